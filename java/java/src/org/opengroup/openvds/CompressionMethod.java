@@ -28,5 +28,7 @@ public enum CompressionMethod {
     ZIP,
     WAVELET_NORMALIZE_BLOCK,
     WAVELET_LOSSLESS,
-    WAVELET_NORMALIZE_BLOCK_LOSSLESS;
+    WAVELET_NORMALIZE_BLOCK_LOSSLESS,
+    ZSTD,
+    LZ4;
 }
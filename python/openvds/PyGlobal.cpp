@@ -45,6 +45,15 @@ PyGlobal::initModule(py::module& m)
   OpenOptions_.def_readwrite("waveletAdaptiveMode"         , &OpenOptions::waveletAdaptiveMode, OPENVDS_DOCSTRING(OpenOptions_waveletAdaptiveMode));
   OpenOptions_.def_readwrite("waveletAdaptiveTolerance"    , &OpenOptions::waveletAdaptiveTolerance, OPENVDS_DOCSTRING(OpenOptions_waveletAdaptiveTolerance));
   OpenOptions_.def_readwrite("waveletAdaptiveRatio"        , &OpenOptions::waveletAdaptiveRatio, OPENVDS_DOCSTRING(OpenOptions_waveletAdaptiveRatio));
+  OpenOptions_.def_readwrite("maxCacheSize"                , &OpenOptions::maxCacheSize     , OPENVDS_DOCSTRING(OpenOptions_maxCacheSize));
+  OpenOptions_.def_readwrite("diskCachePath"               , &OpenOptions::diskCachePath    , OPENVDS_DOCSTRING(OpenOptions_diskCachePath));
+  OpenOptions_.def_readwrite("diskCacheMaxSize"            , &OpenOptions::diskCacheMaxSize , OPENVDS_DOCSTRING(OpenOptions_diskCacheMaxSize));
+  OpenOptions_.def_readwrite("maxConcurrentRequests"       , &OpenOptions::maxConcurrentRequests, OPENVDS_DOCSTRING(OpenOptions_maxConcurrentRequests));
+  OpenOptions_.def_readwrite("adaptiveConcurrency"         , &OpenOptions::adaptiveConcurrency, OPENVDS_DOCSTRING(OpenOptions_adaptiveConcurrency));
+  OpenOptions_.def_readwrite("maxConnectionsPerHost"       , &OpenOptions::maxConnectionsPerHost, OPENVDS_DOCSTRING(OpenOptions_maxConnectionsPerHost));
+  OpenOptions_.def_readwrite("http2Multiplexing"           , &OpenOptions::http2Multiplexing, OPENVDS_DOCSTRING(OpenOptions_http2Multiplexing));
+  OpenOptions_.def_readwrite("tcpKeepAlive"                , &OpenOptions::tcpKeepAlive    , OPENVDS_DOCSTRING(OpenOptions_tcpKeepAlive));
+  OpenOptions_.def_readwrite("receiveBufferSize"           , &OpenOptions::receiveBufferSize, OPENVDS_DOCSTRING(OpenOptions_receiveBufferSize));
 
   py::enum_<OpenOptions::ConnectionType> 
     OpenOptions_ConnectionType_(OpenOptions_,"ConnectionType", OPENVDS_DOCSTRING(OpenOptions_ConnectionType));
@@ -31,6 +31,9 @@ PyGlobalState::initModule(py::module& m)
   GlobalState_.def("getChunksDownloaded"         , static_cast<uint64_t(GlobalState::*)(OpenOptions::ConnectionType)>(&GlobalState::GetChunksDownloaded), py::arg("connectionType").none(false), py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(GlobalState_GetChunksDownloaded));
   GlobalState_.def("getBytesDecompressed"        , static_cast<uint64_t(GlobalState::*)(OpenOptions::ConnectionType)>(&GlobalState::GetBytesDecompressed), py::arg("connectionType").none(false), py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(GlobalState_GetBytesDecompressed));
   GlobalState_.def("getChunksDecompressed"       , static_cast<uint64_t(GlobalState::*)(OpenOptions::ConnectionType)>(&GlobalState::GetChunksDecompressed), py::arg("connectionType").none(false), py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(GlobalState_GetChunksDecompressed));
+  GlobalState_.def("getCacheHits"                , static_cast<uint64_t(GlobalState::*)(OpenOptions::ConnectionType)>(&GlobalState::GetCacheHits), py::arg("connectionType").none(false), py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(GlobalState_GetCacheHits));
+  GlobalState_.def("getCacheMisses"              , static_cast<uint64_t(GlobalState::*)(OpenOptions::ConnectionType)>(&GlobalState::GetCacheMisses), py::arg("connectionType").none(false), py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(GlobalState_GetCacheMisses));
+  GlobalState_.def("getCacheEvictions"           , static_cast<uint64_t(GlobalState::*)(OpenOptions::ConnectionType)>(&GlobalState::GetCacheEvictions), py::arg("connectionType").none(false), py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(GlobalState_GetCacheEvictions));
 
 //AUTOGEN-END
 }
@@ -87,6 +87,8 @@ PyVolumeData::initModule(py::module& m)
   CompressionMethod_.value("WaveletNormalizeBlock"       , CompressionMethod::WaveletNormalizeBlock, OPENVDS_DOCSTRING(CompressionMethod_WaveletNormalizeBlock));
   CompressionMethod_.value("WaveletLossless"             , CompressionMethod::WaveletLossless      , OPENVDS_DOCSTRING(CompressionMethod_WaveletLossless));
   CompressionMethod_.value("WaveletNormalizeBlockLossless", CompressionMethod::WaveletNormalizeBlockLossless, OPENVDS_DOCSTRING(CompressionMethod_WaveletNormalizeBlockLossless));
+  CompressionMethod_.value("Zstd"                        , CompressionMethod::Zstd                 , OPENVDS_DOCSTRING(CompressionMethod_Zstd));
+  CompressionMethod_.value("LZ4"                         , CompressionMethod::LZ4                  , OPENVDS_DOCSTRING(CompressionMethod_LZ4));
 
   m.def("compressionMethod_IsWavelet" , static_cast<bool(*)(native::CompressionMethod)>(&CompressionMethod_IsWavelet), py::arg("compressionMethod").none(false), py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(CompressionMethod_IsWavelet));
   m.def("getLODSize"                  , static_cast<int(*)(int, int, int, bool)>(&GetLODSize), py::arg("voxelMin").none(false), py::arg("voxelMax").none(false), py::arg("lod").none(false), py::arg("includePartialUpperVoxel") = true, py::call_guard<py::gil_scoped_release>(), OPENVDS_DOCSTRING(GetLODSize));
@@ -189,6 +189,8 @@ static const char *__doc_OpenVDS_CompressionMethod = R"doc()doc";
 
 static const char *__doc_OpenVDS_CompressionMethod_IsWavelet = R"doc()doc";
 
+static const char *__doc_OpenVDS_CompressionMethod_LZ4 = R"doc()doc";
+
 static const char *__doc_OpenVDS_CompressionMethod_None = R"doc()doc";
 
 static const char *__doc_OpenVDS_CompressionMethod_RLE = R"doc()doc";
@@ -203,6 +205,10 @@ static const char *__doc_OpenVDS_CompressionMethod_WaveletNormalizeBlockLossless
 
 static const char *__doc_OpenVDS_CompressionMethod_Zip = R"doc()doc";
 
+static const char *__doc_OpenVDS_CompressionMethod_Zstd =
+R"doc(The compression tolerance is used as the zstd compression level, 0
+selects the zstd default level)doc";
+
 static const char *__doc_OpenVDS_ConvertNoValue = R"doc()doc";
 
 static const char *__doc_OpenVDS_ConvertNoValue_2 = R"doc()doc";
@@ -884,6 +890,49 @@ Returns:
     Global number of bytes downloaded from the connection. This does
     not include any http header data.)doc";
 
+static const char *__doc_OpenVDS_GlobalState_GetCacheEvictions =
+R"doc(Get the global count of pages evicted from memory, either because a
+page accessor reached its page limit or because the VDS reached its
+cache size limit.
+
+Parameters:
+-----------
+
+connectionType :
+    The counter to be retireved.
+
+Returns:
+--------
+    Number of evicted pages.)doc";
+
+static const char *__doc_OpenVDS_GlobalState_GetCacheHits =
+R"doc(Get the global count of page reads that were served by pages already
+in memory.
+
+Parameters:
+-----------
+
+connectionType :
+    The counter to be retireved.
+
+Returns:
+--------
+    Number of page cache hits.)doc";
+
+static const char *__doc_OpenVDS_GlobalState_GetCacheMisses =
+R"doc(Get the global count of page reads that had to read and decompress
+the chunk.
+
+Parameters:
+-----------
+
+connectionType :
+    The counter to be retireved.
+
+Returns:
+--------
+    Number of page cache misses.)doc";
+
 static const char *__doc_OpenVDS_GlobalState_GetChunksDecompressed =
 R"doc(Get the global count of decompressed chunks.
 
@@ -2541,8 +2590,50 @@ static const char *__doc_OpenVDS_OpenOptions_OpenOptions = R"doc()doc";
 
 static const char *__doc_OpenVDS_OpenOptions_OpenOptions_2 = R"doc()doc";
 
+static const char *__doc_OpenVDS_OpenOptions_adaptiveConcurrency =
+R"doc(< Adjust the number of requests in flight (up to
+maxConcurrentRequests) to the observed throughput and latency. The
+limit is raised by one while the connection keeps up and halved when
+requests are retried or the latency grows without a gain in
+throughput.)doc";
+
 static const char *__doc_OpenVDS_OpenOptions_connectionType = R"doc()doc";
 
+static const char *__doc_OpenVDS_OpenOptions_diskCacheMaxSize =
+R"doc(< Maximum number of bytes stored in the disk cache directory. When the
+limit is exceeded the least recently used chunks are deleted.)doc";
+
+static const char *__doc_OpenVDS_OpenOptions_diskCachePath =
+R"doc(< Directory used to cache chunks on local disk when a VDS is opened for
+reading. Several processes can share the same directory. An empty
+string disables the disk cache.)doc";
+
+static const char *__doc_OpenVDS_OpenOptions_http2Multiplexing =
+R"doc(< Use HTTP/2 when the server supports it and multiplex requests over
+existing connections instead of opening new ones.)doc";
+
+static const char *__doc_OpenVDS_OpenOptions_maxCacheSize =
+R"doc(< Maximum number of bytes of decompressed chunk data kept in memory by
+all the page accessors of the VDS together. When the limit is exceeded
+the pages that are cheapest to read again are evicted first. A value
+of 0 means that only the page limit of each page accessor applies.)doc";
+
+static const char *__doc_OpenVDS_OpenOptions_maxConcurrentRequests =
+R"doc(< Maximum number of requests in flight at the same time for the Http,
+GoogleStorage and AzurePresigned connection types.)doc";
+
+static const char *__doc_OpenVDS_OpenOptions_maxConnectionsPerHost =
+R"doc(< Maximum number of connections opened to a single host by the Http,
+GoogleStorage and AzurePresigned connection types. A value of 0 means
+no limit other than maxConcurrentRequests.)doc";
+
+static const char *__doc_OpenVDS_OpenOptions_receiveBufferSize =
+R"doc(< Size in bytes of the receive buffer of each request. A value of 0
+uses the default of libcurl.)doc";
+
+static const char *__doc_OpenVDS_OpenOptions_tcpKeepAlive =
+R"doc(< Send TCP keep-alive probes on idle connections.)doc";
+
 static const char *__doc_OpenVDS_OpenOptions_waveletAdaptiveMode =
 R"doc(< This property (only relevant when using Wavelet compression) is used
 to control how the wavelet adaptive compression determines which level
@@ -4556,6 +4647,10 @@ static const char *__doc_OpenVDS_VolumeDataPageAccessor_AccessMode = R"doc()doc"
 
 static const char *__doc_OpenVDS_VolumeDataPageAccessor_AccessMode_AccessMode_Create = R"doc()doc";
 
+static const char *__doc_OpenVDS_VolumeDataPageAccessor_AccessMode_AccessMode_CreateWithLODGeneration =
+R"doc(Create the layer and all its parent LOD layers, which are produced by
+downsampling the chunks as they are written)doc";
+
 static const char *__doc_OpenVDS_VolumeDataPageAccessor_AccessMode_AccessMode_ReadOnly = R"doc()doc";
 
 static const char *__doc_OpenVDS_VolumeDataPageAccessor_AccessMode_AccessMode_ReadWrite = R"doc()doc";
@@ -10,8 +10,14 @@
 
 #include "HueBulkDataStore.h"
 #include "IO/File.h"
+#include "IO/FileReadQueue.h"
+#include "VDS/Env.h"
 #include <fmt/format.h>
+#include <memory>
+#include <mutex>
 using OpenVDS::File;
+using OpenVDS::FileView;
+using OpenVDS::FileReadQueue;
 using OpenVDS::Error;
 
 class DataStoreFileDescriptor
@@ -30,15 +36,17 @@ class DataStoreBuffer : public HueBulkDataStore::Buffer
   int64_t m_offset;
   int32_t m_size;
   bool    m_owner;
+  bool    m_mapped;
   void   *m_data;
 
   mutable bool
     m_dirty;
 
 public:
-  DataStoreBuffer(int64_t offset, int32_t size, bool dirty, void *data, bool takeOwnership) : m_offset(offset), m_size(size), m_owner(takeOwnership), m_data(data), m_dirty(dirty) { assert(data && size > 0); }
-  DataStoreBuffer(int64_t offset, int32_t size) : m_offset(offset), m_size(size), m_owner(true), m_data(calloc(1, size)), m_dirty(true) { assert(size > 0); }
-  DataStoreBuffer() : m_offset(0), m_size(0), m_owner(false),  m_data(NULL), m_dirty(false) {}
+  DataStoreBuffer(int64_t offset, int32_t size, bool dirty, void *data, bool takeOwnership) : m_offset(offset), m_size(size), m_owner(takeOwnership), m_mapped(false), m_data(data), m_dirty(dirty) { assert(data && size > 0); }
+  DataStoreBuffer(int64_t offset, int32_t size) : m_offset(offset), m_size(size), m_owner(true), m_mapped(false), m_data(calloc(1, size)), m_dirty(true) { assert(size > 0); }
+  DataStoreBuffer(int64_t offset, int32_t size, const FileView &fileView) : m_offset(offset), m_size(size), m_owner(false), m_mapped(true), m_data(const_cast<char *>(static_cast<const char *>(fileView.Pointer()) + (offset - fileView.Pos()))), m_dirty(false) { assert(size > 0 && offset >= fileView.Pos() && offset + size <= fileView.Pos() + fileView.Size()); }
+  DataStoreBuffer() : m_offset(0), m_size(0), m_owner(false), m_mapped(false), m_data(NULL), m_dirty(false) {}
   virtual ~DataStoreBuffer() { assert(!m_owner || m_data); if (m_owner) free(m_data); }
 
   int64_t
@@ -56,6 +64,19 @@ public:
   void
     ClearDirty() const { assert(m_dirty); m_dirty = false; }
 
+  // The data points into the mapping of the file, so it can't be made writable and has to be read with CopyData
+  bool
+    IsMapped() const { return m_mapped; }
+
+  bool
+    CopyData(void *target, int32_t offset, int32_t size) const
+  {
+    assert(offset >= 0 && size >= 0 && offset + size <= m_size);
+    if (m_mapped) return FileView::CopyData(target, static_cast<const char *>(m_data) + offset, size);
+    memcpy(target, static_cast<const char *>(m_data) + offset, size);
+    return true;
+  }
+
   // HueBulkDataStore::Buffer implementation
   virtual const void *
     Data() const { return m_data; }
@@ -64,6 +85,24 @@ public:
     Size() const { return m_size; }
 };
 
+class DataStoreReadRequest : public HueBulkDataStore::ReadRequest
+{
+public:
+  int64_t m_offset;
+  int32_t m_size;
+  void   *m_data;
+
+  std::shared_ptr<OpenVDS::FileReadRequest>
+    m_fileReadRequest;
+
+  DataStoreBuffer
+    *m_mappedBuffer; // Used instead of reading the data when it is mapped
+
+  DataStoreReadRequest(int64_t offset, int32_t size) : m_offset(offset), m_size(size), m_data(malloc(size)), m_mappedBuffer(NULL) { assert(size > 0); }
+  explicit DataStoreReadRequest(DataStoreBuffer *mappedBuffer) : m_offset(mappedBuffer->Offset()), m_size(mappedBuffer->Size()), m_data(NULL), m_mappedBuffer(mappedBuffer) {}
+  ~DataStoreReadRequest() { free(m_data); delete m_mappedBuffer; }
+};
+
 class FileInterfaceImpl : public HueBulkDataStore::FileInterface
 {
   class HueBulkDataStoreImpl
@@ -142,10 +181,26 @@ class HueBulkDataStoreImpl : public HueBulkDataStore
     FILENAME_MAX_CHARS = 1024
   };
 
+  enum
+  {
+    FILE_READ_QUEUE_DEPTH = 128
+  };
+
   File    m_fileHandle;
 
   bool    m_readOnly;
 
+  std::mutex
+          m_fileReadQueueMutex;
+
+  bool    m_isFileReadQueueCreated;
+
+  std::unique_ptr<FileReadQueue>
+          m_fileReadQueue;
+
+  FileView
+         *m_fileView;
+
   static thread_local std::string
          m_errorMessage;
 
@@ -175,6 +230,14 @@ public:
   DataStoreBuffer *
     ReadBuffer(int64_t offset, int32_t size);
 
+  DataStoreBuffer *
+    ReadMappedBuffer(int64_t offset, int32_t size);
+
+  void MapFile();
+
+  // Only the part of the file that existed when it was opened is mapped, and data written after that is read normally
+  bool IsMapped(int64_t offset, int32_t size) const { return m_fileView && m_readOnly && offset >= m_fileView->Pos() && offset + size <= m_fileView->Pos() + m_fileView->Size(); }
+
   DataStoreBuffer *
     CreateBuffer(int32_t size, ExtentAllocator::ExtentType type);
 
@@ -182,6 +245,9 @@ public:
 
   bool WriteBuffer(DataStoreBuffer const &buffer);
 
+  FileReadQueue *
+    GetFileReadQueue();
+
   bool ReadHeaderAndFileTable();
 
   const DataStoreHeader &
@@ -236,8 +302,14 @@ public:
 
   virtual void           CreateChunkDataIndexEntry(IndexEntry &indexEntry, int size) { assert(size > 0); indexEntry = IndexEntry(); indexEntry.m_offset = m_extentAllocator->Allocate(size, ExtentAllocator::ChunkExtent); indexEntry.m_length = size; }
 
-  virtual Buffer *       ReadChunkData(IndexEntry const &indexEntry) { return ReadBuffer(indexEntry.m_offset, indexEntry.m_length); }
+  virtual Buffer *       ReadChunkData(IndexEntry const &indexEntry) { return ReadMappedBuffer(indexEntry.m_offset, indexEntry.m_length); }
   virtual bool           WriteChunkData(IndexEntry const &indexEntry, const void *data, int size) { assert(size == indexEntry.m_length); return WriteBuffer(DataStoreBuffer(indexEntry.m_offset, size, true, const_cast<void *>(data), false)); }
+
+  virtual ReadRequest *  ReadChunkDataAsync(IndexEntry const &indexEntry);
+  virtual Buffer *       WaitForChunkData(ReadRequest *readRequest);
+  virtual void           CancelReadChunkData(ReadRequest *readRequest);
+
+  virtual bool           CopyBufferData(Buffer const *buffer, int offset, int size, void *target);
 };
 
 thread_local std::string HueBulkDataStoreImpl::m_errorMessage;
@@ -299,6 +371,15 @@ FileInterfaceImpl::ReadIndexPage(int indexPage, DataStoreBuffer **indexPageBuffe
   int
     indexPageEntryCount = m_fileDescriptor.m_fileHeader.m_indexPageEntryCount;
 
+  if (m_indexPages[indexPage] && makeWritable && m_indexPages[indexPage]->IsMapped())
+  {
+    // A mapped page can't be modified, read it again as an ordinary buffer
+    assert(!m_indexPages[indexPage]->IsDirty());
+    delete m_indexPages[indexPage];
+    m_indexPages[indexPage] = NULL;
+    m_indexPageCacheMRUList.remove(indexPage);
+  }
+
   if (m_indexPages[indexPage])
   {
     assert(std::find(m_indexPageCacheMRUList.begin(), m_indexPageCacheMRUList.end(), indexPage) != m_indexPageCacheMRUList.end());
@@ -321,9 +402,10 @@ FileInterfaceImpl::ReadIndexPage(int indexPage, DataStoreBuffer **indexPageBuffe
 
   if (indexPageOffset != 0)
   {
-    *indexPageBuffer = m_dataStore.ReadBuffer(indexPageOffset, indexPageEntryCount * indexEntrySize);
+    *indexPageBuffer = makeWritable ? m_dataStore.ReadBuffer(indexPageOffset, indexPageEntryCount * indexEntrySize)
+                                    : m_dataStore.ReadMappedBuffer(indexPageOffset, indexPageEntryCount * indexEntrySize);
 
-    if (!indexPageBuffer)
+    if (!*indexPageBuffer)
     {
       return false;
     }
@@ -391,17 +473,17 @@ FileInterfaceImpl::ReadIndexEntry(int chunk, IndexEntry *indexEntry, void *metad
 
   if (indexPageBuffer)
   {
-    size_t
-      indexPageEntrySize = sizeof(IndexEntry) + m_fileDescriptor.m_fileHeader.m_chunkMetadataLength;
-
-    const IndexEntry
-      *indexPageEntry = reinterpret_cast<const IndexEntry *>(static_cast<const char *>(indexPageBuffer->Data()) + entryIndex * indexPageEntrySize);
+    int
+      indexPageEntrySize = (int)sizeof(IndexEntry) + m_fileDescriptor.m_fileHeader.m_chunkMetadataLength;
 
-    memcpy(indexEntry, indexPageEntry, sizeof(IndexEntry));
+    if (!m_dataStore.CopyBufferData(indexPageBuffer, entryIndex * indexPageEntrySize, (int)sizeof(IndexEntry), indexEntry))
+    {
+      return false;
+    }
 
-    if (metadata)
+    if (metadata && !m_dataStore.CopyBufferData(indexPageBuffer, entryIndex * indexPageEntrySize + (int)sizeof(IndexEntry), m_fileDescriptor.m_fileHeader.m_chunkMetadataLength, metadata))
     {
-      memcpy(metadata, indexPageEntry + 1, m_fileDescriptor.m_fileHeader.m_chunkMetadataLength);
+      return false;
     }
   }
   else
@@ -698,6 +780,134 @@ HueBulkDataStoreImpl::ReadBuffer(int64_t offset, int32_t size)
   }
 }
 
+DataStoreBuffer *
+HueBulkDataStoreImpl::ReadMappedBuffer(int64_t offset, int32_t size)
+{
+  assert(offset >= 0 && size >= 0);
+
+  if (size > 0 && IsMapped(offset, size))
+  {
+    return new DataStoreBuffer(offset, size, *m_fileView);
+  }
+
+  return ReadBuffer(offset, size);
+}
+
+void
+HueBulkDataStoreImpl::MapFile()
+{
+  assert(m_fileHandle.IsOpen() && !m_fileView);
+
+  Error error;
+  int64_t fileSize = m_fileHandle.Size(error);
+
+  // If the file can't be mapped it is read like it would be without the mapping
+  if (fileSize > 0)
+  {
+    m_fileView = m_fileHandle.CreateFileView(0, fileSize, false, error);
+  }
+}
+
+FileReadQueue *
+HueBulkDataStoreImpl::GetFileReadQueue()
+{
+  std::unique_lock<std::mutex> lock(m_fileReadQueueMutex);
+
+  if (!m_isFileReadQueueCreated && m_fileHandle.IsOpen())
+  {
+    // OPENVDS_FILE_READ_QUEUE can be "io_uring", "threadpool" or "none" to pick the queue or read synchronously ("mmap" is handled by Open)
+    std::string queueType = OpenVDS::getStringEnvironmentVariable("OPENVDS_FILE_READ_QUEUE");
+
+    if (queueType != "none")
+    {
+      m_fileReadQueue = FileReadQueue::Create(m_fileHandle, FILE_READ_QUEUE_DEPTH, queueType == "io_uring" ? FileReadQueue::Type_IoUring : queueType == "threadpool" ? FileReadQueue::Type_ThreadPool : FileReadQueue::Type_Default);
+    }
+    m_isFileReadQueueCreated = true;
+  }
+
+  return m_fileReadQueue.get();
+}
+
+HueBulkDataStore::ReadRequest *
+HueBulkDataStoreImpl::ReadChunkDataAsync(IndexEntry const &indexEntry)
+{
+  assert(indexEntry.m_offset >= 0 && indexEntry.m_length > 0);
+
+  if (IsMapped(indexEntry.m_offset, indexEntry.m_length))
+  {
+    DataStoreBuffer *mappedBuffer = new DataStoreBuffer(indexEntry.m_offset, indexEntry.m_length, *m_fileView);
+
+    // There is nothing to read, but asking the kernel to page in the data now means it is less likely to block when it is copied
+    Error error;
+    m_fileView->Prefetch(mappedBuffer->Data(), mappedBuffer->Size(), error);
+    return new DataStoreReadRequest(mappedBuffer);
+  }
+
+  FileReadQueue *fileReadQueue = GetFileReadQueue();
+
+  if (!fileReadQueue)
+  {
+    return NULL;
+  }
+
+  DataStoreReadRequest *readRequest = new DataStoreReadRequest(indexEntry.m_offset, indexEntry.m_length);
+  readRequest->m_fileReadRequest = fileReadQueue->Read(readRequest->m_data, readRequest->m_offset, readRequest->m_size);
+  return readRequest;
+}
+
+HueBulkDataStore::Buffer *
+HueBulkDataStoreImpl::WaitForChunkData(ReadRequest *readRequest)
+{
+  DataStoreReadRequest *dataStoreReadRequest = static_cast<DataStoreReadRequest *>(readRequest);
+  DataStoreBuffer *buffer = NULL;
+
+  Error error;
+  if (dataStoreReadRequest->m_mappedBuffer)
+  {
+    buffer = dataStoreReadRequest->m_mappedBuffer;
+    dataStoreReadRequest->m_mappedBuffer = NULL;
+  }
+  else if (dataStoreReadRequest->m_fileReadRequest->WaitForFinish(error))
+  {
+    buffer = new DataStoreBuffer(dataStoreReadRequest->m_offset, dataStoreReadRequest->m_size, false, dataStoreReadRequest->m_data, true);
+    dataStoreReadRequest->m_data = NULL;
+  }
+  else
+  {
+    SetErrorMessage("Read error: " + error.string);
+  }
+
+  delete dataStoreReadRequest;
+  return buffer;
+}
+
+void
+HueBulkDataStoreImpl::CancelReadChunkData(ReadRequest *readRequest)
+{
+  DataStoreReadRequest *dataStoreReadRequest = static_cast<DataStoreReadRequest *>(readRequest);
+
+  // A read that has been started can't be taken back, so the buffer has to stay around until it is done
+  if (dataStoreReadRequest->m_fileReadRequest)
+  {
+    Error error;
+    dataStoreReadRequest->m_fileReadRequest->WaitForFinish(error);
+  }
+
+  delete dataStoreReadRequest;
+}
+
+bool
+HueBulkDataStoreImpl::CopyBufferData(Buffer const *buffer, int offset, int size, void *target)
+{
+  if (!static_cast<DataStoreBuffer const *>(buffer)->CopyData(target, offset, size))
+  {
+    SetErrorMessage(fmt::format("Read error: Couldn't read {} bytes at offset {} of the mapped file", size, static_cast<DataStoreBuffer const *>(buffer)->Offset() + offset));
+    return false;
+  }
+
+  return true;
+}
+
 DataStoreBuffer *
 HueBulkDataStoreImpl::CreateBuffer(int32_t size, ExtentAllocator::ExtentType type)
 {
@@ -914,6 +1124,8 @@ HueBulkDataStoreImpl::OpenFileInternal(DataStoreFileDescriptor &fileDescriptor,
 
 HueBulkDataStoreImpl::HueBulkDataStoreImpl() :
   m_readOnly(true),
+  m_isFileReadQueueCreated(false),
+  m_fileView(NULL),
   m_header(NULL),
   m_fileTable(NULL),
   m_extentAllocator(NULL)
@@ -1438,6 +1650,12 @@ HueBulkDataStoreImpl::Open(const char *fileName)
     return false;
   }
 
+  // Serve the index pages and chunk data from a mapping of the file instead of reading them into buffers
+  if (OpenVDS::getStringEnvironmentVariable("OPENVDS_FILE_READ_QUEUE") == "mmap")
+  {
+    MapFile();
+  }
+
   return true;
 }
 
@@ -1473,6 +1691,16 @@ HueBulkDataStoreImpl::CreateNew(const char *fileName, bool overwriteExisting)
 void
 HueBulkDataStoreImpl::Close()
 {
+  // Wait for the reads in flight before the file is closed
+  m_fileReadQueue.reset();
+  m_isFileReadQueueCreated = false;
+
+  if (m_fileView)
+  {
+    FileView::RemoveReference(m_fileView);
+    m_fileView = NULL;
+  }
+
   if(m_fileHandle.IsOpen())
   {
     m_fileHandle.Close();
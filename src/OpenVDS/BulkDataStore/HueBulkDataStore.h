@@ -50,6 +50,13 @@ public:
     virtual int  Size() const = 0;
   };
 
+  class ReadRequest
+  {
+  protected:
+    ReadRequest() {}
+    ~ReadRequest() {}
+  };
+
   class FileInterface
   {
   public:
@@ -119,6 +126,18 @@ public:
   virtual Buffer*  ReadChunkData(struct IndexEntry const &indexEntry) = 0;
   virtual bool     WriteChunkData(struct IndexEntry const &indexEntry, const void *data, int size) = 0;
 
+  // Starts reading the chunk data in the background, returns NULL if the data store can't read asynchronously.
+  // Every request must be finished with either WaitForChunkData or CancelReadChunkData, these are thread-safe too.
+  virtual ReadRequest*
+                   ReadChunkDataAsync(struct IndexEntry const &indexEntry) = 0;
+  virtual Buffer*  WaitForChunkData(ReadRequest *readRequest) = 0;
+  virtual void     CancelReadChunkData(ReadRequest *readRequest) = 0;
+
+  // The buffers returned by ReadChunkData and WaitForChunkData point into a mapping of the file when the data store is
+  // opened with OPENVDS_FILE_READ_QUEUE=mmap, so their data must be read with this method. It fails instead of crashing
+  // if the mapped file can't be read.
+  virtual bool     CopyBufferData(Buffer const *buffer, int offset, int size, void *target) = 0;
+
   static HueBulkDataStore *Open(const char *fileName);
   static HueBulkDataStore *CreateNew(const char *fileName, bool overwriteExisting);
   static void              Close(HueBulkDataStore *hueBulkDataStore);
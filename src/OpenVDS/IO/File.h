@@ -76,6 +76,10 @@ public:
   OPENVDS_EXPORT
   virtual bool Prefetch(const void *pData, int64_t nSize, Error &error) const = 0;
 
+  // Copies from the memory of a file view, returns false instead of crashing if the pages can't be read (e.g. the file was truncated)
+  OPENVDS_EXPORT
+  static bool CopyData(void *pTarget, const void *pSource, int64_t nSize);
+
   OPENVDS_EXPORT
   static FileView* AddReference(FileView* pcFileView);
 
@@ -0,0 +1,525 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include "FileReadQueue.h"
+
+#include <VDS/ThreadPool.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <assert.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define FILEREADQUEUE_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace OpenVDS
+{
+
+class FileReadRequestImpl : public FileReadRequest
+{
+  mutable std::mutex m_mutex;
+  std::condition_variable m_doneCondition;
+  bool m_done;
+  Error m_error;
+
+public:
+  FileReadRequestImpl() : m_done(false) {}
+
+  void Complete(const Error &error)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_error = error;
+    m_done = true;
+    m_doneCondition.notify_all();
+  }
+
+  bool WaitForFinish(Error &error) override
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]{ return m_done; });
+    error = m_error;
+    return m_error.code == 0;
+  }
+
+  bool IsDone() const override
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_done;
+  }
+};
+
+class ThreadPoolFileReadQueue : public FileReadQueue
+{
+  File &m_file;
+  ThreadPool m_threadPool;
+
+public:
+  ThreadPoolFileReadQueue(File &file, int threadCount) : m_file(file), m_threadPool(threadCount) {}
+
+  std::shared_ptr<FileReadRequest> Read(void *data, int64_t offset, int32_t length) override
+  {
+    auto request = std::make_shared<FileReadRequestImpl>();
+    File &file = m_file;
+    m_threadPool.Enqueue([&file, request, data, offset, length]
+      {
+        Error error;
+        file.Read(data, offset, length, error);
+        request->Complete(error);
+      });
+    return request;
+  }
+
+  Type GetType() const override { return Type_ThreadPool; }
+};
+
+#ifdef FILEREADQUEUE_IO_URING
+
+// The ring is driven with the raw system calls so we don't depend on liburing. Reads are submitted under m_mutex, and a
+// completion thread waits for completions, resubmits the remainder of short reads and completes the requests. Reads
+// beyond the queue depth wait in m_waitingRequests and are submitted by the completion thread as others complete.
+// Reads the kernel refuses, and all reads after the ring has failed, are done with File::Read without holding m_mutex.
+class IoUringFileReadQueue : public FileReadQueue
+{
+  struct IoUringReadRequest : public FileReadRequestImpl
+  {
+    struct iovec iovec;
+    int64_t offset;
+  };
+
+  File &m_file;
+
+  int m_ringFd;
+
+  void *m_submissionRing;
+  size_t m_submissionRingSize;
+  void *m_completionRing;
+  size_t m_completionRingSize;
+  io_uring_sqe *m_submissionEntries;
+  size_t m_submissionEntriesSize;
+
+  unsigned *m_submissionHead;
+  unsigned *m_submissionTail;
+  unsigned *m_submissionArray;
+  unsigned m_submissionMask;
+  unsigned *m_completionHead;
+  unsigned *m_completionTail;
+  io_uring_cqe *m_completionEntries;
+  unsigned m_completionMask;
+
+  typedef std::unordered_map<uint64_t, std::shared_ptr<IoUringReadRequest>> RequestMap;
+  typedef std::vector<std::shared_ptr<IoUringReadRequest>> RequestList;
+
+  std::mutex m_mutex;
+  RequestMap m_requests;
+  std::deque<uint64_t> m_waitingRequests;
+  unsigned m_submittedRequestCount;
+  unsigned m_maxSubmittedRequestCount;
+  uint64_t m_nextRequestId;
+  bool m_stop;
+  Error m_ringError;
+
+  std::thread m_completionThread;
+
+  // Requests are identified by a non-zero id, zero is the NOP that wakes up the completion thread when stopping
+  bool SubmitLocked(uint8_t opcode, uint64_t id, const IoUringReadRequest *request)
+  {
+    unsigned tail = *m_submissionTail;
+    unsigned index = tail & m_submissionMask;
+
+    io_uring_sqe &entry = m_submissionEntries[index];
+    memset(&entry, 0, sizeof(entry));
+    entry.opcode = opcode;
+    entry.user_data = id;
+    if (request)
+    {
+      entry.fd = (int)(intptr_t)m_file.Handle();
+      entry.off = request->offset;
+      entry.addr = (uint64_t)(uintptr_t)&request->iovec;
+      entry.len = 1;
+    }
+    m_submissionArray[index] = index;
+    __atomic_store_n(m_submissionTail, tail + 1, __ATOMIC_RELEASE);
+
+    int result;
+    do
+    {
+      result = (int)syscall(__NR_io_uring_enter, m_ringFd, 1, 0, 0, nullptr, 0);
+    } while (result < 0 && errno == EINTR);
+
+    if (result != 1)
+    {
+      // Take the entry back so the next submission doesn't pick it up
+      __atomic_store_n(m_submissionTail, tail, __ATOMIC_RELEASE);
+      return false;
+    }
+    return true;
+  }
+
+  void CompleteLocked(RequestMap::iterator it, const Error &error)
+  {
+    it->second->Complete(error);
+    m_requests.erase(it);
+  }
+
+  // If the kernel refuses a submission the rest of the read is done synchronously, so the request still completes. The
+  // read is done by the caller after m_mutex is released, so it doesn't hold up the other submitters.
+  void ReadSynchronouslyLocked(RequestMap::iterator it, RequestList &synchronousReads)
+  {
+    synchronousReads.push_back(it->second);
+    m_requests.erase(it);
+  }
+
+  void ReadSynchronously(RequestList &synchronousReads)
+  {
+    for (auto &request : synchronousReads)
+    {
+      Error error;
+      m_file.Read(request->iovec.iov_base, request->offset, int32_t(request->iovec.iov_len), error);
+      request->Complete(error);
+    }
+    synchronousReads.clear();
+  }
+
+  void SubmitWaitingRequestsLocked(RequestList &synchronousReads)
+  {
+    while (!m_waitingRequests.empty() && m_submittedRequestCount < m_maxSubmittedRequestCount)
+    {
+      auto it = m_requests.find(m_waitingRequests.front());
+      m_waitingRequests.pop_front();
+      assert(it != m_requests.end());
+
+      if (SubmitLocked(IORING_OP_READV, it->first, it->second.get()))
+      {
+        m_submittedRequestCount++;
+      }
+      else
+      {
+        ReadSynchronouslyLocked(it, synchronousReads);
+      }
+    }
+  }
+
+  void HandleCompletionLocked(const io_uring_cqe &completion, RequestList &synchronousReads)
+  {
+    auto it = m_requests.find(completion.user_data);
+    if (it == m_requests.end())
+    {
+      assert(completion.user_data == 0 && "Completion for an unknown read");
+      return;
+    }
+
+    IoUringReadRequest &request = *it->second;
+
+    bool isRetry = (completion.res == -EINTR || completion.res == -EAGAIN);
+
+    if (completion.res > 0 && size_t(completion.res) < request.iovec.iov_len)
+    {
+      // Short read, continue with the rest of the range
+      request.iovec.iov_base = (char *)request.iovec.iov_base + completion.res;
+      request.iovec.iov_len -= completion.res;
+      request.offset += completion.res;
+      isRetry = true;
+    }
+
+    if (isRetry)
+    {
+      if (!SubmitLocked(IORING_OP_READV, it->first, &request))
+      {
+        m_submittedRequestCount--;
+        ReadSynchronouslyLocked(it, synchronousReads);
+        SubmitWaitingRequestsLocked(synchronousReads);
+      }
+      return;
+    }
+
+    Error error;
+    if (completion.res < 0)
+    {
+      error.code = -completion.res;
+      error.string = std::string("File::read ") + strerror(-completion.res);
+    }
+    else if (completion.res == 0)
+    {
+      error.code = -1;
+      error.string = "File::read (zero-length read)";
+    }
+    CompleteLocked(it, error);
+    m_submittedRequestCount--;
+    SubmitWaitingRequestsLocked(synchronousReads);
+  }
+
+  void CompletionThread()
+  {
+    RequestList synchronousReads;
+
+    while (true)
+    {
+      int result = (int)syscall(__NR_io_uring_enter, m_ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      int enterError = result < 0 ? errno : 0;
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      if (enterError != 0 && enterError != EINTR && enterError != EAGAIN && enterError != EBUSY)
+      {
+        // The ring is unusable, so fail the reads in flight rather than waiting for them forever. Later reads are done
+        // synchronously by Read since nothing would complete them.
+        m_ringError.code = enterError;
+        m_ringError.string = std::string("io_uring_enter ") + strerror(enterError);
+        while (!m_requests.empty())
+        {
+          CompleteLocked(m_requests.begin(), m_ringError);
+        }
+        m_waitingRequests.clear();
+        m_submittedRequestCount = 0;
+        return;
+      }
+
+      unsigned head = *m_completionHead;
+      unsigned tail = __atomic_load_n(m_completionTail, __ATOMIC_ACQUIRE);
+
+      for (; head != tail; head++)
+      {
+        io_uring_cqe completion = m_completionEntries[head & m_completionMask];
+        __atomic_store_n(m_completionHead, head + 1, __ATOMIC_RELEASE);
+        HandleCompletionLocked(completion, synchronousReads);
+      }
+
+      bool isStopped = m_stop && m_requests.empty();
+      lock.unlock();
+
+      ReadSynchronously(synchronousReads);
+
+      if (isStopped)
+      {
+        return;
+      }
+    }
+  }
+
+  bool Initialize(int queueDepth)
+  {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    m_ringFd = (int)syscall(__NR_io_uring_setup, unsigned(queueDepth), &params);
+    if (m_ringFd < 0)
+    {
+      return false;
+    }
+
+    m_submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    m_submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    bool isSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (isSingleMapping)
+    {
+      m_submissionRingSize = m_completionRingSize = std::max(m_submissionRingSize, m_completionRingSize);
+    }
+
+    m_submissionRing = mmap(nullptr, m_submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    if (m_submissionRing == MAP_FAILED)
+    {
+      m_submissionRing = nullptr;
+      return false;
+    }
+
+    if (isSingleMapping)
+    {
+      m_completionRing = m_submissionRing;
+    }
+    else
+    {
+      m_completionRing = mmap(nullptr, m_completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+      if (m_completionRing == MAP_FAILED)
+      {
+        m_completionRing = nullptr;
+        return false;
+      }
+    }
+
+    void *submissionEntries = mmap(nullptr, m_submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+    if (submissionEntries == MAP_FAILED)
+    {
+      return false;
+    }
+    m_submissionEntries = static_cast<io_uring_sqe *>(submissionEntries);
+
+    char *submissionRing = static_cast<char *>(m_submissionRing);
+    m_submissionHead = reinterpret_cast<unsigned *>(submissionRing + params.sq_off.head);
+    m_submissionTail = reinterpret_cast<unsigned *>(submissionRing + params.sq_off.tail);
+    m_submissionArray = reinterpret_cast<unsigned *>(submissionRing + params.sq_off.array);
+    m_submissionMask = *reinterpret_cast<unsigned *>(submissionRing + params.sq_off.ring_mask);
+
+    char *completionRing = static_cast<char *>(m_completionRing);
+    m_completionHead = reinterpret_cast<unsigned *>(completionRing + params.cq_off.head);
+    m_completionTail = reinterpret_cast<unsigned *>(completionRing + params.cq_off.tail);
+    m_completionEntries = reinterpret_cast<io_uring_cqe *>(completionRing + params.cq_off.cqes);
+    m_completionMask = *reinterpret_cast<unsigned *>(completionRing + params.cq_off.ring_mask);
+
+    // Each read has at most one entry in the submission queue, and the completion queue is at least as large
+    m_maxSubmittedRequestCount = params.sq_entries;
+
+    m_completionThread = std::thread([this]{ CompletionThread(); });
+    return true;
+  }
+
+public:
+  explicit IoUringFileReadQueue(File &file)
+    : m_file(file)
+    , m_ringFd(-1)
+    , m_submissionRing(nullptr)
+    , m_submissionRingSize(0)
+    , m_completionRing(nullptr)
+    , m_completionRingSize(0)
+    , m_submissionEntries(nullptr)
+    , m_submissionEntriesSize(0)
+    , m_submissionHead(nullptr)
+    , m_submissionTail(nullptr)
+    , m_submissionArray(nullptr)
+    , m_submissionMask(0)
+    , m_completionHead(nullptr)
+    , m_completionTail(nullptr)
+    , m_completionEntries(nullptr)
+    , m_completionMask(0)
+    , m_submittedRequestCount(0)
+    , m_maxSubmittedRequestCount(0)
+    , m_nextRequestId(0)
+    , m_stop(false)
+  {
+  }
+
+  ~IoUringFileReadQueue() override
+  {
+    if (m_completionThread.joinable())
+    {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+        // The completion queue is twice the size of the submission queue, so there is always room for the NOP. The
+        // completion thread has already returned if the ring failed.
+        while (m_ringError.code == 0 && !SubmitLocked(IORING_OP_NOP, 0, nullptr))
+        {
+          lock.unlock();
+          std::this_thread::yield();
+          lock.lock();
+        }
+      }
+      m_completionThread.join();
+    }
+
+    if (m_submissionEntries) munmap(m_submissionEntries, m_submissionEntriesSize);
+    if (m_completionRing && m_completionRing != m_submissionRing) munmap(m_completionRing, m_completionRingSize);
+    if (m_submissionRing) munmap(m_submissionRing, m_submissionRingSize);
+    if (m_ringFd >= 0) close(m_ringFd);
+  }
+
+  static std::unique_ptr<FileReadQueue> Create(File &file, int queueDepth)
+  {
+    std::unique_ptr<IoUringFileReadQueue> queue(new IoUringFileReadQueue(file));
+    if (!queue->Initialize(queueDepth))
+    {
+      return nullptr;
+    }
+    return std::unique_ptr<FileReadQueue>(queue.release());
+  }
+
+  std::shared_ptr<FileReadRequest> Read(void *data, int64_t offset, int32_t length) override
+  {
+    assert(offset >= 0 && length >= 0);
+
+    auto request = std::make_shared<IoUringReadRequest>();
+    request->iovec.iov_base = data;
+    request->iovec.iov_len = size_t(length);
+    request->offset = offset;
+
+    if (length == 0)
+    {
+      request->Complete(Error());
+      return request;
+    }
+
+    RequestList synchronousReads;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_ringError.code != 0)
+    {
+      synchronousReads.push_back(request);
+    }
+    else
+    {
+      uint64_t id = ++m_nextRequestId;
+      m_requests.emplace(id, request);
+      m_waitingRequests.push_back(id);
+      SubmitWaitingRequestsLocked(synchronousReads);
+    }
+
+    lock.unlock();
+    ReadSynchronously(synchronousReads);
+
+    return request;
+  }
+
+  Type GetType() const override { return Type_IoUring; }
+};
+
+#endif
+
+std::unique_ptr<FileReadQueue> FileReadQueue::Create(File &file, int queueDepth, Type type)
+{
+  assert(queueDepth > 0);
+
+#ifdef FILEREADQUEUE_IO_URING
+  if (type == Type_Default || type == Type_IoUring)
+  {
+    std::unique_ptr<FileReadQueue> queue = IoUringFileReadQueue::Create(file, queueDepth);
+    if (queue || type == Type_IoUring)
+    {
+      return queue;
+    }
+  }
+#else
+  if (type == Type_IoUring)
+  {
+    return nullptr;
+  }
+#endif
+
+  // Blocking reads need a thread each, so don't spend a thread on every queue slot
+  return std::unique_ptr<FileReadQueue>(new ThreadPoolFileReadQueue(file, std::min(queueDepth, 16)));
+}
+
+}
@@ -0,0 +1,67 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef FILEREADQUEUE_H
+#define FILEREADQUEUE_H
+
+#include "File.h"
+
+#include <memory>
+
+namespace OpenVDS
+{
+
+class FileReadRequest
+{
+public:
+  virtual ~FileReadRequest() {}
+
+  // Blocks until the whole range has been read. Returns false and sets the error if the read failed.
+  virtual bool WaitForFinish(Error &error) = 0;
+  virtual bool IsDone() const = 0;
+};
+
+// Runs positional reads from a file in the background, so the caller can keep many reads in flight while it works
+// on the data of the reads that have completed. On Linux the reads are submitted to an io_uring, otherwise (or if the
+// kernel does not allow io_uring) they are run by a small thread pool using File::Read.
+//
+// The destination buffer of a read must stay valid until the read is done. A read can not be cancelled, and
+// destroying the queue waits for all the reads in flight. The file must stay open while the queue exists.
+class FileReadQueue
+{
+public:
+  enum Type
+  {
+    Type_Default,   // io_uring if available, otherwise a thread pool
+    Type_IoUring,
+    Type_ThreadPool
+  };
+
+  virtual ~FileReadQueue() {}
+
+  // Starts reading length bytes at offset into data. At most queueDepth reads are in flight, the rest wait their turn.
+  virtual std::shared_ptr<FileReadRequest> Read(void *data, int64_t offset, int32_t length) = 0;
+
+  virtual Type GetType() const = 0;
+
+  // Returns nullptr if the requested type is not supported on this system
+  static std::unique_ptr<FileReadQueue> Create(File &file, int queueDepth, Type type = Type_Default);
+};
+
+}
+
+#endif //FILEREADQUEUE_H
@@ -20,6 +20,7 @@
 #include "IOManager.h"
 
 #include "IOManagerInMemory.h"
+#include "IOManagerDiskCache.h"
 
 #ifndef OPENVDS_NO_AWS_IOMANAGER
 #include "IOManagerAWS.h"
@@ -39,6 +40,8 @@
 
 #include "IOManagerDms.h"
 
+#include <fmt/format.h>
+
 namespace OpenVDS
 {
 Request::Request(const std::string& objectName)
@@ -54,7 +57,7 @@ IOManager::IOManager(OpenOptions::ConnectionType connectionType)
 }
 IOManager::~IOManager()
 {}
-IOManager* IOManager::CreateIOManager(const OpenOptions& options, IOManager::AccessPattern accessPattern, Error &error)
+static IOManager* CreateBackendIOManager(const OpenOptions& options, IOManager::AccessPattern accessPattern, Error &error)
 {
   switch(options.connectionType)
   {
@@ -68,7 +71,7 @@ IOManager* IOManager::CreateIOManager(const OpenOptions& options, IOManager::Acc
 #endif
 #ifndef OPENVDS_NO_AZURE_PRESIGNED_IOMANAGER
   case OpenOptions::AzurePresigned:
-    return new IOManagerAzurePresigned(static_cast<const AzurePresignedOpenOptions&>(options).baseUrl, static_cast<const AzurePresignedOpenOptions&>(options).urlSuffix, error);
+    return new IOManagerAzurePresigned(static_cast<const AzurePresignedOpenOptions&>(options), error);
 #endif
 #ifndef OPENVDS_NO_GCP_IOMANAGER
   case OpenOptions::GoogleStorage:
@@ -89,6 +92,72 @@ IOManager* IOManager::CreateIOManager(const OpenOptions& options, IOManager::Acc
   }
 }
 
+// Identifies the dataset in the keys of the disk cache, so datasets with the same layout don't share entries. This
+// is stored in the cache directory, so it must not contain credentials.
+static std::string GetDatasetIdentity(const OpenOptions &options)
+{
+  switch(options.connectionType)
+  {
+  case OpenOptions::AWS:
+  {
+    auto &awsOptions = static_cast<const AWSOpenOptions &>(options);
+    return fmt::format("s3://{}/{}/{}/{}", awsOptions.endpointOverride, awsOptions.region, awsOptions.bucket, awsOptions.key);
+  }
+  case OpenOptions::Azure:
+  {
+    auto &azureOptions = static_cast<const AzureOpenOptions &>(options);
+    std::string accountName = azureOptions.accountName;
+    if (accountName.empty())
+    {
+      // Only the account name is taken from the connection string, the rest of it holds the key
+      static const char accountNameKey[] = "AccountName=";
+      size_t start = azureOptions.connectionString.find(accountNameKey);
+      if (start != std::string::npos)
+      {
+        start += sizeof(accountNameKey) - 1;
+        accountName = azureOptions.connectionString.substr(start, azureOptions.connectionString.find(';', start) - start);
+      }
+    }
+    return fmt::format("azure://{}/{}/{}", accountName, azureOptions.container, azureOptions.blob);
+  }
+  case OpenOptions::AzurePresigned:
+    // The url suffix is the shared access signature
+    return fmt::format("azuresas://{}", static_cast<const AzurePresignedOpenOptions &>(options).baseUrl);
+  case OpenOptions::GoogleStorage:
+  {
+    auto &googleOptions = static_cast<const GoogleOpenOptions &>(options);
+    return fmt::format("gs://{}/{}", googleOptions.bucket, googleOptions.pathPrefix);
+  }
+  case OpenOptions::Http:
+  {
+    // The query of the url can hold a signature
+    const std::string &url = static_cast<const HttpOpenOptions &>(options).url;
+    return url.substr(0, url.find('?'));
+  }
+  case OpenOptions::DMS:
+  {
+    auto &dmsOptions = static_cast<const DMSOpenOptions &>(options);
+    return fmt::format("sd://{}/{}", dmsOptions.sdAuthorityUrl, dmsOptions.datasetPath);
+  }
+  case OpenOptions::InMemory:
+    return fmt::format("inmemory://{}", static_cast<const InMemoryOpenOptions &>(options).name);
+  default:
+    return std::string();
+  }
+}
+
+IOManager* IOManager::CreateIOManager(const OpenOptions& options, IOManager::AccessPattern accessPattern, Error &error)
+{
+  IOManager *ioManager = CreateBackendIOManager(options, accessPattern, error);
+  if (!ioManager || error.code || options.diskCachePath.empty() || accessPattern != AccessPattern::ReadOnly)
+    return ioManager;
+
+  std::unique_ptr<IOManagerDiskCache> diskCache(new IOManagerDiskCache(ioManager, GetDatasetIdentity(options), options.diskCachePath, options.diskCacheMaxSize, error));
+  if (error.code)
+    return nullptr;
+  return diskCache.release();
+}
+
 IOManager *IOManager::CreateIOManager(const StringWrapper &url, const StringWrapper &connectionString, IOManager::AccessPattern accessPattern, Error& error)
 {
   std::unique_ptr<OpenOptions> openOptions(CreateOpenOptions(url, connectionString, error));
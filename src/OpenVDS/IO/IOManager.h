@@ -35,6 +35,10 @@ namespace OpenVDS
     virtual void HandleMetadata(const std::string &key, const std::string &header) = 0;
     virtual void HandleData(std::vector<uint8_t> &&data) = 0;
     virtual void Completed(const Request &request, const Error &error) = 0;
+
+    // The version of the object the reader expects (e.g. the hash of a chunk), an IOManager that caches objects
+    // doesn't use a cached copy of a different version
+    virtual std::string ExpectedVersion() const { return std::string(); }
   };
 
   class Request
@@ -21,11 +21,11 @@
 
 namespace OpenVDS
 {
-  IOManagerAzurePresigned::IOManagerAzurePresigned(const std::string& base, const std::string& suffix, Error &error)
+  IOManagerAzurePresigned::IOManagerAzurePresigned(const AzurePresignedOpenOptions& openOptions, Error &error)
     : IOManager(OpenOptions::AzurePresigned)
-    , m_curlHandler(error)
-    , m_base(base)
-    , m_suffix(suffix)
+    , m_curlHandler(openOptions, error)
+    , m_base(openOptions.baseUrl)
+    , m_suffix(openOptions.urlSuffix)
   {
     if (m_base.empty())
     {
@@ -102,18 +102,141 @@ static size_t curlReadCallback(char *buffer, size_t size, size_t nitems, void *u
   return static_cast<CurlEasyHandler *>(userdata)->handleReadRequest(buffer, nitems);
 }
 
+static const int minAdaptiveConcurrency = 4;
+static const int initialAdaptiveConcurrency = 8;
+
 static void curlAddRequests(UVEventLoopData *eventLoopData)
 {
-  int maxConcurrentRequests = 64;
-  int to_add = maxConcurrentRequests - int(eventLoopData->processingRequests.size());
-  assert(to_add >= 0);
+  // The limit can drop below the number of requests in flight when adaptive concurrency backs off
+  int to_add = std::max(eventLoopData->concurrencyLimit - int(eventLoopData->processingRequests.size()), 0);
   to_add = std::min(to_add, int(eventLoopData->queuedRequests.size()));
   for (int i = 0; i < to_add; i++)
   {
-    eventLoopData->processingRequests.emplace_back(eventLoopData->queuedRequests[i]);
+    eventLoopData->processingRequests.emplace_back(std::move(eventLoopData->queuedRequests.front()));
+    eventLoopData->queuedRequests.pop_front();
     curl_multi_add_handle(eventLoopData->curlMulti, eventLoopData->processingRequests.back()->curlEasy);
   }
-  eventLoopData->queuedRequests.erase(eventLoopData->queuedRequests.begin(), eventLoopData->queuedRequests.begin() + to_add);
+  if (!eventLoopData->queuedRequests.empty())
+  {
+    eventLoopData->windowSaturated = true;
+  }
+}
+
+static void curlAdjustConcurrency(UVEventLoopData *eventLoopData, CURL *curlEasy)
+{
+  if (!eventLoopData->adaptiveConcurrency)
+    return;
+
+  curl_off_t bytes = 0;
+  curl_off_t totalTime = 0;
+  curl_easy_getinfo(curlEasy, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+  curl_easy_getinfo(curlEasy, CURLINFO_TOTAL_TIME_T, &totalTime);
+  eventLoopData->windowRequests++;
+  eventLoopData->windowBytes += int64_t(bytes);
+  eventLoopData->windowLatency += double(totalTime) / 1000000.0;
+
+  int limit = eventLoopData->concurrencyLimit;
+  if (eventLoopData->windowRequests < limit)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - eventLoopData->windowStart).count();
+  double throughput = elapsed > 0.0 ? double(eventLoopData->windowBytes) / elapsed : 0.0;
+  double latency = eventLoopData->windowLatency / eventLoopData->windowRequests;
+
+  // The baseline follows the lowest latency seen, but creeps up by 10% a second so a permanently slower connection isn't penalized forever.
+  // The creep is by time rather than per window since windows are only a round trip long when the limit is low.
+  if (eventLoopData->baselineLatency == 0.0 || latency < eventLoopData->baselineLatency)
+    eventLoopData->baselineLatency = latency;
+  else
+    eventLoopData->baselineLatency *= 1.0 + 0.1 * elapsed;
+
+  int minLimit = std::min(minAdaptiveConcurrency, eventLoopData->maxConcurrentRequests);
+  if (eventLoopData->windowRetries > 0 || (latency > eventLoopData->baselineLatency * 2.0 && throughput <= eventLoopData->previousThroughput * 1.05))
+  {
+    limit = std::max(limit / 2, minLimit);
+  }
+  else if (eventLoopData->windowSaturated)
+  {
+    limit = std::min(limit + 1, eventLoopData->maxConcurrentRequests);
+  }
+  eventLoopData->concurrencyLimit = limit;
+
+  eventLoopData->previousThroughput = throughput;
+  eventLoopData->windowRequests = 0;
+  eventLoopData->windowRetries = 0;
+  eventLoopData->windowBytes = 0;
+  eventLoopData->windowLatency = 0.0;
+  eventLoopData->windowSaturated = !eventLoopData->queuedRequests.empty();
+  eventLoopData->windowStart = now;
+}
+
+static void curlEasySetSharedOptions(UVEventLoopData *eventLoopData, CURL *curlEasy)
+{
+  curl_easy_setopt(curlEasy, CURLOPT_SHARE, eventLoopData->curlShare);
+  if (eventLoopData->http2Multiplexing)
+  {
+    // Prefer multiplexing over an existing HTTP/2 connection to opening a new one
+    curl_easy_setopt(curlEasy, CURLOPT_HTTP_VERSION, long(CURL_HTTP_VERSION_2TLS));
+    curl_easy_setopt(curlEasy, CURLOPT_PIPEWAIT, 1L);
+  }
+  else
+  {
+    curl_easy_setopt(curlEasy, CURLOPT_HTTP_VERSION, long(CURL_HTTP_VERSION_1_1));
+  }
+  curl_easy_setopt(curlEasy, CURLOPT_TCP_NODELAY, 1L);
+  curl_easy_setopt(curlEasy, CURLOPT_TCP_KEEPALIVE, eventLoopData->tcpKeepAlive ? 1L : 0L);
+  if (eventLoopData->receiveBufferSize > 0)
+  {
+    curl_easy_setopt(curlEasy, CURLOPT_BUFFERSIZE, long(eventLoopData->receiveBufferSize));
+  }
+}
+
+static CURL *curlEasyAcquire(UVEventLoopData *eventLoopData)
+{
+  CURL *curlEasy;
+  if (eventLoopData->idleEasyHandles.empty())
+  {
+    curlEasy = curl_easy_init();
+  }
+  else
+  {
+    curlEasy = eventLoopData->idleEasyHandles.back();
+    eventLoopData->idleEasyHandles.pop_back();
+  }
+  curlEasySetSharedOptions(eventLoopData, curlEasy);
+  return curlEasy;
+}
+
+static void curlEasyRelease(UVEventLoopData *eventLoopData, CurlEasyHandler *handler)
+{
+  if (handler->curlEasy)
+  {
+    if (int(eventLoopData->idleEasyHandles.size()) < eventLoopData->maxConcurrentRequests)
+    {
+      curl_easy_reset(handler->curlEasy);
+      eventLoopData->idleEasyHandles.push_back(handler->curlEasy);
+    }
+    else
+    {
+      curl_easy_cleanup(handler->curlEasy);
+    }
+    handler->curlEasy = nullptr;
+  }
+  curl_slist_free_all(handler->headerList);
+  handler->headerList = nullptr;
+}
+
+static void curlEasyRetry(UVEventLoopData *eventLoopData, CurlEasyHandler *handler)
+{
+  eventLoopData->windowRetries++;
+  curl_multi_remove_handle(eventLoopData->curlMulti, handler->curlEasy);
+
+  CURL* dup = curl_easy_duphandle(handler->curlEasy);
+  curl_easy_cleanup(handler->curlEasy);
+  curl_easy_setopt(dup, CURLOPT_SHARE, eventLoopData->curlShare);
+  handler->curlEasy = dup;
+  curl_multi_add_handle(eventLoopData->curlMulti, dup);
 }
 
 static int curl_easy_debug_callback(CURL* handle, curl_infotype type, char* data, size_t size, void* userptr)
@@ -165,17 +288,16 @@ static void addDownloadCB(uv_async_t *handle)
   }
   for (auto &downloadRequest : downloadRequests)
   {
-    downloadRequest->curlEasy = curl_easy_init();
+    downloadRequest->curlEasy = curlEasyAcquire(eventLoopData);
     CurlEasyHandler *context = downloadRequest.get();
 
     if (downloadRequest->headers.size())
     {
-      curl_slist *headers = nullptr;
       for (auto &header : downloadRequest->headers)
       {
-        headers = curl_slist_append(headers, header.c_str());
+        downloadRequest->headerList = curl_slist_append(downloadRequest->headerList, header.c_str());
       }
-      curl_easy_setopt(downloadRequest->curlEasy, CURLOPT_HTTPHEADER, headers);
+      curl_easy_setopt(downloadRequest->curlEasy, CURLOPT_HTTPHEADER, downloadRequest->headerList);
     }
 
     curl_easy_setopt(downloadRequest->curlEasy, CURLOPT_PRIVATE, context);
@@ -235,7 +357,7 @@ static void cancelledDownloadCB(uv_async_t *handle)
         curl_multi_remove_handle(eventLoopData->curlMulti, cancelled->curlEasy);
       }
     }
-    curl_easy_cleanup(cancelled->curlEasy);
+    curlEasyRelease(eventLoopData, cancelled.get());
     auto req = cancelled->request.lock();
     if (req)
     {
@@ -259,17 +381,16 @@ static void addUploadCB(uv_async_t *handle)
   }
   for (auto &uploadRequest : uploadRequests)
   {
-    uploadRequest->curlEasy = curl_easy_init();
+    uploadRequest->curlEasy = curlEasyAcquire(eventLoopData);
     CurlEasyHandler *context = uploadRequest.get();
 
     if (uploadRequest->headers.size())
     {
-      curl_slist *headers = nullptr;
       for (auto &header : uploadRequest->headers)
       {
-        headers = curl_slist_append(headers, header.c_str());
+        uploadRequest->headerList = curl_slist_append(uploadRequest->headerList, header.c_str());
       }
-      curl_easy_setopt(uploadRequest->curlEasy, CURLOPT_HTTPHEADER, headers);
+      curl_easy_setopt(uploadRequest->curlEasy, CURLOPT_HTTPHEADER, uploadRequest->headerList);
     }
 
     curl_easy_setopt(uploadRequest->curlEasy, CURLOPT_PRIVATE, context);
@@ -338,7 +459,7 @@ static void cancelledUploadCB(uv_async_t *handle)
         curl_multi_remove_handle(eventLoopData->curlMulti, cancelled->curlEasy);
       }
     }
-    curl_easy_cleanup(cancelled->curlEasy);
+    curlEasyRelease(eventLoopData, cancelled.get());
     auto req = cancelled->request.lock();
     if (req)
     {
@@ -411,12 +532,7 @@ static void beforeBlockCB(uv_prepare_t *handle)
             if (socketContext->shouldRetry())
             {
               fmt::print(stderr, "CURL respons error {}. Automatic rety {}", responseCode, url);
-              curl_multi_remove_handle(eventLoopData->curlMulti, socketContext->curlEasy);
-
-              CURL* dup = curl_easy_duphandle(socketContext->curlEasy);
-              curl_easy_cleanup(socketContext->curlEasy);
-              socketContext->curlEasy = dup;
-              curl_multi_add_handle(eventLoopData->curlMulti, dup);
+              curlEasyRetry(eventLoopData, socketContext);
               continue;
             }
             else
@@ -441,12 +557,7 @@ static void beforeBlockCB(uv_prepare_t *handle)
         char* url = NULL;
         curl_easy_getinfo(socketContext->curlEasy, CURLINFO_EFFECTIVE_URL, &url);
         fmt::print(stderr, "CURL timeout. Automatic rety {}", url);
-        curl_multi_remove_handle(eventLoopData->curlMulti, socketContext->curlEasy);
-
-        CURL* dup = curl_easy_duphandle(socketContext->curlEasy);
-        curl_easy_cleanup(socketContext->curlEasy);
-        socketContext->curlEasy = dup;
-        curl_multi_add_handle(eventLoopData->curlMulti, dup);
+        curlEasyRetry(eventLoopData, socketContext);
         continue;
       }
       else
@@ -456,10 +567,10 @@ static void beforeBlockCB(uv_prepare_t *handle)
       }
 
       socketContext->handleDone(responseCode, error);
+      curlAdjustConcurrency(eventLoopData, easy_handle);
 
       curl_multi_remove_handle(eventLoopData->curlMulti, easy_handle);
-      curl_easy_cleanup(easy_handle);
-      socketContext->curlEasy = nullptr;
+      curlEasyRelease(eventLoopData, socketContext);
       to_remove.push_back(socketContext);
       break;
     }
@@ -786,8 +897,24 @@ struct Barrier
   std::condition_variable wait;
 };
 
-CurlHandler::CurlHandler(Error& error)
-{
+CurlHandler::CurlHandler(const OpenOptions &options, Error& error)
+{
+  m_eventLoopData.maxConcurrentRequests = std::max(options.maxConcurrentRequests, 1);
+  m_eventLoopData.maxConnectionsPerHost = options.maxConnectionsPerHost;
+  m_eventLoopData.http2Multiplexing = options.http2Multiplexing;
+  m_eventLoopData.tcpKeepAlive = options.tcpKeepAlive;
+  m_eventLoopData.receiveBufferSize = options.receiveBufferSize;
+  m_eventLoopData.adaptiveConcurrency = options.adaptiveConcurrency;
+  m_eventLoopData.concurrencyLimit = options.adaptiveConcurrency ? std::min(initialAdaptiveConcurrency, m_eventLoopData.maxConcurrentRequests) : m_eventLoopData.maxConcurrentRequests;
+  m_eventLoopData.windowRequests = 0;
+  m_eventLoopData.windowRetries = 0;
+  m_eventLoopData.windowBytes = 0;
+  m_eventLoopData.windowLatency = 0.0;
+  m_eventLoopData.windowSaturated = false;
+  m_eventLoopData.windowStart = std::chrono::steady_clock::now();
+  m_eventLoopData.previousThroughput = 0.0;
+  m_eventLoopData.baselineLatency = 0.0;
+
   error.code = curl_global_init(CURL_GLOBAL_ALL);
   if (error.code)
   {
@@ -818,7 +945,18 @@ CurlHandler::CurlHandler(Error& error)
     uv_async_init(m_eventLoopData.loop, &m_eventLoopData.asyncCancelledUpload, &cancelledUploadCB);
     m_eventLoopData.asyncCancelledUpload.data = &m_eventLoopData;
 
+    m_eventLoopData.curlShare = curl_share_init();
+    curl_share_setopt(m_eventLoopData.curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(m_eventLoopData.curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
     m_eventLoopData.curlMulti = curl_multi_init();
+    curl_multi_setopt(m_eventLoopData.curlMulti, CURLMOPT_PIPELINING, m_eventLoopData.http2Multiplexing ? long(CURLPIPE_MULTIPLEX) : long(CURLPIPE_NOTHING));
+    // The default connection cache shrinks with the number of active transfers, keep enough idle connections for the next batch of requests
+    curl_multi_setopt(m_eventLoopData.curlMulti, CURLMOPT_MAXCONNECTS, long(m_eventLoopData.maxConcurrentRequests));
+    if (m_eventLoopData.maxConnectionsPerHost > 0)
+    {
+      curl_multi_setopt(m_eventLoopData.curlMulti, CURLMOPT_MAX_HOST_CONNECTIONS, long(m_eventLoopData.maxConnectionsPerHost));
+    }
     curl_multi_setopt(m_eventLoopData.curlMulti, CURLMOPT_SOCKETFUNCTION, curlSocketCB);
     curl_multi_setopt(m_eventLoopData.curlMulti, CURLMOPT_SOCKETDATA, &m_eventLoopData);
     curl_multi_setopt(m_eventLoopData.curlMulti, CURLMOPT_TIMERFUNCTION, curlTimerCallback);
@@ -838,6 +976,12 @@ CurlHandler::CurlHandler(Error& error)
     uv_run(m_eventLoopData.loop, UV_RUN_DEFAULT);
 
     curl_multi_cleanup(m_eventLoopData.curlMulti);
+    for (CURL *curlEasy : m_eventLoopData.idleEasyHandles)
+    {
+      curl_easy_cleanup(curlEasy);
+    }
+    m_eventLoopData.idleEasyHandles.clear();
+    curl_share_cleanup(m_eventLoopData.curlShare);
 
 #if UV_VERSION_MAJOR < 1
     uv_loop_delete(m_eventLoopData.loop);
@@ -30,6 +30,7 @@
 #include <deque>
 #include <condition_variable>
 #include <functional>
+#include <chrono>
 
 #undef WIN32_LEAN_AND_MEAN // avoid warnings if defined on command line
 #define WIN32_LEAN_AND_MEAN
@@ -48,12 +49,14 @@ struct CurlEasyHandler
   CurlEasyHandler(UVEventLoopData *eventLoopData)
     : eventLoopData(eventLoopData)
     , curlEasy(nullptr)
+    , headerList(nullptr)
     , retry_count(0)
   {}
   virtual ~CurlEasyHandler() {}
 
   UVEventLoopData *eventLoopData;
   CURL* curlEasy;
+  curl_slist *headerList;
   int retry_count;
   
   bool shouldRetry();
@@ -169,9 +172,37 @@ struct UVEventLoopData
   std::vector<std::shared_ptr<CurlUploadHandler>> incommingUploadRequests;
   std::vector<std::shared_ptr<CurlUploadHandler>> cancelledUploads;
 
-  std::vector<std::shared_ptr<CurlEasyHandler>> queuedRequests;
+  std::deque<std::shared_ptr<CurlEasyHandler>> queuedRequests;
   std::vector<std::shared_ptr<CurlEasyHandler>> processingRequests;
 
+  // Easy handles are reset and reused, and the DNS cache and TLS sessions are shared
+  // between them, so the many small requests of a volume read don't pay for setting up
+  // a handle (or a TLS handshake without session resumption) every time.
+  std::vector<CURL *> idleEasyHandles;
+  CURLSH *curlShare;
+
+  int maxConcurrentRequests;
+  int maxConnectionsPerHost;
+  bool http2Multiplexing;
+  bool tcpKeepAlive;
+  int receiveBufferSize;
+
+  // With adaptive concurrency the number of requests in flight is tuned with AIMD. A
+  // window of observations is collected for roughly one round of requests, then the
+  // limit is raised by one if the queue was backed up and the connection kept up, or
+  // halved if requests had to be retried or the latency grew without any gain in
+  // throughput.
+  bool adaptiveConcurrency;
+  std::atomic<int> concurrencyLimit;
+  int windowRequests;
+  int windowRetries;
+  int64_t windowBytes;
+  double windowLatency;
+  bool windowSaturated;
+  std::chrono::steady_clock::time_point windowStart;
+  double previousThroughput;
+  double baselineLatency;
+
   std::mutex mutex;
   
   uv_async_t asyncAddDownload;
@@ -188,9 +219,11 @@ struct UVEventLoopData
 class CurlHandler
 {
 public:
-  CurlHandler(Error& error);
+  CurlHandler(const OpenOptions &options, Error& error);
   ~CurlHandler();
 
+  int getConcurrencyLimit() const { return m_eventLoopData.concurrencyLimit; }
+
   void addDownloadRequest(const std::shared_ptr<DownloadRequestCurl>& request, const std::string& url, const std::vector<std::string>& headers, std::function<std::string(const std::string &date)> toISO8601DateTransformer, CurlDownloadHandler::Verb verb);
   void addUploadRequest(const std::shared_ptr<UploadRequestCurl>& request, const std::string& url, const std::vector<std::string>& headers, const std::shared_ptr<std::vector<uint8_t>> &data)
   {
@@ -0,0 +1,585 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include "IOManagerDiskCache.h"
+#include "IOManagerRequestImpl.h"
+
+#include <VDS/Hash.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <direct.h>
+#include <process.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace OpenVDS
+{
+
+static const char g_entryMagic[4] = { 'V', 'D', 'S', 'C' };
+static const uint32_t g_entryVersion = 2;
+static const char g_entryExtension[] = ".entry";
+static const char g_temporaryExtension[] = ".tmp";
+
+// A temporary file that hasn't been renamed into place after this long was left by a process that died while writing it
+static const int64_t g_staleTemporaryFileSeconds = 3600;
+
+struct CacheFileInfo
+{
+  std::string path;
+  int64_t     size;
+  int64_t     lastWriteTime;
+};
+
+#ifdef _WIN32
+static bool CreateCacheDirectory(const std::string &path)
+{
+  return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+}
+
+static void TouchCacheFile(const std::string &path)
+{
+  _utime(path.c_str(), nullptr);
+}
+
+static bool RemoveCacheDirectory(const std::string &path)
+{
+  return _rmdir(path.c_str()) == 0;
+}
+
+static int GetProcessId()
+{
+  return _getpid();
+}
+
+// The last write time of a file written before this time, in the unit ListCacheFiles uses
+static int64_t GetLastWriteTimeBefore(int64_t seconds)
+{
+  FILETIME fileTime;
+  GetSystemTimeAsFileTime(&fileTime);
+  return ((int64_t(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime) - seconds * 10000000;
+}
+
+static std::vector<CacheFileInfo> ListCacheFiles(const std::string &path, const char *extension)
+{
+  std::vector<CacheFileInfo> files;
+  WIN32_FIND_DATAA findData;
+  HANDLE findHandle = FindFirstFileA((path + "\\*" + extension).c_str(), &findData);
+  if (findHandle == INVALID_HANDLE_VALUE)
+    return files;
+  do
+  {
+    if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+      continue;
+    CacheFileInfo info;
+    info.path = path + "/" + findData.cFileName;
+    info.size = (int64_t(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+    info.lastWriteTime = (int64_t(findData.ftLastWriteTime.dwHighDateTime) << 32) | findData.ftLastWriteTime.dwLowDateTime;
+    files.push_back(info);
+  } while (FindNextFileA(findHandle, &findData));
+  FindClose(findHandle);
+  return files;
+}
+#else
+static bool CreateCacheDirectory(const std::string &path)
+{
+  return mkdir(path.c_str(), 0777) == 0 || errno == EEXIST;
+}
+
+static void TouchCacheFile(const std::string &path)
+{
+  utime(path.c_str(), nullptr);
+}
+
+static bool RemoveCacheDirectory(const std::string &path)
+{
+  return rmdir(path.c_str()) == 0;
+}
+
+static int GetProcessId()
+{
+  return int(getpid());
+}
+
+// The last write time of a file written before this time, in the unit ListCacheFiles uses
+static int64_t GetLastWriteTimeBefore(int64_t seconds)
+{
+  return int64_t(time(nullptr)) - seconds;
+}
+
+static std::vector<CacheFileInfo> ListCacheFiles(const std::string &path, const char *extension)
+{
+  std::vector<CacheFileInfo> files;
+  DIR *dir = opendir(path.c_str());
+  if (!dir)
+    return files;
+  const size_t extensionLength = strlen(extension);
+  while (dirent *dirEntry = readdir(dir))
+  {
+    size_t nameLength = strlen(dirEntry->d_name);
+    if (nameLength <= extensionLength || strcmp(dirEntry->d_name + nameLength - extensionLength, extension) != 0)
+      continue;
+    CacheFileInfo info;
+    info.path = path + "/" + dirEntry->d_name;
+    struct stat fileStat;
+    if (stat(info.path.c_str(), &fileStat) != 0)
+      continue;
+    info.size = int64_t(fileStat.st_size);
+    info.lastWriteTime = int64_t(fileStat.st_mtime);
+    files.push_back(info);
+  }
+  closedir(dir);
+  return files;
+}
+#endif
+
+static void WriteString(std::vector<uint8_t> &buffer, const std::string &str)
+{
+  uint32_t size = uint32_t(str.size());
+  buffer.insert(buffer.end(), reinterpret_cast<const uint8_t *>(&size), reinterpret_cast<const uint8_t *>(&size) + sizeof(size));
+  buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+static bool ReadString(const std::vector<uint8_t> &buffer, size_t &pos, std::string &str)
+{
+  uint32_t size;
+  if (pos + sizeof(size) > buffer.size())
+    return false;
+  memcpy(&size, buffer.data() + pos, sizeof(size));
+  pos += sizeof(size);
+  if (pos + size > buffer.size())
+    return false;
+  str.assign(reinterpret_cast<const char *>(buffer.data() + pos), size);
+  pos += size;
+  return true;
+}
+
+static bool ReadFile(const std::string &path, std::vector<uint8_t> &data)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  bool success = fseek(file, 0, SEEK_END) == 0;
+  long size = success ? ftell(file) : -1;
+  success = size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+  if (success)
+  {
+    data.resize(size_t(size));
+    success = data.empty() || fread(data.data(), 1, data.size(), file) == data.size();
+  }
+  fclose(file);
+  return success;
+}
+
+class DiskCacheTransferHandler : public TransferDownloadHandler
+{
+public:
+  DiskCacheTransferHandler(IOManagerDiskCache *diskCache, const std::string &objectName, const std::string &key, std::shared_ptr<TransferDownloadHandler> handler)
+    : m_diskCache(diskCache)
+    , m_objectName(objectName)
+    , m_key(key)
+    , m_handler(handler)
+  {
+    m_entry.version = handler->ExpectedVersion();
+    m_entry.objectSize = 0;
+  }
+
+  void HandleObjectSize(int64_t size) override
+  {
+    m_entry.objectSize = size;
+    m_handler->HandleObjectSize(size);
+  }
+  void HandleObjectLastWriteTime(const std::string &lastWriteTimeISO8601) override
+  {
+    m_entry.lastWriteTime = lastWriteTimeISO8601;
+    m_handler->HandleObjectLastWriteTime(lastWriteTimeISO8601);
+  }
+  void HandleMetadata(const std::string &key, const std::string &header) override
+  {
+    m_entry.metadata.emplace_back(key, header);
+    m_handler->HandleMetadata(key, header);
+  }
+  void HandleData(std::vector<uint8_t> &&data) override
+  {
+    m_entry.data = data;
+    m_handler->HandleData(std::move(data));
+  }
+  void Completed(const Request &request, const Error &error) override
+  {
+    if (error.code == 0)
+    {
+      if (m_key.empty())
+        m_diskCache->SetDatasetObject(m_objectName, m_entry.data);
+      else
+        m_diskCache->StoreEntry(m_key, m_entry);
+    }
+    m_handler->Completed(request, error);
+  }
+  std::string ExpectedVersion() const override
+  {
+    return m_entry.version;
+  }
+
+private:
+  IOManagerDiskCache *m_diskCache;
+  std::string m_objectName;
+  std::string m_key;
+  std::shared_ptr<TransferDownloadHandler> m_handler;
+  IOManagerDiskCache::Entry m_entry;
+};
+
+IOManagerDiskCache::IOManagerDiskCache(IOManager *backend, const std::string &datasetIdentity, const std::string &cachePath, int64_t maxCacheSize, Error &error)
+  : IOManager(backend->connectionType())
+  , m_backend(backend)
+  , m_datasetIdentity(datasetIdentity)
+  , m_cachePath(cachePath)
+  , m_maxCacheSize(maxCacheSize)
+  , m_volumeDataLayoutHash(0)
+  , m_layerStatusHash(0)
+  , m_hasWritten(false)
+  , m_pendingCachedReads(0)
+  , m_cacheSize(0)
+  , m_hits(0)
+  , m_misses(0)
+  , m_staleEntries(0)
+  , m_temporaryFileCount(0)
+  , m_threadPool(4)
+{
+  if (!CreateCacheDirectory(m_cachePath))
+  {
+    error.code = -1;
+    error.string = fmt::format("Failed to create disk cache directory {}", m_cachePath);
+    return;
+  }
+
+  RemoveStaleTemporaryFiles();
+
+  for (auto &file : ListCacheFiles(m_cachePath, g_entryExtension))
+  {
+    m_cacheSize += file.size;
+  }
+
+  // The directory may have been filled with a larger limit
+  if (m_cacheSize > m_maxCacheSize)
+    LimitCacheSize();
+}
+
+IOManagerDiskCache::~IOManagerDiskCache()
+{
+  // Cached reads run on the thread pool and fall back to the backend if the entry is gone or stale, so they have to
+  // finish before the backend is destroyed. Destroying the backend waits for its outstanding requests, and those can
+  // still store entries from the thread pool, so the thread pool (the last member) is destroyed after the backend.
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pendingCachedReadsCondition.wait(lock, [this]{ return m_pendingCachedReads == 0; });
+  }
+  m_backend.reset();
+}
+
+bool IOManagerDiskCache::RemoveCache(const std::string &cachePath)
+{
+  bool success = true;
+  for (const char *extension : { g_entryExtension, g_temporaryExtension })
+  {
+    for (auto &file : ListCacheFiles(cachePath, extension))
+    {
+      success = remove(file.path.c_str()) == 0 && success;
+    }
+  }
+  return RemoveCacheDirectory(cachePath) && success;
+}
+
+std::string IOManagerDiskCache::GetEntryPath(const std::string &key) const
+{
+  return fmt::format("{}/{:016x}{}", m_cachePath, uint64_t(HashCombiner(key)), g_entryExtension);
+}
+
+void IOManagerDiskCache::SetDatasetObject(const std::string &objectName, const std::vector<uint8_t> &data)
+{
+  uint64_t hash = HashCombiner(std::string(data.begin(), data.end()));
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (objectName == "VolumeDataLayout")
+    m_volumeDataLayoutHash = hash;
+  else
+    m_layerStatusHash = hash;
+}
+
+bool IOManagerDiskCache::LoadEntry(const std::string &key, Entry &entry)
+{
+  std::string path = GetEntryPath(key);
+  std::vector<uint8_t> buffer;
+  if (!ReadFile(path, buffer))
+    return false;
+
+  size_t pos = 0;
+  uint32_t version;
+  if (buffer.size() < sizeof(g_entryMagic) + sizeof(version) || memcmp(buffer.data(), g_entryMagic, sizeof(g_entryMagic)) != 0)
+    return false;
+  pos += sizeof(g_entryMagic);
+  memcpy(&version, buffer.data() + pos, sizeof(version));
+  pos += sizeof(version);
+  if (version != g_entryVersion)
+    return false;
+
+  // The file name is a hash of the key, so the key is stored to rule out collisions
+  std::string storedKey;
+  if (!ReadString(buffer, pos, storedKey) || storedKey != key)
+    return false;
+
+  if (!ReadString(buffer, pos, entry.version))
+    return false;
+
+  uint32_t metadataCount;
+  if (pos + sizeof(entry.objectSize) + sizeof(metadataCount) > buffer.size())
+    return false;
+  memcpy(&entry.objectSize, buffer.data() + pos, sizeof(entry.objectSize));
+  pos += sizeof(entry.objectSize);
+  if (!ReadString(buffer, pos, entry.lastWriteTime))
+    return false;
+  if (pos + sizeof(metadataCount) > buffer.size())
+    return false;
+  memcpy(&metadataCount, buffer.data() + pos, sizeof(metadataCount));
+  pos += sizeof(metadataCount);
+  entry.metadata.resize(metadataCount);
+  for (auto &metadata : entry.metadata)
+  {
+    if (!ReadString(buffer, pos, metadata.first) || !ReadString(buffer, pos, metadata.second))
+      return false;
+  }
+  entry.data.assign(buffer.begin() + pos, buffer.end());
+
+  TouchCacheFile(path);
+  return true;
+}
+
+void IOManagerDiskCache::StoreEntry(const std::string &key, const Entry &entry)
+{
+  auto buffer = std::make_shared<std::vector<uint8_t>>();
+  buffer->reserve(entry.data.size() + 256);
+  buffer->insert(buffer->end(), g_entryMagic, g_entryMagic + sizeof(g_entryMagic));
+  buffer->insert(buffer->end(), reinterpret_cast<const uint8_t *>(&g_entryVersion), reinterpret_cast<const uint8_t *>(&g_entryVersion) + sizeof(g_entryVersion));
+  WriteString(*buffer, key);
+  WriteString(*buffer, entry.version);
+  buffer->insert(buffer->end(), reinterpret_cast<const uint8_t *>(&entry.objectSize), reinterpret_cast<const uint8_t *>(&entry.objectSize) + sizeof(entry.objectSize));
+  WriteString(*buffer, entry.lastWriteTime);
+  uint32_t metadataCount = uint32_t(entry.metadata.size());
+  buffer->insert(buffer->end(), reinterpret_cast<const uint8_t *>(&metadataCount), reinterpret_cast<const uint8_t *>(&metadataCount) + sizeof(metadataCount));
+  for (auto &metadata : entry.metadata)
+  {
+    WriteString(*buffer, metadata.first);
+    WriteString(*buffer, metadata.second);
+  }
+  buffer->insert(buffer->end(), entry.data.begin(), entry.data.end());
+
+  // Write the file from the thread pool so the IO thread of the backend can move on
+  std::string path = GetEntryPath(key);
+  std::string temporaryPath = fmt::format("{}.{}.{}{}", path, GetProcessId(), m_temporaryFileCount++, g_temporaryExtension);
+  m_threadPool.Enqueue([this, buffer, path, temporaryPath]
+    {
+      FILE *file = fopen(temporaryPath.c_str(), "wb");
+      if (!file)
+        return;
+      bool success = fwrite(buffer->data(), 1, buffer->size(), file) == buffer->size();
+      success = fclose(file) == 0 && success;
+
+      // Writing to a temporary file and renaming it means other processes never see a partial entry
+      if (success && rename(temporaryPath.c_str(), path.c_str()) != 0)
+      {
+        remove(path.c_str());
+        success = rename(temporaryPath.c_str(), path.c_str()) == 0;
+      }
+      if (!success)
+      {
+        remove(temporaryPath.c_str());
+        return;
+      }
+
+      m_cacheSize += int64_t(buffer->size());
+      if (m_cacheSize > m_maxCacheSize)
+        LimitCacheSize();
+    });
+}
+
+void IOManagerDiskCache::RemoveEntry(const std::string &key)
+{
+  std::string path = GetEntryPath(key);
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return;
+  long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+  fclose(file);
+  if (remove(path.c_str()) == 0 && size > 0)
+    m_cacheSize -= int64_t(size);
+}
+
+void IOManagerDiskCache::RemoveStaleTemporaryFiles()
+{
+  // Temporary files of other processes that are still writing them are younger than this
+  int64_t staleTime = GetLastWriteTimeBefore(g_staleTemporaryFileSeconds);
+  for (auto &file : ListCacheFiles(m_cachePath, g_temporaryExtension))
+  {
+    if (file.lastWriteTime < staleTime)
+      remove(file.path.c_str());
+  }
+}
+
+void IOManagerDiskCache::LimitCacheSize()
+{
+  RemoveStaleTemporaryFiles();
+
+  // The directory can be shared with other processes, so the files on disk are the only reliable size and age
+  std::vector<CacheFileInfo> files = ListCacheFiles(m_cachePath, g_entryExtension);
+  std::sort(files.begin(), files.end(), [](const CacheFileInfo &a, const CacheFileInfo &b) { return a.lastWriteTime < b.lastWriteTime; });
+
+  int64_t size = 0;
+  for (auto &file : files)
+    size += file.size;
+
+  // Evict down to 90% of the limit so every insert doesn't have to scan the directory
+  int64_t targetSize = m_maxCacheSize - m_maxCacheSize / 10;
+  for (auto &file : files)
+  {
+    if (size <= targetSize)
+      break;
+    if (remove(file.path.c_str()) == 0)
+      size -= file.size;
+  }
+  m_cacheSize = size;
+}
+
+std::shared_ptr<Request> IOManagerDiskCache::ReadObjectInfo(const std::string &objectName, std::shared_ptr<TransferDownloadHandler> handler)
+{
+  return m_backend->ReadObjectInfo(objectName, handler);
+}
+
+std::shared_ptr<Request> IOManagerDiskCache::ReadObject(const std::string &objectName, std::shared_ptr<TransferDownloadHandler> handler, const IORange &range)
+{
+  // These objects identify the dataset, they are always read from the backend
+  if (objectName == "VolumeDataLayout" || objectName == "LayerStatus")
+  {
+    return m_backend->ReadObject(objectName, std::make_shared<DiskCacheTransferHandler>(this, objectName, std::string(), handler), range);
+  }
+
+  // The chunk metadata pages hold the hashes the chunks are validated against, so they always come from the backend
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_hasWritten || !m_volumeDataLayoutHash || !m_layerStatusHash || objectName.find("/ChunkMetadata/") != std::string::npos)
+  {
+    lock.unlock();
+    return m_backend->ReadObject(objectName, handler, range);
+  }
+  std::string key = fmt::format("{}/{:016x}{:016x}/{}/{}-{}", m_datasetIdentity, m_volumeDataLayoutHash, m_layerStatusHash, objectName, range.start, range.end);
+  lock.unlock();
+
+  std::string path = GetEntryPath(key);
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+  {
+    m_misses++;
+    return m_backend->ReadObject(objectName, std::make_shared<DiskCacheTransferHandler>(this, objectName, key, handler), range);
+  }
+  fclose(file);
+
+  // Cache hits are delivered from the thread pool since the caller may hold locks the handler needs
+  auto request = std::make_shared<RequestImpl>(objectName);
+  std::string version = handler->ExpectedVersion();
+  lock.lock();
+  m_pendingCachedReads++;
+  lock.unlock();
+  m_threadPool.Enqueue([this, objectName, key, version, handler, request, range]
+    {
+      ReadCachedObject(objectName, key, version, handler, request, range);
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (--m_pendingCachedReads == 0)
+        m_pendingCachedReadsCondition.notify_all();
+    });
+  std::shared_ptr<Request> retRequest = request;
+  return retRequest;
+}
+
+void IOManagerDiskCache::ReadCachedObject(const std::string &objectName, const std::string &key, const std::string &version, std::shared_ptr<TransferDownloadHandler> handler, std::shared_ptr<RequestImpl> request, const IORange &range)
+{
+  Entry entry;
+  bool isLoaded = LoadEntry(key, entry);
+  if (isLoaded && entry.version != version)
+  {
+    // The object has been rewritten since it was cached
+    m_staleEntries++;
+    RemoveEntry(key);
+    isLoaded = false;
+  }
+
+  if (!isLoaded)
+  {
+    // Stale, or evicted by another process after we checked, read it from the backend
+    m_misses++;
+    auto backendRequest = m_backend->ReadObject(objectName, std::make_shared<DiskCacheTransferHandler>(this, objectName, key, handler), range);
+    Error error;
+    backendRequest->WaitForFinish(error);
+    RequestStateHandler requestStateHandler(*request);
+    request->m_error = error;
+    return;
+  }
+
+  m_hits++;
+  RequestStateHandler requestStateHandler(*request);
+  if (requestStateHandler.isCancelledRequested())
+  {
+    return;
+  }
+  handler->HandleObjectSize(entry.objectSize);
+  if (!entry.lastWriteTime.empty())
+  {
+    handler->HandleObjectLastWriteTime(entry.lastWriteTime);
+  }
+  for (auto &metadata : entry.metadata)
+  {
+    handler->HandleMetadata(metadata.first, metadata.second);
+  }
+  handler->HandleData(std::move(entry.data));
+  handler->Completed(*request, Error());
+}
+
+std::shared_ptr<Request> IOManagerDiskCache::WriteObject(const std::string &objectName, const std::string &contentDispostionFilename, const std::string &contentType, const std::vector<std::pair<std::string, std::string>> &metadataHeader, std::shared_ptr<std::vector<uint8_t>> data, std::function<void(const Request &request, const Error &error)> completedCallback)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_hasWritten = true;
+  }
+  return m_backend->WriteObject(objectName, contentDispostionFilename, contentType, metadataHeader, data, completedCallback);
+}
+
+}
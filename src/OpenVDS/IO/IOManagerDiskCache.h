@@ -0,0 +1,113 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef IOMANAGERDISKCACHE_H
+#define IOMANAGERDISKCACHE_H
+
+#include "IOManager.h"
+#include <VDS/ThreadPool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace OpenVDS
+{
+  class RequestImpl;
+
+  // Local disk cache in front of another IOManager. Chunks read through it are stored as
+  // one file each in the cache directory and served from there the next time they are
+  // read.
+  //
+  // Entries are keyed by the identity of the dataset (e.g. the bucket and prefix) and a
+  // hash of its VolumeDataLayout and LayerStatus objects. Each entry also stores the
+  // version the reader expected when it was downloaded (for chunks this is the chunk
+  // metadata with the chunk hash), and an entry with a different version than the reader
+  // expects now is deleted and read from the backend again. The chunk metadata pages are
+  // never cached since they are what the chunks are checked against. Until the
+  // VolumeDataLayout and LayerStatus objects have been read, and after anything has been
+  // written, everything goes straight to the backend.
+  //
+  // Several processes can share one cache directory: entries are written to a temporary
+  // file and renamed into place, and the least recently used entries (by modification
+  // time, which is updated on every hit) are deleted when the directory grows beyond the
+  // size limit. Temporary files left behind by a process that died while writing are
+  // deleted when they are old.
+  class IOManagerDiskCache : public IOManager
+  {
+  public:
+    IOManagerDiskCache(IOManager *backend, const std::string &datasetIdentity, const std::string &cachePath, int64_t maxCacheSize, Error &error);
+    ~IOManagerDiskCache() override;
+
+    std::shared_ptr<Request> ReadObjectInfo(const std::string &objectName, std::shared_ptr<TransferDownloadHandler> handler) override;
+    std::shared_ptr<Request> ReadObject(const std::string &objectName, std::shared_ptr<TransferDownloadHandler> handler, const IORange& range = IORange()) override;
+    std::shared_ptr<Request> WriteObject(const std::string &objectName, const std::string& contentDispostionFilename, const std::string& contentType, const std::vector<std::pair<std::string, std::string>>& metadataHeader, std::shared_ptr<std::vector<uint8_t>> data, std::function<void(const Request & request, const Error & error)> completedCallback = nullptr) override;
+
+    int64_t GetHitCount() const { return m_hits; }
+    int64_t GetMissCount() const { return m_misses; }
+    int64_t GetStaleCount() const { return m_staleEntries; }
+    int64_t GetCacheSize() const { return m_cacheSize; }
+
+    struct Entry
+    {
+      std::string version;
+      int64_t objectSize;
+      std::string lastWriteTime;
+      std::vector<std::pair<std::string, std::string>> metadata;
+      std::vector<uint8_t> data;
+    };
+
+    void StoreEntry(const std::string &key, const Entry &entry);
+    void SetDatasetObject(const std::string &objectName, const std::vector<uint8_t> &data);
+
+    // Deletes the entries and temporary files in a cache directory and then the directory
+    static bool RemoveCache(const std::string &cachePath);
+
+  private:
+    std::string GetEntryPath(const std::string &key) const;
+    bool LoadEntry(const std::string &key, Entry &entry);
+    void RemoveEntry(const std::string &key);
+    void ReadCachedObject(const std::string &objectName, const std::string &key, const std::string &version, std::shared_ptr<TransferDownloadHandler> handler, std::shared_ptr<RequestImpl> request, const IORange &range);
+    void RemoveStaleTemporaryFiles();
+    void LimitCacheSize();
+
+    std::unique_ptr<IOManager> m_backend;
+    std::string m_datasetIdentity;
+    std::string m_cachePath;
+    int64_t m_maxCacheSize;
+
+    std::mutex m_mutex;
+    uint64_t m_volumeDataLayoutHash;
+    uint64_t m_layerStatusHash;
+    bool m_hasWritten;
+    int m_pendingCachedReads;
+    std::condition_variable m_pendingCachedReadsCondition;
+
+    std::atomic<int64_t> m_cacheSize;
+    std::atomic<int64_t> m_hits;
+    std::atomic<int64_t> m_misses;
+    std::atomic<int64_t> m_staleEntries;
+    std::atomic<int64_t> m_temporaryFileCount;
+
+    ThreadPool m_threadPool;
+  };
+}
+
+#endif //IOMANAGERDISKCACHE_H
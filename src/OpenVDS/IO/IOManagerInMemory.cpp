@@ -3,6 +3,8 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+
 namespace OpenVDS
 {
 
@@ -57,7 +59,7 @@ std::shared_ptr<Request> IOManagerInMemory::ReadObjectInfo(const std::string &ob
 std::shared_ptr<OpenVDS::Request> IOManagerInMemory::ReadObject(const std::string &objectName, std::shared_ptr<TransferDownloadHandler> handler, const IORange &range)
 {
   auto request = std::make_shared<RequestImpl>(objectName);
-  m_threadPool.Enqueue([this, objectName, handler, request]
+  m_threadPool.Enqueue([this, objectName, handler, request, range]
     {
       std::unique_lock<std::mutex> lock(m_mutex);
       RequestStateHandler requestStateHandler(*request);
@@ -77,6 +79,13 @@ std::shared_ptr<OpenVDS::Request> IOManagerInMemory::ReadObject(const std::strin
         {
           handler->HandleMetadata(meta.first, meta.second);
         }
+        // Like the cloud backends a range with a non-zero end is an inclusive byte range, otherwise the whole object is read
+        if (range.end)
+        {
+          int64_t start = std::min(range.start, int64_t(object.data.size()));
+          int64_t end = std::min(range.end + 1, int64_t(object.data.size()));
+          object.data = std::vector<uint8_t>(object.data.begin() + start, object.data.begin() + std::max(start, end));
+        }
         handler->HandleData(std::move(object.data));
       }
       else
@@ -69,6 +69,9 @@ private:
     {
       siglongjmp (*SystemFileView_pSigjmpEnv, 1);
     }
+
+    // Not inside FILEVIEW_TRY, restore the previous handler so the faulting access raises the signal again instead of looping
+    sigaction(SIGBUS, &SignalHandlerInstaller::m_SigactionOld, NULL);
   }
 
   class SignalHandlerInstaller
@@ -314,7 +317,7 @@ bool File::Read(void* pxData, int64_t nOffset, int32_t nLength, Error& error) co
 
     if (nread == 0)
     {
-      SetIoError(errno, "File::read (zero-length read) ", error);
+      SetIoError("File::read (zero-length read)", error);
       return false;
     }
 
@@ -397,6 +400,25 @@ SystemFileView_SetSigBusJmpEnv(sigjmp_buf* pSigjmpEnv)
   SystemFileView_pSigjmpEnv = pSigjmpEnv;
 }
 
+bool FileView::CopyData(void *pTarget, const void *pSource, int64_t nSize)
+{
+  // Volatile since it is modified between sigsetjmp and siglongjmp
+  volatile bool isCopied = false;
+
+  FILEVIEW_TRY
+  {
+    memcpy(pTarget, pSource, size_t(nSize));
+    isCopied = true;
+  }
+  FILEVIEW_CATCH
+  {
+    isCopied = false;
+  }
+  FILEVIEW_FINALLY
+
+  return isCopied;
+}
+
 bool FileView::SystemFileMappingObject::Open(SystemFileMappingObject** ppcFileMappingObject, File& file, Error& error)
 {
   assert(ppcFileMappingObject && !*ppcFileMappingObject);
@@ -462,6 +462,24 @@ bool File::Flush()
   return isOK == TRUE;
 }
 
+bool FileView::CopyData(void *pTarget, const void *pSource, int64_t nSize)
+{
+  bool isCopied = false;
+
+  FILEVIEW_TRY
+  {
+    memcpy(pTarget, pSource, size_t(nSize));
+    isCopied = true;
+  }
+  FILEVIEW_CATCH
+  {
+    isCopied = false;
+  }
+  FILEVIEW_FINALLY
+
+  return isCopied;
+}
+
 FileView *File::CreateFileView(int64_t nPos, int64_t nSize, bool isPopulate, Error &error)
 {
   if(!m_pFileMappingObject)
@@ -94,6 +94,57 @@ static std::string urlDecode(const StringWrapper& url)
   return std::string(output.data(), output.data() + output.size());
 }
 
+const std::set<std::string> TrueWords = { "true", "yes", "on" };
+const std::set<std::string> FalseWords = { "false", "no", "off" };
+
+// Settings of the libcurl based IOManagers that can be given in the connection string. Returns false if the key is not one of them.
+static bool parseHttpTransferOption(const std::pair<std::string, std::string> &connectionPair, OpenOptions &openOptions, Error &error)
+{
+  static const std::set<std::string> integerKeys = { "maxconcurrentrequests", "maxconnectionsperhost", "receivebuffersize" };
+  static const std::set<std::string> booleanKeys = { "adaptiveconcurrency", "http2multiplexing", "tcpkeepalive" };
+
+  if (integerKeys.count(connectionPair.first))
+  {
+    char *end = nullptr;
+    long value = strtol(connectionPair.second.c_str(), &end, 10);
+    if (connectionPair.second.empty() || *end != '\0' || value < 0 || value > std::numeric_limits<int>::max() || (connectionPair.first == "maxconcurrentrequests" && value < 1))
+    {
+      error.code = -1;
+      error.string = fmt::format("Invalid value \"{}\" for {} in connection string.", connectionPair.second, connectionPair.first);
+      return true;
+    }
+    if (connectionPair.first == "maxconcurrentrequests")
+      openOptions.maxConcurrentRequests = int(value);
+    else if (connectionPair.first == "maxconnectionsperhost")
+      openOptions.maxConnectionsPerHost = int(value);
+    else
+      openOptions.receiveBufferSize = int(value);
+    return true;
+  }
+
+  if (booleanKeys.count(connectionPair.first))
+  {
+    std::string value = connectionPair.second;
+    std::transform(value.begin(), value.end(), value.begin(), asciitolower);
+    bool enable = TrueWords.find(value) != TrueWords.end();
+    if (!enable && FalseWords.find(value) == FalseWords.end())
+    {
+      error.code = -1;
+      error.string = fmt::format("Invalid value \"{}\" for {} in connection string.", connectionPair.second, connectionPair.first);
+      return true;
+    }
+    if (connectionPair.first == "adaptiveconcurrency")
+      openOptions.adaptiveConcurrency = enable;
+    else if (connectionPair.first == "http2multiplexing")
+      openOptions.http2Multiplexing = enable;
+    else
+      openOptions.tcpKeepAlive = enable;
+    return true;
+  }
+
+  return false;
+}
+
 static std::unique_ptr<OpenOptions> createS3OpenOptions(const StringWrapper &url, const StringWrapper &connectionString, Error &error)
 {
   std::unique_ptr<AWSOpenOptions> openOptions(new AWSOpenOptions());
@@ -245,6 +296,11 @@ static std::unique_ptr<OpenOptions> createAzureSASOpenOptions(const StringWrappe
     {
       openOptions->urlSuffix = connectionPair.second;
     }
+    else if (parseHttpTransferOption(connectionPair, *openOptions, error))
+    {
+      if (error.code)
+        return openOptions;
+    }
     else
     {
       error.code = -1;
@@ -255,9 +311,6 @@ static std::unique_ptr<OpenOptions> createAzureSASOpenOptions(const StringWrappe
   return openOptions;
 }
 
-const std::set<std::string> TrueWords = { "true", "yes", "on" };
-const std::set<std::string> FalseWords = { "false", "no", "off" };
-
 static std::unique_ptr<OpenOptions> createGoogleOpenOptions(const StringWrapper& url, const StringWrapper& connectionString, Error& error)
 {
   std::unique_ptr<GoogleOpenOptions> openOptions(new GoogleOpenOptions());
@@ -316,6 +369,11 @@ static std::unique_ptr<OpenOptions> createGoogleOpenOptions(const StringWrapper&
             return openOptions;
         }
     }
+    else if (parseHttpTransferOption(connectionPair, *openOptions, error))
+    {
+      if (error.code)
+        return openOptions;
+    }
     else
     {
       error.code = -1;
@@ -372,6 +430,18 @@ static std::unique_ptr<OpenOptions> createDMSOpenOptions(const StringWrapper& ur
 static std::unique_ptr<OpenOptions> createHttpOpenOptions(const StringWrapper& url, const StringWrapper& connectionString, Error& error)
 {
   std::unique_ptr<HttpOpenOptions> openOptions(new HttpOpenOptions(std::string(url.data, url.data + url.size)));
+  auto connectionStringMap = ParseConnectionString(connectionString.data, connectionString.size, error);
+  if (error.code)
+  {
+    return nullptr;
+  }
+
+  // Other keys have always been ignored for http urls, so they still are
+  for (auto& connectionPair : connectionStringMap)
+  {
+    if (parseHttpTransferOption(connectionPair, *openOptions, error) && error.code)
+      return openOptions;
+  }
   return openOptions;
 }
 
@@ -485,6 +555,7 @@ static bool Init(VDS *vds, VolumeDataStore *volumeDataStore, Error& error)
 {
   vds->produceStatuses.clear();
   vds->produceStatuses.resize(int(Dimensions_45) + 1, VolumeDataLayer::ProduceStatus_Unavailable);
+  vds->producedLODMasks.assign(int(Dimensions_45) + 1, ~0u);
 
   vds->volumeDataStore.reset(volumeDataStore);
 
@@ -577,6 +648,7 @@ VDS *Open(const OpenOptions &options, Error &error)
   {
     assert(ret.get());
     InitWaveletAdaptiveLoadLevel(*ret.get(), options);
+    ret->accessManager->GetPageCache().SetMaxSize(options.maxCacheSize);
     return ret.release();
   }
   else
@@ -687,7 +759,9 @@ void CreateVolumeDataLayout(VDS &vds, CompressionMethod compressionMethod, float
     int32_t physicalLODLevels = (nChunkDimensionality == 3 || vds.layoutDescriptor.IsCreate2DLODs()) ? GetLODCount(vds.layoutDescriptor) : 1;
     int32_t brickSize = GetInternalCubeSizeLOD0(vds.layoutDescriptor) * (nChunkDimensionality == 2 ? vds.layoutDescriptor.GetBrickSizeMultiplier2D() : 1);
 
-    vds.volumeDataLayout->CreateLayers(dimensionGroup, brickSize, physicalLODLevels, vds.produceStatuses[DimensionGroupUtil::GetDimensionsNDFromDimensionGroup(dimensionGroup)]);
+    DimensionsND dimensionsND = DimensionGroupUtil::GetDimensionsNDFromDimensionGroup(dimensionGroup);
+
+    vds.volumeDataLayout->CreateLayers(dimensionGroup, brickSize, physicalLODLevels, vds.produceStatuses[dimensionsND], vds.producedLODMasks[dimensionsND]);
   }
 }
 
@@ -715,6 +789,7 @@ static bool Init(VDS *vds, VolumeDataStore* volumeDataStore, VolumeDataLayoutDes
 
   vds->produceStatuses.clear();
   vds->produceStatuses.resize(int(Dimensions_45) + 1, VolumeDataLayer::ProduceStatus_Unavailable);
+  vds->producedLODMasks.assign(int(Dimensions_45) + 1, ~0u);
 
   vds->volumeDataStore.reset(volumeDataStore);
   vds->layoutDescriptor = layoutDescriptor;
@@ -754,6 +829,7 @@ static bool Init(VDS *vds, VolumeDataStore* volumeDataStore, VolumeDataLayoutDes
 
   vds->produceStatuses.clear();
   vds->produceStatuses.resize(int(Dimensions_45) + 1, VolumeDataLayer::ProduceStatus_Unavailable);
+  vds->producedLODMasks.assign(int(Dimensions_45) + 1, ~0u);
 
   if (!vds->volumeDataStore->WriteSerializedVolumeDataLayout(SerializeVolumeDataLayout(*vds), error))
     return false;
@@ -815,6 +891,7 @@ VDSHandle Create(const OpenOptions& options, VolumeDataLayoutDescriptor const& l
 
   if(Init(ret.get(), volumeDataStore.release(), layoutDescriptor, axisDescriptors, channelDescriptors, metadata, compressionMethod, compressionTolerance, error))
   {
+    ret->accessManager->GetPageCache().SetMaxSize(options.maxCacheSize);
     return ret.release();
   }
   else
@@ -61,6 +61,28 @@ public:
   /// <param name="connectionType"> The counter to be retireved. </param>
   /// <returns>Number of chunks decompressed.</returns>
   virtual uint64_t GetChunksDecompressed(OpenOptions::ConnectionType connectionType) = 0;
+
+  /// <summary>
+  /// Get the global count of page reads that were served by pages already in memory.
+  /// </summary>
+  /// <param name="connectionType"> The counter to be retireved. </param>
+  /// <returns>Number of page cache hits.</returns>
+  virtual uint64_t GetCacheHits(OpenOptions::ConnectionType connectionType) = 0;
+
+  /// <summary>
+  /// Get the global count of page reads that had to read and decompress the chunk.
+  /// </summary>
+  /// <param name="connectionType"> The counter to be retireved. </param>
+  /// <returns>Number of page cache misses.</returns>
+  virtual uint64_t GetCacheMisses(OpenOptions::ConnectionType connectionType) = 0;
+
+  /// <summary>
+  /// Get the global count of pages evicted from memory, either because a page accessor
+  /// reached its page limit or because the VDS reached its cache size limit.
+  /// </summary>
+  /// <param name="connectionType"> The counter to be retireved. </param>
+  /// <returns>Number of evicted pages.</returns>
+  virtual uint64_t GetCacheEvictions(OpenOptions::ConnectionType connectionType) = 0;
 };
 }
 
@@ -64,13 +64,22 @@ struct OpenOptions
   ConnectionType connectionType;
 
 protected:
-  OpenOptions(ConnectionType connectionType) : connectionType(connectionType), waveletAdaptiveMode(WaveletAdaptiveMode::BestQuality), waveletAdaptiveTolerance(0.01f), waveletAdaptiveRatio(1.0f) {}
-  OpenOptions(ConnectionType connectionType, WaveletAdaptiveMode waveletAdaptiveMode, float waveletAdaptiveTolerance, float waveletAdaptiveRatio) : connectionType(connectionType), waveletAdaptiveMode(waveletAdaptiveMode), waveletAdaptiveTolerance(waveletAdaptiveTolerance), waveletAdaptiveRatio(waveletAdaptiveRatio) {}
+  OpenOptions(ConnectionType connectionType) : connectionType(connectionType), waveletAdaptiveMode(WaveletAdaptiveMode::BestQuality), waveletAdaptiveTolerance(0.01f), waveletAdaptiveRatio(1.0f), maxCacheSize(0), diskCacheMaxSize(int64_t(1) << 30), maxConcurrentRequests(64), adaptiveConcurrency(false), maxConnectionsPerHost(0), http2Multiplexing(true), tcpKeepAlive(true), receiveBufferSize(0) {}
+  OpenOptions(ConnectionType connectionType, WaveletAdaptiveMode waveletAdaptiveMode, float waveletAdaptiveTolerance, float waveletAdaptiveRatio) : connectionType(connectionType), waveletAdaptiveMode(waveletAdaptiveMode), waveletAdaptiveTolerance(waveletAdaptiveTolerance), waveletAdaptiveRatio(waveletAdaptiveRatio), maxCacheSize(0), diskCacheMaxSize(int64_t(1) << 30), maxConcurrentRequests(64), adaptiveConcurrency(false), maxConnectionsPerHost(0), http2Multiplexing(true), tcpKeepAlive(true), receiveBufferSize(0) {}
 
 public:
   WaveletAdaptiveMode waveletAdaptiveMode;      ///< This property (only relevant when using Wavelet compression) is used to control how the wavelet adaptive compression determines which level of wavelet compressed data to load. Depending on the setting, either the global or local WaveletAdaptiveTolerance or the WaveletAdaptiveRatio can be used.
   float               waveletAdaptiveTolerance; ///< Wavelet adaptive tolerance, this setting will be used whenever the WavletAdaptiveMode is set to Tolerance.
   float               waveletAdaptiveRatio;     ///< Wavelet adaptive ratio, this setting will be used whenever the WavletAdaptiveMode is set to Ratio. A compression ratio of 5.0 corresponds to compressed data which is 20% of the original.
+  int64_t             maxCacheSize;             ///< Maximum number of bytes of decompressed chunk data kept in memory by all the page accessors of the VDS together. When the limit is exceeded the pages that are cheapest to read again are evicted first. A value of 0 means that only the page limit of each page accessor applies.
+  std::string         diskCachePath;            ///< Directory used to cache chunks on local disk when a VDS is opened for reading. Several processes can share the same directory. An empty string disables the disk cache.
+  int64_t             diskCacheMaxSize;         ///< Maximum number of bytes stored in the disk cache directory. When the limit is exceeded the least recently used chunks are deleted.
+  int                 maxConcurrentRequests;    ///< Maximum number of requests in flight at the same time for the Http, GoogleStorage and AzurePresigned connection types.
+  bool                adaptiveConcurrency;      ///< Adjust the number of requests in flight (up to maxConcurrentRequests) to the observed throughput and latency. The limit is raised by one while the connection keeps up and halved when requests are retried or the latency grows without a gain in throughput.
+  int                 maxConnectionsPerHost;    ///< Maximum number of connections opened to a single host by the Http, GoogleStorage and AzurePresigned connection types. A value of 0 means no limit other than maxConcurrentRequests.
+  bool                http2Multiplexing;        ///< Use HTTP/2 when the server supports it and multiplex requests over existing connections instead of opening new ones.
+  bool                tcpKeepAlive;             ///< Send TCP keep-alive probes on idle connections.
+  int                 receiveBufferSize;        ///< Size in bytes of the receive buffer of each request. A value of 0 uses the default of libcurl.
 
   OPENVDS_EXPORT virtual ~OpenOptions();
 };
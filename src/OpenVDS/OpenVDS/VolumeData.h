@@ -89,7 +89,9 @@ enum class CompressionMethod
   Zip,
   WaveletNormalizeBlock,
   WaveletLossless,
-  WaveletNormalizeBlockLossless
+  WaveletNormalizeBlockLossless,
+  Zstd, ///< The compression tolerance is used as the zstd compression level, 0 selects the zstd default level
+  LZ4
 };
 
 inline bool CompressionMethod_IsWavelet(CompressionMethod compressionMethod)
@@ -24,6 +24,9 @@
 #include <OpenVDS/Vector.h>
 #include <OpenVDS/Exceptions.h>
 
+#include <memory>
+#include <vector>
+
 namespace OpenVDS {
 
 enum class VDSProduceStatus
@@ -119,6 +122,39 @@ public:
   virtual void Cancel() = 0;
 };
 
+/// \class VolumeDataPageView
+/// \brief A read-only view of the buffer of a volume data page, which shares the buffer with the page instead of copying it.
+/// The buffer is reference counted, so it stays valid as long as any copy of the view exists, also after the page is released or evicted from the cache.
+class VolumeDataPageView
+{
+  std::shared_ptr<const std::vector<uint8_t>>
+                m_buffer;
+  int           m_min[Dimensionality_Max];
+  int           m_max[Dimensionality_Max];
+  int           m_pitch[Dimensionality_Max];
+public:
+                VolumeDataPageView() : m_buffer(), m_min(), m_max(), m_pitch() {}
+                VolumeDataPageView(std::shared_ptr<const std::vector<uint8_t>> buffer, const int (&min)[Dimensionality_Max], const int (&max)[Dimensionality_Max], const int (&pitch)[Dimensionality_Max])
+                  : m_buffer(std::move(buffer))
+                {
+                  for (int dimension = 0; dimension < Dimensionality_Max; dimension++)
+                  {
+                    m_min[dimension] = min[dimension];
+                    m_max[dimension] = max[dimension];
+                    m_pitch[dimension] = pitch[dimension];
+                  }
+                }
+
+  /// Check if the view refers to a buffer, a view of a page that could not be read is empty
+  bool          IsValid() const { return m_buffer != nullptr; }
+
+  void          GetMinMax(int (&min)[Dimensionality_Max], int (&max)[Dimensionality_Max]) const { for (int dimension = 0; dimension < Dimensionality_Max; dimension++) { min[dimension] = m_min[dimension]; max[dimension] = m_max[dimension]; } }
+
+  const void   *GetBuffer(int (&pitch)[Dimensionality_Max]) const { for (int dimension = 0; dimension < Dimensionality_Max; dimension++) { pitch[dimension] = m_pitch[dimension]; } return m_buffer ? m_buffer->data() : nullptr; }
+
+  int64_t       GetBufferSize() const { return m_buffer ? int64_t(m_buffer->size()) : 0; }
+};
+
 class VolumeDataPage
 {
 public:
@@ -138,6 +174,8 @@ public:
   virtual Error GetError() const = 0;
   virtual const void *
                 GetBuffer(int (&pitch)[Dimensionality_Max]) = 0;
+  virtual VolumeDataPageView
+                GetBufferView() = 0; ///< Get a reference counted read-only view of the buffer that can be kept after the page is released. Writes to the page after the view is created are not visible in the view.
   virtual void *GetWritableBuffer(int (&pitch)[Dimensionality_Max]) = 0;
   virtual void  UpdateWrittenRegion(const int (&writtenMin)[Dimensionality_Max], const int (&writtenMax)[Dimensionality_Max]) = 0;
   virtual void  Release() = 0;
@@ -150,7 +188,8 @@ public:
   {
     AccessMode_ReadOnly,
     AccessMode_ReadWrite,
-    AccessMode_Create
+    AccessMode_Create,
+    AccessMode_CreateWithLODGeneration ///< Create the layer and all its parent LOD layers, which are produced by downsampling the chunks as they are written
   };
 
 protected:
@@ -204,6 +243,7 @@ public:
   virtual VolumeDataPage *CreatePage(int64_t chunkIndex) = 0;
   virtual VolumeDataPage *ReadPage(int64_t chunkIndex) = 0;
   virtual VolumeDataPage *ReadPageAtPosition(const int (&position)[Dimensionality_Max]) = 0;
+  virtual VolumeDataPageView ReadPageView(int64_t chunkIndex) = 0; ///< Read a page and return a view of its buffer without keeping the page pinned, the view is empty if the page could not be read
 
   virtual void  Commit() = 0;
 };
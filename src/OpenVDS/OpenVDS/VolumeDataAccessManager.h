@@ -25,6 +25,7 @@
 #include <OpenVDS/Optional.h>
 #include <OpenVDS/Exceptions.h>
 
+#include <functional>
 #include <memory>
 
 namespace OpenVDS {
@@ -82,10 +83,11 @@ public:
   /// The maximum number of pages that the volume data page accessor will cache.
   /// </param>
   /// <param name="accessMode">
-  /// This specifies the access mode (ReadOnly/ReadWrite/Create) of the volume data page accessor.
+  /// This specifies the access mode (ReadOnly/ReadWrite/Create/CreateWithLODGeneration) of the volume data page accessor.
+  /// With CreateWithLODGeneration the parent LOD layers are created too, and every chunk written is downsampled into them. The LOD layers are written when the accessor is committed.
   /// </param>
   /// <param name="chunkMetadataPageSize">
-  /// The chunk metadata page size of the layer. This controls how many chunk metadata entries are written per page, and is only used when the access mode is Create.
+  /// The chunk metadata page size of the layer. This controls how many chunk metadata entries are written per page, and is only used when the access mode is Create or CreateWithLODGeneration.
   /// If this number is too low it will degrade performance, but in certain situations it can be advantageous to make this number a multiple
   /// of the number of chunks in some of the dimensions. Do not change this from the default (1024) unless you know exactly what you are doing.
   /// </param>
@@ -196,6 +198,51 @@ public:
   /// </returns>
   virtual int64_t RequestVolumeSubset(void *buffer, int64_t bufferByteSize, DimensionsND dimensionsND, int LOD, int channel, const int (&minVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], const int (&maxVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], VolumeDataChannelDescriptor::Format format, optional<float> replacementNoValue = optional<float>()) = 0;
 
+  /// <summary>
+  /// Request a subset of the input VDS that is delivered progressively.
+  /// The buffer is first filled with the chunks decoded at a coarse wavelet adaptive level, which only needs a small part of each chunk to be read.
+  /// Then the rest of each chunk is read and the buffer is filled again at the adaptive level the layer is read at.
+  /// Layers that are not wavelet compressed are filled once.
+  /// </summary>
+  /// <param name="buffer">
+  /// Pointer to a preallocated buffer holding at least as many elements of format as indicated by minVoxelCoordinates and maxVoxelCoordinates.
+  /// </param>
+  /// <param name="bufferByteSize">
+  /// The size of the provided buffer, in bytes.
+  /// </param>
+  /// <param name="dimensionsND">
+  /// The dimensiongroup the requested data is read from.
+  /// </param>
+  /// <param name="LOD">
+  /// The LOD level the requested data is read from.
+  /// </param>
+  /// <param name="channel">
+  /// The channel index the requested data is read from.
+  /// </param>
+  /// <param name="minVoxelCoordinates">
+  /// The minimum voxel coordinates to request in each dimension (inclusive).
+  /// </param>
+  /// <param name="maxVoxelCoordinates">
+  /// The maximum voxel coordinates to request in each dimension (exclusive).
+  /// </param>
+  /// <param name="format">
+  /// Voxel format of the destination buffer.
+  /// </param>
+  /// <param name="coarseAdaptiveLevel">
+  /// The wavelet adaptive level of the first pass over the subset. Higher levels read a smaller part of each chunk.
+  /// </param>
+  /// <param name="refinementCallback">
+  /// Called from a worker thread with the adaptive level of the data in the buffer each time the whole buffer has been filled.
+  /// The last call is made with the adaptive level the layer is read at, before the request completes. The callback must not throw.
+  /// </param>
+  /// <param name="replacementNoValue">
+  /// If specified, this value is used to replace regions of the input VDS that has no data.
+  /// </param>
+  /// <returns>
+  /// The RequestID which can be used to query the status of the request, cancel the request or wait for the request to complete.
+  /// </returns>
+  virtual int64_t RequestVolumeSubsetProgressive(void *buffer, int64_t bufferByteSize, DimensionsND dimensionsND, int LOD, int channel, const int (&minVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], const int (&maxVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], VolumeDataChannelDescriptor::Format format, int coarseAdaptiveLevel, std::function<void(int adaptiveLevel)> refinementCallback, optional<float> replacementNoValue = optional<float>()) = 0;
+
   /// <summary>
   /// Compute the buffer size (in bytes) for a projected volume subset request.
   /// </summary>
@@ -797,6 +844,7 @@ public:
   static constexpr AccessMode AccessMode_ReadOnly  = VolumeDataPageAccessor::AccessMode_ReadOnly;
   static constexpr AccessMode AccessMode_ReadWrite = VolumeDataPageAccessor::AccessMode_ReadWrite;
   static constexpr AccessMode AccessMode_Create    = VolumeDataPageAccessor::AccessMode_Create;
+  static constexpr AccessMode AccessMode_CreateWithLODGeneration = VolumeDataPageAccessor::AccessMode_CreateWithLODGeneration;
 
   static constexpr int Dimensionality_Max = VolumeDataLayout::Dimensionality_Max;  ///< the maximum number of dimensions a VDS can have
 
@@ -941,10 +989,11 @@ public:
   /// The maximum number of pages that the volume data page accessor will cache.
   /// </param>
   /// <param name="accessMode">
-  /// This specifies the access mode (ReadOnly/ReadWrite/Create) of the volume data page accessor.
+  /// This specifies the access mode (ReadOnly/ReadWrite/Create/CreateWithLODGeneration) of the volume data page accessor.
+  /// With CreateWithLODGeneration the parent LOD layers are created too, and every chunk written is downsampled into them. The LOD layers are written when the accessor is committed.
   /// </param>
   /// <param name="chunkMetadataPageSize">
-  /// The chunk metadata page size of the layer. This controls how many chunk metadata entries are written per page, and is only used when the access mode is Create.
+  /// The chunk metadata page size of the layer. This controls how many chunk metadata entries are written per page, and is only used when the access mode is Create or CreateWithLODGeneration.
   /// If this number is too low it will degrade performance, but in certain situations it can be advantageous to make this number a multiple
   /// of the number of chunks in some of the dimensions. Do not change this from the default (1024) unless you know exactly what you are doing.
   /// </param>
@@ -1666,6 +1715,58 @@ public:
     return DoRequestVolumeSubset(request, buffer, bufferByteSize, dimensionsND, LOD, channel, minVoxelCoordinates, maxVoxelCoordinates, format, replacementNoValue);
   }
 
+  /// <summary>
+  /// Request a subset of the input VDS that is delivered progressively.
+  /// The buffer is first filled with the chunks decoded at a coarse wavelet adaptive level, which only needs a small part of each chunk to be read.
+  /// Then the rest of each chunk is read and the buffer is filled again at the adaptive level the layer is read at.
+  /// Layers that are not wavelet compressed are filled once.
+  /// </summary>
+  /// <param name="buffer">
+  /// Pointer to a preallocated buffer holding at least as many elements of format as indicated by minVoxelCoordinates and maxVoxelCoordinates.
+  /// </param>
+  /// <param name="bufferByteSize">
+  /// The size of the provided buffer, in bytes.
+  /// </param>
+  /// <param name="dimensionsND">
+  /// The dimensiongroup the requested data is read from.
+  /// </param>
+  /// <param name="LOD">
+  /// The LOD level the requested data is read from.
+  /// </param>
+  /// <param name="channel">
+  /// The channel index the requested data is read from.
+  /// </param>
+  /// <param name="minVoxelCoordinates">
+  /// The minimum voxel coordinates to request in each dimension (inclusive).
+  /// </param>
+  /// <param name="maxVoxelCoordinates">
+  /// The maximum voxel coordinates to request in each dimension (exclusive).
+  /// </param>
+  /// <param name="format">
+  /// Voxel format of the destination buffer.
+  /// </param>
+  /// <param name="coarseAdaptiveLevel">
+  /// The wavelet adaptive level of the first pass over the subset. Higher levels read a smaller part of each chunk.
+  /// </param>
+  /// <param name="refinementCallback">
+  /// Called from a worker thread with the adaptive level of the data in the buffer each time the whole buffer has been filled.
+  /// The last call is made with the adaptive level the layer is read at, before the request completes. The callback must not throw.
+  /// </param>
+  /// <param name="replacementNoValue">
+  /// If specified, this value is used to replace regions of the input VDS that has no data.
+  /// </param>
+  /// <returns>
+  /// A VolumeDataRequest instance encapsulating the request status and buffer.
+  /// </returns>
+  std::shared_ptr<VolumeDataRequest>
+  RequestVolumeSubsetProgressive(void *buffer, int64_t bufferByteSize, DimensionsND dimensionsND, int LOD, int channel, const int (&minVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], const int (&maxVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], VolumeDataChannelDescriptor::Format format, int coarseAdaptiveLevel, std::function<void(int adaptiveLevel)> refinementCallback, optional<float> replacementNoValue = optional<float>())
+  {
+    EnsureValid();
+    auto request = new VolumeDataRequest(m_IVolumeDataAccessManager, buffer, bufferByteSize, format);
+    request->SetJobID(m_IVolumeDataAccessManager->RequestVolumeSubsetProgressive(buffer, bufferByteSize, dimensionsND, LOD, channel, minVoxelCoordinates, maxVoxelCoordinates, format, coarseAdaptiveLevel, refinementCallback, replacementNoValue));
+    return std::shared_ptr<VolumeDataRequest>(request, &VolumeDataRequest::Deleter);
+  }
+
   /// <summary>
   /// Request a subset of the input VDS.
   /// </summary>
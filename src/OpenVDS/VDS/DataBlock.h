@@ -168,6 +168,16 @@ inline int32_t GetAllocatedByteSizeForSize(const int32_t size)
   return size == 1 ? 1 : (size + 7) & -8;
 }
 
+// A data block is linear when its rows and slices are not padded, i.e. the start of the allocated buffer has the same layout as a linear buffer of the data
+inline bool IsDataBlockLinear(const DataBlock &block)
+{
+  int32_t sizeX = (block.Format == VolumeDataChannelDescriptor::Format_1Bit) ? ((block.Size[0] * block.Components) + 7) / 8 : block.Size[0];
+
+  return (sizeX == block.AllocatedSize[0] || (block.Size[1] == 1 && block.Size[2] == 1 && block.Size[3] == 1)) &&
+         (block.Size[1] == block.AllocatedSize[1] || (block.Size[2] == 1 && block.Size[3] == 1)) &&
+         (block.Size[2] == block.AllocatedSize[2] || block.Size[3] == 1);
+}
+
 }
 
 #endif //DATABLOCK_H
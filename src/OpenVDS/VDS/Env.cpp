@@ -21,4 +21,12 @@ bool getBooleanEnvironmentVariable(const char *name)
     return false;
   return true;
 }
+
+std::string getStringEnvironmentVariable(const char *name)
+{
+  const char *var = getenv(name);
+  if (!var)
+    return std::string();
+  return std::string(var);
+}
 }
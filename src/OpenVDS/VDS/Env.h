@@ -1,9 +1,12 @@
 #ifndef ENV_H
 #define ENV_H
 
+#include <string>
+
 namespace OpenVDS
 {
 bool getBooleanEnvironmentVariable(const char *name);
+std::string getStringEnvironmentVariable(const char *name);
 }
 
 #endif
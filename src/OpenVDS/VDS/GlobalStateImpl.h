@@ -37,11 +37,20 @@ namespace OpenVDS
         i = 0;
       for (auto &i : decompressedChunks)
         i = 0;
+      for (auto &i : cacheHits)
+        i = 0;
+      for (auto &i : cacheMisses)
+        i = 0;
+      for (auto &i : cacheEvictions)
+        i = 0;
     }
     std::atomic<uint64_t> downloaded[OpenOptions::ConnectionTypeCount];
     std::atomic<uint64_t> downloadedChunks[OpenOptions::ConnectionTypeCount];
     std::atomic<uint64_t> decompressed[OpenOptions::ConnectionTypeCount];
     std::atomic<uint64_t> decompressedChunks[OpenOptions::ConnectionTypeCount];
+    std::atomic<uint64_t> cacheHits[OpenOptions::ConnectionTypeCount];
+    std::atomic<uint64_t> cacheMisses[OpenOptions::ConnectionTypeCount];
+    std::atomic<uint64_t> cacheEvictions[OpenOptions::ConnectionTypeCount];
 
     uint64_t GetBytesDownloaded(OpenOptions::ConnectionType connectionType) override
     {
@@ -59,16 +68,31 @@ namespace OpenVDS
     {
       return decompressedChunks[connectionType];
     }
+    uint64_t GetCacheHits(OpenOptions::ConnectionType connectionType) override
+    {
+      return cacheHits[connectionType];
+    }
+    uint64_t GetCacheMisses(OpenOptions::ConnectionType connectionType) override
+    {
+      return cacheMisses[connectionType];
+    }
+    uint64_t GetCacheEvictions(OpenOptions::ConnectionType connectionType) override
+    {
+      return cacheEvictions[connectionType];
+    }
   };
 
   class GlobalStateVds
   {
   public:
-    GlobalStateVds(std::atomic<uint64_t> &downloaded, std::atomic<uint64_t> &downloadedChunks, std::atomic<uint64_t> &decompressed, std::atomic<uint64_t> &decompressedChunks)
+    GlobalStateVds(std::atomic<uint64_t> &downloaded, std::atomic<uint64_t> &downloadedChunks, std::atomic<uint64_t> &decompressed, std::atomic<uint64_t> &decompressedChunks, std::atomic<uint64_t> &cacheHits, std::atomic<uint64_t> &cacheMisses, std::atomic<uint64_t> &cacheEvictions)
       : downloaded(downloaded)
       , downloadedChunks(downloadedChunks)
       , decompressed(decompressed)
       , decompressedChunks(decompressedChunks)
+      , cacheHits(cacheHits)
+      , cacheMisses(cacheMisses)
+      , cacheEvictions(cacheEvictions)
     {}
     void addDownload(uint64_t download)
     {
@@ -80,11 +104,26 @@ namespace OpenVDS
       decompressed += decompress;
       decompressedChunks++;
     }
+    void addCacheHit()
+    {
+      cacheHits++;
+    }
+    void addCacheMiss()
+    {
+      cacheMisses++;
+    }
+    void addCacheEviction()
+    {
+      cacheEvictions++;
+    }
   private:
     std::atomic<uint64_t> &downloaded;
     std::atomic<uint64_t> &downloadedChunks;
     std::atomic<uint64_t> &decompressed;
     std::atomic<uint64_t> &decompressedChunks;
+    std::atomic<uint64_t> &cacheHits;
+    std::atomic<uint64_t> &cacheMisses;
+    std::atomic<uint64_t> &cacheEvictions;
   };
 }
 #endif
\ No newline at end of file
@@ -63,6 +63,9 @@ public:
   Item *GetFirstItem() const { return m_firstItem; }
   Item *GetLastItem() const { return m_lastItem; }
 
+  static Item *GetNextItem(Item *item) { return (item->*PtrToNode).m_next; }
+  static Item *GetPrevItem(Item *item) { return (item->*PtrToNode).m_prev; }
+
   void Remove(Item *item)
   {
     Node &node = item->*PtrToNode;
@@ -485,6 +485,14 @@ static CompressionMethod CompressionMethodFromJson(Json::Value const &jsonCompre
   {
     return CompressionMethod::WaveletNormalizeBlockLossless;
   }
+  else if(compressionMethodString == "Zstd")
+  {
+    return CompressionMethod::Zstd;
+  }
+  else if(compressionMethodString == "LZ4")
+  {
+    return CompressionMethod::LZ4;
+  }
   else
   {
     throw Json::Exception("Illegal compression method");
@@ -732,6 +740,8 @@ std::string ToString(CompressionMethod compressionMethod)
   case CompressionMethod::WaveletNormalizeBlock:         return "WaveletNormalizeBlock";
   case CompressionMethod::WaveletLossless:               return "WaveletLossless";
   case CompressionMethod::WaveletNormalizeBlockLossless: return "WaveletNormalizeBlockLossless";
+  case CompressionMethod::Zstd:                          return "Zstd";
+  case CompressionMethod::LZ4:                           return "LZ4";
 
   default: assert(0 && "Illegal compression method"); return "";
   };
@@ -1101,6 +1111,7 @@ bool ParseLayerStatus(const std::vector<uint8_t> &json, VDS &vds, LayerMetadataC
 {
   vds.produceStatuses.clear();
   vds.produceStatuses.resize(int(Dimensions_45) + 1, VolumeDataLayer::ProduceStatus_Unavailable);
+  vds.producedLODMasks.assign(int(Dimensions_45) + 1, 0);
 
   Json::Value root;
   if (!ParseJSONFromBuffer(json, root, error))
@@ -1132,6 +1143,11 @@ bool ParseLayerStatus(const std::vector<uint8_t> &json, VDS &vds, LayerMetadataC
         vds.produceStatuses[dimensionsND] = produceStatus;
       }
 
+      if (lod < 32 && produceStatus != VolumeDataLayer::ProduceStatus_Unavailable)
+      {
+        vds.producedLODMasks[dimensionsND] |= 1u << lod;
+      }
+
       MetadataStatus
         metadataStatus = MetadataStatus();
 
@@ -20,6 +20,14 @@
 #include <assert.h>
 #include <string.h>
 
+#include <algorithm>
+
+#define ENABLE_SSE_RLE 1
+
+#ifdef ENABLE_SSE_RLE
+#include <emmintrin.h>
+#endif
+
 #define HUERLE_RUN_LENGTH_FIRST_BYTE_SHIFT    6
 #define HUERLE_RUN_LENGTH_FIRST_BYTE_MASK     (0x3f)
 #define HUERLE_EXTENDED_RUN_FLAG              (1 << 7)
@@ -179,4 +187,181 @@ int32_t RleDecompress(uint8_t *target, int32_t targetSize, uint8_t *source)
   }
   return 0;
 }
+
+// A repeat run costs a run length and one value, and it splits the unique run it is in. Shorter runs are left in the unique run.
+template<typename T>
+static int32_t RleMinimumRepeatLength()
+{
+  return 1 + int32_t((2 + sizeof(T)) / sizeof(T));
+}
+
+// Returns the number of values from the start of source that are equal to the first one, at most count
+template<typename T>
+static int32_t RleFindRepeatLength(const T *source, int32_t count)
+{
+  T value = source[0];
+  int32_t length = 1;
+
+#ifdef ENABLE_SSE_RLE
+  const int32_t valuesPerVector = int32_t(sizeof(__m128i) / sizeof(T));
+  __m128i packedValue = _mm_set1_epi64x(int64_t(RlePack(value)));
+
+  while (length + valuesPerVector <= count)
+  {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(source + length)), packedValue));
+
+    if (mask != 0xffff)
+    {
+      // Only whole values are equal, so the first differing byte is in the first differing value
+      int32_t differingByte = 0;
+      while (mask & (1 << differingByte)) differingByte++;
+      return length + differingByte / int32_t(sizeof(T));
+    }
+    length += valuesPerVector;
+  }
+#endif
+
+  while (length < count && source[length] == value)
+  {
+    length++;
+  }
+
+  return length;
+}
+
+// Returns the number of values from the start of source before the first run of at least minimumRepeatLength equal values, at most count
+template<typename T>
+static int32_t RleFindUniqueLength(const T *source, int32_t count, int32_t minimumRepeatLength)
+{
+  int32_t index = 0;
+
+  while (index < count)
+  {
+#ifdef ENABLE_SSE_RLE
+    // Skip ahead to the first value that is equal to the next one
+    const int32_t valuesPerVector = int32_t(sizeof(__m128i) / sizeof(T));
+    const int valueMask = (1 << sizeof(T)) - 1;
+
+    while (index + valuesPerVector < count)
+    {
+      int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(source + index)), _mm_loadu_si128((const __m128i *)(source + index + 1))));
+
+      int32_t equal = 0;
+      while (equal < valuesPerVector && ((mask >> (equal * sizeof(T))) & valueMask) != valueMask) equal++;
+
+      index += equal;
+      if (equal < valuesPerVector) break;
+    }
+#endif
+
+    if (index + 1 < count && source[index] == source[index + 1])
+    {
+      int32_t repeatLength = RleFindRepeatLength(source + index, std::min(count - index, minimumRepeatLength));
+      if (repeatLength >= minimumRepeatLength)
+      {
+        return index;
+      }
+    }
+    index++;
+  }
+
+  return count;
+}
+
+template<typename T>
+static uint8_t *RleWriteRunLength(uint8_t *target, int32_t runLength, bool isUnique)
+{
+  // We don't need to encode runs of 0 length, so we store one less than the actual run length
+  runLength--;
+
+  uint8_t u0 = uint8_t(runLength & HUERLE_RUN_LENGTH_FIRST_BYTE_MASK) | (isUnique ? HUERLE_UNIQUE_RUN_FLAG : 0);
+
+  if (runLength > HUERLE_RUN_LENGTH_FIRST_BYTE_MASK)
+  {
+    *target++ = u0 | HUERLE_EXTENDED_RUN_FLAG;
+    *target++ = uint8_t(runLength >> HUERLE_RUN_LENGTH_FIRST_BYTE_SHIFT);
+  }
+  else
+  {
+    *target++ = u0;
+  }
+
+  return target;
+}
+
+template <typename T>
+int32_t RleCompress(uint8_t *target_parameter, int32_t targetSize, const uint8_t *source_parameter, int32_t sourceSize)
+{
+  assert(sourceSize % sizeof(T) == 0);
+
+  const T *source = (const T *)source_parameter;
+  int32_t count = sourceSize / int32_t(sizeof(T));
+
+  uint8_t *target = target_parameter + sizeof(RLEHeader);
+  uint8_t *targetEnd = target_parameter + targetSize;
+
+  int32_t minimumRepeatLength = RleMinimumRepeatLength<T>();
+
+  int32_t index = 0;
+
+  while (index < count)
+  {
+    int32_t maxRunLength = std::min(count - index, HUERLE_MAX_RUN_LENGTH);
+
+    int32_t runLength = RleFindRepeatLength(source + index, maxRunLength);
+
+    bool isUnique = runLength < minimumRepeatLength;
+
+    if (isUnique)
+    {
+      runLength = RleFindUniqueLength(source + index, maxRunLength, minimumRepeatLength);
+    }
+
+    int32_t valueSize = (isUnique ? runLength : 1) * int32_t(sizeof(T));
+
+    if (targetEnd - target < 2 + valueSize)
+    {
+      return -1;
+    }
+
+    target = RleWriteRunLength<T>(target, runLength, isUnique);
+    memcpy(target, source + index, valueSize);
+    target += valueSize;
+    index += runLength;
+  }
+
+  RLEHeader *rleHeader = (RLEHeader *)target_parameter;
+  rleHeader->compressedSize = int32_t(target - target_parameter);
+  rleHeader->originalSize = sourceSize;
+  rleHeader->rleUnitSize = int32_t(sizeof(T));
+
+  return rleHeader->compressedSize;
+}
+
+int32_t RleCompress(uint8_t *target, int32_t targetSize, const uint8_t *source, int32_t sourceSize, int32_t rleUnitSize)
+{
+  if (targetSize < int32_t(sizeof(RLEHeader)))
+  {
+    return -1;
+  }
+
+  switch (rleUnitSize)
+  {
+    case 1:
+      return RleCompress<uint8_t>(target, targetSize, source, sourceSize);
+
+    case 2:
+      return RleCompress<uint16_t>(target, targetSize, source, sourceSize);
+
+    case 4:
+      return RleCompress<uint32_t>(target, targetSize, source, sourceSize);
+
+    case 8:
+      return RleCompress<uint64_t>(target, targetSize, source, sourceSize);
+
+    default:
+      assert(("Unsupported unit size"));
+  }
+  return -1;
+}
 }
@@ -32,6 +32,9 @@ struct RLEHeader
 
 int32_t RleDecompress(uint8_t *target, int32_t targetSize, uint8_t* source);
 
+// Compresses sourceSize bytes of rleUnitSize (1, 2, 4 or 8) byte values, returns the compressed size including the RLEHeader or -1 if the target is too small
+int32_t RleCompress(uint8_t *target, int32_t targetSize, const uint8_t *source, int32_t sourceSize, int32_t rleUnitSize);
+
 }
 
 #endif //RLE_H
\ No newline at end of file
@@ -17,97 +17,299 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
+// Work-stealing thread pool. Every worker owns one deque per priority, guarded
+// by its own mutex, so enqueueing and dequeueing does not serialize on one lock.
+// Workers take work from their own deque first and steal from the other workers
+// when it runs dry. Higher priority work is always preferred, also when stealing.
 class ThreadPool
 {
 public:
+  enum Priority
+  {
+    Priority_High,
+    Priority_Normal,
+    Priority_Low,
+    Priority_Count
+  };
+
   ThreadPool(size_t);
   template <class F>
   auto Enqueue(F&& f)
     ->std::future<typename std::result_of<F()>::type>;
+  template <class F>
+  auto Enqueue(F&& f, Priority priority)
+    ->std::future<typename std::result_of<F()>::type>;
   ~ThreadPool();
 
+  // Runs body(0) ... body(count - 1) on the calling thread and up to helperCount workers of the pool. The calling thread
+  // takes items until none are left and then waits for the items the helpers are running, so this can be called from a
+  // worker of the pool even when all the other workers are busy.
+  void ParallelFor(int count, int helperCount, const std::function<void(int)> &body);
+
+  // The pool the calling thread is a worker of, or nullptr
+  static ThreadPool *GetCurrentPool() { return GetCurrentWorker().pool; }
+
+  size_t  GetWorkerCount() const { return m_workers.size(); }
+  int     GetIdleWorkerCount() const { return m_sleepers; }
+  int64_t GetQueueDepth() const;
+  int64_t GetQueueDepth(Priority priority) const { int64_t depth = m_pending[priority]; return depth > 0 ? depth : 0; }
+  int64_t GetStealCount() const { return m_steals; }
+  int64_t GetExecutedCount() const { return m_executed; }
+
 private:
-  std::vector<std::thread> workers;
-  std::queue<std::function<void()>> tasks;
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks[Priority_Count];
+  };
 
-  std::mutex queue_mutex;
-  std::condition_variable condition;
-  bool stop;
+  struct CurrentWorker
+  {
+    ThreadPool *pool;
+    size_t index;
+  };
+
+  static CurrentWorker &GetCurrentWorker()
+  {
+    static thread_local CurrentWorker currentWorker = { nullptr, 0 };
+    return currentWorker;
+  }
+
+  void Push(std::function<void()> &&task, Priority priority);
+  bool TryPop(size_t index, std::function<void()> &task);
+  void WorkerLoop(size_t index);
+
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+
+  // The pending counters can be transiently negative since a task becomes visible
+  // to the workers before its counter is incremented.
+  std::atomic<int64_t> m_pending[Priority_Count];
+  std::atomic<int64_t> m_steals;
+  std::atomic<int64_t> m_executed;
+  std::atomic<size_t> m_nextQueue;
+  std::atomic<int> m_sleepers;
+
+  std::mutex m_sleepMutex;
+  std::condition_variable m_sleepCondition;
+  std::atomic<bool> m_stop;
 };
 
 inline ThreadPool::ThreadPool(size_t threads)
-  : stop(false)
+  : m_steals(0)
+  , m_executed(0)
+  , m_nextQueue(0)
+  , m_sleepers(0)
+  , m_stop(false)
 {
+  if (threads == 0)
+    threads = 1;
+
+  for (auto &pending : m_pending)
+    pending = 0;
+
+  m_queues.reserve(threads);
   for (size_t i = 0; i < threads; ++i)
-    workers.emplace_back(
+    m_queues.emplace_back(new WorkerQueue());
+
+  m_workers.reserve(threads);
+  for (size_t i = 0; i < threads; ++i)
+    m_workers.emplace_back([this, i] { WorkerLoop(i); });
+}
+
+inline int64_t ThreadPool::GetQueueDepth() const
+{
+  int64_t depth = 0;
+  for (auto &pending : m_pending)
+    depth += pending;
+  return depth > 0 ? depth : 0;
+}
+
+inline void ThreadPool::Push(std::function<void()> &&task, Priority priority)
+{
+  // Work enqueued from one of our own workers stays on that worker for locality,
+  // everything else is distributed round robin.
+  CurrentWorker &currentWorker = GetCurrentWorker();
+  size_t index = currentWorker.pool == this ? currentWorker.index : m_nextQueue++ % m_queues.size();
+
+  {
+    WorkerQueue &queue = *m_queues[index];
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    queue.tasks[priority].emplace_back(std::move(task));
+  }
+  m_pending[priority]++;
+
+  if (m_sleepers > 0)
+  {
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_sleepCondition.notify_one();
+  }
+}
+
+inline bool ThreadPool::TryPop(size_t index, std::function<void()> &task)
+{
+  size_t queueCount = m_queues.size();
+  for (int priority = 0; priority < Priority_Count; priority++)
+  {
+    if (m_pending[priority] <= 0)
+      continue;
+
+    {
+      WorkerQueue &queue = *m_queues[index];
+      std::unique_lock<std::mutex> lock(queue.mutex);
+      auto &tasks = queue.tasks[priority];
+      if (!tasks.empty())
+      {
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        m_pending[priority]--;
+        return true;
+      }
+    }
+
+    for (size_t i = 1; i < queueCount; i++)
+    {
+      WorkerQueue &victim = *m_queues[(index + i) % queueCount];
+      std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+      if (!lock.owns_lock())
+        continue;
+      auto &tasks = victim.tasks[priority];
+      if (!tasks.empty())
+      {
+        task = std::move(tasks.back());
+        tasks.pop_back();
+        m_pending[priority]--;
+        m_steals++;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+inline void ThreadPool::WorkerLoop(size_t index)
+{
+  GetCurrentWorker().pool = this;
+  GetCurrentWorker().index = index;
+
+  for (;;)
+  {
+    std::function<void()> task;
+    if (TryPop(index, task))
+    {
+      task();
+      m_executed++;
+      continue;
+    }
+
+    // Another worker holds the lock of the deque with the pending work, try again.
+    if (GetQueueDepth() > 0)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    if (m_stop && GetQueueDepth() == 0)
+      return;
+    m_sleepers++;
+    m_sleepCondition.wait(lock,
       [this]
       {
-        for (;;)
-        {
-          std::function<void()> task;
-
-          {
-            std::unique_lock<std::mutex> lock(this->queue_mutex);
-            this->condition.wait(lock,
-              [this]
-              {
-                return this->stop || !this->tasks.empty();
-              });
-            if (this->stop && this->tasks.empty())
-              return;
-            task = std::move(this->tasks.front());
-            this->tasks.pop();
-          }
-
-          task();
-        }
+        return m_stop || GetQueueDepth() > 0;
       });
+    m_sleepers--;
+  }
 }
 
 template <class F>
 auto ThreadPool::Enqueue(F && f)
 -> std::future<typename std::result_of<F()>::type>
+{
+  return Enqueue(std::forward<F>(f), Priority_Normal);
+}
+
+template <class F>
+auto ThreadPool::Enqueue(F && f, Priority priority)
+-> std::future<typename std::result_of<F()>::type>
 {
   using return_type = typename std::result_of<F()>::type;
 
   auto task = std::make_shared<std::packaged_task<return_type()>>(std::forward<F>(f));
 
   std::future<return_type> res = task->get_future();
+  if (m_stop)
   {
-    std::unique_lock<std::mutex> lock(queue_mutex);
+    fprintf(stderr, "enqueue on stopped ThreadPool");
+    abort();
+  }
 
-    if (stop)
+  Push([task]()
     {
-      fprintf(stderr, "enqueue on stopped ThreadPool");
-      abort();
-    }
+      (*task)();
+    }, priority);
+  return res;
+}
+
+inline void ThreadPool::ParallelFor(int count, int helperCount, const std::function<void(int)> &body)
+{
+  struct State
+  {
+    std::atomic<int> next;
+    std::atomic<int> done;
+    std::mutex mutex;
+    std::condition_variable condition;
+  };
+
+  auto state = std::make_shared<State>();
+  state->next = 0;
+  state->done = 0;
 
-    tasks.emplace([task]()
+  // Helpers that start after all items are taken return without touching body, which may be gone by then
+  auto run = [state, count, &body]()
+    {
+      for (int i = state->next++; i < count; i = state->next++)
       {
-        (*task)();
-      });
+        body(i);
+        if (++state->done == count)
+        {
+          std::unique_lock<std::mutex> lock(state->mutex);
+          state->condition.notify_all();
+        }
+      }
+    };
+
+  for (int i = 0; i < helperCount && i < count - 1; i++)
+  {
+    Push(std::function<void()>(run), Priority_High);
   }
-  condition.notify_one();
-  return res;
+
+  run();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->condition.wait(lock, [&state, count] { return state->done == count; });
 }
 
 inline ThreadPool::~ThreadPool()
 {
   {
-    std::unique_lock<std::mutex> lock(queue_mutex);
-    stop = true;
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_stop = true;
   }
-  condition.notify_all();
-  for (std::thread& worker : workers)
+  m_sleepCondition.notify_all();
+  for (std::thread& worker : m_workers)
     worker.join();
 }
-
@@ -80,6 +80,10 @@ struct VDS
   std::vector<VolumeDataLayer::ProduceStatus>
                     produceStatuses;
 
+  // Bit mask of the LODs that have been produced for each dimension group, the LODs that haven't been produced are unavailable
+  std::vector<uint32_t>
+                    producedLODMasks;
+
   MetadataContainer metadataContainer;
 
   std::unique_ptr<VolumeDataLayoutImpl>
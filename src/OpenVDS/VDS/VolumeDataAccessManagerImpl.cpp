@@ -19,6 +19,7 @@
 
 #include "VDS.h"
 #include "VolumeDataPageAccessorImpl.h"
+#include "VolumeDataLODProducer.h"
 #include "VolumeDataAccessor.h"
 #include <OpenVDS/ValueConversion.h>
 #include <OpenVDS/VolumeSampler.h>
@@ -42,6 +43,7 @@ VolumeDataAccessManagerImpl::VolumeDataAccessManagerImpl(VDS &vds)
   , m_vds(vds)
   , m_requestProcessor(new VolumeDataRequestProcessor(*this))
   , m_currentErrorIndex(0)
+  , m_hasCurrentDownloadError(false)
 {
 }
 
@@ -193,8 +195,17 @@ VolumeDataAccessManagerImpl::ValidateProduceStatus(VolumeDataLayer const * volum
 {
   if (volumeDataLayer->GetProduceStatus() == VolumeDataLayer::ProduceStatus_Unavailable)
   {
+    // The chunks are produced by downsampling the nearest LOD layer below that is available
+    VolumeDataLayer const *
+      sourceLayer = volumeDataLayer->GetChildLayer();
+
+    while(sourceLayer && sourceLayer->GetProduceStatus() == VolumeDataLayer::ProduceStatus_Unavailable)
+    {
+      sourceLayer = sourceLayer->GetChildLayer();
+    }
+
     bool
-      LODProductionPossible = allowLODProduction && volumeDataLayer->GetChildLayer() && volumeDataLayer->GetChildLayer()->GetProduceStatus() == VolumeDataLayer::ProduceStatus_Normal;
+      LODProductionPossible = allowLODProduction && sourceLayer && sourceLayer->GetProduceStatus() == VolumeDataLayer::ProduceStatus_Normal && !volumeDataLayer->GetVolumeDataChannelMapping();
 
     if(!LODProductionPossible)
     {
@@ -359,17 +370,39 @@ VolumeDataAccessManagerImpl::CreateVolumeDataPageAccessor(DimensionsND dimension
 
   VolumeDataLayer *volumeDataLayer = const_cast<VolumeDataLayer *>(PrivateGetLayer(dimensionsND, channel, LOD));
 
-  if(accessMode == VolumeDataAccessManager::AccessMode_Create)
+  bool isCreate = accessMode == VolumeDataAccessManager::AccessMode_Create || accessMode == VolumeDataAccessManager::AccessMode_CreateWithLODGeneration;
+  bool isLODGeneration = accessMode == VolumeDataAccessManager::AccessMode_CreateWithLODGeneration && volumeDataLayer->GetParentLayer();
+
+  if(isCreate)
   {
-    volumeDataLayer->SetProduceStatus(VolumeDataLayer::ProduceStatus_Normal);
-    bool success = GetVolumeDataStore()->AddLayer(volumeDataLayer, chunkMetadataPageSize);
-    if(!success)
+    // When generating LODs the parent layers are created as well
+    for(VolumeDataLayer *layer = volumeDataLayer; layer; layer = isLODGeneration ? layer->GetParentLayer() : nullptr)
     {
-      throw InvalidOperation("Failed to create layer");
+      layer->SetProduceStatus(VolumeDataLayer::ProduceStatus_Normal);
+      bool success = GetVolumeDataStore()->AddLayer(layer, chunkMetadataPageSize);
+      if(!success)
+      {
+        throw InvalidOperation("Failed to create layer");
+      }
     }
   }
 
   VolumeDataPageAccessorImpl *pageAccessor = new VolumeDataPageAccessorImpl(this, ValidateProduceStatus(volumeDataLayer), maxPages, accessMode != VolumeDataAccessManager::AccessMode_ReadOnly);
+  if(isLODGeneration)
+  {
+    pageAccessor->SetLODProducer(new VolumeDataLODProducer(this, volumeDataLayer));
+  }
+  m_volumeDataPageAccessorList.InsertLast(pageAccessor);
+  return pageAccessor;
+}
+
+VolumeDataPageAccessorImpl *
+VolumeDataAccessManagerImpl::CreateVolumeDataPageAccessorWithLODProduction(DimensionsND dimensionsND, int LOD, int channel, int maxPages)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  VolumeDataPageAccessorImpl *pageAccessor = new VolumeDataPageAccessorImpl(this, ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD), true), maxPages, false);
+  pageAccessor->EnableLODProduction();
   m_volumeDataPageAccessorList.InsertLast(pageAccessor);
   return pageAccessor;
 }
@@ -403,7 +436,22 @@ VolumeDataAccessManagerImpl::RequestVolumeSubset(void *buffer, int64_t bufferByt
   {
     auto requiredBufferSize = GetVolumeSubsetBufferSize(minVoxelCoordinates, maxVoxelCoordinates, format, LOD, channel);
     ValidateBuffer(buffer, bufferByteSize, requiredBufferSize);
-    return m_requestProcessor->RequestVolumeSubset(buffer, ValidateVolumeSubset(ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD)), minVoxelCoordinates, maxVoxelCoordinates), minVoxelCoordinates, maxVoxelCoordinates, LOD, format, replacementNoValue.has_value(), replacementNoValue.value_or(0));
+    return m_requestProcessor->RequestVolumeSubset(buffer, ValidateVolumeSubset(ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD), true), minVoxelCoordinates, maxVoxelCoordinates), minVoxelCoordinates, maxVoxelCoordinates, LOD, format, replacementNoValue.has_value(), replacementNoValue.value_or(0));
+  }
+  else
+  {
+    return RaiseInvalidManagerException();
+  }
+}
+
+int64_t 
+VolumeDataAccessManagerImpl::RequestVolumeSubsetProgressive(void *buffer, int64_t bufferByteSize, DimensionsND dimensionsND, int LOD, int channel, const int (&minVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], const int (&maxVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], VolumeDataChannelDescriptor::Format format, int coarseAdaptiveLevel, std::function<void(int adaptiveLevel)> refinementCallback, optional<float> replacementNoValue)
+{
+  if (IsValid())
+  {
+    auto requiredBufferSize = GetVolumeSubsetBufferSize(minVoxelCoordinates, maxVoxelCoordinates, format, LOD, channel);
+    ValidateBuffer(buffer, bufferByteSize, requiredBufferSize);
+    return m_requestProcessor->RequestVolumeSubsetProgressive(buffer, ValidateVolumeSubset(ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD), true), minVoxelCoordinates, maxVoxelCoordinates), minVoxelCoordinates, maxVoxelCoordinates, LOD, format, replacementNoValue.has_value(), replacementNoValue.value_or(0), coarseAdaptiveLevel, refinementCallback);
   }
   else
   {
@@ -431,7 +479,7 @@ VolumeDataAccessManagerImpl::RequestProjectedVolumeSubset(void *buffer, int64_t
   {
     auto requiredBufferSize = GetProjectedVolumeSubsetBufferSize(minVoxelCoordinates, maxVoxelCoordinates, projectedDimensions, format, LOD, channel);
     ValidateBuffer(buffer, bufferByteSize, requiredBufferSize);
-    return m_requestProcessor->RequestProjectedVolumeSubset(buffer, ValidateVolumeSubset(ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD)), minVoxelCoordinates, maxVoxelCoordinates), minVoxelCoordinates, maxVoxelCoordinates, voxelPlane, DimensionGroupUtil::GetDimensionGroupFromDimensionsND(projectedDimensions), LOD, format, interpolationMethod, replacementNoValue.has_value(), replacementNoValue.value_or(0));
+    return m_requestProcessor->RequestProjectedVolumeSubset(buffer, ValidateVolumeSubset(ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD), true), minVoxelCoordinates, maxVoxelCoordinates), minVoxelCoordinates, maxVoxelCoordinates, voxelPlane, DimensionGroupUtil::GetDimensionGroupFromDimensionsND(projectedDimensions), LOD, format, interpolationMethod, replacementNoValue.has_value(), replacementNoValue.value_or(0));
   }
   else
   {
@@ -459,7 +507,7 @@ VolumeDataAccessManagerImpl::RequestVolumeSamples(float *buffer, int64_t bufferB
   {
     auto requiredBufferSize = GetVolumeSamplesBufferSize(nSampleCount, channel);
     ValidateBuffer(buffer, bufferByteSize, requiredBufferSize);
-    return m_requestProcessor->RequestVolumeSamples(buffer, ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD)), SamplePositions, nSampleCount, interpolationMethod, replacementNoValue.has_value(), replacementNoValue.value_or(0));
+    return m_requestProcessor->RequestVolumeSamples(buffer, ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD), true), SamplePositions, nSampleCount, interpolationMethod, replacementNoValue.has_value(), replacementNoValue.value_or(0));
   }
   else
   {
@@ -487,7 +535,7 @@ VolumeDataAccessManagerImpl::RequestVolumeTraces(float *buffer, int64_t bufferBy
   {
     auto requiredBufferSize = GetVolumeTracesBufferSize(traceCount, traceDimension, LOD, channel);
     ValidateBuffer(buffer, bufferByteSize, requiredBufferSize);
-    return m_requestProcessor->RequestVolumeTraces(buffer, ValidateTraceDimension(ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD)), traceDimension), tracePositions, traceCount, LOD, interpolationMethod, traceDimension, replacementNoValue.has_value(), replacementNoValue.value_or(0));
+    return m_requestProcessor->RequestVolumeTraces(buffer, ValidateTraceDimension(ValidateProduceStatus(PrivateGetLayer(dimensionsND, channel, LOD), true), traceDimension), tracePositions, traceCount, LOD, interpolationMethod, traceDimension, replacementNoValue.has_value(), replacementNoValue.value_or(0));
   }
   else
   {
@@ -669,6 +717,7 @@ void VolumeDataAccessManagerImpl::GetCurrentUploadError(const char** objectId, i
 
 void VolumeDataAccessManagerImpl::GetCurrentDownloadError(int* errorCode, const char** errorString)
 {
+  std::unique_lock<std::mutex> lock(m_currentDownloadErrorMutex);
   *errorCode = m_currentDownloadError.code;
   *errorString = m_currentDownloadError.string.c_str();
 }
@@ -22,6 +22,7 @@
 
 #include "IntrusiveList.h"
 #include "VolumeDataPageAccessorImpl.h"
+#include "VolumeDataPageCache.h"
 #include "VolumeDataLayoutImpl.h"
 #include "VolumeDataStore.h"
 
@@ -29,7 +30,9 @@
 #include "VolumeDataLayer.h"
 #include "VolumeDataRequestProcessor.h"
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include "Base64.h"
 
 namespace OpenVDS
@@ -75,6 +78,9 @@ public:
   VDSProduceStatus GetVDSProduceStatus(DimensionsND dimensionsND, int LOD, int channel) override;
   VolumeDataPageAccessor *CreateVolumeDataPageAccessor(DimensionsND dimensionsND, int LOD, int channel, int maxPages, VolumeDataAccessManager::AccessMode accessMode, int chunkMetadataPageSize = 1024) override;
 
+  // Used by the request processor, the chunks of unavailable LOD layers are produced from the nearest available LOD layer below
+  VolumeDataPageAccessorImpl *CreateVolumeDataPageAccessorWithLODProduction(DimensionsND dimensionsND, int LOD, int channel, int maxPages);
+
   void  DestroyVolumeDataPageAccessor(VolumeDataPageAccessor *volumeDataPageAccessor) override;
   void  DestroyVolumeDataAccessor(IVolumeDataAccessor *accessor) override;
   IVolumeDataAccessor * CloneVolumeDataAccessor(IVolumeDataAccessor const &accessor) override;
@@ -119,6 +125,7 @@ public:
 
   int64_t GetVolumeSubsetBufferSize(const int (&minVoxelCoordinates)[Dimensionality_Max], const int (&maxVoxelCoordinates)[Dimensionality_Max], VolumeDataChannelDescriptor::Format format, int LOD, int channel) override;
   int64_t RequestVolumeSubset(void *buffer, int64_t bufferByteSize, DimensionsND dimensionsND, int LOD, int channel, const int (&minVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], const int (&maxVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], VolumeDataChannelDescriptor::Format format, optional<float> replacementNoValue) override;
+  int64_t RequestVolumeSubsetProgressive(void *buffer, int64_t bufferByteSize, DimensionsND dimensionsND, int LOD, int channel, const int (&minVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], const int (&maxVoxelCoordinates)[VolumeDataLayout::Dimensionality_Max], VolumeDataChannelDescriptor::Format format, int coarseAdaptiveLevel, std::function<void(int adaptiveLevel)> refinementCallback, optional<float> replacementNoValue) override;
   int64_t GetProjectedVolumeSubsetBufferSize(const int (&minVoxelCoordinates)[Dimensionality_Max], const int (&maxVoxelCoordinates)[Dimensionality_Max], DimensionsND projectedDimensions, VolumeDataChannelDescriptor::Format format, int LOD, int channel) override;
   int64_t RequestProjectedVolumeSubset(void *buffer, int64_t bufferByteSize, DimensionsND dimensionsND, int LOD, int channel, const int (&minVoxelCoordinates)[Dimensionality_Max], const int (&maxVoxelCoordinates)[Dimensionality_Max], FloatVector4 const &voxelPlane, DimensionsND projectedDimensions, VolumeDataChannelDescriptor::Format format, InterpolationMethod interpolationMethod, optional<float> replacementNoValue) override;
   int64_t GetVolumeSamplesBufferSize(int sampleCount, int channel) override;
@@ -128,6 +135,7 @@ public:
   int64_t PrefetchVolumeChunk(DimensionsND dimensionsND, int LOD, int channel, int64_t chunkIndex) override;
 
   VolumeDataStore *GetVolumeDataStore();
+  VolumeDataPageCache &GetPageCache() { return m_pageCache; }
   void AddUploadError(Error const &error, const std::string &url);
 
   void FlushUploadQueue(bool writeUpdatedLayerStatus = true) override;
@@ -140,7 +148,12 @@ public:
  
   void SetCurrentDownloadError(const Error& error)
   {
+    // Clearing an already clear error is the common case when polling requests, so it doesn't take the lock
+    if (!error.code && !m_hasCurrentDownloadError)
+      return;
+    std::unique_lock<std::mutex> lock(m_currentDownloadErrorMutex);
     m_currentDownloadError = error;
+    m_hasCurrentDownloadError = error.code != 0;
   }
 
   int CountActivePages() { return m_requestProcessor->CountActivePages(); }
@@ -148,12 +161,15 @@ private:
   std::atomic<int> m_refCount;
   bool m_invalidated;
   VDS &m_vds;
+  VolumeDataPageCache m_pageCache;
   std::unique_ptr<VolumeDataRequestProcessor> m_requestProcessor;
   IntrusiveList<VolumeDataPageAccessorImpl, &VolumeDataPageAccessorImpl::m_volumeDataPageAccessorListNode> m_volumeDataPageAccessorList;
   std::mutex m_mutex;
   std::vector<std::unique_ptr<UploadError>> m_uploadErrors;
   uint32_t m_currentErrorIndex;
   Error m_currentDownloadError;
+  std::atomic<bool> m_hasCurrentDownloadError;
+  std::mutex m_currentDownloadErrorMutex;
 };
 
 }
@@ -0,0 +1,93 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef VOLUMEDATACHUNKSET_H
+#define VOLUMEDATACHUNKSET_H
+
+#include "VolumeDataChunk.h"
+#include "VolumeDataLayer.h"
+#include "VolumeDataRegion.h"
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace OpenVDS
+{
+
+// Collects the unique chunks of a layer that a request needs, in the order they are first added. Layers with a moderate
+// number of chunks use a bitset over all chunk indices for the membership test, larger layers use a hash set so the
+// cost only depends on the number of chunks added.
+class VolumeDataChunkSet
+{
+  static const int64_t BITSET_MAX_CHUNKS = int64_t(1) << 20;
+
+  VolumeDataLayer const *m_layer;
+  std::vector<uint64_t> m_bitset;
+  std::unordered_set<int64_t> m_hashed;
+  std::vector<VolumeDataChunk> m_chunks;
+
+public:
+  explicit VolumeDataChunkSet(VolumeDataLayer const *layer)
+    : m_layer(layer)
+  {
+    int64_t chunkCount = layer->GetTotalChunkCount();
+    if (chunkCount <= BITSET_MAX_CHUNKS)
+    {
+      m_bitset.resize(size_t((chunkCount + 63) / 64));
+    }
+  }
+
+  // Returns true if the chunk was not already in the set
+  bool Add(int64_t chunkIndex)
+  {
+    if (!m_bitset.empty())
+    {
+      uint64_t &word = m_bitset[size_t(chunkIndex >> 6)];
+      uint64_t bit = uint64_t(1) << (chunkIndex & 63);
+      if (word & bit) return false;
+      word |= bit;
+    }
+    else if (!m_hashed.insert(chunkIndex).second)
+    {
+      return false;
+    }
+
+    m_chunks.push_back(m_layer->GetChunkFromIndex(chunkIndex));
+    return true;
+  }
+
+  // Add all chunks intersecting the region given in voxel coordinates
+  void AddRegion(const IndexArray &min, const IndexArray &max)
+  {
+    VolumeDataRegion region(*m_layer, min, max);
+
+    int64_t chunksInRegion = region.GetNumChunksInRegion();
+    for (int64_t chunkInRegion = 0; chunkInRegion < chunksInRegion; chunkInRegion++)
+    {
+      Add(region.GetChunkIndexInRegion(chunkInRegion));
+    }
+  }
+
+  bool IsEmpty() const { return m_chunks.empty(); }
+
+  const std::vector<VolumeDataChunk> &GetChunks() const { return m_chunks; }
+};
+
+}
+
+#endif //VOLUMEDATACHUNKSET_H
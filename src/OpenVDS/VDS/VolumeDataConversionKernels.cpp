@@ -0,0 +1,589 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include "VolumeDataConversionKernels.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ENABLE_SSE_CONVERSION 1
+#endif
+
+#ifdef ENABLE_SSE_CONVERSION
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define CONVERSION_TARGET_SSE41
+#define CONVERSION_TARGET_AVX2
+#else
+// The AVX2 kernels are compiled for their own target and selected at runtime
+#define CONVERSION_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define CONVERSION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// The kernels are called for every row of a block copy, so the AVX2 kernels clear the upper halves of the registers
+// before returning to avoid the transition penalty in the SSE code that follows (compilers only do this when
+// optimizing).
+//
+// The quantization to U8/U16 clamps the bucket to [0, buckets - 1] before rounding, which gives the same result as the
+// comparisons in QuantizeValueWithReciprocalScale (also for NaN, which ends up in bucket 0).
+
+namespace OpenVDS
+{
+namespace ConversionKernels
+{
+
+template<typename T> struct IsQuantized : std::integral_constant<bool, !std::is_same<T, float>::value> {};
+
+/////////////////////////////////////////////////////////////////////////////
+// Scalar
+
+template<typename S>
+static float ToFloat(S value, const ValueConversion &conversion)
+{
+  return conversion.integerOffset + conversion.integerScale * value;
+}
+
+static float ToFloat(float value, const ValueConversion &)
+{
+  return value;
+}
+
+template<typename T>
+static T FromFloat(float value, const ValueConversion &conversion)
+{
+  return T(QuantizeValueWithReciprocalScale(value, conversion.valueRangeMin, conversion.reciprocalScale, conversion.buckets));
+}
+
+template<>
+float FromFloat<float>(float value, const ValueConversion &)
+{
+  return value;
+}
+
+template<typename T, typename S, bool isUseNoValue>
+static void ConvertScalar(T *target, const S *source, const ValueConversion &conversion, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    S value = source[i];
+    target[i] = (isUseNoValue && value == S(conversion.noValue)) ? T(conversion.replacementNoValue) : FromFloat<T>(ToFloat(value, conversion), conversion);
+  }
+}
+
+template<typename S, bool isUseNoValue>
+static void PackScalar(uint8_t *target, const S *source, const ValueConversion &conversion, float noValue, int byteCount)
+{
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    uint8_t bits = 0;
+    for (int bit = 0; bit < 8; bit++)
+    {
+      S sourceValue = source[byte * 8 + bit];
+      float value = (isUseNoValue && sourceValue == S(conversion.noValue)) ? conversion.replacementNoValue : ToFloat(sourceValue, conversion);
+      if ((!isUseNoValue || value != noValue) && value != 0.0f)
+      {
+        bits |= uint8_t(1 << bit);
+      }
+    }
+    target[byte] = bits;
+  }
+}
+
+template<typename T>
+static void UnpackScalar(T *target, const uint8_t *source, int byteCount)
+{
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    for (int bit = 0; bit < 8; bit++)
+    {
+      target[byte * 8 + bit] = (source[byte] & (1 << bit)) ? T(1) : T(0);
+    }
+  }
+}
+
+#ifdef ENABLE_SSE_CONVERSION
+
+/////////////////////////////////////////////////////////////////////////////
+// SSE4.1, four values per iteration
+
+struct SetupSSE41
+{
+  __m128  integerScale;
+  __m128  integerOffset;
+  __m128  valueRangeMin;
+  __m128  reciprocalScale;
+  __m128  maxBucket;
+  __m128  noValue;
+  __m128  replacementNoValue;
+  __m128i replacementNoValueInt;
+
+  CONVERSION_TARGET_SSE41 explicit SetupSSE41(const ValueConversion &conversion)
+    : integerScale(_mm_set1_ps(conversion.integerScale))
+    , integerOffset(_mm_set1_ps(conversion.integerOffset))
+    , valueRangeMin(_mm_set1_ps(conversion.valueRangeMin))
+    , reciprocalScale(_mm_set1_ps(conversion.reciprocalScale))
+    , maxBucket(_mm_set1_ps(float(conversion.buckets - 1)))
+    , noValue(_mm_set1_ps(conversion.noValue))
+    , replacementNoValue(_mm_set1_ps(conversion.replacementNoValue))
+    , replacementNoValueInt(_mm_set1_epi32(conversion.buckets ? int(conversion.replacementNoValue) : 0))
+  {
+  }
+};
+
+CONVERSION_TARGET_SSE41 static inline __m128 Load4(const uint8_t *source)
+{
+  int32_t bytes;
+  memcpy(&bytes, source, sizeof(bytes));
+  return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes)));
+}
+
+CONVERSION_TARGET_SSE41 static inline __m128 Load4(const uint16_t *source)
+{
+  return _mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(source))));
+}
+
+CONVERSION_TARGET_SSE41 static inline __m128 Load4(const float *source)
+{
+  return _mm_loadu_ps(source);
+}
+
+CONVERSION_TARGET_SSE41 static inline __m128i Quantize4(__m128 value, const SetupSSE41 &setup)
+{
+  __m128 bucket = _mm_mul_ps(_mm_sub_ps(value, setup.valueRangeMin), setup.reciprocalScale);
+  bucket = _mm_min_ps(_mm_max_ps(bucket, _mm_setzero_ps()), setup.maxBucket);
+  return _mm_cvttps_epi32(_mm_add_ps(bucket, _mm_set1_ps(0.5f)));
+}
+
+CONVERSION_TARGET_SSE41 static inline void Store4(float *target, __m128 value, __m128 isNoValue, const SetupSSE41 &setup)
+{
+  _mm_storeu_ps(target, _mm_blendv_ps(value, setup.replacementNoValue, isNoValue));
+}
+
+CONVERSION_TARGET_SSE41 static inline void Store4(uint8_t *target, __m128 value, __m128 isNoValue, const SetupSSE41 &setup)
+{
+  __m128i quantized = _mm_blendv_epi8(Quantize4(value, setup), setup.replacementNoValueInt, _mm_castps_si128(isNoValue));
+  quantized = _mm_packus_epi32(quantized, quantized);
+  int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(quantized, quantized));
+  memcpy(target, &bytes, sizeof(bytes));
+}
+
+CONVERSION_TARGET_SSE41 static inline void Store4(uint16_t *target, __m128 value, __m128 isNoValue, const SetupSSE41 &setup)
+{
+  __m128i quantized = _mm_blendv_epi8(Quantize4(value, setup), setup.replacementNoValueInt, _mm_castps_si128(isNoValue));
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(target), _mm_packus_epi32(quantized, quantized));
+}
+
+template<typename S, bool isUseNoValue>
+CONVERSION_TARGET_SSE41 static inline __m128 LoadAndConvert4(const S *source, __m128 &isNoValue, const SetupSSE41 &setup)
+{
+  __m128 value = Load4(source);
+  isNoValue = isUseNoValue ? _mm_cmpeq_ps(value, setup.noValue) : _mm_setzero_ps();
+  return IsQuantized<S>::value ? _mm_add_ps(setup.integerOffset, _mm_mul_ps(setup.integerScale, value)) : value;
+}
+
+template<typename T, typename S, bool isUseNoValue>
+CONVERSION_TARGET_SSE41 static int ConvertSSE41(T *target, const S *source, const ValueConversion &conversion, int count)
+{
+  SetupSSE41 setup(conversion);
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 isNoValue;
+    __m128 value = LoadAndConvert4<S, isUseNoValue>(source + i, isNoValue, setup);
+    Store4(target + i, value, isNoValue, setup);
+  }
+  return i;
+}
+
+template<typename S, bool isUseNoValue>
+CONVERSION_TARGET_SSE41 static inline int PackMask4(const S *source, __m128 bitNoValue, const SetupSSE41 &setup)
+{
+  __m128 isNoValue;
+  __m128 value = LoadAndConvert4<S, isUseNoValue>(source, isNoValue, setup);
+  if (isUseNoValue)
+  {
+    value = _mm_blendv_ps(value, setup.replacementNoValue, isNoValue);
+  }
+  __m128 isSet = _mm_cmpneq_ps(value, _mm_setzero_ps());
+  if (isUseNoValue)
+  {
+    isSet = _mm_and_ps(isSet, _mm_cmpneq_ps(value, bitNoValue));
+  }
+  return _mm_movemask_ps(isSet);
+}
+
+template<typename S, bool isUseNoValue>
+CONVERSION_TARGET_SSE41 static int PackSSE41(uint8_t *target, const S *source, const ValueConversion &conversion, float noValue, int byteCount)
+{
+  SetupSSE41 setup(conversion);
+  __m128 bitNoValue = _mm_set1_ps(noValue);
+
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    target[byte] = uint8_t(PackMask4<S, isUseNoValue>(source + byte * 8, bitNoValue, setup) | (PackMask4<S, isUseNoValue>(source + byte * 8 + 4, bitNoValue, setup) << 4));
+  }
+  return byteCount;
+}
+
+CONVERSION_TARGET_SSE41 static int UnpackSSE41(uint8_t *target, const uint8_t *source, int byteCount)
+{
+  const __m128i bitMask = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+  const __m128i one = _mm_set1_epi8(1);
+
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    __m128i bits = _mm_and_si128(_mm_set1_epi8(char(source[byte])), bitMask);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(target + byte * 8), _mm_and_si128(_mm_cmpeq_epi8(bits, bitMask), one));
+  }
+  return byteCount;
+}
+
+CONVERSION_TARGET_SSE41 static int UnpackSSE41(uint16_t *target, const uint8_t *source, int byteCount)
+{
+  const __m128i bitMask = _mm_set_epi16(128, 64, 32, 16, 8, 4, 2, 1);
+  const __m128i one = _mm_set1_epi16(1);
+
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    __m128i bits = _mm_and_si128(_mm_set1_epi16(short(source[byte])), bitMask);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(target + byte * 8), _mm_and_si128(_mm_cmpeq_epi16(bits, bitMask), one));
+  }
+  return byteCount;
+}
+
+CONVERSION_TARGET_SSE41 static int UnpackSSE41(float *target, const uint8_t *source, int byteCount)
+{
+  const __m128i bitMaskLow = _mm_set_epi32(8, 4, 2, 1);
+  const __m128i bitMaskHigh = _mm_set_epi32(128, 64, 32, 16);
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    __m128i value = _mm_set1_epi32(source[byte]);
+    __m128 isSetLow = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(value, bitMaskLow), bitMaskLow));
+    __m128 isSetHigh = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(value, bitMaskHigh), bitMaskHigh));
+    _mm_storeu_ps(target + byte * 8, _mm_and_ps(isSetLow, one));
+    _mm_storeu_ps(target + byte * 8 + 4, _mm_and_ps(isSetHigh, one));
+  }
+  return byteCount;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AVX2, eight values per iteration
+
+struct SetupAVX2
+{
+  __m256  integerScale;
+  __m256  integerOffset;
+  __m256  valueRangeMin;
+  __m256  reciprocalScale;
+  __m256  maxBucket;
+  __m256  noValue;
+  __m256  replacementNoValue;
+  __m256i replacementNoValueInt;
+
+  CONVERSION_TARGET_AVX2 explicit SetupAVX2(const ValueConversion &conversion)
+    : integerScale(_mm256_set1_ps(conversion.integerScale))
+    , integerOffset(_mm256_set1_ps(conversion.integerOffset))
+    , valueRangeMin(_mm256_set1_ps(conversion.valueRangeMin))
+    , reciprocalScale(_mm256_set1_ps(conversion.reciprocalScale))
+    , maxBucket(_mm256_set1_ps(float(conversion.buckets - 1)))
+    , noValue(_mm256_set1_ps(conversion.noValue))
+    , replacementNoValue(_mm256_set1_ps(conversion.replacementNoValue))
+    , replacementNoValueInt(_mm256_set1_epi32(conversion.buckets ? int(conversion.replacementNoValue) : 0))
+  {
+  }
+};
+
+CONVERSION_TARGET_AVX2 static inline __m256 Load8(const uint8_t *source)
+{
+  return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(source))));
+}
+
+CONVERSION_TARGET_AVX2 static inline __m256 Load8(const uint16_t *source)
+{
+  return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source))));
+}
+
+CONVERSION_TARGET_AVX2 static inline __m256 Load8(const float *source)
+{
+  return _mm256_loadu_ps(source);
+}
+
+// Quantize and pack to eight unsigned 16-bit values
+CONVERSION_TARGET_AVX2 static inline __m128i Quantize8(__m256 value, __m256 isNoValue, const SetupAVX2 &setup)
+{
+  __m256 bucket = _mm256_mul_ps(_mm256_sub_ps(value, setup.valueRangeMin), setup.reciprocalScale);
+  bucket = _mm256_min_ps(_mm256_max_ps(bucket, _mm256_setzero_ps()), setup.maxBucket);
+  __m256i quantized = _mm256_cvttps_epi32(_mm256_add_ps(bucket, _mm256_set1_ps(0.5f)));
+  quantized = _mm256_blendv_epi8(quantized, setup.replacementNoValueInt, _mm256_castps_si256(isNoValue));
+  return _mm_packus_epi32(_mm256_castsi256_si128(quantized), _mm256_extracti128_si256(quantized, 1));
+}
+
+CONVERSION_TARGET_AVX2 static inline void Store8(float *target, __m256 value, __m256 isNoValue, const SetupAVX2 &setup)
+{
+  _mm256_storeu_ps(target, _mm256_blendv_ps(value, setup.replacementNoValue, isNoValue));
+}
+
+CONVERSION_TARGET_AVX2 static inline void Store8(uint8_t *target, __m256 value, __m256 isNoValue, const SetupAVX2 &setup)
+{
+  __m128i quantized = Quantize8(value, isNoValue, setup);
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(target), _mm_packus_epi16(quantized, quantized));
+}
+
+CONVERSION_TARGET_AVX2 static inline void Store8(uint16_t *target, __m256 value, __m256 isNoValue, const SetupAVX2 &setup)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(target), Quantize8(value, isNoValue, setup));
+}
+
+template<typename S, bool isUseNoValue>
+CONVERSION_TARGET_AVX2 static inline __m256 LoadAndConvert8(const S *source, __m256 &isNoValue, const SetupAVX2 &setup)
+{
+  __m256 value = Load8(source);
+  isNoValue = isUseNoValue ? _mm256_cmp_ps(value, setup.noValue, _CMP_EQ_OQ) : _mm256_setzero_ps();
+  return IsQuantized<S>::value ? _mm256_add_ps(setup.integerOffset, _mm256_mul_ps(setup.integerScale, value)) : value;
+}
+
+template<typename T, typename S, bool isUseNoValue>
+CONVERSION_TARGET_AVX2 static int ConvertAVX2(T *target, const S *source, const ValueConversion &conversion, int count)
+{
+  SetupAVX2 setup(conversion);
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 isNoValue;
+    __m256 value = LoadAndConvert8<S, isUseNoValue>(source + i, isNoValue, setup);
+    Store8(target + i, value, isNoValue, setup);
+  }
+  _mm256_zeroupper();
+  return i;
+}
+
+template<typename S, bool isUseNoValue>
+CONVERSION_TARGET_AVX2 static int PackAVX2(uint8_t *target, const S *source, const ValueConversion &conversion, float noValue, int byteCount)
+{
+  SetupAVX2 setup(conversion);
+  __m256 bitNoValue = _mm256_set1_ps(noValue);
+
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    __m256 isNoValue;
+    __m256 value = LoadAndConvert8<S, isUseNoValue>(source + byte * 8, isNoValue, setup);
+    if (isUseNoValue)
+    {
+      value = _mm256_blendv_ps(value, setup.replacementNoValue, isNoValue);
+    }
+    __m256 isSet = _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+    if (isUseNoValue)
+    {
+      isSet = _mm256_and_ps(isSet, _mm256_cmp_ps(value, bitNoValue, _CMP_NEQ_UQ));
+    }
+    target[byte] = uint8_t(_mm256_movemask_ps(isSet));
+  }
+  _mm256_zeroupper();
+  return byteCount;
+}
+
+CONVERSION_TARGET_AVX2 static int UnpackAVX2(uint8_t *target, const uint8_t *source, int byteCount)
+{
+  // Each 128-bit lane spreads two of the four source bytes to eight bytes each
+  const __m256i spread = _mm256_set_epi8(3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i bitMask = _mm256_set1_epi64x(int64_t(0x8040201008040201ull));
+  const __m256i one = _mm256_set1_epi8(1);
+
+  int byte = 0;
+  for (; byte + 4 <= byteCount; byte += 4)
+  {
+    int32_t bytes;
+    memcpy(&bytes, source + byte, sizeof(bytes));
+    __m256i bits = _mm256_and_si256(_mm256_shuffle_epi8(_mm256_set1_epi32(bytes), spread), bitMask);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + byte * 8), _mm256_and_si256(_mm256_cmpeq_epi8(bits, bitMask), one));
+  }
+  _mm256_zeroupper();
+  return byte;
+}
+
+CONVERSION_TARGET_AVX2 static int UnpackAVX2(uint16_t *target, const uint8_t *source, int byteCount)
+{
+  // The low lane tests the bits of the first source byte and the high lane the bits of the second
+  const __m256i bitMask = _mm256_set_epi16(-32768, 16384, 8192, 4096, 2048, 1024, 512, 256, 128, 64, 32, 16, 8, 4, 2, 1);
+  const __m256i one = _mm256_set1_epi16(1);
+
+  int byte = 0;
+  for (; byte + 2 <= byteCount; byte += 2)
+  {
+    __m256i bits = _mm256_and_si256(_mm256_set1_epi16(short(source[byte] | (source[byte + 1] << 8))), bitMask);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + byte * 8), _mm256_and_si256(_mm256_cmpeq_epi16(bits, bitMask), one));
+  }
+  _mm256_zeroupper();
+  return byte;
+}
+
+CONVERSION_TARGET_AVX2 static int UnpackAVX2(float *target, const uint8_t *source, int byteCount)
+{
+  const __m256i bitMask = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+  const __m256 one = _mm256_set1_ps(1.0f);
+
+  for (int byte = 0; byte < byteCount; byte++)
+  {
+    __m256i bits = _mm256_and_si256(_mm256_set1_epi32(source[byte]), bitMask);
+    _mm256_storeu_ps(target + byte * 8, _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(bits, bitMask)), one));
+  }
+  _mm256_zeroupper();
+  return byteCount;
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Runtime dispatch
+
+template<typename T, typename S, bool isUseNoValue>
+static void ConvertWithKernel(InstructionSet instructionSet, T *target, const S *source, const ValueConversion &conversion, int count)
+{
+  int done = 0;
+
+#ifdef ENABLE_SSE_CONVERSION
+  switch (instructionSet)
+  {
+  case InstructionSet::AVX2:  done = ConvertAVX2<T, S, isUseNoValue>(target, source, conversion, count); break;
+  case InstructionSet::SSE41: done = ConvertSSE41<T, S, isUseNoValue>(target, source, conversion, count); break;
+  default: break;
+  }
+#else
+  (void)instructionSet;
+#endif
+
+  // The values that don't fill a whole vector
+  ConvertScalar<T, S, isUseNoValue>(target + done, source + done, conversion, count - done);
+}
+
+template<typename T, typename S>
+static void ConvertWithKernel(InstructionSet instructionSet, void *target, const void *source, const ValueConversion &conversion, int count)
+{
+  if (conversion.isUseNoValue)
+    ConvertWithKernel<T, S, true>(instructionSet, static_cast<T *>(target), static_cast<const S *>(source), conversion, count);
+  else
+    ConvertWithKernel<T, S, false>(instructionSet, static_cast<T *>(target), static_cast<const S *>(source), conversion, count);
+}
+
+template<typename T>
+static void ConvertWithKernel(InstructionSet instructionSet, void *target, VolumeDataChannelDescriptor::Format sourceFormat, const void *source, const ValueConversion &conversion, int count)
+{
+  switch (sourceFormat)
+  {
+  case VolumeDataChannelDescriptor::Format_U8:  return ConvertWithKernel<T, uint8_t>(instructionSet, target, source, conversion, count);
+  case VolumeDataChannelDescriptor::Format_U16: return ConvertWithKernel<T, uint16_t>(instructionSet, target, source, conversion, count);
+  case VolumeDataChannelDescriptor::Format_R32: return ConvertWithKernel<T, float>(instructionSet, target, source, conversion, count);
+  default:
+    throw std::runtime_error("Source format not supported by the conversion kernels");
+  }
+}
+
+void
+ConvertValues(InstructionSet instructionSet, VolumeDataChannelDescriptor::Format targetFormat, void *target, VolumeDataChannelDescriptor::Format sourceFormat, const void *source, const ValueConversion &conversion, int count)
+{
+  switch (targetFormat)
+  {
+  case VolumeDataChannelDescriptor::Format_U8:  return ConvertWithKernel<uint8_t>(instructionSet, target, sourceFormat, source, conversion, count);
+  case VolumeDataChannelDescriptor::Format_U16: return ConvertWithKernel<uint16_t>(instructionSet, target, sourceFormat, source, conversion, count);
+  case VolumeDataChannelDescriptor::Format_R32: return ConvertWithKernel<float>(instructionSet, target, sourceFormat, source, conversion, count);
+  default:
+    throw std::runtime_error("Target format not supported by the conversion kernels");
+  }
+}
+
+template<typename S, bool isUseNoValue>
+static void PackWithKernel(InstructionSet instructionSet, uint8_t *target, const S *source, const ValueConversion &conversion, float noValue, int byteCount)
+{
+  int done = 0;
+
+#ifdef ENABLE_SSE_CONVERSION
+  switch (instructionSet)
+  {
+  case InstructionSet::AVX2:  done = PackAVX2<S, isUseNoValue>(target, source, conversion, noValue, byteCount); break;
+  case InstructionSet::SSE41: done = PackSSE41<S, isUseNoValue>(target, source, conversion, noValue, byteCount); break;
+  default: break;
+  }
+#else
+  (void)instructionSet;
+#endif
+
+  PackScalar<S, isUseNoValue>(target + done, source + done * 8, conversion, noValue, byteCount - done);
+}
+
+template<typename S>
+static void PackWithKernel(InstructionSet instructionSet, uint8_t *target, const void *source, const ValueConversion &conversion, float noValue, int byteCount)
+{
+  if (conversion.isUseNoValue)
+    PackWithKernel<S, true>(instructionSet, target, static_cast<const S *>(source), conversion, noValue, byteCount);
+  else
+    PackWithKernel<S, false>(instructionSet, target, static_cast<const S *>(source), conversion, noValue, byteCount);
+}
+
+void
+PackBits(InstructionSet instructionSet, uint8_t *target, VolumeDataChannelDescriptor::Format sourceFormat, const void *source, const ValueConversion &conversion, float noValue, int byteCount)
+{
+  switch (sourceFormat)
+  {
+  case VolumeDataChannelDescriptor::Format_U8:  return PackWithKernel<uint8_t>(instructionSet, target, source, conversion, noValue, byteCount);
+  case VolumeDataChannelDescriptor::Format_U16: return PackWithKernel<uint16_t>(instructionSet, target, source, conversion, noValue, byteCount);
+  case VolumeDataChannelDescriptor::Format_R32: return PackWithKernel<float>(instructionSet, target, source, conversion, noValue, byteCount);
+  default:
+    throw std::runtime_error("Source format not supported by the conversion kernels");
+  }
+}
+
+template<typename T>
+static void UnpackWithKernel(InstructionSet instructionSet, void *target, const uint8_t *source, int byteCount)
+{
+  T *targetT = static_cast<T *>(target);
+  int done = 0;
+
+#ifdef ENABLE_SSE_CONVERSION
+  switch (instructionSet)
+  {
+  case InstructionSet::AVX2:  done = UnpackAVX2(targetT, source, byteCount); break;
+  case InstructionSet::SSE41: done = UnpackSSE41(targetT, source, byteCount); break;
+  default: break;
+  }
+#else
+  (void)instructionSet;
+#endif
+
+  UnpackScalar(targetT + done * 8, source + done, byteCount - done);
+}
+
+void
+UnpackBits(InstructionSet instructionSet, VolumeDataChannelDescriptor::Format targetFormat, void *target, const uint8_t *source, int byteCount)
+{
+  switch (targetFormat)
+  {
+  case VolumeDataChannelDescriptor::Format_U8:  return UnpackWithKernel<uint8_t>(instructionSet, target, source, byteCount);
+  case VolumeDataChannelDescriptor::Format_U16: return UnpackWithKernel<uint16_t>(instructionSet, target, source, byteCount);
+  case VolumeDataChannelDescriptor::Format_R32: return UnpackWithKernel<float>(instructionSet, target, source, byteCount);
+  default:
+    throw std::runtime_error("Target format not supported by the conversion kernels");
+  }
+}
+
+} // end namespace ConversionKernels
+}
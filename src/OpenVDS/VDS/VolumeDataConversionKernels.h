@@ -0,0 +1,114 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef VOLUMEDATACONVERSIONKERNELS_H
+#define VOLUMEDATACONVERSIONKERNELS_H
+
+#include "VolumeDataSampleKernels.h"
+
+#include <OpenVDS/VolumeDataChannelDescriptor.h>
+#include <OpenVDS/ValueConversion.h>
+
+#include <cstdint>
+#include <type_traits>
+
+namespace OpenVDS
+{
+
+// Vectorized format conversion of rows of samples, used by the block copy of the RequestVolumeSubset processing.
+// The kernels give the same results as QuantizingValueConverterWithNoValue for the U8, U16 and R32 formats, and pack
+// and unpack 1-bit rows in whole bytes. The instruction set is selected at runtime in the same way as for the sample
+// kernels.
+namespace ConversionKernels
+{
+
+using SampleKernels::InstructionSet;
+using SampleKernels::SupportedInstructionSet;
+using SampleKernels::InstructionSetName;
+
+template<typename T> struct ElementFormat           { static const VolumeDataChannelDescriptor::Format format = VolumeDataChannelDescriptor::Format_Any; };
+template<>           struct ElementFormat<uint8_t>  { static const VolumeDataChannelDescriptor::Format format = VolumeDataChannelDescriptor::Format_U8; };
+template<>           struct ElementFormat<uint16_t> { static const VolumeDataChannelDescriptor::Format format = VolumeDataChannelDescriptor::Format_U16; };
+template<>           struct ElementFormat<float>    { static const VolumeDataChannelDescriptor::Format format = VolumeDataChannelDescriptor::Format_R32; };
+
+inline bool IsFormatSupported(VolumeDataChannelDescriptor::Format format)
+{
+  return format == VolumeDataChannelDescriptor::Format_U8 || format == VolumeDataChannelDescriptor::Format_U16 || format == VolumeDataChannelDescriptor::Format_R32;
+}
+
+// The conversion from a source to a target element type, with the same values as the members of the corresponding
+// QuantizingValueConverterWithNoValue
+struct ValueConversion
+{
+  float   integerScale;       // Quantized source to float
+  float   integerOffset;
+  float   valueRangeMin;      // Float to quantized target
+  float   reciprocalScale;
+  int32_t buckets;
+  bool    isUseNoValue;
+  float   noValue;            // No-value in the source type
+  float   replacementNoValue; // Replacement in the target type
+};
+
+template<typename T, typename S>
+ValueConversion CreateValueConversion(float valueRangeMin, float valueRangeMax, float integerScale, float integerOffset, float noValue, float replacementNoValue, bool isUseNoValue)
+{
+  ValueConversion conversion;
+  conversion.integerScale = integerScale;
+  conversion.integerOffset = integerOffset;
+  conversion.valueRangeMin = valueRangeMin;
+  conversion.reciprocalScale = isUseNoValue ? ResultConverter<T, true>::ReciprocalScale(valueRangeMin, valueRangeMax) : ResultConverter<T, false>::ReciprocalScale(valueRangeMin, valueRangeMax);
+  conversion.buckets = std::is_same<T, uint8_t>::value  ? 256 - isUseNoValue :
+                       std::is_same<T, uint16_t>::value ? 65536 - isUseNoValue :
+                                                          0;
+  conversion.isUseNoValue = isUseNoValue;
+  conversion.noValue = float(ConvertNoValue<S>(noValue));
+  conversion.replacementNoValue = float(ConvertNoValue<T>(replacementNoValue));
+  return conversion;
+}
+
+// Convert count values, target[i] = QuantizingValueConverterWithNoValue<T, S, isUseNoValue>::ConvertValue(source[i])
+void ConvertValues(InstructionSet instructionSet, VolumeDataChannelDescriptor::Format targetFormat, void *target, VolumeDataChannelDescriptor::Format sourceFormat, const void *source, const ValueConversion &conversion, int count);
+
+// Pack byteCount * 8 values to bits. The conversion must be created for a float target, a bit is set when the converted
+// value is non-zero and (if the no-value is used) different from noValue.
+void PackBits(InstructionSet instructionSet, uint8_t *target, VolumeDataChannelDescriptor::Format sourceFormat, const void *source, const ValueConversion &conversion, float noValue, int byteCount);
+
+// Unpack byteCount bytes to byteCount * 8 values of 0 or 1
+void UnpackBits(InstructionSet instructionSet, VolumeDataChannelDescriptor::Format targetFormat, void *target, const uint8_t *source, int byteCount);
+
+// Convert, pack and unpack using the best supported instruction set
+inline void ConvertValues(VolumeDataChannelDescriptor::Format targetFormat, void *target, VolumeDataChannelDescriptor::Format sourceFormat, const void *source, const ValueConversion &conversion, int count)
+{
+  ConvertValues(SupportedInstructionSet(), targetFormat, target, sourceFormat, source, conversion, count);
+}
+
+inline void PackBits(uint8_t *target, VolumeDataChannelDescriptor::Format sourceFormat, const void *source, const ValueConversion &conversion, float noValue, int byteCount)
+{
+  PackBits(SupportedInstructionSet(), target, sourceFormat, source, conversion, noValue, byteCount);
+}
+
+inline void UnpackBits(VolumeDataChannelDescriptor::Format targetFormat, void *target, const uint8_t *source, int byteCount)
+{
+  UnpackBits(SupportedInstructionSet(), targetFormat, target, source, byteCount);
+}
+
+} // end namespace ConversionKernels
+
+}
+
+#endif //VOLUMEDATACONVERSIONKERNELS_H
@@ -0,0 +1,635 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include "VolumeDataLODProducer.h"
+
+#include "VolumeDataLayer.h"
+#include "VolumeDataPageAccessorImpl.h"
+#include "VolumeDataAccessManagerImpl.h"
+#include "DataBlock.h"
+#include "DimensionGroup.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define ENABLE_SSE_LOD 1
+
+#ifdef ENABLE_SSE_LOD
+#include <smmintrin.h>
+#endif
+
+namespace OpenVDS
+{
+
+// Each parent sample is made from at most two child samples in every chunked dimension
+static const int MAX_SOURCE_ROWS = 1 << (Dimensionality_Max - 1);
+
+// The samples of one row (along dimension 0) of the parent chunk and the child rows they are made from
+template<typename T>
+struct DownsampleRow
+{
+  T          *target;
+  int32_t     targetPitch;
+  const T    *sources[MAX_SOURCE_ROWS];
+  int         sourceCount;
+  int32_t     sourceStep;  // Distance between the first child samples of consecutive parent samples
+  int32_t     pairOffset;  // Distance to the second child sample, or 0 if the dimension is not decimated
+  int         count;
+  int         pairCount;   // The number of parent samples that have a second child sample
+};
+
+template<typename T>
+static inline bool IsValid(T value, T noValue, bool isNoValueNaN)
+{
+  return isNoValueNaN ? !std::isnan(value) : value != noValue;
+}
+
+template<typename T, bool useNoValue>
+static void AverageRowFloat(DownsampleRow<T> const &row, int start, T noValue, bool isNoValueNaN)
+{
+  for(int sample = start; sample < row.count; sample++)
+  {
+    int32_t sourceIndex = sample * row.sourceStep;
+    bool isPair = sample < row.pairCount;
+    T sum = T(0);
+    int validCount = 0;
+
+    for(int source = 0; source < row.sourceCount; source++)
+    {
+      T a = row.sources[source][sourceIndex];
+      T b = isPair ? row.sources[source][sourceIndex + row.pairOffset] : T(0);
+
+      if(useNoValue)
+      {
+        bool isValidA = IsValid(a, noValue, isNoValueNaN);
+        bool isValidB = isPair && IsValid(b, noValue, isNoValueNaN);
+        sum += (isValidA ? a : T(0)) + (isValidB ? b : T(0));
+        validCount += int(isValidA) + int(isValidB);
+      }
+      else
+      {
+        sum += a + b;
+        validCount += isPair ? 2 : 1;
+      }
+    }
+
+    row.target[sample * row.targetPitch] = validCount ? sum / T(validCount) : noValue;
+  }
+}
+
+#ifdef ENABLE_SSE_LOD
+// Average rows of contiguous floats where every parent sample is made from a pair of child samples in dimension 0
+template<bool useNoValue>
+static int AverageRowPairsSSE(DownsampleRow<float> const &row, float noValue, bool isNoValueNaN)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 noValueVector = _mm_set1_ps(noValue);
+  const __m128 sampleCount = _mm_set1_ps(float(row.sourceCount * 2));
+
+  int sample = 0;
+  for(; sample + 4 <= row.pairCount; sample += 4)
+  {
+    __m128 sum = _mm_setzero_ps();
+    __m128 validCount = _mm_setzero_ps();
+
+    for(int source = 0; source < row.sourceCount; source++)
+    {
+      __m128 a = _mm_loadu_ps(row.sources[source] + sample * 2);
+      __m128 b = _mm_loadu_ps(row.sources[source] + sample * 2 + 4);
+
+      if(useNoValue)
+      {
+        __m128 validA = isNoValueNaN ? _mm_cmpord_ps(a, a) : _mm_cmpneq_ps(a, noValueVector);
+        __m128 validB = isNoValueNaN ? _mm_cmpord_ps(b, b) : _mm_cmpneq_ps(b, noValueVector);
+        sum = _mm_add_ps(sum, _mm_hadd_ps(_mm_and_ps(a, validA), _mm_and_ps(b, validB)));
+        validCount = _mm_add_ps(validCount, _mm_hadd_ps(_mm_and_ps(one, validA), _mm_and_ps(one, validB)));
+      }
+      else
+      {
+        sum = _mm_add_ps(sum, _mm_hadd_ps(a, b));
+      }
+    }
+
+    __m128 average;
+    if(useNoValue)
+    {
+      average = _mm_blendv_ps(_mm_div_ps(sum, validCount), noValueVector, _mm_cmpeq_ps(validCount, _mm_setzero_ps()));
+    }
+    else
+    {
+      average = _mm_div_ps(sum, sampleCount);
+    }
+    _mm_storeu_ps(row.target + sample, average);
+  }
+  return sample;
+}
+
+// Average rows of contiguous floats where dimension 0 is not decimated
+template<bool useNoValue>
+static int AverageRowsSSE(DownsampleRow<float> const &row, float noValue, bool isNoValueNaN)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 noValueVector = _mm_set1_ps(noValue);
+  const __m128 sampleCount = _mm_set1_ps(float(row.sourceCount));
+
+  int sample = 0;
+  for(; sample + 4 <= row.count; sample += 4)
+  {
+    __m128 sum = _mm_setzero_ps();
+    __m128 validCount = _mm_setzero_ps();
+
+    for(int source = 0; source < row.sourceCount; source++)
+    {
+      __m128 a = _mm_loadu_ps(row.sources[source] + sample);
+
+      if(useNoValue)
+      {
+        __m128 validA = isNoValueNaN ? _mm_cmpord_ps(a, a) : _mm_cmpneq_ps(a, noValueVector);
+        sum = _mm_add_ps(sum, _mm_and_ps(a, validA));
+        validCount = _mm_add_ps(validCount, _mm_and_ps(one, validA));
+      }
+      else
+      {
+        sum = _mm_add_ps(sum, a);
+      }
+    }
+
+    __m128 average;
+    if(useNoValue)
+    {
+      average = _mm_blendv_ps(_mm_div_ps(sum, validCount), noValueVector, _mm_cmpeq_ps(validCount, _mm_setzero_ps()));
+    }
+    else
+    {
+      average = _mm_div_ps(sum, sampleCount);
+    }
+    _mm_storeu_ps(row.target + sample, average);
+  }
+  return sample;
+}
+#endif
+
+template<bool useNoValue>
+static void AverageRow(DownsampleRow<float> const &row, float noValue, bool isNoValueNaN)
+{
+  int start = 0;
+#ifdef ENABLE_SSE_LOD
+  if(row.targetPitch == 1 && row.sourceStep == 2 && row.pairOffset == 1)
+  {
+    start = AverageRowPairsSSE<useNoValue>(row, noValue, isNoValueNaN);
+  }
+  else if(row.targetPitch == 1 && row.sourceStep == 1 && row.pairCount == 0)
+  {
+    start = AverageRowsSSE<useNoValue>(row, noValue, isNoValueNaN);
+  }
+#endif
+  AverageRowFloat<float, useNoValue>(row, start, noValue, isNoValueNaN);
+}
+
+template<bool useNoValue>
+static void AverageRow(DownsampleRow<double> const &row, double noValue, bool isNoValueNaN)
+{
+  AverageRowFloat<double, useNoValue>(row, 0, noValue, isNoValueNaN);
+}
+
+// Integer samples are averaged with rounding, no-value is not supported since it is stored as a quantized value
+template<typename T>
+static void AverageRowInteger(DownsampleRow<T> const &row)
+{
+  for(int sample = 0; sample < row.count; sample++)
+  {
+    int32_t sourceIndex = sample * row.sourceStep;
+    bool isPair = sample < row.pairCount;
+    uint64_t sum = 0;
+
+    for(int source = 0; source < row.sourceCount; source++)
+    {
+      sum += row.sources[source][sourceIndex];
+      if(isPair)
+      {
+        sum += row.sources[source][sourceIndex + row.pairOffset];
+      }
+    }
+
+    uint64_t sampleCount = uint64_t(row.sourceCount) * (isPair ? 2 : 1);
+    row.target[sample * row.targetPitch] = T((sum + sampleCount / 2) / sampleCount);
+  }
+}
+
+template<typename T>
+static void DecimateRow(DownsampleRow<T> const &row)
+{
+  for(int sample = 0; sample < row.count; sample++)
+  {
+    row.target[sample * row.targetPitch] = row.sources[0][sample * row.sourceStep];
+  }
+}
+
+enum class DownsampleMethod
+{
+  Decimate,
+  Average,
+  AverageNoValue
+};
+
+struct DownsampleRegion
+{
+  int32_t childStart[Dimensionality_Max];
+  int32_t parentStart[Dimensionality_Max];
+  int32_t count[Dimensionality_Max];
+  int32_t pairCount[Dimensionality_Max];
+  int32_t ratio[Dimensionality_Max];
+};
+
+template<typename T, typename F>
+static void DownsampleRegionRows(DownsampleRegion const &region, const T *childBuffer, const int32_t (&childPitch)[Dimensionality_Max], T *parentBuffer, const int32_t (&parentPitch)[Dimensionality_Max], F const &rowFunction)
+{
+  const T *childBase = childBuffer;
+  T *parentBase = parentBuffer;
+  for(int dimension = 0; dimension < Dimensionality_Max; dimension++)
+  {
+    childBase += region.childStart[dimension] * childPitch[dimension];
+    parentBase += region.parentStart[dimension] * parentPitch[dimension];
+  }
+
+  DownsampleRow<T> row;
+  row.targetPitch = parentPitch[0];
+  row.sourceStep = region.ratio[0] * childPitch[0];
+  row.pairOffset = region.ratio[0] == 2 ? childPitch[0] : 0;
+  row.count = region.count[0];
+  row.pairCount = region.pairCount[0];
+
+  int index[Dimensionality_Max] = {};
+
+  while(true)
+  {
+    row.target = parentBase;
+    row.sources[0] = childBase;
+    row.sourceCount = 1;
+
+    for(int dimension = 1; dimension < Dimensionality_Max; dimension++)
+    {
+      row.target += index[dimension] * parentPitch[dimension];
+      for(int source = 0; source < row.sourceCount; source++)
+      {
+        row.sources[source] += index[dimension] * region.ratio[dimension] * childPitch[dimension];
+      }
+      if(index[dimension] < region.pairCount[dimension])
+      {
+        for(int source = 0; source < row.sourceCount; source++)
+        {
+          row.sources[row.sourceCount + source] = row.sources[source] + childPitch[dimension];
+        }
+        row.sourceCount *= 2;
+      }
+    }
+
+    rowFunction(row);
+
+    int dimension = 1;
+    while(dimension < Dimensionality_Max && ++index[dimension] == region.count[dimension])
+    {
+      index[dimension] = 0;
+      dimension++;
+    }
+    if(dimension == Dimensionality_Max)
+    {
+      break;
+    }
+  }
+}
+
+template<typename T>
+static void DownsampleRegionFloat(DownsampleRegion const &region, DownsampleMethod method, T noValue, const void *childBuffer, const int32_t (&childPitch)[Dimensionality_Max], void *parentBuffer, const int32_t (&parentPitch)[Dimensionality_Max])
+{
+  bool isNoValueNaN = std::isnan(noValue);
+
+  switch(method)
+  {
+  case DownsampleMethod::Decimate:       DownsampleRegionRows(region, static_cast<const T *>(childBuffer), childPitch, static_cast<T *>(parentBuffer), parentPitch, [](DownsampleRow<T> const &row) { DecimateRow(row); }); break;
+  case DownsampleMethod::Average:        DownsampleRegionRows(region, static_cast<const T *>(childBuffer), childPitch, static_cast<T *>(parentBuffer), parentPitch, [=](DownsampleRow<T> const &row) { AverageRow<false>(row, noValue, isNoValueNaN); }); break;
+  case DownsampleMethod::AverageNoValue: DownsampleRegionRows(region, static_cast<const T *>(childBuffer), childPitch, static_cast<T *>(parentBuffer), parentPitch, [=](DownsampleRow<T> const &row) { AverageRow<true>(row, noValue, isNoValueNaN); }); break;
+  }
+}
+
+template<typename T>
+static void DownsampleRegionInteger(DownsampleRegion const &region, DownsampleMethod method, const void *childBuffer, const int32_t (&childPitch)[Dimensionality_Max], void *parentBuffer, const int32_t (&parentPitch)[Dimensionality_Max])
+{
+  if(method == DownsampleMethod::Decimate)
+  {
+    DownsampleRegionRows(region, static_cast<const T *>(childBuffer), childPitch, static_cast<T *>(parentBuffer), parentPitch, [](DownsampleRow<T> const &row) { DecimateRow(row); });
+  }
+  else
+  {
+    DownsampleRegionRows(region, static_cast<const T *>(childBuffer), childPitch, static_cast<T *>(parentBuffer), parentPitch, [](DownsampleRow<T> const &row) { AverageRowInteger(row); });
+  }
+}
+
+// 1-bit samples are packed in dimension 0 and the pitches of the other dimensions are in bytes
+static void DecimateRegion1Bit(DownsampleRegion const &region, int components, const uint8_t *childBuffer, const int32_t (&childPitch)[Dimensionality_Max], uint8_t *parentBuffer, const int32_t (&parentPitch)[Dimensionality_Max])
+{
+  int32_t childPitchBits[Dimensionality_Max], parentPitchBits[Dimensionality_Max];
+  for(int dimension = 0; dimension < Dimensionality_Max; dimension++)
+  {
+    childPitchBits[dimension] = dimension == 0 ? components : childPitch[dimension] * 8;
+    parentPitchBits[dimension] = dimension == 0 ? components : parentPitch[dimension] * 8;
+  }
+
+  int index[Dimensionality_Max] = {};
+
+  while(true)
+  {
+    int64_t childBit = 0, parentBit = 0;
+    for(int dimension = 0; dimension < Dimensionality_Max; dimension++)
+    {
+      childBit += int64_t(region.childStart[dimension] + index[dimension] * region.ratio[dimension]) * childPitchBits[dimension];
+      parentBit += int64_t(region.parentStart[dimension] + index[dimension]) * parentPitchBits[dimension];
+    }
+
+    for(int component = 0; component < components; component++)
+    {
+      int64_t sourceBit = childBit + component, targetBit = parentBit + component;
+      bool value = (childBuffer[sourceBit / 8] >> (sourceBit % 8)) & 1;
+      parentBuffer[targetBit / 8] = uint8_t((parentBuffer[targetBit / 8] & ~(1 << (targetBit % 8))) | (int(value) << (targetBit % 8)));
+    }
+
+    int dimension = 0;
+    while(dimension < Dimensionality_Max && ++index[dimension] == region.count[dimension])
+    {
+      index[dimension] = 0;
+      dimension++;
+    }
+    if(dimension == Dimensionality_Max)
+    {
+      break;
+    }
+  }
+}
+
+static int32_t DivideRoundUp(int32_t dividend, int32_t divisor)
+{
+  return (dividend + divisor - 1) / divisor;
+}
+
+bool DownsampleChunk(VolumeDataLayer const *childLayer, int64_t childChunk, const void *childBuffer, const int32_t (&childPitch)[Dimensionality_Max],
+                     VolumeDataLayer const *parentLayer, int64_t parentChunk, void *parentBuffer, const int32_t (&parentPitch)[Dimensionality_Max],
+                     int32_t (&writtenMin)[Dimensionality_Max], int32_t (&writtenMax)[Dimensionality_Max])
+{
+  assert(childLayer->GetParentLayer() == parentLayer);
+
+  int32_t childMin[Dimensionality_Max], childMax[Dimensionality_Max];
+  int32_t childMinExcludingMargin[Dimensionality_Max], childMaxExcludingMargin[Dimensionality_Max];
+  int32_t parentMin[Dimensionality_Max], parentMax[Dimensionality_Max];
+
+  childLayer->GetChunkMinMax(childChunk, childMin, childMax, true);
+  childLayer->GetChunkMinMax(childChunk, childMinExcludingMargin, childMaxExcludingMargin, false);
+  parentLayer->GetChunkMinMax(parentChunk, parentMin, parentMax, true);
+
+  DownsampleRegion region;
+
+  for(int dimension = 0; dimension < Dimensionality_Max; dimension++)
+  {
+    bool isDecimated = childLayer->IsDimensionChunked(dimension) && childLayer->IsDimensionLODDecimated(dimension);
+
+    int32_t childStep = isDecimated ? 1 << childLayer->GetLOD() : 1;
+    int32_t parentStep = isDecimated ? 1 << parentLayer->GetLOD() : 1;
+
+    // The parent samples that are inside the part of the volume owned by the child chunk
+    int32_t parentSize = DivideRoundUp(parentMax[dimension] - parentMin[dimension], parentStep);
+    int32_t parentStart = DivideRoundUp(std::max(childMinExcludingMargin[dimension] - parentMin[dimension], 0), parentStep);
+    int32_t parentEnd = std::min(DivideRoundUp(childMaxExcludingMargin[dimension] - parentMin[dimension], parentStep), parentSize);
+
+    if(parentStart >= parentEnd)
+    {
+      return false;
+    }
+
+    int32_t childSize = DivideRoundUp(childMax[dimension] - childMin[dimension], childStep);
+    int32_t childStart = (parentMin[dimension] + parentStart * parentStep - childMin[dimension]) / childStep;
+
+    region.childStart[dimension] = childStart;
+    region.parentStart[dimension] = parentStart;
+    region.count[dimension] = parentEnd - parentStart;
+    region.ratio[dimension] = parentStep / childStep;
+    region.pairCount[dimension] = region.ratio[dimension] == 2 ? std::min(region.count[dimension], (childSize - childStart) / 2) : 0;
+
+    writtenMin[dimension] = parentMin[dimension] + parentStart * parentStep;
+    writtenMax[dimension] = std::min(parentMin[dimension] + parentEnd * parentStep, parentMax[dimension]);
+  }
+
+  VolumeDataChannelDescriptor::Format format = childLayer->GetFormat();
+  int components = childLayer->GetComponents();
+
+  DownsampleMethod method = DownsampleMethod::Average;
+
+  if(childLayer->IsDiscrete())
+  {
+    method = DownsampleMethod::Decimate;
+  }
+  else if(childLayer->IsUseNoValue())
+  {
+    bool isFloat = format == VolumeDataChannelDescriptor::Format_R32 || format == VolumeDataChannelDescriptor::Format_R64;
+    method = isFloat ? DownsampleMethod::AverageNoValue : DownsampleMethod::Decimate;
+  }
+
+  if(format == VolumeDataChannelDescriptor::Format_1Bit)
+  {
+    DecimateRegion1Bit(region, components, static_cast<const uint8_t *>(childBuffer), childPitch, static_cast<uint8_t *>(parentBuffer), parentPitch);
+    return true;
+  }
+
+  // Each component is downsampled separately, with the pitches in units of the component type
+  int32_t childComponentPitch[Dimensionality_Max], parentComponentPitch[Dimensionality_Max];
+  for(int dimension = 0; dimension < Dimensionality_Max; dimension++)
+  {
+    childComponentPitch[dimension] = childPitch[dimension] * components;
+    parentComponentPitch[dimension] = parentPitch[dimension] * components;
+  }
+
+  int32_t componentSize = GetVoxelFormatByteSize(format);
+
+  for(int component = 0; component < components; component++)
+  {
+    const void *childComponent = static_cast<const uint8_t *>(childBuffer) + component * componentSize;
+    void *parentComponent = static_cast<uint8_t *>(parentBuffer) + component * componentSize;
+
+    switch(format)
+    {
+    case VolumeDataChannelDescriptor::Format_R32: DownsampleRegionFloat<float>(region, method, childLayer->GetNoValue(), childComponent, childComponentPitch, parentComponent, parentComponentPitch); break;
+    case VolumeDataChannelDescriptor::Format_R64: DownsampleRegionFloat<double>(region, method, childLayer->GetNoValue(), childComponent, childComponentPitch, parentComponent, parentComponentPitch); break;
+    case VolumeDataChannelDescriptor::Format_U8:  DownsampleRegionInteger<uint8_t>(region, method, childComponent, childComponentPitch, parentComponent, parentComponentPitch); break;
+    case VolumeDataChannelDescriptor::Format_U16: DownsampleRegionInteger<uint16_t>(region, method, childComponent, childComponentPitch, parentComponent, parentComponentPitch); break;
+    case VolumeDataChannelDescriptor::Format_U32: DownsampleRegionInteger<uint32_t>(region, method, childComponent, childComponentPitch, parentComponent, parentComponentPitch); break;
+    // The sum of 64-bit samples can overflow, so they are decimated
+    case VolumeDataChannelDescriptor::Format_U64: DownsampleRegionInteger<uint64_t>(region, DownsampleMethod::Decimate, childComponent, childComponentPitch, parentComponent, parentComponentPitch); break;
+    default: assert(0 && "Illegal format"); return false;
+    }
+  }
+
+  return true;
+}
+
+VolumeDataLODProducer::VolumeDataLODProducer(VolumeDataAccessManagerImpl *accessManager, VolumeDataLayer const *childLayer)
+  : m_accessManager(accessManager)
+  , m_childLayer(childLayer)
+  , m_parentLayer(childLayer->GetParentLayer())
+{
+  assert(m_parentLayer);
+
+  // The parent pages are pinned until all their children have been downsampled, and written back as soon as they are unpinned
+  m_parentAccessor.reset(new VolumeDataPageAccessorImpl(accessManager, m_parentLayer, 0, true));
+
+  if(m_parentLayer->GetParentLayer())
+  {
+    m_parentAccessor->SetLODProducer(new VolumeDataLODProducer(accessManager, m_parentLayer));
+  }
+}
+
+VolumeDataLODProducer::~VolumeDataLODProducer()
+{
+}
+
+VolumeDataLODProducer::PendingParent *VolumeDataLODProducer::AcquireParent(int64_t parentChunk, std::unique_lock<std::mutex> &lock)
+{
+  auto inserted = m_pendingParents.emplace(parentChunk, PendingParent());
+  PendingParent &pendingParent = inserted.first->second;
+
+  if(inserted.second)
+  {
+    int64_t childIndices[8];
+    m_parentLayer->GetChildIndices(parentChunk, *m_childLayer, childIndices);
+
+    pendingParent.m_page = nullptr;
+    pendingParent.m_remainingChildren = int(std::count_if(childIndices, childIndices + 8, [](int64_t childIndex) { return childIndex >= 0; }));
+    pendingParent.m_activeChildren = 1;
+    pendingParent.m_receivedChildren = 0;
+    pendingParent.m_isCreated = false;
+
+    // A parent that has already been written is read back so the new child is downsampled into the existing data
+    bool isCompleted = m_completedParents.erase(parentChunk) != 0;
+
+    lock.unlock();
+    VolumeDataPage *page = isCompleted ? m_parentAccessor->ReadPage(parentChunk) : m_parentAccessor->CreatePage(parentChunk);
+    if(page && page->GetError().errorCode != 0)
+    {
+      fprintf(stderr, "Failed when reading LOD chunk: %s\n", page->GetError().message);
+      page->Release();
+      page = nullptr;
+    }
+    lock.lock();
+
+    pendingParent.m_page = page;
+    pendingParent.m_isCreated = true;
+    m_parentCreatedCondition.notify_all();
+  }
+  else
+  {
+    pendingParent.m_activeChildren++;
+    m_parentCreatedCondition.wait(lock, [&pendingParent]() { return pendingParent.m_isCreated; });
+  }
+
+  return &pendingParent;
+}
+
+void VolumeDataLODProducer::AddChunk(int64_t chunk, const DataBlock &dataBlock, const std::vector<uint8_t> &data)
+{
+  int32_t child = 0;
+  int64_t parentChunk = m_childLayer->GetParentIndex(chunk, *m_parentLayer, &child);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  PendingParent &pendingParent = *AcquireParent(parentChunk, lock);
+  VolumeDataPage *page = pendingParent.m_page;
+  lock.unlock();
+
+  // Children of the same parent are downsampled concurrently since they write to separate parts of the parent page
+  if(page)
+  {
+    int32_t childPitch[Dimensionality_Max] = {};
+
+    for(int chunkDimension = 0; chunkDimension < m_childLayer->GetChunkDimensionality(); chunkDimension++)
+    {
+      int dimension = DimensionGroupUtil::GetDimension(m_childLayer->GetChunkDimensionGroup(), chunkDimension);
+
+      assert(dimension >= 0 && dimension < Dimensionality_Max);
+      childPitch[dimension] = dataBlock.Pitch[chunkDimension];
+    }
+
+    int32_t parentPitch[Dimensionality_Max];
+    void *parentBuffer = page->GetWritableBuffer(parentPitch);
+
+    int32_t writtenMin[Dimensionality_Max], writtenMax[Dimensionality_Max];
+    if(DownsampleChunk(m_childLayer, chunk, data.data(), childPitch, m_parentLayer, parentChunk, parentBuffer, parentPitch, writtenMin, writtenMax))
+    {
+      page->UpdateWrittenRegion(writtenMin, writtenMax);
+    }
+  }
+
+  lock.lock();
+  pendingParent.m_activeChildren--;
+  if(!(pendingParent.m_receivedChildren & (1u << child)))
+  {
+    pendingParent.m_receivedChildren |= 1u << child;
+    pendingParent.m_remainingChildren--;
+  }
+
+  bool isComplete = pendingParent.m_remainingChildren <= 0 && pendingParent.m_activeChildren == 0;
+  if(isComplete)
+  {
+    if(page)
+    {
+      page->Release();
+      m_completedParents.insert(parentChunk);
+    }
+    m_pendingParents.erase(parentChunk);
+  }
+  lock.unlock();
+
+  if(isComplete && page)
+  {
+    m_parentAccessor->WriteBackUnpinnedPages();
+  }
+}
+
+void VolumeDataLODProducer::Commit()
+{
+  std::vector<VolumeDataPage *> pages;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for(auto &pendingParent : m_pendingParents)
+    {
+      assert(pendingParent.second.m_activeChildren == 0 && "Chunks cannot be written while committing");
+      if(pendingParent.second.m_page)
+      {
+        pages.push_back(pendingParent.second.m_page);
+        m_completedParents.insert(pendingParent.first);
+      }
+    }
+    m_pendingParents.clear();
+  }
+
+  for(auto page : pages)
+  {
+    page->Release();
+  }
+
+  // This writes the remaining parent chunks, which in turn produces and commits the next LOD level
+  m_parentAccessor->Commit();
+}
+
+}
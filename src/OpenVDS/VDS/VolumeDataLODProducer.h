@@ -0,0 +1,90 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef VOLUMEDATALODPRODUCER_H
+#define VOLUMEDATALODPRODUCER_H
+
+#include <OpenVDS/VolumeData.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace OpenVDS
+{
+class VolumeDataLayer;
+class VolumeDataAccessManagerImpl;
+class VolumeDataPageAccessorImpl;
+class VolumeDataPage;
+struct DataBlock;
+
+// Downsample the part of a parent chunk that is owned by one of its child chunks (i.e. the child chunk excluding margins).
+// The buffers start at the minimum corner of the chunks including margins, and the pitches are in elements for each
+// dimension of the layout. Floating point and integer data is averaged (ignoring no-value samples), discrete data is
+// decimated. The written region of the parent chunk is returned in voxel coordinates, the function returns false if the
+// child chunk doesn't overlap the parent chunk.
+bool DownsampleChunk(VolumeDataLayer const *childLayer, int64_t childChunk, const void *childBuffer, const int32_t (&childPitch)[Dimensionality_Max],
+                     VolumeDataLayer const *parentLayer, int64_t parentChunk, void *parentBuffer, const int32_t (&parentPitch)[Dimensionality_Max],
+                     int32_t (&writtenMin)[Dimensionality_Max], int32_t (&writtenMax)[Dimensionality_Max]);
+
+// Produces the parent LOD layer of a layer that is being created. Every chunk that is written to the child layer is
+// downsampled into its parent chunk as soon as it is written, and the parent chunk is written when all its children
+// have been written. The parent layer has its own producer if there are more LOD levels, so the whole LOD pyramid is
+// produced incrementally while the full resolution data is written.
+class VolumeDataLODProducer
+{
+  struct PendingParent
+  {
+    VolumeDataPage *m_page;
+    int             m_remainingChildren;
+    int             m_activeChildren;
+    uint32_t        m_receivedChildren;
+    bool            m_isCreated;
+  };
+
+  VolumeDataAccessManagerImpl *m_accessManager;
+  VolumeDataLayer const *m_childLayer;
+  VolumeDataLayer const *m_parentLayer;
+  std::unique_ptr<VolumeDataPageAccessorImpl> m_parentAccessor;
+
+  std::mutex m_mutex;
+  std::condition_variable m_parentCreatedCondition;
+  std::unordered_map<int64_t, PendingParent> m_pendingParents;
+  // Parent chunks that have been written, these are read back if one of their children is written again
+  std::unordered_set<int64_t> m_completedParents;
+
+  PendingParent *AcquireParent(int64_t parentChunk, std::unique_lock<std::mutex> &lock);
+public:
+  VolumeDataLODProducer(VolumeDataAccessManagerImpl *accessManager, VolumeDataLayer const *childLayer);
+  ~VolumeDataLODProducer();
+
+  VolumeDataLayer const *GetParentLayer() const { return m_parentLayer; }
+
+  // Called with the data of every chunk written to the child layer
+  void AddChunk(int64_t chunk, const DataBlock &dataBlock, const std::vector<uint8_t> &data);
+
+  // Write all parent chunks, including the ones where not all children have been written, and commit the parent layers
+  void Commit();
+};
+
+}
+
+#endif //VOLUMEDATALODPRODUCER_H
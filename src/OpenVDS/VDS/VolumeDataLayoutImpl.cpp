@@ -334,7 +334,7 @@ void VolumeDataLayoutImpl::SetActualValueRange(int32_t actualValueRangeChannel,
 }
 
 
-void VolumeDataLayoutImpl::CreateLayers(DimensionGroup dimensionGroup, int32_t brickSize, int32_t physicalLODLevels, VolumeDataLayer::ProduceStatus produceStatus)
+void VolumeDataLayoutImpl::CreateLayers(DimensionGroup dimensionGroup, int32_t brickSize, int32_t physicalLODLevels, VolumeDataLayer::ProduceStatus produceStatus, uint32_t producedLODMask)
 {
   assert(physicalLODLevels > 0);
 
@@ -410,11 +410,14 @@ void VolumeDataLayoutImpl::CreateLayers(DimensionGroup dimensionGroup, int32_t b
 
     if(lod < physicalLODLevels)
     {
+      // LODs that haven't been produced are unavailable, they can be produced on read from the LODs below
+      bool isProduced = lod == 0 || lod >= 32 || (producedLODMask & (1u << lod));
+
       for(VolumeDataLayer *volumeDataLayer = m_primaryTopLayers[dimensionGroup]; volumeDataLayer; volumeDataLayer = volumeDataLayer->GetNextChannelLayer())
       {
         if(volumeDataLayer->GetLayerType() != VolumeDataLayer::Virtual)
         {
-          volumeDataLayer->SetProduceStatus(produceStatus);
+          volumeDataLayer->SetProduceStatus(isProduced ? produceStatus : VolumeDataLayer::ProduceStatus_Unavailable);
         }
       }
     }
@@ -177,7 +177,7 @@ public:
   void SetCompressionTolerance(float compressionTolerance) { m_compressionTolerance = compressionTolerance; }
   void SetWaveletAdaptiveLoadLevel(int waveletAdaptiveLoadLevel) { m_waveletAdaptiveLoadLevel = waveletAdaptiveLoadLevel; }
 
-  void CreateLayers(DimensionGroup dimensionGroup, int32_t brickSize, int32_t physicalLODLevels, VolumeDataLayer::ProduceStatus produceStatus);
+  void CreateLayers(DimensionGroup dimensionGroup, int32_t brickSize, int32_t physicalLODLevels, VolumeDataLayer::ProduceStatus produceStatus, uint32_t producedLODMask);
 
   bool IsDimensionLODDecimated(int32_t dimension) const { return dimension != m_fullResolutionDimension; }
   int32_t GetFullResolutionDimension() const { return m_fullResolutionDimension; }
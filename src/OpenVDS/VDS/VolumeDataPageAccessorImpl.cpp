@@ -21,8 +21,11 @@
 #include "VolumeDataAccessManagerImpl.h"
 #include "VolumeDataLayer.h"
 #include "VolumeDataPageImpl.h"
+#include "VolumeDataPageCache.h"
+#include "VolumeDataLODProducer.h"
 #include "VolumeDataStore.h"
 #include "MetadataManager.h"
+#include "WaveletTypes.h"
 
 #include <IO/IOManager.h>
 
@@ -36,6 +39,12 @@
 namespace OpenVDS
 {
 
+// Number of least recently used pages considered by each page accessor when the cache size limit is exceeded
+static const int CACHE_EVICTION_CANDIDATES = 16;
+
+// Number of child pages kept by the accessor reading the layer below an unavailable LOD layer
+static const int LOD_SOURCE_MAX_PAGES = 8;
+
 VolumeDataPageAccessorImpl::VolumeDataPageAccessorImpl(VolumeDataAccessManagerImpl* accessManager, VolumeDataLayer const* layer, int maxPages, bool isReadWrite)
   : m_accessManager(accessManager)
   , m_layer(layer)
@@ -48,15 +57,47 @@ VolumeDataPageAccessorImpl::VolumeDataPageAccessorImpl(VolumeDataAccessManagerIm
   , m_isCommitInProgress(false)
   , m_lastUsed(std::chrono::steady_clock::now())
 {
+  GetPageCache().AddPageAccessor(this);
 }
 VolumeDataPageAccessorImpl::~VolumeDataPageAccessorImpl()
 {
-  for (auto& page : m_pages)
+  GetPageCache().RemovePageAccessor(this);
+  while (VolumeDataPageImpl *page = m_pages.GetFirstItem())
   {
+    RemovePage(page);
     delete page;
   }
 }
 
+VolumeDataPageCache &VolumeDataPageAccessorImpl::GetPageCache() const
+{
+  return m_accessManager->GetPageCache();
+}
+
+GlobalStateVds &VolumeDataPageAccessorImpl::GetGlobalStateVds() const
+{
+  return m_accessManager->GetVolumeDataStore()->GetGlobalStateVds();
+}
+
+VolumeDataPageImpl *VolumeDataPageAccessorImpl::FindPage(int64_t chunk) const
+{
+  auto page_it = m_pageMap.find(chunk);
+  return page_it != m_pageMap.end() ? page_it->second : nullptr;
+}
+
+void VolumeDataPageAccessorImpl::InsertPage(VolumeDataPageImpl *page)
+{
+  m_pages.InsertFirst(page);
+  m_pageMap.emplace(page->GetChunkIndex(), page);
+}
+
+void VolumeDataPageAccessorImpl::RemovePage(VolumeDataPageImpl *page)
+{
+  m_pages.Remove(page);
+  m_pageMap.erase(page->GetChunkIndex());
+  GetPageCache().RemoveSize(page->GetBufferSize());
+}
+
   
 VolumeDataLayout const* VolumeDataPageAccessorImpl::GetLayout() const
 {
@@ -150,7 +191,6 @@ int VolumeDataPageAccessorImpl::RemoveReference()
 
 int VolumeDataPageAccessorImpl::GetMaxPages()
 {
-  std::unique_lock<std::mutex> pageListMutexLock(m_pagesMutex);
   return m_maxPages;
 }
 
@@ -176,8 +216,7 @@ VolumeDataPage* VolumeDataPageAccessorImpl::CreatePage(int64_t chunk)
     return nullptr;
   }
 
-  auto page_it = std::find_if(m_pages.begin(), m_pages.end(), [chunk](VolumeDataPageImpl *page)->bool { return page->GetChunkIndex() == chunk; });
-  if(page_it != m_pages.end())
+  if(FindPage(chunk))
   {
     throw InvalidOperation("Cannot create a page that already exists");
   }
@@ -192,10 +231,18 @@ VolumeDataPage* VolumeDataPageAccessorImpl::CreatePage(int64_t chunk)
     }
   }
 
+  // A new page must not be written before an earlier write back of the same chunk has been requested
+  WaitForWriteBack(chunk, pageListMutexLock);
+
+  if(FindPage(chunk))
+  {
+    throw InvalidOperation("Cannot create a page that already exists");
+  }
+
   // Create a new page
   VolumeDataPageImpl *page = new VolumeDataPageImpl(this, chunk);
 
-  m_pages.push_front(page);
+  InsertPage(page);
 
   assert(page->IsPinned());
 
@@ -227,6 +274,7 @@ VolumeDataPage* VolumeDataPageAccessorImpl::CreatePage(int64_t chunk)
   pageListMutexLock.lock();
   page->SetBufferData(dataBlock, pitch, std::move(page_data));
   page->MakeDirty();
+  GetPageCache().AddSize(page->GetBufferSize());
 
   m_pageReadCondition.notify_all();
 
@@ -238,6 +286,9 @@ VolumeDataPage* VolumeDataPageAccessorImpl::CreatePage(int64_t chunk)
 
   LimitPageListSize(m_maxPages, pageListMutexLock);
 
+  pageListMutexLock.unlock();
+  GetPageCache().LimitSize();
+
   return page;
 }
 
@@ -252,28 +303,30 @@ VolumeDataPage* VolumeDataPageAccessorImpl::PrepareReadPage(int64_t chunk, Error
     return nullptr;
   }
 
-  if (m_layer->GetProduceStatus() == VolumeDataLayer::ProduceStatus_Unavailable)
+  if (m_layer->GetProduceStatus() == VolumeDataLayer::ProduceStatus_Unavailable && !m_lodSourceAccessor)
   {
     error.code = -1;
     error.string = "The accessed dimension group or channel is unavailable (check produce status on VDS before accessing data)";
     return nullptr;
   }
 
-  for(auto page_it = m_pages.begin(); page_it != m_pages.end(); ++page_it)
+  if(VolumeDataPageImpl *page = FindPage(chunk))
   {
-    if((*page_it)->GetChunkIndex() == chunk)
+    if(page != m_pages.GetFirstItem())
     {
-      if (page_it != m_pages.begin())
-      {
-        m_pages.splice(m_pages.begin(), m_pages, page_it, std::next(page_it));
-      }
-      (*page_it)->Pin();
-
-      m_pagesFound++;
-      return *page_it;
+      m_pages.Remove(page);
+      m_pages.InsertFirst(page);
     }
+    page->Pin();
+    page->SetCachePriority(GetPageCache().GetPriority(page->GetCacheCost(), page->GetBufferSize()));
+
+    m_pagesFound++;
+    GetGlobalStateVds().addCacheHit();
+    return page;
   }
 
+  GetGlobalStateVds().addCacheMiss();
+
   // Wait for commit to finish before inserting a new page
   while(m_isCommitInProgress)
   {
@@ -286,15 +339,25 @@ VolumeDataPage* VolumeDataPageAccessorImpl::PrepareReadPage(int64_t chunk, Error
     }
   }
 
+  // Make sure the data read back includes the page if it is being written back
+  WaitForWriteBack(chunk, pageListMutexLock);
+
+  if(VolumeDataPageImpl *page = FindPage(chunk))
+  {
+    page->Pin();
+    return page;
+  }
+
   // Not found, we need to create a new page
   VolumeDataPageImpl *page = new VolumeDataPageImpl(this, chunk);
 
-  m_pages.push_front(page);
+  InsertPage(page);
 
   assert(page->IsPinned());
 
+  // Produced chunks are read from the layer below when the page is read
   VolumeDataChunk volumeDataChunk = m_layer->GetChunkFromIndex(chunk);
-  if (!m_accessManager->GetVolumeDataStore()->PrepareReadChunk(volumeDataChunk, m_layer->GetEffectiveWaveletAdaptiveLoadLevel(), error))
+  if (!m_lodSourceAccessor && !m_accessManager->GetVolumeDataStore()->PrepareReadChunk(volumeDataChunk, m_layer->GetEffectiveWaveletAdaptiveLoadLevel(), error))
   {
     page->SetError(error);
   }
@@ -324,7 +387,7 @@ bool VolumeDataPageAccessorImpl::ReadPreparedPaged(VolumeDataPage* page)
     std::vector<uint8_t> metadata;
     CompressionInfo compressionInfo;
 
-    if (!m_accessManager->GetVolumeDataStore()->ReadChunk(volumeDataChunk, m_layer->GetEffectiveWaveletAdaptiveLoadLevel(), serialized_data, metadata, compressionInfo, error))
+    if (!m_lodSourceAccessor && !m_accessManager->GetVolumeDataStore()->ReadChunk(volumeDataChunk, m_layer->GetEffectiveWaveletAdaptiveLoadLevel(), serialized_data, metadata, compressionInfo, error))
     {
       pageListMutexLock.lock();
       pageImpl->SetError(error);
@@ -337,7 +400,10 @@ bool VolumeDataPageAccessorImpl::ReadPreparedPaged(VolumeDataPage* page)
 
     std::vector<uint8_t> page_data;
     DataBlock dataBlock;
-    if (!m_accessManager->GetVolumeDataStore()->DeserializeVolumeData(volumeDataChunk, serialized_data, metadata, compressionInfo.GetCompressionMethod(), compressionInfo.GetAdaptiveLevel(), m_layer->GetFormat(), dataBlock, page_data, error))
+    auto deserializeStart = std::chrono::steady_clock::now();
+    bool isDataValid = m_lodSourceAccessor ? ProduceLODChunk(volumeDataChunk, dataBlock, page_data, error)
+                                           : m_accessManager->GetVolumeDataStore()->DeserializeVolumeData(volumeDataChunk, serialized_data, metadata, compressionInfo.GetCompressionMethod(), compressionInfo.GetAdaptiveLevel(), m_layer->GetFormat(), dataBlock, page_data, error);
+    if (!isDataValid)
     {
       pageListMutexLock.lock();
       pageImpl->SetError(error);
@@ -358,8 +424,14 @@ bool VolumeDataPageAccessorImpl::ReadPreparedPaged(VolumeDataPage* page)
       pitch[dimension] = dataBlock.Pitch[chunkDimension];
     }
 
+    // The time it took to decompress the page is the cost of evicting it
+    double deserializeCost = double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - deserializeStart).count());
+
     pageListMutexLock.lock();
     pageImpl->SetBufferData(dataBlock, pitch, std::move(page_data));
+    pageImpl->SetCacheCost(deserializeCost);
+    pageImpl->SetCachePriority(GetPageCache().GetPriority(deserializeCost, pageImpl->GetBufferSize()));
+    GetPageCache().AddSize(pageImpl->GetBufferSize());
     m_pagesRead++;
     pageImpl->SetRequestPrepared(false);
     pageImpl->LeaveSettingData();
@@ -381,7 +453,12 @@ bool VolumeDataPageAccessorImpl::ReadPreparedPaged(VolumeDataPage* page)
   }
 
   LimitPageListSize(m_maxPages, pageListMutexLock);
-  return m_layer != nullptr;
+  bool isValid = m_layer != nullptr;
+
+  pageListMutexLock.unlock();
+  GetPageCache().LimitSize();
+
+  return isValid;
 }
 
 void VolumeDataPageAccessorImpl::CancelPreparedReadPage(VolumeDataPage* page)
@@ -394,12 +471,11 @@ void VolumeDataPageAccessorImpl::CancelPreparedReadPage(VolumeDataPage* page)
   if (pageImpl->IsPinned())
     return;
 
-  auto page_it = std::find(m_pages.begin(), m_pages.end(), page);
-  if (page_it != m_pages.end())
-    m_pages.erase(page_it);
+  if (FindPage(pageImpl->GetChunkIndex()) == pageImpl)
+    RemovePage(pageImpl);
   pageListMutexLock.unlock();
 
-  if (pageImpl->RequestPrepared())
+  if (pageImpl->RequestPrepared() && !m_lodSourceAccessor)
   {
     VolumeDataChunk volumeDataChunk = m_layer->GetChunkFromIndex(pageImpl->GetChunkIndex());
     Error error;
@@ -438,9 +514,64 @@ VolumeDataPage* VolumeDataPageAccessorImpl::ReadPageAtPosition(const int (&posit
   return ReadPage(GetChunkIndex(position));
 }
 
+VolumeDataPageView VolumeDataPageAccessorImpl::ReadPageView(int64_t chunk)
+{
+  VolumeDataPage *page = ReadPage(chunk);
+  if (!page)
+  {
+    return VolumeDataPageView();
+  }
+
+  VolumeDataPageView view;
+  if (page->GetError().errorCode == 0)
+  {
+    view = page->GetBufferView();
+  }
+  page->Release();
+  return view;
+}
+
+bool VolumeDataPageAccessorImpl::IsPageInCache(int64_t chunk)
+{
+  std::unique_lock<std::mutex> pageListMutexLock(m_pagesMutex);
+  return FindPage(chunk) != nullptr;
+}
+
+bool VolumeDataPageAccessorImpl::CanReadChunkIntoBuffer() const
+{
+  return m_layer && !m_lodSourceAccessor && m_layer->GetProduceStatus() != VolumeDataLayer::ProduceStatus_Unavailable;
+}
+
+bool VolumeDataPageAccessorImpl::ReadChunkIntoBuffer(int64_t chunk, void *buffer, int64_t bufferSize, Error &error)
+{
+  if (!CanReadChunkIntoBuffer())
+  {
+    error.code = -1;
+    error.string = "ReadChunkIntoBuffer can only read chunks that are stored";
+    return false;
+  }
+
+  VolumeDataChunk volumeDataChunk = m_layer->GetChunkFromIndex(chunk);
+  VolumeDataStore *volumeDataStore = m_accessManager->GetVolumeDataStore();
+  int adaptiveLevel = m_layer->GetEffectiveWaveletAdaptiveLoadLevel();
+
+  std::vector<uint8_t> serializedData;
+  std::vector<uint8_t> metadata;
+  CompressionInfo compressionInfo;
+
+  if (!volumeDataStore->PrepareReadChunk(volumeDataChunk, adaptiveLevel, error) ||
+      !volumeDataStore->ReadChunk(volumeDataChunk, adaptiveLevel, serializedData, metadata, compressionInfo, error))
+  {
+    return false;
+  }
+
+  DataBlock dataBlock;
+  return volumeDataStore->DeserializeVolumeData(volumeDataChunk, serializedData, metadata, compressionInfo.GetCompressionMethod(), compressionInfo.GetAdaptiveLevel(), m_layer->GetFormat(), dataBlock, buffer, bufferSize, error);
+}
+
 void VolumeDataPageAccessorImpl::LimitPageListSize(int maxPages, std::unique_lock<std::mutex>& pageListMutexLock)
 {
-  while(int(m_pages.size()) > m_maxPages)
+  while(int(m_pageMap.size()) > maxPages)
   {
     // Wait for commit to finish before deleting a page
     while(m_isCommitInProgress)
@@ -448,16 +579,19 @@ void VolumeDataPageAccessorImpl::LimitPageListSize(int maxPages, std::unique_loc
       m_commitFinishedCondition.wait_for(pageListMutexLock, std::chrono::milliseconds(1000));
     }
 
-    // Find a page to evict
-    auto page_it = std::find_if(m_pages.rbegin(), m_pages.rend(), [](VolumeDataPageImpl *page)->bool { return !page->IsPinned(); });
+    // Find the least recently used page that is not pinned. Pages are moved to the front when they are pinned,
+    // so the scan from the back normally stops at the first page.
+    VolumeDataPageImpl *page = m_pages.GetLastItem();
+    while(page && page->IsPinned())
+    {
+      page = m_pages.GetPrevItem(page);
+    }
 
-    if(page_it == m_pages.rend())
+    if(!page)
     {
       return;
     }
 
-    VolumeDataPageImpl *page = *page_it;
-
     if(page->IsWritten())
     {
       // Finish reading all pages currently being read
@@ -465,7 +599,7 @@ void VolumeDataPageAccessorImpl::LimitPageListSize(int maxPages, std::unique_loc
       {
         bool isReadInProgress = false;
 
-        for(VolumeDataPageImpl *targetPage : m_pages)
+        for(VolumeDataPageImpl *targetPage = m_pages.GetFirstItem(); targetPage; targetPage = m_pages.GetNextItem(targetPage))
         {
           if(page->IsCopyMarginNeeded(targetPage))
           {
@@ -505,7 +639,7 @@ void VolumeDataPageAccessorImpl::LimitPageListSize(int maxPages, std::unique_loc
       // Copy margins
       if(page->IsWritten())
       {
-        for(VolumeDataPageImpl *targetPage : m_pages)
+        for(VolumeDataPageImpl *targetPage = m_pages.GetFirstItem(); targetPage; targetPage = m_pages.GetNextItem(targetPage))
         {
           if(page->IsCopyMarginNeeded(targetPage))
           {
@@ -515,11 +649,20 @@ void VolumeDataPageAccessorImpl::LimitPageListSize(int maxPages, std::unique_loc
       }
     }
 
-    m_pages.erase(std::prev(page_it.base()));
+    RemovePage(page);
+    GetGlobalStateVds().addCacheEviction();
 
     if(page->IsDirty())
     {
+      // The page is no longer in the page list, so it can be serialized and compressed without holding the mutex.
+      // This lets threads that create pages concurrently also write back the evicted pages concurrently.
+      int64_t chunk = page->GetChunkIndex();
+      m_writeBackChunks.push_back(chunk);
+      pageListMutexLock.unlock();
       page->WriteBack(m_layer, pageListMutexLock);
+      pageListMutexLock.lock();
+      m_writeBackChunks.erase(std::find(m_writeBackChunks.begin(), m_writeBackChunks.end(), chunk));
+      m_writeBackFinishedCondition.notify_all();
       m_pagesWritten++;
     }
 
@@ -527,12 +670,84 @@ void VolumeDataPageAccessorImpl::LimitPageListSize(int maxPages, std::unique_loc
   }
 }
 
+void VolumeDataPageAccessorImpl::WaitForWriteBack(int64_t chunk, std::unique_lock<std::mutex>& pageListMutexLock)
+{
+  m_writeBackFinishedCondition.wait(pageListMutexLock, [this, chunk]{return std::find(m_writeBackChunks.begin(), m_writeBackChunks.end(), chunk) == m_writeBackChunks.end() && (chunk >= 0 || m_writeBackChunks.empty());});
+}
+
+VolumeDataPageImpl *VolumeDataPageAccessorImpl::FindCacheEvictionCandidate()
+{
+  // Pages of read/write accessors are left to LimitPageListSize and Commit since evicting them needs margins to be copied
+  if(m_isReadWrite || m_isCommitInProgress)
+  {
+    return nullptr;
+  }
+
+  VolumeDataPageImpl *candidate = nullptr;
+  int candidates = 0;
+
+  for(VolumeDataPageImpl *page = m_pages.GetLastItem(); page && candidates < CACHE_EVICTION_CANDIDATES; page = m_pages.GetPrevItem(page))
+  {
+    if(page->IsPinned() || page->IsEmpty() || page->IsDirty())
+    {
+      continue;
+    }
+
+    if(!candidate || page->GetCachePriority() < candidate->GetCachePriority())
+    {
+      candidate = page;
+    }
+    candidates++;
+  }
+
+  return candidate;
+}
+
+bool VolumeDataPageAccessorImpl::GetCacheEvictionCandidate(double &priority)
+{
+  std::unique_lock<std::mutex> pageListMutexLock(m_pagesMutex, std::try_to_lock);
+  if(!pageListMutexLock.owns_lock())
+  {
+    return false;
+  }
+
+  VolumeDataPageImpl *page = FindCacheEvictionCandidate();
+  if(!page)
+  {
+    return false;
+  }
+
+  priority = page->GetCachePriority();
+  return true;
+}
+
+bool VolumeDataPageAccessorImpl::EvictCacheEvictionCandidate()
+{
+  std::unique_lock<std::mutex> pageListMutexLock(m_pagesMutex, std::try_to_lock);
+  if(!pageListMutexLock.owns_lock())
+  {
+    return false;
+  }
+
+  VolumeDataPageImpl *page = FindCacheEvictionCandidate();
+  if(!page)
+  {
+    return false;
+  }
+
+  RemovePage(page);
+  GetGlobalStateVds().addCacheEviction();
+  delete page;
+  return true;
+}
+
 int64_t VolumeDataPageAccessorImpl::RequestWritePage(int64_t chunk, const DataBlock& dataBlock, const std::vector<uint8_t>& data)
 {
   std::vector<uint8_t> serializedData;
   uint64_t hash;
+  std::vector<uint8_t> adaptiveLevels;
 
-  hash = VolumeDataStore::SerializeVolumeData({ m_layer, chunk }, dataBlock, data, m_layer->GetEffectiveCompressionMethod(), m_layer->GetEffectiveCompressionTolerance(), serializedData);
+  hash = VolumeDataStore::SerializeVolumeData({ m_layer, chunk }, dataBlock, data, m_layer->GetEffectiveCompressionMethod(), m_layer->GetEffectiveCompressionTolerance(), serializedData, adaptiveLevels);
 
   if (hash == VolumeDataHash::UNKNOWN)
   {
@@ -542,7 +757,126 @@ int64_t VolumeDataPageAccessorImpl::RequestWritePage(int64_t chunk, const DataBl
   std::vector<uint8_t> metadata(sizeof(hash));
   memcpy(metadata.data(), &hash, sizeof(hash));
 
-  return m_accessManager->GetVolumeDataStore()->WriteChunk({ m_layer, chunk }, serializedData, metadata);
+  // Wavelet chunks have the adaptive levels after the hash, constant chunks have all levels 0
+  if (CompressionMethod_IsWavelet(m_layer->GetEffectiveCompressionMethod()))
+  {
+    adaptiveLevels.resize(WAVELET_ADAPTIVE_LEVELS);
+    metadata.insert(metadata.end(), adaptiveLevels.begin(), adaptiveLevels.end());
+  }
+
+  int64_t jobId = m_accessManager->GetVolumeDataStore()->WriteChunk({ m_layer, chunk }, serializedData, metadata);
+
+  if(m_lodProducer)
+  {
+    m_lodProducer->AddChunk(chunk, dataBlock, data);
+  }
+
+  return jobId;
+}
+
+void VolumeDataPageAccessorImpl::SetLODProducer(VolumeDataLODProducer *lodProducer)
+{
+  m_lodProducer.reset(lodProducer);
+}
+
+void VolumeDataPageAccessorImpl::EnableLODProduction()
+{
+  assert(!m_isReadWrite && "Only read-only page accessors can produce LOD chunks");
+
+  if (m_layer->GetProduceStatus() != VolumeDataLayer::ProduceStatus_Unavailable || m_lodSourceAccessor)
+  {
+    return;
+  }
+
+  assert(m_layer->GetChildLayer());
+  m_lodSourceAccessor.reset(new VolumeDataPageAccessorImpl(m_accessManager, m_layer->GetChildLayer(), LOD_SOURCE_MAX_PAGES, false));
+  m_lodSourceAccessor->EnableLODProduction();
+}
+
+bool VolumeDataPageAccessorImpl::ProduceLODChunk(const VolumeDataChunk &volumeDataChunk, DataBlock &dataBlock, std::vector<uint8_t> &data, Error &error)
+{
+  VolumeDataLayer const *childLayer = m_lodSourceAccessor->GetLayer();
+
+  if (!VolumeDataStore::CreateConstantValueDataBlock(volumeDataChunk, m_layer->GetFormat(), m_layer->GetNoValue(), m_layer->GetComponents(), m_layer->IsUseNoValue() ? VolumeDataHash::NOVALUE : VolumeDataHash(0.0f), dataBlock, data, error))
+  {
+    return false;
+  }
+
+  int32_t pitch[Dimensionality_Max] = {};
+
+  for (int chunkDimension = 0; chunkDimension < m_layer->GetChunkDimensionality(); chunkDimension++)
+  {
+    int dimension = DimensionGroupUtil::GetDimension(m_layer->GetChunkDimensionGroup(), chunkDimension);
+
+    assert(dimension >= 0 && dimension < Dimensionality_Max);
+    pitch[dimension] = dataBlock.Pitch[chunkDimension];
+  }
+
+  // All child chunks overlapping the chunk including its margins are needed, not just the ones given by GetChildIndices, so the margins are produced as well
+  IndexArray min, max;
+  m_layer->GetChunkMinMax(volumeDataChunk.index, min, max, true);
+
+  for (int dimension = 0; dimension < Dimensionality_Max; dimension++)
+  {
+    min[dimension] = std::max(min[dimension], m_layer->GetDimensionFirstSample(dimension));
+    max[dimension] = std::min(max[dimension], m_layer->GetDimensionFirstSample(dimension) + m_layer->GetDimensionNumSamples(dimension));
+  }
+
+  std::vector<VolumeDataChunk> childChunks;
+  childLayer->GetChunksInRegion(min, max, &childChunks);
+
+  // Start reading all the child chunks before waiting for any of them
+  std::vector<VolumeDataPageImpl *> childPages;
+  childPages.reserve(childChunks.size());
+  for (auto &childChunk : childChunks)
+  {
+    VolumeDataPageImpl *childPage = static_cast<VolumeDataPageImpl *>(m_lodSourceAccessor->PrepareReadPage(childChunk.index, error));
+    if (!childPage)
+    {
+      break;
+    }
+    childPages.push_back(childPage);
+  }
+
+  bool success = childPages.size() == childChunks.size();
+
+  for (size_t child = 0; child < childPages.size(); child++)
+  {
+    VolumeDataPageImpl *childPage = childPages[child];
+
+    if (!success)
+    {
+      m_lodSourceAccessor->CancelPreparedReadPage(childPage);
+      continue;
+    }
+
+    if (!m_lodSourceAccessor->ReadPreparedPaged(childPage))
+    {
+      if (!childPage->GetError(error))
+      {
+        error.code = -1;
+        error.string = "Failed to read the chunk the LOD chunk is produced from";
+      }
+      success = false;
+    }
+    else
+    {
+      int32_t childPitch[Dimensionality_Max];
+      const void *childBuffer = childPage->GetBuffer(childPitch);
+
+      int32_t writtenMin[Dimensionality_Max], writtenMax[Dimensionality_Max];
+      DownsampleChunk(childLayer, childChunks[child].index, childBuffer, childPitch, m_layer, volumeDataChunk.index, data.data(), pitch, writtenMin, writtenMax);
+    }
+    childPage->Release();
+  }
+
+  return success;
+}
+
+void VolumeDataPageAccessorImpl::WriteBackUnpinnedPages()
+{
+  std::unique_lock<std::mutex> pageListMutexLock(m_pagesMutex);
+  LimitPageListSize(0, pageListMutexLock);
 }
 /////////////////////////////////////////////////////////////////////////////
 // Commit
@@ -559,8 +893,11 @@ void VolumeDataPageAccessorImpl::Commit()
   // Make sure we don't start reading any new pages while we're finishing up the current waiting reads
   m_isCommitInProgress = true;
 
+  // Finish writing back the pages that other threads have evicted
+  WaitForWriteBack(-1, pageListMutexLock);
+
   // Finish reading all pages currently being read
-  for(VolumeDataPageImpl *page : m_pages)
+  for(VolumeDataPageImpl *page = m_pages.GetFirstItem(); page; page = m_pages.GetNextItem(page))
   {
     while(page->IsEmpty())
     {
@@ -570,11 +907,11 @@ void VolumeDataPageAccessorImpl::Commit()
   }
 
   // Copy all margins
-  for(VolumeDataPageImpl *page : m_pages)
+  for(VolumeDataPageImpl *page = m_pages.GetFirstItem(); page; page = m_pages.GetNextItem(page))
   {
     if(page->IsWritten())
     {
-      for(VolumeDataPageImpl *targetPage : m_pages)
+      for(VolumeDataPageImpl *targetPage = m_pages.GetFirstItem(); targetPage; targetPage = m_pages.GetNextItem(targetPage))
       {
         if(page->IsCopyMarginNeeded(targetPage))
         {
@@ -584,7 +921,7 @@ void VolumeDataPageAccessorImpl::Commit()
     }
   }
 
-  for(VolumeDataPageImpl *page : m_pages)
+  for(VolumeDataPageImpl *page = m_pages.GetFirstItem(); page; page = m_pages.GetNextItem(page))
   {
     if(page->IsDirty() && m_layer)
     {
@@ -606,5 +943,14 @@ void VolumeDataPageAccessorImpl::Commit()
     m_layer->GetLayout()->CompletePendingWriteChunkRequests(0);
     m_accessManager->FlushUploadQueue();
   }
+
+  if(m_lodProducer)
+  {
+    if(pageListMutexLock.owns_lock())
+    {
+      pageListMutexLock.unlock();
+    }
+    m_lodProducer->Commit();
+  }
 }
 }
@@ -20,21 +20,26 @@
 
 #include <OpenVDS/VolumeDataAccess.h>
 #include "IntrusiveList.h"
+#include "VolumeDataPageImpl.h"
 
-#include <list>
+#include <unordered_map>
 #include <mutex>
 #include <condition_variable>
 #include <vector>
 #include <atomic>
 #include <chrono>
+#include <memory>
 
 namespace OpenVDS
 {
-class VolumeDataPageImpl;
 class VolumeDataLayer;
 class VolumeDataAccessManagerImpl;
+class VolumeDataPageCache;
+class GlobalStateVds;
+class VolumeDataLODProducer;
 struct Error;
 struct DataBlock;
+struct VolumeDataChunk;
 
 class VolumeDataPageAccessorImpl : public VolumeDataPageAccessor
 {
@@ -44,14 +49,23 @@ private:
   int m_pagesFound;
   int m_pagesRead;
   int m_pagesWritten;
-  int m_maxPages;
+  std::atomic_int m_maxPages;
   std::atomic_int m_references;
   bool m_isReadWrite;
   bool m_isCommitInProgress;
   std::atomic<std::chrono::time_point<std::chrono::steady_clock>> m_lastUsed;
-  std::list<VolumeDataPageImpl *> m_pages;
+  // Pages in most recently used order, the map gives constant time lookup by chunk index
+  IntrusiveList<VolumeDataPageImpl, &VolumeDataPageImpl::m_pageListNode> m_pages;
+  std::unordered_map<int64_t, VolumeDataPageImpl *> m_pageMap;
+  // Evicted pages that are being written back without holding the page list mutex
+  std::vector<int64_t> m_writeBackChunks;
   std::condition_variable m_pageReadCondition;
   std::condition_variable m_commitFinishedCondition;
+  std::condition_variable m_writeBackFinishedCondition;
+  // Downsamples the written chunks into the parent LOD layer when the accessor was created with LOD generation
+  std::unique_ptr<VolumeDataLODProducer> m_lodProducer;
+  // Reads the child LOD layer when the chunks of this (unavailable) layer are produced on read
+  std::unique_ptr<VolumeDataPageAccessorImpl> m_lodSourceAccessor;
 
   public:
   std::mutex m_pagesMutex;
@@ -59,6 +73,14 @@ private:
 
 private:
   void LimitPageListSize(int maxPages, std::unique_lock<std::mutex> &pageListMutexLock);
+  VolumeDataPageImpl *FindPage(int64_t chunk) const;
+  void InsertPage(VolumeDataPageImpl *page);
+  void RemovePage(VolumeDataPageImpl *page);
+  void WaitForWriteBack(int64_t chunk, std::unique_lock<std::mutex> &pageListMutexLock);
+  VolumeDataPageImpl *FindCacheEvictionCandidate();
+  VolumeDataPageCache &GetPageCache() const;
+  GlobalStateVds &GetGlobalStateVds() const;
+  bool ProduceLODChunk(const VolumeDataChunk &volumeDataChunk, DataBlock &dataBlock, std::vector<uint8_t> &data, Error &error);
 
 public:
   VolumeDataPageAccessorImpl(VolumeDataAccessManagerImpl *acccessManager, VolumeDataLayer const* layer, int maxPages, bool IsReadWrite);
@@ -93,11 +115,31 @@ public:
   VolumeDataPage *CreatePage(int64_t chunk) override;
   VolumeDataPage *ReadPage(int64_t chunk) override;
   VolumeDataPage *ReadPageAtPosition(const int (&position)[Dimensionality_Max]) override;
+  VolumeDataPageView ReadPageView(int64_t chunk) override;
+
+  bool  IsPageInCache(int64_t chunk);
+
+  // Read a chunk from the volume data store and deserialize it into a buffer laid out as a linear data block, bypassing the pages.
+  // Only chunks that are stored in the layer can be read this way, produced chunks have to be read as pages.
+  bool  CanReadChunkIntoBuffer() const;
+  bool  ReadChunkIntoBuffer(int64_t chunk, void *buffer, int64_t bufferSize, Error &error);
  
   int64_t RequestWritePage(int64_t chunk, const DataBlock &dataBlock, const std::vector<uint8_t> &data);
 
   void  Commit() override;
 
+  void  SetLODProducer(VolumeDataLODProducer *lodProducer);
+
+  // Produce the chunks of the layer by downsampling the layer below if the layer is unavailable (recursively)
+  void  EnableLODProduction();
+
+  // Write back and remove all pages that are not pinned, regardless of the max pages
+  void  WriteBackUnpinnedPages();
+
+  // Used by the VolumeDataPageCache to evict pages when the VDS is over its cache size limit
+  bool  GetCacheEvictionCandidate(double &priority);
+  bool  EvictCacheEvictionCandidate();
+
   bool IsReadWrite() const { return m_isReadWrite; }
 
   VolumeDataAccessManagerImpl *GetManager() const { return m_accessManager; }
@@ -0,0 +1,84 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include "VolumeDataPageCache.h"
+#include "VolumeDataPageAccessorImpl.h"
+
+#include <algorithm>
+
+namespace OpenVDS
+{
+
+VolumeDataPageCache::VolumeDataPageCache()
+  : m_maxSize(0)
+  , m_size(0)
+  , m_inflation(0.0)
+{
+}
+
+double VolumeDataPageCache::GetPriority(double cost, int64_t size) const
+{
+  return m_inflation.load() + (size > 0 ? cost / double(size) : cost);
+}
+
+void VolumeDataPageCache::AddPageAccessor(VolumeDataPageAccessorImpl *pageAccessor)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_pageAccessors.push_back(pageAccessor);
+}
+
+void VolumeDataPageCache::RemovePageAccessor(VolumeDataPageAccessorImpl *pageAccessor)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_pageAccessors.erase(std::remove(m_pageAccessors.begin(), m_pageAccessors.end(), pageAccessor), m_pageAccessors.end());
+}
+
+void VolumeDataPageCache::LimitSize()
+{
+  if (!IsLimited() || m_size <= m_maxSize)
+    return;
+
+  // If another thread is already evicting it will keep going until the cache is within its limit
+  std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+  if (!lock.owns_lock())
+    return;
+
+  while (m_size > m_maxSize)
+  {
+    VolumeDataPageAccessorImpl *victim = nullptr;
+    double victimPriority = 0.0;
+
+    for (VolumeDataPageAccessorImpl *pageAccessor : m_pageAccessors)
+    {
+      double priority;
+      if (pageAccessor->GetCacheEvictionCandidate(priority) && (!victim || priority < victimPriority))
+      {
+        victim = pageAccessor;
+        victimPriority = priority;
+      }
+    }
+
+    // Everything left is pinned, dirty or being read
+    if (!victim || !victim->EvictCacheEvictionCandidate())
+      break;
+
+    if (victimPriority > m_inflation)
+      m_inflation = victimPriority;
+  }
+}
+
+}
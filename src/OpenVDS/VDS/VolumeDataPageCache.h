@@ -0,0 +1,71 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef VOLUMEDATAPAGECACHE_H
+#define VOLUMEDATAPAGECACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace OpenVDS
+{
+class VolumeDataPageAccessorImpl;
+
+// Byte budget shared by all the page accessors of a VDS. The pages are still owned by
+// their page accessors, this class only keeps track of the total size of their buffers
+// and asks the page accessors to evict pages when the total exceeds the limit.
+//
+// Eviction uses the GreedyDual-Size policy: every page has a retention priority of
+// inflation + cost / size, where cost is the time it took to decompress the page. The
+// page with the lowest priority is evicted and the inflation is raised to its
+// priority, so pages that are not used age relative to the pages that are.
+class VolumeDataPageCache
+{
+public:
+  VolumeDataPageCache();
+
+  void    SetMaxSize(int64_t maxSize) { m_maxSize = maxSize; }
+  int64_t GetMaxSize() const { return m_maxSize; }
+  int64_t GetSize() const { return m_size; }
+  bool    IsLimited() const { return m_maxSize > 0; }
+
+  void    AddSize(int64_t size) { m_size += size; }
+  void    RemoveSize(int64_t size) { m_size -= size; }
+
+  double  GetPriority(double cost, int64_t size) const;
+
+  void    AddPageAccessor(VolumeDataPageAccessorImpl *pageAccessor);
+  void    RemovePageAccessor(VolumeDataPageAccessorImpl *pageAccessor);
+
+  // Evict pages until the cache is within its limit. Must not be called with the pages
+  // mutex of any page accessor held.
+  void    LimitSize();
+
+private:
+  std::atomic<int64_t> m_maxSize;
+  std::atomic<int64_t> m_size;
+  std::atomic<double>  m_inflation;
+
+  std::mutex m_mutex;
+  std::vector<VolumeDataPageAccessorImpl *> m_pageAccessors;
+};
+
+}
+
+#endif //VOLUMEDATAPAGECACHE_H
@@ -101,6 +101,8 @@ VolumeDataPageImpl::VolumeDataPageImpl(VolumeDataPageAccessorImpl* volumeDataPag
   , m_isDirty(false)
   , m_requestPrepared(true)
   , m_chunksCopiedTo(0)
+  , m_cacheCost(0.0)
+  , m_cachePriority(0.0)
 {
   for (int32_t iDimension = 0; iDimension < Dimensionality_Max; iDimension++)
   {
@@ -135,7 +137,7 @@ void VolumeDataPageImpl::UnPin()
 bool VolumeDataPageImpl::IsEmpty()
 {
   //assert(m_volumeDataPageAccessor->m_pageListMutex.isLockedByCurrentThread());
-  return m_blob.empty();
+  return !m_blob || m_blob->empty();
 }
 
 bool VolumeDataPageImpl::IsDirty()
@@ -162,13 +164,13 @@ void VolumeDataPageImpl::SetBufferData(const DataBlock &dataBlock, int32_t (&pit
   m_dataBlock = dataBlock;
   static_assert(sizeof(pitch) == sizeof(m_pitch), "Pitch of different size");
   memcpy(m_pitch, pitch, sizeof(m_pitch));
-  m_blob = std::move(blob);
+  m_blob = std::make_shared<std::vector<uint8_t>>(std::move(blob));
 }
 
 void VolumeDataPageImpl::WriteBack(VolumeDataLayer const* volumeDataLayer, std::unique_lock<std::mutex>& pageListMutexLock)
 {
   assert(m_isDirty);
-  m_volumeDataPageAccessor->RequestWritePage(m_chunk, m_dataBlock, m_blob);
+  m_volumeDataPageAccessor->RequestWritePage(m_chunk, m_dataBlock, *m_blob);
   auto layout = const_cast<VolumeDataLayoutImpl*>(static_cast<VolumeDataLayoutImpl const*>(m_volumeDataPageAccessor->GetLayout()));
   m_isDirty = false;
   layout->CompletePendingWriteChunkRequests(16);
@@ -186,9 +188,34 @@ void* VolumeDataPageImpl::GetBufferInternal(int(&anPitch)[Dimensionality_Max], b
   if(isReadWrite)
   {
     m_isReadWrite = true;
+
+    // The buffer is shared with views of the page, which must not see the writes
+    if(m_blob.use_count() > 1)
+    {
+      m_blob = std::make_shared<std::vector<uint8_t>>(*m_blob);
+    }
   }
 
-  return m_blob.data();
+  return m_blob ? m_blob->data() : nullptr;
+}
+
+VolumeDataPageView VolumeDataPageImpl::GetBufferViewInternal()
+{
+  //assert(m_volumeDataPageAccessor->m_pageListMutex.isLockedByCurrentThread());
+
+  if(!m_blob)
+  {
+    return VolumeDataPageView();
+  }
+
+  int min[Dimensionality_Max];
+  int max[Dimensionality_Max];
+  GetMinMax(min, max);
+
+  // A writable buffer may already have been handed out, so the view gets a copy that will not see later writes
+  std::shared_ptr<const std::vector<uint8_t>> buffer = m_isReadWrite ? std::make_shared<std::vector<uint8_t>>(*m_blob) : m_blob;
+
+  return VolumeDataPageView(std::move(buffer), min, max, m_pitch);
 }
 
 bool VolumeDataPageImpl::IsCopyMarginNeeded(VolumeDataPageImpl* targetPage)
@@ -265,10 +292,16 @@ void VolumeDataPageImpl::CopyMargin(VolumeDataPageImpl* targetPage)
   int32_t iSourceIndex = 0;
   int32_t iTargetIndex = 0;
 
+  VolumeDataLayer const *volumeDataLayer = m_volumeDataPageAccessor->GetLayer();
+
   for(int32_t iDimension = 0; iDimension < Dimensionality_Max; iDimension++)
   {
-    iSourceIndex += (overlapMin[iDimension] - sourceMin[iDimension]) * sourcePitch[iDimension];
-    iTargetIndex += (overlapMin[iDimension] - targetMin[iDimension]) * targetPitch[iDimension];
+    // The overlap is in voxels, which have to be converted to samples in the LOD decimated dimensions
+    int32_t lodShift = (volumeDataLayer->IsDimensionChunked(iDimension) && volumeDataLayer->IsDimensionLODDecimated(iDimension)) ? volumeDataLayer->GetLOD() : 0;
+
+    iSourceIndex += ((overlapMin[iDimension] - sourceMin[iDimension]) >> lodShift) * sourcePitch[iDimension];
+    iTargetIndex += ((overlapMin[iDimension] - targetMin[iDimension]) >> lodShift) * targetPitch[iDimension];
+    overlapSize[iDimension] = (overlapSize[iDimension] + (1 << lodShift) - 1) >> lodShift;
   }
 
   int32_t remappedSourcePitch[4];
@@ -350,6 +383,12 @@ const void* VolumeDataPageImpl::GetBuffer(int(&pitch)[Dimensionality_Max])
 
   return GetBufferInternal(pitch, m_volumeDataPageAccessor->IsReadWrite());
 }
+VolumeDataPageView VolumeDataPageImpl::GetBufferView()
+{
+  std::unique_lock<std::mutex>  pageListMutexLock(const_cast<VolumeDataPageAccessorImpl *>(m_volumeDataPageAccessor)->m_pagesMutex);
+
+  return GetBufferViewInternal();
+}
 void* VolumeDataPageImpl::GetWritableBuffer(int(&pitch)[Dimensionality_Max])
 {
  std::unique_lock<std::mutex>  pageListMutexLock(const_cast<VolumeDataPageAccessorImpl *>(m_volumeDataPageAccessor)->m_pagesMutex);
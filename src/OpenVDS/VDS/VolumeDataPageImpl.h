@@ -21,8 +21,10 @@
 #include <OpenVDS/VolumeDataAccess.h>
 
 #include "DataBlock.h"
+#include "IntrusiveList.h"
 
 #include <mutex>
+#include <memory>
 #include <vector>
 #include <atomic>
 
@@ -39,7 +41,7 @@ private:
 
   DataBlock m_dataBlock;
   int32_t m_pitch[Dimensionality_Max];
-  std::vector<uint8_t> m_blob;
+  std::shared_ptr<std::vector<uint8_t>> m_blob; // Shared with the views of the page
 
   std::atomic_int m_pins;
 
@@ -62,7 +64,12 @@ private:
 
   int32_t m_chunksCopiedTo;
 
+  double  m_cacheCost;
+  double  m_cachePriority;
+
 public:
+  IntrusiveListNode<VolumeDataPageImpl> m_pageListNode;
+
   VolumeDataPageImpl(VolumeDataPageAccessorImpl *volumeDataPageAccessor, int64_t chunk);
   VolumeDataPageImpl(VolumeDataPageImpl const &) = delete;
 
@@ -82,7 +89,10 @@ public:
   void          SetBufferData(const DataBlock& dataBlock, int32_t(&pitch)[Dimensionality_Max], std::vector<uint8_t>&& blob);
   void          WriteBack(VolumeDataLayer const *volumeDataLayer, std::unique_lock<std::mutex> &pageListMutexLock);
   void *        GetBufferInternal(int (&anPitch)[Dimensionality_Max], bool isReadWrite);
-  void *        GetRawBufferInternal() { return m_blob.data(); }
+  void *        GetRawBufferInternal() { return m_blob ? m_blob->data() : nullptr; }
+  int64_t       GetBufferSize() const { return m_blob ? int64_t(m_blob->size()) : 0; }
+  VolumeDataPageView
+                GetBufferViewInternal();
   bool          IsCopyMarginNeeded(VolumeDataPageImpl *targetPage);
   void          CopyMargin(VolumeDataPageImpl *targetPage);
 
@@ -95,6 +105,12 @@ public:
   void          SetError(const OpenVDS::Error &error) { m_error = error; }
   bool          GetError(OpenVDS::Error &error) { error = m_error; return error.code != 0; }
 
+  // Cost of reading the page again and its current priority in the VolumeDataPageCache
+  void          SetCacheCost(double cost) { m_cacheCost = cost; }
+  double        GetCacheCost() const { return m_cacheCost; }
+  void          SetCachePriority(double priority) { m_cachePriority = priority; }
+  double        GetCachePriority() const { return m_cachePriority; }
+
   // Implementation of Hue::HueSpaceLib::VolumeDataPage interface, these methods aquire a lock (except the GetMinMax methods which don't need to)
   VolumeDataPageAccessor &
         GetVolumeDataPageAccessor() const override;
@@ -102,6 +118,7 @@ public:
   void  GetMinMaxExcludingMargin(int (&minExcludingMargin)[Dimensionality_Max], int (&maxExcludingMargin)[Dimensionality_Max]) const override;
   Error GetError() const override;
   const void *GetBuffer(int (&pitch)[Dimensionality_Max]) override; // Getting the buffer will block if the page is currently being read from the VolumeDataCache
+  VolumeDataPageView GetBufferView() override;
   void *GetWritableBuffer(int (&pitch)[Dimensionality_Max]) override;
   void  UpdateWrittenRegion(const int (&writtenMin)[Dimensionality_Max], const int (&writtenMax)[Dimensionality_Max]) override;
   void  Release() override;
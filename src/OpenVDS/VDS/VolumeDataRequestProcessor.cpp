@@ -18,10 +18,13 @@
 #include "VolumeDataRequestProcessor.h"
 
 #include "VolumeDataChunk.h"
+#include "VolumeDataChunkSet.h"
 #include "VolumeDataChannelMapping.h"
 #include "VolumeDataAccessManagerImpl.h"
 #include "VolumeDataLayoutImpl.h"
 #include "VolumeDataPageImpl.h"
+#include "VolumeDataSampleKernels.h"
+#include "VolumeDataConversionKernels.h"
 #include "DataBlock.h"
 #include "DimensionGroup.h"
 #include "CompilerDefines.h"
@@ -33,6 +36,7 @@
 #include <cstdint>
 #include <algorithm>
 #include <atomic>
+#include <future>
 #include <thread>
 #include <chrono>
 
@@ -45,6 +49,8 @@ namespace OpenVDS
 {
 
 const int MIN_MEMCPY = 4096;
+// Jobs touching at most this many chunks are treated as interactive and are scheduled ahead of bulk jobs
+const int MAX_INTERACTIVE_JOB_CHUNKS = 64;
 template <unsigned int IVAL> struct FIND_SHIFT    { enum { RET = 1 + FIND_SHIFT<IVAL/2>::RET }; };
 template <>                  struct FIND_SHIFT<1> { enum { RET = 0 }; };
 template <>                  struct FIND_SHIFT<0> { enum { RET = 0 }; };
@@ -197,11 +203,23 @@ static int32_t CombineAndReduceDimensions (int32_t (&sourceSize  )[DataBlock::Di
 }
 
 template <typename T, bool isUseNoValue>
-static void CopyTo1Bit(uint8_t * __restrict target, int64_t targetBit, const QuantizingValueConverterWithNoValue<float, T, isUseNoValue> &valueConverter, const T * __restrict source, float noValue, int32_t count)
+static void CopyTo1Bit(uint8_t * __restrict target, int64_t targetBit, const QuantizingValueConverterWithNoValue<float, T, isUseNoValue> &valueConverter, const T * __restrict source, float noValue, int32_t count, const ConversionKernels::ValueConversion *kernelConversion)
 {
     target += targetBit / 8;
     uint8_t bits = *target;
 
+    // Whole bytes are packed by the conversion kernels
+    if (kernelConversion && count >= 8)
+    {
+      int32_t byteCount = count / 8;
+      ConversionKernels::PackBits(target, ConversionKernels::ElementFormat<T>::format, source, *kernelConversion, noValue, byteCount);
+      target[0] |= bits;
+      target += byteCount;
+      source += byteCount * 8;
+      count -= byteCount * 8;
+      bits = 0;
+    }
+
     int32_t mask = 1;
 
     for(int32_t voxel = 0; voxel < count; voxel++)
@@ -236,7 +254,7 @@ static void CopyTo1Bit(uint8_t * __restrict target, int64_t targetBit, const Qua
 }
 
 template <typename T>
-static void CopyFrom1Bit(T * __restrict target, const uint8_t * __restrict source, uint64_t bitIndex, int32_t count)
+static void CopyFrom1BitScalar(T * __restrict target, const uint8_t * __restrict source, uint64_t bitIndex, int32_t count)
 {
   source += bitIndex / 8;
   uint8_t bits = *source;
@@ -255,6 +273,32 @@ static void CopyFrom1Bit(T * __restrict target, const uint8_t * __restrict sourc
   }
 }
 
+template <typename T>
+static void CopyFrom1Bit(T * __restrict target, const uint8_t * __restrict source, uint64_t bitIndex, int32_t count)
+{
+  // Copy up to the first source byte boundary, then unpack whole bytes with the conversion kernels
+  if (ConversionKernels::IsFormatSupported(ConversionKernels::ElementFormat<T>::format) && count >= 16)
+  {
+    int32_t head = int32_t((8 - bitIndex % 8) % 8);
+    if (head)
+    {
+      CopyFrom1BitScalar(target, source, bitIndex, head);
+    }
+    int32_t byteCount = (count - head) / 8;
+    ConversionKernels::UnpackBits(ConversionKernels::ElementFormat<T>::format, target + head, source + (bitIndex + head) / 8, byteCount);
+
+    int32_t done = head + byteCount * 8;
+    target += done;
+    bitIndex += done;
+    count -= done;
+  }
+
+  if (count > 0)
+  {
+    CopyFrom1BitScalar(target, source, bitIndex, count);
+  }
+}
+
 static force_inline void CopyBits(void* target, int64_t targetBit, const void* source, int64_t sourceBit, int32_t bits)
 {
   while(bits--)
@@ -326,6 +370,12 @@ QuantizingValueConverterWithNoValue<T,S,noValue> createValueConverter(const Conv
   return QuantizingValueConverterWithNoValue<T, S, noValue>(cp.valueRangeMin, cp.valueRangeMax, cp.integerScale, cp.integerOffset, cp.noValue, cp.replacementNoValue);
 }
 
+template<typename T, typename S>
+ConversionKernels::ValueConversion createKernelConversion(const ConversionParameters &cp, bool noValue)
+{
+  return ConversionKernels::CreateValueConversion<T, S>(cp.valueRangeMin, cp.valueRangeMax, cp.integerScale, cp.integerOffset, cp.noValue, cp.replacementNoValue, noValue);
+}
+
 template<typename T, bool targetOneBit, typename S, bool sourceOneBit, bool noValue>
 struct BlockCopy
 {
@@ -342,6 +392,12 @@ struct BlockCopy
     QuantizingValueConverterWithNoValue<T, S, noValue> valueConverter = createValueConverter<T,S,noValue>(conversionParamters);
     QuantizingValueConverterWithNoValue<float, S, noValue> floatValueConverter = createValueConverter<float,S,noValue>(conversionParamters);
 
+    // Rows between the U8, U16 and R32 formats (or packed to 1-bit) are converted by the vectorized conversion kernels
+    const VolumeDataChannelDescriptor::Format targetFormat = ConversionKernels::ElementFormat<T>::format;
+    const VolumeDataChannelDescriptor::Format sourceFormat = ConversionKernels::ElementFormat<S>::format;
+    const bool isKernelConversion = !sourceOneBit && ConversionKernels::IsFormatSupported(sourceFormat) && (targetOneBit || ConversionKernels::IsFormatSupported(targetFormat));
+    ConversionKernels::ValueConversion kernelConversion = targetOneBit ? createKernelConversion<float, S>(conversionParamters, noValue) : createKernelConversion<T, S>(conversionParamters, noValue);
+
     for (int dimension3 = 0; dimension3 < overlapSize[3]; dimension3++)
     {
       for (int dimension2 = 0; dimension2 < overlapSize[2]; dimension2++)
@@ -359,13 +415,18 @@ struct BlockCopy
             }
             else
             {
-              CopyTo1Bit(static_cast<uint8_t *>(target), targetLocalBaseSize + targetLocal, floatValueConverter, reinterpret_cast<const S *>(sourceLocalBase + sourceLocal), conversionParamters.noValue, overlapSize[0]);
+              CopyTo1Bit(static_cast<uint8_t *>(target), targetLocalBaseSize + targetLocal, floatValueConverter, reinterpret_cast<const S *>(sourceLocalBase + sourceLocal), conversionParamters.noValue, overlapSize[0], isKernelConversion ? &kernelConversion : nullptr);
             }
           }
           else if(sourceOneBit)
           {
             CopyFrom1Bit(reinterpret_cast<T *>(targetLocalBase + targetLocal), static_cast<const uint8_t *>(source), sourceLocalBaseSize + sourceLocal, overlapSize[0]);
-          } else
+          }
+          else if (isKernelConversion)
+          {
+            ConversionKernels::ConvertValues(targetFormat, targetLocalBase + targetLocal, sourceFormat, sourceLocalBase + sourceLocal, kernelConversion, overlapSize[0]);
+          }
+          else
           {
             ConvertAndCopy(reinterpret_cast<T *>(targetLocalBase + targetLocal), reinterpret_cast<const S *>(sourceLocalBase + sourceLocal), valueConverter, overlapSize[0]);
           }
@@ -473,15 +534,16 @@ static void DispatchBlockCopy(VolumeDataChannelDescriptor::Format destinationFor
   }
 }
 
-static bool RequestSubsetProcessPage(VolumeDataPageImpl* page, const VolumeDataChunk &chunk, const int32_t (&destMin)[Dimensionality_Max], const int32_t (&destMax)[Dimensionality_Max], VolumeDataChannelDescriptor::Format destinationFormat, const ConversionParameters &conversionParameters, void *destBuffer, Error &error)
+// Copy the part of a deserialized chunk that overlaps the requested subset into the destination buffer
+static void RequestSubsetProcessChunk(const VolumeDataChunk &chunk, const DataBlock &dataBlock, const void *source, const int32_t (&destMin)[Dimensionality_Max], const int32_t (&destMax)[Dimensionality_Max], VolumeDataChannelDescriptor::Format destinationFormat, const ConversionParameters &conversionParameters, void *destBuffer)
 {
   int32_t sourceMin[Dimensionality_Max];
   int32_t sourceMax[Dimensionality_Max];
   int32_t sourceMinExcludingMargin[Dimensionality_Max];
   int32_t sourceMaxExcludingMargin[Dimensionality_Max];
 
-  page->GetMinMax(sourceMin, sourceMax);
-  page->GetMinMaxExcludingMargin(sourceMinExcludingMargin, sourceMaxExcludingMargin);
+  chunk.layer->GetChunkMinMax(chunk.index, sourceMin, sourceMax, true);
+  chunk.layer->GetChunkMinMax(chunk.index, sourceMinExcludingMargin, sourceMaxExcludingMargin, false);
 
   int32_t LOD = chunk.layer->GetLOD();
 
@@ -525,7 +587,7 @@ static bool RequestSubsetProcessPage(VolumeDataPageImpl* page, const VolumeDataC
       if (dimension == DimensionGroupUtil::GetDimension(sourceDimensionGroup, iCopyDimension))
       {
 
-        globalSourceSize[dimension] = page->GetDataBlock().AllocatedSize[iCopyDimension];
+        globalSourceSize[dimension] = dataBlock.AllocatedSize[iCopyDimension];
         if (sourceIs1Bit && iCopyDimension == 0)
         {
           globalSourceSize[dimension] *= 8;
@@ -558,12 +620,14 @@ static bool RequestSubsetProcessPage(VolumeDataPageImpl* page, const VolumeDataC
   int32_t copyDimensions = CombineAndReduceDimensions(sourceSize, sourceOffset, targetSize, targetOffset, overlapSize, globalSourceSize, globalSourceOffset, globalTargetSize, globalTargetOffset, globalOverlapSize);
   (void) copyDimensions;
 
-  void *source = page->GetRawBufferInternal();
-
   DispatchBlockCopy(destinationFormat, destBuffer, targetOffset, targetSize,
     sourceFormat, source, sourceOffset, sourceSize,
     overlapSize, conversionParameters);
+}
 
+static bool RequestSubsetProcessPage(VolumeDataPageImpl* page, const VolumeDataChunk &chunk, const int32_t (&destMin)[Dimensionality_Max], const int32_t (&destMax)[Dimensionality_Max], VolumeDataChannelDescriptor::Format destinationFormat, const ConversionParameters &conversionParameters, void *destBuffer, Error &error)
+{
+  RequestSubsetProcessChunk(chunk, page->GetDataBlock(), page->GetRawBufferInternal(), destMin, destMax, destinationFormat, conversionParameters, destBuffer);
   return true;
 }
 
@@ -573,6 +637,67 @@ struct Box
   int32_t max[Dimensionality_Max];
 };
 
+// Check if the request is exactly one chunk without margins in its native format, and the buffer has the layout of a linear
+// data block of the chunk. Then the chunk can be deserialized straight into the buffer of the request.
+static bool IsDirectSubsetRequest(const VolumeDataChunk &chunk, const Box &box, VolumeDataChannelDescriptor::Format format, bool isReplaceNoValue, int64_t &bufferSize)
+{
+  VolumeDataLayer const *layer = chunk.layer;
+
+  if (format != layer->GetFormat() || format == VolumeDataChannelDescriptor::Format_1Bit || layer->GetComponents() != VolumeDataChannelDescriptor::Components_1)
+  {
+    return false;
+  }
+
+  if (isReplaceNoValue && layer->IsUseNoValue())
+  {
+    return false;
+  }
+
+  int32_t chunkMin[Dimensionality_Max];
+  int32_t chunkMax[Dimensionality_Max];
+  int32_t chunkMinExcludingMargin[Dimensionality_Max];
+  int32_t chunkMaxExcludingMargin[Dimensionality_Max];
+
+  layer->GetChunkMinMax(chunk.index, chunkMin, chunkMax, true);
+  layer->GetChunkMinMax(chunk.index, chunkMinExcludingMargin, chunkMaxExcludingMargin, false);
+
+  for (int32_t dimension = 0; dimension < Dimensionality_Max; dimension++)
+  {
+    if (chunkMin[dimension] != chunkMinExcludingMargin[dimension] || chunkMax[dimension] != chunkMaxExcludingMargin[dimension] ||
+        chunkMin[dimension] != box.min[dimension] || chunkMax[dimension] != box.max[dimension])
+    {
+      return false;
+    }
+  }
+
+  int32_t size[DataBlock::Dimensionality_Max];
+  layer->GetChunkVoxelSize(chunk.index, size);
+
+  DataBlock dataBlock;
+  Error error;
+  if (!InitializeDataBlock(format, layer->GetComponents(), (enum DataBlock::Dimensionality)(layer->GetChunkDimensionality()), size, dataBlock, error) || !IsDataBlockLinear(dataBlock))
+  {
+    return false;
+  }
+
+  // The size of the request in each dimension of the chunk must be the size of the chunk, which can differ for decimated dimensions
+  VolumeDataLayoutImpl *volumeDataLayout = layer->GetLayout();
+  DimensionGroup dimensionGroup = layer->GetChunkDimensionGroup();
+
+  for (int32_t chunkDimension = 0; chunkDimension < layer->GetChunkDimensionality(); chunkDimension++)
+  {
+    int32_t dimension = DimensionGroupUtil::GetDimension(dimensionGroup, chunkDimension);
+    int32_t sizeThisLOD = volumeDataLayout->IsDimensionLODDecimated(dimension) ? GetLODSize(box.min[dimension], box.max[dimension], layer->GetLOD()) : box.max[dimension] - box.min[dimension];
+    if (sizeThisLOD != size[chunkDimension])
+    {
+      return false;
+    }
+  }
+
+  bufferSize = GetByteSize(dataBlock);
+  return true;
+}
+
 int64_t VolumeDataRequestProcessor::RequestVolumeSubset(void *buffer, VolumeDataLayer const *volumeDataLayer, const int32_t(&minRequested)[Dimensionality_Max], const int32_t (&maxRequested)[Dimensionality_Max], int32_t LOD, VolumeDataChannelDescriptor::Format format, bool isReplaceNoValue, float replacementNoValue)
 {
   Box boxRequested;
@@ -586,18 +711,34 @@ int64_t VolumeDataRequestProcessor::RequestVolumeSubset(void *buffer, VolumeData
     boxRequested.max[dimension] = 1;
   }
 
-  std::vector<VolumeDataChunk> chunksInRegion;
+  VolumeDataChunkSet chunksInRegion(volumeDataLayer);
 
-  volumeDataLayer->GetChunksInRegion(boxRequested.min, boxRequested.max, &chunksInRegion);
+  chunksInRegion.AddRegion(boxRequested.min, boxRequested.max);
 
-  if (chunksInRegion.size() == 0)
+  if (chunksInRegion.IsEmpty())
   {
     throw std::runtime_error("Requested volume subset does not contain any data");
   }
 
+  // A request for exactly one chunk that is not in the page cache is deserialized straight into the buffer instead of through a page
+  int64_t directBufferSize = 0;
+  if (chunksInRegion.GetChunks().size() == 1 && IsDirectSubsetRequest(chunksInRegion.GetChunks().front(), boxRequested, format, isReplaceNoValue, directBufferSize))
+  {
+    VolumeDataChunk chunk = chunksInRegion.GetChunks().front();
+    VolumeDataPageAccessorImpl *pageAccessor = AcquirePageAccessor(volumeDataLayer, 8);
+
+    if (pageAccessor->CanReadChunkIntoBuffer() && !pageAccessor->IsPageInCache(chunk.index))
+    {
+      return AddDirectJob(pageAccessor, chunk, [pageAccessor, chunk, buffer, directBufferSize](Error &error) { return pageAccessor->ReadChunkIntoBuffer(chunk.index, buffer, directBufferSize, error); });
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    pageAccessor->RemoveReference();
+  }
+
   ConversionParameters conversionParameters = makeConversionParameters(volumeDataLayer, isReplaceNoValue, replacementNoValue);
 
-  return AddJob(chunksInRegion, [boxRequested, buffer, format, conversionParameters](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error &error) {return RequestSubsetProcessPage(page, dataChunk, boxRequested.min, boxRequested.max, format, conversionParameters, buffer, error);}, format == VolumeDataChannelDescriptor::Format_1Bit);
+  return AddJob(chunksInRegion.GetChunks(), [boxRequested, buffer, format, conversionParameters](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error &error) {return RequestSubsetProcessPage(page, dataChunk, boxRequested.min, boxRequested.max, format, conversionParameters, buffer, error);}, format == VolumeDataChannelDescriptor::Format_1Bit);
 }
 
 struct ProjectVars
@@ -982,7 +1123,7 @@ VolumeDataRequestProcessor::RequestProjectedVolumeSubset(void *buffer, VolumeDat
     boxRequested.max[dimension] = 1;
   }
 
-  std::vector<VolumeDataChunk> chunksInRegion;
+  VolumeDataChunkSet chunksInRegion(volumeDataLayer);
 
   int32_t projectionDimension = -1;
   int32_t projectionDimensionPosition = -1;
@@ -1058,7 +1199,6 @@ VolumeDataRequestProcessor::RequestProjectedVolumeSubset(void *buffer, VolumeDat
   }
 
   std::vector<VolumeDataChunk> chunksInProjectedRegion;
-  std::vector<VolumeDataChunk> chunksIntersectingPlane;
 
   volumeDataLayer->GetChunksInRegion(boxRequested.min,
                                      boxRequested.max,
@@ -1106,28 +1246,14 @@ VolumeDataRequestProcessor::RequestProjectedVolumeSubset(void *buffer, VolumeDat
     boxProjected.min[projectedDimensionsPair[1]] = min[projectedDimensionsPair[1]];
     boxProjected.max[projectedDimensionsPair[1]] = max[projectedDimensionsPair[1]];
 
-    volumeDataLayer->GetChunksInRegion(boxProjected.min,
-                                       boxProjected.max,
-                                            &chunksIntersectingPlane);
-
-    for (int iChunkInPlane = 0; iChunkInPlane < int(chunksIntersectingPlane.size()); iChunkInPlane++)
-    {
-      VolumeDataChunk &chunkInIntersectingPlane = chunksIntersectingPlane[iChunkInPlane];
-      auto chunk_it = std::find_if(chunksInRegion.begin(), chunksInRegion.end(), [&chunkInIntersectingPlane] (const VolumeDataChunk &a) { return a.index == chunkInIntersectingPlane.index && a.layer == chunkInIntersectingPlane.layer; });
-      if (chunk_it == chunksInRegion.end())
-      {
-        chunksInRegion.push_back(chunkInIntersectingPlane);
-      }
-    }
-
-    chunksIntersectingPlane.clear();
+    chunksInRegion.AddRegion(boxProjected.min, boxProjected.max);
   }
 
-  if(chunksInRegion.size() == 0)
+  if(chunksInRegion.IsEmpty())
   {
     throw std::runtime_error("Requested volume subset does not contain any data");
   }
-  return AddJob(chunksInRegion, [boxRequested, buffer, projectedDimensions, voxelPlaneSwapped, format, interpolationMethod, isReplaceNoValue, replacementNoValue](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error &error) { return RequestProjectedVolumeSubsetProcessPage(page, dataChunk, boxRequested.min, boxRequested.max, projectedDimensions, voxelPlaneSwapped, format, interpolationMethod, isReplaceNoValue, replacementNoValue, buffer, error);}, format == VolumeDataChannelDescriptor::Format_1Bit);
+  return AddJob(chunksInRegion.GetChunks(), [boxRequested, buffer, projectedDimensions, voxelPlaneSwapped, format, interpolationMethod, isReplaceNoValue, replacementNoValue](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error &error) { return RequestProjectedVolumeSubsetProcessPage(page, dataChunk, boxRequested.min, boxRequested.max, projectedDimensions, voxelPlaneSwapped, format, interpolationMethod, isReplaceNoValue, replacementNoValue, buffer, error);}, format == VolumeDataChannelDescriptor::Format_1Bit);
 }
 
 struct VolumeDataSamplePos
@@ -1142,28 +1268,74 @@ struct VolumeDataSamplePos
   }
 };
 
-template <typename T, InterpolationMethod INTERPMETHOD, bool isUseNoValue>
-static void SampleVolume(VolumeDataPageImpl *page, const VolumeDataLayer *volumeDataLayer, const std::vector<VolumeDataSamplePos> &volumeSamplePositions, int32_t iStartSamplePos, int32_t nSamplePos, float noValue, void *destBuffer)
+// The transform from voxel coordinates to the local index in the buffer of a page, set up once per page
+struct PageSampleTransform
 {
-  const DataBlock &dataBlock = page->GetDataBlock();
-  int64_t chunkIndex = page->GetChunkIndex();
+  int32_t chunkDimension[3];
+  int32_t min[3];
+  float   scale[3];
+  float   constant[3];   // Used for the local index when there is no chunk dimension
 
-  int32_t chunkDimension0 = volumeDataLayer->GetChunkDimension(0);
-  int32_t chunkDimension1 = volumeDataLayer->GetChunkDimension(1);
-  int32_t chunkDimension2 = volumeDataLayer->GetChunkDimension(2);
+  PageSampleTransform(const VolumeDataLayer *volumeDataLayer, int64_t chunkIndex, float constantIndex)
+  {
+    int32_t chunkMin[Dimensionality_Max];
+    int32_t chunkMax[Dimensionality_Max];
 
-  assert(chunkDimension0 >= 0 && chunkDimension1 >= 0);
+    volumeDataLayer->GetChunkMinMax(chunkIndex, chunkMin, chunkMax, true);
 
-  int32_t min[Dimensionality_Max];
-  int32_t max[Dimensionality_Max];
+    float LODScale = 1.0f / (1 << volumeDataLayer->GetLOD());
 
-  volumeDataLayer->GetChunkMinMax(chunkIndex, min, max, true);
+    int32_t fullResolutionDimension = volumeDataLayer->GetLayout()->GetFullResolutionDimension();
 
-  int32_t LOD = volumeDataLayer->GetLOD();
+    for (int i = 0; i < 3; i++)
+    {
+      chunkDimension[i] = volumeDataLayer->GetChunkDimension(i);
+      min[i] = chunkDimension[i] >= 0 ? chunkMin[chunkDimension[i]] : 0;
+      scale[i] = chunkDimension[i] == fullResolutionDimension ? 1 : LODScale;
+      constant[i] = constantIndex;
+    }
+
+    assert(chunkDimension[0] >= 0 && chunkDimension[1] >= 0);
+  }
+
+  float LocalIndex(const NDPos &pos, int i) const
+  {
+    return chunkDimension[i] >= 0 ? (pos.Data[chunkDimension[i]] - min[i]) * scale[i] : constant[i];
+  }
+
+  FloatVector3 LocalIndex(const NDPos &pos) const
+  {
+    return FloatVector3(LocalIndex(pos, 0), LocalIndex(pos, 1), LocalIndex(pos, 2));
+  }
+};
+
+static SampleKernels::SampleBuffer GetSampleBuffer(VolumeDataPageImpl *page, bool isUseNoValue, float noValue)
+{
+  const DataBlock &dataBlock = page->GetDataBlock();
+
+  SampleKernels::SampleBuffer sampleBuffer;
+  sampleBuffer.data = (const float *)page->GetRawBufferInternal();
+  for (int i = 0; i < 3; i++)
+  {
+    sampleBuffer.size[i] = dataBlock.Size[i];
+    sampleBuffer.pitch[i] = dataBlock.Pitch[i];
+  }
+  sampleBuffer.isUseNoValue = isUseNoValue;
+  sampleBuffer.noValue = noValue;
+  sampleBuffer.replacementNoValue = noValue;
+  return sampleBuffer;
+}
 
-  float LODScale = 1.0f / (1 << LOD);
+// The number of positions transformed and sampled at a time by the batched sample kernels
+static const int SAMPLE_BATCH_SIZE = 256;
+
+template <typename T, InterpolationMethod INTERPMETHOD, bool isUseNoValue>
+static void SampleVolume(VolumeDataPageImpl *page, const VolumeDataLayer *volumeDataLayer, const std::vector<VolumeDataSamplePos> &volumeSamplePositions, int32_t iStartSamplePos, int32_t nSamplePos, float noValue, void *destBuffer)
+{
+  const DataBlock &dataBlock = page->GetDataBlock();
+  int64_t chunkIndex = page->GetChunkIndex();
 
-  int32_t fullResolutionDimension = volumeDataLayer->GetLayout()->GetFullResolutionDimension();
+  PageSampleTransform transform(volumeDataLayer, chunkIndex, 0.0f);
 
   VolumeSampler<T, INTERPMETHOD, isUseNoValue> volumeSampler(dataBlock.Size, dataBlock.Pitch, volumeDataLayer->GetValueRange().Min, volumeDataLayer->GetValueRange().Max,
     volumeDataLayer->GetIntegerScale(), volumeDataLayer->GetIntegerOffset(), noValue, noValue);
@@ -1176,19 +1348,46 @@ static void SampleVolume(VolumeDataPageImpl *page, const VolumeDataLayer *volume
 
     if (volumeDataSamplePos.chunkIndex != chunkIndex) break;
 
-    FloatVector3 pos((volumeDataSamplePos.pos.Data[chunkDimension0] - min[chunkDimension0]) * (chunkDimension0 == fullResolutionDimension ? 1 : LODScale),
-                     (volumeDataSamplePos.pos.Data[chunkDimension1] - min[chunkDimension1]) * (chunkDimension1 == fullResolutionDimension ? 1 : LODScale),
-                      0);
+    typename InterpolatedRealType<T>::type value = volumeSampler.Sample3D(buffer, transform.LocalIndex(volumeDataSamplePos.pos));
+
+    static_cast<float *>(destBuffer)[volumeDataSamplePos.originalSample] = (float)value;
+  }
+}
+
+// Sample float data with the batched sample kernels, the results are the same as from SampleVolume<float, ...>
+static void SampleVolumeBatched(VolumeDataPageImpl *page, const VolumeDataLayer *volumeDataLayer, const std::vector<VolumeDataSamplePos> &volumeSamplePositions, InterpolationMethod interpolationMethod, int32_t iStartSamplePos, int32_t nSamplePos, float noValue, void *destBuffer)
+{
+  int64_t chunkIndex = page->GetChunkIndex();
+
+  PageSampleTransform transform(volumeDataLayer, chunkIndex, 0.0f);
+  SampleKernels::SampleBuffer sampleBuffer = GetSampleBuffer(page, volumeDataLayer->IsUseNoValue(), noValue);
+
+  float u[SAMPLE_BATCH_SIZE], v[SAMPLE_BATCH_SIZE], w[SAMPLE_BATCH_SIZE], result[SAMPLE_BATCH_SIZE];
+
+  int32_t iEndSamplePos = iStartSamplePos;
+  while (iEndSamplePos < nSamplePos && volumeSamplePositions[iEndSamplePos].chunkIndex == chunkIndex)
+  {
+    iEndSamplePos++;
+  }
+
+  for (int32_t iBatchStart = iStartSamplePos; iBatchStart < iEndSamplePos; iBatchStart += SAMPLE_BATCH_SIZE)
+  {
+    int count = std::min(SAMPLE_BATCH_SIZE, int(iEndSamplePos - iBatchStart));
 
-    if (chunkDimension2 >= 0)
+    for (int i = 0; i < count; i++)
     {
-      pos[2] = (volumeDataSamplePos.pos.Data[chunkDimension2] - min[chunkDimension2]) * (chunkDimension2 == fullResolutionDimension ? 1 : LODScale);
+      const NDPos &pos = volumeSamplePositions[iBatchStart + i].pos;
+      u[i] = transform.LocalIndex(pos, 0);
+      v[i] = transform.LocalIndex(pos, 1);
+      w[i] = transform.LocalIndex(pos, 2);
     }
 
+    SampleKernels::Sample3D(interpolationMethod, sampleBuffer, u, v, w, count, result);
 
-    typename InterpolatedRealType<T>::type value = volumeSampler.Sample3D(buffer, pos);
-
-    static_cast<float *>(destBuffer)[volumeDataSamplePos.originalSample] = (float)value;
+    for (int i = 0; i < count; i++)
+    {
+      static_cast<float *>(destBuffer)[volumeSamplePositions[iBatchStart + i].originalSample] = result[i];
+    }
   }
 }
 
@@ -1287,7 +1486,14 @@ static bool RequestVolumeSamplesProcessPage(VolumeDataPageImpl *page, VolumeData
     SampleVolumeInit<uint32_t>(page, dataChunk.layer, volumeDataSamplePositions, interpolationMethod, iStartSamplePos, samplePosCount, replacementNoValue, buffer);
     break;
   case VolumeDataChannelDescriptor::Format_R32:
-    SampleVolumeInit<float>(page, dataChunk.layer, volumeDataSamplePositions, interpolationMethod, iStartSamplePos, samplePosCount, replacementNoValue, buffer);
+    if (SampleKernels::IsInterpolationMethodSupported(interpolationMethod))
+    {
+      SampleVolumeBatched(page, dataChunk.layer, volumeDataSamplePositions, interpolationMethod, iStartSamplePos, samplePosCount, replacementNoValue, buffer);
+    }
+    else
+    {
+      SampleVolumeInit<float>(page, dataChunk.layer, volumeDataSamplePositions, interpolationMethod, iStartSamplePos, samplePosCount, replacementNoValue, buffer);
+    }
     break;
   case VolumeDataChannelDescriptor::Format_U64:
     SampleVolumeInit<uint64_t>(page, dataChunk.layer, volumeDataSamplePositions, interpolationMethod, iStartSamplePos, samplePosCount, replacementNoValue, buffer);
@@ -1327,114 +1533,165 @@ int64_t VolumeDataRequestProcessor::RequestVolumeSamples(void *buffer, VolumeDat
     interpolationMethod = InterpolationMethod::Nearest;
   }
 
-  std::vector<VolumeDataChunk> volumeDataChunks;
-  int64_t currentChunkIndex = -1;
+  VolumeDataChunkSet volumeDataChunks(volumeDataLayer);
 
   for (int32_t samplePos = 0; samplePos < int32_t(volumeDataSamplePositions->size()); samplePos++)
   {
-    VolumeDataSamplePos &volumeDataSamplePos = volumeDataSamplePositions->at(samplePos);
-    if (volumeDataSamplePos.chunkIndex != currentChunkIndex)
-    {
-      currentChunkIndex = volumeDataSamplePos.chunkIndex;
-      volumeDataChunks.push_back(volumeDataLayer->GetChunkFromIndex(currentChunkIndex));
-    }
+    volumeDataChunks.Add(volumeDataSamplePositions->at(samplePos).chunkIndex);
   }
 
-  return AddJob(volumeDataChunks, [buffer, volumeDataSamplePositions, interpolationMethod, isReplaceNoValue, replacementNoValue](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error& error)
+  return AddJob(volumeDataChunks.GetChunks(), [buffer, volumeDataSamplePositions, interpolationMethod, isReplaceNoValue, replacementNoValue](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error& error)
     {
       return RequestVolumeSamplesProcessPage(page, dataChunk,  *volumeDataSamplePositions, interpolationMethod, dataChunk.layer->IsUseNoValue(), isReplaceNoValue, isReplaceNoValue ? replacementNoValue : dataChunk.layer->GetNoValue(), buffer, error);
     });
 }
 
-template <typename T, InterpolationMethod INTERPMETHOD, bool isUseNoValue>
-void TraceVolume(VolumeDataPageImpl *page, const VolumeDataChunk &chunk, const std::vector<VolumeDataSamplePos> &volumeDataSamplePositions, int32_t traceDimension, float noValue, void *targetBuffer)
+// The part of the traces that is covered by a page, set up once per page
+struct PageTraceRange
 {
-  int32_t traceSize = chunk.layer->GetDimensionNumSamples(traceDimension);
+  int32_t traceSize;
+  int32_t traceDimensionInChunk;
+  int32_t overlapCount;
+  int32_t offsetSource;
+  int32_t offsetTarget;
+  int32_t traceDimension;
+  int32_t minExcludingMargin[Dimensionality_Max];
+  int32_t maxExcludingMargin[Dimensionality_Max];
 
-  float *traceBuffer = reinterpret_cast<float *>(targetBuffer);
+  PageTraceRange(const VolumeDataChunk &chunk, const PageSampleTransform &transform, int32_t traceDimension)
+    : traceSize(chunk.layer->GetDimensionNumSamples(traceDimension))
+    , traceDimensionInChunk(-1)
+    , traceDimension(traceDimension)
+  {
+    const VolumeDataLayer *volumeDataLayer = chunk.layer;
 
-  const DataBlock & dataBlock = page->GetDataBlock();
+    for (int i = 0; i < 3; i++)
+    {
+      if (transform.chunkDimension[i] == traceDimension)
+      {
+        traceDimensionInChunk = i;
+        break;
+      }
+    }
 
-  const VolumeDataLayer *volumeDataLayer = chunk.layer;
+    int32_t min[Dimensionality_Max];
+    int32_t max[Dimensionality_Max];
 
-  int32_t chunkDimension0 = volumeDataLayer->GetChunkDimension(0);
-  int32_t chunkDimension1 = volumeDataLayer->GetChunkDimension(1);
-  int32_t chunkDimension2 = volumeDataLayer->GetChunkDimension(2);
+    volumeDataLayer->GetChunkMinMax(chunk.index, min, max, true);
+    volumeDataLayer->GetChunkMinMax(chunk.index, minExcludingMargin, maxExcludingMargin, false);
 
-  assert(chunkDimension0 >= 0 && chunkDimension1 >= 0);
+    int32_t fullResolutionDimension = volumeDataLayer->GetLayout()->GetFullResolutionDimension();
 
-  int32_t  traceDimensionInChunk = -1;
+    int32_t traceDimensionLOD = (traceDimension != fullResolutionDimension) ? volumeDataLayer->GetLOD() : 0;
+    overlapCount = GetLODSize(minExcludingMargin[traceDimension], maxExcludingMargin[traceDimension], traceDimensionLOD, maxExcludingMargin[traceDimension] == traceSize);
+    offsetSource = (minExcludingMargin[traceDimension] - min[traceDimension]) >> traceDimensionLOD;
+    offsetTarget = (minExcludingMargin[traceDimension]) >> traceDimensionLOD;
+  }
 
-  if (chunkDimension0 == traceDimension)
-    traceDimensionInChunk = 0;
-  else if (chunkDimension1 == traceDimension)
-    traceDimensionInChunk = 1;
-  else if (chunkDimension2 == traceDimension)
-    traceDimensionInChunk = 2;
+  bool IsInside(const NDPos &pos) const
+  {
+    for (int dim = 0; dim < Dimensionality_Max; dim++)
+    {
+      if (dim != traceDimension &&
+        ((int32_t)pos.Data[dim] < minExcludingMargin[dim] ||
+         (int32_t)pos.Data[dim] >= maxExcludingMargin[dim]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
 
-  int32_t min[Dimensionality_Max];
-  int32_t max[Dimensionality_Max];
-  int32_t minExcludingMargin[Dimensionality_Max];
-  int32_t maxExcludingMargin[Dimensionality_Max];
+  // The local index along the trace so that we sample the center of the voxel
+  float TraceLocalIndex(int32_t overlap) const
+  {
+    return overlap + offsetSource + 0.5f;
+  }
+};
 
-  volumeDataLayer->GetChunkMinMax(chunk.index, min, max, true);
-  volumeDataLayer->GetChunkMinMax(chunk.index, minExcludingMargin, maxExcludingMargin, false);
+template <typename T, InterpolationMethod INTERPMETHOD, bool isUseNoValue>
+void TraceVolume(VolumeDataPageImpl *page, const VolumeDataChunk &chunk, const std::vector<VolumeDataSamplePos> &volumeDataSamplePositions, int32_t traceDimension, float noValue, void *targetBuffer)
+{
+  float *traceBuffer = reinterpret_cast<float *>(targetBuffer);
 
-  int32_t LOD = volumeDataLayer->GetLOD();
+  const DataBlock & dataBlock = page->GetDataBlock();
 
-  float LODScale = 1.0f / (1 << LOD);
+  const VolumeDataLayer *volumeDataLayer = chunk.layer;
 
-  int32_t fullResolutionDimension = volumeDataLayer->GetLayout()->GetFullResolutionDimension();
+  PageSampleTransform transform(volumeDataLayer, chunk.index, 0.5f);
+  PageTraceRange traceRange(chunk, transform, traceDimension);
 
   VolumeSampler<T, INTERPMETHOD, isUseNoValue> volumeSampler(dataBlock.Size, dataBlock.Pitch, volumeDataLayer->GetValueRange().Min, volumeDataLayer->GetValueRange().Max, volumeDataLayer->GetIntegerScale(), volumeDataLayer->GetIntegerOffset(), noValue, noValue);
 
   const T* pBuffer = (const T*) page->GetRawBufferInternal();
 
-  int32_t traceDimensionLOD = (traceDimension != fullResolutionDimension) ? LOD : 0;
-  int32_t overlapCount = GetLODSize(minExcludingMargin[traceDimension], maxExcludingMargin[traceDimension], traceDimensionLOD, maxExcludingMargin[traceDimension] == traceSize);
-  int32_t offsetSource = (minExcludingMargin[traceDimension] - min[traceDimension]) >> traceDimensionLOD;
-  int32_t offsetTarget = (minExcludingMargin[traceDimension]) >> traceDimensionLOD;
-
   int32_t traceCount = int32_t(volumeDataSamplePositions.size());
 
   for (int32_t trace = 0; trace < traceCount; trace++)
   {
     const VolumeDataSamplePos &volumeDataSamplePos = volumeDataSamplePositions[trace];
 
-    bool isInside = true;
+    if (!traceRange.IsInside(volumeDataSamplePos.pos)) continue;
 
-    for (int dim = 0; dim < Dimensionality_Max; dim++)
+    FloatVector3 pos = transform.LocalIndex(volumeDataSamplePos.pos);
+
+    float *target = traceBuffer + traceRange.traceSize * volumeDataSamplePos.originalSample + traceRange.offsetTarget;
+
+    for (int overlap = 0; overlap < traceRange.overlapCount; overlap++)
     {
-      if (dim != traceDimension &&
-        ((int32_t)volumeDataSamplePos.pos.Data[dim] < minExcludingMargin[dim] ||
-         (int32_t)volumeDataSamplePos.pos.Data[dim] >= maxExcludingMargin[dim]))
+      if (traceRange.traceDimensionInChunk != -1)
       {
-        isInside = false;
-        break;
+        pos[traceRange.traceDimensionInChunk] = traceRange.TraceLocalIndex(overlap);
       }
+
+      typename InterpolatedRealType<T>::type value = volumeSampler.Sample3D(pBuffer, pos);
+
+      target[overlap] = (float)value;
     }
+  }
+}
 
-    if (!isInside) continue;
+// Sample float traces with the batched sample kernels, the results are the same as from TraceVolume<float, ...>
+static void TraceVolumeBatched(VolumeDataPageImpl *page, const VolumeDataChunk &chunk, const std::vector<VolumeDataSamplePos> &volumeDataSamplePositions, InterpolationMethod interpolationMethod, int32_t traceDimension, float noValue, void *targetBuffer)
+{
+  float *traceBuffer = reinterpret_cast<float *>(targetBuffer);
 
-    FloatVector3 pos((volumeDataSamplePos.pos.Data[chunkDimension0] - min[chunkDimension0]) * (chunkDimension0 == fullResolutionDimension ? 1 : LODScale),
-      (volumeDataSamplePos.pos.Data[chunkDimension1] - min[chunkDimension1]) * (chunkDimension1 == fullResolutionDimension ? 1 : LODScale),
-      0.5f);
+  PageSampleTransform transform(chunk.layer, chunk.index, 0.5f);
+  PageTraceRange traceRange(chunk, transform, traceDimension);
+  SampleKernels::SampleBuffer sampleBuffer = GetSampleBuffer(page, chunk.layer->IsUseNoValue(), noValue);
 
-    if (chunkDimension2 >= 0)
-    {
-      pos[2] = (volumeDataSamplePos.pos.Data[chunkDimension2] - min[chunkDimension2]) * (chunkDimension2 == fullResolutionDimension ? 1 : LODScale);
-    }
+  float position[3][SAMPLE_BATCH_SIZE];
+
+  int32_t traceCount = int32_t(volumeDataSamplePositions.size());
+
+  for (int32_t trace = 0; trace < traceCount; trace++)
+  {
+    const VolumeDataSamplePos &volumeDataSamplePos = volumeDataSamplePositions[trace];
 
-    for (int overlap = 0; overlap < overlapCount; overlap++)
+    if (!traceRange.IsInside(volumeDataSamplePos.pos)) continue;
+
+    float *target = traceBuffer + traceRange.traceSize * volumeDataSamplePos.originalSample + traceRange.offsetTarget;
+
+    for (int32_t batchStart = 0; batchStart < traceRange.overlapCount; batchStart += SAMPLE_BATCH_SIZE)
     {
-      if (traceDimensionInChunk != -1)
+      int count = std::min(SAMPLE_BATCH_SIZE, int(traceRange.overlapCount - batchStart));
+
+      for (int i = 0; i < 3; i++)
       {
-        pos[traceDimensionInChunk] = overlap + offsetSource + 0.5f; // so that we sample the center of the voxel
+        if (i == traceRange.traceDimensionInChunk)
+        {
+          for (int overlap = 0; overlap < count; overlap++)
+          {
+            position[i][overlap] = traceRange.TraceLocalIndex(batchStart + overlap);
+          }
+        }
+        else
+        {
+          std::fill(position[i], position[i] + count, transform.LocalIndex(volumeDataSamplePos.pos, i));
+        }
       }
 
-      typename InterpolatedRealType<T>::type value = volumeSampler.Sample3D(pBuffer, pos);
-
-      traceBuffer[traceSize * volumeDataSamplePos.originalSample + overlap + offsetTarget] = (float)value;
+      SampleKernels::Sample3D(interpolationMethod, sampleBuffer, position[0], position[1], position[2], count, target + batchStart);
     }
   }
 }
@@ -1508,7 +1765,14 @@ static bool RequestVolumeTracesProcessPage (VolumeDataPageImpl *page, VolumeData
     TraceVolumeInit<uint32_t>(page, dataChunk, volumeDataSamplePositions, interpolationMethod, traceDimension, noValue, buffer);
     break;
   case VolumeDataChannelDescriptor::Format_R32:
-    TraceVolumeInit<float>(page, dataChunk, volumeDataSamplePositions, interpolationMethod, traceDimension, noValue, buffer);
+    if (SampleKernels::IsInterpolationMethodSupported(interpolationMethod))
+    {
+      TraceVolumeBatched(page, dataChunk, volumeDataSamplePositions, interpolationMethod, traceDimension, noValue, buffer);
+    }
+    else
+    {
+      TraceVolumeInit<float>(page, dataChunk, volumeDataSamplePositions, interpolationMethod, traceDimension, noValue, buffer);
+    }
     break;
   case VolumeDataChannelDescriptor::Format_U64:
     TraceVolumeInit<uint64_t>(page, dataChunk, volumeDataSamplePositions, interpolationMethod, traceDimension, noValue, buffer);
@@ -1552,9 +1816,9 @@ int64_t VolumeDataRequestProcessor::RequestVolumeTraces(void *buffer, VolumeData
   }
 
   int64_t currentChunkIndex = -1;
-  int32_t totalChunks = 0;
 
-  std::vector<VolumeDataChunk> volumeDataChunks;
+  // Traces in different chunks along the trace dimension need the same column of chunks, so the chunks are collected in a set
+  VolumeDataChunkSet volumeDataChunks(volumeDataLayer);
   int32_t traceMin[Dimensionality_Max];
   memset(traceMin, 0, sizeof(traceMin));
   int32_t traceMax[Dimensionality_Max];
@@ -1567,9 +1831,6 @@ int64_t VolumeDataRequestProcessor::RequestVolumeTraces(void *buffer, VolumeData
     {
       currentChunkIndex = volumeDataSamplePos.chunkIndex;
 
-      VolumeDataChunk volumeDataChunk(volumeDataLayer->GetChunkFromIndex(currentChunkIndex));
-      volumeDataChunks.push_back(volumeDataChunk);
-
       for (int dim = 0; dim < Dimensionality_Max; dim++)
       {
         traceMin[dim] = (int32_t)volumeDataSamplePos.pos.Data[dim];
@@ -1579,15 +1840,11 @@ int64_t VolumeDataRequestProcessor::RequestVolumeTraces(void *buffer, VolumeData
       traceMin[traceDimension] = 0;
       traceMax[traceDimension] = volumeDataLayer->GetDimensionNumSamples(traceDimension);
 
-      int32_t currentChunksCount = int32_t(volumeDataChunks.size());
-
-      volumeDataLayer->GetChunksInRegion(traceMin, traceMax, &volumeDataChunks, true);
-
-      totalChunks += int32_t(volumeDataChunks.size()) - currentChunksCount;
+      volumeDataChunks.AddRegion(traceMin, traceMax);
     }
   }
 
-  return AddJob(volumeDataChunks, [buffer, volumeDataSamplePositions, interpolationMethod, traceDimension, replacementNoValue](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error& error)
+  return AddJob(volumeDataChunks.GetChunks(), [buffer, volumeDataSamplePositions, interpolationMethod, traceDimension, replacementNoValue](VolumeDataPageImpl* page, VolumeDataChunk dataChunk, Error& error)
     {
       return RequestVolumeTracesProcessPage(page, dataChunk,  *volumeDataSamplePositions, interpolationMethod, traceDimension, replacementNoValue, buffer, error);
     });
@@ -1597,7 +1854,7 @@ int64_t VolumeDataRequestProcessor::PrefetchVolumeChunk(VolumeDataLayer const *v
 {
   std::vector<VolumeDataChunk> chunks;
   chunks.push_back(volumeDataLayer->GetChunkFromIndex(chunkIndex));
-  return AddJob(chunks, [](VolumeDataPageImpl *page, VolumeDataChunk dataChunk, Error &error) {return true;});
+  return AddJob(chunks, [](VolumeDataPageImpl *page, VolumeDataChunk dataChunk, Error &error) {return true;}, false, ThreadPool::Priority_Low);
 }
 
 int64_t VolumeDataRequestProcessor::StaticGetVolumeSubsetBufferSize(VolumeDataLayout const *volumeDataLayout, const int (&minVoxelCoordinates)[Dimensionality_Max], const int (&maxVoxelCoordinates)[Dimensionality_Max], VolumeDataChannelDescriptor::Format format, int LOD, int channel)
@@ -1765,11 +2022,13 @@ struct MarkJobAsDoneOnExit
     }
     if (++job->pagesProcessed == job->pagesCount)
     {
-      std::unique_lock<std::mutex> lock(job->pageAccessorNotifier.mutex);
-      job->pageAccessor.SetLastUsed(std::chrono::steady_clock::now());
-      job->pageAccessor.RemoveReference();
-      job->done = true;
-      job->pageAccessorNotifier.setDirtyNoLock();
+      {
+        std::unique_lock<std::mutex> lock(job->pageAccessorNotifier.mutex);
+        job->pageAccessor.SetLastUsed(std::chrono::steady_clock::now());
+        job->pageAccessor.RemoveReference();
+        job->pageAccessorNotifier.setDirtyNoLock();
+      }
+      job->SetDone();
     }
   }
   Job *job;
@@ -1812,6 +2071,7 @@ static Error ProcessPageInJob(Job *job, int pageIndex, VolumeDataPageAccessorImp
 static void SetErrorForJob(Job* job)
 {
   assert(job->cancelled);
+  std::unique_lock<std::mutex> lock(job->completionMutex);
   for (auto& future : job->future)
   {
     if (!future.valid())
@@ -1826,21 +2086,18 @@ static void SetErrorForJob(Job* job)
   }
 }
 
-int64_t VolumeDataRequestProcessor::AddJob(const std::vector<VolumeDataChunk>& chunks, std::function<bool(VolumeDataPageImpl * page, const VolumeDataChunk &volumeDataChunk, Error & error)> processor, bool singleThread)
+VolumeDataPageAccessorImpl *VolumeDataRequestProcessor::AcquirePageAccessor(VolumeDataLayer const *layer, int maxPages)
 {
-  auto layer = chunks.front().layer;
   DimensionsND dimensions = DimensionGroupUtil::GetDimensionsNDFromDimensionGroup(layer->GetPrimaryChannelLayer().GetChunkDimensionGroup());
   int channel = layer->GetChannelIndex();
   int lod = layer->GetLOD();
 
-  const int maxPages = std::max(8, (int)chunks.size());
-
   std::unique_lock<std::mutex> lock(m_mutex);
   PageAccessorKey key = { dimensions, lod, channel };
   auto page_accessor_it = m_pageAccessors.find(key);
   if (page_accessor_it == m_pageAccessors.end())
   {
-    auto pa = static_cast<VolumeDataPageAccessorImpl *>(m_manager.CreateVolumeDataPageAccessor(dimensions, lod, channel, maxPages, VolumeDataAccessManager::AccessMode_ReadOnly));
+    auto pa = m_manager.CreateVolumeDataPageAccessorWithLODProduction(dimensions, lod, channel, maxPages);
     pa->RemoveReference();
     auto insert_result = m_pageAccessors.emplace(key, pa);
     assert(insert_result.second);
@@ -1856,9 +2113,19 @@ int64_t VolumeDataRequestProcessor::AddJob(const std::vector<VolumeDataChunk>& c
   }
 
   pageAccessor->AddReference();
+  return pageAccessor;
+}
 
-  m_jobs.emplace_back(new Job(GenJobId(), m_pageAccessorNotifier, *pageAccessor, int(chunks.size())));
-  auto &job = m_jobs.back();
+int64_t VolumeDataRequestProcessor::AddJob(const std::vector<VolumeDataChunk>& chunks, std::function<bool(VolumeDataPageImpl * page, const VolumeDataChunk &volumeDataChunk, Error & error)> processor, bool singleThread, ThreadPool::Priority priority)
+{
+  if (priority == ThreadPool::Priority_Normal && int(chunks.size()) <= MAX_INTERACTIVE_JOB_CHUNKS)
+  {
+    priority = ThreadPool::Priority_High;
+  }
+
+  VolumeDataPageAccessorImpl *pageAccessor = AcquirePageAccessor(chunks.front().layer, std::max(8, (int)chunks.size()));
+
+  std::shared_ptr<Job> job = std::make_shared<Job>(GenJobId(), m_pageAccessorNotifier, *pageAccessor, int(chunks.size()));
 
   job->pages.reserve(chunks.size());
   job->future.reserve(chunks.size());
@@ -1885,12 +2152,18 @@ int64_t VolumeDataRequestProcessor::AddJob(const std::vector<VolumeDataChunk>& c
     }
     job->pagesProcessed = job->pagesCount;
     job->done = true;
+    m_jobs.Insert(job);
     return job->jobId;
   }
 
+  // The job is published before its pages are enqueued so it can be polled and
+  // cancelled while work is still being scheduled. The tasks keep their own
+  // reference, so the job outlives its removal from the job table.
+  m_jobs.Insert(job);
+
   if (singleThread)
   {
-    auto job_ptr = job.get();
+    std::shared_ptr<Job> job_ptr = job;
     job->future.push_back(m_threadPool.Enqueue([job_ptr, pageAccessor, processor]
     {
       Error error;
@@ -1899,7 +2172,7 @@ int64_t VolumeDataRequestProcessor::AddJob(const std::vector<VolumeDataChunk>& c
       {
         if (error.code == 0)
         {
-          error = ProcessPageInJob(job_ptr, i, pageAccessor, processor);
+          error = ProcessPageInJob(job_ptr.get(), i, pageAccessor, processor);
           if (error.code)
           {
             job_ptr->cancelled = true;
@@ -1915,55 +2188,243 @@ int64_t VolumeDataRequestProcessor::AddJob(const std::vector<VolumeDataChunk>& c
         }
       }
       return error;
-    }));
+    }, priority));
   } 
   else
   {
-    auto job_ptr = job.get();
+    std::shared_ptr<Job> job_ptr = job;
     for (int i = 0; i < int(job->pages.size()); i++)
     {
       job->future.push_back(m_threadPool.Enqueue([job_ptr, i, pageAccessor, processor]
         {
-          return ProcessPageInJob(job_ptr, i, pageAccessor, processor);
-        }));
+          return ProcessPageInJob(job_ptr.get(), i, pageAccessor, processor);
+        }, priority));
+    }
+  }
+  return job->jobId;
+}
+
+int64_t VolumeDataRequestProcessor::AddDirectJob(VolumeDataPageAccessorImpl *pageAccessor, const VolumeDataChunk &chunk, std::function<bool(Error &error)> reader)
+{
+  std::shared_ptr<Job> job = std::make_shared<Job>(GenJobId(), m_pageAccessorNotifier, *pageAccessor, 1);
+
+  // The job has a single chunk without a page, it is marked as done in the same way as a job with pages
+  job->pages.emplace_back(nullptr, chunk);
+  m_jobs.Insert(job);
+
+  std::shared_ptr<Job> job_ptr = job;
+  job->future.push_back(m_threadPool.Enqueue([job_ptr, reader]
+    {
+      MarkJobAsDoneOnExit jobDone(job_ptr.get(), 0);
+      Error error;
+      if (!job_ptr->cancelled && !reader(error))
+      {
+        job_ptr->cancelled = true;
+      }
+      return error;
+    }, ThreadPool::Priority_High));
+  return job->jobId;
+}
+
+// The state shared by the tasks of a progressive subset request, the serialized data of each chunk is kept from the
+// coarse pass so the refinement pass only has to read the rest of the chunk
+struct ProgressiveSubsetState
+{
+  explicit ProgressiveSubsetState(int chunkCount)
+    : serializedData(chunkCount)
+    , metadata(chunkCount)
+    , compressionMethod(chunkCount, CompressionMethod::None)
+    , errors(chunkCount)
+    , results(chunkCount)
+    , coarseChunksDone(0)
+    , refinedChunksDone(0)
+  {}
+
+  std::vector<std::vector<uint8_t>> serializedData;
+  std::vector<std::vector<uint8_t>> metadata;
+  std::vector<CompressionMethod> compressionMethod;
+  std::vector<Error> errors;
+  std::vector<std::promise<Error>> results;
+  std::atomic_int coarseChunksDone;
+  std::atomic_int refinedChunksDone;
+  std::mutex copyMutex;
+};
+
+static bool ProgressiveSubsetCopyChunk(VolumeDataStore *volumeDataStore, ProgressiveSubsetState &state, int chunkIndex, const VolumeDataChunk &chunk, int32_t adaptiveLevel, const Box &box, VolumeDataChannelDescriptor::Format format, const ConversionParameters &conversionParameters, void *buffer, Error &error)
+{
+  DataBlock dataBlock;
+  std::vector<uint8_t> chunkData;
+
+  if (!volumeDataStore->DeserializeVolumeData(chunk, state.serializedData[chunkIndex], state.metadata[chunkIndex], state.compressionMethod[chunkIndex], adaptiveLevel, chunk.layer->GetFormat(), dataBlock, chunkData, error))
+  {
+    return false;
+  }
+
+  // Chunks share bytes of a 1-bit buffer, so they have to be copied one at a time
+  std::unique_lock<std::mutex> lock(state.copyMutex, std::defer_lock);
+  if (format == VolumeDataChannelDescriptor::Format_1Bit)
+  {
+    lock.lock();
+  }
+
+  RequestSubsetProcessChunk(chunk, dataBlock, chunkData.data(), box.min, box.max, format, conversionParameters, buffer);
+  return true;
+}
+
+int64_t VolumeDataRequestProcessor::RequestVolumeSubsetProgressive(void *buffer, VolumeDataLayer const *volumeDataLayer, const int32_t(&minRequested)[Dimensionality_Max], const int32_t (&maxRequested)[Dimensionality_Max], int32_t LOD, VolumeDataChannelDescriptor::Format format, bool isReplaceNoValue, float replacementNoValue, int32_t coarseAdaptiveLevel, std::function<void(int32_t adaptiveLevel)> refinementCallback)
+{
+  Box boxRequested;
+  memcpy(boxRequested.min, minRequested, sizeof(boxRequested.min));
+  memcpy(boxRequested.max, maxRequested, sizeof(boxRequested.max));
+
+  // Initialized unused dimensions
+  for (int32_t dimension = volumeDataLayer->GetLayout()->GetDimensionality(); dimension < Dimensionality_Max; dimension++)
+  {
+    boxRequested.min[dimension] = 0;
+    boxRequested.max[dimension] = 1;
+  }
+
+  VolumeDataChunkSet chunksInRegion(volumeDataLayer);
+
+  chunksInRegion.AddRegion(boxRequested.min, boxRequested.max);
+
+  if (chunksInRegion.IsEmpty())
+  {
+    throw std::runtime_error("Requested volume subset does not contain any data");
+  }
+
+  // The chunks are read straight from the volume data store, the page accessor is only used to keep track of the job
+  VolumeDataPageAccessorImpl *pageAccessor = AcquirePageAccessor(volumeDataLayer, 8);
+
+  if (!pageAccessor->CanReadChunkIntoBuffer())
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    pageAccessor->RemoveReference();
+    throw std::runtime_error("Progressive volume subset requests can only read layers that are stored");
+  }
+
+  int32_t finalAdaptiveLevel = volumeDataLayer->GetEffectiveWaveletAdaptiveLoadLevel();
+
+  if (!CompressionMethod_IsWavelet(volumeDataLayer->GetEffectiveCompressionMethod()) || coarseAdaptiveLevel <= finalAdaptiveLevel)
+  {
+    coarseAdaptiveLevel = finalAdaptiveLevel;
+  }
+  coarseAdaptiveLevel = std::min(coarseAdaptiveLevel, int32_t(WAVELET_ADAPTIVE_LEVELS - 1));
+
+  const std::vector<VolumeDataChunk> &chunks = chunksInRegion.GetChunks();
+  int chunkCount = int(chunks.size());
+
+  std::shared_ptr<Job> job = std::make_shared<Job>(GenJobId(), m_pageAccessorNotifier, *pageAccessor, chunkCount);
+  std::shared_ptr<ProgressiveSubsetState> state = std::make_shared<ProgressiveSubsetState>(chunkCount);
+
+  // The chunks have no pages, each chunk is marked as done in the same way as a page when its last pass is done
+  job->pages.reserve(chunkCount);
+  job->future.reserve(chunkCount);
+  for (int i = 0; i < chunkCount; i++)
+  {
+    job->pages.emplace_back(nullptr, chunks[i]);
+    job->future.push_back(state->results[i].get_future());
+  }
+  m_jobs.Insert(job);
+
+  VolumeDataStore *volumeDataStore = m_manager.GetVolumeDataStore();
+  ConversionParameters conversionParameters = makeConversionParameters(volumeDataLayer, isReplaceNoValue, replacementNoValue);
+  ThreadPool::Priority priority = chunkCount <= MAX_INTERACTIVE_JOB_CHUNKS ? ThreadPool::Priority_High : ThreadPool::Priority_Normal;
+  ThreadPool *threadPool = &m_threadPool;
+  std::shared_ptr<Job> job_ptr = job;
+
+  auto refineChunk = [job_ptr, state, volumeDataStore, boxRequested, buffer, format, conversionParameters, coarseAdaptiveLevel, finalAdaptiveLevel, refinementCallback, chunkCount](int i)
+  {
+    Error error = state->errors[i];
+    MarkJobAsDoneOnExit jobDone(job_ptr.get(), i);
+    const VolumeDataChunk &chunk = job_ptr->pages[i].chunk;
+
+    if (!error.code && !job_ptr->cancelled && coarseAdaptiveLevel != finalAdaptiveLevel && !state->serializedData[i].empty())
+    {
+      if (!volumeDataStore->ReadChunkRefinement(chunk, finalAdaptiveLevel, state->serializedData[i], state->metadata[i], error) ||
+          !ProgressiveSubsetCopyChunk(volumeDataStore, *state, i, chunk, finalAdaptiveLevel, boxRequested, format, conversionParameters, buffer, error))
+      {
+        job_ptr->cancelled = true;
+      }
     }
+    std::vector<uint8_t>().swap(state->serializedData[i]);
+
+    if (++state->refinedChunksDone == chunkCount && !job_ptr->cancelled && refinementCallback)
+    {
+      refinementCallback(finalAdaptiveLevel);
+    }
+    state->results[i].set_value(error);
+  };
+
+  for (int i = 0; i < chunkCount; i++)
+  {
+    m_threadPool.Enqueue([job_ptr, state, i, volumeDataStore, boxRequested, buffer, format, conversionParameters, coarseAdaptiveLevel, finalAdaptiveLevel, refinementCallback, chunkCount, threadPool, priority, refineChunk]
+      {
+        const VolumeDataChunk &chunk = job_ptr->pages[i].chunk;
+        Error error;
+        CompressionInfo compressionInfo;
+
+        if (!job_ptr->cancelled)
+        {
+          if (!volumeDataStore->PrepareReadChunk(chunk, coarseAdaptiveLevel, error) ||
+              !volumeDataStore->ReadChunk(chunk, coarseAdaptiveLevel, state->serializedData[i], state->metadata[i], compressionInfo, error))
+          {
+            job_ptr->cancelled = true;
+          }
+          else
+          {
+            state->compressionMethod[i] = compressionInfo.GetCompressionMethod();
+            if (!ProgressiveSubsetCopyChunk(volumeDataStore, *state, i, chunk, coarseAdaptiveLevel, boxRequested, format, conversionParameters, buffer, error))
+            {
+              job_ptr->cancelled = true;
+            }
+          }
+        }
+        state->errors[i] = error;
+
+        // The last chunk of the coarse pass starts the refinement pass
+        if (++state->coarseChunksDone == chunkCount)
+        {
+          if (!job_ptr->cancelled && coarseAdaptiveLevel != finalAdaptiveLevel && refinementCallback)
+          {
+            refinementCallback(coarseAdaptiveLevel);
+          }
+          for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+          {
+            threadPool->Enqueue([refineChunk, chunkIndex] { refineChunk(chunkIndex); }, priority);
+          }
+        }
+      }, priority);
   }
   return job->jobId;
 }
 
 bool  VolumeDataRequestProcessor::IsActive(int64_t jobID)
 {
-  std::unique_lock<std::mutex> lock(m_mutex);
-  auto job_it = std::find_if(m_jobs.begin(), m_jobs.end(), [jobID](const std::unique_ptr<Job> &job) { return job->jobId == jobID; });
-  return job_it != m_jobs.end();
+  return m_jobs.Find(jobID) != nullptr;
 }
 
 bool  VolumeDataRequestProcessor::IsCompleted(int64_t jobID)
 {
-  std::unique_lock<std::mutex> lock(m_mutex);
   m_manager.SetCurrentDownloadError(Error());
-  auto job_it = std::find_if(m_jobs.begin(), m_jobs.end(), [jobID](const std::unique_ptr<Job> &job) { return job->jobId == jobID; });
-  if (job_it == m_jobs.end())
+  std::shared_ptr<Job> job = m_jobs.Find(jobID);
+  if (!job)
     return false;
 
-  auto job = job_it->get();
   if (job->done && !job->cancelled)
   {
-    m_jobs.erase(job_it);
-    return true;
+    return m_jobs.Erase(jobID);
   }
   return false;
 }
 
 bool VolumeDataRequestProcessor::IsCanceled(int64_t jobID)
 {
-  std::unique_lock<std::mutex> lock(m_mutex);
   m_manager.SetCurrentDownloadError(Error());
-  auto job_it = std::find_if(m_jobs.begin(), m_jobs.end(), [jobID](const std::unique_ptr<Job> &job) { return job->jobId == jobID; });
-  if (job_it == m_jobs.end())
+  std::shared_ptr<Job> job = m_jobs.Find(jobID);
+  if (!job)
     return false;
 
-  auto job = job_it->get();
   if (job->done && job->cancelled)
   {
     static bool should_print = getBooleanEnvironmentVariable("OPENVDS_DEBUG_IS_CANCELLED");
@@ -1980,9 +2441,10 @@ bool VolumeDataRequestProcessor::IsCanceled(int64_t jobID)
       }
       fmt::print(stderr, "{}", out);
     }
-    SetErrorForJob(job);
+    if (!m_jobs.Erase(jobID))
+      return false;
+    SetErrorForJob(job.get());
     m_manager.SetCurrentDownloadError(job->completedError);
-    m_jobs.erase(job_it);
     return true;
   }
   return false;
@@ -1990,40 +2452,22 @@ bool VolumeDataRequestProcessor::IsCanceled(int64_t jobID)
   
 bool VolumeDataRequestProcessor::WaitForCompletion(int64_t jobID, int millisecondsBeforeTimeout)
 {
-  std::unique_lock<std::mutex> lock(m_mutex);
   m_manager.SetCurrentDownloadError(Error());
-  auto job_it = std::find_if(m_jobs.begin(), m_jobs.end(), [jobID](const std::unique_ptr<Job> &job) { return job->jobId == jobID; });
-  if (job_it == m_jobs.end())
+  std::shared_ptr<Job> job = m_jobs.Find(jobID);
+  if (!job)
     return false;
 
-  Job *job = job_it->get();
   if (!job->done)
   {
-    if (millisecondsBeforeTimeout > 0)
-    {
-      std::chrono::milliseconds toWait(millisecondsBeforeTimeout);
-      job->pageAccessorNotifier.jobNotification.wait_for(lock, toWait, [job]
-        {
-          return job->done.load();
-        });
-    }
-    else
-    {
-      job->pageAccessorNotifier.jobNotification.wait(lock, [job]
-        {
-          return job->done.load();
-        });
-    }
+    job->WaitForDone(millisecondsBeforeTimeout);
   }
   if (job->done && !job->cancelled)
   {
-    job_it = std::find_if(m_jobs.begin(), m_jobs.end(), [job](const std::unique_ptr<Job>& jobin) { return job == jobin.get(); });
-    m_jobs.erase(job_it);
-    return true;
+    return m_jobs.Erase(jobID);
   }
-  if (job->cancelled)
+  if (job->done && job->cancelled)
   {
-    SetErrorForJob(job);
+    SetErrorForJob(job.get());
     m_manager.SetCurrentDownloadError(job->completedError);
   }
   return false;
@@ -2031,23 +2475,31 @@ bool VolumeDataRequestProcessor::WaitForCompletion(int64_t jobID, int millisecon
 
 void VolumeDataRequestProcessor::Cancel(int64_t jobID)
 {
-  std::unique_lock<std::mutex> lock(m_mutex);
   m_manager.SetCurrentDownloadError(Error());
-  auto job_it = std::find_if(m_jobs.begin(), m_jobs.end(), [jobID](std::unique_ptr<Job> &job) { return job->jobId == jobID; });
-  if (job_it == m_jobs.end())
+  std::shared_ptr<Job> job = m_jobs.Find(jobID);
+  if (!job)
     return;
-  job_it->get()->cancelled = true;
-  m_pageAccessorNotifier.setDirtyNoLock();
+  job->cancelled = true;
+  m_pageAccessorNotifier.setDirty();
 }
 
 float VolumeDataRequestProcessor::GetCompletionFactor(int64_t jobID)
 {
-  std::unique_lock<std::mutex> lock(m_mutex);
   m_manager.SetCurrentDownloadError(Error());
-  auto job_it = std::find_if(m_jobs.begin(), m_jobs.end(), [jobID](std::unique_ptr<Job> &job) { return job->jobId == jobID; });
-  if (job_it == m_jobs.end())
+  std::shared_ptr<Job> job = m_jobs.Find(jobID);
+  if (!job)
     return 0.f;
-  return float(job_it->get()->pagesProcessed) / float(job_it->get()->pagesCount);
+  return float(job->pagesProcessed) / float(job->pagesCount);
+}
+
+int64_t VolumeDataRequestProcessor::GetQueueDepth() const
+{
+  return m_threadPool.GetQueueDepth();
+}
+
+int64_t VolumeDataRequestProcessor::GetStealCount() const
+{
+  return m_threadPool.GetStealCount();
 }
 
 int VolumeDataRequestProcessor::CountActivePages()
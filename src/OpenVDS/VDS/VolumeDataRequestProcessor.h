@@ -27,8 +27,10 @@
 #include "ThreadPool.h"
 
 #include <stdint.h>
+#include <chrono>
 #include <map>
 #include <functional>
+#include <unordered_map>
 #include <vector>
 
 namespace OpenVDS
@@ -112,6 +114,68 @@ struct Job
   std::atomic_bool cancelled;
   int pagesCount;
   Error completedError;
+
+  void SetDone()
+  {
+    std::unique_lock<std::mutex> lock(completionMutex);
+    done = true;
+    completionNotification.notify_all();
+  }
+
+  bool WaitForDone(int millisecondsBeforeTimeout)
+  {
+    std::unique_lock<std::mutex> lock(completionMutex);
+    if (millisecondsBeforeTimeout > 0)
+      return completionNotification.wait_for(lock, std::chrono::milliseconds(millisecondsBeforeTimeout), [this] { return done.load(); });
+    completionNotification.wait(lock, [this] { return done.load(); });
+    return true;
+  }
+
+  std::mutex completionMutex;
+  std::condition_variable completionNotification;
+};
+
+// Jobs are spread over a fixed number of shards by job id, each with its own lock,
+// so polling one request does not contend with requests in other shards.
+class JobTable
+{
+public:
+  void Insert(const std::shared_ptr<Job> &job)
+  {
+    Shard &shard = GetShard(job->jobId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    shard.jobs.emplace(job->jobId, job);
+  }
+
+  std::shared_ptr<Job> Find(int64_t jobId)
+  {
+    Shard &shard = GetShard(jobId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    auto it = shard.jobs.find(jobId);
+    if (it == shard.jobs.end())
+      return nullptr;
+    return it->second;
+  }
+
+  bool Erase(int64_t jobId)
+  {
+    Shard &shard = GetShard(jobId);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    return shard.jobs.erase(jobId) > 0;
+  }
+
+private:
+  enum { ShardCount = 64 };
+
+  struct Shard
+  {
+    std::mutex mutex;
+    std::unordered_map<int64_t, std::shared_ptr<Job>> jobs;
+  };
+
+  Shard &GetShard(int64_t jobId) { return m_shards[uint64_t(jobId) % ShardCount]; }
+
+  Shard m_shards[ShardCount];
 };
 
 class VolumeDataRequestProcessor
@@ -120,7 +184,8 @@ public:
   VolumeDataRequestProcessor(VolumeDataAccessManagerImpl &manager);
   ~VolumeDataRequestProcessor();
 
-  int64_t AddJob(const std::vector<VolumeDataChunk> &chunks, std::function<bool(VolumeDataPageImpl *page, const VolumeDataChunk &volumeDataChunk, Error &error)> processor, bool singleThread = false);
+  // Normal priority jobs with few chunks are promoted to high priority so interactive requests are not queued behind bulk requests
+  int64_t AddJob(const std::vector<VolumeDataChunk> &chunks, std::function<bool(VolumeDataPageImpl *page, const VolumeDataChunk &volumeDataChunk, Error &error)> processor, bool singleThread = false, ThreadPool::Priority priority = ThreadPool::Priority_Normal);
   bool  IsActive(int64_t requestID);
   bool  IsCompleted(int64_t requestID);
   bool  IsCanceled(int64_t requestID);
@@ -129,8 +194,12 @@ public:
   float GetCompletionFactor(int64_t requestID);
 
   int CountActivePages();
+  int64_t GetQueueDepth() const;
+  int64_t GetStealCount() const;
 
   int64_t RequestVolumeSubset(void *buffer, VolumeDataLayer const *volumeDataLayer, const int32_t(&minRequested)[Dimensionality_Max], const int32_t (&maxRequested)[Dimensionality_Max], int32_t LOD, VolumeDataChannelDescriptor::Format format, bool isReplaceNoValue, float replacementNoValue);
+  // Read every chunk of the subset at the coarse adaptive level first, then read the rest of each chunk and fill the buffer again at the adaptive level of the layer
+  int64_t RequestVolumeSubsetProgressive(void *buffer, VolumeDataLayer const *volumeDataLayer, const int32_t(&minRequested)[Dimensionality_Max], const int32_t (&maxRequested)[Dimensionality_Max], int32_t LOD, VolumeDataChannelDescriptor::Format format, bool isReplaceNoValue, float replacementNoValue, int32_t coarseAdaptiveLevel, std::function<void(int32_t adaptiveLevel)> refinementCallback);
   int64_t RequestProjectedVolumeSubset(void *buffer, VolumeDataLayer const *volumeDataLayer, const int32_t (&minRequested)[Dimensionality_Max], const int32_t (&maxRequested)[Dimensionality_Max], FloatVector4 const &voxelPlane, DimensionGroup projectedDimensions, int32_t LOD, VolumeDataChannelDescriptor::Format format, InterpolationMethod interpolationMethod, bool isReplaceNoValue, float replacementNoValue);
   int64_t RequestVolumeSamples(void *buffer, VolumeDataLayer const *volumeDataLayer, const float(*samplePositions)[Dimensionality_Max], int32_t samplePosCount, InterpolationMethod interpolationMethod, bool isReplaceNoValue, float replacementNoValue);
   int64_t RequestVolumeTraces(void *buffer, VolumeDataLayer const *volumeDataLayer, const float(*tracePositions)[Dimensionality_Max], int32_t tracePositionsCount, int32_t LOD, InterpolationMethod interpolationMethod, int32_t traceDimension, bool isReplaceNoValue, float replacementNoValue);
@@ -141,9 +210,15 @@ public:
   static int64_t StaticGetVolumeSamplesBufferSize(VolumeDataLayout const *volumeDataLayout, int sampleCount, int channel);
   static int64_t StaticGetVolumeTracesBufferSize(VolumeDataLayout const *volumeDataLayout, int traceCount, int traceDimension, int LOD, int channel);
 private:
+  // Get the page accessor for the layer with room for at least maxPages, the caller has to remove the reference that is added
+  VolumeDataPageAccessorImpl *AcquirePageAccessor(VolumeDataLayer const *layer, int maxPages);
+
+  // A job for a single chunk that is read without a page
+  int64_t AddDirectJob(VolumeDataPageAccessorImpl *pageAccessor, const VolumeDataChunk &chunk, std::function<bool(Error &error)> reader);
+
   VolumeDataAccessManagerImpl &m_manager;
   std::map<PageAccessorKey, VolumeDataPageAccessorImpl *> m_pageAccessors;
-  std::vector<std::unique_ptr<Job>> m_jobs;
+  JobTable m_jobs;
   std::mutex m_mutex;
   ThreadPool m_threadPool;
   PageAccessorNotifier m_pageAccessorNotifier;
@@ -0,0 +1,673 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include "VolumeDataSampleKernels.h"
+
+#include <OpenVDS/VolumeSampler.h>
+
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ENABLE_SSE_SAMPLE 1
+#endif
+
+#ifdef ENABLE_SSE_SAMPLE
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SAMPLE_TARGET_SSE41
+#define SAMPLE_TARGET_AVX2
+#else
+// The AVX2 kernels are compiled for their own target and selected at runtime
+#define SAMPLE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SAMPLE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// The kernels evaluate the same floating point operations in the same order as VolumeSampler::Sample3D, so the results
+// are identical to the scalar sampler. No-value samples are masked out with blends rather than by adding zero, this
+// keeps the sign of zero sums the same as in the scalar code.
+
+namespace OpenVDS
+{
+namespace SampleKernels
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// Scalar
+
+template<InterpolationMethod INTERPMETHOD, bool isUseNoValue>
+static void SampleScalar(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  int size[VolumeSampler<float, INTERPMETHOD, isUseNoValue>::DataBlockDimensionality_Max] = { buffer.size[0], buffer.size[1], buffer.size[2], 1 };
+  int pitch[VolumeSampler<float, INTERPMETHOD, isUseNoValue>::DataBlockDimensionality_Max] = { buffer.pitch[0], buffer.pitch[1], buffer.pitch[2], 0 };
+
+  VolumeSampler<float, INTERPMETHOD, isUseNoValue> volumeSampler(size, pitch, 0.0f, 0.0f, 1.0f, 0.0f, buffer.noValue, buffer.replacementNoValue);
+
+  for (int i = 0; i < count; i++)
+  {
+    result[i] = volumeSampler.Sample3D(buffer.data, FloatVector3(u[i], v[i], w[i]));
+  }
+}
+
+#ifdef ENABLE_SSE_SAMPLE
+
+/////////////////////////////////////////////////////////////////////////////
+// SSE4.1, four positions per iteration
+
+struct SetupSSE41
+{
+  __m128i maxIndex[3];
+  __m128i pitchY;
+  __m128i pitchZ;
+  __m128  noValue;
+  __m128  replacementNoValue;
+};
+
+SAMPLE_TARGET_SSE41 static inline SetupSSE41
+InitSSE41(const SampleBuffer &buffer)
+{
+  SetupSSE41 setup;
+  for (int dimension = 0; dimension < 3; dimension++)
+  {
+    setup.maxIndex[dimension] = _mm_set1_epi32(buffer.size[dimension] - 1);
+  }
+  setup.pitchY = _mm_set1_epi32(buffer.pitch[1]);
+  setup.pitchZ = _mm_set1_epi32(buffer.pitch[2]);
+  setup.noValue = _mm_set1_ps(buffer.noValue);
+  setup.replacementNoValue = _mm_set1_ps(buffer.replacementNoValue);
+  return setup;
+}
+
+SAMPLE_TARGET_SSE41 static inline __m128i
+ClampSSE41(__m128i index, __m128i maxIndex)
+{
+  return _mm_min_epi32(_mm_max_epi32(index, _mm_setzero_si128()), maxIndex);
+}
+
+SAMPLE_TARGET_SSE41 static inline __m128
+GatherSSE41(const float *data, __m128i index)
+{
+  return _mm_setr_ps(data[_mm_extract_epi32(index, 0)], data[_mm_extract_epi32(index, 1)], data[_mm_extract_epi32(index, 2)], data[_mm_extract_epi32(index, 3)]);
+}
+
+SAMPLE_TARGET_SSE41 static inline __m128
+SampleNearestValueSSE41(const SetupSSE41 &setup, const float *data, __m128 u, __m128 v, __m128 w)
+{
+  __m128i nearestU = ClampSSE41(_mm_cvttps_epi32(_mm_floor_ps(u)), setup.maxIndex[0]),
+          nearestV = ClampSSE41(_mm_cvttps_epi32(_mm_floor_ps(v)), setup.maxIndex[1]),
+          nearestW = ClampSSE41(_mm_cvttps_epi32(_mm_floor_ps(w)), setup.maxIndex[2]);
+
+  return GatherSSE41(data, _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(nearestW, setup.pitchZ), _mm_mullo_epi32(nearestV, setup.pitchY)), nearestU));
+}
+
+// The index of the first of the neighbour samples and the fractional position relative to its center
+SAMPLE_TARGET_SSE41 static inline __m128i
+SplitPositionSSE41(__m128 position, __m128 &fraction)
+{
+  const __m128 half = _mm_set1_ps(0.5f);
+  __m128 first = _mm_floor_ps(_mm_sub_ps(position, half));
+  fraction = _mm_sub_ps(_mm_sub_ps(position, first), half);
+  return _mm_cvttps_epi32(first);
+}
+
+SAMPLE_TARGET_SSE41 static inline __m128
+ReplaceNoValueSSE41(const SetupSSE41 &setup, __m128 value, __m128 nearest)
+{
+  return _mm_blendv_ps(value, setup.replacementNoValue, _mm_cmpeq_ps(nearest, setup.noValue));
+}
+
+template<bool isUseNoValue>
+SAMPLE_TARGET_SSE41 static int
+SampleNearestSSE41(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  const SetupSSE41 setup = InitSSE41(buffer);
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 nearest = SampleNearestValueSSE41(setup, buffer.data, _mm_loadu_ps(u + i), _mm_loadu_ps(v + i), _mm_loadu_ps(w + i));
+    if (isUseNoValue) nearest = ReplaceNoValueSSE41(setup, nearest, nearest);
+    _mm_storeu_ps(result + i, nearest);
+  }
+  return i;
+}
+
+template<bool isUseNoValue>
+SAMPLE_TARGET_SSE41 static int
+SampleLinearSSE41(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  const SetupSSE41 setup = InitSSE41(buffer);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128i oneIndex = _mm_set1_epi32(1);
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 positionU = _mm_loadu_ps(u + i),
+           positionV = _mm_loadu_ps(v + i),
+           positionW = _mm_loadu_ps(w + i);
+
+    __m128 nearest = SampleNearestValueSSE41(setup, buffer.data, positionU, positionV, positionW);
+
+    __m128 fractionU, fractionV, fractionW;
+    __m128i firstU = SplitPositionSSE41(positionU, fractionU),
+            firstV = SplitPositionSSE41(positionV, fractionV),
+            firstW = SplitPositionSSE41(positionW, fractionW);
+
+    __m128 weightU[2] = { _mm_sub_ps(one, fractionU), fractionU },
+           weightV[2] = { _mm_sub_ps(one, fractionV), fractionV },
+           weightW[2] = { _mm_sub_ps(one, fractionW), fractionW };
+
+    __m128i indexU[2] = { ClampSSE41(firstU, setup.maxIndex[0]), ClampSSE41(_mm_add_epi32(firstU, oneIndex), setup.maxIndex[0]) },
+            offsetV[2] = { _mm_mullo_epi32(ClampSSE41(firstV, setup.maxIndex[1]), setup.pitchY), _mm_mullo_epi32(ClampSSE41(_mm_add_epi32(firstV, oneIndex), setup.maxIndex[1]), setup.pitchY) },
+            offsetW[2] = { _mm_mullo_epi32(ClampSSE41(firstW, setup.maxIndex[2]), setup.pitchZ), _mm_mullo_epi32(ClampSSE41(_mm_add_epi32(firstW, oneIndex), setup.maxIndex[2]), setup.pitchZ) };
+
+    __m128 sum = _mm_setzero_ps();
+    __m128 weightSum = _mm_setzero_ps();
+
+    for (int k = 0; k < 2; ++k)
+    {
+      for (int j = 0; j < 2; ++j)
+      {
+        __m128i rowOffset = _mm_add_epi32(offsetW[k], offsetV[j]);
+
+        for (int ii = 0; ii < 2; ++ii)
+        {
+          __m128 data = GatherSSE41(buffer.data, _mm_add_epi32(rowOffset, indexU[ii]));
+          __m128 weight = _mm_mul_ps(_mm_mul_ps(weightU[ii], weightV[j]), weightW[k]);
+          __m128 term = _mm_add_ps(sum, _mm_mul_ps(_mm_sub_ps(data, nearest), weight));
+
+          if (isUseNoValue)
+          {
+            __m128 isValid = _mm_cmpneq_ps(data, setup.noValue);
+            sum = _mm_blendv_ps(sum, term, isValid);
+            weightSum = _mm_blendv_ps(weightSum, _mm_add_ps(weightSum, weight), isValid);
+          }
+          else
+          {
+            sum = term;
+          }
+        }
+      }
+    }
+
+    if (isUseNoValue) sum = _mm_div_ps(sum, weightSum);
+    sum = _mm_add_ps(sum, nearest);
+
+    if (isUseNoValue) sum = ReplaceNoValueSSE41(setup, sum, nearest);
+    _mm_storeu_ps(result + i, sum);
+  }
+  return i;
+}
+
+SAMPLE_TARGET_SSE41 static inline void
+CubicWeightsSSE41(__m128 t, __m128 (&weights)[4])
+{
+  __m128 t2 = _mm_mul_ps(t, t);
+  __m128 t3 = _mm_mul_ps(t2, t);
+
+  weights[0] = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.5f), t3), t2), _mm_mul_ps(_mm_set1_ps(0.5f), t));
+  weights[1] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.5f), t3), _mm_mul_ps(_mm_set1_ps(2.5f), t2)), _mm_set1_ps(1.0f));
+  weights[2] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.5f), t3), _mm_mul_ps(_mm_set1_ps(2.0f), t2)), _mm_mul_ps(_mm_set1_ps(0.5f), t));
+  weights[3] = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(t3, t2));
+}
+
+template<bool isUseNoValue>
+SAMPLE_TARGET_SSE41 static int
+SampleCubicSSE41(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  const SetupSSE41 setup = InitSSE41(buffer);
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 positionU = _mm_loadu_ps(u + i),
+           positionV = _mm_loadu_ps(v + i),
+           positionW = _mm_loadu_ps(w + i);
+
+    __m128 nearest = SampleNearestValueSSE41(setup, buffer.data, positionU, positionV, positionW);
+
+    __m128 fractionU, fractionV, fractionW;
+    __m128i firstU = SplitPositionSSE41(positionU, fractionU),
+            firstV = SplitPositionSSE41(positionV, fractionV),
+            firstW = SplitPositionSSE41(positionW, fractionW);
+
+    __m128 weightU[4], weightV[4], weightW[4];
+    CubicWeightsSSE41(fractionU, weightU);
+    CubicWeightsSSE41(fractionV, weightV);
+    CubicWeightsSSE41(fractionW, weightW);
+
+    __m128i indexU[4], offsetV[4], offsetW[4];
+    for (int tap = 0; tap < 4; tap++)
+    {
+      __m128i delta = _mm_set1_epi32(tap - 1);
+      indexU[tap] = ClampSSE41(_mm_add_epi32(firstU, delta), setup.maxIndex[0]);
+      offsetV[tap] = _mm_mullo_epi32(ClampSSE41(_mm_add_epi32(firstV, delta), setup.maxIndex[1]), setup.pitchY);
+      offsetW[tap] = _mm_mullo_epi32(ClampSSE41(_mm_add_epi32(firstW, delta), setup.maxIndex[2]), setup.pitchZ);
+    }
+
+    __m128 data[4][4][4];
+    for (int k = 0; k < 4; ++k)
+    {
+      for (int j = 0; j < 4; ++j)
+      {
+        __m128i rowOffset = _mm_add_epi32(offsetW[k], offsetV[j]);
+        for (int ii = 0; ii < 4; ++ii)
+        {
+          data[k][j][ii] = GatherSSE41(buffer.data, _mm_add_epi32(rowOffset, indexU[ii]));
+        }
+      }
+    }
+
+    __m128 sum = _mm_setzero_ps();
+    __m128 weightSum = _mm_setzero_ps();
+
+    for (int k = 0; k < 4; ++k)
+    {
+      int centerK = (k <= 1 ? 1 : 2);
+      for (int j = 0; j < 4; ++j)
+      {
+        int centerJ = (j <= 1 ? 1 : 2);
+        for (int ii = 0; ii < 4; ++ii)
+        {
+          int centerI = (ii <= 1 ? 1 : 2);
+
+          __m128 weight = _mm_mul_ps(_mm_mul_ps(weightU[ii], weightV[j]), weightW[k]);
+          __m128 term = _mm_add_ps(sum, _mm_mul_ps(_mm_sub_ps(data[k][j][ii], nearest), weight));
+
+          if (isUseNoValue)
+          {
+            __m128 isValid = _mm_and_ps(_mm_cmpneq_ps(data[k][j][ii], setup.noValue), _mm_cmpneq_ps(data[centerK][centerJ][centerI], setup.noValue));
+            sum = _mm_blendv_ps(sum, term, isValid);
+            weightSum = _mm_blendv_ps(weightSum, _mm_add_ps(weightSum, weight), isValid);
+          }
+          else
+          {
+            sum = term;
+          }
+        }
+      }
+    }
+
+    if (isUseNoValue) sum = _mm_div_ps(sum, weightSum);
+    sum = _mm_add_ps(sum, nearest);
+
+    if (isUseNoValue) sum = ReplaceNoValueSSE41(setup, sum, nearest);
+    _mm_storeu_ps(result + i, sum);
+  }
+  return i;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AVX2, eight positions per iteration using hardware gathers
+
+struct SetupAVX2
+{
+  __m256i maxIndex[3];
+  __m256i pitchY;
+  __m256i pitchZ;
+  __m256  noValue;
+  __m256  replacementNoValue;
+};
+
+SAMPLE_TARGET_AVX2 static inline SetupAVX2
+InitAVX2(const SampleBuffer &buffer)
+{
+  SetupAVX2 setup;
+  for (int dimension = 0; dimension < 3; dimension++)
+  {
+    setup.maxIndex[dimension] = _mm256_set1_epi32(buffer.size[dimension] - 1);
+  }
+  setup.pitchY = _mm256_set1_epi32(buffer.pitch[1]);
+  setup.pitchZ = _mm256_set1_epi32(buffer.pitch[2]);
+  setup.noValue = _mm256_set1_ps(buffer.noValue);
+  setup.replacementNoValue = _mm256_set1_ps(buffer.replacementNoValue);
+  return setup;
+}
+
+SAMPLE_TARGET_AVX2 static inline __m256i
+ClampAVX2(__m256i index, __m256i maxIndex)
+{
+  return _mm256_min_epi32(_mm256_max_epi32(index, _mm256_setzero_si256()), maxIndex);
+}
+
+SAMPLE_TARGET_AVX2 static inline __m256
+GatherAVX2(const float *data, __m256i index)
+{
+  return _mm256_i32gather_ps(data, index, 4);
+}
+
+SAMPLE_TARGET_AVX2 static inline __m256
+SampleNearestValueAVX2(const SetupAVX2 &setup, const float *data, __m256 u, __m256 v, __m256 w)
+{
+  __m256i nearestU = ClampAVX2(_mm256_cvttps_epi32(_mm256_floor_ps(u)), setup.maxIndex[0]),
+          nearestV = ClampAVX2(_mm256_cvttps_epi32(_mm256_floor_ps(v)), setup.maxIndex[1]),
+          nearestW = ClampAVX2(_mm256_cvttps_epi32(_mm256_floor_ps(w)), setup.maxIndex[2]);
+
+  return GatherAVX2(data, _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(nearestW, setup.pitchZ), _mm256_mullo_epi32(nearestV, setup.pitchY)), nearestU));
+}
+
+SAMPLE_TARGET_AVX2 static inline __m256i
+SplitPositionAVX2(__m256 position, __m256 &fraction)
+{
+  const __m256 half = _mm256_set1_ps(0.5f);
+  __m256 first = _mm256_floor_ps(_mm256_sub_ps(position, half));
+  fraction = _mm256_sub_ps(_mm256_sub_ps(position, first), half);
+  return _mm256_cvttps_epi32(first);
+}
+
+SAMPLE_TARGET_AVX2 static inline __m256
+ReplaceNoValueAVX2(const SetupAVX2 &setup, __m256 value, __m256 nearest)
+{
+  return _mm256_blendv_ps(value, setup.replacementNoValue, _mm256_cmp_ps(nearest, setup.noValue, _CMP_EQ_OQ));
+}
+
+template<bool isUseNoValue>
+SAMPLE_TARGET_AVX2 static int
+SampleNearestAVX2(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  const SetupAVX2 setup = InitAVX2(buffer);
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 nearest = SampleNearestValueAVX2(setup, buffer.data, _mm256_loadu_ps(u + i), _mm256_loadu_ps(v + i), _mm256_loadu_ps(w + i));
+    if (isUseNoValue) nearest = ReplaceNoValueAVX2(setup, nearest, nearest);
+    _mm256_storeu_ps(result + i, nearest);
+  }
+  return i;
+}
+
+template<bool isUseNoValue>
+SAMPLE_TARGET_AVX2 static int
+SampleLinearAVX2(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  const SetupAVX2 setup = InitAVX2(buffer);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256i oneIndex = _mm256_set1_epi32(1);
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 positionU = _mm256_loadu_ps(u + i),
+           positionV = _mm256_loadu_ps(v + i),
+           positionW = _mm256_loadu_ps(w + i);
+
+    __m256 nearest = SampleNearestValueAVX2(setup, buffer.data, positionU, positionV, positionW);
+
+    __m256 fractionU, fractionV, fractionW;
+    __m256i firstU = SplitPositionAVX2(positionU, fractionU),
+            firstV = SplitPositionAVX2(positionV, fractionV),
+            firstW = SplitPositionAVX2(positionW, fractionW);
+
+    __m256 weightU[2] = { _mm256_sub_ps(one, fractionU), fractionU },
+           weightV[2] = { _mm256_sub_ps(one, fractionV), fractionV },
+           weightW[2] = { _mm256_sub_ps(one, fractionW), fractionW };
+
+    __m256i indexU[2] = { ClampAVX2(firstU, setup.maxIndex[0]), ClampAVX2(_mm256_add_epi32(firstU, oneIndex), setup.maxIndex[0]) },
+            offsetV[2] = { _mm256_mullo_epi32(ClampAVX2(firstV, setup.maxIndex[1]), setup.pitchY), _mm256_mullo_epi32(ClampAVX2(_mm256_add_epi32(firstV, oneIndex), setup.maxIndex[1]), setup.pitchY) },
+            offsetW[2] = { _mm256_mullo_epi32(ClampAVX2(firstW, setup.maxIndex[2]), setup.pitchZ), _mm256_mullo_epi32(ClampAVX2(_mm256_add_epi32(firstW, oneIndex), setup.maxIndex[2]), setup.pitchZ) };
+
+    __m256 sum = _mm256_setzero_ps();
+    __m256 weightSum = _mm256_setzero_ps();
+
+    for (int k = 0; k < 2; ++k)
+    {
+      for (int j = 0; j < 2; ++j)
+      {
+        __m256i rowOffset = _mm256_add_epi32(offsetW[k], offsetV[j]);
+
+        for (int ii = 0; ii < 2; ++ii)
+        {
+          __m256 data = GatherAVX2(buffer.data, _mm256_add_epi32(rowOffset, indexU[ii]));
+          __m256 weight = _mm256_mul_ps(_mm256_mul_ps(weightU[ii], weightV[j]), weightW[k]);
+          __m256 term = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_sub_ps(data, nearest), weight));
+
+          if (isUseNoValue)
+          {
+            __m256 isValid = _mm256_cmp_ps(data, setup.noValue, _CMP_NEQ_UQ);
+            sum = _mm256_blendv_ps(sum, term, isValid);
+            weightSum = _mm256_blendv_ps(weightSum, _mm256_add_ps(weightSum, weight), isValid);
+          }
+          else
+          {
+            sum = term;
+          }
+        }
+      }
+    }
+
+    if (isUseNoValue) sum = _mm256_div_ps(sum, weightSum);
+    sum = _mm256_add_ps(sum, nearest);
+
+    if (isUseNoValue) sum = ReplaceNoValueAVX2(setup, sum, nearest);
+    _mm256_storeu_ps(result + i, sum);
+  }
+  return i;
+}
+
+SAMPLE_TARGET_AVX2 static inline void
+CubicWeightsAVX2(__m256 t, __m256 (&weights)[4])
+{
+  __m256 t2 = _mm256_mul_ps(t, t);
+  __m256 t3 = _mm256_mul_ps(t2, t);
+
+  weights[0] = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-0.5f), t3), t2), _mm256_mul_ps(_mm256_set1_ps(0.5f), t));
+  weights[1] = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(1.5f), t3), _mm256_mul_ps(_mm256_set1_ps(2.5f), t2)), _mm256_set1_ps(1.0f));
+  weights[2] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-1.5f), t3), _mm256_mul_ps(_mm256_set1_ps(2.0f), t2)), _mm256_mul_ps(_mm256_set1_ps(0.5f), t));
+  weights[3] = _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(t3, t2));
+}
+
+template<bool isUseNoValue>
+SAMPLE_TARGET_AVX2 static int
+SampleCubicAVX2(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  const SetupAVX2 setup = InitAVX2(buffer);
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 positionU = _mm256_loadu_ps(u + i),
+           positionV = _mm256_loadu_ps(v + i),
+           positionW = _mm256_loadu_ps(w + i);
+
+    __m256 nearest = SampleNearestValueAVX2(setup, buffer.data, positionU, positionV, positionW);
+
+    __m256 fractionU, fractionV, fractionW;
+    __m256i firstU = SplitPositionAVX2(positionU, fractionU),
+            firstV = SplitPositionAVX2(positionV, fractionV),
+            firstW = SplitPositionAVX2(positionW, fractionW);
+
+    __m256 weightU[4], weightV[4], weightW[4];
+    CubicWeightsAVX2(fractionU, weightU);
+    CubicWeightsAVX2(fractionV, weightV);
+    CubicWeightsAVX2(fractionW, weightW);
+
+    __m256i indexU[4], offsetV[4], offsetW[4];
+    for (int tap = 0; tap < 4; tap++)
+    {
+      __m256i delta = _mm256_set1_epi32(tap - 1);
+      indexU[tap] = ClampAVX2(_mm256_add_epi32(firstU, delta), setup.maxIndex[0]);
+      offsetV[tap] = _mm256_mullo_epi32(ClampAVX2(_mm256_add_epi32(firstV, delta), setup.maxIndex[1]), setup.pitchY);
+      offsetW[tap] = _mm256_mullo_epi32(ClampAVX2(_mm256_add_epi32(firstW, delta), setup.maxIndex[2]), setup.pitchZ);
+    }
+
+    // The validity of the eight center samples decides which of the surrounding samples are used
+    __m256 isCenterValid[2][2][2];
+    if (isUseNoValue)
+    {
+      for (int k = 0; k < 2; ++k)
+      {
+        for (int j = 0; j < 2; ++j)
+        {
+          __m256i rowOffset = _mm256_add_epi32(offsetW[k + 1], offsetV[j + 1]);
+          for (int ii = 0; ii < 2; ++ii)
+          {
+            isCenterValid[k][j][ii] = _mm256_cmp_ps(GatherAVX2(buffer.data, _mm256_add_epi32(rowOffset, indexU[ii + 1])), setup.noValue, _CMP_NEQ_UQ);
+          }
+        }
+      }
+    }
+
+    __m256 sum = _mm256_setzero_ps();
+    __m256 weightSum = _mm256_setzero_ps();
+
+    for (int k = 0; k < 4; ++k)
+    {
+      int centerK = (k <= 1 ? 0 : 1);
+      for (int j = 0; j < 4; ++j)
+      {
+        int centerJ = (j <= 1 ? 0 : 1);
+        __m256i rowOffset = _mm256_add_epi32(offsetW[k], offsetV[j]);
+        for (int ii = 0; ii < 4; ++ii)
+        {
+          int centerI = (ii <= 1 ? 0 : 1);
+
+          __m256 data = GatherAVX2(buffer.data, _mm256_add_epi32(rowOffset, indexU[ii]));
+          __m256 weight = _mm256_mul_ps(_mm256_mul_ps(weightU[ii], weightV[j]), weightW[k]);
+          __m256 term = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_sub_ps(data, nearest), weight));
+
+          if (isUseNoValue)
+          {
+            __m256 isValid = _mm256_and_ps(_mm256_cmp_ps(data, setup.noValue, _CMP_NEQ_UQ), isCenterValid[centerK][centerJ][centerI]);
+            sum = _mm256_blendv_ps(sum, term, isValid);
+            weightSum = _mm256_blendv_ps(weightSum, _mm256_add_ps(weightSum, weight), isValid);
+          }
+          else
+          {
+            sum = term;
+          }
+        }
+      }
+    }
+
+    if (isUseNoValue) sum = _mm256_div_ps(sum, weightSum);
+    sum = _mm256_add_ps(sum, nearest);
+
+    if (isUseNoValue) sum = ReplaceNoValueAVX2(setup, sum, nearest);
+    _mm256_storeu_ps(result + i, sum);
+  }
+  return i;
+}
+
+#endif // ENABLE_SSE_SAMPLE
+
+/////////////////////////////////////////////////////////////////////////////
+// Runtime dispatch
+
+static InstructionSet
+DetectInstructionSet()
+{
+#if defined(ENABLE_SSE_SAMPLE) && defined(_MSC_VER)
+  int cpuInfo[4];
+  __cpuid(cpuInfo, 0);
+  int maxLeaf = cpuInfo[0];
+
+  __cpuid(cpuInfo, 1);
+  bool isSSE41 = (cpuInfo[2] & (1 << 19)) != 0;
+  bool isOSXSAVE = (cpuInfo[2] & (1 << 27)) != 0;
+  bool isAVX = (cpuInfo[2] & (1 << 28)) != 0 && isOSXSAVE && (_xgetbv(0) & 6) == 6;
+  bool isAVX2 = false;
+  if (isAVX && maxLeaf >= 7)
+  {
+    __cpuidex(cpuInfo, 7, 0);
+    isAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+  }
+
+  if (isAVX2) return InstructionSet::AVX2;
+  if (isSSE41) return InstructionSet::SSE41;
+#elif defined(ENABLE_SSE_SAMPLE)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return InstructionSet::AVX2;
+  if (__builtin_cpu_supports("sse4.1")) return InstructionSet::SSE41;
+#endif
+  return InstructionSet::Scalar;
+}
+
+InstructionSet
+SupportedInstructionSet()
+{
+  static const InstructionSet instructionSet = DetectInstructionSet();
+  return instructionSet;
+}
+
+const char *
+InstructionSetName(InstructionSet instructionSet)
+{
+  switch (instructionSet)
+  {
+  case InstructionSet::SSE41: return "SSE4.1";
+  case InstructionSet::AVX2:  return "AVX2";
+  default:                    return "Scalar";
+  }
+}
+
+typedef int (*BatchKernel)(const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result);
+
+template<InterpolationMethod INTERPMETHOD, bool isUseNoValue>
+static void SampleWithKernel(InstructionSet instructionSet, const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  BatchKernel batchKernel = nullptr;
+
+#ifdef ENABLE_SSE_SAMPLE
+  switch (instructionSet)
+  {
+  case InstructionSet::AVX2:
+    batchKernel = INTERPMETHOD == InterpolationMethod::Nearest ? &SampleNearestAVX2<isUseNoValue> :
+                  INTERPMETHOD == InterpolationMethod::Linear  ? &SampleLinearAVX2<isUseNoValue> :
+                                                                 &SampleCubicAVX2<isUseNoValue>;
+    break;
+  case InstructionSet::SSE41:
+    batchKernel = INTERPMETHOD == InterpolationMethod::Nearest ? &SampleNearestSSE41<isUseNoValue> :
+                  INTERPMETHOD == InterpolationMethod::Linear  ? &SampleLinearSSE41<isUseNoValue> :
+                                                                 &SampleCubicSSE41<isUseNoValue>;
+    break;
+  default:
+    break;
+  }
+#else
+  (void)instructionSet;
+#endif
+
+  int done = batchKernel ? batchKernel(buffer, u, v, w, count, result) : 0;
+
+  // The positions that don't fill a whole batch
+  SampleScalar<INTERPMETHOD, isUseNoValue>(buffer, u + done, v + done, w + done, count - done, result + done);
+}
+
+void
+Sample3D(InstructionSet instructionSet, InterpolationMethod interpolationMethod, const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  switch (interpolationMethod)
+  {
+  case InterpolationMethod::Nearest:
+    buffer.isUseNoValue ? SampleWithKernel<InterpolationMethod::Nearest, true>(instructionSet, buffer, u, v, w, count, result) : SampleWithKernel<InterpolationMethod::Nearest, false>(instructionSet, buffer, u, v, w, count, result);
+    break;
+  case InterpolationMethod::Linear:
+    buffer.isUseNoValue ? SampleWithKernel<InterpolationMethod::Linear, true>(instructionSet, buffer, u, v, w, count, result) : SampleWithKernel<InterpolationMethod::Linear, false>(instructionSet, buffer, u, v, w, count, result);
+    break;
+  case InterpolationMethod::Cubic:
+    buffer.isUseNoValue ? SampleWithKernel<InterpolationMethod::Cubic, true>(instructionSet, buffer, u, v, w, count, result) : SampleWithKernel<InterpolationMethod::Cubic, false>(instructionSet, buffer, u, v, w, count, result);
+    break;
+  default:
+    throw std::runtime_error("Interpolation method not supported by the sample kernels");
+  }
+}
+
+} // end namespace SampleKernels
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef VOLUMEDATASAMPLEKERNELS_H
+#define VOLUMEDATASAMPLEKERNELS_H
+
+#include <OpenVDS/VolumeData.h>
+
+#include <cstdint>
+
+namespace OpenVDS
+{
+
+// Batched sampling of float (Format_R32) buffers, used by the RequestVolumeSamples and RequestVolumeTraces processing.
+// The kernels give the same results as VolumeSampler<float, ...>::Sample3D for the same positions, but interpolate
+// several positions per iteration. The positions are given as separate arrays of local buffer indices (i.e. in the
+// same coordinate system as the FloatVector3 passed to Sample3D).
+namespace SampleKernels
+{
+
+enum class InstructionSet
+{
+  Scalar,
+  SSE41,
+  AVX2
+};
+
+// The best instruction set supported by this build and the running CPU
+InstructionSet SupportedInstructionSet();
+
+const char *InstructionSetName(InstructionSet instructionSet);
+
+// Nearest, Linear and Cubic interpolation have batched kernels, the other methods must use the VolumeSampler
+inline bool IsInterpolationMethodSupported(InterpolationMethod interpolationMethod)
+{
+  return interpolationMethod == InterpolationMethod::Nearest || interpolationMethod == InterpolationMethod::Linear || interpolationMethod == InterpolationMethod::Cubic;
+}
+
+struct SampleBuffer
+{
+  const float *data;
+  int32_t      size[3];
+  int32_t      pitch[3];
+  bool         isUseNoValue;
+  float        noValue;
+  float        replacementNoValue;
+};
+
+// Sample the buffer at count positions and write the results to result[0 .. count-1]
+void Sample3D(InstructionSet instructionSet, InterpolationMethod interpolationMethod, const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result);
+
+// Sample using the best supported instruction set
+inline void Sample3D(InterpolationMethod interpolationMethod, const SampleBuffer &buffer, const float *u, const float *v, const float *w, int count, float *result)
+{
+  Sample3D(SupportedInstructionSet(), interpolationMethod, buffer, u, v, w, count, result);
+}
+
+} // end namespace SampleKernels
+
+}
+
+#endif //VOLUMEDATASAMPLEKERNELS_H
@@ -35,6 +35,14 @@
 
 #include <zlib.h>
 
+#ifndef OPENVDS_NO_ZSTD
+#include <zstd.h>
+#endif
+
+#ifndef OPENVDS_NO_LZ4
+#include <lz4.h>
+#endif
+
 namespace OpenVDS
 {
 
@@ -42,7 +50,10 @@ VolumeDataStore::VolumeDataStore(OpenOptions::ConnectionType connectionType)
   : m_globalStateVds(static_cast<GlobalStateImpl *>(GetGlobalState())->downloaded[connectionType],
                      static_cast<GlobalStateImpl *>(GetGlobalState())->downloadedChunks[connectionType],
                      static_cast<GlobalStateImpl *>(GetGlobalState())->decompressed[connectionType],
-                     static_cast<GlobalStateImpl *>(GetGlobalState())->decompressedChunks[connectionType])
+                     static_cast<GlobalStateImpl *>(GetGlobalState())->decompressedChunks[connectionType],
+                     static_cast<GlobalStateImpl *>(GetGlobalState())->cacheHits[connectionType],
+                     static_cast<GlobalStateImpl *>(GetGlobalState())->cacheMisses[connectionType],
+                     static_cast<GlobalStateImpl *>(GetGlobalState())->cacheEvictions[connectionType])
 {
 }
 
@@ -56,6 +67,27 @@ static uint32_t GetByteSize(const DataBlockDescriptor &descriptor)
   return GetByteSize(size, descriptor.Format, descriptor.Components);
 }
 
+int64_t VolumeDataStore::GetAdaptiveLevelDataSize(const VolumeDataChunk &volumeDataChunk, const std::vector<uint8_t> &serializedData, const std::vector<uint8_t> &metadata, int32_t adaptiveLevel)
+{
+  if(!CompressionMethod_IsWavelet(volumeDataChunk.layer->GetEffectiveCompressionMethod()) || metadata.size() != sizeof(uint64_t) + sizeof(uint8_t[WAVELET_ADAPTIVE_LEVELS]) || serializedData.size() < sizeof(int32_t) * 2)
+  {
+    return int64_t(serializedData.size());
+  }
+
+  uint64_t volumeDataHashValue;
+  memcpy(&volumeDataHashValue, metadata.data(), sizeof(uint64_t));
+
+  if(VolumeDataHash(volumeDataHashValue).IsConstant())
+  {
+    return int64_t(serializedData.size());
+  }
+
+  int32_t compressedSize;
+  memcpy(&compressedSize, serializedData.data() + sizeof(int32_t), sizeof(int32_t));
+
+  return Wavelet_DecodeAdaptiveLevelsMetadata(compressedSize, adaptiveLevel, metadata.data() + sizeof(uint64_t));
+}
+
 bool VolumeDataStore::Verify(const VolumeDataChunk &volumeDataChunk, const std::vector<uint8_t> &serializedData, CompressionMethod compressionMethod, bool isFullyRead)
 {
   bool isValid = false;
@@ -93,7 +125,9 @@ bool VolumeDataStore::Verify(const VolumeDataChunk &volumeDataChunk, const std::
   }
   else if(compressionMethod == CompressionMethod::None ||
           compressionMethod == CompressionMethod::RLE ||
-          compressionMethod == CompressionMethod::Zip)
+          compressionMethod == CompressionMethod::Zip ||
+          compressionMethod == CompressionMethod::Zstd ||
+          compressionMethod == CompressionMethod::LZ4)
   {
     if(serializedData.size() > sizeof(DataBlockDescriptor))
     {
@@ -105,7 +139,7 @@ bool VolumeDataStore::Verify(const VolumeDataChunk &volumeDataChunk, const std::
   return isValid;
 }
 
-static void CopyLinearBufferIntoDataBlock(const void *sourceBuffer, const DataBlock &dataBlock, std::vector<uint8_t> &targetBuffer)
+static void CopyLinearBufferIntoDataBlock(const void *sourceBuffer, const DataBlock &dataBlock, uint8_t *targetBuffer)
 {
 
   int32_t sizeX = dataBlock.Size[0];
@@ -126,7 +160,7 @@ static void CopyLinearBufferIntoDataBlock(const void *sourceBuffer, const DataBl
   {
     for(int32_t iY = 0; iY < sizeY; iY++)
     {
-      uint8_t *target = targetBuffer.data()                             +  (iZ * allocatedSizeY + iY) * allocatedSizeX * elementSize;
+      uint8_t *target = targetBuffer                                    +  (iZ * allocatedSizeY + iY) * allocatedSizeX * elementSize;
       const uint8_t *source = static_cast<const uint8_t*>(sourceBuffer) +  (iZ * sizeY          + iY) * sizeX          * elementSize;
       memcpy(target, source, size_t(sizeX) * elementSize);
     }
@@ -267,6 +301,18 @@ static int64_t GetSerializationTargetBufferSize(int64_t sourceSize, CompressionM
   {
     return sizeof(DataBlockDescriptor) + compressBound((uLong)sourceSize);
   }
+#ifndef OPENVDS_NO_ZSTD
+  else if(compressionMethod == CompressionMethod::Zstd)
+  {
+    return sizeof(DataBlockDescriptor) + ZSTD_compressBound(size_t(sourceSize));
+  }
+#endif
+#ifndef OPENVDS_NO_LZ4
+  else if(compressionMethod == CompressionMethod::LZ4)
+  {
+    return sizeof(DataBlockDescriptor) + LZ4_compressBound(int(sourceSize));
+  }
+#endif
   else
   {
     assert(compressionMethod == CompressionMethod::None);
@@ -274,7 +320,26 @@ static int64_t GetSerializationTargetBufferSize(int64_t sourceSize, CompressionM
   }
 }
 
-bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDataChannelDescriptor::Format format, CompressionMethod compressionMethod, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, int32_t adaptiveLevel, DataBlock &dataBlock, std::vector<uint8_t> &destination, Error &error)
+// The destination of the deserialized data is either a vector that is resized to the allocated size of the data block, or a
+// buffer given by the caller. A buffer can only receive linear data blocks, and then only the data (not the padding) is written.
+static uint8_t *GetDeserializeDestination(const DataBlock &dataBlock, std::vector<uint8_t> *destinationVector, void *destinationBuffer, int64_t destinationBufferSize, Error &error)
+{
+  if (destinationVector)
+  {
+    destinationVector->resize(GetAllocatedByteSize(dataBlock));
+    return destinationVector->data();
+  }
+
+  if (!IsDataBlockLinear(dataBlock) || int64_t(GetByteSize(dataBlock)) > destinationBufferSize)
+  {
+    error.code = -1;
+    error.string = "The destination buffer does not match the layout of the deserialized data block";
+    return nullptr;
+  }
+  return static_cast<uint8_t *>(destinationBuffer);
+}
+
+static bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDataChannelDescriptor::Format format, CompressionMethod compressionMethod, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, int32_t adaptiveLevel, DataBlock &dataBlock, std::vector<uint8_t> *destinationVector, void *destinationBuffer, int64_t destinationBufferSize, Error &error)
 {
   if(CompressionMethod_IsWavelet(compressionMethod))
   {
@@ -311,8 +376,16 @@ bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDat
       adaptiveLevel = 0;
     }
 
-    if (!Wavelet_Decompress(data, int32_t(serializedData.size()), format, valueRange, integerScale, integerOffset, isUseNoValue, noValue, isNormalize, adaptiveLevel, isLossless, dataBlock, destination, error))
-      return false;
+    if (destinationVector)
+    {
+      if (!Wavelet_Decompress(data, int32_t(serializedData.size()), format, valueRange, integerScale, integerOffset, isUseNoValue, noValue, isNormalize, adaptiveLevel, isLossless, dataBlock, *destinationVector, error))
+        return false;
+    }
+    else
+    {
+      if (!Wavelet_Decompress(data, int32_t(serializedData.size()), format, valueRange, integerScale, integerOffset, isUseNoValue, noValue, isNormalize, adaptiveLevel, isLossless, dataBlock, destinationBuffer, destinationBufferSize, error))
+        return false;
+    }
   }
   else if(compressionMethod == CompressionMethod::RLE)
   {
@@ -330,18 +403,27 @@ bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDat
 
     void * source = dataBlockDescriptor + 1;
 
+    uint8_t *target = GetDeserializeDestination(dataBlock, destinationVector, destinationBuffer, destinationBufferSize, error);
+    if (!target)
+      return false;
+
+    // Linear data blocks are decompressed in place, others through a linear buffer
+    bool isLinear = IsDataBlockLinear(dataBlock);
     int32_t byteSize = GetByteSize(*dataBlockDescriptor);
-    std::unique_ptr<uint8_t[]>buffer(new uint8_t[byteSize]);
+    std::unique_ptr<uint8_t[]>buffer(isLinear ? nullptr : new uint8_t[byteSize]);
 
-    int32_t decompressedSize = RleDecompress((uint8_t *)buffer.get(), byteSize, (uint8_t *)source);
+    int32_t decompressedSize = RleDecompress(isLinear ? target : buffer.get(), byteSize, (uint8_t *)source);
     (void)decompressedSize;
     assert(decompressedSize == byteSize);
 
-    int allocatedSize = GetAllocatedByteSize(dataBlock);
-    destination.resize(allocatedSize);
-    CopyLinearBufferIntoDataBlock(buffer.get(), dataBlock, destination);
+    if (!isLinear)
+    {
+      CopyLinearBufferIntoDataBlock(buffer.get(), dataBlock, target);
+    }
   }
-  else if(compressionMethod == CompressionMethod::Zip)
+  else if(compressionMethod == CompressionMethod::Zip ||
+          compressionMethod == CompressionMethod::Zstd ||
+          compressionMethod == CompressionMethod::LZ4)
   {
     DataBlockDescriptor *dataBlockDescriptor = (DataBlockDescriptor *)serializedData.data();
 
@@ -356,22 +438,69 @@ bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDat
 
     void * source = dataBlockDescriptor + 1;
 
+    uint8_t *target = GetDeserializeDestination(dataBlock, destinationVector, destinationBuffer, destinationBufferSize, error);
+    if (!target)
+      return false;
+
+    // Linear data blocks are decompressed in place, others through a linear buffer
+    bool isLinear = IsDataBlockLinear(dataBlock);
     int32_t byteSize = GetByteSize(*dataBlockDescriptor);
-    std::unique_ptr<uint8_t[]> buffer(new uint8_t[byteSize]);
+    std::unique_ptr<uint8_t[]> buffer(isLinear ? nullptr : new uint8_t[byteSize]);
+    uint8_t *decompressed = isLinear ? target : buffer.get();
 
-    unsigned long destLen = byteSize;
+    size_t sourceSize = serializedData.size() - sizeof(DataBlockDescriptor);
 
-    int status = uncompress(buffer.get(), &destLen, (uint8_t *)source, uint32_t(serializedData.size() - sizeof(DataBlockDescriptor)));
+    if (compressionMethod == CompressionMethod::Zip)
+    {
+      unsigned long destLen = byteSize;
+
+      int status = uncompress(decompressed, &destLen, (uint8_t *)source, uint32_t(sourceSize));
+
+      if (status != Z_OK)
+      {
+        fprintf(stderr, "zlib uncompress failed (status %d) in VolumeDataStore_c::DeSerialize\n", status);
+        return false;
+      }
+    }
+    else if (compressionMethod == CompressionMethod::Zstd)
+    {
+#ifndef OPENVDS_NO_ZSTD
+      size_t decompressedSize = ZSTD_decompress(decompressed, size_t(byteSize), source, sourceSize);
 
-    if (status != Z_OK)
+      if (ZSTD_isError(decompressedSize) || decompressedSize != size_t(byteSize))
+      {
+        error.code = -1;
+        error.string = ZSTD_isError(decompressedSize) ? fmt::format("zstd decompression failed: {}", ZSTD_getErrorName(decompressedSize)) : std::string("zstd decompression returned the wrong size");
+        return false;
+      }
+#else
+      error.code = -1;
+      error.string = "This build of OpenVDS does not support zstd compression";
+      return false;
+#endif
+    }
+    else
     {
-      fprintf(stderr, "zlib uncompress failed (status %d) in VolumeDataStore_c::DeSerialize\n", status);
+#ifndef OPENVDS_NO_LZ4
+      int decompressedSize = LZ4_decompress_safe((const char *)source, (char *)decompressed, int(sourceSize), byteSize);
+
+      if (decompressedSize != byteSize)
+      {
+        error.code = -1;
+        error.string = "LZ4 decompression failed";
+        return false;
+      }
+#else
+      error.code = -1;
+      error.string = "This build of OpenVDS does not support LZ4 compression";
       return false;
+#endif
     }
 
-    int allocatedSize = GetAllocatedByteSize(dataBlock);
-    destination.resize(allocatedSize);
-    CopyLinearBufferIntoDataBlock(buffer.get(), dataBlock, destination);
+    if (!isLinear)
+    {
+      CopyLinearBufferIntoDataBlock(buffer.get(), dataBlock, target);
+    }
   }
   else if(compressionMethod == CompressionMethod::None)
   {
@@ -398,9 +527,18 @@ bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDat
       return false;
     }
 
-    int32_t byteSize = GetAllocatedByteSize(dataBlock);
-    destination.resize(byteSize);
-    CopyLinearBufferIntoDataBlock(source, dataBlock, destination);
+    uint8_t *target = GetDeserializeDestination(dataBlock, destinationVector, destinationBuffer, destinationBufferSize, error);
+    if (!target)
+      return false;
+
+    if (IsDataBlockLinear(dataBlock))
+    {
+      memcpy(target, source, requiredDataBlockSize);
+    }
+    else
+    {
+      CopyLinearBufferIntoDataBlock(source, dataBlock, target);
+    }
   }
 
   if(dataBlock.Format != format)
@@ -412,6 +550,11 @@ bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDat
   return true;
 }
 
+bool DeserializeVolumeData(const std::vector<uint8_t> &serializedData, VolumeDataChannelDescriptor::Format format, CompressionMethod compressionMethod, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, int32_t adaptiveLevel, DataBlock &dataBlock, std::vector<uint8_t> &destination, Error &error)
+{
+  return DeserializeVolumeData(serializedData, format, compressionMethod, valueRange, integerScale, integerOffset, isUseNoValue, noValue, adaptiveLevel, dataBlock, &destination, nullptr, 0, error);
+}
+
 static float GetConvertedConstantValue(VolumeDataChannelDescriptor const &volumeDataChannelDescriptor, VolumeDataChannelDescriptor::Format format, float noValue, VolumeDataHash const &constantValueVolumeDataHash)
 {
   if(format == VolumeDataChannelDescriptor::Format_1Bit)
@@ -459,17 +602,18 @@ static float GetConvertedConstantValue(VolumeDataChannelDescriptor const &volume
 }
 
 template <typename T>
-static void FillConstantValueBuffer(std::vector<uint8_t> &buffer, int32_t allocatedElements, float value)
+static void FillConstantValueBuffer(uint8_t *buffer, int64_t byteSize, float value)
 {
   T v = ConvertValue<T>(value);
-  T *b = reinterpret_cast<T *>(buffer.data());
-  for(int32_t element = 0; element < allocatedElements; element++)
+  T *b = reinterpret_cast<T *>(buffer);
+  int64_t elements = byteSize / int64_t(sizeof(T));
+  for(int64_t element = 0; element < elements; element++)
   {
     b[element] = v;
   }
 }
 
-bool VolumeDataStore::CreateConstantValueDataBlock(VolumeDataChunk const &volumeDataChunk, VolumeDataChannelDescriptor::Format format, float noValue, VolumeDataChannelDescriptor::Components components, VolumeDataHash const &constantValueVolumeDataHash, DataBlock &dataBlock, std::vector<uint8_t> &buffer, Error &error)
+static bool CreateConstantValueDataBlock(VolumeDataChunk const &volumeDataChunk, VolumeDataChannelDescriptor::Format format, float noValue, VolumeDataChannelDescriptor::Components components, VolumeDataHash const &constantValueVolumeDataHash, DataBlock &dataBlock, std::vector<uint8_t> *destinationVector, void *destinationBuffer, int64_t destinationBufferSize, Error &error)
 {
   int32_t size[4];
   volumeDataChunk.layer->GetChunkVoxelSize(volumeDataChunk.index, size);
@@ -477,11 +621,12 @@ bool VolumeDataStore::CreateConstantValueDataBlock(VolumeDataChunk const &volume
   if (!InitializeDataBlock(format, components, (enum DataBlock::Dimensionality)(dimensionality), size, dataBlock, error))
     return false;
 
- 
-  int32_t allocatedSize = GetAllocatedByteSize(dataBlock);
-  buffer.resize(allocatedSize);
+  uint8_t *buffer = GetDeserializeDestination(dataBlock, destinationVector, destinationBuffer, destinationBufferSize, error);
+  if (!buffer)
+    return false;
 
-  int32_t allocatedElements = dataBlock.AllocatedSize[0] * dataBlock.AllocatedSize[1] * dataBlock.AllocatedSize[2] * dataBlock.AllocatedSize[3] * dataBlock.Components;
+  // A vector is filled including the padding, a buffer only has the data
+  int64_t byteSize = destinationVector ? int64_t(GetAllocatedByteSize(dataBlock)) : int64_t(GetByteSize(dataBlock));
 
   float convertedConstantValue = GetConvertedConstantValue(volumeDataChunk.layer->GetVolumeDataChannelDescriptor(), format, noValue, constantValueVolumeDataHash);
 
@@ -502,18 +647,23 @@ bool VolumeDataStore::CreateConstantValueDataBlock(VolumeDataChunk const &volume
     error.code = -1;
     error.string = "Invalid format in createConstantValuedataBlock";
     return false;
-  case VolumeDataChannelDescriptor::Format_U8:  FillConstantValueBuffer<uint8_t>(buffer, allocatedElements, convertedConstantValue); break;
-  case VolumeDataChannelDescriptor::Format_U16: FillConstantValueBuffer<uint16_t>(buffer, allocatedElements, convertedConstantValue); break;
-  case VolumeDataChannelDescriptor::Format_R32: FillConstantValueBuffer<float>(buffer, allocatedElements, convertedConstantValue); break;
-  case VolumeDataChannelDescriptor::Format_U32: FillConstantValueBuffer<uint32_t>(buffer, allocatedElements, convertedConstantValue); break;
-  case VolumeDataChannelDescriptor::Format_R64: FillConstantValueBuffer<double>(buffer, allocatedElements, convertedConstantValue); break;
-  case VolumeDataChannelDescriptor::Format_U64: FillConstantValueBuffer<uint64_t>(buffer, allocatedElements, convertedConstantValue); break;
+  case VolumeDataChannelDescriptor::Format_U8:  FillConstantValueBuffer<uint8_t>(buffer, byteSize, convertedConstantValue); break;
+  case VolumeDataChannelDescriptor::Format_U16: FillConstantValueBuffer<uint16_t>(buffer, byteSize, convertedConstantValue); break;
+  case VolumeDataChannelDescriptor::Format_R32: FillConstantValueBuffer<float>(buffer, byteSize, convertedConstantValue); break;
+  case VolumeDataChannelDescriptor::Format_U32: FillConstantValueBuffer<uint32_t>(buffer, byteSize, convertedConstantValue); break;
+  case VolumeDataChannelDescriptor::Format_R64: FillConstantValueBuffer<double>(buffer, byteSize, convertedConstantValue); break;
+  case VolumeDataChannelDescriptor::Format_U64: FillConstantValueBuffer<uint64_t>(buffer, byteSize, convertedConstantValue); break;
   }
 
   return true;
 }
 
-bool VolumeDataStore::DeserializeVolumeData(const VolumeDataChunk& volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, CompressionMethod compressionMethod, int32_t adaptiveLevel, VolumeDataChannelDescriptor::Format loadFormat, DataBlock& dataBlock, std::vector<uint8_t>& target, Error& error)
+bool VolumeDataStore::CreateConstantValueDataBlock(VolumeDataChunk const &volumeDataChunk, VolumeDataChannelDescriptor::Format format, float noValue, VolumeDataChannelDescriptor::Components components, VolumeDataHash const &constantValueVolumeDataHash, DataBlock &dataBlock, std::vector<uint8_t> &buffer, Error &error)
+{
+  return OpenVDS::CreateConstantValueDataBlock(volumeDataChunk, format, noValue, components, constantValueVolumeDataHash, dataBlock, &buffer, nullptr, 0, error);
+}
+
+bool VolumeDataStore::DeserializeVolumeData(const VolumeDataChunk& volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, CompressionMethod compressionMethod, int32_t adaptiveLevel, VolumeDataChannelDescriptor::Format loadFormat, DataBlock& dataBlock, std::vector<uint8_t>* targetVector, void* targetBuffer, int64_t targetBufferSize, Error& error)
 {
   uint64_t volumeDataHashValue = VolumeDataHash::UNKNOWN;
 
@@ -533,7 +683,7 @@ bool VolumeDataStore::DeserializeVolumeData(const VolumeDataChunk& volumeDataChu
 
   if (volumeDataHash.IsConstant())
   {
-    return CreateConstantValueDataBlock(volumeDataChunk, volumeDataLayer->GetFormat(), volumeDataLayer->GetNoValue(), volumeDataLayer->GetComponents(), volumeDataHash, dataBlock, target, error);
+    return OpenVDS::CreateConstantValueDataBlock(volumeDataChunk, volumeDataLayer->GetFormat(), volumeDataLayer->GetNoValue(), volumeDataLayer->GetComponents(), volumeDataHash, dataBlock, targetVector, targetBuffer, targetBufferSize, error);
   }
   else if(serializedData.empty())
   {
@@ -568,11 +718,22 @@ bool VolumeDataStore::DeserializeVolumeData(const VolumeDataChunk& volumeDataChu
     }
   }
 
-  bool ret = OpenVDS::DeserializeVolumeData(serializedData, loadFormat, compressionMethod, deserializeValueRange, volumeDataLayer->GetIntegerScale(), volumeDataLayer->GetIntegerOffset(), volumeDataLayer->IsUseNoValue(), volumeDataLayer->GetNoValue(), adaptiveLevel, dataBlock, target, error);
-  m_globalStateVds.addDecompressed(target.size());
+  bool ret = OpenVDS::DeserializeVolumeData(serializedData, loadFormat, compressionMethod, deserializeValueRange, volumeDataLayer->GetIntegerScale(), volumeDataLayer->GetIntegerOffset(), volumeDataLayer->IsUseNoValue(), volumeDataLayer->GetNoValue(), adaptiveLevel, dataBlock, targetVector, targetBuffer, targetBufferSize, error);
+  m_globalStateVds.addDecompressed(targetVector ? targetVector->size() : (ret ? size_t(GetByteSize(dataBlock)) : 0));
   return ret;
 }
 
+bool VolumeDataStore::DeserializeVolumeData(const VolumeDataChunk& volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, CompressionMethod compressionMethod, int32_t adaptiveLevel, VolumeDataChannelDescriptor::Format loadFormat, DataBlock& dataBlock, std::vector<uint8_t>& target, Error& error)
+{
+  return DeserializeVolumeData(volumeDataChunk, serializedData, metadata, compressionMethod, adaptiveLevel, loadFormat, dataBlock, &target, nullptr, 0, error);
+}
+
+bool VolumeDataStore::DeserializeVolumeData(const VolumeDataChunk& volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, CompressionMethod compressionMethod, int32_t adaptiveLevel, VolumeDataChannelDescriptor::Format loadFormat, DataBlock& dataBlock, void* target, int64_t targetSize, Error& error)
+{
+  return DeserializeVolumeData(volumeDataChunk, serializedData, metadata, compressionMethod, adaptiveLevel, loadFormat, dataBlock, nullptr, target, targetSize, error);
+}
+
+
 struct ShrinkToSizeOnExit
 {
   ShrinkToSizeOnExit(std::vector<uint8_t>& to_shrink)
@@ -586,8 +747,10 @@ struct ShrinkToSizeOnExit
 };
 
 uint64_t
-VolumeDataStore::SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlock& dataBlock, const std::vector<uint8_t>& chunkData, CompressionMethod compressionMethod, float, std::vector<uint8_t>& destinationBuffer)
+VolumeDataStore::SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlock& dataBlock, const std::vector<uint8_t>& chunkData, CompressionMethod compressionMethod, float compressionTolerance, std::vector<uint8_t>& destinationBuffer, std::vector<uint8_t>& adaptiveLevels)
 {
+  adaptiveLevels.clear();
+
   DataBlockDescriptor dataBlockHeader;
   dataBlockHeader.Components = dataBlock.Components;
   dataBlockHeader.Dimensionality = dataBlock.Dimensionality;
@@ -600,7 +763,7 @@ VolumeDataStore::SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlo
   {
     destinationBuffer.resize(GetByteSize(dataBlock) + sizeof(DataBlockDescriptor));
   }
-  else
+  else if (!CompressionMethod_IsWavelet(compressionMethod))
   {
     destinationBuffer.resize(size_t(GetSerializationTargetBufferSize(int64_t(GetAllocatedByteSize(dataBlock)), compressionMethod)));
   }
@@ -626,6 +789,67 @@ VolumeDataStore::SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlo
     break;
   }
   case CompressionMethod::Zip:
+  case CompressionMethod::Zstd:
+  case CompressionMethod::LZ4:
+  {
+    uint32_t tmpbuffersize = GetByteSize(dataBlock);
+    std::unique_ptr<uint8_t[]> tmpdata(new uint8_t[tmpbuffersize]);
+    bool isConstant = CopyDataBlockIntoLinearBuffer(dataBlock, chunkData.data(), tmpdata.get(), tmpbuffersize);
+
+    if (isConstant)
+    {
+      destinationBuffer.resize(0);
+      auto& layer = *chunk.layer;
+      return GetConstantValueVolumeDataHash(dataBlock, tmpdata.get(), layer.GetValueRange(), layer.GetIntegerScale(), layer.GetIntegerOffset(), layer.IsUseNoValue(), layer.GetNoValue());
+    }
+    void *targetBuffer = destinationBuffer.data();
+    memcpy(targetBuffer, &dataBlockHeader, sizeof(dataBlockHeader));
+    targetBuffer = ((uint8_t *)targetBuffer) + sizeof(dataBlockHeader);
+    size_t targetBufferSize = destinationBuffer.size() - sizeof(dataBlockHeader);
+
+    if (compressionMethod == CompressionMethod::Zip)
+    {
+      unsigned long compressedSize = (unsigned long)targetBufferSize;
+      int status = compress((uint8_t *)targetBuffer, &compressedSize, tmpdata.get(), tmpbuffersize);
+      destinationBuffer.resize(compressedSize + sizeof(dataBlockHeader));
+
+      if (status != Z_OK)
+      {
+        throw std::runtime_error("zlib compression failed");
+      }
+    }
+#ifndef OPENVDS_NO_ZSTD
+    else if (compressionMethod == CompressionMethod::Zstd)
+    {
+      // The compression tolerance is the zstd compression level, 0 is the zstd default level
+      size_t compressedSize = ZSTD_compress(targetBuffer, targetBufferSize, tmpdata.get(), tmpbuffersize, int(compressionTolerance));
+
+      if (ZSTD_isError(compressedSize))
+      {
+        throw std::runtime_error(fmt::format("zstd compression failed: {}", ZSTD_getErrorName(compressedSize)));
+      }
+      destinationBuffer.resize(compressedSize + sizeof(dataBlockHeader));
+    }
+#endif
+#ifndef OPENVDS_NO_LZ4
+    else if (compressionMethod == CompressionMethod::LZ4)
+    {
+      int compressedSize = LZ4_compress_default((const char *)tmpdata.get(), (char *)targetBuffer, int(tmpbuffersize), int(targetBufferSize));
+
+      if (compressedSize <= 0)
+      {
+        throw std::runtime_error("LZ4 compression failed");
+      }
+      destinationBuffer.resize(compressedSize + sizeof(dataBlockHeader));
+    }
+#endif
+    else
+    {
+      throw std::runtime_error("Compression method is not supported by this build of OpenVDS");
+    }
+    break;
+  }
+  case CompressionMethod::RLE:
   {
     uint32_t tmpbuffersize = GetByteSize(dataBlock);
     std::unique_ptr<uint8_t[]> tmpdata(new uint8_t[tmpbuffersize]);
@@ -640,14 +864,40 @@ VolumeDataStore::SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlo
     void *targetBuffer = destinationBuffer.data();
     memcpy(targetBuffer, &dataBlockHeader, sizeof(dataBlockHeader));
     targetBuffer = ((uint8_t *)targetBuffer) + sizeof(dataBlockHeader);
-    unsigned long compressedSize = (unsigned long)destinationBuffer.size();
-    int status = compress((uint8_t *)targetBuffer, &compressedSize, tmpdata.get(), tmpbuffersize);
+
+    int32_t rleUnitSize = dataBlock.Format == VolumeDataChannelDescriptor::Format_1Bit ? 1 : GetVoxelFormatByteSize(dataBlock.Format);
+    int32_t compressedSize = RleCompress((uint8_t *)targetBuffer, int32_t(destinationBuffer.size() - sizeof(dataBlockHeader)), tmpdata.get(), int32_t(tmpbuffersize), rleUnitSize);
+
+    if (compressedSize < 0)
+    {
+      throw std::runtime_error("RLE compression failed");
+    }
     destinationBuffer.resize(compressedSize + sizeof(dataBlockHeader));
+    break;
+  }
+  case CompressionMethod::Wavelet:
+  case CompressionMethod::WaveletLossless:
+  {
+    auto& layer = *chunk.layer;
+    uint32_t tmpbuffersize = GetByteSize(dataBlock);
+    std::unique_ptr<uint8_t[]> tmpdata(new uint8_t[tmpbuffersize]);
+    bool isConstant = CopyDataBlockIntoLinearBuffer(dataBlock, chunkData.data(), tmpdata.get(), tmpbuffersize);
+
+    if (isConstant)
+    {
+      destinationBuffer.resize(0);
+      return GetConstantValueVolumeDataHash(dataBlock, tmpdata.get(), layer.GetValueRange(), layer.GetIntegerScale(), layer.GetIntegerOffset(), layer.IsUseNoValue(), layer.GetNoValue());
+    }
 
-    if (status != Z_OK)
+    int adaptiveLevelSizes[WAVELET_ADAPTIVE_LEVELS];
+    Error error;
+    if (!Wavelet_Compress(dataBlock, chunkData.data(), layer.GetValueRange(), layer.IsUseNoValue(), layer.GetNoValue(), compressionTolerance, compressionMethod == CompressionMethod::WaveletLossless, destinationBuffer, adaptiveLevelSizes, error))
     {
-      throw std::runtime_error("zlib compression failed");
+      throw std::runtime_error(error.string);
     }
+    uint8_t levels[WAVELET_ADAPTIVE_LEVELS];
+    Wavelet_EncodeAdaptiveLevelsMetadata(int32_t(destinationBuffer.size()), adaptiveLevelSizes, levels);
+    adaptiveLevels.assign(levels, levels + WAVELET_ADAPTIVE_LEVELS);
     break;
   }
   default:
@@ -659,7 +909,20 @@ VolumeDataStore::SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlo
 bool
 VolumeDataStore::IsCompressionMethodSupported(CompressionMethod compressionMethod)
 {
-  return !CompressionMethod_IsWavelet(compressionMethod);
+#ifdef OPENVDS_NO_ZSTD
+  if (compressionMethod == CompressionMethod::Zstd)
+  {
+    return false;
+  }
+#endif
+#ifdef OPENVDS_NO_LZ4
+  if (compressionMethod == CompressionMethod::LZ4)
+  {
+    return false;
+  }
+#endif
+  return compressionMethod != CompressionMethod::WaveletNormalizeBlock &&
+         compressionMethod != CompressionMethod::WaveletNormalizeBlockLossless;
 }
 
 }
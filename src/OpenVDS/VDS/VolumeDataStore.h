@@ -59,6 +59,8 @@ public:
   virtual bool          PrepareReadChunk(const VolumeDataChunk &volumeDataChunk, int adaptiveLevel, Error &error) = 0;
   virtual bool          ReadChunk(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, std::vector<uint8_t>& metadata, CompressionInfo& compressionInfo, Error& error) = 0;
   virtual bool          CancelReadChunk(const VolumeDataChunk& chunk, Error& error) = 0;
+  // Extend serialized data read for a coarser adaptive level with the remaining bytes needed for a finer adaptive level, without reading the bytes that are already present
+  virtual bool          ReadChunkRefinement(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, Error& error) = 0;
   virtual bool          WriteChunk(const VolumeDataChunk& chunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata) = 0;
   virtual bool          Flush(bool writeUpdatedLayerStatus) = 0;
   virtual bool          ReadSerializedVolumeDataLayout(std::vector<uint8_t>& serializedVolumeDataLayout, Error &error) = 0;
@@ -67,13 +69,22 @@ public:
   virtual bool          RemoveLayer(VolumeDataLayer* volumeDataLayer) = 0;
 
   bool DeserializeVolumeData(const VolumeDataChunk &volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, CompressionMethod compressionMethod, int32_t adaptiveLevel, VolumeDataChannelDescriptor::Format loadFormat, DataBlock &dataBlock, std::vector<uint8_t>& target, Error& error);
+  // Deserialize into a buffer laid out as a linear data block without padding, which fails if the data block is not linear or the buffer is too small
+  bool DeserializeVolumeData(const VolumeDataChunk &volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, CompressionMethod compressionMethod, int32_t adaptiveLevel, VolumeDataChannelDescriptor::Format loadFormat, DataBlock &dataBlock, void* target, int64_t targetSize, Error& error);
 
+  // The number of bytes from the start of a wavelet adaptive chunk that are needed to decode an adaptive level, or the size of the serialized data if the chunk is not wavelet adaptive
+  static int64_t GetAdaptiveLevelDataSize(const VolumeDataChunk& volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, int32_t adaptiveLevel);
   static bool Verify(const VolumeDataChunk& volumeDataChunk, const std::vector<uint8_t>& serializedData, CompressionMethod compressionMethod, bool isFullyRead);
   static bool CreateConstantValueDataBlock(VolumeDataChunk const &volumeDataChunk, VolumeDataChannelDescriptor::Format format, float noValue, VolumeDataChannelDescriptor::Components components, VolumeDataHash const &constantValueVolumeDataHash, DataBlock &dataBlock, std::vector<uint8_t> &buffer, Error &error);
   static uint64_t
-              SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlock &dataBlock, const std::vector<uint8_t>& chunkData, CompressionMethod compressionMethod, float compressionTolerance, std::vector<uint8_t>& destinationBuffer);
+              SerializeVolumeData(const VolumeDataChunk& chunk, const DataBlock &dataBlock, const std::vector<uint8_t>& chunkData, CompressionMethod compressionMethod, float compressionTolerance, std::vector<uint8_t>& destinationBuffer, std::vector<uint8_t>& adaptiveLevels);
   static bool IsCompressionMethodSupported(CompressionMethod compressionMethod);
 
+  GlobalStateVds &      GetGlobalStateVds() { return m_globalStateVds; }
+
+private:
+  bool DeserializeVolumeData(const VolumeDataChunk &volumeDataChunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, CompressionMethod compressionMethod, int32_t adaptiveLevel, VolumeDataChannelDescriptor::Format loadFormat, DataBlock &dataBlock, std::vector<uint8_t>* targetVector, void* targetBuffer, int64_t targetBufferSize, Error& error);
+
 protected:
   GlobalStateVds        m_globalStateVds; 
 };
@@ -152,6 +152,12 @@ public:
   {
     m_error = error;
   }
+
+  // The chunk metadata from the metadata page has the hash of the chunk, so a cached chunk that has been rewritten since is not used
+  std::string ExpectedVersion() const override
+  {
+    return std::string(m_metadataFromPage.begin(), m_metadataFromPage.end());
+  }
   
   CompressionInfo m_compressionInfo;
 
@@ -521,6 +527,55 @@ bool VolumeDataStoreIOManager::ReadChunk(const VolumeDataChunk &chunk, int adapt
   }
 
   compressionInfo = transferHandler->m_compressionInfo;
+
+  // The transfer can have been started for a different adaptive level by another reader of the same chunk
+  if (CompressionMethod_IsWavelet(compressionInfo.GetCompressionMethod()) && compressionInfo.GetAdaptiveLevel() != adaptiveLevel)
+  {
+    compressionInfo = CompressionInfo(compressionInfo.GetCompressionMethod(), compressionInfo.GetTolerance(), adaptiveLevel);
+
+    if (!ReadChunkRefinement(chunk, adaptiveLevel, serializedData, metadata, error))
+    {
+      compressionInfo = CompressionInfo();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool VolumeDataStoreIOManager::ReadChunkRefinement(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, Error& error)
+{
+  int64_t refinedSize = GetAdaptiveLevelDataSize(chunk, serializedData, metadata, adaptiveLevel);
+
+  if (refinedSize <= int64_t(serializedData.size()))
+  {
+    return true;
+  }
+
+  std::string url = CreateUrlForChunk(GetLayerName(*chunk.layer), chunk.index);
+  auto transferHandler = std::make_shared<ReadChunkTransfer>(CompressionInfo(), std::vector<uint8_t>());
+
+  // Only read the bytes following the data we already have
+  auto request = m_ioManager->ReadObject(url, transferHandler, { int64_t(serializedData.size()), refinedSize - 1 });
+
+  if (!request->WaitForFinish(error))
+    return false;
+
+  if (transferHandler->m_error.code)
+  {
+    error = transferHandler->m_error;
+    return false;
+  }
+
+  if (int64_t(transferHandler->m_data.size()) != refinedSize - int64_t(serializedData.size()))
+  {
+    error.string = fmt::format("Unexpected size {} of refinement for chunk {}", transferHandler->m_data.size(), url);
+    error.code = -1;
+    return false;
+  }
+
+  m_globalStateVds.addDownload(transferHandler->m_data.size());
+  serializedData.insert(serializedData.end(), transferHandler->m_data.begin(), transferHandler->m_data.end());
   return true;
 }
 
@@ -122,6 +122,7 @@ public:
   bool          PrepareReadChunk(const VolumeDataChunk &volumeDataChunk, int adaptiveLevel, Error &error) override;
   bool          ReadChunk(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, std::vector<uint8_t>& metadata, CompressionInfo& compressionInfo, Error& error) override;
   bool          CancelReadChunk(const VolumeDataChunk& chunk, Error& error) override;
+  bool          ReadChunkRefinement(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, Error& error) override;
   bool          WriteChunk(const VolumeDataChunk& chunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata) override;
   bool          Flush(bool writeUpdatedLayerStatus) override;
   bool          ReadSerializedVolumeDataLayout(std::vector<uint8_t>& serializedVolumeDataLayout, Error &error) override;
@@ -76,8 +76,140 @@ VolumeDataStoreVDSFile::LayerFile *VolumeDataStoreVDSFile::GetLayerFile(std::str
   return (layerFileIterator != m_layerFiles.end()) ? const_cast<VolumeDataStoreVDSFile::LayerFile *>(&layerFileIterator->second) : nullptr;
 }
 
-bool VolumeDataStoreVDSFile::PrepareReadChunk(const VolumeDataChunk &volumeDataChunk, int adaptiveLevel, Error &error)
+// The buffer may point into a mapping of the file, so it is copied by the data store which fails instead of crashing if the file can't be read
+static bool AppendBufferData(HueBulkDataStore &dataStore, HueBulkDataStore::Buffer const *buffer, std::vector<uint8_t> &serializedData)
 {
+  size_t offset = serializedData.size();
+  serializedData.resize(offset + buffer->Size());
+  if(!dataStore.CopyBufferData(buffer, 0, buffer->Size(), serializedData.data() + offset))
+  {
+    serializedData.resize(offset);
+    return false;
+  }
+  return true;
+}
+
+// A read of the chunk data that was started by PrepareReadChunk. It is shared by everyone who prepared the chunk, the
+// first one to need the data waits for the read and the others get the same buffer.
+struct VolumeDataStoreVDSFile::PendingChunkRead
+{
+  HueBulkDataStore &dataStore;
+  HueBulkDataStore::ReadRequest *readRequest;
+  HueBulkDataStore::Buffer *buffer;
+  std::string errorMessage;
+  std::vector<uint8_t> metadata;
+  int adaptiveLevel;
+  std::mutex mutex;
+
+  PendingChunkRead(HueBulkDataStore &dataStore, int adaptiveLevel) : dataStore(dataStore), readRequest(nullptr), buffer(nullptr), adaptiveLevel(adaptiveLevel) {}
+
+  ~PendingChunkRead()
+  {
+    if(readRequest) dataStore.CancelReadChunkData(readRequest);
+    if(buffer) HueBulkDataStore::ReleaseBuffer(buffer);
+  }
+
+  HueBulkDataStore::Buffer *WaitForBuffer()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if(readRequest)
+    {
+      buffer = dataStore.WaitForChunkData(readRequest);
+      readRequest = nullptr;
+      if(!buffer) errorMessage = dataStore.GetErrorMessage();
+    }
+    return buffer;
+  }
+};
+
+bool VolumeDataStoreVDSFile::PrepareReadChunk(const VolumeDataChunk &chunk, int adaptiveLevel, Error &error)
+{
+  assert(chunk.layer);
+  LayerFile* layerFile = GetLayerFile(*chunk.layer);
+
+  // Chunks we can't start reading here are read synchronously by ReadChunk, which also reports any errors
+  if(!layerFile)
+  {
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  auto pendingReadIterator = m_pendingReads.find(chunk);
+  if(pendingReadIterator != m_pendingReads.end())
+  {
+    pendingReadIterator->second.ref++;
+    return true;
+  }
+
+  HueBulkDataStore::FileInterface *fileInterface = layerFile->fileInterface;
+
+  auto chunkRead = std::make_shared<PendingChunkRead>(*m_dataStore, adaptiveLevel);
+  chunkRead->metadata.resize(fileInterface->GetChunkMetadataLength());
+  IndexEntry indexEntry;
+
+  if(!fileInterface->ReadIndexEntry((int)chunk.index, &indexEntry, chunkRead->metadata.data()) || indexEntry.m_length == 0)
+  {
+    return true;
+  }
+
+  if(layerFile->layerChunksWaveletAdaptive)
+  {
+    assert(chunkRead->metadata.size() == sizeof(VDSWaveletAdaptiveLevelsChunkMetadata));
+    auto waveletAdaptiveLevelsChunkMetadata = reinterpret_cast<VDSWaveletAdaptiveLevelsChunkMetadata *>(chunkRead->metadata.data());
+    indexEntry.m_length = Wavelet_DecodeAdaptiveLevelsMetadata(indexEntry.m_length, adaptiveLevel, waveletAdaptiveLevelsChunkMetadata->m_levels);
+  }
+
+  chunkRead->readRequest = m_dataStore->ReadChunkDataAsync(indexEntry);
+
+  if(chunkRead->readRequest)
+  {
+    m_pendingReads.emplace(chunk, PendingRead(chunkRead));
+  }
+
+  return true;
+}
+
+bool VolumeDataStoreVDSFile::ReadPendingChunk(const VolumeDataChunk& chunk, LayerFile *layerFile, PendingChunkRead &pendingChunkRead, int adaptiveLevel, std::vector<uint8_t>& serializedData, std::vector<uint8_t>& metadata, CompressionInfo& compressionInfo, Error& error)
+{
+  HueBulkDataStore::Buffer *buffer = pendingChunkRead.WaitForBuffer();
+
+  if(!buffer)
+  {
+    error.code = -1;
+    error.string = pendingChunkRead.errorMessage;
+    compressionInfo = CompressionInfo();
+    return false;
+  }
+
+  m_globalStateVds.addDownload(buffer->Size());
+  serializedData.clear();
+  if(!AppendBufferData(*m_dataStore, buffer, serializedData))
+  {
+    error.code = -1;
+    error.string = m_dataStore->GetErrorMessage();
+    compressionInfo = CompressionInfo();
+    return false;
+  }
+  metadata = pendingChunkRead.metadata;
+
+  // The read may have been started for another adaptive level, the coarser levels are a prefix of the finer levels
+  if(layerFile->layerChunksWaveletAdaptive && pendingChunkRead.adaptiveLevel != adaptiveLevel)
+  {
+    int64_t adaptiveLevelSize = GetAdaptiveLevelDataSize(chunk, serializedData, metadata, adaptiveLevel);
+
+    if(adaptiveLevelSize < int64_t(serializedData.size()))
+    {
+      serializedData.resize(size_t(adaptiveLevelSize));
+    }
+    else if(!ReadChunkRefinement(chunk, adaptiveLevel, serializedData, metadata, error))
+    {
+      compressionInfo = CompressionInfo();
+      return false;
+    }
+  }
+
+  compressionInfo = CompressionInfo(CompressionMethod(layerFile->layerMetadata.m_compressionMethod), layerFile->layerMetadata.m_compressionTolerance, adaptiveLevel);
   return true;
 }
 
@@ -97,6 +229,20 @@ bool VolumeDataStoreVDSFile::ReadChunk(const VolumeDataChunk& chunk, int adaptiv
   }
 
   std::unique_lock<std::mutex> lock(m_mutex);
+
+  auto pendingReadIterator = m_pendingReads.find(chunk);
+  if(pendingReadIterator != m_pendingReads.end())
+  {
+    std::shared_ptr<PendingChunkRead> chunkRead = pendingReadIterator->second.chunkRead;
+    if(--pendingReadIterator->second.ref == 0)
+    {
+      m_pendingReads.erase(pendingReadIterator);
+    }
+    lock.unlock();
+
+    return ReadPendingChunk(chunk, layerFile, *chunkRead, adaptiveLevel, serializedData, metadata, compressionInfo, error);
+  }
+
   HueBulkDataStore::FileInterface *fileInterface = layerFile->fileInterface;
 
   metadata.resize(fileInterface->GetChunkMetadataLength());
@@ -121,8 +267,8 @@ bool VolumeDataStoreVDSFile::ReadChunk(const VolumeDataChunk& chunk, int adaptiv
       if(buffer)
       {
         m_globalStateVds.addDownload(buffer->Size());
-        auto bufferData = reinterpret_cast<const uint8_t *>(buffer->Data());
-        serializedData.assign(bufferData, bufferData + buffer->Size());
+        serializedData.clear();
+        success = AppendBufferData(*m_dataStore, buffer, serializedData);
         m_dataStore->ReleaseBuffer(buffer);
       }
       else
@@ -148,9 +294,86 @@ bool VolumeDataStoreVDSFile::ReadChunk(const VolumeDataChunk& chunk, int adaptiv
 
 bool VolumeDataStoreVDSFile::CancelReadChunk(const VolumeDataChunk& chunk, Error& error)
 {
+  // Released after unlocking, since dropping the last reference waits for the read to finish
+  std::shared_ptr<PendingChunkRead> chunkRead;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  auto pendingReadIterator = m_pendingReads.find(chunk);
+  if(pendingReadIterator != m_pendingReads.end() && --pendingReadIterator->second.ref == 0)
+  {
+    chunkRead = std::move(pendingReadIterator->second.chunkRead);
+    m_pendingReads.erase(pendingReadIterator);
+  }
+
+  lock.unlock();
   return true;
 }
 
+bool VolumeDataStoreVDSFile::ReadChunkRefinement(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, Error& error)
+{
+  int64_t refinedSize = GetAdaptiveLevelDataSize(chunk, serializedData, metadata, adaptiveLevel);
+
+  if(refinedSize <= int64_t(serializedData.size()))
+  {
+    return true;
+  }
+
+  assert(chunk.layer);
+  LayerFile* layerFile = GetLayerFile(*chunk.layer);
+
+  if(!layerFile)
+  {
+    error.code = -1;
+    error.string = "Trying to read from a layer that has not been added";
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  HueBulkDataStore::FileInterface *fileInterface = layerFile->fileInterface;
+
+  std::vector<uint8_t> indexMetadata(fileInterface->GetChunkMetadataLength());
+  IndexEntry indexEntry;
+
+  bool success = fileInterface->ReadIndexEntry((int)chunk.index, &indexEntry, indexMetadata.data());
+  lock.unlock();
+
+  if(success && refinedSize > indexEntry.m_length)
+  {
+    error.code = -1;
+    error.string = fmt::format("Refinement of chunk {}/{} is larger than the chunk", GetLayerName(*chunk.layer), chunk.index);
+    return false;
+  }
+
+  if(success)
+  {
+    // Only read the bytes following the data we already have
+    indexEntry.m_offset += serializedData.size();
+    indexEntry.m_length = int32_t(refinedSize - int64_t(serializedData.size()));
+
+    HueBulkDataStore::Buffer *buffer = m_dataStore->ReadChunkData(indexEntry);
+
+    if(buffer)
+    {
+      m_globalStateVds.addDownload(buffer->Size());
+      success = AppendBufferData(*m_dataStore, buffer, serializedData);
+      m_dataStore->ReleaseBuffer(buffer);
+    }
+    else
+    {
+      success = false;
+    }
+  }
+
+  if(!success)
+  {
+    error.code = -1;
+    error.string = m_dataStore->GetErrorMessage();
+  }
+
+  return success;
+}
+
 bool VolumeDataStoreVDSFile::WriteChunk(const VolumeDataChunk& chunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata)
 {
   Error error = Error();
@@ -306,6 +529,8 @@ bool VolumeDataStoreVDSFile::ReadSerializedVolumeDataLayout(std::vector<uint8_t>
     serializedVolumeDataLayout.assign(data, data + buffer->Size());
   }
 
+  m_vds.producedLODMasks.assign(int(Dimensions_45) + 1, 0);
+
   for(auto &layerFileEntry : m_layerFiles)
   {
     LayerFile *layerFile = &layerFileEntry.second;
@@ -343,6 +568,11 @@ bool VolumeDataStoreVDSFile::ReadSerializedVolumeDataLayout(std::vector<uint8_t>
     {
       m_vds.produceStatuses[dimensionsND] = VolumeDataLayer::ProduceStatus_Normal;
     }
+
+    if (lod < 32)
+    {
+      m_vds.producedLODMasks[dimensionsND] |= 1u << lod;
+    }
   }
 
   return true;
@@ -25,6 +25,8 @@
 #include "MetadataManager.h"
 #include "VolumeDataStore.h"
 
+#include <map>
+#include <memory>
 #include <mutex>
 
 namespace OpenVDS
@@ -45,6 +47,17 @@ class VolumeDataStoreVDSFile : public VolumeDataStore, public LayerMetadataConta
     {}
   };
 
+  struct PendingChunkRead;
+
+  struct PendingRead
+  {
+    std::shared_ptr<PendingChunkRead> chunkRead;
+    int ref;
+
+    PendingRead() : ref(0) {}
+    explicit PendingRead(std::shared_ptr<PendingChunkRead> chunkRead) : chunkRead(chunkRead), ref(1) {}
+  };
+
   VDS &m_vds;
 
   mutable std::mutex m_mutex;
@@ -53,12 +66,15 @@ class VolumeDataStoreVDSFile : public VolumeDataStore, public LayerMetadataConta
   bool m_isVolumeDataLayoutFilePresent;
   std::map<std::string, LayerFile> m_layerFiles;
   std::unique_ptr<HueBulkDataStore, void (*)(HueBulkDataStore *)> m_dataStore;
+  std::map<VolumeDataChunk, PendingRead> m_pendingReads; // Declared after the data store so the reads are finished before it is closed
 
   std::vector<uint8_t> ParseVDSObject(std::string const &parseString);
 
   LayerFile *GetLayerFile(std::string const &layerName) const;
   LayerFile *GetLayerFile(const VolumeDataLayer &volumeDataLayer) const { return GetLayerFile(GetLayerName(volumeDataLayer)); }
 
+  bool ReadPendingChunk(const VolumeDataChunk& chunk, LayerFile *layerFile, PendingChunkRead &pendingChunkRead, int adaptiveLevel, std::vector<uint8_t>& serializedData, std::vector<uint8_t>& metadata, CompressionInfo& compressionInfo, Error& error);
+
 public:
   enum Mode
   {
@@ -72,6 +88,7 @@ public:
   bool          PrepareReadChunk(const VolumeDataChunk &volumeDataChunk, int adaptiveLevel, Error &error) override;
   bool          ReadChunk(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, std::vector<uint8_t>& metadata, CompressionInfo& compressionInfo, Error& error) override;
   bool          CancelReadChunk(const VolumeDataChunk& chunk, Error& error) override;
+  bool          ReadChunkRefinement(const VolumeDataChunk& chunk, int adaptiveLevel, std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata, Error& error) override;
   bool          WriteChunk(const VolumeDataChunk& chunk, const std::vector<uint8_t>& serializedData, const std::vector<uint8_t>& metadata) override;
   bool          Flush(bool writeUpdatedLayerStatus) override;
   bool          ReadSerializedVolumeDataLayout(std::vector<uint8_t>& serializedVolumeDataLayout, Error &error) override;
@@ -16,9 +16,14 @@
 ****************************************************************************/
 
 #include "VolumeDataStore.h"
+#include "VolumeDataSampleKernels.h"
+#include "ThreadPool.h"
 #include "Wavelet.h"
 
 #include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include "WaveletAdaptiveLL.h"
 
@@ -29,6 +34,7 @@
 
 #define WAVELET_SSE_THREADS 4 //Number of streams packed/unpacked for bitencoding/decoding
 #define WAVELET_MAX_DIMENSION_SIZE 4096
+#define WAVELET_PARALLEL_TRANSFORM_MIN_SIZE (64 * 64 * 64) // Smaller bands are transformed on the decoding thread only
 
 #define RLE_BYTE_MASK 0
 #define RLE_2BYTE_MASK 1
@@ -38,37 +44,36 @@
 namespace OpenVDS
 {
 
-template<typename T>
-void convertFloatToIntegerType(const DataBlock &sourceDataBlock, const std::vector<uint8_t> &sourceData, const DataBlock &targetDataBlock, std::vector<uint8_t> &targetData)
+WaveletArena &WaveletArena::ThreadArena()
 {
-  assert(sourceDataBlock.Format == VolumeDataChannelDescriptor::Format_R32);
-
-  int32_t sourceSizeX = sourceDataBlock.Size[0];
-  int32_t sourceSizeY = sourceDataBlock.Size[1];
-  int32_t sourceSizeZ = sourceDataBlock.Size[2];
-  int32_t sourceAllocatedSizeX = sourceDataBlock.AllocatedSize[0];
-  int32_t sourceAllocatedSizeY = sourceDataBlock.AllocatedSize[1];
-  uint32_t sourceElementSize = GetElementSize(sourceDataBlock);
-
-  int32_t targetAllocatedSizeX = targetDataBlock.AllocatedSize[0];
-  int32_t targetAllocatedSizeY = targetDataBlock.AllocatedSize[1];
-  uint32_t targetElementSize = GetElementSize(targetDataBlock);
+  static thread_local WaveletArena arena;
+  return arena;
+}
 
-  for (int32_t iZ = 0; iZ < sourceSizeZ; iZ++)
+template<typename T>
+static void convertFloatToIntegerType(const DataBlock &dataBlock, const float *source, uint8_t *targetData)
+{
+  for (int32_t iZ = 0; iZ < dataBlock.Size[2]; iZ++)
   {
-    for (int32_t iY = 0; iY < sourceSizeY; iY++)
+    for (int32_t iY = 0; iY < dataBlock.Size[1]; iY++)
     {
-      T* target = reinterpret_cast<T*>(targetData.data() + (iZ * targetAllocatedSizeY * targetAllocatedSizeX + iY * targetAllocatedSizeX) * targetElementSize);
-      const float * source = reinterpret_cast<const float *>(sourceData.data() + (iZ * sourceAllocatedSizeY * sourceAllocatedSizeX + iY * sourceAllocatedSizeX) * sourceElementSize);
-      for (int32_t iX = 0; iX < sourceSizeX; iX++, target++, source++)
+      int64_t offset = int64_t(iZ) * dataBlock.Pitch[2] + int64_t(iY) * dataBlock.Pitch[1];
+      T *target = reinterpret_cast<T *>(targetData) + offset;
+      const float *sourceRow = source + offset;
+      for (int32_t iX = 0; iX < dataBlock.Size[0]; iX++)
       {
-        *target = T(*source);
+        // Lossy compression can reconstruct values just outside the range of the integer type
+        float value = sourceRow[iX];
+        target[iX] = !(value > 0.0f) ? T(0) : value >= float(std::numeric_limits<T>::max()) ? std::numeric_limits<T>::max() : T(value);
       }
     }
   }
 }
 
-bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataSize, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool isNormalize, int nDecompressLevel, bool isLossless, DataBlock &dataBlock, std::vector<uint8_t> &target, Error &error)
+// The target is either a vector that is resized to the allocated size of the data block, or a buffer that receives a linear data block.
+// R32 data is decoded directly into the target when it has room for the allocated data block, anything else is decoded into the
+// arena of the thread and written to the target in the format of the data block in a single pass.
+static bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataSize, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool isNormalize, int nDecompressLevel, bool isLossless, DataBlock &dataBlock, std::vector<uint8_t> *targetVector, void *targetBuffer, int64_t targetBufferSize, Error &error)
 {
   if (isLossless)
   {
@@ -103,11 +108,37 @@ bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataS
     return false;
   }
 
-  if (!InitializeDataBlock(VolumeDataChannelDescriptor::Format_R32, VolumeDataChannelDescriptor::Components_1, (enum DataBlock::Dimensionality)(dimensions), createSize, dataBlock, error))
+  if (dataBlockFormat != VolumeDataChannelDescriptor::Format_U8 && dataBlockFormat != VolumeDataChannelDescriptor::Format_U16)
+  {
+    dataBlockFormat = VolumeDataChannelDescriptor::Format_R32;
+  }
+
+  if (!InitializeDataBlock(dataBlockFormat, VolumeDataChannelDescriptor::Components_1, (enum DataBlock::Dimensionality)(dimensions), createSize, dataBlock, error))
     return false;
-  target.resize(GetAllocatedByteSize(dataBlock));
-  
-  Wavelet wavelet(integerInfo, compressedData,
+
+  uint8_t *target;
+  if (targetVector)
+  {
+    targetVector->resize(GetAllocatedByteSize(dataBlock));
+    target = targetVector->data();
+  }
+  else
+  {
+    if (!IsDataBlockLinear(dataBlock) || int64_t(GetByteSize(dataBlock)) > targetBufferSize)
+    {
+      error.code = -1;
+      error.string = "The destination buffer does not match the layout of the deserialized data block";
+      return false;
+    }
+    target = static_cast<uint8_t *>(targetBuffer);
+  }
+
+  WaveletArena &arena = WaveletArena::ThreadArena();
+
+  bool isDecodeIntoTarget = dataBlock.Format == VolumeDataChannelDescriptor::Format_R32 && (targetVector || int64_t(GetAllocatedByteSize(dataBlock)) <= targetBufferSize);
+  float *picture = isDecodeIntoTarget ? reinterpret_cast<float *>(target) : arena.picture.Get(size_t(dataBlock.AllocatedSize[0]) * dataBlock.AllocatedSize[1] * dataBlock.AllocatedSize[2]);
+
+  Wavelet wavelet(arena, integerInfo, compressedData,
     dataBlock.Size[0],
     dataBlock.Size[1],
     dataBlock.Size[2],
@@ -134,32 +165,38 @@ bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataS
 
   bool isAnyNoValue;
 
-  if (!wavelet.DeCompress(true, -1, -1, -1, &startThreshold, &threshold, dataBlock.Format, valueRange, integerScale, integerOffset, isUseNoValue, noValue, &isAnyNoValue, &waveletNoValue, isNormalize, nDecompressLevel, isLossless, nCompressedAdaptiveDataSize, dataBlock, target, error))
+  if (!wavelet.DeCompress(true, -1, -1, -1, &startThreshold, &threshold, VolumeDataChannelDescriptor::Format_R32, valueRange, integerScale, integerOffset, isUseNoValue, noValue, &isAnyNoValue, &waveletNoValue, isNormalize, nDecompressLevel, isLossless, nCompressedAdaptiveDataSize, picture, error))
     return false;
 
-  if (dataBlock.Format != dataBlockFormat)
+  if (!isDecodeIntoTarget)
   {
-    DataBlock finalDataBlock;
-    if (!InitializeDataBlock(dataBlockFormat, VolumeDataChannelDescriptor::Components_1, (enum DataBlock::Dimensionality)(dimensions), createSize, finalDataBlock, error))
-      return false;
-    std::vector<uint8_t> finalDataTarget;
-    finalDataTarget.resize(GetAllocatedByteSize(finalDataBlock));
-
-    if (finalDataBlock.Format == VolumeDataChannelDescriptor::Format_U8)
+    if (dataBlock.Format == VolumeDataChannelDescriptor::Format_U8)
     {
-      convertFloatToIntegerType<uint8_t>(dataBlock, target, finalDataBlock, finalDataTarget);
+      convertFloatToIntegerType<uint8_t>(dataBlock, picture, target);
+    }
+    else if (dataBlock.Format == VolumeDataChannelDescriptor::Format_U16)
+    {
+      convertFloatToIntegerType<uint16_t>(dataBlock, picture, target);
     }
     else
     {
-      convertFloatToIntegerType<uint16_t>(dataBlock, target, finalDataBlock, finalDataTarget);
+      memcpy(target, picture, GetByteSize(dataBlock));
     }
-    target = std::move(finalDataTarget);
-    dataBlock = finalDataBlock;
   }
 
   return true;
 }
 
+bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataSize, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool isNormalize, int nDecompressLevel, bool isLossless, DataBlock &dataBlock, std::vector<uint8_t> &target, Error &error)
+{
+  return Wavelet_Decompress(compressedData, nCompressedAdaptiveDataSize, dataBlockFormat, valueRange, integerScale, integerOffset, isUseNoValue, noValue, isNormalize, nDecompressLevel, isLossless, dataBlock, &target, nullptr, 0, error);
+}
+
+bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataSize, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool isNormalize, int nDecompressLevel, bool isLossless, DataBlock &dataBlock, void *target, int64_t targetSize, Error &error)
+{
+  return Wavelet_Decompress(compressedData, nCompressedAdaptiveDataSize, dataBlockFormat, valueRange, integerScale, integerOffset, isUseNoValue, noValue, isNormalize, nDecompressLevel, isLossless, dataBlock, nullptr, target, targetSize, error);
+}
+
 
 static int32_t findTransformMethod(IntVector3 (&bandSize)[TRANSFORM_MAX_ITERATIONS + 1], int32_t(&splitMask)[TRANSFORM_MAX_ITERATIONS], int32_t sizeX, int32_t sizeY, int32_t sizeZ, int32_t dataVersion)
 {
@@ -421,11 +458,18 @@ static int CalculateBufferSizeNeeded(int maxPixels, int maxChildren)
   return size;
 }
 
-Wavelet::Wavelet(uint32_t integerInfo, const void *compressedData, int32_t transformSizeX, int32_t transformSizeY, int32_t transformSizeZ, int32_t allocatedSizeX, int32_t allocatedSizeY, int32_t allocatedSizeZ, int32_t dimensions, int32_t dataVersion)
+static size_t BandVolume(const IntVector3 &bandSize)
+{
+  return size_t(bandSize[0]) * bandSize[1] * bandSize[2];
+}
+
+Wavelet::Wavelet(WaveletArena &arena, uint32_t integerInfo, const void *compressedData, int32_t transformSizeX, int32_t transformSizeY, int32_t transformSizeZ, int32_t allocatedSizeX, int32_t allocatedSizeY, int32_t allocatedSizeZ, int32_t dimensions, int32_t dataVersion)
+  : m_arena(arena)
 {
   m_readCompressedData = (const uint32_t *)compressedData;
   m_noValueData = nullptr;
   m_integerInfo =  integerInfo;
+  m_isAVX2 = SampleKernels::SupportedInstructionSet() == SampleKernels::InstructionSet::AVX2;
   m_dataVersion = dataVersion;
   m_dimensions = dimensions;
 
@@ -453,14 +497,9 @@ Wavelet::Wavelet(uint32_t integerInfo, const void *compressedData, int32_t trans
   m_allocatedHalfSizeY = m_bandSize[1][1];
   m_allocatedHalfSizeZ = m_bandSize[1][2];
 
-  m_maxTree.reset(new float[m_allocatedHalfSizeX * m_allocatedHalfSizeY * m_allocatedHalfSizeZ]);
-  m_maxTreeMaxOnly.reset(new float[m_allocatedHalfSizeX * m_allocatedHalfSizeY * m_allocatedHalfSizeZ]);
-  m_tempEncodeDecodeBuffer.reset(new int[(16*16*16*2) + m_allocatedSizeX * m_allocatedSizeY * m_allocatedSizeZ]);
-
-  int allocSize = 256 * 256 * 7;
-  m_pixelSetPixelSignificant.reset(new Wavelet_PixelSetPixel[allocSize]);
-  m_pixelSetPixelInSignificant.reset(new Wavelet_PixelSetPixel[allocSize]);
-  m_pixelSetChildren.reset(new Wavelet_PixelSetChildren[allocSize]);
+  // InitCoder creates children for the sub-bands of the last transform iteration and pixels for the band below them
+  m_pixelSetChildren = m_arena.pixelSetChildren.Get(m_transformIterations > 1 ? BandVolume(m_bandSize[m_transformIterations - 1]) : 1);
+  m_pixelSetPixelInSignificant = m_arena.pixelSetPixelInSignificant.Get(BandVolume(m_bandSize[m_transformIterations == 1 ? 0 : m_transformIterations]));
 }
 
 static inline void CreatePixelSetChildren(Wavelet_PixelSetChildren *pixelSet, uint32_t iX, uint32_t iY, uint32_t iZ,  uint32_t uTransformIteration, int32_t iSubBand)
@@ -482,7 +521,6 @@ static inline void CreatePixelSetPixel(Wavelet_PixelSetPixel *pixelSet, uint32_t
 void Wavelet::InitCoder()
 {
   m_pixelSetPixelInSignificantCount = 0;
-  m_pixelSetPixelSignificantCount = 0;
   m_pixelSetChildrenCount = 0;
 
   for (int i = 0; i < m_transformIterations; i++)
@@ -756,7 +794,7 @@ static void DecompressZerosAlongX(const uint8_t *in, void *pic, int elementSize,
   }
 }
 
-bool Wavelet::DeCompress(bool isTransform, int32_t decompressInfo, float decompressSlice, int32_t decompressFlip, float* startThreshold, float* threshold, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange& valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool* isAnyNoValue, float* waveletNoValue, bool isNormalize, int decompressLevel, bool isLossless, int compressedAdaptiveDataSize, DataBlock& dataBlock, std::vector<uint8_t>& target, Error& error)
+bool Wavelet::DeCompress(bool isTransform, int32_t decompressInfo, float decompressSlice, int32_t decompressFlip, float* startThreshold, float* threshold, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange& valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool* isAnyNoValue, float* waveletNoValue, bool isNormalize, int decompressLevel, bool isLossless, int compressedAdaptiveDataSize, float *picture, Error& error)
 {
   assert(m_dataVersion >= WAVELET_DATA_VERSION_1_4 && m_dataVersion <= WAVELET_DATA_VERSION_1_5);
   InitCoder();
@@ -776,6 +814,7 @@ bool Wavelet::DeCompress(bool isTransform, int32_t decompressInfo, float decompr
   }
   else if (compressedSize <= WAVELET_MIN_COMPRESSED_HEADER)
   {
+    memset(picture, 0, size_t(m_allocatedSizeX) * m_allocatedSizeY * m_allocatedSizeZ * sizeof(float));
     *isAnyNoValue = false;
     *waveletNoValue = 0.0f;
     return true;
@@ -816,11 +855,9 @@ bool Wavelet::DeCompress(bool isTransform, int32_t decompressInfo, float decompr
 
   m_readCompressedData = (uint32_t *)floatRead;
 
-  void *pxData = (void*) target.data();                                                             
-
   int nAdaptiveSize = *m_readCompressedData++;
 
-  float *floatReadWriteData = (float*)pxData;
+  float *floatReadWriteData = picture;
 
   // create transform data
   Wavelet_TransformData transformData[TRANSFORM_MAX_ITERATIONS];
@@ -829,13 +866,12 @@ bool Wavelet::DeCompress(bool isTransform, int32_t decompressInfo, float decompr
 
   int cpuTempDecodeSizeNeeded = CalculateBufferSizeNeeded(m_allocatedSizeX * m_allocatedSizeY * m_allocatedSizeZ, m_allocatedHalfSizeX * m_allocatedHalfSizeY * m_allocatedHalfSizeZ);
 
-  std::vector<uint8_t> cpuTempData;
-  cpuTempData.resize(cpuTempDecodeSizeNeeded);
+  uint8_t *cpuTempData = m_arena.coderTemp.Get(cpuTempDecodeSizeNeeded);
 
   bool isInteger = m_integerInfo & WAVELET_INTEGERINFO_ISINTEGER;
   WaveletAdaptiveLL_DecodeIterator decodeIterator = WaveletAdaptiveLL_CreateDecodeIterator((uint8_t*)m_readCompressedData, floatReadWriteData, m_dimensions, m_allocatedSizeX, m_allocatedSizeY, m_allocatedSizeZ, *threshold, *startThreshold, m_transformMask, transformData, m_transformIterations,
-      m_pixelSetChildren.get(), m_pixelSetChildrenCount, m_pixelSetPixelInSignificant.get(), m_pixelSetPixelInSignificantCount,
-      m_allocatedHalfSizeX, m_allocatedHalfSizeX * m_allocatedHalfSizeY, cpuTempData.data(), m_allocatedHalfSizeX * m_allocatedHalfSizeY * m_allocatedHalfSizeZ, m_allocatedSizeX * m_allocatedSizeY * m_allocatedSizeZ, decompressLevel, isInteger);
+      m_pixelSetChildren, m_pixelSetChildrenCount, m_pixelSetPixelInSignificant, m_pixelSetPixelInSignificantCount,
+      m_allocatedHalfSizeX, m_allocatedHalfSizeX * m_allocatedHalfSizeY, cpuTempData, m_allocatedHalfSizeX * m_allocatedHalfSizeY * m_allocatedHalfSizeZ, m_allocatedSizeX * m_allocatedSizeY * m_allocatedSizeZ, decompressLevel, isInteger);
 
   int size = WaveletAdaptiveLL_DecompressAdaptive(decodeIterator);
   (void)size;
@@ -845,14 +881,12 @@ bool Wavelet::DeCompress(bool isTransform, int32_t decompressInfo, float decompr
     assert(nAdaptiveSize == size);
   }
 
-  cpuTempData = std::vector<uint8_t>();
-
   InverseTransform(floatReadWriteData);
 
   // Decompres no values?
   float localWaveletNoValue;
 
-  std::vector<uint32_t> noValueBitBuffer;
+  std::vector<uint32_t> &noValueBitBuffer = m_arena.noValueBits;
   DeCompressNoValues(&localWaveletNoValue, noValueBitBuffer);
 
   if (noValueBitBuffer.size())
@@ -886,10 +920,9 @@ bool Wavelet::DeCompress(bool isTransform, int32_t decompressInfo, float decompr
   //  Decompress Zeroes
   if (nDeCompressZeroSize > 4) // if equal to 4, then do nothing, no zero runs. 4 is the minimum size stored
   {
-    std::vector<uint8_t> buffer;
-    buffer.resize(m_transformSizeY * m_transformSizeZ * int32_t(sizeof(unsigned short)));
+    uint8_t *buffer = m_arena.zeroRunTemp.Get(m_transformSizeY * m_transformSizeZ * sizeof(unsigned short));
 
-    DecompressZerosAlongX(pnDecompressZeroSize, (void*)floatReadWriteData, 4, 0.0f, m_transformSizeX, m_transformSizeY, m_transformSizeZ, m_allocatedSizeX, m_allocatedSizeY, m_allocatedSizeZ, buffer.data());
+    DecompressZerosAlongX(pnDecompressZeroSize, (void*)floatReadWriteData, 4, 0.0f, m_transformSizeX, m_transformSizeY, m_transformSizeZ, m_allocatedSizeX, m_allocatedSizeY, m_allocatedSizeZ, buffer);
   }
 
   // Do lossless diff
@@ -933,10 +966,32 @@ static void ResizeVector(std::vector<T> &buffer, int32_t  allocatedSizeX, int32_
 }
 
 #ifdef ENABLE_SSE_TRANSFORM
+// Runs body(begin, end) for ranges covering [0, count). When helperCount is not 0 the ranges are shared with that many
+// workers of the thread pool the calling thread belongs to, the passes of the transform have independent items so the
+// result is the same.
+template<typename F>
+static void Wavelet_TransformPass(int helperCount, int32_t count, const F &body)
+{
+  if (helperCount == 0 || count < 2)
+  {
+    body(0, count);
+    return;
+  }
+
+  int32_t parts = std::min(count, int32_t(helperCount + 1) * 4);
+  ThreadPool::GetCurrentPool()->ParallelFor(parts, helperCount, [count, parts, &body](int part)
+    {
+      body(int32_t(int64_t(count) * part / parts), int32_t(int64_t(count) * (part + 1) / parts));
+    });
+}
+
 void Wavelet::InverseTransform(float *source)
 {
-  std::vector<float> tempBuffer;
-  ResizeVector(tempBuffer, (m_bandSize[0][0] + 3) & ~3, m_bandSize[0][1], m_bandSize[0][2]);
+  float *tempBuffer = m_arena.transformTemp.Get(size_t((m_bandSize[0][0] + 3) & ~3) * m_bandSize[0][1] * m_bandSize[0][2]);
+
+  // When the chunk is decoded by a request thread pool with idle workers the passes of the larger bands are shared with them
+  ThreadPool *threadPool = ThreadPool::GetCurrentPool();
+  int idleWorkerCount = threadPool ? std::min(threadPool->GetIdleWorkerCount(), WAVELET_SSE_THREADS - 1) : 0;
 
   for (int i = m_transformIterations - 1; i >= 0; i--)
   {
@@ -965,45 +1020,54 @@ void Wavelet::InverseTransform(float *source)
     int32_t writePitchXY = bufferPitchXY;
 
     float *read = source;
-    float *write = tempBuffer.data();
-    const int32_t threadCount = WAVELET_SSE_THREADS;
-    (void)threadCount;
+    float *write = tempBuffer;
+    const int helperCount = int64_t(bandSizeX) * bandSizeY * bandSizeZ >= WAVELET_PARALLEL_TRANSFORM_MIN_SIZE ? idleWorkerCount : 0;
+    const uint32_t integerInfo = m_integerInfo;
+    const bool isAVX2 = m_isAVX2;
+    const int32_t allocatedSizeX = m_allocatedSizeX;
+    const int32_t allocatedSizeXY = m_allocatedSizeXY;
 
     if (transformMask == 7)
     {
       // changed so it doez Z first, then Y, then X.
-      #pragma omp parallel for num_threads(threadCount) schedule(guided)
-      for (int32_t iD1 = 0; iD1 < bandSize[1]; ++iD1)
-      {
-        Wavelet_InverseTransformSliceInterleave(tempBuffer.data() + iD1 * bufferPitchX, bufferPitchXY, source + iD1 * m_allocatedSizeX, m_allocatedSizeXY, bandSizeX, bandSizeZ, m_integerInfo);
-      }
-
-      #pragma omp parallel for num_threads(threadCount) schedule(guided)
-      for (int32_t iD2 = 0; iD2 < bandSize[2]; ++iD2)
-      {
-        Wavelet_InverseTransformSlice(tempBuffer.data() + iD2 * bufferPitchXY, bufferPitchX, tempBuffer.data() + iD2 * bufferPitchXY, bufferPitchX, bandSizeX, bandSizeY, m_integerInfo);
+      Wavelet_TransformPass(helperCount, bandSize[1], [&](int32_t begin, int32_t end)
+        {
+          for (int32_t iD1 = begin; iD1 < end; ++iD1)
+          {
+            Wavelet_InverseTransformSliceInterleave(tempBuffer + iD1 * bufferPitchX, bufferPitchXY, source + iD1 * allocatedSizeX, allocatedSizeXY, bandSizeX, bandSizeZ, integerInfo, isAVX2);
+          }
+        });
 
-        for (int32_t iD1 = 0; iD1 < bandSize[1]; ++iD1)
+      Wavelet_TransformPass(helperCount, bandSize[2], [&](int32_t begin, int32_t end)
         {
-          int32_t iD1Interleaved = (iD1 & 1 ? (bandSize[1] + 1) >> 1 : 0) + (iD1 >> 1);
+          for (int32_t iD2 = begin; iD2 < end; ++iD2)
+          {
+            Wavelet_InverseTransformSlice(tempBuffer + iD2 * bufferPitchXY, bufferPitchX, tempBuffer + iD2 * bufferPitchXY, bufferPitchX, bandSizeX, bandSizeY, integerInfo, isAVX2);
 
-          // Wavelet transform x
-          float *readLine = tempBuffer.data() + (iD2 * bufferPitchXY + iD1Interleaved * bufferPitchX);
+            for (int32_t iD1 = 0; iD1 < bandSize[1]; ++iD1)
+            {
+              int32_t iD1Interleaved = (iD1 & 1 ? (bandSize[1] + 1) >> 1 : 0) + (iD1 >> 1);
 
-          Wavelet_InverseTransformLine(readLine, bandSizeX, m_integerInfo);
-          Wavelet_InterleaveLine(source + (iD1 * m_allocatedSizeX + iD2 * m_allocatedSizeXY), readLine, readLine + ((bandSizeX + 1) >> 1), bandSizeX);
-        }
-      }
+              // Wavelet transform x
+              float *readLine = tempBuffer + (iD2 * bufferPitchXY + iD1Interleaved * bufferPitchX);
+
+              Wavelet_InverseTransformLine(readLine, bandSizeX, integerInfo);
+              Wavelet_InterleaveLine(source + (iD1 * allocatedSizeX + iD2 * allocatedSizeXY), readLine, readLine + ((bandSizeX + 1) >> 1), bandSizeX);
+            }
+          }
+        });
     }
     else
     {
       if (transformMask & 4)
       {
-        #pragma omp parallel for num_threads(threadCount) schedule(guided)
-        for (int32_t iD1 = 0; iD1 < bandSize[1]; ++iD1)
-        {
-          Wavelet_InverseTransformSliceInterleave(write + iD1 * writePitchX, writePitchXY, read + iD1 * readPitchX, readPitchXY, bandSizeX, bandSizeZ, m_integerInfo);
-        }
+        Wavelet_TransformPass(helperCount, bandSize[1], [&](int32_t begin, int32_t end)
+          {
+            for (int32_t iD1 = begin; iD1 < end; ++iD1)
+            {
+              Wavelet_InverseTransformSliceInterleave(write + iD1 * writePitchX, writePitchXY, read + iD1 * readPitchX, readPitchXY, bandSizeX, bandSizeZ, integerInfo, isAVX2);
+            }
+          });
 
         read = write;
         readPitchX = writePitchX;
@@ -1016,11 +1080,13 @@ void Wavelet::InverseTransform(float *source)
 
       if (transformMask & 2)
       {
-        #pragma omp parallel for num_threads(threadCount) schedule(guided)
-        for (int32_t iD2 = 0; iD2 < bandSize[2]; ++iD2)
-        {
-          Wavelet_InverseTransformSliceInterleave(write + iD2 * writePitchXY, writePitchX, read + iD2 * readPitchXY, readPitchX, bandSizeX, bandSizeY, m_integerInfo);
-        }
+        Wavelet_TransformPass(helperCount, bandSize[2], [&](int32_t begin, int32_t end)
+          {
+            for (int32_t iD2 = begin; iD2 < end; ++iD2)
+            {
+              Wavelet_InverseTransformSliceInterleave(write + iD2 * writePitchXY, writePitchX, read + iD2 * readPitchXY, readPitchX, bandSizeX, bandSizeY, integerInfo, isAVX2);
+            }
+          });
 
         read = write;
         readPitchX = writePitchX;
@@ -1033,18 +1099,20 @@ void Wavelet::InverseTransform(float *source)
 
       if (transformMask & 1)
       {
-        #pragma omp parallel for num_threads(threadCount) schedule(guided)
-        for (int32_t iD2 = 0; iD2 < bandSize[2]; ++iD2)
-        {
-          for (int32_t iD1 = 0; iD1 < bandSize[1]; ++iD1)
+        Wavelet_TransformPass(helperCount, bandSize[2], [&](int32_t begin, int32_t end)
           {
-            // Wavelet transform x
-            float *readDisplaced = read + (iD1 * readPitchX + iD2 * readPitchXY);
+            for (int32_t iD2 = begin; iD2 < end; ++iD2)
+            {
+              for (int32_t iD1 = 0; iD1 < bandSize[1]; ++iD1)
+              {
+                // Wavelet transform x
+                float *readDisplaced = read + (iD1 * readPitchX + iD2 * readPitchXY);
 
-            Wavelet_InverseTransformLine(readDisplaced, bandSizeX, m_integerInfo);
-            Wavelet_InterleaveLine(write + (iD1 * writePitchX + iD2 * writePitchXY), readDisplaced, readDisplaced + ((bandSizeX + 1) >> 1), bandSizeX);
-          }
-        }
+                Wavelet_InverseTransformLine(readDisplaced, bandSizeX, integerInfo);
+                Wavelet_InterleaveLine(write + (iD1 * writePitchX + iD2 * writePitchXY), readDisplaced, readDisplaced + ((bandSizeX + 1) >> 1), bandSizeX);
+              }
+            }
+          });
 
         read = write;
         readPitchX = writePitchX;
@@ -1053,13 +1121,76 @@ void Wavelet::InverseTransform(float *source)
 
       if (read != source)
       {
-        #pragma omp parallel for num_threads(threadCount) schedule(static)
-        for (int32_t iD2 = 0; iD2 < bandSizeZ; ++iD2)
+        Wavelet_TransformPass(helperCount, bandSizeZ, [&](int32_t begin, int32_t end)
+          {
+            for (int32_t iD2 = begin; iD2 < end; ++iD2)
+            {
+              Wavelet_CopySlice(source + iD2 * allocatedSizeXY, allocatedSizeX, read + iD2 * readPitchXY, readPitchX, bandSizeX, bandSizeY);
+            }
+          });
+      }
+    }
+  }
+}
+
+void Wavelet::ForwardTransform(float *source)
+{
+  float *tempBuffer = m_arena.transformTemp.Get(size_t((m_bandSize[0][0] + 3) & ~3) * m_bandSize[0][1] * m_bandSize[0][2]);
+
+  for (int i = 0; i < m_transformIterations; i++)
+  {
+    char transformMask = m_transformMask[i];
+
+    int32_t bandSizeX = m_bandSize[i][0];
+    int32_t bandSizeY = m_bandSize[i][1];
+    int32_t bandSizeZ = m_bandSize[i][2];
+
+    int32_t bufferPitchX = (bandSizeX + 3) & ~3;
+
+    const int32_t threadCount = WAVELET_SSE_THREADS;
+    (void)threadCount;
+
+    // The inverse transform does Z, then Y, then X, so this is done in the opposite order
+    if (transformMask & 1)
+    {
+      #pragma omp parallel for num_threads(threadCount) schedule(guided)
+      for (int32_t iD2 = 0; iD2 < bandSizeZ; ++iD2)
+      {
+        for (int32_t iD1 = 0; iD1 < bandSizeY; ++iD1)
         {
-          Wavelet_CopySlice(source + iD2 * m_allocatedSizeXY, m_allocatedSizeX, read + iD2 * readPitchXY, readPitchX, bandSizeX, bandSizeY);
+          float *line = source + (iD1 * m_allocatedSizeX + iD2 * m_allocatedSizeXY);
+          float *temp = tempBuffer + (iD1 + iD2 * bandSizeY) * bufferPitchX;
+
+          Wavelet_DeinterleaveLine(temp, temp + ((bandSizeX + 1) >> 1), line, bandSizeX);
+          Wavelet_ForwardTransformLine(temp, bandSizeX, m_integerInfo);
+          memcpy(line, temp, bandSizeX * sizeof(float));
         }
       }
     }
+
+    if (transformMask & 2)
+    {
+      #pragma omp parallel for num_threads(threadCount) schedule(guided)
+      for (int32_t iD2 = 0; iD2 < bandSizeZ; ++iD2)
+      {
+        float *temp = tempBuffer + iD2 * bandSizeY * bufferPitchX;
+
+        Wavelet_ForwardTransformSliceDeinterleave(temp, bufferPitchX, source + iD2 * m_allocatedSizeXY, m_allocatedSizeX, bandSizeX, bandSizeY, m_integerInfo);
+        Wavelet_CopySlice(source + iD2 * m_allocatedSizeXY, m_allocatedSizeX, temp, bufferPitchX, bandSizeX, bandSizeY);
+      }
+    }
+
+    if (transformMask & 4)
+    {
+      #pragma omp parallel for num_threads(threadCount) schedule(guided)
+      for (int32_t iD1 = 0; iD1 < bandSizeY; ++iD1)
+      {
+        float *temp = tempBuffer + iD1 * bandSizeZ * bufferPitchX;
+
+        Wavelet_ForwardTransformSliceDeinterleave(temp, bufferPitchX, source + iD1 * m_allocatedSizeX, m_allocatedSizeXY, bandSizeX, bandSizeZ, m_integerInfo);
+        Wavelet_CopySlice(source + iD1 * m_allocatedSizeX, m_allocatedSizeXY, temp, bufferPitchX, bandSizeX, bandSizeZ);
+      }
+    }
   }
 }
 
@@ -1327,6 +1458,111 @@ void Wavelet::InverseTransform(float *source)
   }
 }
 
+template<bool isInteger>
+static void ForwardTransformLine_2(float *readWrite, int32_t length, uint32_t integerInfo)
+{
+  int32_t lengthLow = (length + 1) >> 1;
+  int32_t lengthHigh = length >> 1;
+
+  TransformPredictDetail<isInteger>(readWrite + lengthLow, readWrite, lengthHigh, 1.0f / 16.0f, length & 1, integerInfo);
+  TransformUpdateCoarse<isInteger>(readWrite, readWrite + lengthLow, lengthLow, 1.0f / 32.0f, length & 1, integerInfo);
+
+  float val = integerInfo & WAVELET_INTEGERINFO_ISLOSSLESSOPTIMIZED ? 1.0f : (float)REAL_SQRT2;
+
+  for (int32_t i = 0; i < lengthLow; i++)
+  {
+    readWrite[i] *= val;
+  }
+}
+
+static void ForwardTransformLine(float *readWrite, int32_t length, uint32_t integerInfo)
+{
+  if (integerInfo & WAVELET_INTEGERINFO_ISINTEGER)
+    ForwardTransformLine_2<true>(readWrite, length, integerInfo);
+  else
+    ForwardTransformLine_2<false>(readWrite, length, integerInfo);
+}
+
+static void ReadLineToLowHighBand(float *write, float *read, int32_t length, int32_t modulo)
+{
+  int32_t lengthLowBand = (length + 1) >> 1;
+
+  float *lowBand = write;
+  float *highBand = write + lengthLowBand;
+
+  for (int32_t i = 0; i < length; i++)
+  {
+    if (i & 1)
+      highBand[i >> 1] = read[i * modulo];
+    else
+      lowBand[i >> 1] = read[i * modulo];
+  }
+}
+
+static void WriteLine(float *write, float *read, int32_t length, int32_t modulo)
+{
+  for (int32_t i = 0; i < length; i++)
+  {
+    write[i * modulo] = read[i];
+  }
+}
+
+void Wavelet::ForwardTransform(float *source)
+{
+  float line[WAVELET_MAX_DIMENSION_SIZE];
+
+  for (int i = 0; i < m_transformIterations; i++)
+  {
+    char transformMask = m_transformMask[i];
+
+    int32_t   bandSizeX = m_bandSize[i][0];
+    int32_t   bandSizeY = m_bandSize[i][1];
+    int32_t   bandSizeZ = m_bandSize[i][2];
+
+    if (transformMask & 1)
+    {
+      for (int32_t iD2 = 0; iD2 < bandSizeZ; iD2++)
+        for (int32_t iD1 = 0; iD1 < bandSizeY; iD1++)
+        {
+          int32_t displacement = (iD1 * m_allocatedSizeX + iD2 * m_allocatedSizeXY);
+
+          // Wavelet transform x
+          ReadLineToLowHighBand(line, source + displacement, bandSizeX, 1);
+          ForwardTransformLine(line, bandSizeX, m_integerInfo);
+          WriteLine(source + displacement, line, bandSizeX, 1);
+        }
+    }
+
+    if (transformMask & 2)
+    {
+      for (int32_t iD2 = 0; iD2 < bandSizeZ; iD2++)
+        for (int32_t iD0 = 0; iD0 < bandSizeX; iD0++)
+        {
+          int32_t displacement = (iD0 + iD2 * m_allocatedSizeXY);
+
+          // Wavelet transform y
+          ReadLineToLowHighBand(line, source + displacement, bandSizeY, m_allocatedSizeX);
+          ForwardTransformLine(line, bandSizeY, m_integerInfo);
+          WriteLine(source + displacement, line, bandSizeY, m_allocatedSizeX);
+        }
+    }
+
+    if (transformMask & 4)
+    {
+      for (int32_t iD1 = 0; iD1 < bandSizeY; iD1++)
+        for (int32_t iD0 = 0; iD0 < bandSizeX; iD0++)
+        {
+          int32_t displacement = (iD0 + iD1 * m_allocatedSizeX);
+
+          // Wavelet transform z
+          ReadLineToLowHighBand(line, source + displacement, bandSizeZ, m_allocatedSizeXY);
+          ForwardTransformLine(line, bandSizeZ, m_integerInfo);
+          WriteLine(source + displacement, line, bandSizeZ, m_allocatedSizeXY);
+        }
+    }
+  }
+}
+
 #endif
 
 static inline bool RleDecodeOneRun(uint8_t *&rleByte, uint32_t &setBits)
@@ -1386,18 +1622,69 @@ static void RleDecode(uint8_t *rleBytes, uint32_t *bitBuffer, int32_t intsToDeco
   }
 }
 
+static void RleEncodeOneRun(std::vector<uint8_t> &rleBytes, bool isSet, uint32_t setBits)
+{
+  uint8_t mask = RLE_BYTE_MASK;
+
+  if (setBits >= (1 << 5))  mask = RLE_2BYTE_MASK;
+  if (setBits >= (1 << 13)) mask = RLE_3BYTE_MASK;
+  if (setBits >= (1 << 21)) mask = RLE_4BYTE_MASK;
+
+  rleBytes.push_back(uint8_t((isSet ? 1 : 0) | (mask << 1) | (setBits << 3)));
+
+  if (mask > RLE_BYTE_MASK)
+  {
+    rleBytes.push_back(uint8_t(setBits >> (8 - 3)));
+  }
+  if (mask > RLE_2BYTE_MASK)
+  {
+    rleBytes.push_back(uint8_t(setBits >> (16 - 3)));
+  }
+  if (mask > RLE_3BYTE_MASK)
+  {
+    rleBytes.push_back(uint8_t(setBits >> (24 - 3)));
+  }
+}
+
+static void RleEncode(const uint32_t *bitBuffer, int32_t intsToEncode, std::vector<uint8_t> &rleBytes)
+{
+  const int maxRun = (1 << 29) - 1;
+
+  int bitsToEncode = intsToEncode * 32;
+
+  int readBit = 0;
+
+  while (readBit < bitsToEncode)
+  {
+    bool isSet = (bitBuffer[readBit / 32] >> (readBit & 31)) & 1;
+
+    int endBit = readBit + 1;
+
+    while (endBit < bitsToEncode && endBit - readBit < maxRun && (((bitBuffer[endBit / 32] >> (endBit & 31)) & 1) != 0) == isSet)
+    {
+      endBit++;
+    }
+
+    RleEncodeOneRun(rleBytes, isSet, uint32_t(endBit - readBit));
+
+    readBit = endBit;
+  }
+}
+
 void Wavelet::DeCompressNoValues(float *noValue, std::vector<uint32_t> &buffer)
 {
   if (!m_noValueData)
   {
     *noValue = 0.0f;
-    buffer = std::vector<uint32_t>();
+    buffer.clear();
     return;
   }
 
   // Create a union for type punning that works with strict aliasing
   union { float fValue; int32_t iValue; } convert;
 
+  // The section starts with the size of the run length encoded bits, then the no value
+  m_noValueData++;
   convert.iValue = *m_noValueData++; *noValue = convert.fValue;
 
   ResizeVector(buffer, ((m_transformSizeX + 31) & ~31) / 32, m_transformSizeY, m_transformSizeZ);
@@ -1440,4 +1727,311 @@ void Wavelet::ApplyNoValues(float *source, uint32_t *bitBuffer, float noValue)
     }
   }
 }
+
+static void AppendCompressedData(std::vector<uint8_t> &compressedData, const void *data, size_t size)
+{
+  compressedData.insert(compressedData.end(), (const uint8_t *)data, (const uint8_t *)data + size);
+}
+
+static void AlignCompressedData(std::vector<uint8_t> &compressedData)
+{
+  compressedData.resize((compressedData.size() + 3) & ~size_t(3));
+}
+
+static void UpdateCompressedSize(std::vector<uint8_t> &compressedData)
+{
+  int32_t compressedSize = int32_t(compressedData.size());
+  memcpy(compressedData.data() + sizeof(int32_t), &compressedSize, sizeof(compressedSize));
+}
+
+void Wavelet::Compress(float *picture, float threshold, const std::vector<uint8_t> &noValueRle, float noValue, std::vector<uint8_t> &compressedData, int (&adaptiveLevelSizes)[WAVELET_ADAPTIVE_LEVELS])
+{
+  InitCoder();
+
+  ForwardTransform(picture);
+
+  // create transform data
+  Wavelet_TransformData transformData[TRANSFORM_MAX_ITERATIONS];
+
+  createTransformData(transformData, m_bandSize, m_transformMask, m_transformIterations);
+
+  int cpuTempEncodeSizeNeeded = CalculateBufferSizeNeeded(m_allocatedSizeX * m_allocatedSizeY * m_allocatedSizeZ, m_allocatedHalfSizeX * m_allocatedHalfSizeY * m_allocatedHalfSizeZ);
+
+  uint8_t *cpuTempData = m_arena.coderTemp.Get(cpuTempEncodeSizeNeeded);
+
+  std::vector<uint8_t> stream;
+  stream.reserve(m_allocatedSizeX * m_allocatedSizeY * m_allocatedSizeZ);
+
+  // The start threshold is found by the encoder
+  bool isInteger = m_integerInfo & WAVELET_INTEGERINFO_ISINTEGER;
+  WaveletAdaptiveLL_DecodeIterator decodeIterator = WaveletAdaptiveLL_CreateDecodeIterator(stream.data(), picture, m_dimensions, m_allocatedSizeX, m_allocatedSizeY, m_allocatedSizeZ, threshold, threshold, m_transformMask, transformData, m_transformIterations,
+      m_pixelSetChildren, m_pixelSetChildrenCount, m_pixelSetPixelInSignificant, m_pixelSetPixelInSignificantCount,
+      m_allocatedHalfSizeX, m_allocatedHalfSizeX * m_allocatedHalfSizeY, cpuTempData, m_allocatedHalfSizeX * m_allocatedHalfSizeY * m_allocatedHalfSizeZ, m_allocatedSizeX * m_allocatedSizeY * m_allocatedSizeZ, 0, isInteger);
+
+  float startThreshold;
+  int32_t streamLevelSizes[WAVELET_ADAPTIVE_LEVELS];
+
+  int32_t streamSize = WaveletAdaptiveLL_CompressAdaptive(decodeIterator, stream, startThreshold, streamLevelSizes);
+
+  compressedData.clear();
+
+  int32_t header[6] = { m_dataVersion, 0, m_dataBlockSizeX, m_dataBlockSizeY, m_dataBlockSizeZ, m_dimensions | int32_t(m_integerInfo << 8) };
+  AppendCompressedData(compressedData, header, sizeof(header));
+
+  // Zero runs are not used, 4 is the minimum size stored
+  int32_t compressZeroSize = 4;
+  AppendCompressedData(compressedData, &compressZeroSize, sizeof(compressZeroSize));
+
+  if (noValueRle.empty())
+  {
+    int32_t noValueSize = -1;
+    AppendCompressedData(compressedData, &noValueSize, sizeof(noValueSize));
+  }
+  else
+  {
+    int32_t noValueSize = int32_t(noValueRle.size());
+    AppendCompressedData(compressedData, &noValueSize, sizeof(noValueSize));
+    AppendCompressedData(compressedData, &noValue, sizeof(noValue));
+    AppendCompressedData(compressedData, noValueRle.data(), noValueRle.size());
+    AlignCompressedData(compressedData);
+  }
+
+  AppendCompressedData(compressedData, &threshold, sizeof(threshold));
+  AppendCompressedData(compressedData, &startThreshold, sizeof(startThreshold));
+  AppendCompressedData(compressedData, &streamSize, sizeof(streamSize));
+
+  int32_t streamStart = int32_t(compressedData.size());
+
+  AppendCompressedData(compressedData, stream.data(), streamSize);
+  AlignCompressedData(compressedData);
+
+  for (int level = 0; level < WAVELET_ADAPTIVE_LEVELS; level++)
+  {
+    adaptiveLevelSizes[level] = streamStart + streamLevelSizes[level];
+  }
+
+  UpdateCompressedSize(compressedData);
+}
+
+template<typename T>
+static void CopyIntoTransformBuffer(const DataBlock &dataBlock, const void *data, float *picture, int32_t allocatedSizeX, int32_t allocatedSizeXY)
+{
+  const T *source = reinterpret_cast<const T *>(data);
+
+  for (int32_t iZ = 0; iZ < dataBlock.Size[2]; iZ++)
+  {
+    for (int32_t iY = 0; iY < dataBlock.Size[1]; iY++)
+    {
+      const T *sourceLine = source + iY * dataBlock.Pitch[1] + iZ * dataBlock.Pitch[2];
+      float *targetLine = picture + iY * allocatedSizeX + iZ * allocatedSizeXY;
+
+      for (int32_t iX = 0; iX < dataBlock.Size[0]; iX++)
+      {
+        targetLine[iX] = float(sourceLine[iX]);
+      }
+    }
+  }
+}
+
+bool Wavelet_Compress(const DataBlock &dataBlock, const void *data, const FloatRange &valueRange, bool isUseNoValue, float noValue, float compressionTolerance, bool isLossless, std::vector<uint8_t> &compressedData, int (&adaptiveLevelSizes)[WAVELET_ADAPTIVE_LEVELS], Error &error)
+{
+  VolumeDataChannelDescriptor::Format format = dataBlock.Format;
+
+  if (dataBlock.Components != VolumeDataChannelDescriptor::Components_1 ||
+    (format != VolumeDataChannelDescriptor::Format_R32 &&
+     format != VolumeDataChannelDescriptor::Format_U8 &&
+     format != VolumeDataChannelDescriptor::Format_U16))
+  {
+    error.code = -1;
+    error.string = "Wavelet compression is only supported for single component R32, U8 and U16 data";
+    return false;
+  }
+
+  int32_t dimensions = dataBlock.Dimensionality;
+
+  int32_t createSize[DataBlock::Dimensionality_Max];
+  createSize[0] = dataBlock.Size[0];
+  createSize[1] = dataBlock.Size[1];
+  createSize[2] = dataBlock.Size[2];
+  createSize[3] = 1;
+
+  if (dimensions < 1 ||
+    dimensions > 3 ||
+    createSize[0] > 512 ||
+    createSize[1] > 512 ||
+    createSize[2] > 512)
+  {
+    error.code = -1;
+    error.string = "Invalid data block size for wavelet compression";
+    return false;
+  }
+
+  DataBlock transformDataBlock;
+  if (!InitializeDataBlock(VolumeDataChannelDescriptor::Format_R32, VolumeDataChannelDescriptor::Components_1, dataBlock.Dimensionality, createSize, transformDataBlock, error))
+    return false;
+
+  int32_t allocatedSizeX = transformDataBlock.AllocatedSize[0];
+  int32_t allocatedSizeXY = transformDataBlock.AllocatedSize[0] * transformDataBlock.AllocatedSize[1];
+
+  std::vector<float> picture(GetAllocatedByteSize(transformDataBlock) / sizeof(float));
+
+  if (format == VolumeDataChannelDescriptor::Format_U8)
+  {
+    CopyIntoTransformBuffer<uint8_t>(dataBlock, data, picture.data(), allocatedSizeX, allocatedSizeXY);
+  }
+  else if (format == VolumeDataChannelDescriptor::Format_U16)
+  {
+    CopyIntoTransformBuffer<uint16_t>(dataBlock, data, picture.data(), allocatedSizeX, allocatedSizeXY);
+  }
+  else
+  {
+    CopyIntoTransformBuffer<float>(dataBlock, data, picture.data(), allocatedSizeX, allocatedSizeXY);
+  }
+
+  uint32_t integerInfo = 0;
+  float threshold;
+
+  std::vector<float> original;
+  std::vector<uint8_t> noValueRle;
+
+  // The threshold is the compression tolerance in units of 1/255 of the value range
+  if (format != VolumeDataChannelDescriptor::Format_R32)
+  {
+    integerInfo = WAVELET_INTEGERINFO_ISINTEGER;
+
+    if (format == VolumeDataChannelDescriptor::Format_U16)
+    {
+      integerInfo |= WAVELET_INTEGERINFO_16BIT;
+    }
+
+    if (isLossless)
+    {
+      // The integer transform is reversible when the coarse band isn't normalized
+      integerInfo |= WAVELET_INTEGERINFO_ISLOSSLESSOPTIMIZED;
+      threshold = 1.0f;
+    }
+    else
+    {
+      threshold = std::max(1.0f, compressionTolerance * (format == VolumeDataChannelDescriptor::Format_U16 ? 256.0f : 1.0f));
+    }
+  }
+  else
+  {
+    if (isLossless)
+    {
+      original = picture;
+    }
+
+    // Mark the no values, they are replaced by the mean of the other values so they don't disturb the transform
+    int32_t bitSizeX = (createSize[0] + 31) / 32;
+
+    std::vector<uint32_t> noValueBitBuffer;
+
+    if (isUseNoValue)
+    {
+      noValueBitBuffer.resize(bitSizeX * createSize[1] * createSize[2]);
+    }
+
+    float minValue = std::numeric_limits<float>::max();
+    float maxValue = -std::numeric_limits<float>::max();
+    double sum = 0.0;
+    int64_t count = 0;
+    int64_t noValueCount = 0;
+
+    for (int32_t iZ = 0; iZ < createSize[2]; iZ++)
+    {
+      for (int32_t iY = 0; iY < createSize[1]; iY++)
+      {
+        float *line = picture.data() + iY * allocatedSizeX + iZ * allocatedSizeXY;
+
+        for (int32_t iX = 0; iX < createSize[0]; iX++)
+        {
+          float value = line[iX];
+
+          if (isUseNoValue && (value == noValue || (value != value && noValue != noValue)))
+          {
+            noValueBitBuffer[(iY + iZ * createSize[1]) * bitSizeX + iX / 32] |= 1u << (iX & 31);
+            noValueCount++;
+          }
+          else if (!std::isfinite(value))
+          {
+            line[iX] = 0.0f;
+          }
+          else
+          {
+            minValue = std::min(minValue, value);
+            maxValue = std::max(maxValue, value);
+            sum += value;
+            count++;
+          }
+        }
+      }
+    }
+
+    if (noValueCount)
+    {
+      float meanValue = count ? float(sum / count) : 0.0f;
+
+      for (int32_t iZ = 0; iZ < createSize[2]; iZ++)
+      {
+        for (int32_t iY = 0; iY < createSize[1]; iY++)
+        {
+          float *line = picture.data() + iY * allocatedSizeX + iZ * allocatedSizeXY;
+          const uint32_t *bits = noValueBitBuffer.data() + (iY + iZ * createSize[1]) * bitSizeX;
+
+          for (int32_t iX = 0; iX < createSize[0]; iX++)
+          {
+            if (bits[iX / 32] & (1u << (iX & 31)))
+            {
+              line[iX] = meanValue;
+            }
+          }
+        }
+      }
+
+      RleEncode(noValueBitBuffer.data(), int32_t(noValueBitBuffer.size()), noValueRle);
+    }
+
+    float rangeSize = valueRange.Max - valueRange.Min;
+
+    if (!(rangeSize > 0.0f) || !std::isfinite(rangeSize))
+    {
+      rangeSize = maxValue > minValue ? maxValue - minValue : 1.0f;
+    }
+
+    float tolerance = isLossless ? WAVELET_MIN_COMPRESSION_TOLERANCE : std::max(compressionTolerance, WAVELET_MIN_COMPRESSION_TOLERANCE);
+
+    threshold = tolerance * rangeSize / 255.0f;
+  }
+
+  WaveletArena arena;
+  Wavelet wavelet(arena, integerInfo, nullptr,
+    transformDataBlock.Size[0],
+    transformDataBlock.Size[1],
+    transformDataBlock.Size[2],
+    transformDataBlock.AllocatedSize[0],
+    transformDataBlock.AllocatedSize[1],
+    transformDataBlock.AllocatedSize[2],
+    dimensions,
+    WAVELET_DATA_VERSION_1_5);
+
+  wavelet.Compress(picture.data(), threshold, noValueRle, noValue, compressedData, adaptiveLevelSizes);
+
+  // Floats are made lossless by storing the bits that differ between the original and the decompressed data
+  if (isLossless && format == VolumeDataChannelDescriptor::Format_R32)
+  {
+    DataBlock decodedDataBlock;
+    std::vector<uint8_t> decoded;
+
+    if (!Wavelet_Decompress(compressedData.data(), int(compressedData.size()), VolumeDataChannelDescriptor::Format_R32, valueRange, 1.0f, 0.0f, isUseNoValue, noValue, false, 0, false, decodedDataBlock, decoded, error))
+      return false;
+
+    WaveletAdaptiveLL_CompressLossless(original.data(), reinterpret_cast<const float *>(decoded.data()), createSize[0], createSize[1], createSize[2], allocatedSizeX, allocatedSizeXY, compressedData);
+
+    AlignCompressedData(compressedData);
+    UpdateCompressedSize(compressedData);
+  }
+
+  return true;
+}
 }
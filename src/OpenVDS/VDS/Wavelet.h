@@ -24,14 +24,53 @@
 #include "DataBlock.h"
 
 #include <memory>
+#include <vector>
 
 #include "WaveletTypes.h"
 
 namespace OpenVDS
 {
 
+template<typename T>
+class WaveletArenaBuffer
+{
+  std::unique_ptr<T[]> m_data;
+  size_t m_count;
+
+public:
+  WaveletArenaBuffer() : m_count(0) {}
+
+  // The contents are undefined when the buffer has to grow
+  T *Get(size_t count)
+  {
+    if (count > m_count)
+    {
+      m_data.reset(new T[count]);
+      m_count = count;
+    }
+    return m_data.get();
+  }
+};
+
+// The work buffers of the wavelet coder. Decompression uses an arena per thread, so once the buffers have grown to the
+// chunk size decoding a chunk does not allocate.
+struct WaveletArena
+{
+  WaveletArenaBuffer<Wavelet_PixelSetChildren> pixelSetChildren;
+  WaveletArenaBuffer<Wavelet_PixelSetPixel> pixelSetPixelInSignificant;
+  WaveletArenaBuffer<uint8_t> coderTemp;
+  WaveletArenaBuffer<float> transformTemp;
+  WaveletArenaBuffer<uint8_t> zeroRunTemp;
+  WaveletArenaBuffer<float> picture;
+  std::vector<uint32_t> noValueBits;
+
+  static WaveletArena &ThreadArena();
+};
+
 class Wavelet
 {
+  WaveletArena &m_arena;
+
   const uint32_t *m_readCompressedData;
 
   const uint32_t *m_noValueData;
@@ -57,26 +96,22 @@ class Wavelet
   int32_t m_allocatedHalfSizeZ;
   int32_t m_pixelSetChildrenCount;
   uint32_t m_integerInfo;
+  bool m_isAVX2;
 
-  std::unique_ptr<float[]> m_maxTree;
-  std::unique_ptr<float[]> m_maxTreeMaxOnly;
-
-  std::unique_ptr<int32_t[]> m_tempEncodeDecodeBuffer;
-
-  std::unique_ptr<Wavelet_PixelSetPixel[]> m_pixelSetPixelSignificant;
-  std::unique_ptr<Wavelet_PixelSetPixel[]> m_pixelSetPixelInSignificant;
-  std::unique_ptr<Wavelet_PixelSetChildren[]> m_pixelSetChildren;
+  Wavelet_PixelSetPixel *m_pixelSetPixelInSignificant;
+  Wavelet_PixelSetChildren *m_pixelSetChildren;
 
-  int32_t m_pixelSetPixelSignificantCount;
   int32_t m_pixelSetPixelInSignificantCount;
 
 public:
-  Wavelet(uint32_t integerIfno, const void *compressedData, int32_t transformSizeX, int32_t transformSizeY, int32_t transformSizeZ, int32_t allocatedSizeX, int32_t allocatedSizeY, int32_t allocatedSizeZ, int32_t dimensions, int32_t dataVersion);
+  Wavelet(WaveletArena &arena, uint32_t integerIfno, const void *compressedData, int32_t transformSizeX, int32_t transformSizeY, int32_t transformSizeZ, int32_t allocatedSizeX, int32_t allocatedSizeY, int32_t allocatedSizeZ, int32_t dimensions, int32_t dataVersion);
   void InitCoder();
 
-  bool DeCompress(bool isTransform, int32_t decompressInfo, float decompressSlice, int32_t decompressFlip, float *startThreshold, float *threshold, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &originalValueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool *isAnyNoValue, float *waveletNoValue, bool isNormalize, int decompressLevel, bool isLossless, int compressedAdaptiveDataSize, DataBlock &dataBlock, std::vector<uint8_t> &target, Error &error);
+  bool DeCompress(bool isTransform, int32_t decompressInfo, float decompressSlice, int32_t decompressFlip, float *startThreshold, float *threshold, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &originalValueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool *isAnyNoValue, float *waveletNoValue, bool isNormalize, int decompressLevel, bool isLossless, int compressedAdaptiveDataSize, float *picture, Error &error);
   void DeCompressNoValuesHeader();
   void InverseTransform(float *source);
+  void ForwardTransform(float *source);
+  void Compress(float *picture, float threshold, const std::vector<uint8_t> &noValueRle, float noValue, std::vector<uint8_t> &compressedData, int (&adaptiveLevelSizes)[WAVELET_ADAPTIVE_LEVELS]);
   void DeCompressNoValues(float* noValue, std::vector<uint32_t> &buffer);
   void ApplyNoValues(float *source, uint32_t* bitBuffer, float noValue);
 };
@@ -1209,4 +1209,617 @@ int32_t WaveletAdaptiveLL_DecompressLossless(uint8_t *in, float *pic, int32_t si
   return (int)(in + totalSize - start);
 }
 
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Encoder
+//
+// The encoder mirrors DecodeTreeStructure and drives the same EvalAndSplit functions as the decoder, so the lists of insignificant
+// and significant sets and the order of the values are identical on both sides. Where the decoder reads a bit for a set, the encoder
+// writes it from the largest quantized coefficient magnitude found in that set.
+
+#define ADAPTIVEWAVELET_ENCODE_MAX_MAGNITUDE ((1u << 30) - 1)
+#define ADAPTIVEWAVELET_ENCODE_SPLIT_SIZE    512
+
+static inline uint32_t QuantizeMagnitude(float value, float threshold, bool isInteger)
+{
+  float magnitude = fabsf(value) / threshold;
+
+  // Integer coefficients are reconstructed as (magnitude * threshold) and floats as ((magnitude + 0.5) * threshold)
+  magnitude = isInteger ? rintf(magnitude) : floorf(magnitude);
+
+  if (!(magnitude < (float)ADAPTIVEWAVELET_ENCODE_MAX_MAGNITUDE))
+  {
+    return magnitude != magnitude ? 0 : ADAPTIVEWAVELET_ENCODE_MAX_MAGNITUDE;
+  }
+
+  return (uint32_t)magnitude;
+}
+
+template<bool isAllNormal>
+static inline Wavelet_FastDecodeInsig GetListItem(const Wavelet_FastDecodeInsig* list, int32_t index)
+{
+  if (isAllNormal)
+  {
+    Wavelet_FastDecodeInsig item;
+    item.xyz = (int32_t)((const Wavelet_FastDecodeInsigAllNormal*)list)[index].iterXYZ;
+    return item;
+  }
+  return list[index];
+}
+
+template<bool isAllNormal>
+static inline void SetListItem(Wavelet_FastDecodeInsig* list, int32_t index, const Wavelet_FastDecodeInsig& item)
+{
+  if (isAllNormal)
+  {
+    ((Wavelet_FastDecodeInsigAllNormal*)list)[index].iterXYZ = (uint32_t)item.xyz;
+  }
+  else
+  {
+    list[index] = item;
+  }
+}
+
+static inline int32_t GetItemPosition(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, const Wavelet_FastDecodeInsig& item)
+{
+  return item.GetX() + item.GetY() * decodeIterator.sizeX + item.GetZ() * decodeIterator.sizeXY;
+}
+
+// Position of the first value of a multiple, the same way DecodeAllBits finds it
+template<bool isAllNormal>
+static inline int32_t GetMultiplePosition(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, int32_t position)
+{
+  Wavelet_FastDecodeInsigAllNormal item;
+
+  item.iterXYZ = position;
+
+  if (isAllNormal)
+  {
+    item.iterXYZ += item.iterXYZ & decodeIterator.allNormalAndMask;
+  }
+
+  return item.GetX() + item.GetY() * decodeIterator.sizeX + item.GetZ() * decodeIterator.sizeXY;
+}
+
+template<bool isAllNormal>
+static inline int32_t GetMultipleDisplacement(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, int32_t child)
+{
+  return isAllNormal ? decodeIterator.screenDisplacementAllNormal[child] : decodeIterator.screenDisplacement[child];
+}
+
+// Find the largest magnitude of all descendants of each set (tested in the insignificant pass) and of all descendants except the
+// children (tested in the significant pass). The tree is walked breadth first by splitting one set at a time with the same
+// EvalAndSplit as the decoder, then the maxima are accumulated bottom up. The maxima are stored at the position of the set.
+template<bool isAllNormal, int dimensions>
+static void CalculateSetMaxima(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, const uint32_t* magnitude, uint32_t* descendantMax, uint32_t* grandDescendantMax)
+{
+  std::vector<Wavelet_FastDecodeInsig> insigSplit(ADAPTIVEWAVELET_ENCODE_SPLIT_SIZE);
+  std::vector<Wavelet_FastDecodeInsig> sigSplit(ADAPTIVEWAVELET_ENCODE_SPLIT_SIZE);
+  std::vector<int32_t> posSplit(2 * ADAPTIVEWAVELET_ENCODE_SPLIT_SIZE);
+
+  WaveletAdaptiveLL_DecodeIterator splitIterator = decodeIterator;
+
+  splitIterator.insig = insigSplit.data();
+  splitIterator.sig = sigSplit.data();
+  splitIterator.pos = posSplit.data();
+  splitIterator.maxChildren = ADAPTIVEWAVELET_ENCODE_SPLIT_SIZE;
+
+  std::vector<Wavelet_FastDecodeInsig> sets;
+  std::vector<int32_t> setChildrenEnd;
+  std::vector<int32_t> setSubSetsEnd;
+  std::vector<int32_t> children;
+
+  InitializeInsignificants<isAllNormal>(decodeIterator, decodeIterator.pixelSetChildren, decodeIterator.pixelSetChildrenCount);
+
+  int32_t rootSets = decodeIterator.pixelSetChildrenCount;
+
+  for (int32_t iSet = 0; iSet < rootSets; iSet++)
+  {
+    sets.push_back(GetListItem<isAllNormal>(decodeIterator.insig, iSet));
+  }
+
+  uint8_t expand = 1;
+
+  for (size_t iSet = 0; iSet < sets.size(); iSet++)
+  {
+    SetListItem<isAllNormal>(splitIterator.insig, 0, sets[iSet]);
+
+    int32_t current = 0;
+    int32_t count = 1;
+    int32_t valuesMultiple = 0;
+    int32_t valuesSingle = 0;
+    int32_t sigCount = 0;
+
+    if (isAllNormal)
+    {
+      EvalAndSplitAllNormal<true>(splitIterator, &expand, current, count, 0.0f, valuesMultiple, sigCount);
+    }
+    else
+    {
+      EvalAndSplit<true, dimensions>(splitIterator, &expand, current, count, 0.0f, valuesMultiple, valuesSingle, sigCount);
+    }
+
+    for (int32_t iValue = 0; iValue < valuesMultiple; iValue++)
+    {
+      int32_t position = GetMultiplePosition<isAllNormal>(decodeIterator, splitIterator.pos[iValue]);
+
+      for (int32_t child = 0; child < decodeIterator.multiple; child++)
+      {
+        children.push_back(position + GetMultipleDisplacement<isAllNormal>(decodeIterator, child));
+      }
+    }
+
+    for (int32_t iValue = 0; iValue < valuesSingle; iValue++)
+    {
+      children.push_back(splitIterator.pos[splitIterator.maxChildren + iValue]);
+    }
+
+    setChildrenEnd.push_back((int32_t)children.size());
+
+    if (sigCount)
+    {
+      int32_t insigCount = 0;
+      int32_t dummy = 0;
+      int32_t dummy2 = 0;
+
+      current = 0;
+      count = sigCount;
+
+      if (isAllNormal)
+      {
+        EvalAndSplitAllNormal<false>(splitIterator, &expand, current, count, 0.0f, dummy, insigCount);
+      }
+      else
+      {
+        EvalAndSplit<false, dimensions>(splitIterator, &expand, current, count, 0.0f, dummy, dummy2, insigCount);
+      }
+
+      for (int32_t iSubSet = 0; iSubSet < insigCount; iSubSet++)
+      {
+        sets.push_back(GetListItem<isAllNormal>(splitIterator.insig, iSubSet));
+      }
+    }
+
+    setSubSetsEnd.push_back((int32_t)sets.size());
+  }
+
+  for (int32_t iSet = (int32_t)sets.size() - 1; iSet >= 0; iSet--)
+  {
+    uint32_t childMax = 0;
+    uint32_t grandChildMax = 0;
+
+    for (int32_t iChild = iSet ? setChildrenEnd[iSet - 1] : 0; iChild < setChildrenEnd[iSet]; iChild++)
+    {
+      childMax = std::max(childMax, magnitude[children[iChild]]);
+    }
+
+    for (int32_t iSubSet = iSet ? setSubSetsEnd[iSet - 1] : rootSets; iSubSet < setSubSetsEnd[iSet]; iSubSet++)
+    {
+      grandChildMax = std::max(grandChildMax, descendantMax[GetItemPosition(decodeIterator, sets[iSubSet])]);
+    }
+
+    int32_t position = GetItemPosition(decodeIterator, sets[iSet]);
+
+    descendantMax[position] = std::max(childMax, grandChildMax);
+    grandDescendantMax[position] = grandChildMax;
+  }
+}
+
+template<bool isAllNormal>
+static void WriteSignificanceBits(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, const Wavelet_FastDecodeInsig* list, int32_t current, int32_t count, const uint32_t* setMax, uint32_t significance, uint8_t* bitField)
+{
+  for (int32_t iItem = 0; iItem < count - current; iItem++)
+  {
+    if (setMax[GetItemPosition(decodeIterator, GetListItem<isAllNormal>(list, current + iItem))] >= significance)
+    {
+      bitField[iItem >> 3] |= 1 << (iItem & 7);
+    }
+  }
+}
+
+// Same traversal as DecodeTreeStructure, writing the bit fields instead of reading them
+template<bool isAllNormal, int dimensions>
+static int32_t EncodeTreeStructure(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, const uint32_t* descendantMax, const uint32_t* grandDescendantMax, std::vector<uint8_t>& stream, int32_t (&streamLevelSizes)[WAVELET_ADAPTIVE_LEVELS])
+{
+  int32_t pixelSetChildrenCount = decodeIterator.pixelSetChildrenCount;
+  int32_t pixelSetPixelInsignificantCount = decodeIterator.pixelSetPixelInsignificantCount;
+
+  int32_t* valueEncodingMultiple = decodeIterator.valueEncodingMultiple;
+  int32_t* valuesAtLevelMultiple = decodeIterator.valuesAtLevelMultiple;
+
+  int32_t* valueEncodingSingle = decodeIterator.valueEncodingSingle;
+  int32_t* valuesAtLevelSingle = decodeIterator.valuesAtLevelSingle;
+
+  int32_t numberOfValuesPerLevelMultiple[WAVELET_ADAPTIVE_LEVELS] = {};
+  int32_t numberOfValuesPerLevelSingle[WAVELET_ADAPTIVE_LEVELS] = {};
+
+  int32_t valuesMultiple = 0;
+  int32_t valuesSingle = 0;
+
+  int32_t iStreamPos = WAVELET_ADAPTIVE_LEVELS * sizeof(int);
+
+  if (!isAllNormal)
+  {
+    iStreamPos += WAVELET_ADAPTIVE_LEVELS * sizeof(int);
+  }
+
+  iStreamPos += (pixelSetChildrenCount + pixelSetPixelInsignificantCount) * int32_t(sizeof(float));
+
+  stream.assign(iStreamPos, 0);
+
+  for (int level = 0; level < WAVELET_ADAPTIVE_LEVELS; level++)
+  {
+    streamLevelSizes[level] = iStreamPos;
+  }
+
+  int32_t signValueSetMultiple = 0;
+  int32_t signValueSetSingle = 0;
+  int32_t insig = 0;
+  int32_t sig = 0;
+
+  InitializeInsignificants<isAllNormal>(decodeIterator, decodeIterator.pixelSetChildren, pixelSetChildrenCount);
+
+  insig = pixelSetChildrenCount;
+
+  float decodeBitsThreshold = decodeIterator.startThreshold;
+
+  int decodeBits = decodeIterator.decodeBits;
+
+  int multiple = isAllNormal ? decodeIterator.children[1] : 1 << dimensions;
+
+  while (decodeBits >= 0)
+  {
+    uint32_t significance = 1u << decodeBits;
+
+    int32_t insigCurrent = 0;
+    int32_t sigCurrent = 0;
+
+    while (insigCurrent < insig ||
+      sigCurrent < sig)
+    {
+      if (insigCurrent < insig)
+      {
+        int insigThisPass = insig - insigCurrent;
+
+        stream.resize(iStreamPos + (insigThisPass + 7) / 8);
+
+        uint8_t* bitField = stream.data() + iStreamPos;
+
+        iStreamPos += (insigThisPass + 7) / 8;
+
+        WriteSignificanceBits<isAllNormal>(decodeIterator, decodeIterator.insig, insigCurrent, insig, descendantMax, significance, bitField);
+
+        if (isAllNormal)
+        {
+          EvalAndSplitAllNormal<true>(decodeIterator, bitField, insigCurrent, insig, decodeBitsThreshold, valuesMultiple, sig);
+        }
+        else
+        {
+          EvalAndSplit<true, dimensions>(decodeIterator, bitField, insigCurrent, insig, decodeBitsThreshold, valuesMultiple, valuesSingle, sig);
+        }
+      }
+
+      if (sigCurrent < sig)
+      {
+        int sigThisPass = sig - sigCurrent;
+
+        stream.resize(iStreamPos + (sigThisPass + 7) / 8);
+
+        uint8_t* bitField = stream.data() + iStreamPos;
+
+        iStreamPos += (sigThisPass + 7) / 8;
+
+        WriteSignificanceBits<isAllNormal>(decodeIterator, decodeIterator.sig, sigCurrent, sig, grandDescendantMax, significance, bitField);
+
+        int32_t dummy = 0;
+        int32_t dummy2 = 0;
+
+        if (isAllNormal)
+        {
+          EvalAndSplitAllNormal<false>(decodeIterator, bitField, sigCurrent, sig, decodeBitsThreshold, dummy, insig);
+        }
+        else
+        {
+          EvalAndSplit<false, dimensions>(decodeIterator, bitField, sigCurrent, sig, decodeBitsThreshold, dummy, dummy2, insig);
+        }
+      }
+    }
+
+    valuesAtLevelMultiple[decodeBits] = valuesMultiple * multiple;
+    valueEncodingMultiple[decodeBits] = iStreamPos;
+
+    iStreamPos += (valuesMultiple * multiple + 7) / 8;
+    iStreamPos += ((valuesMultiple - signValueSetMultiple) * multiple + 7) / 8;
+
+    if (!isAllNormal)
+    {
+      valuesAtLevelSingle[decodeBits] = valuesSingle;
+      valueEncodingSingle[decodeBits] = iStreamPos;
+
+      iStreamPos += (valuesSingle + 7) / 8;
+      iStreamPos += ((valuesSingle - signValueSetSingle) + 7) / 8;
+    }
+
+    stream.resize(iStreamPos);
+
+    if (decodeBits < WAVELET_ADAPTIVE_LEVELS)
+    {
+      numberOfValuesPerLevelMultiple[decodeBits] = valuesMultiple;
+      numberOfValuesPerLevelSingle[decodeBits] = valuesSingle;
+      streamLevelSizes[decodeBits] = iStreamPos;
+    }
+
+    signValueSetMultiple = (int32_t)valuesMultiple;
+    signValueSetSingle = (int32_t)valuesSingle;
+
+    decodeBits--;
+    decodeBitsThreshold *= 0.5f;
+  }
+
+  memcpy(stream.data(), numberOfValuesPerLevelMultiple, sizeof(numberOfValuesPerLevelMultiple));
+
+  if (!isAllNormal)
+  {
+    memcpy(stream.data() + sizeof(numberOfValuesPerLevelMultiple), numberOfValuesPerLevelSingle, sizeof(numberOfValuesPerLevelSingle));
+  }
+
+  return iStreamPos;
+}
+
+static void WriteStartValues(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, uint8_t* stream)
+{
+  float* startValues = (float*)(stream + (decodeIterator.isAllNormal ? 1 : 2) * WAVELET_ADAPTIVE_LEVELS * sizeof(int32_t));
+
+  int totalValue = decodeIterator.pixelSetPixelInsignificantCount + decodeIterator.pixelSetChildrenCount;
+
+  for (int value = 0; value < totalValue; value++)
+  {
+    int pos;
+
+    if (value >= decodeIterator.pixelSetPixelInsignificantCount)
+    {
+      const Wavelet_PixelSetChildren& pixelSetChildren = decodeIterator.pixelSetChildren[value - decodeIterator.pixelSetPixelInsignificantCount];
+      pos = pixelSetChildren.x + pixelSetChildren.y * decodeIterator.sizeX + pixelSetChildren.z * decodeIterator.sizeXY;
+    }
+    else
+    {
+      const Wavelet_PixelSetPixel& pixelSetPixel = decodeIterator.pixelSetPixelInSignificant[value];
+      pos = pixelSetPixel.x + pixelSetPixel.y * decodeIterator.sizeX + pixelSetPixel.z * decodeIterator.sizeXY;
+    }
+
+    startValues[value] = decodeIterator.picture[pos];
+  }
+}
+
+// Same value order as DecodeAllBits, each value has its bits from the level it became significant and a sign bit at that level
+template<bool isMultiple, bool isAllNormal>
+static void EncodeAllBits(const WaveletAdaptiveLL_DecodeIterator& decodeIterator, const uint32_t* magnitude, uint8_t* stream, const int* valueEncoding, const int* valuesAtLevel, const int values, const int multiple, const int startDecodeBits)
+{
+  const int* positions = decodeIterator.pos;
+
+  if (!isMultiple)
+  {
+    positions += decodeIterator.maxChildren;
+  }
+
+  for (int32_t parentValue = 0; parentValue < values; parentValue++)
+  {
+    int32_t parentPosition = isMultiple ? GetMultiplePosition<isAllNormal>(decodeIterator, positions[parentValue]) : positions[parentValue];
+
+    for (int32_t child = 0; child < multiple; child++)
+    {
+      int32_t position = isMultiple ? parentPosition + GetMultipleDisplacement<isAllNormal>(decodeIterator, child) : parentPosition;
+
+      int32_t value = parentValue * multiple + child;
+
+      int32_t bit = value & 7;
+      int32_t bytePos = value >> 3;
+
+      uint32_t valueMagnitude = magnitude[position];
+
+      for (int32_t decodeBit = 0; decodeBit <= startDecodeBits; decodeBit++)
+      {
+        int32_t decodeLevelOffset = valueEncoding[decodeBit];
+
+        if (valueMagnitude & (1u << decodeBit))
+        {
+          stream[decodeLevelOffset + bytePos] |= 1 << bit;
+        }
+
+        int valuesNextLevel = 0;
+
+        if (decodeBit < startDecodeBits)
+        {
+          valuesNextLevel = valuesAtLevel[decodeBit + 1];
+        }
+
+        if (value >= valuesNextLevel)
+        {
+          assert((valueMagnitude >> (decodeBit + 1)) == 0);
+
+          int signValue = value - valuesNextLevel;
+
+          if (decodeIterator.picture[position] < 0.0f)
+          {
+            uint8_t* signEncoding = stream + decodeLevelOffset + ((valuesAtLevel[decodeBit] + 7) >> 3);
+
+            signEncoding[signValue >> 3] |= 1 << (signValue & 7);
+          }
+          break;
+        }
+      }
+    }
+  }
+}
+
+template<bool isAllNormal, int dimensions>
+static int32_t CompressAdaptive(WaveletAdaptiveLL_DecodeIterator& decodeIterator, std::vector<uint8_t>& stream, float& startThreshold, int32_t (&streamLevelSizes)[WAVELET_ADAPTIVE_LEVELS])
+{
+  std::vector<uint32_t> magnitude(decodeIterator.maxPixel);
+  std::vector<uint32_t> descendantMax(decodeIterator.maxPixel);
+  std::vector<uint32_t> grandDescendantMax(decodeIterator.maxPixel);
+
+  for (int32_t iPixel = 0; iPixel < decodeIterator.maxPixel; iPixel++)
+  {
+    magnitude[iPixel] = QuantizeMagnitude(decodeIterator.picture[iPixel], decodeIterator.threshold, decodeIterator.isInteger);
+  }
+
+  CalculateSetMaxima<isAllNormal, dimensions>(decodeIterator, magnitude.data(), descendantMax.data(), grandDescendantMax.data());
+
+  uint32_t maxMagnitude = 0;
+
+  for (int32_t iSet = 0; iSet < decodeIterator.pixelSetChildrenCount; iSet++)
+  {
+    const Wavelet_PixelSetChildren& pixelSetChildren = decodeIterator.pixelSetChildren[iSet];
+    maxMagnitude = std::max(maxMagnitude, descendantMax[pixelSetChildren.x + pixelSetChildren.y * decodeIterator.sizeX + pixelSetChildren.z * decodeIterator.sizeXY]);
+  }
+
+  // The start threshold is a power of two times the threshold so the decoder finds the same number of bits
+  int decodeBits = 0;
+
+  while (maxMagnitude >> (decodeBits + 1))
+  {
+    decodeBits++;
+  }
+
+  startThreshold = ldexpf(decodeIterator.threshold, decodeBits);
+
+  decodeIterator.decodeBits = decodeBits;
+  decodeIterator.startThreshold = startThreshold;
+
+  int32_t streamSize = EncodeTreeStructure<isAllNormal, dimensions>(decodeIterator, descendantMax.data(), grandDescendantMax.data(), stream, streamLevelSizes);
+
+  WriteStartValues(decodeIterator, stream.data());
+
+  int valuesMultiple = ((int32_t*)stream.data())[0];
+
+  if (valuesMultiple)
+  {
+    EncodeAllBits<true, isAllNormal>(decodeIterator, magnitude.data(), stream.data(), decodeIterator.valueEncodingMultiple, decodeIterator.valuesAtLevelMultiple, valuesMultiple, decodeIterator.multiple, decodeBits);
+  }
+
+  if (!isAllNormal)
+  {
+    int valuesSingle = ((int32_t*)stream.data())[WAVELET_ADAPTIVE_LEVELS];
+
+    if (valuesSingle)
+    {
+      EncodeAllBits<false, isAllNormal>(decodeIterator, magnitude.data(), stream.data(), decodeIterator.valueEncodingSingle, decodeIterator.valuesAtLevelSingle, valuesSingle, 1, decodeBits);
+    }
+  }
+
+  return streamSize;
+}
+
+int32_t WaveletAdaptiveLL_CompressAdaptive(WaveletAdaptiveLL_DecodeIterator decodeIterator, std::vector<uint8_t> &stream, float &startThreshold, int32_t (&streamLevelSizes)[WAVELET_ADAPTIVE_LEVELS])
+{
+  if (decodeIterator.isAllNormal)
+  {
+    if (decodeIterator.dimensions == 1)
+    {
+      return CompressAdaptive<true, 1>(decodeIterator, stream, startThreshold, streamLevelSizes);
+    }
+    else if (decodeIterator.dimensions == 2)
+    {
+      return CompressAdaptive<true, 2>(decodeIterator, stream, startThreshold, streamLevelSizes);
+    }
+    else
+    {
+      return CompressAdaptive<true, 3>(decodeIterator, stream, startThreshold, streamLevelSizes);
+    }
+  }
+  else
+  {
+    if (decodeIterator.dimensions == 1)
+    {
+      return CompressAdaptive<false, 1>(decodeIterator, stream, startThreshold, streamLevelSizes);
+    }
+    else if (decodeIterator.dimensions == 2)
+    {
+      return CompressAdaptive<false, 2>(decodeIterator, stream, startThreshold, streamLevelSizes);
+    }
+    else
+    {
+      return CompressAdaptive<false, 3>(decodeIterator, stream, startThreshold, streamLevelSizes);
+    }
+  }
+}
+
+// The entropy coder is only available for decompression, so each byte channel of the difference is stored either as all zero or uncompressed
+int32_t WaveletAdaptiveLL_CompressLossless(const float *original, const float *decoded, int32_t sizeX, int32_t sizeY, int32_t sizeZ, int32_t allocatedSizeX, int32_t allocatedSizeXY, std::vector<uint8_t> &out)
+{
+  int
+    nPixels = sizeX * sizeY * sizeZ;
+
+  std::vector<uint8_t> count[4];
+
+  for (int i = 0; i < 4; i++)
+  {
+    count[i].resize(nPixels);
+  }
+
+  const uint32_t *intOriginal = (const uint32_t *)original;
+  const uint32_t *intDecoded = (const uint32_t *)decoded;
+
+  uint32_t anyBits = 0;
+
+  int iWrite = 0;
+
+  for (int iZ = 0; iZ < sizeZ; iZ++)
+  {
+    for (int iY = 0; iY < sizeY; iY++)
+    {
+      for (int iX = 0; iX < sizeX; iX++)
+      {
+        int
+          iPixel = iX + iY * allocatedSizeX + iZ * allocatedSizeXY;
+
+        uint32_t
+          uValue = intOriginal[iPixel] ^ intDecoded[iPixel];
+
+        count[0][iWrite] = (uint8_t)uValue;
+        count[1][iWrite] = (uint8_t)(uValue >> 8);
+        count[2][iWrite] = (uint8_t)(uValue >> 16);
+        count[3][iWrite] = (uint8_t)(uValue >> 24);
+
+        anyBits |= uValue;
+        iWrite++;
+      }
+    }
+  }
+
+  int32_t header[5];
+
+  int totalSize = 0;
+
+  for (int i = 0; i < 4; i++)
+  {
+    if (anyBits & (0xff << (i * 8)))
+    {
+      header[i + 1] = ADAPTIVEWAVELET_LOSSLESS_CHANNEL_UNCOMPRESSED;
+      totalSize += nPixels;
+    }
+    else
+    {
+      header[i + 1] = ADAPTIVEWAVELET_LOSSLESS_CHANNEL_ZERO;
+    }
+  }
+
+  header[0] = int32_t(sizeof(header)) + totalSize;
+
+  size_t start = out.size();
+
+  out.insert(out.end(), (const uint8_t *)header, (const uint8_t *)header + sizeof(header));
+
+  for (int i = 0; i < 4; i++)
+  {
+    if (header[i + 1] == ADAPTIVEWAVELET_LOSSLESS_CHANNEL_UNCOMPRESSED)
+    {
+      out.insert(out.end(), count[i].begin(), count[i].end());
+    }
+  }
+
+  return (int32_t)(out.size() - start);
+}
+
 }
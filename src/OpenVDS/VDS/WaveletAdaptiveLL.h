@@ -21,6 +21,7 @@
 #include "WaveletTypes.h"
 
 #include <inttypes.h>
+#include <vector>
 
 namespace OpenVDS
 {
@@ -89,6 +90,12 @@ WaveletAdaptiveLL_DecodeIterator WaveletAdaptiveLL_CreateDecodeIterator(uint8_t
 
 int32_t WaveletAdaptiveLL_DecompressAdaptive(WaveletAdaptiveLL_DecodeIterator decodeIterator);
 int32_t WaveletAdaptiveLL_DecompressLossless(uint8_t *in, float *pic, int32_t sizeX, int32_t sizeY, int32_t sizeZ, int32_t allocatedSizeX, int32_t allocatedSizeXY);
+
+// Encodes the transformed picture of the iterator into a stream that WaveletAdaptiveLL_DecompressAdaptive reads. The start threshold
+// is chosen from the largest coefficient and returned, and streamLevelSizes gets the size of the stream needed to decode each adaptive level.
+int32_t WaveletAdaptiveLL_CompressAdaptive(WaveletAdaptiveLL_DecodeIterator decodeIterator, std::vector<uint8_t> &stream, float &startThreshold, int32_t (&streamLevelSizes)[WAVELET_ADAPTIVE_LEVELS]);
+// Appends the difference between the original and the decoded picture in the format WaveletAdaptiveLL_DecompressLossless reads
+int32_t WaveletAdaptiveLL_CompressLossless(const float *original, const float *decoded, int32_t sizeX, int32_t sizeY, int32_t sizeZ, int32_t allocatedSizeX, int32_t allocatedSizeXY, std::vector<uint8_t> &out);
 }
 
 #endif
@@ -30,6 +30,14 @@
 #include <xmmintrin.h>
 #include <emmintrin.h>
 #include <smmintrin.h>
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#define WAVELET_TARGET_AVX2
+#else
+// The AVX2 lifting steps are compiled for their own target and selected at runtime
+#define WAVELET_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
 
 
 namespace OpenVDS
@@ -411,41 +419,302 @@ Wavelet_TransformSlice_PredictDetail(float* write, int32_t nWritePitch, float* r
   }
 }
 
-void
-Wavelet_InverseTransformSliceInterleave(float* write, int32_t nWritePitch, float* read, int32_t nReadPitch, int32_t nSliceWidth, int32_t nSliceHeight, uint32_t integerInfo)
+// AVX2 versions of the slice lifting steps. They do the same operations in the same order as the SSE versions, eight columns at
+// a time, so the results are identical. The columns that are left over are done by the SSE versions.
+
+template<bool isInteger>
+WAVELET_TARGET_AVX2 inline void
+Wavelet_UpdateCoarseRowAVX2(float* write, float* readLow, float* const (&aprLine)[4], int32_t nVectorWidth, const __m256& mmNine, const __m256& mmSign, const __m256& mmVal)
+{
+  for (int32_t i = 0; i < nVectorWidth; i += 8)
+  {
+    __m256
+      mm0 = _mm256_loadu_ps(aprLine[0] + i),
+      mm1 = _mm256_loadu_ps(aprLine[1] + i),
+      mm2 = _mm256_loadu_ps(aprLine[2] + i),
+      mm3 = _mm256_loadu_ps(aprLine[3] + i),
+      mmLifted = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(mm0, mm3), _mm256_mul_ps(_mm256_add_ps(mm1, mm2), mmNine)), mmSign);
+
+    if (isInteger)
+    {
+      __m256 mmIntRounded = _mm256_mul_ps(_mm256_loadu_ps(readLow + i), mmVal);
+
+      // select ceil or floor based on sign bit in floating point in mmIntRounded
+      mmIntRounded = _mm256_blendv_ps(_mm256_ceil_ps(mmIntRounded), _mm256_floor_ps(mmIntRounded), mmIntRounded);
+
+      _mm256_storeu_ps(write + i, _mm256_add_ps(_mm256_round_ps(mmLifted, _MM_FROUND_RINT), mmIntRounded));
+    }
+    else
+    {
+      _mm256_storeu_ps(write + i, _mm256_add_ps(mmLifted, _mm256_mul_ps(_mm256_loadu_ps(readLow + i), mmVal)));
+    }
+  }
+}
+
+template<bool isInteger>
+WAVELET_TARGET_AVX2 inline void
+Wavelet_PredictDetailRowAVX2(float* write, float* readHigh, float* const (&aprLine)[4], int32_t nVectorWidth, const __m256& mmNine, const __m256& mmSign)
+{
+  for (int32_t i = 0; i < nVectorWidth; i += 8)
+  {
+    __m256
+      mm0 = _mm256_loadu_ps(aprLine[0] + i),
+      mm1 = _mm256_loadu_ps(aprLine[1] + i),
+      mm2 = _mm256_loadu_ps(aprLine[2] + i),
+      mm3 = _mm256_loadu_ps(aprLine[3] + i),
+      mmLifted = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(mm0, mm3), _mm256_mul_ps(_mm256_add_ps(mm1, mm2), mmNine)), mmSign);
+
+    if (isInteger)
+    {
+      mmLifted = _mm256_round_ps(mmLifted, _MM_FROUND_RINT);
+    }
+
+    _mm256_storeu_ps(write + i, _mm256_add_ps(mmLifted, _mm256_loadu_ps(readHigh + i)));
+  }
+}
+
+// readLow and write may be equal.
+template<bool isInteger>
+WAVELET_TARGET_AVX2 void
+Wavelet_TransformSlice_UpdateCoarseAVX2(float* write, int32_t nWritePitch, float* readLow, int32_t nReadLowPitch, float* readHigh, int32_t nReadHighPitch, int32_t nSliceWidth, int32_t nSliceHeight, float rSign, float rVal, bool isOdd, uint32_t integerInfo)
+{
+  int32_t
+    nVectorWidth = nSliceWidth & ~7;
+
+  if (nVectorWidth < nSliceWidth)
+  {
+    Wavelet_TransformSlice_UpdateCoarse<isInteger>(write + nVectorWidth, nWritePitch, readLow + nVectorWidth, nReadLowPitch, readHigh + nVectorWidth, nReadHighPitch, nSliceWidth - nVectorWidth, nSliceHeight, rSign, rVal, isOdd, integerInfo);
+  }
+
+  float
+    * aprLine[4];
+
+  // Clip 21
+  aprLine[0] = readHigh + nReadHighPitch;
+  aprLine[1] = readHigh;
+  aprLine[2] = readHigh;
+  readHigh += nReadHighPitch;
+
+  int32_t
+    nExtra = isOdd ? 2 : 1,
+    nDstHeightMiddle = nSliceHeight - nExtra;
+
+  if (integerInfo & WAVELET_INTEGERINFO_ISLOSSLESSOPTIMIZED)
+  {
+    rVal = 1.0f;
+  }
+
+  __m256
+    mmNine = _mm256_set1_ps(-9.0f),
+    mmSign = _mm256_set1_ps(-rSign),
+    mmVal = _mm256_set1_ps(rVal);
+
+  for (int32_t iLine = 0; iLine < nDstHeightMiddle; ++iLine)
+  {
+    aprLine[3] = readHigh;
+    readHigh += nReadHighPitch;
+
+    Wavelet_UpdateCoarseRowAVX2<isInteger>(write, readLow, aprLine, nVectorWidth, mmNine, mmSign, mmVal);
+
+    write += nWritePitch;
+    readLow += nReadLowPitch;
+
+    aprLine[0] = aprLine[1];
+    aprLine[1] = aprLine[2];
+    aprLine[2] = aprLine[3];
+  }
+
+  if (!isOdd) readHigh -= nReadHighPitch;
+
+  for (int32_t iLine = 0; iLine < nExtra; ++iLine)
+  {
+    readHigh -= nReadHighPitch;
+    aprLine[3] = readHigh;
+
+    Wavelet_UpdateCoarseRowAVX2<isInteger>(write, readLow, aprLine, nVectorWidth, mmNine, mmSign, mmVal);
+
+    write += nWritePitch;
+    readLow += nReadLowPitch;
+
+    aprLine[0] = aprLine[1];
+    aprLine[1] = aprLine[2];
+    aprLine[2] = aprLine[3];
+  }
+
+  _mm256_zeroupper();
+}
+
+// readHigh and write may be equal.
+template<bool isInteger>
+WAVELET_TARGET_AVX2 void
+Wavelet_TransformSlice_PredictDetailAVX2(float* write, int32_t nWritePitch, float* readLow, int32_t nReadLowPitch, float* readHigh, int32_t nReadHighPitch, int32_t nSliceWidth, int32_t nSliceHeight, float rSign, bool isOdd, uint32_t integerInfo)
+{
+  int32_t
+    nVectorWidth = nSliceWidth & ~7;
+
+  if (nVectorWidth < nSliceWidth)
+  {
+    Wavelet_TransformSlice_PredictDetail<isInteger>(write + nVectorWidth, nWritePitch, readLow + nVectorWidth, nReadLowPitch, readHigh + nVectorWidth, nReadHighPitch, nSliceWidth - nVectorWidth, nSliceHeight, rSign, isOdd, integerInfo);
+  }
+
+  float
+    * aprLine[4];
+
+  aprLine[0] = readLow; // New format 1
+  aprLine[1] = readLow;
+  aprLine[2] = readLow + nReadLowPitch;
+  readLow += 2 * nReadLowPitch;
+
+  int32_t
+    nExtra = isOdd ? 1 : 2,
+    nDstHeightMiddle = nSliceHeight - nExtra;
+
+  __m256
+    mmNine = _mm256_set1_ps(-9.0f),
+    mmSign = _mm256_set1_ps(rSign);
+
+  for (int32_t iLine = 0; iLine < nDstHeightMiddle; ++iLine)
+  {
+    aprLine[3] = readLow;
+    readLow += nReadLowPitch;
+
+    Wavelet_PredictDetailRowAVX2<isInteger>(write, readHigh, aprLine, nVectorWidth, mmNine, mmSign);
+
+    write += nWritePitch;
+    readHigh += nReadHighPitch;
+
+    aprLine[0] = aprLine[1];
+    aprLine[1] = aprLine[2];
+    aprLine[2] = aprLine[3];
+  }
+
+  if (isOdd) readLow -= nReadLowPitch;
+
+  for (int32_t iLine = 0; iLine < nExtra; ++iLine)
+  {
+    readLow -= nReadLowPitch;
+    aprLine[3] = readLow;
+
+    Wavelet_PredictDetailRowAVX2<isInteger>(write, readHigh, aprLine, nVectorWidth, mmNine, mmSign);
+
+    write += nWritePitch;
+    readHigh += nReadHighPitch;
+
+    aprLine[0] = aprLine[1];
+    aprLine[1] = aprLine[2];
+    aprLine[2] = aprLine[3];
+  }
+
+  _mm256_zeroupper();
+}
+
+// The inverse lifting steps of a slice, writeHigh is where the first line of the detail is written
+template<bool isInteger>
+inline void
+Wavelet_InverseTransformSliceLifting(float* write, float* writeHigh, int32_t nWritePitch, float* read, int32_t nReadPitch, int32_t nSliceWidth, int32_t nSliceHeight, uint32_t integerInfo, bool isAVX2)
 {
   int32_t
     nHeightLow = (nSliceHeight + 1) >> 1,
     nHeightHigh = nSliceHeight >> 1;
 
+  if (isAVX2)
+  {
+    Wavelet_TransformSlice_UpdateCoarseAVX2<isInteger>(write, nWritePitch, read, nReadPitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightLow, -1.0f / 32.0f, (float)REAL_INVSQRT2, nSliceHeight & 1, integerInfo);
+    Wavelet_TransformSlice_PredictDetailAVX2<isInteger>(writeHigh, nWritePitch, write, nWritePitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightHigh, -1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+  }
+  else
+  {
+    Wavelet_TransformSlice_UpdateCoarse<isInteger>(write, nWritePitch, read, nReadPitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightLow, -1.0f / 32.0f, (float)REAL_INVSQRT2, nSliceHeight & 1, integerInfo);
+    Wavelet_TransformSlice_PredictDetail<isInteger>(writeHigh, nWritePitch, write, nWritePitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightHigh, -1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+  }
+}
+
+void
+Wavelet_InverseTransformSliceInterleave(float* write, int32_t nWritePitch, float* read, int32_t nReadPitch, int32_t nSliceWidth, int32_t nSliceHeight, uint32_t integerInfo, bool isAVX2)
+{
   if (integerInfo & WAVELET_INTEGERINFO_ISINTEGER)
   {
-    Wavelet_TransformSlice_UpdateCoarse<true>(write, 2 * nWritePitch, read, nReadPitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightLow, -1.0f / 32.0f, (float)REAL_INVSQRT2, nSliceHeight & 1, integerInfo);
-    Wavelet_TransformSlice_PredictDetail<true>(write + nWritePitch, 2 * nWritePitch, write, 2 * nWritePitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightHigh, -1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+    Wavelet_InverseTransformSliceLifting<true>(write, write + nWritePitch, 2 * nWritePitch, read, nReadPitch, nSliceWidth, nSliceHeight, integerInfo, isAVX2);
   }
   else
   {
-    Wavelet_TransformSlice_UpdateCoarse<false>(write, 2 * nWritePitch, read, nReadPitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightLow, -1.0f / 32.0f, (float)REAL_INVSQRT2, nSliceHeight & 1, integerInfo);
-    Wavelet_TransformSlice_PredictDetail<false>(write + nWritePitch, 2 * nWritePitch, write, 2 * nWritePitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightHigh, -1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+    Wavelet_InverseTransformSliceLifting<false>(write, write + nWritePitch, 2 * nWritePitch, read, nReadPitch, nSliceWidth, nSliceHeight, integerInfo, isAVX2);
   }
 }
 
 void
-Wavelet_InverseTransformSlice(float* write, int32_t nWritePitch, float* read, int32_t nReadPitch, int32_t nSliceWidth, int32_t nSliceHeight, uint32_t integerInfo)
+Wavelet_InverseTransformSlice(float* write, int32_t nWritePitch, float* read, int32_t nReadPitch, int32_t nSliceWidth, int32_t nSliceHeight, uint32_t integerInfo, bool isAVX2)
+{
+  int32_t
+    nHeightLow = (nSliceHeight + 1) >> 1;
+
+  if (integerInfo & WAVELET_INTEGERINFO_ISINTEGER)
+  {
+    Wavelet_InverseTransformSliceLifting<true>(write, write + nHeightLow * nWritePitch, nWritePitch, read, nReadPitch, nSliceWidth, nSliceHeight, integerInfo, isAVX2);
+  }
+  else
+  {
+    Wavelet_InverseTransformSliceLifting<false>(write, write + nHeightLow * nWritePitch, nWritePitch, read, nReadPitch, nSliceWidth, nSliceHeight, integerInfo, isAVX2);
+  }
+}
+
+inline void
+Wavelet_ScaleLine(float* readWrite, int32_t nLength, float rScale)
+{
+  __m128
+    mmScale = _mm_set1_ps(rScale);
+
+  int32_t
+    i = 0;
+
+  for (; i + 4 <= nLength; i += 4)
+  {
+    _mm_storeu_ps(readWrite + i, _mm_mul_ps(_mm_loadu_ps(readWrite + i), mmScale));
+  }
+
+  for (; i < nLength; ++i)
+  {
+    readWrite[i] *= rScale;
+  }
+}
+
+// The forward transform of a slice is the inverse of Wavelet_InverseTransformSliceInterleave, the lines are deinterleaved into write
+// and the lifting steps are done in place in the reverse order with the opposite sign.
+void
+Wavelet_ForwardTransformSliceDeinterleave(float* write, int32_t nWritePitch, float* read, int32_t nReadPitch, int32_t nSliceWidth, int32_t nSliceHeight, uint32_t integerInfo)
 {
   int32_t
     nHeightLow = (nSliceHeight + 1) >> 1,
     nHeightHigh = nSliceHeight >> 1;
 
+  for (int32_t iLine = 0; iLine < nSliceHeight; ++iLine)
+  {
+    int32_t
+      iLineDeinterleaved = (iLine >> 1) + ((iLine & 1) ? nHeightLow : 0);
+
+    memcpy(write + iLineDeinterleaved * nWritePitch, read + iLine * nReadPitch, nSliceWidth * sizeof(float));
+  }
+
+  float
+    * writeHigh = write + nHeightLow * nWritePitch;
+
   if (integerInfo & WAVELET_INTEGERINFO_ISINTEGER)
   {
-    Wavelet_TransformSlice_UpdateCoarse<true>(write, nWritePitch, read, nReadPitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightLow, -1.0f / 32.0f, (float)REAL_INVSQRT2, nSliceHeight & 1, integerInfo);
-    Wavelet_TransformSlice_PredictDetail<true>(write + nHeightLow * nWritePitch, nWritePitch, write, nWritePitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightHigh, -1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+    Wavelet_TransformSlice_PredictDetail<true>(writeHigh, nWritePitch, write, nWritePitch, writeHigh, nWritePitch, nSliceWidth, nHeightHigh, 1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+    Wavelet_TransformSlice_UpdateCoarse<true>(write, nWritePitch, write, nWritePitch, writeHigh, nWritePitch, nSliceWidth, nHeightLow, 1.0f / 32.0f, 1.0f, nSliceHeight & 1, integerInfo);
   }
   else
   {
-    Wavelet_TransformSlice_UpdateCoarse<false>(write, nWritePitch, read, nReadPitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightLow, -1.0f / 32.0f, (float)REAL_INVSQRT2, nSliceHeight & 1, integerInfo);
-    Wavelet_TransformSlice_PredictDetail<false>(write + nHeightLow * nWritePitch, nWritePitch, write, nWritePitch, read + nHeightLow * nReadPitch, nReadPitch, nSliceWidth, nHeightHigh, -1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+    Wavelet_TransformSlice_PredictDetail<false>(writeHigh, nWritePitch, write, nWritePitch, writeHigh, nWritePitch, nSliceWidth, nHeightHigh, 1.0f / 16.0f, nSliceHeight & 1, integerInfo);
+    Wavelet_TransformSlice_UpdateCoarse<false>(write, nWritePitch, write, nWritePitch, writeHigh, nWritePitch, nSliceWidth, nHeightLow, 1.0f / 32.0f, 1.0f, nSliceHeight & 1, integerInfo);
+  }
+
+  if (!(integerInfo & WAVELET_INTEGERINFO_ISLOSSLESSOPTIMIZED))
+  {
+    for (int32_t iLine = 0; iLine < nHeightLow; ++iLine)
+    {
+      Wavelet_ScaleLine(write + iLine * nWritePitch, nSliceWidth, (float)REAL_SQRT2);
+    }
   }
 }
 
@@ -793,6 +1062,57 @@ Wavelet_InterleaveLine(float* write, float* readLow, float* readHigh, int32_t nL
   }
 }
 
+
+inline void
+Wavelet_DeinterleaveLine(float* writeLow, float* writeHigh, float* read, int32_t nLength)
+{
+  int32_t i = 0;
+
+  for (; i + 8 <= nLength; i += 8)
+  {
+    __m128 mm0 = _mm_loadu_ps(read + i);
+    __m128 mm1 = _mm_loadu_ps(read + i + 4);
+
+    _mm_storeu_ps(writeLow + (i >> 1), _mm_shuffle_ps(mm0, mm1, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(writeHigh + (i >> 1), _mm_shuffle_ps(mm0, mm1, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+
+  for (; i + 2 <= nLength; i += 2)
+  {
+    writeLow[i >> 1] = read[i];
+    writeHigh[i >> 1] = read[i + 1];
+  }
+
+  if (nLength & 1)
+  {
+    writeLow[i >> 1] = read[i];
+  }
+}
+
+// Forward transform of a deinterleaved line, the inverse of Wavelet_InverseTransformLine
+inline void
+Wavelet_ForwardTransformLine(float* readWrite, int32_t nLength, uint32_t integerInfo)
+{
+  int32_t nLengthLow = (nLength + 1) >> 1;
+  int32_t nLengthHigh = nLength >> 1;
+
+  if (integerInfo & WAVELET_INTEGERINFO_ISINTEGER)
+  {
+    Wavelet_TransformLine_PredictDetail<true>(readWrite + nLengthLow, readWrite, nLengthHigh, 1.0f / 16.0f, nLength & 1, integerInfo);
+    Wavelet_TransformLine_UpdateCoarse<true>(readWrite, readWrite + nLengthLow, nLengthLow, 1.0f / 32.0f, 1.0f, nLength & 1, integerInfo);
+  }
+  else
+  {
+    Wavelet_TransformLine_PredictDetail<false>(readWrite + nLengthLow, readWrite, nLengthHigh, 1.0f / 16.0f, nLength & 1, integerInfo);
+    Wavelet_TransformLine_UpdateCoarse<false>(readWrite, readWrite + nLengthLow, nLengthLow, 1.0f / 32.0f, 1.0f, nLength & 1, integerInfo);
+  }
+
+  if (!(integerInfo & WAVELET_INTEGERINFO_ISLOSSLESSOPTIMIZED))
+  {
+    Wavelet_ScaleLine(readWrite, nLengthLow, (float)REAL_SQRT2);
+  }
+}
+
 }
 
 #endif //IFDEF ENABLE_SSE_TRANSFORM
@@ -146,6 +146,12 @@ enum Wavelet_IntegerInfo
 };
 
 bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataSize, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool isNormalize, int nDecompressLevel, bool isLossless, DataBlock &dataBlock, std::vector<uint8_t> &target, Error &error);
+// Decompresses into a buffer of targetSize bytes, which only works when the decompressed data block is linear
+bool Wavelet_Decompress(const void *compressedData, int nCompressedAdaptiveDataSize, VolumeDataChannelDescriptor::Format dataBlockFormat, const FloatRange &valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, bool isNormalize, int nDecompressLevel, bool isLossless, DataBlock &dataBlock, void *target, int64_t targetSize, Error &error);
+
+// Compresses a single component R32, U8 or U16 data block into the format Wavelet_Decompress reads. The adaptive level sizes are the
+// size of the compressed data needed to decode each adaptive level, as expected by Wavelet_EncodeAdaptiveLevelsMetadata.
+bool Wavelet_Compress(const DataBlock &dataBlock, const void *data, const FloatRange &valueRange, bool isUseNoValue, float noValue, float compressionTolerance, bool isLossless, std::vector<uint8_t> &compressedData, int (&adaptiveLevelSizes)[WAVELET_ADAPTIVE_LEVELS], Error &error);
 
 struct Wavelet_PixelSetPixel
 {
@@ -16,15 +16,46 @@
 ****************************************************************************/
 
 #include <SEGYUtils/SEGY.h>
+#include "SEGYConversion.h"
 
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ENABLE_SSE_SEGY 1
+#endif
+
+#ifdef ENABLE_SSE_SEGY
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SEGY_TARGET_SSE41
+#define SEGY_TARGET_AVX2
+#else
+// The library is built for the baseline instruction set, so the SIMD kernels are compiled for their own target and selected at runtime
+#define SEGY_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SEGY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 namespace SEGY
 {
 
+/////////////////////////////////////////////////////////////////////////////
+// Byte swapping
+
+static inline uint32_t
+ByteSwap(uint32_t value)
+{
+#ifdef WIN32
+  return _byteswap_ulong(value);
+#else
+  return __builtin_bswap32(value);
+#endif // WIN32
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ibm2ieee
 
@@ -40,131 +71,112 @@ sign). When precision is lost, rounding is toward zero (because it's
 fast and easy -- if someone really wants round to nearest it shouldn't
 be TOO difficult). */
 
-void
-Ibm2ieee(void *to, const void *from, size_t len)
+// Convert a single IBM float (already in native byte order) to the bits of an IEEE float
+static inline uint32_t
+Ibm2ieeeValue(uint32_t fr)
 {
-  for (; len-- > 0; to = (char *)to + 4, from = (const char *)from + 4)
-  {
-    unsigned int
-      fr = *(const uint32_t *)from;
+  if (fr == 0)
+  { 
+    /* short-circuit for everything is zero. Then (also endian converted) matissa also is */
+    return 0x00000000;
+  }
 
-    if (fr == 0)
-    { 
-      /* short-circuit for everything is zero. Then (also endian converted) matissa also is */
+  unsigned int
+    sgn = fr & 0x80000000; /* save sign */
 
-      *(unsigned *)to = 0x00000000;
+  unsigned int
+    expIBM4 = (fr & 0x7f000000) >> 22;   // i.e. 4 * expIBM, shift (24 down and then 2 up in one go).
 
-      continue;
-    }
+  fr &= 0x00ffffff;
 
-#ifdef WIN32
-    fr =_byteswap_ulong(fr);
-#else
-    fr = __builtin_bswap32(fr);
-#endif // WIN32
+  if (fr == 0)
+  { 
+    /* short-circuit for zero matissa*/
+    return sgn;  // Matissa all zeroes, set exponent all zero, maintain sign.
+  }
 
-    unsigned int
-      sgn = fr & 0x80000000; /* save sign */
+  // The involved magic numbers will fall out when studying the IEEE and IBM representations.
 
-    unsigned int
-      expIBM4 = (fr & 0x7f000000) >> 22;   // i.e. 4 * expIBM, shift (24 down and then 2 up in one go).
+  const bool
+    isNormalNumberEnsured = (expIBM4 > 154) && (expIBM4 < 385);
 
-    fr &= 0x00ffffff;
+  // Inside this range, none of the special considerations needs be taken. 
 
-    if (fr == 0)
-    { 
-      /* short-circuit for zero matissa*/
-      *(unsigned *)to = sgn;  // Matissa all zeroes, set exponent all zero, maintain sign.
-     
-      continue;
-    }
+  if (isNormalNumberEnsured)
+  {
+    // This approach is what the SIMD kernels below do for all lanes in the normal range.
 
-    // The involved magic numbers will fall out when studying the IEEE and IBM representations.
-  
-    const bool
-      isNormalNumberEnsured = (expIBM4 > 154) && (expIBM4 < 385);
+    // First let the CPU instruction convert the IBM matissa conversion into an IEEE float.
+    // This will handle the possible leading zeroes on the IBM matissa without any loop,
+    // or use of count leading zero instuction, which is not part of SSE (to the version
+    // we can currently assume in common use.)
 
-    // Inside this range, none of the special considerations needs be taken. 
+    float
+      rValue = float (fr);
 
-    if (isNormalNumberEnsured)
-    {
-      // This approach should be SSE friendly, for further optimization.
+    uint32_t
+      uValue;
+    memcpy(&uValue, &rValue, sizeof(uValue));
 
-      // First let the CPU instruction convert the IBM matissa conversion into an IEEE float.
-      // This will handle the possible leading zeroes on the IBM matissa without any loop,
-      // or use of count leading zero instuction, which is not part of SSE (to the version
-      // we can currently assume in common use.)
+    // Then mod the exponent on the IEEE number, and we are done.
 
-      float
-        rValue = float (fr);
+    uint32_t
+      uExp = (expIBM4 - uint32_t(280)) << 23;
+
+    uValue = uValue + uExp; 
+
+    return uValue | sgn;
+  }
 
-      uint32_t
-        uValue;
-      memcpy(&uValue, &rValue, sizeof(uValue));
+  // Note: This part is able to handle all cases (i.e. also the normal range above).
 
-      // Then mod the exponent on the IEEE number, and we are done.
+  /*
+  adjust exponent from base 16 offset 64 radix point before first digit
+      to base 2 offset 127 radix point after first digit
+  (exp - 64) * 4 + 127 - 1 == exp * 4 - 256 + 126 == (exp << 2) - 130
+  */
+  int
+    expModified = expIBM4 - 130;
 
-      uint32_t
-        uExp = (expIBM4 - uint32_t(280)) << 23;
+  int
+    nNormalizeShift = 0;
 
-      uValue = uValue + uExp; 
+  /* normalize */
+  while (fr < 0x00800000)
+  {
+    fr <<= 1;
+    nNormalizeShift++;
+  }
 
-      *(unsigned int*)to = (uValue | sgn);
+  expModified = expModified - nNormalizeShift;
 
+  if (expModified <= 0)
+  { 
+    /* underflow */
+    if (expModified < -23)
+    {
+      /* complete underflow - return properly signed zero */
+      fr = 0;
     }
     else
     {
-      // Note: This else clause is able to handle all cases (i.e. also the normal range above).
-
-       /*
-      adjust exponent from base 16 offset 64 radix point before first digit
-          to base 2 offset 127 radix point after first digit
-      (exp - 64) * 4 + 127 - 1 == exp * 4 - 256 + 126 == (exp << 2) - 130
-      */
-      int
-        expModified = expIBM4 - 130;
-
-      int
-        nNormalizeShift = 0;
-
-      /* normalize */
-      while (fr < 0x00800000)
-      {
-        fr <<= 1;
-        nNormalizeShift++;
-      }
-
-      expModified = expModified - nNormalizeShift;
-
-      if (expModified <= 0)
-      { 
-        /* underflow */
-        if (expModified < -23)
-        {
-          /* complete underflow - return properly signed zero */
-          fr = 0;
-        }
-        else
-        {
-          /* partial underflow - return denormalized number */
-          fr >>= 1-expModified;
-        }
-        expModified = 0;
-      }
-      else if (expModified >= 255)
-      { 
-        /* overflow - return infinity */
-        fr = 0;
-        expModified = 255;
-      }
-      else
-      { 
-        /* Standard number - assumed high bit masked away below */
-      }
-
-      *(unsigned *)to = (fr & 0x007fffff) | (expModified << 23) | sgn;  
+      /* partial underflow - return denormalized number */
+      fr >>= 1-expModified;
     }
+    expModified = 0;
+  }
+  else if (expModified >= 255)
+  { 
+    /* overflow - return infinity */
+    fr = 0;
+    expModified = 255;
   }
+  else
+  { 
+    /* Standard number - assumed high bit masked away below */
+  }
+
+  return (fr & 0x007fffff) | (expModified << 23) | sgn;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -178,57 +190,481 @@ IBM 370 number. When precision is lost, rounding is toward zero
 (because it's fast and easy -- if someone really wants round to nearest
 it shouldn't be TOO difficult). */
 
-void
-Ieee2ibm(void *to, const void *from, size_t len)
+// Convert the bits of a single IEEE float to an IBM float in native byte order
+static inline uint32_t
+Ieee2ibmValue(uint32_t fr)
 {
-  unsigned fr; /* fraction */
   int exp; /* exponent */
   int sgn; /* sign */
 
-  for (; len-- > 0; to = (char *)to + 4, from = (const char *)from + 4)
+      /* split into sign, exponent, and fraction */
+  sgn = fr >> 31; /* save sign */
+  fr <<= 1; /* shift sign out */
+  exp = fr >> 24; /* save exponent */
+  fr <<= 8; /* shift exponent out */
+
+  if (exp == 255) { /* infinity (or NAN) - map to largest */
+    fr = 0xffffff00;
+    exp = 0x7f;
+    goto done;
+  }
+  else if (exp > 0) /* add assumed digit */
+    fr = (fr >> 1) | 0x80000000;
+  else if (fr == 0) /* short-circuit for zero */
+    goto done;
+
+      /* adjust exponent from base 2 offset 127 radix point after first digit
+         to base 16 offset 64 radix point before first digit */
+  exp += 130;
+  fr >>= -exp & 3;
+  exp = (exp + 3) >> 2;
+
+      /* (re)normalize */
+  while (fr < 0x10000000)
+  { /* never executed for normalized input */
+    --exp;
+    fr <<= 4;
+  }
+
+  done:
+/* put the pieces back together and return it */
+  return (fr >> 8) | (exp << 24) | (unsigned(sgn) << 31);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+
+static void
+Ibm2ieeeScalar(void *to, const void *from, size_t len, Endianness fromEndianness)
+{
+  const bool swap = (fromEndianness == Endianness::BigEndian);
+
+  for (size_t i = 0; i < len; i++)
+  {
+    uint32_t value;
+    memcpy(&value, (const char *)from + i * 4, sizeof(value));
+    value = Ibm2ieeeValue(swap ? ByteSwap(value) : value);
+    memcpy((char *)to + i * 4, &value, sizeof(value));
+  }
+}
+
+static void
+Ieee2ibmScalar(void *to, const void *from, size_t len, Endianness toEndianness)
+{
+  const bool swap = (toEndianness == Endianness::BigEndian);
+
+  for (size_t i = 0; i < len; i++)
   {
-        /* split into sign, exponent, and fraction */
-    fr = *(const unsigned *)from; /* pick up value */
-    sgn = fr >> 31; /* save sign */
-    fr <<= 1; /* shift sign out */
-    exp = fr >> 24; /* save exponent */
-    fr <<= 8; /* shift exponent out */
-
-    if (exp == 255) { /* infinity (or NAN) - map to largest */
-      fr = 0xffffff00;
-      exp = 0x7f;
-      goto done;
+    uint32_t value;
+    memcpy(&value, (const char *)from + i * 4, sizeof(value));
+    value = Ieee2ibmValue(value);
+    value = swap ? ByteSwap(value) : value;
+    memcpy((char *)to + i * 4, &value, sizeof(value));
+  }
+}
+
+static void
+ByteSwap32Scalar(void *to, const void *from, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    uint32_t value;
+    memcpy(&value, (const char *)from + i * 4, sizeof(value));
+    value = ByteSwap(value);
+    memcpy((char *)to + i * 4, &value, sizeof(value));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SIMD kernels
+//
+// The kernels convert every lane with the fast path of the scalar code and
+// re-convert the (rare) lanes that need the general path with the scalar
+// code, so the results are bit-exact with the scalar kernels. Byte swapping
+// is fused into the load or store so the data only passes through once.
+
+#ifdef ENABLE_SSE_SEGY
+
+static void
+PatchIbm2ieee(uint32_t *to, const uint32_t *lanes, int mask)
+{
+  for (int lane = 0; mask; lane++, mask >>= 1)
+  {
+    if (mask & 1) to[lane] = Ibm2ieeeValue(lanes[lane]);
+  }
+}
+
+static void
+PatchIeee2ibm(uint32_t *to, const uint32_t *lanes, int mask, bool swap)
+{
+  for (int lane = 0; mask; lane++, mask >>= 1)
+  {
+    if (mask & 1) to[lane] = swap ? ByteSwap(Ieee2ibmValue(lanes[lane])) : Ieee2ibmValue(lanes[lane]);
+  }
+}
+
+SEGY_TARGET_SSE41 static void
+Ibm2ieeeSSE41(void *to, const void *from, size_t len, Endianness fromEndianness)
+{
+  const bool swap = (fromEndianness == Endianness::BigEndian);
+
+  const __m128i byteSwap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m128i signMask = _mm_set1_epi32(int(0x80000000));
+  const __m128i fractionMask = _mm_set1_epi32(0x00ffffff);
+  const __m128i exponentMask = _mm_set1_epi32(0x7f);
+  const __m128i exponentBias = _mm_set1_epi32(int(280u << 23));
+  const __m128i minNormalExponent = _mm_set1_epi32(39);
+  const __m128i maxNormalExponent = _mm_set1_epi32(96);
+  const __m128i zero = _mm_setzero_si128();
+
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4)
+  {
+    __m128i value = _mm_loadu_si128((const __m128i *)((const char *)from + i * 4));
+    if (swap) value = _mm_shuffle_epi8(value, byteSwap);
+
+    __m128i sign = _mm_and_si128(value, signMask);
+    __m128i fraction = _mm_and_si128(value, fractionMask);
+    __m128i exponent = _mm_and_si128(_mm_srli_epi32(value, 24), exponentMask);
+
+    // float(fraction) normalizes the fraction, then the exponent is adjusted by (4 * expIBM - 280)
+    __m128i result = _mm_castps_si128(_mm_cvtepi32_ps(fraction));
+    result = _mm_add_epi32(result, _mm_sub_epi32(_mm_slli_epi32(exponent, 25), exponentBias));
+    result = _mm_or_si128(result, sign);
+
+    // A zero fraction gives a signed zero
+    __m128i isZero = _mm_cmpeq_epi32(fraction, zero);
+    result = _mm_blendv_epi8(result, sign, isZero);
+
+    // Exponents outside the range where the fast path is exact need the scalar code
+    __m128i isOutside = _mm_or_si128(_mm_cmplt_epi32(exponent, minNormalExponent), _mm_cmpgt_epi32(exponent, maxNormalExponent));
+    int patchMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(isZero, isOutside)));
+
+    uint32_t *target = (uint32_t *)((char *)to + i * 4);
+    if (patchMask)
+    {
+      uint32_t lanes[4];
+      _mm_storeu_si128((__m128i *)lanes, value);
+      _mm_storeu_si128((__m128i *)target, result);
+      PatchIbm2ieee(target, lanes, patchMask);
     }
-    else if (exp > 0) /* add assumed digit */
-      fr = (fr >> 1) | 0x80000000;
-    else if (fr == 0) /* short-circuit for zero */
-      goto done;
-
-        /* adjust exponent from base 2 offset 127 radix point after first digit
-           to base 16 offset 64 radix point before first digit */
-    exp += 130;
-    fr >>= -exp & 3;
-    exp = (exp + 3) >> 2;
-
-        /* (re)normalize */
-    while (fr < 0x10000000)
-    { /* never executed for normalized input */
-      --exp;
-      fr <<= 4;
+    else
+    {
+      _mm_storeu_si128((__m128i *)target, result);
     }
+  }
 
-    done:
-/* put the pieces back together and return it */
-    fr = (fr >> 8) | (exp << 24) | (sgn << 31);
+  Ibm2ieeeScalar((char *)to + i * 4, (const char *)from + i * 4, len - i, fromEndianness);
+}
 
-#ifdef WIN32
-    fr =_byteswap_ulong(fr);
-#else
-    fr = __builtin_bswap32(fr);
-#endif // WIN32
+SEGY_TARGET_SSE41 static void
+Ieee2ibmSSE41(void *to, const void *from, size_t len, Endianness toEndianness)
+{
+  const bool swap = (toEndianness == Endianness::BigEndian);
+
+  const __m128i byteSwap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m128i signMask = _mm_set1_epi32(int(0x80000000));
+  const __m128i magnitudeMask = _mm_set1_epi32(0x7fffffff);
+  const __m128i mantissaMask = _mm_set1_epi32(0x007fffff);
+  const __m128i implicitBit = _mm_set1_epi32(0x00800000);
+  const __m128i exponentMask = _mm_set1_epi32(0xff);
+  const __m128i largestIBM = _mm_set1_epi32(0x7fffffff);
+  const __m128i three = _mm_set1_epi32(3);
+  const __m128i zero = _mm_setzero_si128();
+
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4)
+  {
+    __m128i value = _mm_loadu_si128((const __m128i *)((const char *)from + i * 4));
+
+    __m128i sign = _mm_and_si128(value, signMask);
+    __m128i exponent = _mm_and_si128(_mm_srli_epi32(value, 23), exponentMask);
+    __m128i fraction = _mm_or_si128(_mm_and_si128(value, mantissaMask), implicitBit);
+
+    // The fraction is shifted right by (-(exp + 130) & 3) to align it with a base 16 exponent.
+    // SSE has no per-lane variable shift, so select between shifts by 1 and 2 using the bits of the shift count.
+    __m128i shift = _mm_and_si128(_mm_sub_epi32(zero, _mm_add_epi32(exponent, _mm_set1_epi32(2))), three);
+    fraction = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(fraction), _mm_castsi128_ps(_mm_srli_epi32(fraction, 1)), _mm_castsi128_ps(_mm_slli_epi32(shift, 31))));
+    fraction = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(fraction), _mm_castsi128_ps(_mm_srli_epi32(fraction, 2)), _mm_castsi128_ps(_mm_slli_epi32(shift, 30))));
+
+    __m128i result = _mm_or_si128(_mm_or_si128(fraction, _mm_slli_epi32(_mm_srli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(133)), 2), 24)), sign);
+
+    // Infinity and NaN map to the largest IBM number, zero maps to a signed zero
+    __m128i isInfinity = _mm_cmpeq_epi32(exponent, exponentMask);
+    result = _mm_blendv_epi8(result, _mm_or_si128(largestIBM, sign), isInfinity);
+    __m128i isZero = _mm_cmpeq_epi32(_mm_and_si128(value, magnitudeMask), zero);
+    result = _mm_blendv_epi8(result, sign, isZero);
+
+    // Denormals need the scalar code
+    int patchMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(isZero, _mm_cmpeq_epi32(exponent, zero))));
 
-    *(unsigned *)to = fr;
+    if (swap) result = _mm_shuffle_epi8(result, byteSwap);
+
+    uint32_t *target = (uint32_t *)((char *)to + i * 4);
+    if (patchMask)
+    {
+      uint32_t lanes[4];
+      _mm_storeu_si128((__m128i *)lanes, value);
+      _mm_storeu_si128((__m128i *)target, result);
+      PatchIeee2ibm(target, lanes, patchMask, swap);
+    }
+    else
+    {
+      _mm_storeu_si128((__m128i *)target, result);
+    }
   }
+
+  Ieee2ibmScalar((char *)to + i * 4, (const char *)from + i * 4, len - i, toEndianness);
+}
+
+SEGY_TARGET_SSE41 static void
+ByteSwap32SSE41(void *to, const void *from, size_t len)
+{
+  const __m128i byteSwap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4)
+  {
+    __m128i value = _mm_loadu_si128((const __m128i *)((const char *)from + i * 4));
+    _mm_storeu_si128((__m128i *)((char *)to + i * 4), _mm_shuffle_epi8(value, byteSwap));
+  }
+
+  ByteSwap32Scalar((char *)to + i * 4, (const char *)from + i * 4, len - i);
+}
+
+SEGY_TARGET_AVX2 static void
+Ibm2ieeeAVX2(void *to, const void *from, size_t len, Endianness fromEndianness)
+{
+  const bool swap = (fromEndianness == Endianness::BigEndian);
+
+  const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m256i signMask = _mm256_set1_epi32(int(0x80000000));
+  const __m256i fractionMask = _mm256_set1_epi32(0x00ffffff);
+  const __m256i exponentMask = _mm256_set1_epi32(0x7f);
+  const __m256i exponentBias = _mm256_set1_epi32(int(280u << 23));
+  const __m256i minNormalExponent = _mm256_set1_epi32(39);
+  const __m256i maxNormalExponent = _mm256_set1_epi32(96);
+  const __m256i zero = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8)
+  {
+    __m256i value = _mm256_loadu_si256((const __m256i *)((const char *)from + i * 4));
+    if (swap) value = _mm256_shuffle_epi8(value, byteSwap);
+
+    __m256i sign = _mm256_and_si256(value, signMask);
+    __m256i fraction = _mm256_and_si256(value, fractionMask);
+    __m256i exponent = _mm256_and_si256(_mm256_srli_epi32(value, 24), exponentMask);
+
+    __m256i result = _mm256_castps_si256(_mm256_cvtepi32_ps(fraction));
+    result = _mm256_add_epi32(result, _mm256_sub_epi32(_mm256_slli_epi32(exponent, 25), exponentBias));
+    result = _mm256_or_si256(result, sign);
+
+    __m256i isZero = _mm256_cmpeq_epi32(fraction, zero);
+    result = _mm256_blendv_epi8(result, sign, isZero);
+
+    __m256i isOutside = _mm256_or_si256(_mm256_cmpgt_epi32(minNormalExponent, exponent), _mm256_cmpgt_epi32(exponent, maxNormalExponent));
+    int patchMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(isZero, isOutside)));
+
+    uint32_t *target = (uint32_t *)((char *)to + i * 4);
+    if (patchMask)
+    {
+      uint32_t lanes[8];
+      _mm256_storeu_si256((__m256i *)lanes, value);
+      _mm256_storeu_si256((__m256i *)target, result);
+      PatchIbm2ieee(target, lanes, patchMask);
+    }
+    else
+    {
+      _mm256_storeu_si256((__m256i *)target, result);
+    }
+  }
+
+  Ibm2ieeeSSE41((char *)to + i * 4, (const char *)from + i * 4, len - i, fromEndianness);
+}
+
+SEGY_TARGET_AVX2 static void
+Ieee2ibmAVX2(void *to, const void *from, size_t len, Endianness toEndianness)
+{
+  const bool swap = (toEndianness == Endianness::BigEndian);
+
+  const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m256i signMask = _mm256_set1_epi32(int(0x80000000));
+  const __m256i magnitudeMask = _mm256_set1_epi32(0x7fffffff);
+  const __m256i mantissaMask = _mm256_set1_epi32(0x007fffff);
+  const __m256i implicitBit = _mm256_set1_epi32(0x00800000);
+  const __m256i exponentMask = _mm256_set1_epi32(0xff);
+  const __m256i largestIBM = _mm256_set1_epi32(0x7fffffff);
+  const __m256i three = _mm256_set1_epi32(3);
+  const __m256i zero = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8)
+  {
+    __m256i value = _mm256_loadu_si256((const __m256i *)((const char *)from + i * 4));
+
+    __m256i sign = _mm256_and_si256(value, signMask);
+    __m256i exponent = _mm256_and_si256(_mm256_srli_epi32(value, 23), exponentMask);
+    __m256i fraction = _mm256_or_si256(_mm256_and_si256(value, mantissaMask), implicitBit);
+
+    __m256i shift = _mm256_and_si256(_mm256_sub_epi32(zero, _mm256_add_epi32(exponent, _mm256_set1_epi32(2))), three);
+    fraction = _mm256_srlv_epi32(fraction, shift);
+
+    __m256i result = _mm256_or_si256(_mm256_or_si256(fraction, _mm256_slli_epi32(_mm256_srli_epi32(_mm256_add_epi32(exponent, _mm256_set1_epi32(133)), 2), 24)), sign);
+
+    __m256i isInfinity = _mm256_cmpeq_epi32(exponent, exponentMask);
+    result = _mm256_blendv_epi8(result, _mm256_or_si256(largestIBM, sign), isInfinity);
+    __m256i isZero = _mm256_cmpeq_epi32(_mm256_and_si256(value, magnitudeMask), zero);
+    result = _mm256_blendv_epi8(result, sign, isZero);
+
+    int patchMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(isZero, _mm256_cmpeq_epi32(exponent, zero))));
+
+    if (swap) result = _mm256_shuffle_epi8(result, byteSwap);
+
+    uint32_t *target = (uint32_t *)((char *)to + i * 4);
+    if (patchMask)
+    {
+      uint32_t lanes[8];
+      _mm256_storeu_si256((__m256i *)lanes, value);
+      _mm256_storeu_si256((__m256i *)target, result);
+      PatchIeee2ibm(target, lanes, patchMask, swap);
+    }
+    else
+    {
+      _mm256_storeu_si256((__m256i *)target, result);
+    }
+  }
+
+  Ieee2ibmSSE41((char *)to + i * 4, (const char *)from + i * 4, len - i, toEndianness);
+}
+
+SEGY_TARGET_AVX2 static void
+ByteSwap32AVX2(void *to, const void *from, size_t len)
+{
+  const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8)
+  {
+    __m256i value = _mm256_loadu_si256((const __m256i *)((const char *)from + i * 4));
+    _mm256_storeu_si256((__m256i *)((char *)to + i * 4), _mm256_shuffle_epi8(value, byteSwap));
+  }
+
+  ByteSwap32SSE41((char *)to + i * 4, (const char *)from + i * 4, len - i);
+}
+
+#endif // ENABLE_SSE_SEGY
+
+/////////////////////////////////////////////////////////////////////////////
+// Runtime dispatch
+
+namespace Conversion
+{
+
+static InstructionSet
+DetectInstructionSet()
+{
+#if defined(ENABLE_SSE_SEGY) && defined(_MSC_VER)
+  int cpuInfo[4];
+  __cpuid(cpuInfo, 0);
+  int maxLeaf = cpuInfo[0];
+
+  __cpuid(cpuInfo, 1);
+  bool isSSE41 = (cpuInfo[2] & (1 << 19)) != 0;
+  bool isOSXSAVE = (cpuInfo[2] & (1 << 27)) != 0;
+  bool isAVX = (cpuInfo[2] & (1 << 28)) != 0 && isOSXSAVE && (_xgetbv(0) & 6) == 6;
+  bool isAVX2 = false;
+  if (isAVX && maxLeaf >= 7)
+  {
+    __cpuidex(cpuInfo, 7, 0);
+    isAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+  }
+
+  if (isAVX2) return InstructionSet::AVX2;
+  if (isSSE41) return InstructionSet::SSE41;
+#elif defined(ENABLE_SSE_SEGY)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return InstructionSet::AVX2;
+  if (__builtin_cpu_supports("sse4.1")) return InstructionSet::SSE41;
+#endif
+  return InstructionSet::Scalar;
+}
+
+InstructionSet
+SupportedInstructionSet()
+{
+  static const InstructionSet instructionSet = DetectInstructionSet();
+  return instructionSet;
+}
+
+const char *
+InstructionSetName(InstructionSet instructionSet)
+{
+  switch (instructionSet)
+  {
+  case InstructionSet::SSE41: return "SSE4.1";
+  case InstructionSet::AVX2:  return "AVX2";
+  default:                    return "Scalar";
+  }
+}
+
+void
+Ibm2ieee(InstructionSet instructionSet, void *to, const void *from, size_t len, Endianness fromEndianness)
+{
+  switch (instructionSet)
+  {
+#ifdef ENABLE_SSE_SEGY
+  case InstructionSet::AVX2:  Ibm2ieeeAVX2(to, from, len, fromEndianness); break;
+  case InstructionSet::SSE41: Ibm2ieeeSSE41(to, from, len, fromEndianness); break;
+#endif
+  default:                    Ibm2ieeeScalar(to, from, len, fromEndianness); break;
+  }
+}
+
+void
+Ieee2ibm(InstructionSet instructionSet, void *to, const void *from, size_t len, Endianness toEndianness)
+{
+  switch (instructionSet)
+  {
+#ifdef ENABLE_SSE_SEGY
+  case InstructionSet::AVX2:  Ieee2ibmAVX2(to, from, len, toEndianness); break;
+  case InstructionSet::SSE41: Ieee2ibmSSE41(to, from, len, toEndianness); break;
+#endif
+  default:                    Ieee2ibmScalar(to, from, len, toEndianness); break;
+  }
+}
+
+void
+ByteSwap32(InstructionSet instructionSet, void *to, const void *from, size_t len)
+{
+  switch (instructionSet)
+  {
+#ifdef ENABLE_SSE_SEGY
+  case InstructionSet::AVX2:  ByteSwap32AVX2(to, from, len); break;
+  case InstructionSet::SSE41: ByteSwap32SSE41(to, from, len); break;
+#endif
+  default:                    ByteSwap32Scalar(to, from, len); break;
+  }
+}
+
+} // end namespace Conversion
+
+void
+Ibm2ieee(void *to, const void *from, size_t len, Endianness fromEndianness)
+{
+  Conversion::Ibm2ieee(Conversion::SupportedInstructionSet(), to, from, len, fromEndianness);
+}
+
+void
+Ieee2ibm(void *to, const void *from, size_t len, Endianness toEndianness)
+{
+  Conversion::Ieee2ibm(Conversion::SupportedInstructionSet(), to, from, len, toEndianness);
+}
+
+void
+ByteSwap32(void *to, const void *from, size_t len)
+{
+  Conversion::ByteSwap32(Conversion::SupportedInstructionSet(), to, from, len);
 }
 
 int
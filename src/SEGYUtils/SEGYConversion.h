@@ -0,0 +1,55 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef SEGYCONVERSION_H
+#define SEGYCONVERSION_H
+
+#include <SEGYUtils/SEGY.h>
+
+#include <stddef.h>
+
+namespace SEGY
+{
+
+// Sample conversion kernels for a specific instruction set. The exported
+// Ibm2ieee/Ieee2ibm/ByteSwap32 functions use the best instruction set the CPU
+// supports; these entry points exist so the kernels can be tested and
+// benchmarked against each other.
+namespace Conversion
+{
+
+enum class InstructionSet
+{
+  Scalar,
+  SSE41,
+  AVX2
+};
+
+// The best instruction set supported by this build and the running CPU
+InstructionSet SupportedInstructionSet();
+
+const char *InstructionSetName(InstructionSet instructionSet);
+
+void Ibm2ieee(InstructionSet instructionSet, void *to, const void *from, size_t len, Endianness fromEndianness);
+void Ieee2ibm(InstructionSet instructionSet, void *to, const void *from, size_t len, Endianness toEndianness);
+void ByteSwap32(InstructionSet instructionSet, void *to, const void *from, size_t len);
+
+} // end namespace Conversion
+
+} // end namespace SEGY
+
+#endif // SEGYCONVERSION_H
@@ -23,8 +23,13 @@
 
 #include <iostream>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <functional>
+#include <map>
+#include <thread>
 
 using namespace OpenVDS;
 using namespace SEGY;
@@ -92,8 +97,245 @@ SEGYFileInfo::StaticGetUniqueID()
   return OpenVDS::HashCombiner(std::chrono::system_clock::now().time_since_epoch().count()).Add(std::chrono::high_resolution_clock::now().time_since_epoch().count()).GetCombinedHash();
 }
 
+namespace
+{
+
+// The first trace of a segment, the header values read from it and the guess of the segment length used to start the search for its end
+struct SegmentStart
+{
+  int64_t     m_trace;
+  int64_t     m_lengthGuess;
+  int         m_primaryKey;
+  SEGYBinInfo m_binInfo;
+
+  SegmentStart() : m_trace(), m_lengthGuess(), m_primaryKey(), m_binInfo() {}
+  SegmentStart(int64_t trace, int64_t lengthGuess, int primaryKey, SEGYBinInfo const &binInfo) : m_trace(trace), m_lengthGuess(lengthGuess), m_primaryKey(primaryKey), m_binInfo(binInfo) {}
+};
+
+struct ScannedSegment
+{
+  SegmentStart    m_start;
+  SEGYSegmentInfo m_segmentInfo;
+  SegmentStart    m_next;
+};
+
+// Finds the segments of a single file. The search for the end of a segment only depends on the segment start
+// (trace and length guess), so a chain of segments scanned from any known segment start is identical to what
+// a sequential scan of the whole file finds from that point on.
+struct SegmentScanner
+{
+  SEGYFileInfo const &m_fileInfo;
+  DataProvider const &m_dataProvider;
+  HeaderField const &m_primaryKeyHeaderField;
+  SEGYBinInfoHeaderFields const &m_binInfoHeaderFields;
+  int64_t m_traceByteSize;
+  int64_t m_lastTrace;
+
+  SegmentScanner(SEGYFileInfo const &fileInfo, DataProvider const &dataProvider, HeaderField const &primaryKeyHeaderField, SEGYBinInfoHeaderFields const &binInfoHeaderFields, int64_t traceByteSize, int64_t traceCount)
+    : m_fileInfo(fileInfo), m_dataProvider(dataProvider), m_primaryKeyHeaderField(primaryKeyHeaderField), m_binInfoHeaderFields(binInfoHeaderFields), m_traceByteSize(traceByteSize), m_lastTrace(traceCount - 1)
+  {}
+
+  bool ReadSegmentStart(int64_t trace, SegmentStart &start, Error &error) const
+  {
+    char traceHeader[TraceHeaderSize];
+
+    if (!m_dataProvider.Read(traceHeader, TextualFileHeaderSize + BinaryFileHeaderSize + trace * m_traceByteSize, TraceHeaderSize, error) || error.code != 0)
+    {
+      return false;
+    }
+
+    start = SegmentStart(trace, 1, ReadFieldFromHeader(traceHeader, m_primaryKeyHeaderField, m_fileInfo.m_headerEndianness), m_fileInfo.readBinInfoFromHeader(traceHeader, m_binInfoHeaderFields, m_fileInfo.m_headerEndianness, 1));
+    return true;
+  }
+
+  bool ScanSegment(SegmentStart const &start, SEGYSegmentInfo &segmentInfo, SegmentStart &next, Error &error) const
+  {
+    char traceHeader[TraceHeaderSize];
+
+    segmentInfo = SEGYSegmentInfo(start.m_primaryKey, start.m_trace, start.m_binInfo);
+
+    // The outside trace is the first known trace outside the current segment (used when binary searching)
+    int64_t outsideTrace = 0, jump = 1;
+
+    SEGYBinInfo outsideBinInfo;
+
+    int nextPrimaryKey = 0;
+
+    int64_t trace = std::min(m_lastTrace, start.m_trace + start.m_lengthGuess);
+
+    while (segmentInfo.m_traceStop != m_lastTrace)
+    {
+      if (!m_dataProvider.Read(traceHeader, TextualFileHeaderSize + BinaryFileHeaderSize + trace * m_traceByteSize, TraceHeaderSize, error) || error.code != 0)
+      {
+        return false;
+      }
+
+      int primaryKey = ReadFieldFromHeader(traceHeader, m_primaryKeyHeaderField, m_fileInfo.m_headerEndianness);
+
+      if (primaryKey == segmentInfo.m_primaryKey) // expand current segment if the primary key matches
+      {
+        assert(trace > segmentInfo.m_traceStop);
+        segmentInfo.m_traceStop = trace;
+        segmentInfo.m_binInfoStop = m_fileInfo.readBinInfoFromHeader(traceHeader, m_binInfoHeaderFields, m_fileInfo.m_headerEndianness, static_cast<int>(trace - segmentInfo.m_traceStart + 1));
+      }
+      else
+      {
+        assert(outsideTrace == 0 || trace < outsideTrace);
+        outsideTrace = trace;
+        outsideBinInfo = m_fileInfo.readBinInfoFromHeader(traceHeader, m_binInfoHeaderFields, m_fileInfo.m_headerEndianness, 1);
+        nextPrimaryKey = primaryKey;
+      }
+
+      if (outsideTrace == segmentInfo.m_traceStop + 1) // current segment is finished
+      {
+        int64_t segmentLength = segmentInfo.m_traceStop - segmentInfo.m_traceStart + 1;
+        next = SegmentStart(outsideTrace, segmentLength, nextPrimaryKey, outsideBinInfo);
+        return true;
+      }
+      else if (outsideTrace == 0) // looking for a trace outside the current segment
+      {
+        trace = std::min(m_lastTrace, trace + jump);
+        jump *= 2;
+      }
+      else if (trace - jump > segmentInfo.m_traceStop) // looking for a trace inside the current segment
+      {
+        trace = trace - jump;
+        jump *= 2;
+      }
+      else // search for end of segment which must lie somewhere between the last known trace inside the current segment and the first known trace outside the current segment
+      {
+        trace = (segmentInfo.m_traceStop + outsideTrace + 1) / 2;
+      }
+    }
+
+    // final segment in this file
+    next = SegmentStart(m_lastTrace + 1, 0, 0, SEGYBinInfo());
+    return true;
+  }
+
+  // Scan the chain of segments that start in [traceStart, traceEnd). Unless traceStart is the first trace of the file it is not
+  // known to be the start of a segment, so the chain starts after the end of the segment that traceStart is part of.
+  bool ScanRange(int64_t traceStart, int64_t traceEnd, std::vector<ScannedSegment> &scannedSegments, Error &error) const
+  {
+    SegmentStart start;
+
+    if (!ReadSegmentStart(traceStart, start, error))
+    {
+      return false;
+    }
+
+    if (traceStart != 0)
+    {
+      SEGYSegmentInfo segmentInfo;
+      SegmentStart next;
+      if (!ScanSegment(start, segmentInfo, next, error))
+      {
+        return false;
+      }
+      start = next;
+    }
+
+    while (start.m_trace < traceEnd && start.m_trace <= m_lastTrace)
+    {
+      ScannedSegment scannedSegment;
+      scannedSegment.m_start = start;
+      if (!ScanSegment(start, scannedSegment.m_segmentInfo, scannedSegment.m_next, error))
+      {
+        return false;
+      }
+      scannedSegments.push_back(scannedSegment);
+      start = scannedSegment.m_next;
+    }
+
+    return true;
+  }
+
+  // Follow the segment chain from the first trace of the file, using the scanned ranges where the chain reaches a segment start
+  // with the same length guess and scanning the segments in between (normally only the first segment of each range) again.
+  bool Merge(std::vector<std::vector<ScannedSegment>> const &scannedRanges, std::vector<SEGYSegmentInfo> &segmentInfos, Error &error) const
+  {
+    std::map<std::pair<int64_t, int64_t>, ScannedSegment const *> scannedSegmentMap;
+
+    for (auto const &scannedRange : scannedRanges)
+    {
+      for (auto const &scannedSegment : scannedRange)
+      {
+        scannedSegmentMap.emplace(std::make_pair(scannedSegment.m_start.m_trace, scannedSegment.m_start.m_lengthGuess), &scannedSegment);
+      }
+    }
+
+    assert(!scannedRanges.empty() && !scannedRanges[0].empty() && scannedRanges[0][0].m_start.m_trace == 0);
+    SegmentStart start = scannedRanges[0][0].m_start;
+
+    while (true)
+    {
+      SEGYSegmentInfo segmentInfo;
+      SegmentStart next;
+
+      auto it = scannedSegmentMap.find(std::make_pair(start.m_trace, start.m_lengthGuess));
+      if (it != scannedSegmentMap.end())
+      {
+        segmentInfo = it->second->m_segmentInfo;
+        next = it->second->m_next;
+      }
+      else if (!ScanSegment(start, segmentInfo, next, error))
+      {
+        return false;
+      }
+
+      segmentInfos.push_back(segmentInfo);
+      start = next;
+
+      if (segmentInfo.m_traceStop == m_lastTrace)
+      {
+        return true;
+      }
+    }
+  }
+};
+
+// Run the tasks on threadCount threads, the calling thread being one of them
+void
+RunTasks(int taskCount, int threadCount, std::function<void(int)> const &task)
+{
+  std::atomic<int> nextTask(0);
+
+  auto worker = [&]()
+  {
+    for (int taskIndex = nextTask++; taskIndex < taskCount; taskIndex = nextTask++)
+    {
+      task(taskIndex);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int thread = 1; thread < std::min(threadCount, taskCount); thread++)
+  {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+}
+
+// Scanning is dominated by the latency of the small trace header reads, so use more threads than cores
+int
+DefaultScanThreadCount()
+{
+  return std::max(8, int(std::thread::hardware_concurrency()));
+}
+
+// Don't split files into ranges smaller than this, as each range needs an extra segment search at both ends
+const int64_t MinTracesPerScanRange = 4096;
+
+} // end anonymous namespace
+
 bool
-SEGYFileInfo::Scan(const std::vector<DataProvider>& dataProviders, OpenVDS::Error &error, HeaderField const &primaryKeyHeaderField, HeaderField const &secondaryKeyHeaderField, SEGY::HeaderField const &startTimeHeaderField, SEGYBinInfoHeaderFields const &binInfoHeaderFields)
+SEGYFileInfo::Scan(const std::vector<DataProvider>& dataProviders, OpenVDS::Error &error, HeaderField const &primaryKeyHeaderField, HeaderField const &secondaryKeyHeaderField, SEGY::HeaderField const &startTimeHeaderField, SEGYBinInfoHeaderFields const &binInfoHeaderFields, int threadCount)
 {
   char textualFileHeader[TextualFileHeaderSize];
   char binaryFileHeader[BinaryFileHeaderSize];
@@ -102,6 +344,11 @@ SEGYFileInfo::Scan(const std::vector<DataProvider>& dataProviders, OpenVDS::Erro
   m_primaryKey = primaryKeyHeaderField;
   m_secondaryKey = secondaryKeyHeaderField;
 
+  if (threadCount <= 0)
+  {
+    threadCount = DefaultScanThreadCount();
+  }
+
   // we assume that the text/binary headers are the same for all files; read them from the first file
   dataProviders[0].Read(textualFileHeader,                          0, TextualFileHeaderSize, error) &&
   dataProviders[0].Read(binaryFileHeader, TextualFileHeaderSize, BinaryFileHeaderSize,  error);
@@ -140,131 +387,143 @@ SEGYFileInfo::Scan(const std::vector<DataProvider>& dataProviders, OpenVDS::Erro
 
   m_sampleIntervalMilliseconds = ReadFieldFromHeader(binaryFileHeader, BinaryHeader::SampleIntervalHeaderField, m_headerEndianness) / 1000.0;
 
-  for (const auto& dataProvider : dataProviders)
-  {
-    m_segmentInfoLists.emplace_back();
-    m_traceCounts.emplace_back();
+  const int fileCount = int(dataProviders.size());
 
-    auto&
-      segmentInfos = m_segmentInfoLists.back();
-    auto&
-      traceCount = m_traceCounts.back();
+  // Get the size and first trace header of all files concurrently
+  std::vector<int64_t> fileSizes(fileCount);
+  std::vector<std::array<char, TraceHeaderSize>> firstTraceHeaders(fileCount);
+  std::vector<Error> fileErrors(fileCount);
 
-    int64_t fileSize = dataProvider.Size(error);
+  RunTasks(fileCount, threadCount, [&](int file)
+  {
+    fileSizes[file] = dataProviders[file].Size(fileErrors[file]);
 
-    if (error.code != 0)
+    if (fileErrors[file].code == 0 && fileSizes[file] != TextualFileHeaderSize + BinaryFileHeaderSize)
     {
-      return false;
+      dataProviders[file].Read(firstTraceHeaders[file].data(), TextualFileHeaderSize + BinaryFileHeaderSize, TraceHeaderSize, fileErrors[file]);
     }
+  });
 
-    if (fileSize == TextualFileHeaderSize + BinaryFileHeaderSize)
-    {
-      continue;
-    }
+  // The trace size can depend on the first trace header of the files, so the trace counts are found in file order
+  std::vector<int64_t> traceByteSizes(fileCount);
 
-    // Read first trace header
-    dataProvider.Read(traceHeader, TextualFileHeaderSize + BinaryFileHeaderSize, TraceHeaderSize, error);
+  m_segmentInfoLists.resize(fileCount);
+  m_traceCounts.resize(fileCount);
 
-    if (error.code != 0)
+  for (int file = 0; file < fileCount; file++)
+  {
+    if (fileErrors[file].code != 0)
     {
+      error = fileErrors[file];
       return false;
     }
 
+    if (fileSizes[file] == TextualFileHeaderSize + BinaryFileHeaderSize)
+    {
+      continue;
+    }
+
     // If the sample count is not set in the binary header we try to find it from the first trace header
     if (m_sampleCount == 0)
     {
-      m_sampleCount = ReadFieldFromHeader(traceHeader, TraceHeader::NumSamplesHeaderField, m_headerEndianness);
+      m_sampleCount = ReadFieldFromHeader(firstTraceHeaders[file].data(), TraceHeader::NumSamplesHeaderField, m_headerEndianness);
     }
 
     // If the sample interval is not set in the binary header we try to find it from the first trace header
     if (m_sampleIntervalMilliseconds == 0.0)
     {
-      m_sampleIntervalMilliseconds = ReadFieldFromHeader(traceHeader, TraceHeader::SampleIntervalHeaderField, m_headerEndianness) / 1000.0;
+      m_sampleIntervalMilliseconds = ReadFieldFromHeader(firstTraceHeaders[file].data(), TraceHeader::SampleIntervalHeaderField, m_headerEndianness) / 1000.0;
     }
 
-    int64_t traceDataSize = (fileSize - TextualFileHeaderSize - BinaryFileHeaderSize);
+    int64_t traceDataSize = (fileSizes[file] - TextualFileHeaderSize - BinaryFileHeaderSize);
 
-    traceCount = traceDataSize / TraceByteSize();
+    traceByteSizes[file] = TraceByteSize();
 
-    if (traceDataSize % TraceByteSize() != 0)
+    m_traceCounts[file] = traceDataSize / traceByteSizes[file];
+
+    if (traceDataSize % traceByteSizes[file] != 0)
     {
       std::cerr << "Warning: File size is inconsistent with trace size";
     }
+  }
 
-    if (traceCount == 0)
-    {
-      continue;
-    }
+  // Split the files into trace ranges so there are enough scan tasks to keep the threads busy
+  std::vector<SegmentScanner> scanners;
+  std::vector<std::vector<std::vector<ScannedSegment>>> scannedRanges(fileCount);
 
-    const int64_t lastTrace = (traceCount - 1);
+  scanners.reserve(fileCount);
 
-    // The outside trace is the first known trace outside the current segment (used when binary searching)
-    int64_t outsideTrace = 0, jump = 1;
+  struct ScanTask
+  {
+    int     file;
+    int     range;
+    int64_t traceStart;
+    int64_t traceEnd;
+  };
 
-    SEGYBinInfo outsideBinInfo;
+  std::vector<ScanTask> scanTasks;
 
-    int primaryKey = ReadFieldFromHeader(traceHeader, primaryKeyHeaderField, m_headerEndianness), nextPrimaryKey = 0;
+  int nonEmptyFileCount = int(std::count_if(m_traceCounts.begin(), m_traceCounts.end(), [](int64_t traceCount) { return traceCount > 0; }));
 
-    SEGYSegmentInfo segmentInfo(primaryKey, 0, readBinInfoFromHeader(traceHeader, binInfoHeaderFields, m_headerEndianness, 1));
+  for (int file = 0; file < fileCount; file++)
+  {
+    scanners.emplace_back(*this, dataProviders[file], primaryKeyHeaderField, binInfoHeaderFields, traceByteSizes[file], m_traceCounts[file]);
 
-    int64_t trace = 1;
+    int64_t traceCount = m_traceCounts[file];
 
-    int readCount = 1;
+    if (traceCount == 0)
+    {
+      continue;
+    }
+
+    int rangeCount = int(std::max(int64_t(1), std::min(traceCount / MinTracesPerScanRange, int64_t((threadCount + nonEmptyFileCount - 1) / nonEmptyFileCount))));
+
+    scannedRanges[file].resize(rangeCount);
 
-    while (segmentInfo.m_traceStop != lastTrace)
+    for (int range = 0; range < rangeCount; range++)
     {
-      dataProvider.Read(traceHeader, TextualFileHeaderSize + BinaryFileHeaderSize + trace * TraceByteSize(), TraceHeaderSize, error);
+      scanTasks.push_back({ file, range, traceCount * range / rangeCount, traceCount * (range + 1) / rangeCount });
+    }
+  }
 
-      if (error.code != 0)
-      {
-        return false;
-      }
-      readCount++;
+  std::vector<Error> scanErrors(scanTasks.size());
+  std::atomic<bool> failed(false);
 
-      int primaryKey = ReadFieldFromHeader(traceHeader, primaryKeyHeaderField, m_headerEndianness);
+  RunTasks(int(scanTasks.size()), threadCount, [&](int taskIndex)
+  {
+    ScanTask const &scanTask = scanTasks[taskIndex];
 
-      if (primaryKey == segmentInfo.m_primaryKey) // expand current segment if the primary key matches
-      {
-        assert(trace > segmentInfo.m_traceStop);
-        segmentInfo.m_traceStop = trace;
-        segmentInfo.m_binInfoStop = readBinInfoFromHeader(traceHeader, binInfoHeaderFields, m_headerEndianness, static_cast<int>(trace - segmentInfo.m_traceStart + 1));
-      }
-      else
-      {
-        assert(outsideTrace == 0 || trace < outsideTrace);
-        outsideTrace = trace;
-        outsideBinInfo = readBinInfoFromHeader(traceHeader, binInfoHeaderFields, m_headerEndianness, 1);
-        nextPrimaryKey = primaryKey;
-      }
+    if (!failed && !scanners[scanTask.file].ScanRange(scanTask.traceStart, scanTask.traceEnd, scannedRanges[scanTask.file][scanTask.range], scanErrors[taskIndex]))
+    {
+      failed = true;
+    }
+  });
 
-      if (outsideTrace == segmentInfo.m_traceStop + 1) // current segment is finished
-      {
-        segmentInfos.push_back(segmentInfo);
-        int64_t segmentLength = segmentInfo.m_traceStop - segmentInfo.m_traceStart + 1;
+  for (auto &scanError : scanErrors)
+  {
+    if (scanError.code != 0)
+    {
+      error = scanError;
+      return false;
+    }
+  }
 
-        // start a new segment
-        segmentInfo = SEGYSegmentInfo(nextPrimaryKey, outsideTrace, outsideBinInfo);
-        trace = std::min(lastTrace, outsideTrace + segmentLength);
-        outsideTrace = 0, jump = 1;
-      }
-      else if (outsideTrace == 0) // looking for a trace outside the current segment
-      {
-        trace = std::min(lastTrace, trace + jump);
-        jump *= 2;
-      }
-      else if (trace - jump > segmentInfo.m_traceStop) // looking for a trace inside the current segment
-      {
-        trace = trace - jump;
-        jump *= 2;
-      }
-      else // search for end of segment which must lie somewhere between the last known trace inside the current segment and the first known trace outside the current segment
-      {
-        trace = (segmentInfo.m_traceStop + outsideTrace + 1) / 2;
-      }
+  // Merge the ranges of each file, this only needs to read trace headers where the ranges meet
+  RunTasks(fileCount, threadCount, [&](int file)
+  {
+    if (m_traceCounts[file] > 0 && !failed && !scanners[file].Merge(scannedRanges[file], m_segmentInfoLists[file], fileErrors[file]))
+    {
+      failed = true;
     }
+  });
 
-    // final segment in this file is finished
-    segmentInfos.push_back(segmentInfo);
+  for (auto &fileError : fileErrors)
+  {
+    if (fileError.code != 0)
+    {
+      error = fileError;
+      return false;
+    }
   }
 
   return true;
@@ -193,6 +193,7 @@ struct DataView
   {
     if (m_fileView)
       return m_fileView->Pointer();
+    std::unique_lock<std::mutex> lock(m_mutex);
     if (m_requests.size())
     {
       if (m_requests.size() == 1)
@@ -261,6 +262,7 @@ struct DataView
   std::vector<std::shared_ptr<DataTransfer>> m_transfers;
   OpenVDS::Error m_error;
   int m_ref;
+  std::mutex m_mutex;
 };
 
 struct DataRequestInfo
@@ -291,8 +291,16 @@ ConvertFromEndianness(T *target, const char *source, int sampleCount)
 
 // Floating point format conversion functions
 
-OPENVDS_EXPORT void Ibm2ieee(void *to, const void *from, size_t len);
-OPENVDS_EXPORT void Ieee2ibm(void *to, const void *from, size_t len);
+// The IBM float data is big-endian unless another endianness is given. The
+// conversions use SIMD instructions when the CPU supports them, and to may
+// be the same buffer as from.
+
+OPENVDS_EXPORT void Ibm2ieee(void *to, const void *from, size_t len, Endianness fromEndianness = Endianness::BigEndian);
+OPENVDS_EXPORT void Ieee2ibm(void *to, const void *from, size_t len, Endianness toEndianness = Endianness::BigEndian);
+
+// Reverse the byte order of len 32-bit values, e.g. to convert IEEE floats to or from big-endian
+
+OPENVDS_EXPORT void ByteSwap32(void *to, const void *from, size_t len);
 
 // Read field from header
 
@@ -0,0 +1,215 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/ValueConversion.h>
+
+#include <VDS/VolumeDataConversionKernels.h>
+
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace OpenVDS;
+
+static const float g_valueRangeMin = -3.0f;
+static const float g_valueRangeMax = 4.0f;
+static const float g_integerScale = 0.25f;
+static const float g_integerOffset = -10.0f;
+static const float g_noValue = -999.25f;
+static const float g_replacementNoValue = 2.5f;
+
+static std::vector<ConversionKernels::InstructionSet> supportedInstructionSets()
+{
+  std::vector<ConversionKernels::InstructionSet> instructionSets = { ConversionKernels::InstructionSet::Scalar };
+  if (ConversionKernels::SupportedInstructionSet() >= ConversionKernels::InstructionSet::SSE41) instructionSets.push_back(ConversionKernels::InstructionSet::SSE41);
+  if (ConversionKernels::SupportedInstructionSet() >= ConversionKernels::InstructionSet::AVX2) instructionSets.push_back(ConversionKernels::InstructionSet::AVX2);
+  return instructionSets;
+}
+
+// Values covering the whole range of the type, with some no-values
+template<typename S> static S randomValue(std::mt19937 &generator, int i, S noValue)
+{
+  if (i % 11 == 0) return noValue;
+  return S(std::uniform_int_distribution<int>(0, (std::numeric_limits<S>::max)())(generator));
+}
+
+template<> float randomValue<float>(std::mt19937 &generator, int i, float noValue)
+{
+  if (i % 11 == 0) return noValue;
+  if (i % 17 == 0) return 0.0f;
+  if (i % 19 == 0) return g_valueRangeMin;
+  return std::uniform_real_distribution<float>(g_valueRangeMin - 2.0f, g_valueRangeMax + 2.0f)(generator);
+}
+
+template<typename T>
+static bool isSameValue(T a, T b)
+{
+  return memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+template<typename T, typename S, bool isUseNoValue>
+static void testConvertValues(int count)
+{
+  std::mt19937 generator(4321);
+  S sourceNoValue = ConvertNoValue<S>(g_noValue);
+  std::vector<S> source(count);
+  for (int i = 0; i < count; i++)
+  {
+    source[i] = randomValue<S>(generator, i, sourceNoValue);
+  }
+
+  QuantizingValueConverterWithNoValue<T, S, isUseNoValue> valueConverter(g_valueRangeMin, g_valueRangeMax, g_integerScale, g_integerOffset, g_noValue, g_replacementNoValue);
+  ConversionKernels::ValueConversion conversion = ConversionKernels::CreateValueConversion<T, S>(g_valueRangeMin, g_valueRangeMax, g_integerScale, g_integerOffset, g_noValue, g_replacementNoValue, isUseNoValue);
+
+  for (auto instructionSet : supportedInstructionSets())
+  {
+    std::vector<T> target(count);
+    ConversionKernels::ConvertValues(instructionSet, ConversionKernels::ElementFormat<T>::format, target.data(), ConversionKernels::ElementFormat<S>::format, source.data(), conversion, count);
+
+    int mismatches = 0;
+    for (int i = 0; i < count; i++)
+    {
+      T expected = valueConverter.ConvertValue(source[i]);
+      if (!isSameValue(target[i], expected) && mismatches++ < 10)
+      {
+        ADD_FAILURE() << ConversionKernels::InstructionSetName(instructionSet) << " format " << int(ConversionKernels::ElementFormat<S>::format) << " to " << int(ConversionKernels::ElementFormat<T>::format) << " noValue " << isUseNoValue << " value " << double(source[i]) << ": " << double(target[i]) << " != " << double(expected);
+      }
+    }
+    EXPECT_EQ(mismatches, 0);
+  }
+}
+
+template<typename T, typename S>
+static void testConvertValues()
+{
+  // Counts that leave a partial vector for the scalar code
+  testConvertValues<T, S, false>(1003);
+  testConvertValues<T, S, true>(1003);
+  testConvertValues<T, S, true>(5);
+}
+
+TEST(ConversionKernels, matchesValueConverter)
+{
+  testConvertValues<float, uint8_t>();
+  testConvertValues<float, uint16_t>();
+  testConvertValues<float, float>();
+  testConvertValues<uint8_t, uint8_t>();
+  testConvertValues<uint8_t, uint16_t>();
+  testConvertValues<uint8_t, float>();
+  testConvertValues<uint16_t, uint8_t>();
+  testConvertValues<uint16_t, uint16_t>();
+  testConvertValues<uint16_t, float>();
+}
+
+template<typename S, bool isUseNoValue>
+static void testPackAndUnpackBits(int byteCount)
+{
+  std::mt19937 generator(5678);
+  S sourceNoValue = ConvertNoValue<S>(g_noValue);
+  std::vector<S> source(byteCount * 8);
+  for (int i = 0; i < byteCount * 8; i++)
+  {
+    source[i] = (i % 3 == 0) ? S(0) : randomValue<S>(generator, i, sourceNoValue);
+  }
+
+  // The 1-bit conversion replaces the no-value with the no-value, so no-values are cleared
+  QuantizingValueConverterWithNoValue<float, S, isUseNoValue> valueConverter(g_valueRangeMin, g_valueRangeMax, g_integerScale, g_integerOffset, g_noValue, g_noValue);
+  ConversionKernels::ValueConversion conversion = ConversionKernels::CreateValueConversion<float, S>(g_valueRangeMin, g_valueRangeMax, g_integerScale, g_integerOffset, g_noValue, g_noValue, isUseNoValue);
+
+  std::vector<uint8_t> expected(byteCount, 0);
+  for (int i = 0; i < byteCount * 8; i++)
+  {
+    float value = valueConverter.ConvertValue(source[i]);
+    if ((!isUseNoValue || value != g_noValue) && value != 0.0f)
+    {
+      expected[i / 8] |= uint8_t(1 << (i % 8));
+    }
+  }
+
+  for (auto instructionSet : supportedInstructionSets())
+  {
+    std::vector<uint8_t> packed(byteCount);
+    ConversionKernels::PackBits(instructionSet, packed.data(), ConversionKernels::ElementFormat<S>::format, source.data(), conversion, g_noValue, byteCount);
+    EXPECT_EQ(packed, expected) << ConversionKernels::InstructionSetName(instructionSet) << " format " << int(ConversionKernels::ElementFormat<S>::format) << " noValue " << isUseNoValue;
+
+    std::vector<S> unpacked(byteCount * 8);
+    ConversionKernels::UnpackBits(instructionSet, ConversionKernels::ElementFormat<S>::format, unpacked.data(), expected.data(), byteCount);
+    for (int i = 0; i < byteCount * 8; i++)
+    {
+      ASSERT_EQ(unpacked[i], (expected[i / 8] & (1 << (i % 8))) ? S(1) : S(0)) << ConversionKernels::InstructionSetName(instructionSet) << " format " << int(ConversionKernels::ElementFormat<S>::format) << " bit " << i;
+    }
+  }
+}
+
+TEST(ConversionKernels, packAndUnpackBits)
+{
+  testPackAndUnpackBits<uint8_t, false>(131);
+  testPackAndUnpackBits<uint8_t, true>(131);
+  testPackAndUnpackBits<uint16_t, false>(131);
+  testPackAndUnpackBits<uint16_t, true>(131);
+  testPackAndUnpackBits<float, false>(131);
+  testPackAndUnpackBits<float, true>(131);
+}
+
+// A U16 subset with a replacement no-value goes through the conversion kernels, the raw U16 subset is a plain copy
+TEST(OpenVDS_integration, RequestVolumeSubsetConversionKernels)
+{
+  std::unique_ptr<VDS, decltype(&Close)> handle(generateSimpleInMemory3DVDS(60, 60, 60, VolumeDataChannelDescriptor::Format_U16), Close);
+  ASSERT_TRUE(handle);
+  fill3DVDSWithNoise(handle.get());
+
+  VolumeDataAccessManager accessManager = GetAccessManager(handle.get());
+  VolumeDataLayout const *layout = accessManager.GetVolumeDataLayout();
+
+  // An odd row length, so the rows end with a partial vector
+  int32_t minPos[Dimensionality_Max] = { 3, 10, 10, 0, 0, 0 };
+  int32_t maxPos[Dimensionality_Max] = { 56, 50, 50, 1, 1, 1 };
+
+  auto requestRaw = accessManager.RequestVolumeSubset<uint16_t>(Dimensions_012, 0, 0, minPos, maxPos);
+  auto requestFloat = accessManager.RequestVolumeSubset<float>(Dimensions_012, 0, 0, minPos, maxPos, g_replacementNoValue);
+  auto requestU8 = accessManager.RequestVolumeSubset<uint8_t>(Dimensions_012, 0, 0, minPos, maxPos, g_replacementNoValue);
+  ASSERT_TRUE(requestRaw->WaitForCompletion());
+  ASSERT_TRUE(requestFloat->WaitForCompletion());
+  ASSERT_TRUE(requestU8->WaitForCompletion());
+
+  float valueRangeMin = layout->GetChannelValueRangeMin(0);
+  float valueRangeMax = layout->GetChannelValueRangeMax(0);
+  float integerScale = layout->GetChannelIntegerScale(0);
+  float integerOffset = layout->GetChannelIntegerOffset(0);
+  float noValue = layout->GetChannelNoValue(0);
+
+  QuantizingValueConverterWithNoValue<float, uint16_t, true> floatConverter(valueRangeMin, valueRangeMax, integerScale, integerOffset, noValue, g_replacementNoValue);
+  QuantizingValueConverterWithNoValue<uint8_t, uint16_t, true> u8Converter(valueRangeMin, valueRangeMax, integerScale, integerOffset, noValue, g_replacementNoValue);
+
+  const std::vector<uint16_t> &raw = requestRaw->Data();
+  const std::vector<float> &floatData = requestFloat->Data();
+  const std::vector<uint8_t> &u8Data = requestU8->Data();
+  ASSERT_EQ(raw.size(), floatData.size());
+  ASSERT_EQ(raw.size(), u8Data.size());
+  for (size_t i = 0; i < raw.size(); i++)
+  {
+    ASSERT_EQ(floatData[i], floatConverter.ConvertValue(raw[i])) << "index " << i;
+    ASSERT_EQ(u8Data[i], u8Converter.ConvertValue(raw[i])) << "index " << i;
+  }
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+
+#include <VDS/VolumeDataConversionKernels.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <chrono>
+#include <random>
+
+static const char *formatName(OpenVDS::VolumeDataChannelDescriptor::Format format)
+{
+  switch (format)
+  {
+  case OpenVDS::VolumeDataChannelDescriptor::Format_1Bit: return "1Bit";
+  case OpenVDS::VolumeDataChannelDescriptor::Format_U8:   return "U8";
+  case OpenVDS::VolumeDataChannelDescriptor::Format_U16:  return "U16";
+  default:                                                return "R32";
+  }
+}
+
+TEST(OpenVDS_performance, ConversionKernels)
+{
+  using OpenVDS::VolumeDataChannelDescriptor;
+
+  const int count = 64 * 1024;
+  const int iterations = 200;
+
+  // Random floats, the U8 and U16 sources see the same bytes
+  std::vector<uint8_t> source(size_t(count) * 4);
+  std::mt19937 gen(123);
+  std::uniform_real_distribution<float> valueDistribution(-2.0f, 2.0f);
+  for (int i = 0; i < count; i++)
+  {
+    float value = valueDistribution(gen);
+    memcpy(&source[size_t(i) * 4], &value, sizeof(value));
+  }
+  std::vector<uint8_t> target(size_t(count) * 4);
+
+  std::vector<OpenVDS::ConversionKernels::InstructionSet> instructionSets = { OpenVDS::ConversionKernels::InstructionSet::Scalar };
+  if (OpenVDS::ConversionKernels::SupportedInstructionSet() >= OpenVDS::ConversionKernels::InstructionSet::SSE41) instructionSets.push_back(OpenVDS::ConversionKernels::InstructionSet::SSE41);
+  if (OpenVDS::ConversionKernels::SupportedInstructionSet() >= OpenVDS::ConversionKernels::InstructionSet::AVX2) instructionSets.push_back(OpenVDS::ConversionKernels::InstructionSet::AVX2);
+
+  const VolumeDataChannelDescriptor::Format formats[] = { VolumeDataChannelDescriptor::Format_U8, VolumeDataChannelDescriptor::Format_U16, VolumeDataChannelDescriptor::Format_R32 };
+
+  for (auto sourceFormat : formats)
+  {
+    for (auto targetFormat : { VolumeDataChannelDescriptor::Format_1Bit, VolumeDataChannelDescriptor::Format_U8, VolumeDataChannelDescriptor::Format_U16, VolumeDataChannelDescriptor::Format_R32 })
+    {
+      if (sourceFormat == targetFormat)
+      {
+        continue;
+      }
+
+      // The no-value is used for all conversions, i.e. the same as requests with a replacement no-value
+      OpenVDS::ConversionKernels::ValueConversion conversion;
+      switch (targetFormat)
+      {
+      case VolumeDataChannelDescriptor::Format_U8:  conversion = OpenVDS::ConversionKernels::CreateValueConversion<uint8_t, float>(-2.0f, 2.0f, 0.01f, -1.0f, -999.25f, 0.0f, true); break;
+      case VolumeDataChannelDescriptor::Format_U16: conversion = OpenVDS::ConversionKernels::CreateValueConversion<uint16_t, float>(-2.0f, 2.0f, 0.01f, -1.0f, -999.25f, 0.0f, true); break;
+      default:                                      conversion = OpenVDS::ConversionKernels::CreateValueConversion<float, float>(-2.0f, 2.0f, 0.01f, -1.0f, -999.25f, 0.0f, true); break;
+      }
+
+      std::string timings;
+      for (auto instructionSet : instructionSets)
+      {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++)
+        {
+          if (targetFormat == VolumeDataChannelDescriptor::Format_1Bit)
+            OpenVDS::ConversionKernels::PackBits(instructionSet, target.data(), sourceFormat, source.data(), conversion, -999.25f, count / 8);
+          else
+            OpenVDS::ConversionKernels::ConvertValues(instructionSet, targetFormat, target.data(), sourceFormat, source.data(), conversion, count);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        timings += fmt::format(" {:>7} {:8.1f}", OpenVDS::ConversionKernels::InstructionSetName(instructionSet), double(count) * iterations / seconds / 1e6);
+      }
+      fmt::print(stderr, "{:>4} -> {:<4} million values/s:{}\n", formatName(sourceFormat), formatName(targetFormat), timings);
+    }
+  }
+
+  for (auto targetFormat : formats)
+  {
+    std::string timings;
+    for (auto instructionSet : instructionSets)
+    {
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int iteration = 0; iteration < iterations; iteration++)
+      {
+        OpenVDS::ConversionKernels::UnpackBits(instructionSet, targetFormat, target.data(), source.data(), count / 8);
+      }
+      double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+      timings += fmt::format(" {:>7} {:8.1f}", OpenVDS::ConversionKernels::InstructionSetName(instructionSet), double(count) * iterations / seconds / 1e6);
+    }
+    fmt::print(stderr, "1Bit -> {:<4} million values/s:{}\n", formatName(targetFormat), timings);
+  }
+}
+
+// The same format combinations as tests/OpenVDS/RequestVolumeSubsetFormat.cpp, timing the whole request
+TEST(OpenVDS_performance, RequestVolumeSubsetFormat)
+{
+  using OpenVDS::VolumeDataChannelDescriptor;
+
+  for (auto sourceFormat : { VolumeDataChannelDescriptor::Format_U8, VolumeDataChannelDescriptor::Format_U16, VolumeDataChannelDescriptor::Format_R32 })
+  {
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(128, 128, 128, sourceFormat, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_64), OpenVDS::Close);
+    ASSERT_TRUE(handle);
+    fill3DVDSWithNoise(handle.get());
+
+    OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+    // Not aligned with the chunks, so every chunk is copied in rows
+    int minPos[OpenVDS::Dimensionality_Max] = { 1, 1, 1, 0, 0, 0 };
+    int maxPos[OpenVDS::Dimensionality_Max] = { 127, 127, 127, 1, 1, 1 };
+    int64_t voxelCount = int64_t(126) * 126 * 126;
+
+    for (auto targetFormat : { VolumeDataChannelDescriptor::Format_1Bit, VolumeDataChannelDescriptor::Format_U8, VolumeDataChannelDescriptor::Format_U16, VolumeDataChannelDescriptor::Format_R32 })
+    {
+      if (sourceFormat == targetFormat)
+      {
+        continue;
+      }
+
+      int64_t bufferSize = accessManager.GetVolumeSubsetBufferSize(minPos, maxPos, targetFormat, 0, 0);
+      std::vector<uint8_t> buffer(bufferSize);
+
+      // The first request reads the chunks into the cache
+      const int iterations = 10;
+      double seconds = 0;
+      for (int iteration = 0; iteration <= iterations; iteration++)
+      {
+        auto start = std::chrono::high_resolution_clock::now();
+        OpenVDS::optional<float> replacementNoValue = targetFormat == VolumeDataChannelDescriptor::Format_1Bit ? OpenVDS::optional<float>() : OpenVDS::optional<float>(0.0f);
+        auto request = accessManager.RequestVolumeSubset(buffer.data(), bufferSize, OpenVDS::Dimensions_012, 0, 0, minPos, maxPos, targetFormat, replacementNoValue);
+        ASSERT_TRUE(request->WaitForCompletion());
+        if (iteration > 0)
+        {
+          seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+      }
+      fmt::print(stderr, "RequestVolumeSubset {:>4} -> {:<4} {:8.1f} million voxels/s\n", formatName(sourceFormat), formatName(targetFormat), double(voxelCount) * iterations / seconds / 1e6);
+    }
+  }
+}
@@ -21,6 +21,7 @@
 #include <OpenVDS/VolumeData.h>
 
 #include <cstdlib>
+#include <cmath>
 
 #include <array>
 
@@ -287,3 +288,80 @@ GTEST_TEST(VolumeSubset, BadLOD)
   }
   ASSERT_TRUE(false);
 }
+
+static std::vector<float> readAllSamples(OpenVDS::VDS *vds)
+{
+  OpenVDS::VolumeDataLayout *layout = OpenVDS::GetLayout(vds);
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(vds);
+
+  int voxelMin[OpenVDS::Dimensionality_Max] = {};
+  int voxelMax[OpenVDS::Dimensionality_Max] = { 1, 1, 1, 1, 1, 1 };
+  for (int dimension = 0; dimension < layout->GetDimensionality(); dimension++)
+    voxelMax[dimension] = layout->GetDimensionNumSamples(dimension);
+
+  auto request = accessManager.RequestVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, voxelMin, voxelMax);
+  EXPECT_TRUE(request->WaitForCompletion());
+  return std::move(request->Data());
+}
+
+GTEST_TEST(OpenVDS_integration, WaveletCompressedWriteRead)
+{
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> reference(generateSimpleInMemory3DVDS(60, 60, 60), &OpenVDS::Close);
+  ASSERT_TRUE(reference);
+  fill3DVDSWithNoise(reference.get());
+  std::vector<float> referenceSamples = readAllSamples(reference.get());
+
+  for (auto compressionMethod : { OpenVDS::CompressionMethod::Wavelet, OpenVDS::CompressionMethod::WaveletLossless })
+  {
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(60, 60, 60, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, nullptr, compressionMethod, 1.0f), &OpenVDS::Close);
+    ASSERT_TRUE(handle);
+    fill3DVDSWithNoise(handle.get());
+
+    OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+    ASSERT_EQ(accessManager.UploadErrorCount(), 0);
+
+    std::vector<float> samples = readAllSamples(handle.get());
+    ASSERT_EQ(samples.size(), referenceSamples.size());
+
+    OpenVDS::VolumeDataLayout *layout = OpenVDS::GetLayout(handle.get());
+    float valueRange = layout->GetChannelValueRangeMax(0) - layout->GetChannelValueRangeMin(0);
+
+    double totalError = 0.0;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+      totalError += std::fabs(samples[i] - referenceSamples[i]);
+    }
+
+    if (compressionMethod == OpenVDS::CompressionMethod::WaveletLossless)
+    {
+      EXPECT_EQ(samples, referenceSamples);
+    }
+    else
+    {
+      EXPECT_LT(totalError / samples.size(), valueRange * 0.02);
+    }
+  }
+}
+
+GTEST_TEST(OpenVDS_integration, LosslessCompressedWriteRead)
+{
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> reference(generateSimpleInMemory3DVDS(60, 60, 60, OpenVDS::VolumeDataChannelDescriptor::Format_U8), &OpenVDS::Close);
+  ASSERT_TRUE(reference);
+  fill3DVDSWithNoise(reference.get());
+  std::vector<float> referenceSamples = readAllSamples(reference.get());
+
+  for (auto compressionMethod : { OpenVDS::CompressionMethod::RLE, OpenVDS::CompressionMethod::Zip, OpenVDS::CompressionMethod::Zstd, OpenVDS::CompressionMethod::LZ4 })
+  {
+    if (!OpenVDS::IsCompressionMethodSupported(compressionMethod))
+    {
+      continue;
+    }
+
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(60, 60, 60, OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, nullptr, compressionMethod), &OpenVDS::Close);
+    ASSERT_TRUE(handle);
+    fill3DVDSWithNoise(handle.get());
+    ASSERT_EQ(OpenVDS::GetAccessManager(handle.get()).UploadErrorCount(), 0);
+
+    EXPECT_EQ(readAllSamples(handle.get()), referenceSamples);
+  }
+}
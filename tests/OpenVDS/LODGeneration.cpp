@@ -0,0 +1,252 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/KnownMetadata.h>
+#include <OpenVDS/GlobalMetadataCommon.h>
+#include <OpenVDS/MetadataContainer.h>
+
+#include <gtest/gtest.h>
+
+#include <OpenVDS/IO/IOManager.h>
+
+#include <fmt/format.h>
+
+#include <cmath>
+
+static const float g_noValue = -999.25f;
+
+static float sampleValue(int x, int y, int z)
+{
+  // Leave holes of no-value samples so the averaging has to skip them
+  if ((x * 7 + y * 3 + z) % 11 == 0)
+  {
+    return g_noValue;
+  }
+  return std::sin(x * 0.3f) + std::cos(y * 0.2f) * 2.0f + z * 0.01f;
+}
+
+static uint8_t sampleValueU8(int x, int y, int z)
+{
+  return uint8_t((x * 5 + y * 3 + z * 11) % 256);
+}
+
+struct Volume
+{
+  int size[3];
+  std::vector<float> data;
+
+  float &at(int x, int y, int z) { return data[(size_t(z) * size[1] + y) * size[0] + x]; }
+};
+
+// Average the pairs of samples in every dimension, ignoring no-value samples
+static Volume downsample(Volume &child, bool useNoValue)
+{
+  Volume parent;
+  for (int dimension = 0; dimension < 3; dimension++)
+  {
+    parent.size[dimension] = (child.size[dimension] + 1) / 2;
+  }
+  parent.data.resize(size_t(parent.size[0]) * parent.size[1] * parent.size[2]);
+
+  for (int z = 0; z < parent.size[2]; z++)
+  {
+    for (int y = 0; y < parent.size[1]; y++)
+    {
+      for (int x = 0; x < parent.size[0]; x++)
+      {
+        double sum = 0;
+        int count = 0;
+        for (int childZ = z * 2; childZ < std::min(z * 2 + 2, child.size[2]); childZ++)
+        {
+          for (int childY = y * 2; childY < std::min(y * 2 + 2, child.size[1]); childY++)
+          {
+            for (int childX = x * 2; childX < std::min(x * 2 + 2, child.size[0]); childX++)
+            {
+              float value = child.at(childX, childY, childZ);
+              if (!useNoValue || value != g_noValue)
+              {
+                sum += value;
+                count++;
+              }
+            }
+          }
+        }
+        parent.at(x, y, z) = count ? float(sum / count) : g_noValue;
+      }
+    }
+  }
+  return parent;
+}
+
+// The LODs are either generated while the data is written, or only the full resolution data is written and the LODs
+// are produced when they are requested
+static void testLODGeneration(int margin, bool isGenerateOnWrite)
+{
+  const int samples[3] = { 101, 70, 45 };
+
+  OpenVDS::VolumeDataLayoutDescriptor layoutDescriptor(OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, margin, margin, 4, OpenVDS::VolumeDataLayoutDescriptor::LODLevels_2, OpenVDS::VolumeDataLayoutDescriptor::Options_None);
+
+  std::vector<OpenVDS::VolumeDataAxisDescriptor> axisDescriptors;
+  axisDescriptors.emplace_back(samples[0], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_SAMPLE, "ms", 0.0f, 4.f * (samples[0] - 1));
+  axisDescriptors.emplace_back(samples[1], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_CROSSLINE, "", 1.f, float(samples[1]));
+  axisDescriptors.emplace_back(samples[2], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_INLINE, "", 1.f, float(samples[2]));
+
+  std::vector<OpenVDS::VolumeDataChannelDescriptor> channelDescriptors;
+  channelDescriptors.emplace_back(OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataChannelDescriptor::Components_1, AMPLITUDE_ATTRIBUTE_NAME, "", -3.0f, 4.0f, OpenVDS::VolumeDataMapping::Direct, 1, OpenVDS::VolumeDataChannelDescriptor::Default, g_noValue, 1.0f, 0.0f);
+  channelDescriptors.emplace_back(OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::VolumeDataChannelDescriptor::Components_1, "Byte", "", 0.0f, 255.0f);
+
+  OpenVDS::InMemoryOpenOptions options(fmt::format("LODGeneration{}{}", margin, isGenerateOnWrite ? "Write" : "Read"));
+  OpenVDS::MetadataContainer metadataContainer;
+  OpenVDS::Error error;
+
+  {
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Create(options, layoutDescriptor, axisDescriptors, channelDescriptors, metadataContainer, OpenVDS::CompressionMethod::None, 0.0f, error), OpenVDS::Close);
+    ASSERT_TRUE(handle) << error.string;
+
+    OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+    for (int channel = 0; channel < 2; channel++)
+    {
+      // Few pages, so most LOD0 pages are written back (and downsampled) before the commit
+      OpenVDS::VolumeDataPageAccessor *pageAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, channel, 2, isGenerateOnWrite ? OpenVDS::VolumeDataAccessManager::AccessMode_CreateWithLODGeneration : OpenVDS::VolumeDataAccessManager::AccessMode_Create);
+      ASSERT_TRUE(pageAccessor);
+
+      // Write the chunks backwards, so parents are not completed in the order they are created
+      for (int64_t chunk = pageAccessor->GetChunkCount() - 1; chunk >= 0; chunk--)
+      {
+        OpenVDS::VolumeDataPage *page = pageAccessor->CreatePage(chunk);
+        ASSERT_TRUE(page);
+
+        int pitch[OpenVDS::Dimensionality_Max];
+        void *buffer = page->GetWritableBuffer(pitch);
+
+        int min[OpenVDS::Dimensionality_Max], max[OpenVDS::Dimensionality_Max];
+        page->GetMinMax(min, max);
+
+        for (int z = min[2]; z < max[2]; z++)
+        {
+          for (int y = min[1]; y < max[1]; y++)
+          {
+            for (int x = min[0]; x < max[0]; x++)
+            {
+              int index = (z - min[2]) * pitch[2] + (y - min[1]) * pitch[1] + (x - min[0]) * pitch[0];
+              if (channel == 0)
+              {
+                static_cast<float *>(buffer)[index] = sampleValue(x, y, z);
+              }
+              else
+              {
+                static_cast<uint8_t *>(buffer)[index] = sampleValueU8(x, y, z);
+              }
+            }
+          }
+        }
+        page->Release();
+      }
+
+      pageAccessor->Commit();
+      accessManager.DestroyVolumeDataPageAccessor(pageAccessor);
+    }
+  }
+
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Open(options, error), OpenVDS::Close);
+  ASSERT_TRUE(handle) << error.string;
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  Volume expected[2][3];
+  for (int channel = 0; channel < 2; channel++)
+  {
+    Volume &lod0 = expected[channel][0];
+    std::copy(samples, samples + 3, lod0.size);
+    lod0.data.resize(size_t(samples[0]) * samples[1] * samples[2]);
+    for (int z = 0; z < samples[2]; z++)
+    {
+      for (int y = 0; y < samples[1]; y++)
+      {
+        for (int x = 0; x < samples[0]; x++)
+        {
+          lod0.at(x, y, z) = channel == 0 ? sampleValue(x, y, z) : float(sampleValueU8(x, y, z));
+        }
+      }
+    }
+  }
+
+  for (int lod = 1; lod <= 2; lod++)
+  {
+    EXPECT_EQ(accessManager.GetVDSProduceStatus(OpenVDS::Dimensions_012, lod, 0), isGenerateOnWrite ? OpenVDS::VDSProduceStatus::Normal : OpenVDS::VDSProduceStatus::Unavailable);
+
+    for (int channel = 0; channel < 2; channel++)
+    {
+      Volume &lodExpected = expected[channel][lod];
+      if (channel == 0)
+      {
+        lodExpected = downsample(expected[channel][lod - 1], true);
+      }
+      else
+      {
+        // Integer samples are rounded at every level, so the reference must be too
+        lodExpected = downsample(expected[channel][lod - 1], false);
+        for (auto &value : lodExpected.data)
+        {
+          value = std::floor(value + 0.5f);
+        }
+      }
+
+      std::vector<float> data(lodExpected.data.size());
+      auto request = accessManager.RequestVolumeSubset<float>(data.data(), data.size() * sizeof(float), OpenVDS::Dimensions_012, lod, channel, { 0, 0, 0 }, { samples[0], samples[1], samples[2] });
+      ASSERT_TRUE(request->WaitForCompletion());
+
+      int mismatches = 0;
+      for (size_t index = 0; index < data.size(); index++)
+      {
+        float tolerance = channel == 0 ? 1e-4f : 0.0f;
+        if (std::abs(data[index] - lodExpected.data[index]) > tolerance)
+        {
+          if (mismatches++ < 10)
+          {
+            ADD_FAILURE() << "LOD " << lod << " channel " << channel << " sample " << index << ": " << data[index] << " != " << lodExpected.data[index];
+          }
+        }
+      }
+      EXPECT_EQ(mismatches, 0) << "LOD " << lod << " channel " << channel;
+    }
+  }
+}
+
+TEST(OpenVDS_integration, LODGeneration)
+{
+  testLODGeneration(0, true);
+}
+
+TEST(OpenVDS_integration, LODGenerationWithMargins)
+{
+  testLODGeneration(4, true);
+}
+
+TEST(OpenVDS_integration, LODProductionOnRead)
+{
+  testLODGeneration(0, false);
+}
+
+TEST(OpenVDS_integration, LODProductionOnReadWithMargins)
+{
+  testLODGeneration(4, false);
+}
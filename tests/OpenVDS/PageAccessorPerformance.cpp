@@ -0,0 +1,84 @@
+/****************************************************************************
+** Copyright 2019 The Open Group
+** Copyright 2019 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <chrono>
+#include <random>
+
+TEST(OpenVDS_performance, PageAccessorLookupAndEviction)
+{
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(192, 192, 384, OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32), OpenVDS::Close);
+  ASSERT_TRUE(handle);
+  fill3DVDSWithNoise(handle.get());
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+  OpenVDS::VolumeDataPageAccessor *pageAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 0, 0, OpenVDS::VolumeDataAccessManager::AccessMode_ReadOnly);
+  ASSERT_TRUE(pageAccessor);
+
+  int chunkCount = int(pageAccessor->GetChunkCount());
+  ASSERT_EQ(chunkCount, 1024);
+  pageAccessor->SetMaxPages(chunkCount);
+
+  for (int chunk = 0; chunk < chunkCount; chunk++)
+  {
+    OpenVDS::VolumeDataPage *page = pageAccessor->ReadPage(chunk);
+    ASSERT_TRUE(page);
+    page->Release();
+  }
+
+  // Every access is a hit, so this measures lookup and move-to-front in the page list
+  const int accessCount = 200000;
+  std::mt19937 gen(123);
+  std::uniform_int_distribution<int> chunkDistribution(0, chunkCount - 1);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < accessCount; i++)
+  {
+    OpenVDS::VolumeDataPage *page = pageAccessor->ReadPage(chunkDistribution(gen));
+    page->Release();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double hitNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(accessCount);
+
+  // Sweeping over more chunks than fit makes every access evict the least recently used page
+  pageAccessor->SetMaxPages(chunkCount / 2);
+  const int sweepCount = 4;
+  start = std::chrono::high_resolution_clock::now();
+  for (int sweep = 0; sweep < sweepCount; sweep++)
+  {
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+      OpenVDS::VolumeDataPage *page = pageAccessor->ReadPage(chunk);
+      ASSERT_TRUE(page);
+      page->Release();
+    }
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double missNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(sweepCount * chunkCount);
+
+  fmt::print(stderr, "Page accessor with {} pages: {:.0f} ns per page hit, {:.0f} ns per page miss including read and eviction\n", chunkCount, hitNanoseconds, missNanoseconds);
+
+  accessManager.DestroyVolumeDataPageAccessor(pageAccessor);
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/GlobalState.h>
+
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <OpenVDS/IO/IOManager.h>
+
+TEST(OpenVDS_integration, PageCacheSizeLimit)
+{
+  OpenVDS::InMemoryOpenOptions options("PageCacheSizeLimit");
+  OpenVDS::Error error;
+
+  {
+    OpenVDS::IOManager *ioManager = OpenVDS::IOManager::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadWrite, error);
+    ASSERT_EQ(error.code, 0) << error.string;
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(72, 72, 72, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, ioManager), OpenVDS::Close);
+    ASSERT_TRUE(handle);
+    fill3DVDSWithNoise(handle.get());
+  }
+
+  // Every page has at least 24^3 samples (a 32 brick minus the margins), so no more than this many pages fit
+  const int64_t pageSize = 24 * 24 * 24 * sizeof(float);
+  const int64_t cachedPages = 4;
+  options.maxCacheSize = pageSize * cachedPages;
+
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Open(options, error), OpenVDS::Close);
+  ASSERT_TRUE(handle) << error.string;
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  // The page limit of each accessor is far above the cache size limit, so it is the shared cache limit that causes eviction
+  OpenVDS::VolumeDataPageAccessor *pageAccessors[2];
+  for (auto &pageAccessor : pageAccessors)
+  {
+    pageAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 0, 1000, OpenVDS::VolumeDataAccessManager::AccessMode_ReadOnly);
+    ASSERT_TRUE(pageAccessor);
+  }
+
+  int chunkCount = int(pageAccessors[0]->GetChunkCount());
+  ASSERT_GT(chunkCount, cachedPages);
+
+  auto hits = OpenVDS::GetGlobalState()->GetCacheHits(OpenVDS::OpenOptions::InMemory);
+  auto misses = OpenVDS::GetGlobalState()->GetCacheMisses(OpenVDS::OpenOptions::InMemory);
+  auto evictions = OpenVDS::GetGlobalState()->GetCacheEvictions(OpenVDS::OpenOptions::InMemory);
+
+  for (auto pageAccessor : pageAccessors)
+  {
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+      OpenVDS::VolumeDataPage *page = pageAccessor->ReadPage(chunk);
+      ASSERT_TRUE(page);
+      int pitch[OpenVDS::Dimensionality_Max];
+      ASSERT_TRUE(page->GetBuffer(pitch));
+      page->Release();
+    }
+  }
+
+  // The most recently read page is still in memory
+  OpenVDS::VolumeDataPage *page = pageAccessors[1]->ReadPage(chunkCount - 1);
+  ASSERT_TRUE(page);
+  page->Release();
+
+  EXPECT_EQ(OpenVDS::GetGlobalState()->GetCacheMisses(OpenVDS::OpenOptions::InMemory) - misses, uint64_t(chunkCount * 2));
+  EXPECT_EQ(OpenVDS::GetGlobalState()->GetCacheHits(OpenVDS::OpenOptions::InMemory) - hits, uint64_t(1));
+  EXPECT_GE(OpenVDS::GetGlobalState()->GetCacheEvictions(OpenVDS::OpenOptions::InMemory) - evictions, uint64_t(chunkCount * 2 - cachedPages));
+
+  for (auto pageAccessor : pageAccessors)
+  {
+    accessManager.DestroyVolumeDataPageAccessor(pageAccessor);
+  }
+}
@@ -0,0 +1,88 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <chrono>
+#include <functional>
+
+// Time how long it takes to issue a request, i.e. to find the chunks it needs and queue them, for a survey with a large
+// number of chunks. Most of the chunks are never written, so the requests are cancelled as soon as they are issued.
+static double timeRequestIssue(std::function<std::shared_ptr<OpenVDS::VolumeDataRequest>()> const &issue)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  auto request = issue();
+  double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+  request->Cancel();
+  request->WaitForCompletion();
+  return seconds;
+}
+
+TEST(OpenVDS_performance, RequestPlanning)
+{
+  // 2 x 128 x 128 chunks
+  const int samples[3] = { 64, 4096, 4096 };
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(samples[0], samples[1], samples[2], OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32), OpenVDS::Close);
+  ASSERT_TRUE(handle);
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  // Writing a single chunk makes the layer available
+  OpenVDS::VolumeDataPageAccessor *pageAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 0, 1, OpenVDS::VolumeDataAccessManager::AccessMode_Create);
+  ASSERT_TRUE(pageAccessor);
+  pageAccessor->CreatePage(0)->Release();
+  pageAccessor->Commit();
+  accessManager.DestroyVolumeDataPageAccessor(pageAccessor);
+
+  // A slightly dipping time slice across the whole survey, projected onto the inline/crossline plane
+  int min[OpenVDS::Dimensionality_Max] = { 0, 0, 0, 0, 0, 0 };
+  int max[OpenVDS::Dimensionality_Max] = { samples[0], samples[1], samples[2], 1, 1, 1 };
+  OpenVDS::FloatVector4 voxelPlane(-1.0f, 0.005f, 0.002f, 20.0f);
+  double projectedSeconds = timeRequestIssue([&]() { return accessManager.RequestProjectedVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, min, max, voxelPlane, OpenVDS::Dimensions_12, OpenVDS::InterpolationMethod::Nearest); });
+
+  // The same slice as a volume subset
+  min[0] = 20;
+  max[0] = 21;
+  double subsetSeconds = timeRequestIssue([&]() { return accessManager.RequestVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, min, max); });
+
+  // One sample and one trace for every 16th trace in both directions
+  std::vector<float> positions;
+  for (int z = 0; z < samples[2]; z += 16)
+  {
+    for (int y = 0; y < samples[1]; y += 16)
+    {
+      float position[OpenVDS::Dimensionality_Max] = { 20.5f + (y + z) % 20, y + 0.5f, z + 0.5f, 0, 0, 0 };
+      positions.insert(positions.end(), position, position + OpenVDS::Dimensionality_Max);
+    }
+  }
+  int positionCount = int(positions.size() / OpenVDS::Dimensionality_Max);
+  auto samplePositions = reinterpret_cast<const float (*)[OpenVDS::Dimensionality_Max]>(positions.data());
+
+  double samplesSeconds = timeRequestIssue([&]() { return accessManager.RequestVolumeSamples(OpenVDS::Dimensions_012, 0, 0, samplePositions, positionCount, OpenVDS::InterpolationMethod::Linear); });
+  double tracesSeconds = timeRequestIssue([&]() { return accessManager.RequestVolumeTraces(OpenVDS::Dimensions_012, 0, 0, samplePositions, positionCount, OpenVDS::InterpolationMethod::Linear, 0); });
+
+  fmt::print(stderr, "Issuing requests in a survey with 32768 chunks: projected subset {:.1f} ms, subset {:.1f} ms, {} samples {:.1f} ms, {} traces {:.1f} ms\n",
+             projectedSeconds * 1000, subsetSeconds * 1000, positionCount, samplesSeconds * 1000, positionCount, tracesSeconds * 1000);
+}
@@ -0,0 +1,216 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/KnownMetadata.h>
+#include <OpenVDS/GlobalState.h>
+
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <cstring>
+#include <vector>
+
+// A VDS without margins, so the chunks can be requested exactly. 70 samples gives full chunks of 32 and edge chunks of 6, which are padded.
+static OpenVDS::VDS *generateVDSWithoutMargins(OpenVDS::VolumeDataChannelDescriptor::Format format, OpenVDS::CompressionMethod compressionMethod)
+{
+  OpenVDS::VolumeDataLayoutDescriptor layoutDescriptor(OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, 0, 0, 4, OpenVDS::VolumeDataLayoutDescriptor::LODLevels_None, OpenVDS::VolumeDataLayoutDescriptor::Options_None);
+
+  std::vector<OpenVDS::VolumeDataAxisDescriptor> axisDescriptors;
+  axisDescriptors.emplace_back(70, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_SAMPLE, "ms", 0.0f, 4.f);
+  axisDescriptors.emplace_back(70, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_CROSSLINE, "", 1932.f, 2536.f);
+  axisDescriptors.emplace_back(70, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_INLINE, "", 9985.f, 10369.f);
+
+  float rangeMin = -0.1234f;
+  float rangeMax = 0.1234f;
+  float intScale = 1.0f;
+  float intOffset = 0.0f;
+  getScaleOffsetForFormat(rangeMin, rangeMax, true, format, intScale, intOffset);
+
+  std::vector<OpenVDS::VolumeDataChannelDescriptor> channelDescriptors;
+  channelDescriptors.emplace_back(format, OpenVDS::VolumeDataChannelDescriptor::Components_1, AMPLITUDE_ATTRIBUTE_NAME, "", rangeMin, rangeMax, OpenVDS::VolumeDataMapping::Direct, 1, OpenVDS::VolumeDataChannelDescriptor::Default, 0.f, intScale, intOffset);
+
+  OpenVDS::MetadataContainer metadataContainer;
+  OpenVDS::InMemoryOpenOptions options;
+  OpenVDS::Error error;
+  return OpenVDS::Create(options, layoutDescriptor, axisDescriptors, channelDescriptors, metadataContainer, compressionMethod, 0.0f, error);
+}
+
+static void testRequestSingleChunks(OpenVDS::VolumeDataChannelDescriptor::Format format, OpenVDS::CompressionMethod compressionMethod)
+{
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateVDSWithoutMargins(format, compressionMethod), &OpenVDS::Close);
+  ASSERT_TRUE(handle);
+  fill3DVDSWithNoise(handle.get());
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  int elementSize = format == OpenVDS::VolumeDataChannelDescriptor::Format_R32 ? 4 : format == OpenVDS::VolumeDataChannelDescriptor::Format_U16 ? 2 : 1;
+
+  // The chunks are requested one by one before anything is in the page cache, so the full chunks are deserialized straight into the buffer
+  struct ChunkRequest
+  {
+    int min[OpenVDS::Dimensionality_Max];
+    int max[OpenVDS::Dimensionality_Max];
+    std::vector<uint8_t> buffer;
+    std::shared_ptr<OpenVDS::VolumeDataRequest> request;
+  };
+
+  std::vector<ChunkRequest> chunkRequests;
+  for (int z = 0; z < 70; z += 32)
+  {
+    for (int y = 0; y < 70; y += 32)
+    {
+      for (int x = 0; x < 70; x += 32)
+      {
+        ChunkRequest chunkRequest = { { x, y, z, 0, 0, 0 }, { std::min(x + 32, 70), std::min(y + 32, 70), std::min(z + 32, 70), 1, 1, 1 }, {}, nullptr };
+        chunkRequests.push_back(std::move(chunkRequest));
+      }
+    }
+  }
+
+  uint64_t cacheMisses = OpenVDS::GetGlobalState()->GetCacheMisses(OpenVDS::OpenOptions::InMemory);
+
+  for (auto &chunkRequest : chunkRequests)
+  {
+    chunkRequest.buffer.resize(accessManager.GetVolumeSubsetBufferSize(chunkRequest.min, chunkRequest.max, format, 0, 0));
+    chunkRequest.request = accessManager.RequestVolumeSubset((void *)chunkRequest.buffer.data(), chunkRequest.buffer.size(), OpenVDS::Dimensions_012, 0, 0, chunkRequest.min, chunkRequest.max, format);
+  }
+
+  for (auto &chunkRequest : chunkRequests)
+  {
+    ASSERT_TRUE(chunkRequest.request->WaitForCompletion());
+  }
+
+  // Only the chunks with padded rows (at the edge in dimension 0 or 1) are read as pages
+  EXPECT_EQ(OpenVDS::GetGlobalState()->GetCacheMisses(OpenVDS::OpenOptions::InMemory) - cacheMisses, uint64_t(15));
+
+  // The whole volume goes through the pages
+  int volumeMin[OpenVDS::Dimensionality_Max] = { 0, 0, 0, 0, 0, 0 };
+  int volumeMax[OpenVDS::Dimensionality_Max] = { 70, 70, 70, 1, 1, 1 };
+  std::vector<uint8_t> volume(accessManager.GetVolumeSubsetBufferSize(volumeMin, volumeMax, format, 0, 0));
+  auto volumeRequest = accessManager.RequestVolumeSubset((void *)volume.data(), volume.size(), OpenVDS::Dimensions_012, 0, 0, volumeMin, volumeMax, format);
+  ASSERT_TRUE(volumeRequest->WaitForCompletion());
+
+  for (auto &chunkRequest : chunkRequests)
+  {
+    int sizeX = chunkRequest.max[0] - chunkRequest.min[0];
+    int sizeY = chunkRequest.max[1] - chunkRequest.min[1];
+    int sizeZ = chunkRequest.max[2] - chunkRequest.min[2];
+    for (int z = 0; z < sizeZ; z++)
+    {
+      for (int y = 0; y < sizeY; y++)
+      {
+        const uint8_t *expected = volume.data() + ((size_t(chunkRequest.min[2] + z) * 70 + (chunkRequest.min[1] + y)) * 70 + chunkRequest.min[0]) * elementSize;
+        const uint8_t *actual = chunkRequest.buffer.data() + (size_t(z) * sizeY + y) * sizeX * elementSize;
+        ASSERT_EQ(memcmp(expected, actual, size_t(sizeX) * elementSize), 0) << "chunk at " << chunkRequest.min[0] << ", " << chunkRequest.min[1] << ", " << chunkRequest.min[2] << " row " << y << ", " << z;
+      }
+    }
+  }
+}
+
+TEST(OpenVDS_integration, RequestVolumeSubsetSingleChunk)
+{
+  testRequestSingleChunks(OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::None);
+  testRequestSingleChunks(OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::CompressionMethod::None);
+  testRequestSingleChunks(OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::Zip);
+  testRequestSingleChunks(OpenVDS::VolumeDataChannelDescriptor::Format_U16, OpenVDS::CompressionMethod::RLE);
+  testRequestSingleChunks(OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::Wavelet);
+}
+
+TEST(OpenVDS_integration, PageView)
+{
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(60, 60, 60), &OpenVDS::Close);
+  ASSERT_TRUE(handle);
+  fill3DVDSWithNoise(handle.get());
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  OpenVDS::VolumeDataPageAccessor *pageAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 0, 2, OpenVDS::VolumeDataAccessManager::AccessMode_ReadOnly);
+  ASSERT_TRUE(pageAccessor);
+
+  OpenVDS::VolumeDataPage *page = pageAccessor->ReadPage(1);
+  ASSERT_TRUE(page);
+  ASSERT_EQ(page->GetError().errorCode, 0);
+  int pagePitch[OpenVDS::Dimensionality_Max];
+  const float *pageBuffer = static_cast<const float *>(page->GetBuffer(pagePitch));
+  int pageMin[OpenVDS::Dimensionality_Max];
+  int pageMax[OpenVDS::Dimensionality_Max];
+  page->GetMinMax(pageMin, pageMax);
+
+  // The view of a page shares the buffer of the page
+  OpenVDS::VolumeDataPageView pageView = page->GetBufferView();
+  ASSERT_TRUE(pageView.IsValid());
+  int viewPitch[OpenVDS::Dimensionality_Max];
+  EXPECT_EQ(pageView.GetBuffer(viewPitch), pageBuffer);
+  for (int dimension = 0; dimension < OpenVDS::Dimensionality_Max; dimension++)
+  {
+    EXPECT_EQ(viewPitch[dimension], pagePitch[dimension]);
+  }
+
+  std::vector<float> expected(static_cast<const float *>(pageBuffer), static_cast<const float *>(pageBuffer) + pageView.GetBufferSize() / sizeof(float));
+  page->Release();
+
+  OpenVDS::VolumeDataPageView readView = pageAccessor->ReadPageView(1);
+  ASSERT_TRUE(readView.IsValid());
+  int readMin[OpenVDS::Dimensionality_Max];
+  int readMax[OpenVDS::Dimensionality_Max];
+  readView.GetMinMax(readMin, readMax);
+  for (int dimension = 0; dimension < OpenVDS::Dimensionality_Max; dimension++)
+  {
+    EXPECT_EQ(readMin[dimension], pageMin[dimension]);
+    EXPECT_EQ(readMax[dimension], pageMax[dimension]);
+  }
+
+  // Reading other pages evicts the page, and destroying the accessor deletes all pages, but the views keep the buffer
+  for (int64_t chunk = 2; chunk < pageAccessor->GetChunkCount(); chunk++)
+  {
+    OpenVDS::VolumeDataPageView otherView = pageAccessor->ReadPageView(chunk);
+    EXPECT_TRUE(otherView.IsValid());
+  }
+  accessManager.DestroyVolumeDataPageAccessor(pageAccessor);
+
+  for (const OpenVDS::VolumeDataPageView *view : { &pageView, &readView })
+  {
+    int pitch[OpenVDS::Dimensionality_Max];
+    const float *buffer = static_cast<const float *>(view->GetBuffer(pitch));
+    ASSERT_EQ(view->GetBufferSize(), int64_t(expected.size() * sizeof(float)));
+    EXPECT_EQ(memcmp(buffer, expected.data(), expected.size() * sizeof(float)), 0);
+  }
+
+  // Writes to a page after a view is created are not seen by the view
+  OpenVDS::VolumeDataPageAccessor *writeAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 0, 2, OpenVDS::VolumeDataAccessManager::AccessMode_ReadWrite);
+  ASSERT_TRUE(writeAccessor);
+  OpenVDS::VolumeDataPage *writePage = writeAccessor->ReadPage(1);
+  ASSERT_TRUE(writePage);
+  OpenVDS::VolumeDataPageView viewBeforeWrite = writePage->GetBufferView();
+  int writePitch[OpenVDS::Dimensionality_Max];
+  float *writeBuffer = static_cast<float *>(writePage->GetWritableBuffer(writePitch));
+  writeBuffer[0] = expected[0] + 1.0f;
+  OpenVDS::VolumeDataPageView viewAfterWrite = writePage->GetBufferView();
+  writeBuffer[0] = expected[0] + 2.0f;
+  writePage->Release();
+
+  int pitch[OpenVDS::Dimensionality_Max];
+  EXPECT_EQ(static_cast<const float *>(viewBeforeWrite.GetBuffer(pitch))[0], expected[0]);
+  EXPECT_EQ(static_cast<const float *>(viewAfterWrite.GetBuffer(pitch))[0], expected[0] + 1.0f);
+
+  writeAccessor->SetMaxPages(0);
+  accessManager.DestroyVolumeDataPageAccessor(writeAccessor);
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/GlobalState.h>
+
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+#include "../utils/SlowIOManager.h"
+
+#include <OpenVDS/IO/IOManager.h>
+#include <OpenVDS/IO/IOManagerInMemory.h>
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+TEST(OpenVDS_integration, RequestVolumeSubsetProgressive)
+{
+  OpenVDS::InMemoryOpenOptions options;
+  OpenVDS::Error error;
+  std::unique_ptr<OpenVDS::IOManager> inMemory(OpenVDS::IOManagerInMemory::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadWrite, error));
+  SlowIOManager* slowIOManager = new SlowIOManager(20, inMemory.get());
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(60, 60, 60, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, slowIOManager, OpenVDS::CompressionMethod::Wavelet, 0.01f), OpenVDS::Close);
+  ASSERT_TRUE(handle);
+  fill3DVDSWithNoise(handle.get());
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  int32_t minPos[OpenVDS::Dimensionality_Max] = { 0, 0, 0, 0, 0, 0 };
+  int32_t maxPos[OpenVDS::Dimensionality_Max] = { 60, 60, 60, 1, 1, 1 };
+  int64_t bufferSize = accessManager.GetVolumeSubsetBufferSize(minPos, maxPos, OpenVDS::VolumeDataChannelDescriptor::Format_R32, 0, 0);
+
+  const int coarseAdaptiveLevel = 6;
+
+  std::vector<float> progressive(bufferSize / sizeof(float));
+  std::vector<float> coarse;
+  std::vector<int> adaptiveLevels;
+  int64_t coarseDownloaded = 0;
+  std::mutex mutex;
+
+  int64_t downloadedBefore = OpenVDS::GetGlobalState()->GetBytesDownloaded(OpenVDS::OpenOptions::InMemory);
+
+  auto progressiveRequest = accessManager.RequestVolumeSubsetProgressive(progressive.data(), bufferSize, OpenVDS::Dimensions_012, 0, 0, minPos, maxPos, OpenVDS::VolumeDataChannelDescriptor::Format_R32, coarseAdaptiveLevel,
+    [&](int adaptiveLevel)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (adaptiveLevels.empty())
+      {
+        coarse = progressive;
+        coarseDownloaded = OpenVDS::GetGlobalState()->GetBytesDownloaded(OpenVDS::OpenOptions::InMemory) - downloadedBefore;
+      }
+      adaptiveLevels.push_back(adaptiveLevel);
+    });
+  ASSERT_TRUE(progressiveRequest->WaitForCompletion());
+
+  int64_t progressiveDownloaded = OpenVDS::GetGlobalState()->GetBytesDownloaded(OpenVDS::OpenOptions::InMemory) - downloadedBefore;
+
+  auto request = accessManager.RequestVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, minPos, maxPos);
+  ASSERT_TRUE(request->WaitForCompletion());
+
+  int64_t downloaded = OpenVDS::GetGlobalState()->GetBytesDownloaded(OpenVDS::OpenOptions::InMemory) - downloadedBefore - progressiveDownloaded;
+
+  // The whole buffer is delivered at the coarse level first and then at the final level of the layer
+  ASSERT_EQ(adaptiveLevels.size(), size_t(2));
+  EXPECT_EQ(adaptiveLevels[0], coarseAdaptiveLevel);
+  EXPECT_LT(adaptiveLevels[1], coarseAdaptiveLevel);
+  EXPECT_NE(memcmp(coarse.data(), request->Data().data(), bufferSize), 0);
+  EXPECT_EQ(memcmp(progressive.data(), request->Data().data(), bufferSize), 0);
+
+  // The coarse pass only reads a prefix of each chunk, and the refinement pass only reads the rest
+  EXPECT_LT(coarseDownloaded, downloaded / 2);
+  EXPECT_EQ(progressiveDownloaded, downloaded);
+}
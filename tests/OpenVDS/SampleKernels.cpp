@@ -0,0 +1,247 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/VolumeSampler.h>
+#include <OpenVDS/KnownMetadata.h>
+#include <OpenVDS/GlobalMetadataCommon.h>
+#include <OpenVDS/MetadataContainer.h>
+
+#include <VDS/VolumeDataSampleKernels.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace OpenVDS;
+
+static const float g_noValue = -999.25f;
+
+static const InterpolationMethod g_interpolationMethods[] = { InterpolationMethod::Nearest, InterpolationMethod::Linear, InterpolationMethod::Cubic };
+
+static float sampleValue(int x, int y, int z, bool useNoValue)
+{
+  if (useNoValue && (x * 7 + y * 3 + z) % 13 == 0)
+  {
+    return g_noValue;
+  }
+  return std::sin(x * 0.3f) + std::cos(y * 0.2f) * 2.0f + z * 0.01f;
+}
+
+// The samples are compared bit for bit, so a NaN from a division by a zero weight sum matches too
+static bool isSameFloat(float a, float b)
+{
+  return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+template<InterpolationMethod INTERPMETHOD, bool isUseNoValue>
+static float sampleScalar(const std::vector<float> &data, const int (&size)[4], const int (&pitch)[4], float u, float v, float w)
+{
+  VolumeSampler<float, INTERPMETHOD, isUseNoValue> volumeSampler(size, pitch, 0.0f, 0.0f, 1.0f, 0.0f, g_noValue, g_noValue);
+  return volumeSampler.Sample3D(data.data(), FloatVector3(u, v, w));
+}
+
+static float sampleScalar(InterpolationMethod interpolationMethod, bool isUseNoValue, const std::vector<float> &data, const int (&size)[4], const int (&pitch)[4], float u, float v, float w)
+{
+  switch (interpolationMethod)
+  {
+  case InterpolationMethod::Nearest: return isUseNoValue ? sampleScalar<InterpolationMethod::Nearest, true>(data, size, pitch, u, v, w) : sampleScalar<InterpolationMethod::Nearest, false>(data, size, pitch, u, v, w);
+  case InterpolationMethod::Linear:  return isUseNoValue ? sampleScalar<InterpolationMethod::Linear, true>(data, size, pitch, u, v, w) : sampleScalar<InterpolationMethod::Linear, false>(data, size, pitch, u, v, w);
+  default:                           return isUseNoValue ? sampleScalar<InterpolationMethod::Cubic, true>(data, size, pitch, u, v, w) : sampleScalar<InterpolationMethod::Cubic, false>(data, size, pitch, u, v, w);
+  }
+}
+
+TEST(SampleKernels, matchesVolumeSampler)
+{
+  // A padded row pitch, so the pitches are not the same as the size
+  int size[4] = { 23, 17, 11, 1 };
+  int pitch[4] = { 1, 25, 25 * 17, 0 };
+
+  std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> position(-2.0f, 26.0f);
+
+  const int count = 1003;
+  std::vector<float> u(count), v(count), w(count);
+  for (int i = 0; i < count; i++)
+  {
+    // Include exact voxel centers and edges as well as positions outside the buffer
+    u[i] = (i % 5 == 0) ? std::floor(position(generator)) + (i % 2 ? 0.5f : 0.0f) : position(generator);
+    v[i] = position(generator) * (size[1] / 26.0f);
+    w[i] = position(generator) * (size[2] / 26.0f);
+  }
+
+  std::vector<SampleKernels::InstructionSet> instructionSets = { SampleKernels::InstructionSet::Scalar };
+  if (SampleKernels::SupportedInstructionSet() >= SampleKernels::InstructionSet::SSE41) instructionSets.push_back(SampleKernels::InstructionSet::SSE41);
+  if (SampleKernels::SupportedInstructionSet() >= SampleKernels::InstructionSet::AVX2) instructionSets.push_back(SampleKernels::InstructionSet::AVX2);
+
+  for (int useNoValue = 0; useNoValue < 2; useNoValue++)
+  {
+    std::vector<float> data(size_t(pitch[2]) * size[2], 0.0f);
+    for (int z = 0; z < size[2]; z++)
+    {
+      for (int y = 0; y < size[1]; y++)
+      {
+        for (int x = 0; x < size[0]; x++)
+        {
+          data[z * pitch[2] + y * pitch[1] + x] = sampleValue(x, y, z, useNoValue != 0);
+        }
+      }
+    }
+
+    SampleKernels::SampleBuffer buffer;
+    buffer.data = data.data();
+    for (int i = 0; i < 3; i++)
+    {
+      buffer.size[i] = size[i];
+      buffer.pitch[i] = pitch[i];
+    }
+    buffer.isUseNoValue = useNoValue != 0;
+    buffer.noValue = g_noValue;
+    buffer.replacementNoValue = g_noValue;
+
+    for (auto interpolationMethod : g_interpolationMethods)
+    {
+      std::vector<float> expected(count);
+      for (int i = 0; i < count; i++)
+      {
+        expected[i] = sampleScalar(interpolationMethod, useNoValue != 0, data, size, pitch, u[i], v[i], w[i]);
+      }
+
+      for (auto instructionSet : instructionSets)
+      {
+        std::vector<float> result(count);
+        SampleKernels::Sample3D(instructionSet, interpolationMethod, buffer, u.data(), v.data(), w.data(), count, result.data());
+
+        int mismatches = 0;
+        for (int i = 0; i < count; i++)
+        {
+          if (!isSameFloat(result[i], expected[i]) && mismatches++ < 10)
+          {
+            ADD_FAILURE() << SampleKernels::InstructionSetName(instructionSet) << " method " << int(interpolationMethod) << " noValue " << useNoValue << " position (" << u[i] << ", " << v[i] << ", " << w[i] << "): " << result[i] << " != " << expected[i];
+          }
+        }
+        EXPECT_EQ(mismatches, 0);
+      }
+    }
+  }
+}
+
+// RequestVolumeSamples and RequestVolumeTraces use the sample kernels for float data, in a volume that is a single
+// chunk the result must be the same as sampling the whole volume with the VolumeSampler
+TEST(OpenVDS_integration, RequestVolumeSamplesMatchesVolumeSampler)
+{
+  int size[4] = { 45, 30, 20, 1 };
+  int pitch[4] = { 1, size[0], size[0] * size[1], 0 };
+
+  VolumeDataLayoutDescriptor layoutDescriptor(VolumeDataLayoutDescriptor::BrickSize_64, 0, 0, 4, VolumeDataLayoutDescriptor::LODLevels_None, VolumeDataLayoutDescriptor::Options_None);
+
+  std::vector<VolumeDataAxisDescriptor> axisDescriptors;
+  axisDescriptors.emplace_back(size[0], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_SAMPLE, "ms", 0.0f, 4.f * (size[0] - 1));
+  axisDescriptors.emplace_back(size[1], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_CROSSLINE, "", 1.f, float(size[1]));
+  axisDescriptors.emplace_back(size[2], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_INLINE, "", 1.f, float(size[2]));
+
+  std::vector<VolumeDataChannelDescriptor> channelDescriptors;
+  channelDescriptors.emplace_back(VolumeDataChannelDescriptor::Format_R32, VolumeDataChannelDescriptor::Components_1, AMPLITUDE_ATTRIBUTE_NAME, "", -3.0f, 4.0f, VolumeDataMapping::Direct, 1, VolumeDataChannelDescriptor::Default, g_noValue, 1.0f, 0.0f);
+
+  InMemoryOpenOptions options("RequestVolumeSamplesMatchesVolumeSampler");
+  MetadataContainer metadataContainer;
+  Error error;
+
+  std::unique_ptr<VDS, decltype(&Close)> handle(Create(options, layoutDescriptor, axisDescriptors, channelDescriptors, metadataContainer, CompressionMethod::None, 0.0f, error), Close);
+  ASSERT_TRUE(handle) << error.string;
+
+  VolumeDataAccessManager accessManager = GetAccessManager(handle.get());
+
+  std::vector<float> data(static_cast<size_t>(size[0]) * size[1] * size[2]);
+  for (int z = 0; z < size[2]; z++)
+  {
+    for (int y = 0; y < size[1]; y++)
+    {
+      for (int x = 0; x < size[0]; x++)
+      {
+        data[z * pitch[2] + y * pitch[1] + x] = sampleValue(x, y, z, true);
+      }
+    }
+  }
+
+  {
+    VolumeDataPageAccessor *pageAccessor = accessManager.CreateVolumeDataPageAccessor(Dimensions_012, 0, 0, 1, VolumeDataAccessManager::AccessMode_Create);
+    ASSERT_EQ(pageAccessor->GetChunkCount(), 1);
+    VolumeDataPage *page = pageAccessor->CreatePage(0);
+    int pagePitch[Dimensionality_Max];
+    float *buffer = static_cast<float *>(page->GetWritableBuffer(pagePitch));
+    for (int z = 0; z < size[2]; z++)
+    {
+      for (int y = 0; y < size[1]; y++)
+      {
+        memcpy(buffer + z * pagePitch[2] + y * pagePitch[1], data.data() + z * pitch[2] + y * pitch[1], size[0] * sizeof(float));
+      }
+    }
+    page->Release();
+    pageAccessor->Commit();
+    accessManager.DestroyVolumeDataPageAccessor(pageAccessor);
+  }
+
+  std::mt19937 generator(4321);
+  const int count = 500;
+  std::vector<float> positions(count * Dimensionality_Max, 0.0f);
+  for (int i = 0; i < count; i++)
+  {
+    for (int dimension = 0; dimension < 3; dimension++)
+    {
+      positions[i * Dimensionality_Max + dimension] = std::uniform_real_distribution<float>(0.0f, float(size[dimension]))(generator);
+    }
+  }
+  auto samplePositions = reinterpret_cast<const float (*)[Dimensionality_Max]>(positions.data());
+
+  for (auto interpolationMethod : g_interpolationMethods)
+  {
+    std::vector<float> samples(count);
+    auto samplesRequest = accessManager.RequestVolumeSamples(samples.data(), samples.size() * sizeof(float), Dimensions_012, 0, 0, samplePositions, count, interpolationMethod, g_noValue);
+    ASSERT_TRUE(samplesRequest->WaitForCompletion());
+
+    std::vector<float> traces(size_t(count) * size[0]);
+    auto tracesRequest = accessManager.RequestVolumeTraces(traces.data(), traces.size() * sizeof(float), Dimensions_012, 0, 0, samplePositions, count, interpolationMethod, 0, g_noValue);
+    ASSERT_TRUE(tracesRequest->WaitForCompletion());
+
+    int mismatches = 0;
+    for (int i = 0; i < count; i++)
+    {
+      const float *position = samplePositions[i];
+      float expected = sampleScalar(interpolationMethod, true, data, size, pitch, position[0], position[1], position[2]);
+      if (!isSameFloat(samples[i], expected) && mismatches++ < 10)
+      {
+        ADD_FAILURE() << "RequestVolumeSamples method " << int(interpolationMethod) << " sample " << i << ": " << samples[i] << " != " << expected;
+      }
+
+      for (int traceSample = 0; traceSample < size[0]; traceSample++)
+      {
+        float expectedTrace = sampleScalar(interpolationMethod, true, data, size, pitch, traceSample + 0.5f, position[1], position[2]);
+        if (!isSameFloat(traces[size_t(i) * size[0] + traceSample], expectedTrace) && mismatches++ < 10)
+        {
+          ADD_FAILURE() << "RequestVolumeTraces method " << int(interpolationMethod) << " trace " << i << " sample " << traceSample << ": " << traces[size_t(i) * size[0] + traceSample] << " != " << expectedTrace;
+        }
+      }
+    }
+    EXPECT_EQ(mismatches, 0);
+  }
+}
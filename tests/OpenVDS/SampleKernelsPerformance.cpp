@@ -0,0 +1,134 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+
+#include <VDS/VolumeDataSampleKernels.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <chrono>
+#include <random>
+
+static const char *interpolationMethodName(OpenVDS::InterpolationMethod interpolationMethod)
+{
+  switch (interpolationMethod)
+  {
+  case OpenVDS::InterpolationMethod::Nearest: return "Nearest";
+  case OpenVDS::InterpolationMethod::Linear:  return "Linear";
+  default:                                    return "Cubic";
+  }
+}
+
+TEST(OpenVDS_performance, SampleKernels)
+{
+  const int size = 64;
+  std::vector<float> data(size_t(size) * size * size);
+  std::mt19937 gen(123);
+  std::uniform_real_distribution<float> valueDistribution(-1.0f, 1.0f);
+  for (auto &value : data)
+  {
+    value = valueDistribution(gen);
+  }
+
+  OpenVDS::SampleKernels::SampleBuffer buffer;
+  buffer.data = data.data();
+  for (int i = 0; i < 3; i++)
+  {
+    buffer.size[i] = size;
+  }
+  buffer.pitch[0] = 1;
+  buffer.pitch[1] = size;
+  buffer.pitch[2] = size * size;
+  buffer.isUseNoValue = true;
+  buffer.noValue = -999.25f;
+  buffer.replacementNoValue = -999.25f;
+
+  const int count = 4096;
+  const int iterations = 100;
+  std::uniform_real_distribution<float> positionDistribution(0.0f, float(size));
+  std::vector<float> u(count), v(count), w(count), result(count);
+  for (int i = 0; i < count; i++)
+  {
+    u[i] = positionDistribution(gen);
+    v[i] = positionDistribution(gen);
+    w[i] = positionDistribution(gen);
+  }
+
+  std::vector<OpenVDS::SampleKernels::InstructionSet> instructionSets = { OpenVDS::SampleKernels::InstructionSet::Scalar };
+  if (OpenVDS::SampleKernels::SupportedInstructionSet() >= OpenVDS::SampleKernels::InstructionSet::SSE41) instructionSets.push_back(OpenVDS::SampleKernels::InstructionSet::SSE41);
+  if (OpenVDS::SampleKernels::SupportedInstructionSet() >= OpenVDS::SampleKernels::InstructionSet::AVX2) instructionSets.push_back(OpenVDS::SampleKernels::InstructionSet::AVX2);
+
+  for (auto interpolationMethod : { OpenVDS::InterpolationMethod::Nearest, OpenVDS::InterpolationMethod::Linear, OpenVDS::InterpolationMethod::Cubic })
+  {
+    for (auto instructionSet : instructionSets)
+    {
+      OpenVDS::SampleKernels::Sample3D(instructionSet, interpolationMethod, buffer, u.data(), v.data(), w.data(), count, result.data());
+
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int iteration = 0; iteration < iterations; iteration++)
+      {
+        OpenVDS::SampleKernels::Sample3D(instructionSet, interpolationMethod, buffer, u.data(), v.data(), w.data(), count, result.data());
+      }
+      double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+      fmt::print(stderr, "{:<8} {:<8} {:8.1f} million samples/s\n", interpolationMethodName(interpolationMethod), OpenVDS::SampleKernels::InstructionSetName(instructionSet), double(count) * iterations / seconds / 1e6);
+    }
+  }
+}
+
+TEST(OpenVDS_performance, RequestVolumeSamples)
+{
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(256, 128, 128, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_64), OpenVDS::Close);
+  ASSERT_TRUE(handle);
+  fill3DVDSWithNoise(handle.get());
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+  OpenVDS::VolumeDataLayout const *layout = accessManager.GetVolumeDataLayout();
+
+  // Horizon-like positions: one sample for every trace, at a slowly varying depth
+  const int sampleCount = layout->GetDimensionNumSamples(1) * layout->GetDimensionNumSamples(2);
+  std::vector<float> positions(size_t(sampleCount) * OpenVDS::Dimensionality_Max, 0.0f);
+  for (int i = 0; i < sampleCount; i++)
+  {
+    int y = i % layout->GetDimensionNumSamples(1), z = i / layout->GetDimensionNumSamples(1);
+    positions[i * OpenVDS::Dimensionality_Max + 0] = 128.0f + 100.0f * std::sin(y * 0.05f) * std::cos(z * 0.03f);
+    positions[i * OpenVDS::Dimensionality_Max + 1] = y + 0.5f;
+    positions[i * OpenVDS::Dimensionality_Max + 2] = z + 0.5f;
+  }
+  auto samplePositions = reinterpret_cast<const float (*)[OpenVDS::Dimensionality_Max]>(positions.data());
+  std::vector<float> samples(sampleCount);
+
+  for (auto interpolationMethod : { OpenVDS::InterpolationMethod::Nearest, OpenVDS::InterpolationMethod::Linear, OpenVDS::InterpolationMethod::Cubic })
+  {
+    const int iterations = 10;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+      auto request = accessManager.RequestVolumeSamples(samples.data(), samples.size() * sizeof(float), OpenVDS::Dimensions_012, 0, 0, samplePositions, sampleCount, interpolationMethod);
+      ASSERT_TRUE(request->WaitForCompletion());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    fmt::print(stderr, "RequestVolumeSamples {:<8} {:8.1f} million samples/s\n", interpolationMethodName(interpolationMethod), double(sampleCount) * iterations / seconds / 1e6);
+  }
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+
+#include <gtest/gtest.h>
+
+#include "../utils/GenerateVDS.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static void SetFileReadQueue(const char *queueType)
+{
+#ifdef _WIN32
+  _putenv_s("OPENVDS_FILE_READ_QUEUE", queueType);
+#else
+  setenv("OPENVDS_FILE_READ_QUEUE", queueType, 1);
+#endif
+}
+
+// A wavelet compressed VDS file must read back the same no matter how the chunks are read from the file, also when a
+// progressive request (which starts reading a coarse adaptive level) and a normal request prepare the same chunks.
+TEST(OpenVDS_integration, VDSFileReadModes)
+{
+  const OpenVDS::VDSFileOpenOptions openOptions("test_read_modes.vds");
+  remove(openOptions.fileName.c_str());
+
+  OpenVDS::Error error;
+  {
+    OpenVDS::VolumeDataLayoutDescriptor layoutDescriptor(OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, 4, 4, 4, OpenVDS::VolumeDataLayoutDescriptor::LODLevels_None, OpenVDS::VolumeDataLayoutDescriptor::Options_None);
+    std::vector<OpenVDS::VolumeDataAxisDescriptor> axisDescriptors;
+    axisDescriptors.emplace_back(90, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_SAMPLE, "ms", 0.0f, 356.0f);
+    axisDescriptors.emplace_back(90, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_CROSSLINE, "", 1932.0f, 2021.0f);
+    axisDescriptors.emplace_back(90, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_INLINE, "", 9985.0f, 10074.0f);
+    std::vector<OpenVDS::VolumeDataChannelDescriptor> channelDescriptors;
+    channelDescriptors.emplace_back(OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataChannelDescriptor::Components_1, AMPLITUDE_ATTRIBUTE_NAME, "", -0.1234f, 0.1234f);
+    OpenVDS::MetadataContainer metadataContainer;
+
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Create(openOptions, layoutDescriptor, axisDescriptors, channelDescriptors, metadataContainer, OpenVDS::CompressionMethod::Wavelet, 0.01f, error), &OpenVDS::Close);
+    ASSERT_TRUE(handle) << error.string;
+    fill3DVDSWithNoise(handle.get());
+  }
+
+  int32_t minPos[OpenVDS::Dimensionality_Max] = { 0, 0, 0, 0, 0, 0 };
+  int32_t maxPos[OpenVDS::Dimensionality_Max] = { 90, 90, 90, 1, 1, 1 };
+
+  std::vector<float> reference;
+
+  const char *queueTypes[] = { "none", "threadpool", "io_uring", "mmap" };
+  for (auto queueType : queueTypes)
+  {
+    SetFileReadQueue(queueType);
+
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Open(openOptions, error), &OpenVDS::Close);
+    ASSERT_TRUE(handle) << error.string;
+    OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+    int64_t bufferSize = accessManager.GetVolumeSubsetBufferSize(minPos, maxPos, OpenVDS::VolumeDataChannelDescriptor::Format_R32, 0, 0);
+
+    // Requests that are cancelled right away leave reads that nobody waits for
+    for (int i = 0; i < 4; i++)
+    {
+      accessManager.RequestVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, minPos, maxPos)->Cancel();
+    }
+
+    std::vector<float> progressive(bufferSize / sizeof(float));
+    auto progressiveRequest = accessManager.RequestVolumeSubsetProgressive(progressive.data(), bufferSize, OpenVDS::Dimensions_012, 0, 0, minPos, maxPos, OpenVDS::VolumeDataChannelDescriptor::Format_R32, 6, nullptr);
+    auto request = accessManager.RequestVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, minPos, maxPos);
+    ASSERT_TRUE(progressiveRequest->WaitForCompletion()) << queueType;
+    ASSERT_TRUE(request->WaitForCompletion()) << queueType;
+
+    EXPECT_EQ(memcmp(progressive.data(), request->Data().data(), bufferSize), 0) << queueType;
+
+    if (reference.empty())
+    {
+      reference = request->Data();
+    }
+    EXPECT_EQ(memcmp(reference.data(), request->Data().data(), bufferSize), 0) << queueType;
+  }
+  SetFileReadQueue("");
+
+  remove(openOptions.fileName.c_str());
+}
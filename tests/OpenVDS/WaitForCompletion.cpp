@@ -29,6 +29,10 @@
 #include <OpenVDS/IO/IOManager.h>
 #include <OpenVDS/IO/IOManagerInMemory.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 TEST(WaitForCompletion, waitTimeout)
 {
   OpenVDS::InMemoryOpenOptions options;
@@ -48,3 +52,53 @@ TEST(WaitForCompletion, waitTimeout)
   ASSERT_FALSE(requestFloat->WaitForCompletion(1));
   ASSERT_TRUE(requestFloat->WaitForCompletion(0));
 }
+
+TEST(WaitForCompletion, concurrentWaiters)
+{
+  OpenVDS::InMemoryOpenOptions options;
+  OpenVDS::Error error;
+  std::unique_ptr<OpenVDS::IOManager> inMemory(OpenVDS::IOManagerInMemory::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadWrite, error));
+  SlowIOManager* slowIOManager = new SlowIOManager(5, inMemory.get());
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(128,128,128, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, slowIOManager), OpenVDS::Close);
+  fill3DVDSWithBitNoise(handle.get());
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  const int requestCount = 64;
+  const int threadCount = 8;
+  std::vector<std::shared_ptr<OpenVDS::VolumeDataRequestFloat>> requests;
+  for (int i = 0; i < requestCount; i++)
+  {
+    int32_t minPos[OpenVDS::Dimensionality_Max] = { (i % 4) * 32, ((i / 4) % 4) * 32, (i / 16) * 32 };
+    int32_t maxPos[OpenVDS::Dimensionality_Max] = { minPos[0] + 32, minPos[1] + 32, minPos[2] + 32 };
+    requests.push_back(accessManager.RequestVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, minPos, maxPos));
+  }
+
+  // Half of the threads block on their requests while the other half poll theirs
+  std::atomic<int> completed(0);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < threadCount; thread++)
+  {
+    threads.emplace_back([&requests, &completed, thread]
+      {
+        for (int i = thread; i < requestCount; i += threadCount)
+        {
+          bool isCompleted;
+          if (thread % 2)
+          {
+            isCompleted = requests[i]->WaitForCompletion();
+          }
+          else
+          {
+            while (!(isCompleted = requests[i]->IsCompleted()) && !requests[i]->IsCanceled())
+              std::this_thread::yield();
+          }
+          if (isCompleted)
+            completed++;
+        }
+      });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(completed, requestCount);
+}
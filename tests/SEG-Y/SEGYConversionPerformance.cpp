@@ -0,0 +1,81 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <SEGYUtils/SEGY.h>
+#include "SEGYConversion.h"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+using namespace SEGY;
+
+// Time a conversion of a trace sized buffer, repeated so the total amount of converted data is large
+static double benchmark(std::function<void()> const &convert, int iterations)
+{
+  convert();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    convert();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(SEGYConversion_performance, conversionKernels)
+{
+  // Seismic-like amplitudes with the occasional zero trace sample
+  const int sampleCount = 1500;
+  const int iterations = 20000;
+  std::vector<float> ieee(sampleCount);
+  for (int sample = 0; sample < sampleCount; sample++)
+  {
+    ieee[sample] = (sample % 97 == 0) ? 0.0f : 1000.0f * std::sin(sample * 0.05f) * std::exp(-sample * 0.001f);
+  }
+
+  std::vector<uint32_t> ibmBigEndian(sampleCount);
+  std::vector<uint32_t> ibmLittleEndian(sampleCount);
+  std::vector<uint32_t> ieeeBigEndian(sampleCount);
+  Ieee2ibm(ibmBigEndian.data(), ieee.data(), sampleCount, Endianness::BigEndian);
+  Ieee2ibm(ibmLittleEndian.data(), ieee.data(), sampleCount, Endianness::LittleEndian);
+  ByteSwap32(ieeeBigEndian.data(), ieee.data(), sampleCount);
+
+  std::vector<float> result(sampleCount);
+  std::vector<uint32_t> ibmResult(sampleCount);
+  double megaBytes = double(sampleCount) * sizeof(float) * iterations / (1024.0 * 1024.0);
+
+  std::vector<Conversion::InstructionSet> instructionSets = { Conversion::InstructionSet::Scalar };
+  if (Conversion::SupportedInstructionSet() >= Conversion::InstructionSet::SSE41) instructionSets.push_back(Conversion::InstructionSet::SSE41);
+  if (Conversion::SupportedInstructionSet() >= Conversion::InstructionSet::AVX2) instructionSets.push_back(Conversion::InstructionSet::AVX2);
+
+  for (auto instructionSet : instructionSets)
+  {
+    double ibmBigEndianSeconds = benchmark([&]() { Conversion::Ibm2ieee(instructionSet, result.data(), ibmBigEndian.data(), sampleCount, Endianness::BigEndian); }, iterations);
+    double ibmLittleEndianSeconds = benchmark([&]() { Conversion::Ibm2ieee(instructionSet, result.data(), ibmLittleEndian.data(), sampleCount, Endianness::LittleEndian); }, iterations);
+    double ieee2ibmSeconds = benchmark([&]() { Conversion::Ieee2ibm(instructionSet, ibmResult.data(), ieee.data(), sampleCount, Endianness::BigEndian); }, iterations);
+    double byteSwapSeconds = benchmark([&]() { Conversion::ByteSwap32(instructionSet, result.data(), ieeeBigEndian.data(), sampleCount); }, iterations);
+
+    fmt::print(stderr, "{:<8} Ibm2ieee (big-endian) {:6.0f} MB/s, Ibm2ieee (little-endian) {:6.0f} MB/s, Ieee2ibm {:6.0f} MB/s, ByteSwap32 {:6.0f} MB/s\n",
+               Conversion::InstructionSetName(instructionSet), megaBytes / ibmBigEndianSeconds, megaBytes / ibmLittleEndianSeconds, megaBytes / ieee2ibmSeconds, megaBytes / byteSwapSeconds);
+
+    EXPECT_EQ(result[1], ieee[1]);
+  }
+}
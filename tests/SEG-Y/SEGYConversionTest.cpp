@@ -0,0 +1,336 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <SEGYUtils/SEGY.h>
+#include "SEGYConversion.h"
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+using namespace SEGY;
+
+// The scalar conversion functions as they were before the SIMD kernels were added, used as the reference
+
+static void
+referenceIbm2ieee(void *to, const void *from, size_t len)
+{
+  for (; len-- > 0; to = (char *)to + 4, from = (const char *)from + 4)
+  {
+    unsigned int
+      fr = *(const uint32_t *)from;
+
+    if (fr == 0)
+    { 
+      /* short-circuit for everything is zero. Then (also endian converted) matissa also is */
+
+      *(unsigned *)to = 0x00000000;
+
+      continue;
+    }
+
+#ifdef WIN32
+    fr =_byteswap_ulong(fr);
+#else
+    fr = __builtin_bswap32(fr);
+#endif // WIN32
+
+    unsigned int
+      sgn = fr & 0x80000000; /* save sign */
+
+    unsigned int
+      expIBM4 = (fr & 0x7f000000) >> 22;   // i.e. 4 * expIBM, shift (24 down and then 2 up in one go).
+
+    fr &= 0x00ffffff;
+
+    if (fr == 0)
+    { 
+      /* short-circuit for zero matissa*/
+      *(unsigned *)to = sgn;  // Matissa all zeroes, set exponent all zero, maintain sign.
+     
+      continue;
+    }
+
+    // The involved magic numbers will fall out when studying the IEEE and IBM representations.
+  
+    const bool
+      isNormalNumberEnsured = (expIBM4 > 154) && (expIBM4 < 385);
+
+    // Inside this range, none of the special considerations needs be taken. 
+
+    if (isNormalNumberEnsured)
+    {
+      // This approach should be SSE friendly, for further optimization.
+
+      // First let the CPU instruction convert the IBM matissa conversion into an IEEE float.
+      // This will handle the possible leading zeroes on the IBM matissa without any loop,
+      // or use of count leading zero instuction, which is not part of SSE (to the version
+      // we can currently assume in common use.)
+
+      float
+        rValue = float (fr);
+
+      uint32_t
+        uValue;
+      memcpy(&uValue, &rValue, sizeof(uValue));
+
+      // Then mod the exponent on the IEEE number, and we are done.
+
+      uint32_t
+        uExp = (expIBM4 - uint32_t(280)) << 23;
+
+      uValue = uValue + uExp; 
+
+      *(unsigned int*)to = (uValue | sgn);
+
+    }
+    else
+    {
+      // Note: This else clause is able to handle all cases (i.e. also the normal range above).
+
+       /*
+      adjust exponent from base 16 offset 64 radix point before first digit
+          to base 2 offset 127 radix point after first digit
+      (exp - 64) * 4 + 127 - 1 == exp * 4 - 256 + 126 == (exp << 2) - 130
+      */
+      int
+        expModified = expIBM4 - 130;
+
+      int
+        nNormalizeShift = 0;
+
+      /* normalize */
+      while (fr < 0x00800000)
+      {
+        fr <<= 1;
+        nNormalizeShift++;
+      }
+
+      expModified = expModified - nNormalizeShift;
+
+      if (expModified <= 0)
+      { 
+        /* underflow */
+        if (expModified < -23)
+        {
+          /* complete underflow - return properly signed zero */
+          fr = 0;
+        }
+        else
+        {
+          /* partial underflow - return denormalized number */
+          fr >>= 1-expModified;
+        }
+        expModified = 0;
+      }
+      else if (expModified >= 255)
+      { 
+        /* overflow - return infinity */
+        fr = 0;
+        expModified = 255;
+      }
+      else
+      { 
+        /* Standard number - assumed high bit masked away below */
+      }
+
+      *(unsigned *)to = (fr & 0x007fffff) | (expModified << 23) | sgn;  
+    }
+  }
+}
+
+static void
+referenceIeee2ibm(void *to, const void *from, size_t len)
+{
+  unsigned fr; /* fraction */
+  int exp; /* exponent */
+  int sgn; /* sign */
+
+  for (; len-- > 0; to = (char *)to + 4, from = (const char *)from + 4)
+  {
+        /* split into sign, exponent, and fraction */
+    fr = *(const unsigned *)from; /* pick up value */
+    sgn = fr >> 31; /* save sign */
+    fr <<= 1; /* shift sign out */
+    exp = fr >> 24; /* save exponent */
+    fr <<= 8; /* shift exponent out */
+
+    if (exp == 255) { /* infinity (or NAN) - map to largest */
+      fr = 0xffffff00;
+      exp = 0x7f;
+      goto done;
+    }
+    else if (exp > 0) /* add assumed digit */
+      fr = (fr >> 1) | 0x80000000;
+    else if (fr == 0) /* short-circuit for zero */
+      goto done;
+
+        /* adjust exponent from base 2 offset 127 radix point after first digit
+           to base 16 offset 64 radix point before first digit */
+    exp += 130;
+    fr >>= -exp & 3;
+    exp = (exp + 3) >> 2;
+
+        /* (re)normalize */
+    while (fr < 0x10000000)
+    { /* never executed for normalized input */
+      --exp;
+      fr <<= 4;
+    }
+
+    done:
+/* put the pieces back together and return it */
+    fr = (fr >> 8) | (exp << 24) | (unsigned(sgn) << 31);
+
+#ifdef WIN32
+    fr =_byteswap_ulong(fr);
+#else
+    fr = __builtin_bswap32(fr);
+#endif // WIN32
+
+    *(unsigned *)to = fr;
+  }
+}
+
+static uint32_t byteSwap(uint32_t value)
+{
+  return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+}
+
+// Bit patterns covering zeros, denormals, the limits of the normal ranges, infinities and NaNs, followed by random patterns
+static std::vector<uint32_t> testPatterns()
+{
+  std::vector<uint32_t> patterns;
+
+  for (uint32_t sign = 0; sign < 2; sign++)
+  {
+    for (uint32_t exponent = 0; exponent < 256; exponent++)
+    {
+      for (uint32_t fraction : { 0x000000u, 0x000001u, 0x00000fu, 0x0000f0u, 0x000fffu, 0x0fffffu, 0x100000u, 0x7fffffu, 0x800000u, 0xffffffu, 0x555555u, 0x0aaaaau })
+      {
+        patterns.push_back((sign << 31) | (exponent << 23) | (fraction & 0x7fffff)); // IEEE layout
+        patterns.push_back((sign << 31) | ((exponent & 0x7f) << 24) | fraction);     // IBM layout
+      }
+    }
+  }
+
+  std::mt19937 generator(1234);
+  std::uniform_int_distribution<uint32_t> distribution;
+  for (int i = 0; i < 1 << 16; i++)
+  {
+    patterns.push_back(distribution(generator));
+  }
+
+  return patterns;
+}
+
+static std::vector<Conversion::InstructionSet> supportedInstructionSets()
+{
+  std::vector<Conversion::InstructionSet> instructionSets = { Conversion::InstructionSet::Scalar };
+  if (Conversion::SupportedInstructionSet() >= Conversion::InstructionSet::SSE41) instructionSets.push_back(Conversion::InstructionSet::SSE41);
+  if (Conversion::SupportedInstructionSet() >= Conversion::InstructionSet::AVX2) instructionSets.push_back(Conversion::InstructionSet::AVX2);
+  return instructionSets;
+}
+
+TEST(SEGYConversionTest, ibm2ieee)
+{
+  std::vector<uint32_t> bigEndian = testPatterns();
+  std::vector<uint32_t> littleEndian(bigEndian.size());
+  for (size_t i = 0; i < bigEndian.size(); i++)
+  {
+    littleEndian[i] = byteSwap(bigEndian[i]);
+  }
+
+  std::vector<uint32_t> expected(bigEndian.size());
+  referenceIbm2ieee(expected.data(), bigEndian.data(), bigEndian.size());
+
+  for (auto instructionSet : supportedInstructionSets())
+  {
+    // Use odd lengths and offsets to exercise the scalar tail and unaligned loads
+    for (size_t offset : { 0, 1, 3 })
+    {
+      size_t len = bigEndian.size() - offset - 1;
+      std::vector<uint32_t> result(len);
+
+      Conversion::Ibm2ieee(instructionSet, result.data(), bigEndian.data() + offset, len, Endianness::BigEndian);
+      EXPECT_EQ(0, memcmp(result.data(), expected.data() + offset, len * 4)) << Conversion::InstructionSetName(instructionSet) << " big-endian";
+
+      Conversion::Ibm2ieee(instructionSet, result.data(), littleEndian.data() + offset, len, Endianness::LittleEndian);
+      EXPECT_EQ(0, memcmp(result.data(), expected.data() + offset, len * 4)) << Conversion::InstructionSetName(instructionSet) << " little-endian";
+    }
+
+    // In-place conversion
+    std::vector<uint32_t> inPlace = bigEndian;
+    Conversion::Ibm2ieee(instructionSet, inPlace.data(), inPlace.data(), inPlace.size(), Endianness::BigEndian);
+    EXPECT_TRUE(inPlace == expected) << Conversion::InstructionSetName(instructionSet) << " in-place";
+  }
+}
+
+TEST(SEGYConversionTest, ieee2ibm)
+{
+  std::vector<uint32_t> ieee = testPatterns();
+
+  std::vector<uint32_t> expected(ieee.size());
+  referenceIeee2ibm(expected.data(), ieee.data(), ieee.size());
+
+  for (auto instructionSet : supportedInstructionSets())
+  {
+    for (size_t offset : { 0, 1, 3 })
+    {
+      size_t len = ieee.size() - offset - 1;
+      std::vector<uint32_t> result(len);
+
+      Conversion::Ieee2ibm(instructionSet, result.data(), ieee.data() + offset, len, Endianness::BigEndian);
+      EXPECT_EQ(0, memcmp(result.data(), expected.data() + offset, len * 4)) << Conversion::InstructionSetName(instructionSet) << " big-endian";
+
+      Conversion::Ieee2ibm(instructionSet, result.data(), ieee.data() + offset, len, Endianness::LittleEndian);
+      for (size_t i = 0; i < len; i++)
+      {
+        result[i] = byteSwap(result[i]);
+      }
+      EXPECT_EQ(0, memcmp(result.data(), expected.data() + offset, len * 4)) << Conversion::InstructionSetName(instructionSet) << " little-endian";
+    }
+
+    std::vector<uint32_t> inPlace = ieee;
+    Conversion::Ieee2ibm(instructionSet, inPlace.data(), inPlace.data(), inPlace.size(), Endianness::BigEndian);
+    EXPECT_TRUE(inPlace == expected) << Conversion::InstructionSetName(instructionSet) << " in-place";
+  }
+}
+
+TEST(SEGYConversionTest, byteSwap)
+{
+  std::vector<uint32_t> values = testPatterns();
+
+  std::vector<uint32_t> expected(values.size());
+  ConvertFromEndianness<Endianness::BigEndian>(expected.data(), reinterpret_cast<const char *>(values.data()), int(values.size()));
+
+  for (auto instructionSet : supportedInstructionSets())
+  {
+    for (size_t offset : { 0, 1, 3 })
+    {
+      size_t len = values.size() - offset - 1;
+      std::vector<uint32_t> result(len);
+
+      Conversion::ByteSwap32(instructionSet, result.data(), values.data() + offset, len);
+      EXPECT_EQ(0, memcmp(result.data(), expected.data() + offset, len * 4)) << Conversion::InstructionSetName(instructionSet);
+    }
+  }
+}
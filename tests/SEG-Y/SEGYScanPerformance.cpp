@@ -0,0 +1,83 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <SEGYUtils/SEGYFileInfo.h>
+
+#include "../utils/GenerateSEGY.h"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+using namespace SEGY;
+
+static const int g_fileCount = 6;
+static const int g_inlineCount = 200;
+static const int g_crosslineCount = 150;
+
+static double scan(std::shared_ptr<SEGYObjectStore> store, int threadCount, SEGYFileInfo &fileInfo, int64_t &readCount)
+{
+  OpenVDS::Error error;
+  std::vector<DataProvider> dataProviders;
+  for (int file = 0; file < g_fileCount; file++)
+  {
+    dataProviders.emplace_back(new SEGYObjectIOManager(store), fmt::format("file{}.segy", file), error);
+  }
+
+  int64_t readCountBefore = store->m_readCount;
+  auto start = std::chrono::steady_clock::now();
+  bool success = fileInfo.Scan(dataProviders, error, TraceHeader::InlineNumberHeaderField, TraceHeader::CrosslineNumberHeaderField, TraceHeader::StartTimeHeaderField, SEGYBinInfoHeaderFields::StandardHeaderFields(), threadCount);
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_TRUE(success) << error.string;
+
+  readCount = store->m_readCount - readCountBefore;
+  return std::chrono::duration<double>(end - start).count();
+}
+
+TEST(SEGYScan_performance, parallelScan)
+{
+  // Each read takes 2 ms, about the latency of a small ranged read from object storage
+  auto store = std::make_shared<SEGYObjectStore>(2);
+
+  for (int file = 0; file < g_fileCount; file++)
+  {
+    store->m_objects.emplace(fmt::format("file{}.segy", file), generateSEGY(int64_t(g_inlineCount) * g_crosslineCount, 50, [&](int64_t trace, int &inlineNumber, int &crosslineNumber)
+      {
+        inlineNumber = file * g_inlineCount + int(trace / g_crosslineCount) + 1;
+        crosslineNumber = int(trace % g_crosslineCount) + 1;
+      }));
+  }
+
+  SEGYFileInfo sequential, parallel;
+  int64_t sequentialReadCount, parallelReadCount;
+  double sequentialSeconds = scan(store, 1, sequential, sequentialReadCount);
+  double parallelSeconds = scan(store, 32, parallel, parallelReadCount);
+
+  ASSERT_EQ(sequential.m_segmentInfoLists.size(), parallel.m_segmentInfoLists.size());
+  for (int file = 0; file < g_fileCount; file++)
+  {
+    EXPECT_EQ(g_inlineCount, int(parallel.m_segmentInfoLists[file].size()));
+    ASSERT_EQ(sequential.m_segmentInfoLists[file].size(), parallel.m_segmentInfoLists[file].size());
+    for (size_t segment = 0; segment < sequential.m_segmentInfoLists[file].size(); segment++)
+    {
+      EXPECT_EQ(sequential.m_segmentInfoLists[file][segment].m_traceStop, parallel.m_segmentInfoLists[file][segment].m_traceStop);
+    }
+  }
+
+  fmt::print(stderr, "Scan of {} files with {} traces: {:.2f} s ({} reads) with 1 thread, {:.2f} s ({} reads) with 32 threads\n", g_fileCount, g_inlineCount * g_crosslineCount, sequentialSeconds, sequentialReadCount, parallelSeconds, parallelReadCount);
+}
@@ -18,8 +18,13 @@
 #include "IO/File.h"
 #include <SEGYUtils/SEGYFileInfo.h>
 
+#include "../utils/GenerateSEGY.h"
+
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
+
 using namespace SEGY;
 
 TEST(SEGYScanTest, scan)
@@ -65,3 +70,101 @@ TEST(SEGYScanTest, scan)
 
   EXPECT_TRUE(fileInfo.m_segmentInfoLists.front().back().m_traceStop == fileInfo.m_traceCounts[0] - 1);
 }
+
+static void expectSameBinInfo(SEGYBinInfo const &a, SEGYBinInfo const &b)
+{
+  EXPECT_EQ(a.m_inlineNumber, b.m_inlineNumber);
+  EXPECT_EQ(a.m_crosslineNumber, b.m_crosslineNumber);
+  EXPECT_EQ(a.m_ensembleXCoordinate, b.m_ensembleXCoordinate);
+  EXPECT_EQ(a.m_ensembleYCoordinate, b.m_ensembleYCoordinate);
+}
+
+static void expectSameScan(std::shared_ptr<SEGYObjectStore> store, std::vector<std::string> const &objectNames, SEGYType segyType)
+{
+  std::vector<DataProvider>
+    dataProviders;
+
+  OpenVDS::Error
+    error;
+
+  for (auto const &objectName : objectNames)
+  {
+    dataProviders.emplace_back(new SEGYObjectIOManager(store), objectName, error);
+    ASSERT_EQ(error.code, 0) << error.string;
+  }
+
+  SEGYFileInfo
+    sequential,
+    parallel;
+
+  sequential.m_segyType = parallel.m_segyType = segyType;
+
+  ASSERT_TRUE(sequential.Scan(dataProviders, error, TraceHeader::InlineNumberHeaderField, TraceHeader::CrosslineNumberHeaderField, TraceHeader::StartTimeHeaderField, SEGYBinInfoHeaderFields::StandardHeaderFields(), 1)) << error.string;
+  ASSERT_TRUE(parallel.Scan(dataProviders, error, TraceHeader::InlineNumberHeaderField, TraceHeader::CrosslineNumberHeaderField, TraceHeader::StartTimeHeaderField, SEGYBinInfoHeaderFields::StandardHeaderFields(), 8)) << error.string;
+
+  EXPECT_EQ(sequential.m_sampleCount, parallel.m_sampleCount);
+  EXPECT_EQ(sequential.m_sampleIntervalMilliseconds, parallel.m_sampleIntervalMilliseconds);
+  EXPECT_EQ(sequential.m_traceCounts, parallel.m_traceCounts);
+  ASSERT_EQ(sequential.m_segmentInfoLists.size(), parallel.m_segmentInfoLists.size());
+
+  for (size_t file = 0; file < sequential.m_segmentInfoLists.size(); file++)
+  {
+    auto const &sequentialSegments = sequential.m_segmentInfoLists[file];
+    auto const &parallelSegments = parallel.m_segmentInfoLists[file];
+    ASSERT_EQ(sequentialSegments.size(), parallelSegments.size()) << "file " << file;
+
+    for (size_t segment = 0; segment < sequentialSegments.size(); segment++)
+    {
+      EXPECT_EQ(sequentialSegments[segment].m_primaryKey, parallelSegments[segment].m_primaryKey);
+      EXPECT_EQ(sequentialSegments[segment].m_traceStart, parallelSegments[segment].m_traceStart);
+      EXPECT_EQ(sequentialSegments[segment].m_traceStop, parallelSegments[segment].m_traceStop);
+      expectSameBinInfo(sequentialSegments[segment].m_binInfoStart, parallelSegments[segment].m_binInfoStart);
+      expectSameBinInfo(sequentialSegments[segment].m_binInfoStop, parallelSegments[segment].m_binInfoStop);
+    }
+  }
+}
+
+TEST(SEGYScanTest, parallelScan)
+{
+  auto
+    store = std::make_shared<SEGYObjectStore>();
+
+  // Inlines of varying length, large enough to be split into several trace ranges
+  std::vector<int64_t> inlineStarts(1, 0);
+  for (int inlineIndex = 0; inlineStarts.back() < 60000; inlineIndex++)
+  {
+    inlineStarts.push_back(inlineStarts.back() + 100 + (inlineIndex * 37) % 150);
+  }
+  int64_t traceCount = inlineStarts.back();
+  store->m_objects.emplace("regular.segy", generateSEGY(traceCount, 10, [&](int64_t trace, int &inlineNumber, int &crosslineNumber)
+    {
+      auto it = std::upper_bound(inlineStarts.begin(), inlineStarts.end(), trace) - 1;
+      inlineNumber = 1000 + int(it - inlineStarts.begin());
+      crosslineNumber = 1 + int(trace - *it);
+    }));
+
+  // Runs of random length with a few primary keys that repeat in non-contiguous runs, where the segments found depend on how they are searched
+  std::mt19937 generator(42);
+  std::vector<int64_t> runStarts(1, 0);
+  std::vector<int> runKeys(1, 0);
+  while (runStarts.back() < 30000)
+  {
+    runStarts.push_back(runStarts.back() + std::uniform_int_distribution<int>(1, 1500)(generator));
+    runKeys.push_back((runKeys.back() + std::uniform_int_distribution<int>(1, 3)(generator)) % 4);
+  }
+  store->m_objects.emplace("irregular.segy", generateSEGY(runStarts.back(), 10, [&](int64_t trace, int &inlineNumber, int &crosslineNumber)
+    {
+      auto it = std::upper_bound(runStarts.begin(), runStarts.end(), trace) - 1;
+      inlineNumber = runKeys[it - runStarts.begin()];
+      crosslineNumber = 1 + int(trace - *it);
+    }));
+
+  // A file with only the file headers, and a file with a single trace
+  store->m_objects.emplace("empty.segy", generateSEGY(0, 10, nullptr));
+  store->m_objects.emplace("single.segy", generateSEGY(1, 10, [&](int64_t trace, int &inlineNumber, int &crosslineNumber) { inlineNumber = 1; crosslineNumber = 1; }));
+
+  expectSameScan(store, { "regular.segy" }, SEGYType::Poststack);
+  expectSameScan(store, { "irregular.segy" }, SEGYType::Poststack);
+  expectSameScan(store, { "regular.segy", "empty.segy", "irregular.segy", "single.segy", "regular.segy" }, SEGYType::Poststack);
+  expectSameScan(store, { "irregular.segy", "regular.segy" }, SEGYType::CDPGathers);
+}
@@ -0,0 +1,159 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <VDS/VolumeDataStore.h>
+#include <VDS/DataBlock.h>
+#include <IO/File.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace OpenVDS
+{
+  bool DeserializeVolumeData(const std::vector<uint8_t>& serializedData, VolumeDataChannelDescriptor::Format format, CompressionMethod compressionMethod, const FloatRange& valueRange, float integerScale, float integerOffset, bool isUseNoValue, float noValue, int32_t adaptiveLevel, DataBlock& dataBlock, std::vector<uint8_t>& destination, Error& error);
+}
+
+static std::vector<uint8_t> LoadTestFile(const std::string &file)
+{
+  OpenVDS::File chunkFile;
+  OpenVDS::Error error;
+  chunkFile.Open(TEST_DATA_PATH + file, false, false, false, error);
+  EXPECT_EQ(error.code, 0);
+
+  int64_t fileSize = chunkFile.Size(error);
+  EXPECT_EQ(error.code, 0);
+
+  std::vector<uint8_t> serializedData(fileSize);
+  chunkFile.Read(serializedData.data(), 0, (int32_t)fileSize, error);
+  EXPECT_EQ(error.code, 0);
+  return serializedData;
+}
+
+static void benchmarkCodec(const std::string &file, OpenVDS::VolumeDataChannelDescriptor::Format format, OpenVDS::CompressionMethod compressionMethod, float compressionTolerance, const char *name)
+{
+  if (!OpenVDS::IsCompressionMethodSupported(compressionMethod))
+  {
+    fmt::print(stderr, "{:<32} {:<10} not supported by this build\n", file, name);
+    return;
+  }
+
+  OpenVDS::FloatRange valueRange(-0.07883811742067337f, 0.07883811742067337f);
+  OpenVDS::Error error;
+
+  std::vector<uint8_t> data;
+  OpenVDS::DataBlock dataBlock;
+  OpenVDS::DeserializeVolumeData(LoadTestFile(file), format, OpenVDS::CompressionMethod::None, valueRange, 1.0f, 0.0f, false, 0.0f, 0, dataBlock, data, error);
+  ASSERT_EQ(error.code, 0) << error.string;
+
+  const int iterations = 10;
+  double byteSize = double(OpenVDS::GetByteSize(dataBlock)) * iterations;
+
+  // The fixture chunks are not constant, so no layer is needed to compute a constant value hash
+  OpenVDS::VolumeDataChunk chunk = { nullptr, 0 };
+  std::vector<uint8_t> serialized;
+  std::vector<uint8_t> adaptiveLevels;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    OpenVDS::VolumeDataStore::SerializeVolumeData(chunk, dataBlock, data, compressionMethod, compressionTolerance, serialized, adaptiveLevels);
+  }
+  double encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<uint8_t> deserialized;
+  OpenVDS::DataBlock deserializedDataBlock;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    ASSERT_TRUE(OpenVDS::DeserializeVolumeData(serialized, dataBlock.Format, compressionMethod, valueRange, 1.0f, 0.0f, false, 0.0f, 0, deserializedDataBlock, deserialized, error)) << error.string;
+  }
+  double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  EXPECT_EQ(deserialized, data);
+
+  fmt::print(stderr, "{:<32} {:<10} ratio {:6.3f}  encode {:8.1f} MB/s  decode {:8.1f} MB/s\n", file, name, double(OpenVDS::GetByteSize(dataBlock)) / serialized.size(), byteSize / encodeSeconds / (1024 * 1024), byteSize / decodeSeconds / (1024 * 1024));
+}
+
+TEST(VDS_performance, Codecs)
+{
+  struct Fixture
+  {
+    const char *file;
+    OpenVDS::VolumeDataChannelDescriptor::Format format;
+  };
+
+  Fixture fixtures[] =
+  {
+    { "/chunk.CompressionMethod_None", OpenVDS::VolumeDataChannelDescriptor::Format_R32 },
+    { "/chunk.U8.CompressionMethod_None", OpenVDS::VolumeDataChannelDescriptor::Format_U8 },
+    { "/chunk.U16.CompressionMethod_None", OpenVDS::VolumeDataChannelDescriptor::Format_U16 }
+  };
+
+  for (auto &fixture : fixtures)
+  {
+    const char *file = fixture.file;
+    auto format = fixture.format;
+    benchmarkCodec(file, format, OpenVDS::CompressionMethod::None, 0.0f, "None");
+    benchmarkCodec(file, format, OpenVDS::CompressionMethod::RLE, 0.0f, "RLE");
+    benchmarkCodec(file, format, OpenVDS::CompressionMethod::Zip, 0.0f, "Zip");
+    benchmarkCodec(file, format, OpenVDS::CompressionMethod::Zstd, 1.0f, "Zstd -1");
+    benchmarkCodec(file, format, OpenVDS::CompressionMethod::Zstd, 0.0f, "Zstd");
+    benchmarkCodec(file, format, OpenVDS::CompressionMethod::Zstd, 9.0f, "Zstd -9");
+    benchmarkCodec(file, format, OpenVDS::CompressionMethod::LZ4, 0.0f, "LZ4");
+  }
+}
+
+static void benchmarkWaveletDecode(const std::string &file, OpenVDS::VolumeDataChannelDescriptor::Format format, OpenVDS::CompressionMethod compressionMethod)
+{
+  OpenVDS::FloatRange valueRange(-0.07883811742067337f, 0.07883811742067337f);
+  OpenVDS::Error error;
+
+  std::vector<uint8_t> serialized = LoadTestFile(file);
+  int32_t adaptiveLevel = compressionMethod == OpenVDS::CompressionMethod::WaveletLossless ? -1 : 0;
+
+  // The first decode grows the work buffers of the thread, it is not timed
+  std::vector<uint8_t> deserialized;
+  OpenVDS::DataBlock dataBlock;
+  ASSERT_TRUE(OpenVDS::DeserializeVolumeData(serialized, format, compressionMethod, valueRange, 1.0f, 0.0f, false, 0.0f, adaptiveLevel, dataBlock, deserialized, error)) << error.string;
+
+  const int iterations = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    ASSERT_TRUE(OpenVDS::DeserializeVolumeData(serialized, format, compressionMethod, valueRange, 1.0f, 0.0f, false, 0.0f, adaptiveLevel, dataBlock, deserialized, error)) << error.string;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  int64_t voxelCount = int64_t(dataBlock.Size[0]) * dataBlock.Size[1] * dataBlock.Size[2];
+  fmt::print(stderr, "{:<48} {:8.1f} million voxels/s  {:8.2f} ms/chunk\n", file, double(voxelCount) * iterations / seconds / 1e6, seconds * 1000 / iterations);
+}
+
+TEST(VDS_performance, WaveletDecode)
+{
+  benchmarkWaveletDecode("/chunk.CompressionMethod_Wavelet", OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::Wavelet);
+  benchmarkWaveletDecode("/chunk.U8.CompressionMethod_Wavelet", OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::CompressionMethod::Wavelet);
+  benchmarkWaveletDecode("/chunk.U16.CompressionMethod_Wavelet", OpenVDS::VolumeDataChannelDescriptor::Format_U16, OpenVDS::CompressionMethod::Wavelet);
+  benchmarkWaveletDecode("/chunk.CompressionMethod_WaveletLossless", OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::WaveletLossless);
+  benchmarkWaveletDecode("/chunk.U8.CompressionMethod_WaveletLossless", OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::CompressionMethod::WaveletLossless);
+  benchmarkWaveletDecode("/chunk.U16.CompressionMethod_WaveletLossless", OpenVDS::VolumeDataChannelDescriptor::Format_U16, OpenVDS::CompressionMethod::WaveletLossless);
+  benchmarkWaveletDecode("/chunk.1082.CompressionMethod_WaveletLossless", OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::WaveletLossless);
+  benchmarkWaveletDecode("/chunk.1255.CompressionMethod_WaveletLossless", OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::WaveletLossless);
+}
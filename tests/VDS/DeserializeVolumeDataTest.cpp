@@ -19,12 +19,17 @@
 #include <OpenVDS/VolumeDataChannelDescriptor.h>
 #include <VDS/VolumeDataStore.h>
 #include <VDS/DataBlock.h>
+#include <VDS/WaveletTypes.h>
+#include <VDS/Rle.h>
+#include <VDS/ThreadPool.h>
 #include <IO/File.h>
 #include <OpenVDS/ValueConversion.h>
 #include <OpenVDS/Range.h>
 
 #include <cstdlib>
 #include <cmath>
+#include <chrono>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -311,3 +316,269 @@ GTEST_TEST(VDS_integration, DeSerializeVolumeData1255)
   
   verify_lossless(valueRange, dataBlockNone, dataNone, "/chunk.1255.CompressionMethod_WaveletLossless", OpenVDS::CompressionMethod::WaveletLossless, OpenVDS::VolumeDataChannelDescriptor::Format_R32);
 }
+
+static std::vector<uint8_t> CompressWavelet(const OpenVDS::FloatRange &valueRange, const OpenVDS::DataBlock &dataBlock, const std::vector<uint8_t> &data, bool isUseNoValue, float noValue, float compressionTolerance, bool isLossless, int (&adaptiveLevelSizes)[WAVELET_ADAPTIVE_LEVELS])
+{
+  OpenVDS::Error error;
+  std::vector<uint8_t> compressed;
+  EXPECT_TRUE(OpenVDS::Wavelet_Compress(dataBlock, data.data(), valueRange, isUseNoValue, noValue, compressionTolerance, isLossless, compressed, adaptiveLevelSizes, error)) << error.string;
+  EXPECT_EQ(compressed.size() % sizeof(int32_t), 0);
+  EXPECT_EQ(reinterpret_cast<const int32_t *>(compressed.data())[1], int32_t(compressed.size()));
+  return compressed;
+}
+
+template<typename T>
+static void verify_integer_lossless(OpenVDS::VolumeDataChannelDescriptor::Format format, enum OpenVDS::DataBlock::Dimensionality dimensionality, int32_t (&size)[OpenVDS::DataBlock::Dimensionality_Max])
+{
+  OpenVDS::Error error;
+  OpenVDS::DataBlock dataBlock;
+  ASSERT_TRUE(OpenVDS::InitializeDataBlock(format, OpenVDS::VolumeDataChannelDescriptor::Components_1, dimensionality, size, dataBlock, error)) << error.string;
+
+  std::vector<uint8_t> data(OpenVDS::GetAllocatedByteSize(dataBlock));
+  T *values = reinterpret_cast<T *>(data.data());
+  srand(1234);
+  for (int i2 = 0; i2 < size[2]; i2++)
+    for (int i1 = 0; i1 < size[1]; i1++)
+      for (int i0 = 0; i0 < size[0]; i0++)
+      {
+        float smooth = (std::sin(i0 * 0.1f) * std::cos(i1 * 0.07f + i2 * 0.05f) + 1.0f) * 0.45f;
+        values[i0 + i1 * dataBlock.Pitch[1] + i2 * dataBlock.Pitch[2]] = T(smooth * std::numeric_limits<T>::max() + rand() % 8);
+      }
+
+  int adaptiveLevelSizes[WAVELET_ADAPTIVE_LEVELS];
+  OpenVDS::FloatRange valueRange(0.0f, float(std::numeric_limits<T>::max()));
+  std::vector<uint8_t> compressed = CompressWavelet(valueRange, dataBlock, data, false, 0.0f, 0.0f, true, adaptiveLevelSizes);
+
+  std::vector<uint8_t> decompressed;
+  OpenVDS::DataBlock decompressedDataBlock;
+  OpenVDS::DeserializeVolumeData(compressed, format, OpenVDS::CompressionMethod::WaveletLossless, valueRange, 1.0f, 0.0f, false, 0.0f, -1, decompressedDataBlock, decompressed, error);
+  ASSERT_EQ(error.code, 0) << error.string;
+  ASSERT_EQ(decompressed.size(), data.size());
+
+  const T *decompressedValues = reinterpret_cast<const T *>(decompressed.data());
+  int mismatches = 0;
+  for (int i2 = 0; i2 < size[2]; i2++)
+    for (int i1 = 0; i1 < size[1]; i1++)
+      for (int i0 = 0; i0 < size[0]; i0++)
+      {
+        int32_t offset = i0 + i1 * dataBlock.Pitch[1] + i2 * dataBlock.Pitch[2];
+        mismatches += values[offset] != decompressedValues[offset];
+      }
+  EXPECT_EQ(mismatches, 0);
+}
+
+GTEST_TEST(VDS_integration, WaveletCompressRoundTrip)
+{
+  OpenVDS::Error error;
+
+  OpenVDS::FloatRange valueRange(-0.07883811742067337f, 0.07883811742067337f);
+  std::vector<uint8_t> serializedNone = LoadTestFile("/chunk.CompressionMethod_None");
+  std::vector<uint8_t> dataNone;
+  OpenVDS::DataBlock dataBlockNone;
+  OpenVDS::DeserializeVolumeData(serializedNone, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::None, valueRange, 1.0f, 0.0f, false, 0.0f, 0, dataBlockNone, dataNone, error);
+  ASSERT_EQ(error.code, 0);
+
+  int adaptiveLevelSizes[WAVELET_ADAPTIVE_LEVELS];
+  std::vector<uint8_t> compressed = CompressWavelet(valueRange, dataBlockNone, dataNone, false, 0.0f, 1.0f, false, adaptiveLevelSizes);
+  EXPECT_LT(compressed.size(), dataNone.size() / 2);
+
+  for (int level = 1; level < WAVELET_ADAPTIVE_LEVELS; level++)
+  {
+    EXPECT_LE(adaptiveLevelSizes[level], adaptiveLevelSizes[level - 1]);
+  }
+  EXPECT_LE(adaptiveLevelSizes[0], int(compressed.size()));
+
+  float diff, maxError, deviation, samples;
+  OpenVDS::DataBlock dataBlockWavelet;
+  std::vector<uint8_t> dataWavelet;
+  OpenVDS::DeserializeVolumeData(compressed, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::Wavelet, valueRange, 1.0f, 0.0f, false, 0.0f, 0, dataBlockWavelet, dataWavelet, error);
+  ASSERT_EQ(error.code, 0) << error.string;
+  Stats(valueRange, dataBlockNone, dataNone, dataBlockWavelet, dataWavelet, diff, maxError, deviation, samples);
+  float fullError = diff / samples;
+  EXPECT_LT(fullError, getOnePercentValueRange(valueRange, OpenVDS::VolumeDataChannelDescriptor::Format_R32) * 2);
+
+  // Decoding from the prefix given by the adaptive level metadata is coarser, but still close
+  uint8_t levels[WAVELET_ADAPTIVE_LEVELS];
+  OpenVDS::Wavelet_EncodeAdaptiveLevelsMetadata(int32_t(compressed.size()), adaptiveLevelSizes, levels);
+  int prefixSize = OpenVDS::Wavelet_DecodeAdaptiveLevelsMetadata(compressed.size(), 2, levels);
+  EXPECT_GE(prefixSize, adaptiveLevelSizes[2]);
+  EXPECT_LT(prefixSize, int(compressed.size()));
+  std::vector<uint8_t> prefix(compressed.begin(), compressed.begin() + prefixSize);
+  OpenVDS::DeserializeVolumeData(prefix, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::Wavelet, valueRange, 1.0f, 0.0f, false, 0.0f, 2, dataBlockWavelet, dataWavelet, error);
+  ASSERT_EQ(error.code, 0) << error.string;
+  Stats(valueRange, dataBlockNone, dataNone, dataBlockWavelet, dataWavelet, diff, maxError, deviation, samples);
+  EXPECT_GT(diff / samples, fullError);
+  EXPECT_LT(diff / samples, getOnePercentValueRange(valueRange, OpenVDS::VolumeDataChannelDescriptor::Format_R32) * 8);
+
+  // Lossless float compression is bit exact
+  compressed = CompressWavelet(valueRange, dataBlockNone, dataNone, false, 0.0f, 0.0f, true, adaptiveLevelSizes);
+  OpenVDS::DeserializeVolumeData(compressed, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::WaveletLossless, valueRange, 1.0f, 0.0f, false, 0.0f, -1, dataBlockWavelet, dataWavelet, error);
+  ASSERT_EQ(error.code, 0) << error.string;
+  ASSERT_EQ(dataWavelet.size(), dataNone.size());
+  EXPECT_EQ(memcmp(dataWavelet.data(), dataNone.data(), dataNone.size()), 0);
+}
+
+GTEST_TEST(VDS_integration, WaveletCompressNoValue)
+{
+  OpenVDS::Error error;
+
+  OpenVDS::FloatRange valueRange(-0.07883811742067337f, 0.07883811742067337f);
+  std::vector<uint8_t> serializedNone = LoadTestFile("/chunk.CompressionMethod_None");
+  std::vector<uint8_t> dataNone;
+  OpenVDS::DataBlock dataBlockNone;
+  OpenVDS::DeserializeVolumeData(serializedNone, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::CompressionMethod::None, valueRange, 1.0f, 0.0f, false, 0.0f, 0, dataBlockNone, dataNone, error);
+  ASSERT_EQ(error.code, 0);
+
+  const float noValue = -999.25f;
+  float *values = reinterpret_cast<float *>(dataNone.data());
+  for (int i2 = 0; i2 < dataBlockNone.Size[2]; i2++)
+    for (int i1 = 0; i1 < dataBlockNone.Size[1]; i1++)
+      for (int i0 = 0; i0 < 10; i0++)
+        values[i0 + i1 * dataBlockNone.Pitch[1] + i2 * dataBlockNone.Pitch[2]] = noValue;
+
+  for (bool isLossless : { false, true })
+  {
+    int adaptiveLevelSizes[WAVELET_ADAPTIVE_LEVELS];
+    std::vector<uint8_t> compressed = CompressWavelet(valueRange, dataBlockNone, dataNone, true, noValue, 1.0f, isLossless, adaptiveLevelSizes);
+
+    OpenVDS::DataBlock dataBlockWavelet;
+    std::vector<uint8_t> dataWavelet;
+    OpenVDS::DeserializeVolumeData(compressed, OpenVDS::VolumeDataChannelDescriptor::Format_R32, isLossless ? OpenVDS::CompressionMethod::WaveletLossless : OpenVDS::CompressionMethod::Wavelet, valueRange, 1.0f, 0.0f, true, noValue, isLossless ? -1 : 0, dataBlockWavelet, dataWavelet, error);
+    ASSERT_EQ(error.code, 0) << error.string;
+
+    const float *decompressed = reinterpret_cast<const float *>(dataWavelet.data());
+    int noValueMismatches = 0;
+    int valueMismatches = 0;
+    for (int i2 = 0; i2 < dataBlockNone.Size[2]; i2++)
+      for (int i1 = 0; i1 < dataBlockNone.Size[1]; i1++)
+        for (int i0 = 0; i0 < dataBlockNone.Size[0]; i0++)
+        {
+          int32_t offset = i0 + i1 * dataBlockNone.Pitch[1] + i2 * dataBlockNone.Pitch[2];
+          float tolerance = isLossless ? 0.0f : (valueRange.Max - valueRange.Min) * 0.1f;
+          if (i0 < 10)
+            noValueMismatches += decompressed[offset] != noValue;
+          else
+            valueMismatches += !(std::fabs(decompressed[offset] - values[offset]) <= tolerance);
+        }
+    EXPECT_EQ(noValueMismatches, 0);
+    EXPECT_EQ(valueMismatches, 0);
+  }
+}
+
+GTEST_TEST(VDS_integration, WaveletCompressIntegerLossless)
+{
+  int32_t size3D[OpenVDS::DataBlock::Dimensionality_Max] = { 64, 48, 40, 1 };
+  int32_t size2D[OpenVDS::DataBlock::Dimensionality_Max] = { 100, 70, 1, 1 };
+
+  verify_integer_lossless<uint8_t>(OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::DataBlock::Dimensionality_3, size3D);
+  verify_integer_lossless<uint16_t>(OpenVDS::VolumeDataChannelDescriptor::Format_U16, OpenVDS::DataBlock::Dimensionality_3, size3D);
+  verify_integer_lossless<uint8_t>(OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::DataBlock::Dimensionality_2, size2D);
+  verify_integer_lossless<uint16_t>(OpenVDS::VolumeDataChannelDescriptor::Format_U16, OpenVDS::DataBlock::Dimensionality_2, size2D);
+}
+
+template<typename T>
+static void verify_rle_round_trip(const std::vector<T> &values)
+{
+  int32_t sourceSize = int32_t(values.size() * sizeof(T));
+  std::vector<uint8_t> compressed(sizeof(OpenVDS::RLEHeader) + sourceSize * 2);
+  int32_t compressedSize = OpenVDS::RleCompress(compressed.data(), int32_t(compressed.size()), reinterpret_cast<const uint8_t *>(values.data()), sourceSize, int32_t(sizeof(T)));
+  ASSERT_GT(compressedSize, 0);
+  EXPECT_LT(compressedSize, sourceSize / 4);
+
+  std::vector<T> decompressed(values.size());
+  EXPECT_EQ(OpenVDS::RleDecompress(reinterpret_cast<uint8_t *>(decompressed.data()), sourceSize, compressed.data()), sourceSize);
+  EXPECT_EQ(decompressed, values);
+}
+
+GTEST_TEST(VDS_integration, RleCompressRoundTrip)
+{
+  // The encoder produces the same bytes as the encoder that wrote the fixture
+  std::vector<uint8_t> serializedNone = LoadTestFile("/chunk.CompressionMethod_None");
+  std::vector<uint8_t> serializedRle = LoadTestFile("/chunk.CompressionMethod_RLE");
+  ASSERT_GT(serializedNone.size(), sizeof(OpenVDS::DataBlockDescriptor));
+
+  const uint8_t *source = serializedNone.data() + sizeof(OpenVDS::DataBlockDescriptor);
+  int32_t sourceSize = int32_t(serializedNone.size() - sizeof(OpenVDS::DataBlockDescriptor));
+  std::vector<uint8_t> compressed(sizeof(OpenVDS::RLEHeader) + sourceSize * 2);
+  int32_t compressedSize = OpenVDS::RleCompress(compressed.data(), int32_t(compressed.size()), source, sourceSize, 4);
+  ASSERT_EQ(size_t(compressedSize), serializedRle.size() - sizeof(OpenVDS::DataBlockDescriptor));
+  EXPECT_EQ(memcmp(compressed.data(), serializedRle.data() + sizeof(OpenVDS::DataBlockDescriptor), compressedSize), 0);
+
+  EXPECT_EQ(OpenVDS::RleCompress(compressed.data(), compressedSize - 1, source, sourceSize, 4), -1);
+
+  // Runs of every length, separated by unique values, for every unit size
+  std::vector<uint8_t> values8;
+  std::vector<uint16_t> values16;
+  std::vector<uint64_t> values64;
+  srand(4321);
+  for (int run = 0; run < 2000; run++)
+  {
+    int runLength = (run % 7 == 0) ? 20000 + rand() % 1000 : 1 + rand() % 300;
+    uint8_t value = uint8_t(rand() % 4);
+    for (int i = 0; i < runLength; i++)
+    {
+      values8.push_back(value);
+      values16.push_back(uint16_t(value * 1000));
+      values64.push_back(uint64_t(value) << 40);
+    }
+    for (int i = rand() % 3; i > 0; i--)
+    {
+      values8.push_back(uint8_t(rand()));
+      values16.push_back(uint16_t(rand()));
+      values64.push_back(uint64_t(rand()));
+    }
+  }
+  verify_rle_round_trip(values8);
+  verify_rle_round_trip(values16);
+  verify_rle_round_trip(values64);
+}
+
+// A chunk decoded by a worker of a thread pool with idle workers shares the transform passes with them, the result must be
+// the same as when it is decoded by one thread
+GTEST_TEST(VDS_integration, WaveletDecodeOnThreadPool)
+{
+  OpenVDS::FloatRange valueRange(-0.07883811742067337f, 0.07883811742067337f);
+
+  struct
+  {
+    const char *file;
+    OpenVDS::CompressionMethod compressionMethod;
+    OpenVDS::VolumeDataChannelDescriptor::Format format;
+  } chunks[] =
+  {
+    { "/chunk.CompressionMethod_Wavelet", OpenVDS::CompressionMethod::Wavelet, OpenVDS::VolumeDataChannelDescriptor::Format_R32 },
+    { "/chunk.U8.CompressionMethod_Wavelet", OpenVDS::CompressionMethod::Wavelet, OpenVDS::VolumeDataChannelDescriptor::Format_U8 },
+    { "/chunk.CompressionMethod_WaveletLossless", OpenVDS::CompressionMethod::WaveletLossless, OpenVDS::VolumeDataChannelDescriptor::Format_R32 },
+    { "/chunk.U16.CompressionMethod_WaveletLossless", OpenVDS::CompressionMethod::WaveletLossless, OpenVDS::VolumeDataChannelDescriptor::Format_U16 },
+  };
+
+  ThreadPool threadPool(4);
+
+  for (auto &chunk : chunks)
+  {
+    std::vector<uint8_t> serialized = LoadTestFile(chunk.file);
+    int32_t adaptiveLevel = chunk.compressionMethod == OpenVDS::CompressionMethod::WaveletLossless ? -1 : 0;
+
+    OpenVDS::Error error;
+    OpenVDS::DataBlock dataBlockSerial;
+    std::vector<uint8_t> dataSerial;
+    ASSERT_TRUE(OpenVDS::DeserializeVolumeData(serialized, chunk.format, chunk.compressionMethod, valueRange, 1.0f, 0.0f, false, 0.0f, adaptiveLevel, dataBlockSerial, dataSerial, error)) << error.string;
+
+    // Let the workers go idle so the decoding worker has helpers
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    OpenVDS::DataBlock dataBlockPool;
+    std::vector<uint8_t> dataPool;
+    int idleWorkerCount = 0;
+    bool result = threadPool.Enqueue([&]
+      {
+        idleWorkerCount = ThreadPool::GetCurrentPool()->GetIdleWorkerCount();
+        return OpenVDS::DeserializeVolumeData(serialized, chunk.format, chunk.compressionMethod, valueRange, 1.0f, 0.0f, false, 0.0f, adaptiveLevel, dataBlockPool, dataPool, error);
+      }).get();
+    ASSERT_TRUE(result) << error.string;
+    EXPECT_GT(idleWorkerCount, 0);
+
+    ASSERT_EQ(dataPool.size(), dataSerial.size());
+    EXPECT_EQ(memcmp(dataPool.data(), dataSerial.data(), dataSerial.size()), 0) << chunk.file;
+  }
+}
@@ -0,0 +1,132 @@
+/****************************************************************************
+** Copyright 2019 The Open Group
+** Copyright 2019 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <VDS/ThreadPool.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+TEST(VDS_integration, ThreadPoolRunsAllTasks)
+{
+  ThreadPool threadPool(4);
+  std::atomic<int> sum(0);
+
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 1000; i++)
+  {
+    results.push_back(threadPool.Enqueue([&sum, i] { sum += i; return i; }, ThreadPool::Priority(i % ThreadPool::Priority_Count)));
+  }
+
+  int expected = 0;
+  for (int i = 0; i < int(results.size()); i++)
+  {
+    EXPECT_EQ(results[i].get(), i);
+    expected += i;
+  }
+  EXPECT_EQ(sum, expected);
+  EXPECT_EQ(threadPool.GetQueueDepth(), 0);
+}
+
+TEST(VDS_integration, ThreadPoolPriority)
+{
+  ThreadPool threadPool(1);
+
+  // Block the only worker so the following tasks are all queued before any of them run
+  std::promise<void> unblock;
+  std::shared_future<void> blocked = unblock.get_future().share();
+  auto blocker = threadPool.Enqueue([blocked] { blocked.wait(); });
+  while (threadPool.GetQueueDepth() != 0)
+    std::this_thread::yield();
+
+  std::vector<int> order;
+  std::vector<std::future<void>> results;
+  results.push_back(threadPool.Enqueue([&order] { order.push_back(ThreadPool::Priority_Low); }, ThreadPool::Priority_Low));
+  results.push_back(threadPool.Enqueue([&order] { order.push_back(ThreadPool::Priority_Normal); }, ThreadPool::Priority_Normal));
+  results.push_back(threadPool.Enqueue([&order] { order.push_back(ThreadPool::Priority_High); }, ThreadPool::Priority_High));
+
+  EXPECT_EQ(threadPool.GetQueueDepth(), 3);
+  EXPECT_EQ(threadPool.GetQueueDepth(ThreadPool::Priority_High), 1);
+
+  unblock.set_value();
+  blocker.get();
+  for (auto &result : results)
+    result.get();
+
+  ASSERT_EQ(order.size(), size_t(3));
+  EXPECT_EQ(order[0], ThreadPool::Priority_High);
+  EXPECT_EQ(order[1], ThreadPool::Priority_Normal);
+  EXPECT_EQ(order[2], ThreadPool::Priority_Low);
+}
+
+TEST(VDS_integration, ThreadPoolWorkStealing)
+{
+  ThreadPool threadPool(4);
+
+  // All tasks are enqueued from a worker, so they land in that worker's deque and
+  // the other workers can only get to them by stealing.
+  std::atomic<int> done(0);
+  auto producer = threadPool.Enqueue([&threadPool, &done]
+    {
+      std::vector<std::future<void>> results;
+      for (int i = 0; i < 64; i++)
+        results.push_back(threadPool.Enqueue([&done] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); done++; }));
+      return results;
+    });
+
+  for (auto &result : producer.get())
+    result.get();
+
+  EXPECT_EQ(done, 64);
+  EXPECT_GT(threadPool.GetStealCount(), 0);
+}
+
+TEST(VDS_integration, ThreadPoolParallelFor)
+{
+  ThreadPool threadPool(4);
+
+  // Called from a worker, with one helper per worker, so some of the helpers can only start after the call has returned
+  auto result = threadPool.Enqueue([&threadPool]
+    {
+      EXPECT_EQ(ThreadPool::GetCurrentPool(), &threadPool);
+
+      std::vector<std::atomic<int>> counts(100);
+      for (auto &count : counts)
+        count = 0;
+
+      for (int repeat = 0; repeat < 10; repeat++)
+      {
+        threadPool.ParallelFor(int(counts.size()), int(threadPool.GetWorkerCount()), [&counts](int i) { counts[i]++; });
+      }
+
+      int wrong = 0;
+      for (auto &count : counts)
+        wrong += count != 10;
+      return wrong;
+    });
+
+  EXPECT_EQ(result.get(), 0);
+  EXPECT_EQ(ThreadPool::GetCurrentPool(), nullptr);
+
+  // Called from outside the pool
+  std::atomic<int> sum(0);
+  threadPool.ParallelFor(1000, 3, [&sum](int i) { sum += i; });
+  EXPECT_EQ(sum, 999 * 1000 / 2);
+}
@@ -0,0 +1,183 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+
+#include <IO/IOManagerDiskCache.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+#ifndef _WIN32
+#include <utime.h>
+#endif
+
+#include "../utils/GenerateVDS.h"
+
+static void generateDataset(const std::string &name, const OpenVDS::FloatVector3 &frequency)
+{
+  OpenVDS::InMemoryOpenOptions options(name);
+  OpenVDS::Error error;
+  OpenVDS::IOManager *ioManager = OpenVDS::IOManager::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadWrite, error);
+  ASSERT_EQ(error.code, 0) << error.string;
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSimpleInMemory3DVDS(60, 60, 60, OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataLayoutDescriptor::BrickSize_32, ioManager), &OpenVDS::Close);
+  ASSERT_TRUE(handle);
+  fill3DVDSWithNoise(handle.get(), 0, frequency);
+}
+
+static OpenVDS::IOManagerDiskCache *createDiskCache(const std::string &name, const std::string &cachePath, int64_t maxCacheSize)
+{
+  OpenVDS::InMemoryOpenOptions options(name);
+  options.diskCachePath = cachePath;
+  options.diskCacheMaxSize = maxCacheSize;
+  OpenVDS::Error error;
+  OpenVDS::IOManager *ioManager = OpenVDS::IOManager::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadOnly, error);
+  EXPECT_EQ(error.code, 0) << error.string;
+  return static_cast<OpenVDS::IOManagerDiskCache *>(ioManager);
+}
+
+// The disk cache is owned by the VDS and is destroyed when it is closed
+static std::vector<float> readAllSamples(OpenVDS::IOManagerDiskCache *diskCache, int64_t &hits, int64_t &misses, int64_t *staleEntries = nullptr)
+{
+  OpenVDS::Error error;
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Open(diskCache, error), &OpenVDS::Close);
+  EXPECT_TRUE(handle) << error.string;
+  if (!handle)
+    return std::vector<float>();
+
+  auto layout = OpenVDS::GetLayout(handle.get());
+  auto accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  int32_t minPos[OpenVDS::Dimensionality_Max] = {};
+  int32_t maxPos[OpenVDS::Dimensionality_Max] = {};
+  for (int dimension = 0; dimension < layout->GetDimensionality(); dimension++)
+    maxPos[dimension] = layout->GetDimensionNumSamples(dimension);
+
+  auto request = accessManager.RequestVolumeSubset<float>(OpenVDS::Dimensions_012, 0, 0, minPos, maxPos);
+  EXPECT_TRUE(request->WaitForCompletion());
+  hits = diskCache->GetHitCount();
+  misses = diskCache->GetMissCount();
+  if (staleEntries)
+    *staleEntries = diskCache->GetStaleCount();
+  return std::move(request->Data());
+}
+
+// Removes the cache directory when the test ends, also when it fails
+struct CacheDirectoryRemover
+{
+  std::string cachePath;
+  ~CacheDirectoryRemover() { OpenVDS::IOManagerDiskCache::RemoveCache(cachePath); }
+};
+
+TEST(IOTests, DiskCache)
+{
+  ASSERT_NO_FATAL_FAILURE(generateDataset("DiskCache", OpenVDS::FloatVector3(0.6f, 2.f, 4.f)));
+
+  // Use a new directory every run so entries from an earlier run of the test are not hits
+  std::string cachePath = fmt::format("DiskCacheTest_{}", std::chrono::steady_clock::now().time_since_epoch().count());
+  CacheDirectoryRemover cacheDirectoryRemover = { cachePath };
+  const int64_t maxCacheSize = int64_t(1) << 30;
+
+  int64_t hits, misses;
+  OpenVDS::IOManagerDiskCache *diskCache = createDiskCache("DiskCache", cachePath, maxCacheSize);
+  ASSERT_TRUE(diskCache);
+  std::vector<float> uncached = readAllSamples(diskCache, hits, misses);
+  ASSERT_FALSE(uncached.empty());
+  EXPECT_EQ(hits, 0);
+  EXPECT_GT(misses, 0);
+  int64_t chunkCount = misses;
+
+  // A second open of the same dataset is served from the files written by the first one
+  diskCache = createDiskCache("DiskCache", cachePath, maxCacheSize);
+  ASSERT_TRUE(diskCache);
+  EXPECT_GT(diskCache->GetCacheSize(), 0);
+  std::vector<float> cached = readAllSamples(diskCache, hits, misses);
+  EXPECT_EQ(hits, chunkCount);
+  EXPECT_EQ(misses, 0);
+  EXPECT_EQ(cached, uncached);
+
+  // Another dataset with the same layout and chunk names doesn't see the entries of the first one
+  ASSERT_NO_FATAL_FAILURE(generateDataset("DiskCacheOther", OpenVDS::FloatVector3(1.f, 1.f, 1.f)));
+  diskCache = createDiskCache("DiskCacheOther", cachePath, maxCacheSize);
+  ASSERT_TRUE(diskCache);
+  std::vector<float> other = readAllSamples(diskCache, hits, misses);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, chunkCount);
+  EXPECT_NE(other, uncached);
+
+  // When the dataset is rewritten the stale entries are deleted and the chunks are read from the backend again
+  ASSERT_NO_FATAL_FAILURE(generateDataset("DiskCache", OpenVDS::FloatVector3(1.f, 1.f, 1.f)));
+  diskCache = createDiskCache("DiskCache", cachePath, maxCacheSize);
+  ASSERT_TRUE(diskCache);
+  int64_t staleEntries;
+  std::vector<float> rewritten = readAllSamples(diskCache, hits, misses, &staleEntries);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, chunkCount);
+  EXPECT_EQ(staleEntries, chunkCount);
+  EXPECT_EQ(rewritten, other);
+
+  // With a size limit smaller than a single chunk the existing entries are evicted, and so is every new one
+  diskCache = createDiskCache("DiskCache", cachePath, 1024);
+  ASSERT_TRUE(diskCache);
+  EXPECT_EQ(diskCache->GetCacheSize(), 0);
+  std::vector<float> evicted = readAllSamples(diskCache, hits, misses);
+  EXPECT_EQ(hits, 0);
+  EXPECT_EQ(misses, chunkCount);
+  EXPECT_EQ(evicted, rewritten);
+
+  std::unique_ptr<OpenVDS::IOManagerDiskCache> emptyDiskCache(createDiskCache("DiskCache", cachePath, 1024));
+  EXPECT_EQ(emptyDiskCache->GetCacheSize(), 0);
+}
+
+#ifndef _WIN32
+// Temporary files left behind by a process that died while writing an entry are deleted when they are old
+TEST(IOTests, DiskCacheTemporaryFiles)
+{
+  ASSERT_NO_FATAL_FAILURE(generateDataset("DiskCacheTemporaryFiles", OpenVDS::FloatVector3(0.6f, 2.f, 4.f)));
+
+  std::string cachePath = fmt::format("DiskCacheTemporaryFilesTest_{}", std::chrono::steady_clock::now().time_since_epoch().count());
+  CacheDirectoryRemover cacheDirectoryRemover = { cachePath };
+  std::unique_ptr<OpenVDS::IOManagerDiskCache> diskCache(createDiskCache("DiskCacheTemporaryFiles", cachePath, int64_t(1) << 30));
+  ASSERT_TRUE(diskCache);
+
+  std::string oldFile = cachePath + "/old.entry.1.0.tmp";
+  std::string newFile = cachePath + "/new.entry.1.1.tmp";
+  for (auto &file : { oldFile, newFile })
+  {
+    FILE *temporaryFile = fopen(file.c_str(), "wb");
+    ASSERT_TRUE(temporaryFile);
+    fclose(temporaryFile);
+  }
+  struct utimbuf times;
+  times.actime = times.modtime = time(nullptr) - 2 * 3600;
+  ASSERT_EQ(utime(oldFile.c_str(), &times), 0);
+
+  diskCache.reset(createDiskCache("DiskCacheTemporaryFiles", cachePath, int64_t(1) << 30));
+  ASSERT_TRUE(diskCache);
+  EXPECT_EQ(fopen(oldFile.c_str(), "rb"), nullptr);
+  FILE *file = fopen(newFile.c_str(), "rb");
+  EXPECT_NE(file, nullptr);
+  if (file)
+    fclose(file);
+}
+#endif
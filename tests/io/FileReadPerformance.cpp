@@ -0,0 +1,258 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataLayout.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/KnownMetadata.h>
+#include <OpenVDS/GlobalMetadataCommon.h>
+#include <OpenVDS/MetadataContainer.h>
+
+#include "IO/File.h"
+#include "IO/FileReadQueue.h"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Reading a file that was just written is served from the page cache, so try to evict it before each run
+static void DropFromPageCache(const std::string &fileName)
+{
+#ifdef __linux__
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd >= 0)
+  {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+#else
+  (void)fileName;
+#endif
+}
+
+static void SetFileReadQueue(const char *queueType)
+{
+#ifdef _WIN32
+  _putenv_s("OPENVDS_FILE_READ_QUEUE", queueType);
+#else
+  setenv("OPENVDS_FILE_READ_QUEUE", queueType, 1);
+#endif
+}
+
+// Generates a VDS file with 1 MB chunks of the given size in GB, reads it back through the access manager with
+// synchronous reads, with each kind of FileReadQueue and from a mapping of the file, and also measures random chunk
+// sized reads straight from the file at the queue depth the data store uses.
+TEST(IOTests, FileReadPerformance)
+{
+  const char *sizeVariable = getenv("OPENVDS_FILE_READ_BENCHMARK_GB");
+  if (!sizeVariable || atoi(sizeVariable) <= 0)
+  {
+    GTEST_SKIP() << "This test has to be enabled manually by setting OPENVDS_FILE_READ_BENCHMARK_GB to the size of the generated file";
+  }
+  int sizeGB = atoi(sizeVariable);
+
+  const OpenVDS::VDSFileOpenOptions openOptions("file_read_performance.vds");
+  remove(openOptions.fileName.c_str());
+
+  const int chunkSamples = 64;
+  const int samples[3] = { 256, 1024, 1024 * sizeGB };
+  OpenVDS::Error error;
+
+  auto generateStart = std::chrono::high_resolution_clock::now();
+  {
+    OpenVDS::VolumeDataLayoutDescriptor layoutDescriptor(OpenVDS::VolumeDataLayoutDescriptor::BrickSize_64, 0, 0, 4, OpenVDS::VolumeDataLayoutDescriptor::LODLevels_None, OpenVDS::VolumeDataLayoutDescriptor::Options_None);
+    std::vector<OpenVDS::VolumeDataAxisDescriptor> axisDescriptors;
+    axisDescriptors.emplace_back(samples[0], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_SAMPLE, "ms", 0.0f, 4.0f * (samples[0] - 1));
+    axisDescriptors.emplace_back(samples[1], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_CROSSLINE, "", 0.0f, float(samples[1] - 1));
+    axisDescriptors.emplace_back(samples[2], KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_INLINE, "", 0.0f, float(samples[2] - 1));
+    std::vector<OpenVDS::VolumeDataChannelDescriptor> channelDescriptors;
+    channelDescriptors.emplace_back(OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataChannelDescriptor::Components_1, AMPLITUDE_ATTRIBUTE_NAME, "", 0.0f, 1.0f);
+    OpenVDS::MetadataContainer metadataContainer;
+
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Create(openOptions, layoutDescriptor, axisDescriptors, channelDescriptors, metadataContainer, error), &OpenVDS::Close);
+    ASSERT_TRUE(handle) << error.string;
+
+    OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+    OpenVDS::VolumeDataPageAccessor *pageAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 0, 16, OpenVDS::VolumeDataAccessManager::AccessMode_Create);
+
+    std::mt19937 gen(123);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<float> noise(1 << 16);
+    for (auto &value : noise)
+      value = distribution(gen);
+
+    int64_t chunkCount = pageAccessor->GetChunkCount();
+    for (int64_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+      OpenVDS::VolumeDataPage *page = pageAccessor->CreatePage(chunk);
+      int pitch[OpenVDS::Dimensionality_Max];
+      float *buffer = static_cast<float *>(page->GetWritableBuffer(pitch));
+      int64_t count = int64_t(pitch[2]) * chunkSamples;
+      for (int64_t i = 0; i < count; i += int64_t(noise.size()))
+      {
+        std::copy(noise.begin(), noise.begin() + std::min(int64_t(noise.size()), count - i), buffer + i);
+      }
+      buffer[0] = float(chunk);
+      page->Release();
+    }
+    pageAccessor->Commit();
+    pageAccessor->SetMaxPages(0);
+    accessManager.FlushUploadQueue();
+    accessManager.DestroyVolumeDataPageAccessor(pageAccessor);
+  }
+  auto generateEnd = std::chrono::high_resolution_clock::now();
+
+  int64_t fileSize;
+  {
+    OpenVDS::File file;
+    ASSERT_TRUE(file.Open(openOptions.fileName, false, false, false, error)) << error.string;
+    fileSize = file.Size(error);
+  }
+  fmt::print(stderr, "Generated {} MB in {:.2f} seconds\n", fileSize >> 20, std::chrono::duration<double>(generateEnd - generateStart).count());
+
+  // Random reads of chunk size straight from the file
+  {
+    const int32_t readSize = 1 << 20;
+    const int readCount = int(std::min(fileSize / readSize, int64_t(4096)));
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> offsetDistribution(0, fileSize / readSize - 1);
+    std::vector<int64_t> offsets(readCount);
+    for (auto &offset : offsets)
+      offset = offsetDistribution(gen) * readSize;
+
+    OpenVDS::File file;
+    ASSERT_TRUE(file.Open(openOptions.fileName, false, false, false, error)) << error.string;
+
+    std::vector<std::vector<uint8_t>> buffers(readCount, std::vector<uint8_t>(readSize));
+
+    DropFromPageCache(openOptions.fileName);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < readCount; i++)
+    {
+      ASSERT_TRUE(file.Read(buffers[i].data(), offsets[i], readSize, error)) << error.string;
+    }
+    double syncSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    fmt::print(stderr, "Random 1 MB reads, File::Read: {:.0f} MB/s\n", readCount / syncSeconds);
+
+    OpenVDS::FileReadQueue::Type types[] = { OpenVDS::FileReadQueue::Type_ThreadPool, OpenVDS::FileReadQueue::Type_IoUring };
+    const char *typeNames[] = { "thread pool", "io_uring" };
+    for (int type = 0; type < 2; type++)
+    {
+      std::unique_ptr<OpenVDS::FileReadQueue> queue = OpenVDS::FileReadQueue::Create(file, 128, types[type]);
+      if (!queue)
+      {
+        fmt::print(stderr, "Random 1 MB reads, {}: not available\n", typeNames[type]);
+        continue;
+      }
+
+      std::vector<std::shared_ptr<OpenVDS::FileReadRequest>> requests(readCount);
+      DropFromPageCache(openOptions.fileName);
+      start = std::chrono::high_resolution_clock::now();
+      for (int i = 0; i < readCount; i++)
+      {
+        requests[i] = queue->Read(buffers[i].data(), offsets[i], readSize);
+      }
+      for (auto &request : requests)
+      {
+        ASSERT_TRUE(request->WaitForFinish(error)) << error.string;
+      }
+      double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+      fmt::print(stderr, "Random 1 MB reads, {} at queue depth 128: {:.0f} MB/s\n", typeNames[type], readCount / seconds);
+    }
+
+    OpenVDS::FileView *fileView = file.CreateFileView(0, fileSize, false, error);
+    ASSERT_TRUE(fileView) << error.string;
+    DropFromPageCache(openOptions.fileName);
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < readCount; i++)
+    {
+      ASSERT_TRUE(OpenVDS::FileView::CopyData(buffers[i].data(), static_cast<const uint8_t *>(fileView->Pointer()) + offsets[i], readSize));
+    }
+    double viewSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    fmt::print(stderr, "Random 1 MB reads, FileView::CopyData: {:.0f} MB/s\n", readCount / viewSeconds);
+    OpenVDS::FileView::RemoveReference(fileView);
+  }
+
+  // Reading the whole volume through the access manager, a slab of chunks per request with a few requests in flight.
+  // Each kind of read is done with the file evicted from the page cache, then again with the file in the page cache.
+  const char *queueTypes[] = { "none", "threadpool", "io_uring", "mmap" };
+  double checksums[8] = {};
+  for (int run = 0; run < 8; run++)
+  {
+    int queueType = run % 4;
+    bool isCold = run < 4;
+    SetFileReadQueue(queueTypes[queueType]);
+    if (isCold)
+    {
+      DropFromPageCache(openOptions.fileName);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Open(openOptions, error), &OpenVDS::Close);
+    ASSERT_TRUE(handle) << error.string;
+    OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+    const int requestsInFlight = 4;
+    const int slabCount = samples[2] / chunkSamples;
+    int64_t slabSize = int64_t(samples[0]) * samples[1] * chunkSamples;
+    std::vector<std::vector<float>> buffers(requestsInFlight, std::vector<float>(slabSize));
+    std::vector<std::shared_ptr<OpenVDS::VolumeDataRequest>> requests(requestsInFlight);
+
+    for (int slab = 0; slab < slabCount + requestsInFlight; slab++)
+    {
+      int index = slab % requestsInFlight;
+      if (requests[index])
+      {
+        ASSERT_TRUE(requests[index]->WaitForCompletion());
+        for (int64_t i = 0; i < slabSize; i += chunkSamples)
+        {
+          checksums[run] += buffers[index][i];
+        }
+        requests[index].reset();
+      }
+      if (slab < slabCount)
+      {
+        int minPos[OpenVDS::Dimensionality_Max] = { 0, 0, slab * chunkSamples, 0, 0, 0 };
+        int maxPos[OpenVDS::Dimensionality_Max] = { samples[0], samples[1], (slab + 1) * chunkSamples, 1, 1, 1 };
+        requests[index] = accessManager.RequestVolumeSubset(static_cast<void *>(buffers[index].data()), slabSize * int64_t(sizeof(float)), OpenVDS::Dimensions_012, 0, 0, minPos, maxPos, OpenVDS::VolumeDataChannelDescriptor::Format_R32);
+      }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    fmt::print(stderr, "Whole volume through RequestVolumeSubset, OPENVDS_FILE_READ_QUEUE={}, {} page cache: {:.0f} MB/s\n", queueTypes[queueType], isCold ? "cold" : "warm", (fileSize >> 20) / seconds);
+  }
+  SetFileReadQueue("");
+
+  for (int run = 1; run < 8; run++)
+  {
+    EXPECT_EQ(checksums[0], checksums[run]);
+  }
+
+  remove(openOptions.fileName.c_str());
+}
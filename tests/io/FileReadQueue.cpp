@@ -0,0 +1,111 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include "IO/File.h"
+#include "IO/FileReadQueue.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+static void TestFileReadQueue(const std::vector<uint8_t> &fileData, std::unique_ptr<OpenVDS::FileReadQueue> fileReadQueue)
+{
+  struct Read
+  {
+    int64_t offset;
+    int32_t length;
+    std::vector<uint8_t> data;
+    std::shared_ptr<OpenVDS::FileReadRequest> request;
+  };
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int64_t> offsetDistribution(0, int64_t(fileData.size()) - 1);
+  std::uniform_int_distribution<int32_t> lengthDistribution(0, 1 << 16);
+
+  // More reads than the queue depth, so some reads have to wait for others to complete
+  std::vector<Read> reads(256);
+
+  // Destroyed before the reads, so no read is left writing to a freed buffer
+  std::unique_ptr<OpenVDS::FileReadQueue> queue = std::move(fileReadQueue);
+
+  for (auto &read : reads)
+  {
+    read.offset = offsetDistribution(gen);
+    read.length = int32_t(std::min(int64_t(lengthDistribution(gen)), int64_t(fileData.size()) - read.offset));
+    read.data.resize(read.length);
+    read.request = queue->Read(read.data.data(), read.offset, read.length);
+  }
+
+  for (auto &read : reads)
+  {
+    OpenVDS::Error error;
+    ASSERT_TRUE(read.request->WaitForFinish(error)) << error.string;
+    EXPECT_TRUE(read.request->IsDone());
+    EXPECT_EQ(memcmp(read.data.data(), fileData.data() + read.offset, read.length), 0);
+  }
+
+  // Reading past the end of the file fails
+  std::vector<uint8_t> data(1024);
+  auto request = queue->Read(data.data(), int64_t(fileData.size()) - 512, int32_t(data.size()));
+  OpenVDS::Error error;
+  EXPECT_FALSE(request->WaitForFinish(error));
+  EXPECT_NE(error.code, 0);
+
+  // Reads that nobody waits for are finished before the queue is destroyed
+  for (auto &read : reads)
+  {
+    read.request = queue->Read(read.data.data(), read.offset, read.length);
+  }
+  queue.reset();
+  for (auto &read : reads)
+  {
+    EXPECT_TRUE(read.request->IsDone());
+  }
+}
+
+TEST(IOTests, FileReadQueue)
+{
+  std::vector<uint8_t> fileData(8 << 20);
+  std::mt19937 gen(123);
+  for (auto &value : fileData)
+    value = uint8_t(gen());
+
+  OpenVDS::Error error;
+  OpenVDS::File file;
+  ASSERT_TRUE(file.Open("test_read_queue.bin", true, true, true, error)) << error.string;
+  ASSERT_TRUE(file.Write(fileData.data(), 0, int32_t(fileData.size()), error)) << error.string;
+  file.Flush();
+
+  OpenVDS::FileReadQueue::Type types[] = { OpenVDS::FileReadQueue::Type_Default, OpenVDS::FileReadQueue::Type_IoUring, OpenVDS::FileReadQueue::Type_ThreadPool };
+  for (auto type : types)
+  {
+    std::unique_ptr<OpenVDS::FileReadQueue> queue = OpenVDS::FileReadQueue::Create(file, 16, type);
+    if (type == OpenVDS::FileReadQueue::Type_IoUring && !queue)
+    {
+      fprintf(stderr, "io_uring is not available, skipping the io_uring read queue\n");
+      continue;
+    }
+    ASSERT_TRUE(queue);
+    EXPECT_TRUE(type == OpenVDS::FileReadQueue::Type_Default || queue->GetType() == type);
+    TestFileReadQueue(fileData, std::move(queue));
+  }
+}
@@ -0,0 +1,138 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <IO/IOManager.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "../utils/LocalHttpServer.h"
+
+TEST(IOTests, httpTransferConnectionString)
+{
+  OpenVDS::Error error;
+  std::unique_ptr<OpenVDS::OpenOptions> options(OpenVDS::CreateOpenOptions("http://127.0.0.1/vds", "MaxConcurrentRequests=8;AdaptiveConcurrency=on;MaxConnectionsPerHost=4;Http2Multiplexing=false;TcpKeepAlive=no;ReceiveBufferSize=65536", error));
+  ASSERT_EQ(error.code, 0) << error.string;
+  ASSERT_TRUE(options);
+  EXPECT_EQ(options->maxConcurrentRequests, 8);
+  EXPECT_TRUE(options->adaptiveConcurrency);
+  EXPECT_EQ(options->maxConnectionsPerHost, 4);
+  EXPECT_FALSE(options->http2Multiplexing);
+  EXPECT_FALSE(options->tcpKeepAlive);
+  EXPECT_EQ(options->receiveBufferSize, 65536);
+
+  options.reset(OpenVDS::CreateOpenOptions("http://127.0.0.1/vds", "MaxConcurrentRequests=0", error));
+  EXPECT_NE(error.code, 0);
+
+  options.reset(OpenVDS::CreateOpenOptions("http://127.0.0.1/vds", "AdaptiveConcurrency=maybe", error));
+  EXPECT_NE(error.code, 0);
+}
+
+#ifdef HAVE_LOCAL_HTTP_SERVER
+class DiscardTransfer : public OpenVDS::TransferDownloadHandler
+{
+public:
+  void HandleObjectSize(int64_t size) override {}
+  void HandleObjectLastWriteTime(const std::string &lastWriteTimeISO8601) override {}
+  void HandleMetadata(const std::string& key, const std::string& header) override {}
+  void HandleData(std::vector<uint8_t>&& data) override {}
+  void Completed(const OpenVDS::Request& req, const OpenVDS::Error& error) override {}
+};
+
+static void readObjects(OpenVDS::IOManager *ioManager, int count)
+{
+  auto transfer = std::make_shared<DiscardTransfer>();
+  std::vector<std::shared_ptr<OpenVDS::Request>> requests;
+  requests.reserve(count);
+  for (int i = 0; i < count; i++)
+  {
+    requests.push_back(ioManager->ReadObject(fmt::format("Dimensions_012LOD0/{}", i), transfer));
+  }
+  for (auto &request : requests)
+  {
+    OpenVDS::Error error;
+    ASSERT_TRUE(request->WaitForFinish(error)) << error.string;
+  }
+}
+
+// Returns the highest number of requests the server had in flight while reading the objects of the second round
+static int measureMaxInFlight(LocalHttpServer &server, const OpenVDS::OpenOptions &options, int warmupCount, int count)
+{
+  OpenVDS::Error error;
+  std::unique_ptr<OpenVDS::IOManager> ioManager(OpenVDS::IOManager::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadOnly, error));
+  if (!ioManager)
+    return -1;
+  readObjects(ioManager.get(), warmupCount);
+  server.TakeMaxInFlight();
+  readObjects(ioManager.get(), count);
+  return server.TakeMaxInFlight();
+}
+#endif
+
+TEST(IOTests, httpMaxConcurrentRequests)
+{
+#ifndef HAVE_LOCAL_HTTP_SERVER
+  GTEST_SKIP() << "The local http server is only implemented for POSIX sockets";
+#else
+  LocalHttpServer server(1024, std::chrono::microseconds(2000));
+  ASSERT_GT(server.Port(), 0);
+
+  OpenVDS::HttpOpenOptions options(server.Url());
+  options.maxConcurrentRequests = 4;
+  int maxInFlight = measureMaxInFlight(server, options, 0, 400);
+  if (maxInFlight < 0)
+  {
+    GTEST_SKIP() << "The http IO backend is not available";
+  }
+  EXPECT_LE(maxInFlight, 4);
+  EXPECT_GE(maxInFlight, 2);
+#endif
+}
+
+TEST(IOTests, httpAdaptiveConcurrency)
+{
+#ifndef HAVE_LOCAL_HTTP_SERVER
+  GTEST_SKIP() << "The local http server is only implemented for POSIX sockets";
+#else
+  // A server that can only work on 4 requests at a time gets slower with more requests in flight without getting faster
+  {
+    LocalHttpServer server(1024, std::chrono::microseconds(2000), 4);
+    ASSERT_GT(server.Port(), 0);
+
+    OpenVDS::HttpOpenOptions options(server.Url());
+    options.adaptiveConcurrency = true;
+    int maxInFlight = measureMaxInFlight(server, options, 2000, 1000);
+    if (maxInFlight < 0)
+    {
+      GTEST_SKIP() << "The http IO backend is not available";
+    }
+    EXPECT_LE(maxInFlight, 24);
+  }
+
+  // A server that keeps up gets more requests in flight than the initial limit of 8
+  {
+    LocalHttpServer server(1024, std::chrono::microseconds(5000));
+    ASSERT_GT(server.Port(), 0);
+
+    OpenVDS::HttpOpenOptions options(server.Url());
+    options.adaptiveConcurrency = true;
+    int maxInFlight = measureMaxInFlight(server, options, 2000, 1000);
+    EXPECT_GT(maxInFlight, 12);
+  }
+#endif
+}
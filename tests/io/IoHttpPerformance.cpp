@@ -0,0 +1,116 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <OpenVDS/OpenVDS.h>
+#include <IO/IOManager.h>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "../utils/LocalHttpServer.h"
+
+#ifdef HAVE_LOCAL_HTTP_SERVER
+class TimedTransfer : public OpenVDS::TransferDownloadHandler
+{
+public:
+  TimedTransfer()
+    : m_start(std::chrono::steady_clock::now())
+    , m_size(0)
+  {}
+
+  void HandleObjectSize(int64_t size) override {}
+  void HandleObjectLastWriteTime(const std::string &lastWriteTimeISO8601) override {}
+  void HandleMetadata(const std::string& key, const std::string& header) override {}
+  void HandleData(std::vector<uint8_t>&& data) override
+  {
+    m_size = data.size();
+  }
+  void Completed(const OpenVDS::Request& req, const OpenVDS::Error& error) override
+  {
+    m_error = error;
+    m_end = std::chrono::steady_clock::now();
+  }
+
+  std::chrono::steady_clock::time_point m_start;
+  std::chrono::steady_clock::time_point m_end;
+  size_t m_size;
+  OpenVDS::Error m_error;
+};
+#endif
+
+TEST(IOTests, httpRequestRate)
+{
+#ifndef HAVE_LOCAL_HTTP_SERVER
+  GTEST_SKIP() << "The local http server is only implemented for POSIX sockets";
+#else
+  // Chunk sized like a small compressed brick, requested like the chunks of a full volume read
+  const size_t chunkSize = 16 * 1024;
+  const int requestCount = 20000;
+  const int batchSize = 256;
+
+  LocalHttpServer server(chunkSize);
+  ASSERT_GT(server.Port(), 0);
+
+  OpenVDS::Error error;
+  OpenVDS::HttpOpenOptions options(server.Url());
+  std::unique_ptr<OpenVDS::IOManager> ioManager(OpenVDS::IOManager::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadOnly, error));
+  if (!ioManager)
+  {
+    GTEST_SKIP() << "The http IO backend is not available: " << error.string;
+  }
+
+  std::vector<std::shared_ptr<TimedTransfer>> transfers;
+  std::vector<std::shared_ptr<OpenVDS::Request>> requests;
+  transfers.reserve(requestCount);
+  requests.reserve(requestCount);
+
+  // The requests are issued in batches the size of a typical request job and each batch is waited for before the next one
+  auto start = std::chrono::steady_clock::now();
+  for (int batchStart = 0; batchStart < requestCount; batchStart += batchSize)
+  {
+    int batchEnd = std::min(batchStart + batchSize, requestCount);
+    for (int i = batchStart; i < batchEnd; i++)
+    {
+      transfers.push_back(std::make_shared<TimedTransfer>());
+      requests.push_back(ioManager->ReadObject(fmt::format("Dimensions_012LOD0/{}", i), transfers.back()));
+    }
+    for (int i = batchStart; i < batchEnd; i++)
+    {
+      ASSERT_TRUE(requests[i]->WaitForFinish(error)) << error.string;
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<double> latencies;
+  latencies.reserve(requestCount);
+  for (auto &transfer : transfers)
+  {
+    ASSERT_EQ(transfer->m_error.code, 0) << transfer->m_error.string;
+    ASSERT_EQ(transfer->m_size, chunkSize);
+    latencies.push_back(std::chrono::duration<double, std::milli>(transfer->m_end - transfer->m_start).count());
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  // The latency includes the time spent queued behind the other requests of the batch
+  fmt::print(stderr, "{} requests of {} bytes in {:.3f} s: {:.0f} requests/s over {} connections\n", requestCount, chunkSize, seconds, requestCount / seconds, server.Connections());
+  fmt::print(stderr, "Latency p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms\n", latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back());
+#endif
+}
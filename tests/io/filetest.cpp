@@ -22,7 +22,7 @@
 
 #include "IO/File.h"
 
-#include "../utils/ThreadPool.h"
+#include <VDS/ThreadPool.h>
 
 #ifdef _WIN32
 #undef WIN32_LEAN_AND_MEAN // avoid warnings if defined on command line
@@ -181,12 +181,12 @@ TEST(IOTests, FileIO)
 
     for (const auto& offset : offsets)
     {
-      results.push_back(thread_pool.enqueue([&file, &rand_data](const Offset & offset)
+      results.push_back(thread_pool.Enqueue([&file, &rand_data, offset]()
         {
           OpenVDS::Error error;
           file.Write(&rand_data[offset.offset], offset.offset * sizeof(*rand_data.data()), offset.size * sizeof(*rand_data.data()), error);
           return error;
-        }, offset));
+        }));
     }
 
     for (auto& result_future : results)
@@ -203,7 +203,7 @@ TEST(IOTests, FileIO)
 
     for (const auto& offset : offsets)
     {
-      results.push_back(thread_pool.enqueue([&file, &rand_data](const Offset & offset)
+      results.push_back(thread_pool.Enqueue([&file, &rand_data, offset]()
         {
           OpenVDS::Error error;
           std::vector<uint8_t> vec;
@@ -219,7 +219,7 @@ TEST(IOTests, FileIO)
             error.string = "Compared data is not the same.";
           }
           return error;
-        }, offset));
+        }));
     }
 
     for (auto& result_future : results)
@@ -237,3 +237,37 @@ TEST(IOTests, FileIO)
 
   }
 }
+
+TEST(IOTests, FileViewCopyData)
+{
+  std::vector<uint8_t> data(DATA_SIZE);
+  std::mt19937 gen(123);
+  for (auto &value : data)
+    value = uint8_t(gen());
+
+  OpenVDS::Error error;
+  OpenVDS::File file;
+  ASSERT_TRUE(file.Open("test_fileview_copy.bin", true, true, true, error)) << error.string;
+  ASSERT_TRUE(file.Write(data.data(), 0, int32_t(data.size()), error)) << error.string;
+  file.Flush();
+
+  OpenVDS::FileView *fileView = file.CreateFileView(0, int64_t(data.size()), false, error);
+  ASSERT_TRUE(fileView) << error.string;
+
+  std::vector<uint8_t> copy(data.size());
+  EXPECT_TRUE(OpenVDS::FileView::CopyData(copy.data(), fileView->Pointer(), int64_t(copy.size())));
+  EXPECT_EQ(memcmp(copy.data(), data.data(), data.size()), 0);
+
+#ifndef _WIN32
+  // Pages past the end of a truncated file can't be read (Windows doesn't allow truncating a mapped file)
+  {
+    OpenVDS::File truncatedFile;
+    ASSERT_TRUE(truncatedFile.Open("test_fileview_copy.bin", true, true, true, error)) << error.string;
+    ASSERT_TRUE(truncatedFile.Write(data.data(), 0, 4096, error)) << error.string;
+  }
+  EXPECT_TRUE(OpenVDS::FileView::CopyData(copy.data(), fileView->Pointer(), 4096));
+  EXPECT_FALSE(OpenVDS::FileView::CopyData(copy.data(), static_cast<const uint8_t *>(fileView->Pointer()) + (DATA_SIZE / 2), 4096));
+#endif
+
+  OpenVDS::FileView::RemoveReference(fileView);
+}
@@ -0,0 +1,192 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "../../tools/SEGYExport/SEGYExportPipeline.h"
+#include "../utils/GenerateVDS.h"
+#include "../utils/FacadeIOManager.h"
+#include "../utils/SlowIOManager.h"
+
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/IO/IOManager.h>
+#include <OpenVDS/IO/IOManagerInMemory.h>
+
+#include <chrono>
+#include <cstring>
+
+static const int g_sampleCount = 400;
+static const int g_crosslineCount = 200;
+static const int g_inlineCount = 100;
+
+static bool isLiveTrace(int inlineIndex, int crosslineIndex)
+{
+  return (inlineIndex + crosslineIndex) % 7 != 0;
+}
+
+static void fillTraceHeader(uint8_t *header, int inlineIndex, int crosslineIndex)
+{
+  memset(header, 0, SEGY::TraceHeaderSize);
+  int32_t traceIndex = inlineIndex * g_crosslineCount + crosslineIndex;
+  memcpy(header, &traceIndex, sizeof(traceIndex));
+  header[SEGY::TraceHeaderSize - 1] = uint8_t(inlineIndex);
+}
+
+// Create a VDS with the same channels as SEGYImport creates, so it can be exported as SEG-Y
+static OpenVDS::VDS *generateSEGYLikeVDS(OpenVDS::IOManager *ioManager)
+{
+  OpenVDS::VolumeDataLayoutDescriptor layoutDescriptor(OpenVDS::VolumeDataLayoutDescriptor::BrickSize_64, 0, 0, 4, OpenVDS::VolumeDataLayoutDescriptor::LODLevels_None, OpenVDS::VolumeDataLayoutDescriptor::Options_None);
+
+  std::vector<OpenVDS::VolumeDataAxisDescriptor> axisDescriptors;
+  axisDescriptors.emplace_back(g_sampleCount, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_SAMPLE, "ms", 0.0f, 4.f * (g_sampleCount - 1));
+  axisDescriptors.emplace_back(g_crosslineCount, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_CROSSLINE, "", 1.f, float(g_crosslineCount));
+  axisDescriptors.emplace_back(g_inlineCount, KNOWNMETADATA_SURVEYCOORDINATE_INLINECROSSLINE_AXISNAME_INLINE, "", 1.f, float(g_inlineCount));
+
+  std::vector<OpenVDS::VolumeDataChannelDescriptor> channelDescriptors;
+  channelDescriptors.emplace_back(OpenVDS::VolumeDataChannelDescriptor::Format_R32, OpenVDS::VolumeDataChannelDescriptor::Components_1, AMPLITUDE_ATTRIBUTE_NAME, "", -0.1234f, 0.1234f);
+  channelDescriptors.emplace_back(OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::VolumeDataChannelDescriptor::Components_1, "Trace", "", 0.0f, 1.0f, OpenVDS::VolumeDataMapping::PerTrace, OpenVDS::VolumeDataChannelDescriptor::DiscreteData);
+  channelDescriptors.emplace_back(OpenVDS::VolumeDataChannelDescriptor::Format_U8, OpenVDS::VolumeDataChannelDescriptor::Components_1, "SEGYTraceHeader", "", 0.0f, 255.0f, OpenVDS::VolumeDataMapping::PerTrace, SEGY::TraceHeaderSize, OpenVDS::VolumeDataChannelDescriptor::DiscreteData, 1.0f, 0.0f);
+
+  OpenVDS::MetadataContainer metadataContainer;
+  OpenVDS::Error error;
+  OpenVDS::VDS *vds = OpenVDS::Create(ioManager, layoutDescriptor, axisDescriptors, channelDescriptors, metadataContainer, OpenVDS::CompressionMethod::None, 0.0f, error);
+  if (!vds)
+  {
+    return nullptr;
+  }
+
+  fill3DVDSWithNoise(vds);
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(vds);
+  auto amplitudeAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 0, 8, OpenVDS::VolumeDataAccessManager::AccessMode_ReadOnly);
+  auto traceFlagAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 1, 8, OpenVDS::VolumeDataAccessManager::AccessMode_Create);
+  auto segyTraceHeaderAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, 2, 8, OpenVDS::VolumeDataAccessManager::AccessMode_Create);
+
+  for (int64_t chunk = 0; chunk < amplitudeAccessor->GetChunkCount(); chunk++)
+  {
+    int min[OpenVDS::Dimensionality_Max], max[OpenVDS::Dimensionality_Max];
+    amplitudeAccessor->GetChunkMinMax(chunk, min, max);
+    if (min[0] != 0)
+    {
+      continue;
+    }
+
+    OpenVDS::VolumeDataPage *traceFlagPage = traceFlagAccessor->CreatePage(traceFlagAccessor->GetMappedChunkIndex(chunk));
+    OpenVDS::VolumeDataPage *segyTraceHeaderPage = segyTraceHeaderAccessor->CreatePage(segyTraceHeaderAccessor->GetMappedChunkIndex(chunk));
+
+    int traceFlagPitch[OpenVDS::Dimensionality_Max];
+    int segyTraceHeaderPitch[OpenVDS::Dimensionality_Max];
+    uint8_t *traceFlagBuffer = static_cast<uint8_t *>(traceFlagPage->GetWritableBuffer(traceFlagPitch));
+    uint8_t *segyTraceHeaderBuffer = static_cast<uint8_t *>(segyTraceHeaderPage->GetWritableBuffer(segyTraceHeaderPitch));
+
+    for (int inlineIndex = min[2]; inlineIndex < max[2]; inlineIndex++)
+    {
+      for (int crosslineIndex = min[1]; crosslineIndex < max[1]; crosslineIndex++)
+      {
+        traceFlagBuffer[(inlineIndex - min[2]) * traceFlagPitch[2] + (crosslineIndex - min[1]) * traceFlagPitch[1]] = isLiveTrace(inlineIndex, crosslineIndex);
+        fillTraceHeader(&segyTraceHeaderBuffer[(inlineIndex - min[2]) * segyTraceHeaderPitch[2] + (crosslineIndex - min[1]) * segyTraceHeaderPitch[1]], inlineIndex, crosslineIndex);
+      }
+    }
+
+    traceFlagPage->Release();
+    segyTraceHeaderPage->Release();
+  }
+
+  traceFlagAccessor->Commit();
+  segyTraceHeaderAccessor->Commit();
+  accessManager.DestroyVolumeDataPageAccessor(amplitudeAccessor);
+  accessManager.DestroyVolumeDataPageAccessor(traceFlagAccessor);
+  accessManager.DestroyVolumeDataPageAccessor(segyTraceHeaderAccessor);
+  return vds;
+}
+
+static double runExport(OpenVDS::VolumeDataAccessManager &accessManager, int prefetchLineCount, int writeBufferCount, std::vector<char> &output)
+{
+  SEGYExportPipeline pipeline(accessManager, OpenVDS::Dimensions_012, 2, 1, 2, SEGY::BinaryHeader::DataSampleFormatCode::IBMFloat, SEGY::Endianness::BigEndian, prefetchLineCount, writeBufferCount);
+
+  output.assign(size_t(pipeline.GetLineCount() * pipeline.GetTraceCount() * (SEGY::TraceHeaderSize + g_sampleCount * sizeof(float))), 0);
+  int64_t writtenSize = 0;
+
+  auto write = [&](const void *data, int64_t offset, int32_t size, OpenVDS::Error &error)
+  {
+    memcpy(output.data() + offset, data, size);
+    writtenSize = std::max(writtenSize, offset + size);
+    return true;
+  };
+
+  OpenVDS::Error error;
+  auto start = std::chrono::high_resolution_clock::now();
+  bool success = pipeline.Run(0, write, nullptr, error);
+  auto end = std::chrono::high_resolution_clock::now();
+  EXPECT_TRUE(success) << error.string;
+
+  output.resize(size_t(writtenSize));
+  return std::chrono::duration<double>(end - start).count();
+}
+
+TEST(SEGYExport_performance, pipelinedExport)
+{
+  OpenVDS::InMemoryOpenOptions options;
+  OpenVDS::Error error;
+  std::unique_ptr<OpenVDS::IOManager> inMemory(OpenVDS::IOManagerInMemory::CreateIOManager(options, OpenVDS::IOManager::AccessPattern::ReadWrite, error));
+
+  {
+    std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(generateSEGYLikeVDS(new IOManagerFacadeLight(inMemory.get())), OpenVDS::Close);
+    ASSERT_TRUE(handle);
+  }
+
+  // Add latency to every object read to get closer to what an export from cloud storage sees
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Open(new SlowIOManager(5, inMemory.get()), error), OpenVDS::Close);
+  ASSERT_TRUE(handle) << error.string;
+
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+
+  // Build the expected SEG-Y traces from a single request for the whole volume
+  std::vector<float> amplitude(size_t(g_sampleCount) * g_crosslineCount * g_inlineCount);
+  auto request = accessManager.RequestVolumeSubset<float>(amplitude.data(), amplitude.size() * sizeof(float), OpenVDS::Dimensions_012, 0, 0, { 0, 0, 0 }, { g_sampleCount, g_crosslineCount, g_inlineCount });
+  ASSERT_TRUE(request->WaitForCompletion());
+
+  const int segyTraceSize = SEGY::TraceHeaderSize + g_sampleCount * int(sizeof(float));
+  std::vector<char> expected;
+  for (int inlineIndex = 0; inlineIndex < g_inlineCount; inlineIndex++)
+  {
+    for (int crosslineIndex = 0; crosslineIndex < g_crosslineCount; crosslineIndex++)
+    {
+      if (!isLiveTrace(inlineIndex, crosslineIndex))
+      {
+        continue;
+      }
+      size_t position = expected.size();
+      expected.resize(position + segyTraceSize);
+      fillTraceHeader(reinterpret_cast<uint8_t *>(&expected[position]), inlineIndex, crosslineIndex);
+      SEGY::Ieee2ibm(&expected[position + SEGY::TraceHeaderSize], &amplitude[(size_t(inlineIndex) * g_crosslineCount + crosslineIndex) * g_sampleCount], g_sampleCount);
+    }
+  }
+
+  std::vector<char> sequentialOutput;
+  double sequentialSeconds = runExport(accessManager, 1, 1, sequentialOutput);
+  ASSERT_EQ(sequentialOutput.size(), expected.size());
+  EXPECT_TRUE(sequentialOutput == expected);
+
+  std::vector<char> pipelinedOutput;
+  double pipelinedSeconds = runExport(accessManager, 8, 3, pipelinedOutput);
+  ASSERT_EQ(pipelinedOutput.size(), expected.size());
+  EXPECT_TRUE(pipelinedOutput == expected);
+
+  double megaBytes = expected.size() / (1024.0 * 1024.0);
+  fmt::print(stderr, "SEG-Y export of {:.1f} MB: {:.0f} MB/s with 1 line in flight, {:.0f} MB/s with 8 lines in flight\n", megaBytes, megaBytes / sequentialSeconds, megaBytes / pipelinedSeconds);
+}
@@ -0,0 +1,209 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataAccess.h>
+#include <OpenVDS/VolumeDataLayout.h>
+
+#include <SEGYUtils/SEGY.h>
+
+#include <fmt/format.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static const int g_sampleCount = 100;
+static const int g_offsetCount = 12;
+static const int g_crosslineCount = 40;
+static const int g_inlineCount = 24;
+
+static void writeBigEndian(uint8_t *target, int32_t value, int size)
+{
+  for (int i = 0; i < size; i++)
+  {
+    target[i] = uint8_t(value >> ((size - 1 - i) * 8));
+  }
+}
+
+// Writes binned prestack gathers in IEEE format, the gathers are sorted by offset
+static void generatePrestackSEGY(const std::string &fileName)
+{
+  std::vector<uint8_t> data(SEGY::TextualFileHeaderSize + SEGY::BinaryFileHeaderSize + size_t(g_inlineCount) * g_crosslineCount * g_offsetCount * (SEGY::TraceHeaderSize + g_sampleCount * sizeof(float)));
+  memset(data.data(), 0x40, SEGY::TextualFileHeaderSize);
+
+  uint8_t *binaryHeader = data.data() + SEGY::TextualFileHeaderSize;
+  writeBigEndian(binaryHeader + 16, 4000, 2);
+  writeBigEndian(binaryHeader + 20, g_sampleCount, 2);
+  writeBigEndian(binaryHeader + 24, int32_t(SEGY::BinaryHeader::DataSampleFormatCode::IEEEFloat), 2);
+
+  uint8_t *trace = binaryHeader + SEGY::BinaryFileHeaderSize;
+  for (int inlineIndex = 0; inlineIndex < g_inlineCount; inlineIndex++)
+  {
+    for (int crosslineIndex = 0; crosslineIndex < g_crosslineCount; crosslineIndex++)
+    {
+      for (int offsetIndex = 0; offsetIndex < g_offsetCount; offsetIndex++)
+      {
+        writeBigEndian(trace + SEGY::TraceHeader::OffsetHeaderField.byteLocation - 1, 100 + offsetIndex * 50, 4);
+        writeBigEndian(trace + 70, -100, 2);
+        writeBigEndian(trace + 114, g_sampleCount, 2);
+        writeBigEndian(trace + 116, 4000, 2);
+        writeBigEndian(trace + 180, (1000 + crosslineIndex * 25) * 100, 4);
+        writeBigEndian(trace + 184, (2000 + inlineIndex * 25) * 100, 4);
+        writeBigEndian(trace + SEGY::TraceHeader::InlineNumberHeaderField.byteLocation - 1, 100 + inlineIndex, 4);
+        writeBigEndian(trace + SEGY::TraceHeader::CrosslineNumberHeaderField.byteLocation - 1, 500 + crosslineIndex, 4);
+
+        uint8_t *samples = trace + SEGY::TraceHeaderSize;
+        for (int sample = 0; sample < g_sampleCount; sample++)
+        {
+          float value = std::sin(sample * 0.05f + offsetIndex * 0.1f) + 0.01f * (inlineIndex + crosslineIndex);
+          int32_t bits;
+          memcpy(&bits, &value, sizeof(bits));
+          writeBigEndian(samples + sample * sizeof(float), bits, 4);
+        }
+        trace += SEGY::TraceHeaderSize + g_sampleCount * sizeof(float);
+      }
+    }
+  }
+
+  FILE *file = fopen(fileName.c_str(), "wb");
+  ASSERT_TRUE(file);
+  EXPECT_EQ(fwrite(data.data(), 1, data.size(), file), data.size());
+  fclose(file);
+}
+
+static void runSEGYImport(const std::string &segyFileName, const std::string &vdsFileName, const char *threadCount)
+{
+#ifdef _WIN32
+  _putenv_s("OMP_NUM_THREADS", threadCount);
+#else
+  setenv("OMP_NUM_THREADS", threadCount, 1);
+#endif
+  remove(vdsFileName.c_str());
+  std::string outputFileName = vdsFileName + ".log";
+  std::string command = fmt::format("\"{}\" --prestack --brick-size 32 --vdsfile {} {} > {}", SEGYIMPORT_EXECUTABLE, vdsFileName, segyFileName, outputFileName);
+  int result = std::system(command.c_str());
+
+  std::ifstream outputFile(outputFileName);
+  std::string output((std::istreambuf_iterator<char>(outputFile)), std::istreambuf_iterator<char>());
+  outputFile.close();
+  remove(outputFileName.c_str());
+
+  ASSERT_EQ(result, 0) << command << "\n" << output;
+  EXPECT_NE(output.find(fmt::format("using {} threads", threadCount)), std::string::npos) << output;
+}
+
+static int formatSize(OpenVDS::VolumeDataChannelDescriptor::Format format)
+{
+  switch (format)
+  {
+  case OpenVDS::VolumeDataChannelDescriptor::Format_R64:
+  case OpenVDS::VolumeDataChannelDescriptor::Format_U64:
+    return 8;
+  case OpenVDS::VolumeDataChannelDescriptor::Format_R32:
+  case OpenVDS::VolumeDataChannelDescriptor::Format_U32:
+    return 4;
+  case OpenVDS::VolumeDataChannelDescriptor::Format_U16:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+static void compareChannel(OpenVDS::VolumeDataAccessManager &accessManager, OpenVDS::VolumeDataAccessManager &referenceAccessManager, int channel)
+{
+  auto accessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, channel, 8, OpenVDS::VolumeDataAccessManager::AccessMode_ReadOnly);
+  auto referenceAccessor = referenceAccessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, channel, 8, OpenVDS::VolumeDataAccessManager::AccessMode_ReadOnly);
+  ASSERT_EQ(accessor->GetChunkCount(), referenceAccessor->GetChunkCount());
+
+  int elementSize = formatSize(accessManager.GetVolumeDataLayout()->GetChannelFormat(channel));
+
+  for (int64_t chunk = 0; chunk < accessor->GetChunkCount(); chunk++)
+  {
+    OpenVDS::VolumeDataPage *page = accessor->ReadPage(chunk);
+    OpenVDS::VolumeDataPage *referencePage = referenceAccessor->ReadPage(chunk);
+    ASSERT_TRUE(page && referencePage);
+
+    int min[OpenVDS::Dimensionality_Max], max[OpenVDS::Dimensionality_Max];
+    page->GetMinMax(min, max);
+    int pitch[OpenVDS::Dimensionality_Max], referencePitch[OpenVDS::Dimensionality_Max];
+    const void *buffer = page->GetBuffer(pitch);
+    const void *referenceBuffer = referencePage->GetBuffer(referencePitch);
+    ASSERT_EQ(memcmp(pitch, referencePitch, sizeof(pitch)), 0);
+
+    size_t size = size_t(pitch[2]) * (max[2] - min[2]) * elementSize;
+    EXPECT_EQ(memcmp(buffer, referenceBuffer, size), 0) << "channel " << channel << ", chunk " << chunk;
+
+    page->Release();
+    referencePage->Release();
+  }
+}
+
+// Importing prestack gathers (with an offset channel) with several worker threads must give the same VDS as a serial import
+TEST(SEGYImport, concurrentPrestackImport)
+{
+  const std::string segyFileName = "test_prestack_import.segy";
+  ASSERT_NO_FATAL_FAILURE(generatePrestackSEGY(segyFileName));
+
+  ASSERT_NO_FATAL_FAILURE(runSEGYImport(segyFileName, "test_prestack_import_serial.vds", "1"));
+  ASSERT_NO_FATAL_FAILURE(runSEGYImport(segyFileName, "test_prestack_import_concurrent.vds", "4"));
+
+  OpenVDS::Error error;
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> reference(OpenVDS::Open(OpenVDS::VDSFileOpenOptions("test_prestack_import_serial.vds"), error), &OpenVDS::Close);
+  ASSERT_TRUE(reference) << error.string;
+  std::unique_ptr<OpenVDS::VDS, decltype(&OpenVDS::Close)> handle(OpenVDS::Open(OpenVDS::VDSFileOpenOptions("test_prestack_import_concurrent.vds"), error), &OpenVDS::Close);
+  ASSERT_TRUE(handle) << error.string;
+
+  OpenVDS::VolumeDataAccessManager referenceAccessManager = OpenVDS::GetAccessManager(reference.get());
+  OpenVDS::VolumeDataAccessManager accessManager = OpenVDS::GetAccessManager(handle.get());
+  OpenVDS::VolumeDataLayout const *layout = accessManager.GetVolumeDataLayout();
+
+  ASSERT_EQ(layout->GetDimensionality(), 4);
+  EXPECT_EQ(layout->GetDimensionNumSamples(1), g_offsetCount);
+  ASSERT_EQ(layout->GetChannelCount(), referenceAccessManager.GetVolumeDataLayout()->GetChannelCount());
+  ASSERT_TRUE(layout->IsChannelAvailable("Offset"));
+
+  for (int channel = 0; channel < layout->GetChannelCount(); channel++)
+  {
+    ASSERT_NO_FATAL_FAILURE(compareChannel(accessManager, referenceAccessManager, channel));
+  }
+
+  // The offset channel holds the offset of each trace in the gathers
+  auto offsetAccessor = accessManager.CreateVolumeDataPageAccessor(OpenVDS::Dimensions_012, 0, layout->GetChannelIndex("Offset"), 8, OpenVDS::VolumeDataAccessManager::AccessMode_ReadOnly);
+  OpenVDS::VolumeDataPage *offsetPage = offsetAccessor->ReadPage(0);
+  ASSERT_TRUE(offsetPage);
+  int offsetPitch[OpenVDS::Dimensionality_Max];
+  const float *offsets = static_cast<const float *>(offsetPage->GetBuffer(offsetPitch));
+  for (int offsetIndex = 0; offsetIndex < g_offsetCount; offsetIndex++)
+  {
+    EXPECT_EQ(offsets[offsetIndex * offsetPitch[1]], float(100 + offsetIndex * 50));
+  }
+  offsetPage->Release();
+
+  handle.reset();
+  reference.reset();
+  remove("test_prestack_import_serial.vds");
+  remove("test_prestack_import_concurrent.vds");
+  remove(segyFileName.c_str());
+}
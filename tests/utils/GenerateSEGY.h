@@ -0,0 +1,154 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef GENERATESEGY_H
+#define GENERATESEGY_H
+
+#include <SEGYUtils/SEGY.h>
+#include <OpenVDS/IO/IOManager.h>
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static void writeSEGYHeaderField(uint8_t *header, SEGY::HeaderField const &headerField, int value)
+{
+  // NOTE: SEG-Y byte locations start at 1
+  uint8_t *field = header + headerField.byteLocation - 1;
+  if (headerField.fieldWidth == SEGY::FieldWidth::FourByte)
+  {
+    field[0] = uint8_t(value >> 24); field[1] = uint8_t(value >> 16); field[2] = uint8_t(value >> 8); field[3] = uint8_t(value);
+  }
+  else
+  {
+    field[0] = uint8_t(value >> 8); field[1] = uint8_t(value);
+  }
+}
+
+// Generate a big-endian IEEE float SEG-Y file in memory; traceKeys gives the inline and crossline numbers of each trace
+static std::vector<uint8_t> generateSEGY(int64_t traceCount, int sampleCount, std::function<void(int64_t trace, int &inlineNumber, int &crosslineNumber)> const &traceKeys)
+{
+  const int64_t traceByteSize = SEGY::TraceHeaderSize + int64_t(sampleCount) * 4;
+  std::vector<uint8_t> data(SEGY::TextualFileHeaderSize + SEGY::BinaryFileHeaderSize + traceCount * traceByteSize, 0);
+
+  uint8_t *binaryHeader = data.data() + SEGY::TextualFileHeaderSize;
+  writeSEGYHeaderField(binaryHeader, SEGY::BinaryHeader::SampleIntervalHeaderField, 4000);
+  writeSEGYHeaderField(binaryHeader, SEGY::BinaryHeader::NumSamplesHeaderField, sampleCount);
+  writeSEGYHeaderField(binaryHeader, SEGY::BinaryHeader::DataSampleFormatCodeHeaderField, int(SEGY::BinaryHeader::DataSampleFormatCode::IEEEFloat));
+
+  for (int64_t trace = 0; trace < traceCount; trace++)
+  {
+    uint8_t *traceHeader = data.data() + SEGY::TextualFileHeaderSize + SEGY::BinaryFileHeaderSize + trace * traceByteSize;
+    int inlineNumber, crosslineNumber;
+    traceKeys(trace, inlineNumber, crosslineNumber);
+    writeSEGYHeaderField(traceHeader, SEGY::TraceHeader::InlineNumberHeaderField, inlineNumber);
+    writeSEGYHeaderField(traceHeader, SEGY::TraceHeader::CrosslineNumberHeaderField, crosslineNumber);
+    writeSEGYHeaderField(traceHeader, SEGY::TraceHeader::CoordinateScaleHeaderField, -100);
+    writeSEGYHeaderField(traceHeader, SEGY::TraceHeader::EnsembleXCoordinateHeaderField, crosslineNumber * 2500);
+    writeSEGYHeaderField(traceHeader, SEGY::TraceHeader::EnsembleYCoordinateHeaderField, inlineNumber * 2500);
+    writeSEGYHeaderField(traceHeader, SEGY::TraceHeader::NumSamplesHeaderField, sampleCount);
+  }
+
+  return data;
+}
+
+// In-memory objects, with a fixed latency for each read to simulate cloud storage
+struct SEGYObjectStore
+{
+  std::map<std::string, std::vector<uint8_t>> m_objects;
+  int m_delayMs;
+  std::atomic<int64_t> m_readCount;
+
+  SEGYObjectStore(int delayMs = 0) : m_delayMs(delayMs), m_readCount(0) {}
+};
+
+// An IOManager serving byte ranges of the objects in a SEGYObjectStore (each DataProvider owns its IOManager)
+class SEGYObjectIOManager : public OpenVDS::IOManager
+{
+  class CompletedRequest : public OpenVDS::Request
+  {
+  public:
+    CompletedRequest(const std::string &objectName, OpenVDS::Error const &error) : OpenVDS::Request(objectName), m_error(error) {}
+    bool WaitForFinish(OpenVDS::Error &error) override { error = m_error; return m_error.code == 0; }
+    void Cancel() override {}
+  private:
+    OpenVDS::Error m_error;
+  };
+
+public:
+  SEGYObjectIOManager(std::shared_ptr<SEGYObjectStore> store)
+    : IOManager(OpenVDS::OpenOptions::InMemory)
+    , m_store(store)
+  {}
+
+  std::shared_ptr<OpenVDS::Request> ReadObjectInfo(const std::string &objectName, std::shared_ptr<OpenVDS::TransferDownloadHandler> handler) override
+  {
+    return Read(objectName, handler, false, OpenVDS::IORange());
+  }
+
+  std::shared_ptr<OpenVDS::Request> ReadObject(const std::string &objectName, std::shared_ptr<OpenVDS::TransferDownloadHandler> handler, const OpenVDS::IORange &range = OpenVDS::IORange()) override
+  {
+    return Read(objectName, handler, true, range);
+  }
+
+  std::shared_ptr<OpenVDS::Request> WriteObject(const std::string &objectName, const std::string &contentDispostionFilename, const std::string &contentType, const std::vector<std::pair<std::string, std::string>> &metadataHeader, std::shared_ptr<std::vector<uint8_t>> data, std::function<void(const OpenVDS::Request &request, const OpenVDS::Error &error)> completedCallback = nullptr) override
+  {
+    OpenVDS::Error error;
+    error.code = -1;
+    error.string = "SEGYObjectIOManager is read-only";
+    return std::make_shared<CompletedRequest>(objectName, error);
+  }
+
+private:
+  std::shared_ptr<OpenVDS::Request> Read(const std::string &objectName, std::shared_ptr<OpenVDS::TransferDownloadHandler> handler, bool isReadData, OpenVDS::IORange const &range)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(m_store->m_delayMs));
+    m_store->m_readCount++;
+
+    OpenVDS::Error error;
+    auto it = m_store->m_objects.find(objectName);
+    if (it == m_store->m_objects.end())
+    {
+      error.code = 404;
+      error.string = "Object: " + objectName + " not found.";
+    }
+    else
+    {
+      std::vector<uint8_t> const &object = it->second;
+      handler->HandleObjectSize(int64_t(object.size()));
+      if (isReadData)
+      {
+        size_t start = size_t(std::min(range.start, int64_t(object.size())));
+        size_t end = range.end ? size_t(std::min(range.end, int64_t(object.size()))) : object.size();
+        handler->HandleData(std::vector<uint8_t>(object.begin() + start, object.begin() + end));
+      }
+    }
+
+    auto request = std::make_shared<CompletedRequest>(objectName, error);
+    handler->Completed(*request, error);
+    return request;
+  }
+
+  std::shared_ptr<SEGYObjectStore> m_store;
+};
+
+#endif //GENERATESEGY_H
@@ -0,0 +1,191 @@
+/****************************************************************************
+** Copyright 2020 The Open Group
+** Copyright 2020 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef LOCALHTTPSERVER_H
+#define LOCALHTTPSERVER_H
+
+#ifndef _WIN32
+#include <fmt/format.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define HAVE_LOCAL_HTTP_SERVER 1
+
+// Minimal HTTP/1.1 server with keep-alive that answers every request with the same body.
+// Each response takes serviceTime, and at most capacity requests are serviced at the same
+// time (0 means no limit), which makes it possible to simulate a saturated server.
+class LocalHttpServer
+{
+public:
+  LocalHttpServer(size_t bodySize, std::chrono::microseconds serviceTime = std::chrono::microseconds(0), int capacity = 0)
+    : m_body(bodySize, 'x')
+    , m_serviceTime(serviceTime)
+    , m_capacity(capacity)
+    , m_listenSocket(-1)
+    , m_port(0)
+    , m_stop(false)
+    , m_inService(0)
+    , m_inFlight(0)
+    , m_maxInFlight(0)
+    , m_acceptedConnections(0)
+  {
+    m_listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenSocket < 0)
+      return;
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+    if (bind(m_listenSocket, reinterpret_cast<sockaddr *>(&address), addressLength) != 0 ||
+        listen(m_listenSocket, 128) != 0 ||
+        getsockname(m_listenSocket, reinterpret_cast<sockaddr *>(&address), &addressLength) != 0)
+    {
+      close(m_listenSocket);
+      m_listenSocket = -1;
+      return;
+    }
+    m_port = ntohs(address.sin_port);
+    m_acceptThread = std::thread([this] { Accept(); });
+  }
+
+  ~LocalHttpServer()
+  {
+    m_stop = true;
+    if (m_listenSocket >= 0)
+    {
+      shutdown(m_listenSocket, SHUT_RDWR);
+      close(m_listenSocket);
+    }
+    if (m_acceptThread.joinable())
+      m_acceptThread.join();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (int connection : m_connections)
+      shutdown(connection, SHUT_RDWR);
+    lock.unlock();
+    for (auto &thread : m_connectionThreads)
+      thread.join();
+  }
+
+  int Port() const { return m_port; }
+  std::string Url() const { return fmt::format("http://127.0.0.1:{}/vds", m_port); }
+
+  // The number of connections accepted so far
+  int Connections() const { return m_acceptedConnections; }
+
+  // The highest number of requests received but not yet answered since the last call
+  int TakeMaxInFlight()
+  {
+    return m_maxInFlight.exchange(m_inFlight);
+  }
+
+private:
+  void Accept()
+  {
+    while (!m_stop)
+    {
+      int connection = accept(m_listenSocket, nullptr, nullptr);
+      if (connection < 0)
+        return;
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_acceptedConnections++;
+      m_connections.push_back(connection);
+      m_connectionThreads.emplace_back([this, connection] { Serve(connection); });
+    }
+  }
+
+  void ServeRequest()
+  {
+    int inFlight = ++m_inFlight;
+    int maxInFlight = m_maxInFlight;
+    while (inFlight > maxInFlight && !m_maxInFlight.compare_exchange_weak(maxInFlight, inFlight))
+    {
+    }
+
+    if (m_capacity > 0)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_serviceCondition.wait(lock, [this] { return m_inService < m_capacity; });
+      m_inService++;
+    }
+    if (m_serviceTime.count() > 0)
+      std::this_thread::sleep_for(m_serviceTime);
+    if (m_capacity > 0)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_inService--;
+      m_serviceCondition.notify_one();
+    }
+  }
+
+  void Serve(int connection)
+  {
+    std::string header = fmt::format("HTTP/1.1 200 OK\r\nContent-Length: {}\r\nContent-Type: application/octet-stream\r\n\r\n", m_body.size());
+    std::string response = header + m_body;
+    std::string received;
+    char buffer[4096];
+    bool connected = true;
+    while (connected)
+    {
+      ssize_t size = recv(connection, buffer, sizeof(buffer), 0);
+      if (size <= 0)
+        break;
+      received.append(buffer, size_t(size));
+      size_t end;
+      while (connected && (end = received.find("\r\n\r\n")) != std::string::npos)
+      {
+        received.erase(0, end + 4);
+        ServeRequest();
+        connected = send(connection, response.data(), response.size(), MSG_NOSIGNAL) == ssize_t(response.size());
+        m_inFlight--;
+      }
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_connections.erase(std::find(m_connections.begin(), m_connections.end(), connection));
+    close(connection);
+  }
+
+  std::string m_body;
+  std::chrono::microseconds m_serviceTime;
+  int m_capacity;
+  int m_listenSocket;
+  int m_port;
+  std::atomic<bool> m_stop;
+  std::thread m_acceptThread;
+  std::mutex m_mutex;
+  std::condition_variable m_serviceCondition;
+  int m_inService;
+  std::atomic<int> m_inFlight;
+  std::atomic<int> m_maxInFlight;
+  std::atomic<int> m_acceptedConnections;
+  std::vector<int> m_connections;
+  std::vector<std::thread> m_connectionThreads;
+};
+#endif
+
+#endif //LOCALHTTPSERVER_H
@@ -17,6 +17,7 @@
 
 #include <SEGYUtils/SEGY.h>
 #include "IO/File.h"
+#include "SEGYExportPipeline.h"
 
 #include <OpenVDS/OpenVDS.h>
 #include <OpenVDS/VolumeDataAccess.h>
@@ -45,6 +46,7 @@ main(int argc, char *argv[])
   std::string connection;
   std::string persistentID;
   std::string fileName;
+  int prefetchLineCount = 4;
   bool jsonOutput = false;
   bool help = false;
   bool version = false;
@@ -54,6 +56,8 @@ main(int argc, char *argv[])
   options.add_option("", "", "vdsfile", "Input VDS file name.", cxxopts::value<std::string>(url), "<string>");
   options.add_option("", "", "persistentID", "A globally unique ID for the VDS, usually an 8-digit hexadecimal number.", cxxopts::value<std::string>(persistentID), "<ID>");
 
+  options.add_option("", "", "prefetch-lines", "Number of lines to request ahead of the line being converted (default 4).", cxxopts::value<int>(prefetchLineCount), "<value>");
+
   options.add_option("", "", "json-output", "Enable json output.", cxxopts::value<bool>(jsonOutput), "");
   options.add_option("", "h", "help", "Print this help information", cxxopts::value<bool>(help), "");
   options.add_option("", "", "version", "Print version information.", cxxopts::value<bool>(version), "");
@@ -314,8 +318,6 @@ main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  int lineCount = volumeDataLayout->GetDimensionNumSamples(outerDimension);
-
   // Find which dimension to loop over in case the data has been transposed on import (i.e. crossline-sorted binned data)
   const char *primaryKey = volumeDataLayout->GetMetadataString("SEGY", "PrimaryKey");
   for(int dimension = 1; dimension < dimensionality; dimension++)
@@ -326,29 +328,10 @@ main(int argc, char *argv[])
     }
   }
 
-  // Count the total number of traces for each request
-  int64_t traceCount = 1;
-  for(int dimension = 1; dimension < dimensionality; dimension++)
-  {
-    if(dimension != outerDimension)
-    {
-      traceCount *= volumeDataLayout->GetDimensionNumSamples(dimension);
-    }
-  }
-
-  const int sampleFormatSize = 4;
-  const int sampleCount = volumeDataLayout->GetDimensionNumSamples(0);
-  const int traceDataSize = sampleCount * sampleFormatSize;
-
-  std::unique_ptr<char[]> data(new char[traceCount * traceDataSize]);
-  std::unique_ptr<char[]> traceFlag(new char[traceCount]);
-  std::unique_ptr<char[]> segyTraceHeader(new char[traceCount * SEGY::TraceHeaderSize]);
-
-  int64_t
-    offset = SEGY::TextualFileHeaderSize + SEGY::BinaryFileHeaderSize;
+  SEGYExportPipeline pipeline(accessManager, dimensionGroup, outerDimension, traceFlagChannel, segyTraceHeaderChannel, dataSampleFormatCode, dataEndianness, prefetchLineCount);
 
   int percentage = -1;
-  for(int line = 0; line < lineCount; line++)
+  auto progress = [&](int line, int lineCount)
   {
     int new_percentage = int(line / double(lineCount) * 100);
     if (!jsonOutput && percentage != new_percentage)
@@ -357,92 +340,17 @@ main(int argc, char *argv[])
       fmt::print(stdout, "\33[2K\r {:3}% Done. ", percentage);
       fflush(stdout);
     }
-    int min[OpenVDS::Dimensionality_Max] = {},
-        max[OpenVDS::Dimensionality_Max] = {};
-
-    for(int dimension = 0; dimension < outerDimension; dimension++)
-    {
-      max[dimension] = volumeDataLayout->GetDimensionNumSamples(dimension);
-    }
-
-    min[outerDimension] = line;
-    max[outerDimension] = line + 1;
-
-    auto dataRequest = accessManager.RequestVolumeSubset((void *)data.get(), traceCount * traceDataSize, dimensionGroup, 0, 0, min, max, OpenVDS::VolumeDataChannelDescriptor::Format_R32);
-
-    max[0] = 1;
-    auto traceFlagRequest = accessManager.RequestVolumeSubset((void *)traceFlag.get(), traceCount, dimensionGroup, 0, traceFlagChannel, min, max, OpenVDS::VolumeDataChannelDescriptor::Format_U8);
-
-    max[0] = 240;
-    auto segyTraceHaderRequest = accessManager.RequestVolumeSubset((void *)segyTraceHeader.get(), traceCount * SEGY::TraceHeaderSize, dimensionGroup, 0, segyTraceHeaderChannel, min, max, OpenVDS::VolumeDataChannelDescriptor::Format_U8);
-
-    // Need to queue the writing on another thread to get max. performance
-    if (!dataRequest->WaitForCompletion())
-    {
-      int errorCode;
-      const char* errorString;
-      accessManager.GetCurrentDownloadError(&errorCode, &errorString);
-      OpenVDS::printError(jsonOutput, "Error in data request", errorString, fmt::format("{}", errorCode));
-      assert(dataRequest->IsCanceled());
-      exit(1);
-    }
-    if (!traceFlagRequest->WaitForCompletion())
-    {
-      int errorCode;
-      const char* errorString;
-      accessManager.GetCurrentDownloadError(&errorCode, &errorString);
-      OpenVDS::printError(jsonOutput, "Error in traceFlag request", errorString, fmt::format("{}", errorCode));
-      assert(traceFlagRequest->IsCanceled());
-      exit(1);
-    }
-    if (!segyTraceHaderRequest->WaitForCompletion())
-    {
-      int errorCode;
-      const char* errorString;
-      accessManager.GetCurrentDownloadError(&errorCode, &errorString);
-      OpenVDS::printError(jsonOutput, "Error in segyTraceHeader request", errorString, fmt::format("{}", errorCode));
-      assert(segyTraceHaderRequest->IsCanceled());
-      exit(1);
-    }
+  };
 
-    std::unique_ptr<char[]> writeBuffer(new char[traceCount * (traceDataSize + SEGY::TraceHeaderSize)]);
-    int activeTraceCount = 0;
-
-    for(int trace = 0; trace < traceCount; trace++)
-    {
-      if(traceFlag[trace])
-      {
-        // Copy trace header
-        memcpy(writeBuffer.get() + activeTraceCount * (traceDataSize + SEGY::TraceHeaderSize), segyTraceHeader.get() + trace * SEGY::TraceHeaderSize, SEGY::TraceHeaderSize);
-
-        // Convert trace data
-        if(dataSampleFormatCode == SEGY::BinaryHeader::DataSampleFormatCode::IBMFloat)
-        {
-          SEGY::Ieee2ibm(writeBuffer.get() + activeTraceCount * (traceDataSize + SEGY::TraceHeaderSize) + SEGY::TraceHeaderSize, data.get() + trace * traceDataSize, sampleCount);
-        }
-        else if(dataSampleFormatCode == SEGY::BinaryHeader::DataSampleFormatCode::IEEEFloat)
-        {
-          if(dataEndianness == SEGY::Endianness::BigEndian)
-          {
-            SEGY::ConvertToEndianness<SEGY::Endianness::BigEndian>(writeBuffer.get() + activeTraceCount * (traceDataSize + SEGY::TraceHeaderSize) + SEGY::TraceHeaderSize, reinterpret_cast<float *>(data.get() + trace * traceDataSize), sampleCount);
-          }
-          else
-          {
-            SEGY::ConvertToEndianness<SEGY::Endianness::LittleEndian>(writeBuffer.get() + activeTraceCount * (traceDataSize + SEGY::TraceHeaderSize) + SEGY::TraceHeaderSize, reinterpret_cast<float *>(data.get() + trace * traceDataSize), sampleCount);
-          }
-        }
-
-        activeTraceCount++;
-      }
-    }
+  auto write = [&file](const void *data, int64_t offset, int32_t size, OpenVDS::Error &error)
+  {
+    return file.Write(data, offset, size, error);
+  };
 
-    file.Write(writeBuffer.get(), offset, activeTraceCount * (traceDataSize + SEGY::TraceHeaderSize), error);
-    if(error.code != 0)
-    {
-      OpenVDS::printError(jsonOutput, "Error writing SEG-Y traces to file", fileName);
-      return EXIT_FAILURE;
-    }
-    offset += activeTraceCount * (traceDataSize + SEGY::TraceHeaderSize);
+  if(!pipeline.Run(SEGY::TextualFileHeaderSize + SEGY::BinaryFileHeaderSize, write, progress, error))
+  {
+    OpenVDS::printError(jsonOutput, "SEGY", "Error exporting SEG-Y traces to file", fileName, error.string);
+    return EXIT_FAILURE;
   }
   if (!jsonOutput)
     fmt::print(stdout, "\33[2K\r 100% Done.\n", percentage);
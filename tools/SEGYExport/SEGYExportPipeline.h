@@ -0,0 +1,331 @@
+/****************************************************************************
+** Copyright 2021 The Open Group
+** Copyright 2021 Bluware, Inc.
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+****************************************************************************/
+
+#ifndef SEGYEXPORT_PIPELINE_H
+#define SEGYEXPORT_PIPELINE_H
+
+#include <SEGYUtils/SEGY.h>
+
+#include <OpenVDS/OpenVDS.h>
+#include <OpenVDS/VolumeDataAccessManager.h>
+#include <OpenVDS/VolumeDataLayout.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Exports the lines of a VDS as SEG-Y traces with three overlapping stages:
+// the volume subset requests for the next lines are kept in flight while the
+// current line is converted (in parallel over the traces) and the previous
+// lines are written by a dedicated writer thread. Both the request buffers and
+// the write buffers are recycled, so the memory used is bounded by the number
+// of prefetched lines and write buffers.
+class SEGYExportPipeline
+{
+public:
+  typedef std::function<bool(const void *data, int64_t offset, int32_t size, OpenVDS::Error &error)> WriteFunction;
+  typedef std::function<void(int line, int lineCount)> ProgressFunction;
+
+private:
+  struct LineRequest
+  {
+    std::vector<char> m_data;
+    std::vector<char> m_traceFlag;
+    std::vector<char> m_segyTraceHeader;
+
+    std::shared_ptr<OpenVDS::VolumeDataRequest> m_dataRequest;
+    std::shared_ptr<OpenVDS::VolumeDataRequest> m_traceFlagRequest;
+    std::shared_ptr<OpenVDS::VolumeDataRequest> m_segyTraceHeaderRequest;
+  };
+
+  struct WriteBuffer
+  {
+    std::vector<char> m_data;
+    int64_t           m_offset;
+    int32_t           m_size;
+  };
+
+  OpenVDS::VolumeDataAccessManager &m_accessManager;
+  OpenVDS::VolumeDataLayout const *m_layout;
+  OpenVDS::DimensionsND m_dimensionGroup;
+  int                   m_outerDimension;
+  int                   m_traceFlagChannel;
+  int                   m_segyTraceHeaderChannel;
+  SEGY::BinaryHeader::DataSampleFormatCode
+                        m_dataSampleFormatCode;
+  SEGY::Endianness      m_dataEndianness;
+  int                   m_prefetchLineCount;
+  int                   m_writeBufferCount;
+
+  int                   m_sampleCount;
+  int64_t               m_traceCount;
+
+  int TraceDataSize() const { return m_sampleCount * int(sizeof(float)); }
+
+  void IssueRequests(LineRequest &lineRequest, int line)
+  {
+    int min[OpenVDS::Dimensionality_Max] = {},
+        max[OpenVDS::Dimensionality_Max] = {};
+
+    for(int dimension = 0; dimension < m_layout->GetDimensionality(); dimension++)
+    {
+      max[dimension] = m_layout->GetDimensionNumSamples(dimension);
+    }
+
+    min[m_outerDimension] = line;
+    max[m_outerDimension] = line + 1;
+
+    lineRequest.m_dataRequest = m_accessManager.RequestVolumeSubset((void *)lineRequest.m_data.data(), int64_t(lineRequest.m_data.size()), m_dimensionGroup, 0, 0, min, max, OpenVDS::VolumeDataChannelDescriptor::Format_R32);
+
+    max[0] = 1;
+    lineRequest.m_traceFlagRequest = m_accessManager.RequestVolumeSubset((void *)lineRequest.m_traceFlag.data(), int64_t(lineRequest.m_traceFlag.size()), m_dimensionGroup, 0, m_traceFlagChannel, min, max, OpenVDS::VolumeDataChannelDescriptor::Format_U8);
+
+    max[0] = SEGY::TraceHeaderSize;
+    lineRequest.m_segyTraceHeaderRequest = m_accessManager.RequestVolumeSubset((void *)lineRequest.m_segyTraceHeader.data(), int64_t(lineRequest.m_segyTraceHeader.size()), m_dimensionGroup, 0, m_segyTraceHeaderChannel, min, max, OpenVDS::VolumeDataChannelDescriptor::Format_U8);
+  }
+
+  bool WaitForRequest(OpenVDS::VolumeDataRequest &request, const char *requestName, OpenVDS::Error &error)
+  {
+    if(request.WaitForCompletion())
+    {
+      return true;
+    }
+
+    int errorCode = 0;
+    const char *errorString = "";
+    m_accessManager.GetCurrentDownloadError(&errorCode, &errorString);
+    error.code = errorCode ? errorCode : -1;
+    error.string = fmt::format("Error in {} request: {}", requestName, errorString);
+    return false;
+  }
+
+  void ConvertTrace(char *target, const char *segyTraceHeader, const char *data) const
+  {
+    memcpy(target, segyTraceHeader, SEGY::TraceHeaderSize);
+    target += SEGY::TraceHeaderSize;
+
+    if(m_dataSampleFormatCode == SEGY::BinaryHeader::DataSampleFormatCode::IBMFloat)
+    {
+      SEGY::Ieee2ibm(target, data, m_sampleCount);
+    }
+    else if(m_dataEndianness == SEGY::Endianness::BigEndian)
+    {
+      SEGY::ByteSwap32(target, data, m_sampleCount);
+    }
+    else
+    {
+      memcpy(target, data, size_t(m_sampleCount) * sizeof(float));
+    }
+  }
+
+public:
+  SEGYExportPipeline(OpenVDS::VolumeDataAccessManager &accessManager, OpenVDS::DimensionsND dimensionGroup, int outerDimension, int traceFlagChannel, int segyTraceHeaderChannel, SEGY::BinaryHeader::DataSampleFormatCode dataSampleFormatCode, SEGY::Endianness dataEndianness, int prefetchLineCount = 4, int writeBufferCount = 2)
+    : m_accessManager(accessManager)
+    , m_layout(accessManager.GetVolumeDataLayout())
+    , m_dimensionGroup(dimensionGroup)
+    , m_outerDimension(outerDimension)
+    , m_traceFlagChannel(traceFlagChannel)
+    , m_segyTraceHeaderChannel(segyTraceHeaderChannel)
+    , m_dataSampleFormatCode(dataSampleFormatCode)
+    , m_dataEndianness(dataEndianness)
+    , m_prefetchLineCount(std::max(1, prefetchLineCount))
+    , m_writeBufferCount(std::max(1, writeBufferCount))
+    , m_sampleCount(m_layout->GetDimensionNumSamples(0))
+    , m_traceCount(1)
+  {
+    for(int dimension = 1; dimension < m_layout->GetDimensionality(); dimension++)
+    {
+      if(dimension != m_outerDimension)
+      {
+        m_traceCount *= m_layout->GetDimensionNumSamples(dimension);
+      }
+    }
+  }
+
+  int     GetLineCount() const  { return m_layout->GetDimensionNumSamples(m_outerDimension); }
+  int64_t GetTraceCount() const { return m_traceCount; }
+
+  // Export all lines, writing the traces sequentially from the given file offset. Returns false if a request or a write failed.
+  bool Run(int64_t offset, WriteFunction const &write, ProgressFunction const &progress, OpenVDS::Error &error)
+  {
+    const int lineCount = GetLineCount();
+    const int traceDataSize = TraceDataSize();
+    const int64_t segyTraceSize = traceDataSize + SEGY::TraceHeaderSize;
+
+    std::vector<LineRequest> lineRequests(std::min(m_prefetchLineCount, std::max(1, lineCount)));
+    for(auto &lineRequest : lineRequests)
+    {
+      lineRequest.m_data.resize(m_traceCount * traceDataSize);
+      lineRequest.m_traceFlag.resize(m_traceCount);
+      lineRequest.m_segyTraceHeader.resize(m_traceCount * SEGY::TraceHeaderSize);
+    }
+
+    std::vector<WriteBuffer> writeBuffers(m_writeBufferCount);
+    for(auto &writeBuffer : writeBuffers)
+    {
+      writeBuffer.m_data.resize(m_traceCount * segyTraceSize);
+    }
+
+    std::mutex mutex;
+    std::condition_variable writeQueueChanged;
+    std::condition_variable freeBuffersChanged;
+    std::deque<WriteBuffer *> writeQueue;
+    std::vector<WriteBuffer *> freeBuffers;
+    bool isDone = false;
+    bool writeFailed = false;
+    OpenVDS::Error writeError;
+
+    for(auto &writeBuffer : writeBuffers)
+    {
+      freeBuffers.push_back(&writeBuffer);
+    }
+
+    std::thread writer([&]()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while(true)
+      {
+        writeQueueChanged.wait(lock, [&]() { return isDone || !writeQueue.empty(); });
+        if(writeQueue.empty())
+        {
+          break;
+        }
+        WriteBuffer *writeBuffer = writeQueue.front();
+        writeQueue.pop_front();
+
+        if(!writeFailed)
+        {
+          lock.unlock();
+          OpenVDS::Error error;
+          bool success = write(writeBuffer->m_data.data(), writeBuffer->m_offset, writeBuffer->m_size, error);
+          lock.lock();
+          if(!success)
+          {
+            writeFailed = true;
+            writeError = error;
+          }
+        }
+
+        freeBuffers.push_back(writeBuffer);
+        freeBuffersChanged.notify_one();
+      }
+    });
+
+    for(int line = 0; line < int(lineRequests.size()); line++)
+    {
+      IssueRequests(lineRequests[line], line);
+    }
+
+    std::vector<int64_t> activeTraces;
+    activeTraces.reserve(m_traceCount);
+
+    bool success = true;
+
+    for(int line = 0; line < lineCount && success; line++)
+    {
+      if(progress)
+      {
+        progress(line, lineCount);
+      }
+
+      LineRequest &lineRequest = lineRequests[line % lineRequests.size()];
+
+      success = WaitForRequest(*lineRequest.m_dataRequest, "data", error) &&
+                WaitForRequest(*lineRequest.m_traceFlagRequest, "traceFlag", error) &&
+                WaitForRequest(*lineRequest.m_segyTraceHeaderRequest, "segyTraceHeader", error);
+      if(!success)
+      {
+        break;
+      }
+
+      activeTraces.clear();
+      for(int64_t trace = 0; trace < m_traceCount; trace++)
+      {
+        if(lineRequest.m_traceFlag[trace])
+        {
+          activeTraces.push_back(trace);
+        }
+      }
+
+      WriteBuffer *writeBuffer = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        freeBuffersChanged.wait(lock, [&]() { return writeFailed || !freeBuffers.empty(); });
+        if(writeFailed)
+        {
+          break;
+        }
+        writeBuffer = freeBuffers.back();
+        freeBuffers.pop_back();
+      }
+
+      const int activeTraceCount = int(activeTraces.size());
+      char *target = writeBuffer->m_data.data();
+      const char *data = lineRequest.m_data.data();
+      const char *segyTraceHeader = lineRequest.m_segyTraceHeader.data();
+
+      #pragma omp parallel for schedule(static)
+      for(int activeTrace = 0; activeTrace < activeTraceCount; activeTrace++)
+      {
+        int64_t trace = activeTraces[activeTrace];
+        ConvertTrace(target + activeTrace * segyTraceSize, segyTraceHeader + trace * SEGY::TraceHeaderSize, data + trace * traceDataSize);
+      }
+
+      // The request buffers of this line have been consumed, so they can be reused for the next line to prefetch
+      if(line + int(lineRequests.size()) < lineCount)
+      {
+        IssueRequests(lineRequest, line + int(lineRequests.size()));
+      }
+
+      writeBuffer->m_offset = offset;
+      writeBuffer->m_size = int32_t(activeTraceCount * segyTraceSize);
+      offset += writeBuffer->m_size;
+
+      std::unique_lock<std::mutex> lock(mutex);
+      writeQueue.push_back(writeBuffer);
+      writeQueueChanged.notify_one();
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      isDone = true;
+      writeQueueChanged.notify_one();
+    }
+    writer.join();
+
+    // Cancel any requests still in flight before their buffers go away
+    lineRequests.clear();
+
+    if(success && writeFailed)
+    {
+      error = writeError;
+      success = false;
+    }
+
+    return success;
+  }
+};
+
+#endif
@@ -36,7 +36,9 @@
 #include "IO/IOManager.h"
 
 #include <mutex>
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
 #include <climits>
 #include <cassert>
 #include <algorithm>
@@ -51,6 +53,10 @@
 #include <chrono>
 #include <numeric>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #if defined(WIN32)
 #undef WIN32_LEAN_AND_MEAN // avoid warnings if defined on command line
 #define WIN32_LEAN_AND_MEAN 1
@@ -667,42 +673,48 @@ findRepresentativeSegment(SEGYFileInfo const& fileInfo, int& primaryStep, int& b
   return fileInfo.m_segmentInfoLists[bestListIndex][bestIndex];
 }
 
+// Time spent in a stage of the import and the number of bytes it processed, summed over all the worker threads
+struct ImportStage
+{
+  std::atomic<int64_t> nanoseconds;
+  std::atomic<int64_t> bytes;
+
+  ImportStage() : nanoseconds(0), bytes(0) {}
+
+  void Add(std::chrono::steady_clock::duration duration, int64_t byteCount)
+  {
+    nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    bytes += byteCount;
+  }
+
+  std::string Throughput() const
+  {
+    double seconds = nanoseconds / 1.0e9;
+    return fmt::format("{:.1f} MB/s per thread ({:.1f} s)", seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0, seconds);
+  }
+};
+
 void
 copySamples(const void* data, SEGY::BinaryHeader::DataSampleFormatCode dataSampleFormatCode, SEGY::Endianness endianness, float* target, int sampleStart, int sampleCount)
 {
+  const void *source = reinterpret_cast<const void*>((intptr_t)data + (size_t)sampleStart * 4);
+
   if (dataSampleFormatCode == SEGY::BinaryHeader::DataSampleFormatCode::IBMFloat)
   {
-    if(endianness == SEGY::Endianness::LittleEndian)
-    {
-      // Reverse endianness since Ibm2ieee expects big endian data
-      const char * source = reinterpret_cast<const char*>((intptr_t)data + (size_t)sampleStart * 4);
-      std::unique_ptr<char[]> temp(new char[sampleCount * 4]);
-      for(int sample = 0; sample < sampleCount; sample++)
-      {
-        temp[sample * 4 + 0] = source[sample * 4 + 3];
-        temp[sample * 4 + 1] = source[sample * 4 + 2];
-        temp[sample * 4 + 2] = source[sample * 4 + 1];
-        temp[sample * 4 + 3] = source[sample * 4 + 0];
-      }
-      SEGY::Ibm2ieee(target, temp.get(), sampleCount);
-    }
-    else
-    {
-      assert(endianness == SEGY::Endianness::BigEndian);
-      SEGY::Ibm2ieee(target, reinterpret_cast<const uint32_t*>((intptr_t)data + (size_t)sampleStart * 4), sampleCount);
-    }
+    // Byte swapping (if needed) is done as part of the conversion
+    SEGY::Ibm2ieee(target, source, sampleCount, endianness);
   }
   else
   {
     assert(dataSampleFormatCode == SEGY::BinaryHeader::DataSampleFormatCode::IEEEFloat);
     if(endianness == SEGY::Endianness::LittleEndian)
     {
-      SEGY::ConvertFromEndianness<SEGY::Endianness::LittleEndian>(target, reinterpret_cast<const char*>((intptr_t)data + (size_t)sampleStart * 4), sampleCount);
+      memcpy(target, source, (size_t)sampleCount * 4);
     }
     else
     {
       assert(endianness == SEGY::Endianness::BigEndian);
-      SEGY::ConvertFromEndianness<SEGY::Endianness::BigEndian>(target, reinterpret_cast<const char*>((intptr_t)data + (size_t)sampleStart * 4), sampleCount);
+      SEGY::ByteSwap32(target, source, sampleCount);
     }
   }
 }
@@ -800,7 +812,7 @@ analyzeSegment(DataProvider &dataProvider, SEGYFileInfo const& fileInfo, SEGYSeg
     if (fileInfo.HasGatherOffset())
     {
       auto
-        thisOffset = SEGY::ReadFieldFromHeader(header, g_traceHeaderFields["Offset"], fileInfo.m_headerEndianness);
+        thisOffset = SEGY::ReadFieldFromHeader(header, g_traceHeaderFields["offset"], fileInfo.m_headerEndianness);
       if (hasPreviousGatherOffset)
       {
         offsetStart = std::min(offsetStart, thisOffset);
@@ -1467,6 +1479,7 @@ main(int argc, char* argv[])
   std::string fileInfoFileName;
   int brickSize = 64;
   int margin = 0;
+  int lodLevelCount = 0;
   bool force = false;
   bool ignoreWarnings = false;
   std::string compressionMethodString;
@@ -1490,6 +1503,8 @@ main(int argc, char* argv[])
   if(OpenVDS::IsCompressionMethodSupported(OpenVDS::CompressionMethod::WaveletNormalizeBlock)) supportedCompressionMethods += ", WaveletNormalizeBlock";
   if(OpenVDS::IsCompressionMethodSupported(OpenVDS::CompressionMethod::WaveletLossless)) supportedCompressionMethods += ", WaveletLossless";
   if(OpenVDS::IsCompressionMethodSupported(OpenVDS::CompressionMethod::WaveletNormalizeBlockLossless)) supportedCompressionMethods += ", WaveletNormalizeBlockLossless";
+  if(OpenVDS::IsCompressionMethodSupported(OpenVDS::CompressionMethod::Zstd)) supportedCompressionMethods += ", Zstd";
+  if(OpenVDS::IsCompressionMethodSupported(OpenVDS::CompressionMethod::LZ4)) supportedCompressionMethods += ", LZ4";
 
   std::vector<std::string> fileNames;
 
@@ -1507,10 +1522,11 @@ main(int argc, char* argv[])
   options.add_option("", "i", "file-info", "A JSON file (generated by the --scan option) containing information about the input SEG-Y file.", cxxopts::value<std::string>(fileInfoFileName), "<file>");
   options.add_option("", "b", "brick-size", "The brick size for the volume data store.", cxxopts::value<int>(brickSize), "<value>");
   options.add_option("", "",  "margin", "The margin size (overlap) of the bricks.", cxxopts::value<int>(margin), "<value>");
+  options.add_option("", "",  "lod-levels", "The number of LOD levels to generate from the amplitude data while it is imported (0-12).", cxxopts::value<int>(lodLevelCount), "<value>");
   options.add_option("", "f", "force", "Continue on upload error.", cxxopts::value<bool>(force), "");
   options.add_option("", "", "ignore-warnings", "Ignore warnings about import parameters.", cxxopts::value<bool>(ignoreWarnings), "");
   options.add_option("", "", "compression-method", std::string("Compression method. Supported compression methods are: ") + supportedCompressionMethods + ".", cxxopts::value<std::string>(compressionMethodString), "<string>");
-  options.add_option("", "", "tolerance", "This parameter specifies the compression tolerance when using the wavelet compression method. This value is the maximum deviation from the original data value when the data is converted to 8-bit using the value range. A value of 1 means the maximum allowable loss is the same as quantizing to 8-bit (but the average loss will be much much lower than quantizing to 8-bit). It is not a good idea to directly relate the tolerance to the quality of the compressed data, as the average loss will in general be an order of magnitude lower than the allowable loss.", cxxopts::value<float>(compressionTolerance), "<value>");
+  options.add_option("", "", "tolerance", "This parameter specifies the compression tolerance when using the wavelet compression method. This value is the maximum deviation from the original data value when the data is converted to 8-bit using the value range. A value of 1 means the maximum allowable loss is the same as quantizing to 8-bit (but the average loss will be much much lower than quantizing to 8-bit). It is not a good idea to directly relate the tolerance to the quality of the compressed data, as the average loss will in general be an order of magnitude lower than the allowable loss. When using the Zstd compression method this value is the zstd compression level.", cxxopts::value<float>(compressionTolerance), "<value>");
   options.add_option("", "", "url", "Url with cloud vendor scheme used for target location or file name of output VDS file.", cxxopts::value<std::string>(url), "<string>");
   options.add_option("", "", "url-connection", "Connection string used for additional parameters to the url connection", cxxopts::value<std::string>(urlConnection), "<string>");
   options.add_option("", "", "vdsfile", "File name of output VDS file.", cxxopts::value<std::string>(url), "<string>");
@@ -1571,6 +1587,8 @@ main(int argc, char* argv[])
   else if(compressionMethodString == "waveletnormalizeblock")         compressionMethod = OpenVDS::CompressionMethod::WaveletNormalizeBlock;
   else if(compressionMethodString == "waveletlossless")               compressionMethod = OpenVDS::CompressionMethod::WaveletLossless;
   else if(compressionMethodString == "waveletnormalizeblocklossless") compressionMethod = OpenVDS::CompressionMethod::WaveletNormalizeBlockLossless;
+  else if(compressionMethodString == "zstd")                          compressionMethod = OpenVDS::CompressionMethod::Zstd;
+  else if(compressionMethodString == "lz4")                           compressionMethod = OpenVDS::CompressionMethod::LZ4;
   else
   {
     OpenVDS::printError(jsonOutput, "CompressionMethod", "Unknown compression method", compressionMethodString);
@@ -1925,7 +1943,14 @@ main(int argc, char* argv[])
   }
 
   OpenVDS::VolumeDataLayoutDescriptor::Options layoutOptions = OpenVDS::VolumeDataLayoutDescriptor::Options_None;
-  OpenVDS::VolumeDataLayoutDescriptor::LODLevels lodLevels = OpenVDS::VolumeDataLayoutDescriptor::LODLevels_None;
+
+  if (lodLevelCount < 0 || lodLevelCount > 12)
+  {
+    OpenVDS::printError(jsonOutput, "Args", "Illegal number of LOD levels (must be between 0 and 12)");
+    return EXIT_FAILURE;
+  }
+
+  OpenVDS::VolumeDataLayoutDescriptor::LODLevels lodLevels = OpenVDS::VolumeDataLayoutDescriptor::LODLevels(lodLevelCount);
 
   const int negativeMargin = margin;
   const int positiveMargin = margin;
@@ -2059,7 +2084,8 @@ main(int argc, char* argv[])
     writeDimensionGroup = OpenVDS::DimensionsND::Dimensions_013;
   }
 
-  auto amplitudeAccessor = accessManager.CreateVolumeDataPageAccessor(writeDimensionGroup, 0, 0, 8, OpenVDS::VolumeDataAccessManager::AccessMode_Create);
+  // The LOD levels of the amplitude channel are produced from the chunks as they are written
+  auto amplitudeAccessor = accessManager.CreateVolumeDataPageAccessor(writeDimensionGroup, 0, 0, 8, lodLevels != OpenVDS::VolumeDataLayoutDescriptor::LODLevels_None ? OpenVDS::VolumeDataAccessManager::AccessMode_CreateWithLODGeneration : OpenVDS::VolumeDataAccessManager::AccessMode_Create);
   auto traceFlagAccessor = accessManager.CreateVolumeDataPageAccessor(writeDimensionGroup, 0, 1, 8, OpenVDS::VolumeDataAccessManager::AccessMode_Create);
   auto segyTraceHeaderAccessor = accessManager.CreateVolumeDataPageAccessor(writeDimensionGroup, 0, 2, 8, OpenVDS::VolumeDataAccessManager::AccessMode_Create);
   auto offsetAccessor = fileInfo.HasGatherOffset() ? accessManager.CreateVolumeDataPageAccessor(writeDimensionGroup, 0, 3, 8, OpenVDS::VolumeDataAccessManager::AccessMode_Create) : nullptr;
@@ -2170,64 +2196,48 @@ main(int argc, char* argv[])
     }
   }
 
-  for (int64_t chunk = 0; chunk < amplitudeAccessor->GetChunkCount() && error.code == 0; chunk++)
+  // Amplitude pages are written back by the worker that evicts them (when creating a new page), so each worker
+  // needs room for about two cached pages and the serialized copy of the page being written back.
+  int
+    chunkMin[OpenVDS::Dimensionality_Max],
+    chunkMax[OpenVDS::Dimensionality_Max];
+  amplitudeAccessor->GetChunkMinMax(0, chunkMin, chunkMax);
+  int64_t amplitudePageSize = sizeof(float);
+  for (int dimension = 0; dimension < OpenVDS::Dimensionality_Max; dimension++)
   {
-    int new_percentage = int(double(chunk) / amplitudeAccessor->GetChunkCount() * 100);
-    if (!jsonOutput && is_tty && percentage != new_percentage)
-    {
-      percentage = new_percentage;
-      fmt::print(stdout, "\r {:3}% Done. ", percentage);
-      fflush(stdout);
-    }
-    int32_t errorCount = accessManager.UploadErrorCount();
-    if (errorCount)
-    {
-      OpenVDS::PrintWarningContext warningContext(jsonOutput, "VDS", !force, "Use -f/--force to continue uploading after upload errors");
-      for (int i = 0; i < errorCount; i++)
-      {
-        const char* object_id;
-        int32_t error_code;
-        const char* error_string;
-        accessManager.GetCurrentUploadError(&object_id, &error_code, &error_string);
-        warningContext.addWarning("Failed to upload object", fmt::format("{}", object_id), fmt::format("Error code {}: {}", object_id, error_code, error_string));
-      }
-    }
+    amplitudePageSize *= std::max(1, chunkMax[dimension] - chunkMin[dimension]);
+  }
 
-    auto &chunkInfo = chunkInfos[chunk];
+  const int64_t importMemoryBudget = std::max(GetTotalSystemMemory() / 4 - dvmMemoryLimit, 4 * amplitudePageSize);
+  int threadCount = 1;
+#if defined(_OPENMP)
+  threadCount = omp_get_max_threads();
+#endif
+  threadCount = int(std::max(int64_t(1), std::min(int64_t(threadCount), importMemoryBudget / (4 * amplitudePageSize))));
 
-    // if we've crossed to a new inline then trim the trace page cache
-    if (chunk > 0)
-    {
-      const auto& previousChunkInfo = chunkInfos[chunk - 1];
+  const int maxPages = std::max(8, 2 * threadCount);
+  amplitudeAccessor->SetMaxPages(maxPages);
+  traceFlagAccessor->SetMaxPages(maxPages);
+  segyTraceHeaderAccessor->SetMaxPages(maxPages);
+  if (offsetAccessor) offsetAccessor->SetMaxPages(maxPages);
 
-      for (size_t chunkFileIndex = 0; chunkFileIndex < dataProviders.size(); ++chunkFileIndex)
-      {
-        auto prevIndexIter = previousChunkInfo.lowerUpperSegmentIndices.find(chunkFileIndex);
-        if (prevIndexIter != previousChunkInfo.lowerUpperSegmentIndices.end())
-        {
-          auto currentIndexIter = chunkInfo.lowerUpperSegmentIndices.find(chunkFileIndex);
-          if (currentIndexIter != chunkInfo.lowerUpperSegmentIndices.end())
-          {
-            // This file is active in both the current and previous chunks. Check to see if we've progressed to a new set of inlines.
-            auto previousLowerSegmentIndex = std::get<0>(prevIndexIter->second);
-            auto currentLowerSegmentIndex = std::get<0>(currentIndexIter->second);
-            if (currentLowerSegmentIndex > previousLowerSegmentIndex)
-            {
-              // we've progressed to a new set of inlines; remove earlier pages from the cache
-              traceDataManagers[chunkFileIndex].retirePagesBefore(fileInfo.m_segmentInfoLists[chunkFileIndex][currentLowerSegmentIndex].m_traceStart);
-            }
-          }
-          else
-          {
-            // This file was active in the previous chunk but not in the current chunk, which implies that we don't
-            // need any more data from this file.
-            traceDataManagers[chunkFileIndex].retireAllPages();
-          }
-        }
-        // else This file isn't used in either the previous or current chunks. We don't need to do anything.
-      }
-    }
+  const SEGY::HeaderField offsetHeaderField = g_traceHeaderFields["offset"];
 
+  ImportStage
+    readStage,
+    convertStage,
+    writeStage;
+
+  auto importChunk = [&](int64_t chunk, OpenVDS::Error &error)
+  {
+    auto &chunkInfo = chunkInfos[chunk];
+
+    auto chunkStart = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration readTime(0);
+    int64_t readBytes = 0;
+    int64_t convertBytes = 0;
+
+    // Creating pages evicts (and writes back) the least recently used pages, so that is counted as writing
     OpenVDS::VolumeDataPage* amplitudePage = amplitudeAccessor->CreatePage(chunk);
     OpenVDS::VolumeDataPage* traceFlagPage = nullptr;
     OpenVDS::VolumeDataPage* segyTraceHeaderPage = nullptr;
@@ -2243,6 +2253,8 @@ main(int argc, char* argv[])
       }
     }
 
+    std::chrono::steady_clock::duration writeTime = std::chrono::steady_clock::now() - chunkStart;
+
     int amplitudePitch[OpenVDS::Dimensionality_Max];
     int traceFlagPitch[OpenVDS::Dimensionality_Max];
     int segyTraceHeaderPitch[OpenVDS::Dimensionality_Max];
@@ -2289,7 +2301,9 @@ main(int argc, char* argv[])
         }
         else
         {
+          auto readStart = std::chrono::steady_clock::now();
           firstTrace = findFirstTrace(traceDataManager, *segment, chunkInfo.secondaryKeyStart, fileInfo, error);
+          readTime += std::chrono::steady_clock::now() - readStart;
           if (error.code)
           {
             OpenVDS::printWarning(jsonOutput, "IO", "Failed when reading data", fmt::format("{}", error.code), error.string);
@@ -2303,7 +2317,10 @@ main(int argc, char* argv[])
 
         for (int64_t trace = firstTrace; trace <= segment->m_traceStop; trace++, tertiaryIndex++)
         {
+          auto readStart = std::chrono::steady_clock::now();
           const char* header = traceDataManager.getTraceData(trace, error);
+          readTime += std::chrono::steady_clock::now() - readStart;
+          readBytes += traceByteSize;
           if (error.code)
           {
             OpenVDS::printWarning(jsonOutput, "IO", "Failed when reading data", fmt::format("{}", error.code), error.string);
@@ -2349,7 +2366,7 @@ main(int argc, char* argv[])
           {
             // recalculate tertiaryIndex from header offset value
             const auto
-              thisOffset = SEGY::ReadFieldFromHeader(header, g_traceHeaderFields["Offset"], fileInfo.m_headerEndianness);
+              thisOffset = SEGY::ReadFieldFromHeader(header, offsetHeaderField, fileInfo.m_headerEndianness);
             tertiaryIndex = (thisOffset - offsetStart) / offsetStep;
 
             // sanity check the new index
@@ -2377,6 +2394,7 @@ main(int argc, char* argv[])
             }
 
             copySamples(data, fileInfo.m_dataSampleFormatCode, fileInfo.m_headerEndianness, &reinterpret_cast<float*>(amplitudeBuffer)[targetOffset], chunkInfo.sampleStart, chunkInfo.sampleCount);
+            convertBytes += chunkInfo.sampleCount * sizeof(float);
           }
 
           if (traceFlagBuffer)
@@ -2423,7 +2441,7 @@ main(int argc, char* argv[])
             }
 
             const int
-              traceOffset = SEGY::ReadFieldFromHeader(header, g_traceHeaderFields["Offset"], fileInfo.m_headerEndianness);
+              traceOffset = SEGY::ReadFieldFromHeader(header, offsetHeaderField, fileInfo.m_headerEndianness);
             reinterpret_cast<float*>(offsetBuffer)[targetOffset] = static_cast<float>(traceOffset);
           }
         }
@@ -2434,12 +2452,125 @@ main(int argc, char* argv[])
     if (traceFlagPage) traceFlagPage->Release();
     if (segyTraceHeaderPage) segyTraceHeaderPage->Release();
     if (offsetPage) offsetPage->Release();
+
+    int64_t writeBytes = sizeof(float);
+    for (int dimension = 0; dimension < OpenVDS::Dimensionality_Max; dimension++)
+    {
+      writeBytes *= std::max(1, chunkInfo.max[dimension] - chunkInfo.min[dimension]);
+    }
+
+    std::chrono::steady_clock::duration chunkTime = std::chrono::steady_clock::now() - chunkStart;
+    readStage.Add(readTime, readBytes);
+    convertStage.Add(chunkTime - readTime - writeTime, convertBytes);
+    writeStage.Add(writeTime, writeBytes);
+  };
+
+  // The chunks that cover the same range of primary keys read the same input traces, so they are imported
+  // concurrently. The trace pages are only retired between these batches of chunks, which keeps the input
+  // read in the same order as a sequential import.
+  const int64_t chunkCount = amplitudeAccessor->GetChunkCount();
+  int64_t completedChunkCount = 0;
+  std::mutex importMutex;
+
+  auto importStart = std::chrono::steady_clock::now();
+
+  for (int64_t batchStart = 0, batchEnd = 0; batchStart < chunkCount && error.code == 0; batchStart = batchEnd)
+  {
+    batchEnd = batchStart + 1;
+    while (batchEnd < chunkCount && chunkInfos[batchEnd].lowerUpperSegmentIndices == chunkInfos[batchStart].lowerUpperSegmentIndices)
+    {
+      batchEnd++;
+    }
+
+    int32_t errorCount = accessManager.UploadErrorCount();
+    if (errorCount)
+    {
+      OpenVDS::PrintWarningContext warningContext(jsonOutput, "VDS", !force, "Use -f/--force to continue uploading after upload errors");
+      for (int i = 0; i < errorCount; i++)
+      {
+        const char* object_id;
+        int32_t error_code;
+        const char* error_string;
+        accessManager.GetCurrentUploadError(&object_id, &error_code, &error_string);
+        warningContext.addWarning("Failed to upload object", fmt::format("{}", object_id), fmt::format("Error code {}: {}", object_id, error_code, error_string));
+      }
+    }
+
+    // if we've crossed to a new inline then trim the trace page cache
+    if (batchStart > 0)
+    {
+      const auto& chunkInfo = chunkInfos[batchStart];
+      const auto& previousChunkInfo = chunkInfos[batchStart - 1];
+
+      for (size_t chunkFileIndex = 0; chunkFileIndex < dataProviders.size(); ++chunkFileIndex)
+      {
+        auto prevIndexIter = previousChunkInfo.lowerUpperSegmentIndices.find(chunkFileIndex);
+        if (prevIndexIter != previousChunkInfo.lowerUpperSegmentIndices.end())
+        {
+          auto currentIndexIter = chunkInfo.lowerUpperSegmentIndices.find(chunkFileIndex);
+          if (currentIndexIter != chunkInfo.lowerUpperSegmentIndices.end())
+          {
+            // This file is active in both the current and previous chunks. Check to see if we've progressed to a new set of inlines.
+            auto previousLowerSegmentIndex = std::get<0>(prevIndexIter->second);
+            auto currentLowerSegmentIndex = std::get<0>(currentIndexIter->second);
+            if (currentLowerSegmentIndex > previousLowerSegmentIndex)
+            {
+              // we've progressed to a new set of inlines; remove earlier pages from the cache
+              traceDataManagers[chunkFileIndex].retirePagesBefore(fileInfo.m_segmentInfoLists[chunkFileIndex][currentLowerSegmentIndex].m_traceStart);
+            }
+          }
+          else
+          {
+            // This file was active in the previous chunk but not in the current chunk, which implies that we don't
+            // need any more data from this file.
+            traceDataManagers[chunkFileIndex].retireAllPages();
+          }
+        }
+        // else This file isn't used in either the previous or current chunks. We don't need to do anything.
+      }
+    }
+
+    bool isBatchFailed = false;
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threadCount)
+    for (int batchChunk = 0; batchChunk < int(batchEnd - batchStart); batchChunk++)
+    {
+      {
+        std::unique_lock<std::mutex> lock(importMutex);
+        if (isBatchFailed)
+        {
+          continue;
+        }
+      }
+
+      OpenVDS::Error chunkError;
+      importChunk(batchStart + batchChunk, chunkError);
+
+      std::unique_lock<std::mutex> lock(importMutex);
+      if (chunkError.code != 0 && !isBatchFailed)
+      {
+        error = chunkError;
+        isBatchFailed = true;
+      }
+
+      int new_percentage = int(double(++completedChunkCount) / chunkCount * 100);
+      if (!jsonOutput && is_tty && percentage != new_percentage)
+      {
+        percentage = new_percentage;
+        fmt::print(stdout, "\r {:3}% Done. ", percentage);
+        fflush(stdout);
+      }
+    }
   }
 
+  auto commitStart = std::chrono::steady_clock::now();
   amplitudeAccessor->Commit();
   traceFlagAccessor->Commit();
   segyTraceHeaderAccessor->Commit();
   if (offsetAccessor) offsetAccessor->Commit();
+  writeStage.Add(std::chrono::steady_clock::now() - commitStart, 0);
+
+  double importSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - importStart).count();
 
   dataView.reset();
   traceDataManagers.clear();
@@ -2453,6 +2584,7 @@ main(int argc, char* argv[])
   {
     fmt::print("\r100% done processing {}.\n", url);
   }
+  OpenVDS::printInfo(jsonOutput, "Throughput", fmt::format("Imported {} chunks in {:.1f} s using {} threads", chunkCount, importSeconds, threadCount), fmt::format("reading {}, converting {}, writing {}", readStage.Throughput(), convertStage.Throughput(), writeStage.Throughput()));
   //double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
   //fmt::print("Elapsed time is {}.\n", elapsed / 1000);
 